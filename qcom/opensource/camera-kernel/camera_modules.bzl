@@ -234,6 +234,16 @@ def _define_module(target, variant):
             "CONFIG_QCOM_BUS_SCALING": {
                 True: ["drivers/cam_utils/cam_soc_bus.c"],
             },
+            "CONFIG_SPECTRA_KUNIT_TEST": {
+                True: [
+                    "drivers/cam_sync/cam_sync_test.c",
+                    "drivers/cam_cdm/cam_cdm_test.c",
+                    "drivers/cam_cdm/cam_cdm_shadow_test.c",
+                    "drivers/cam_utils/cam_packet_util_test.c",
+                    "drivers/cam_req_mgr/cam_req_mgr_workq_test.c",
+                    "drivers/cam_isp/cam_isp_context_test.c",
+                ],
+            },
             "CONFIG_CAM_PRESIL": {
                 # Sources need to be available to specify
                 # True: [
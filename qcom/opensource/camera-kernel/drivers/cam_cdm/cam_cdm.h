@@ -28,6 +28,11 @@
 #define CAM_CDM_HW_RESET_TIMEOUT          1000
 #define CAM_CDM_PAUSE_CORE_US_TIMEOUT     10000
 
+/* Virtual CDM shadow register cache geometry */
+#define CAM_CDM_SHADOW_REG_HASH_BITS      9
+#define CAM_CDM_SHADOW_REG_NUM            (1 << CAM_CDM_SHADOW_REG_HASH_BITS)
+#define CAM_CDM_SHADOW_DMI_NUM            16
+
 /*
  * Macros to get prepare and get information
  * from client CDM handles.
@@ -421,6 +426,7 @@ enum cam_cdm_hw_process_intf_cmd {
 	CAM_CDM_HW_INTF_CMD_HANDLE_ERROR,
 	CAM_CDM_HW_INTF_CMD_HANG_DETECT,
 	CAM_CDM_HW_INTF_DUMP_DBG_REGS,
+	CAM_CDM_HW_INTF_CMD_INVALIDATE_SHADOW,
 	CAM_CDM_HW_INTF_CMD_INVALID,
 };
 
@@ -467,6 +473,19 @@ enum cam_cdm_hw_version {
 	CAM_CDM_VERSION_MAX,
 };
 
+/**
+ * struct cam_cdm_always_write_regs - Mapped addresses of the registers a
+ *                                    virtual CDM client needs written on
+ *                                    every replay
+ *
+ * @addr:   Mapped register addresses
+ * @num:    Number of valid entries in @addr
+ */
+struct cam_cdm_always_write_regs {
+	void __iomem *addr[CAM_CDM_ALWAYS_WRITE_MAX];
+	uint32_t      num;
+};
+
 /* struct cam_cdm_client - struct for cdm clients data.*/
 struct cam_cdm_client {
 	struct cam_cdm_acquire_data data;
@@ -475,6 +494,7 @@ struct cam_cdm_client {
 	uint32_t refcount;
 	struct mutex lock;
 	uint32_t handle;
+	struct cam_cdm_always_write_regs always_write;
 };
 
 /* struct cam_cdm_work_payload - struct for cdm work payload data.*/
@@ -515,6 +535,120 @@ struct cam_cdm_bl_fifo {
 	atomic_t work_record;
 };
 
+/**
+ * struct cam_cdm_shadow_reg - Shadow copy of one register written by
+ *                             the virtual CDM
+ *
+ * @addr:   Mapped register address, NULL if the slot is unused
+ * @value:  Last value written to the register
+ */
+struct cam_cdm_shadow_reg {
+	void __iomem *addr;
+	uint32_t      value;
+};
+
+/**
+ * struct cam_cdm_shadow_dmi_ctx - DMI port registers in effect for an upload
+ *
+ * The virtual CDM replays only the DMI data writes. The LUT and bank the
+ * data lands in, and the start offset, come from the DMI config and address
+ * registers programmed before the upload.
+ *
+ * @cfg:         DMI config register value
+ * @addr:        DMI address register value
+ * @cfg_known:   @cfg holds the value in effect
+ * @addr_known:  @addr holds the value in effect
+ */
+struct cam_cdm_shadow_dmi_ctx {
+	uint32_t cfg;
+	uint32_t addr;
+	bool     cfg_known;
+	bool     addr_known;
+};
+
+/**
+ * struct cam_cdm_shadow_dmi - Fingerprint of the last LUT uploaded
+ *                             through one DMI port
+ *
+ * @addr:    Mapped DMI port address, NULL if the slot is unused
+ * @sel:     DMI select and command type the LUT was uploaded with
+ * @length:  Length field of the DMI command
+ * @hash:    64 bit hash of the LUT payload
+ * @ctx:     DMI port registers the LUT was uploaded with
+ * @cur:     DMI port registers as last written through the shadow
+ */
+struct cam_cdm_shadow_dmi {
+	void __iomem                  *addr;
+	uint32_t                       sel;
+	uint32_t                       length;
+	uint64_t                       hash;
+	struct cam_cdm_shadow_dmi_ctx  ctx;
+	struct cam_cdm_shadow_dmi_ctx  cur;
+};
+
+#ifdef CONFIG_SPECTRA_KUNIT_TEST
+/**
+ * struct cam_cdm_test_mmio_backend - Stand-in MMIO space for the virtual
+ *                                    CDM replay, used by KUnit tests
+ *
+ * @write:  called instead of the MMIO write for each replayed register
+ *          or DMI data write
+ * @priv:   backend private data
+ */
+struct cam_cdm_test_mmio_backend {
+	void (*write)(void *priv, void __iomem *addr, uint32_t value);
+	void *priv;
+};
+#endif
+
+/**
+ * struct cam_cdm_shadow_regs - Virtual CDM shadow register cache
+ *
+ * @lock:            Serializes command buffer replay against the cache
+ * @valid:           False when the cache has to be wiped before next use
+ * @regs:            Direct mapped register shadow, indexed by address hash
+ * @dmi:             Fingerprints of the LUTs last uploaded per DMI port
+ * @dmi_next:        Round robin victim slot for new DMI ports
+ * @always_write:    Always-write registers of the client whose buffer is
+ *                   being replayed, only valid while @lock is held
+ * @writes_issued:   Number of register and DMI writes issued to the HW
+ * @writes_skipped:  Number of register and DMI writes elided by the cache
+ * @dmi_skipped:     Number of DMI uploads elided by the cache
+ * @test_mmio:       stand-in MMIO backend installed by KUnit tests, replay
+ *                   writes go to it instead of the HW when set
+ */
+struct cam_cdm_shadow_regs {
+	struct mutex              lock;
+	bool                      valid;
+	struct cam_cdm_shadow_reg regs[CAM_CDM_SHADOW_REG_NUM];
+	struct cam_cdm_shadow_dmi dmi[CAM_CDM_SHADOW_DMI_NUM];
+	uint32_t                  dmi_next;
+	const struct cam_cdm_always_write_regs *always_write;
+	uint64_t                  writes_issued;
+	uint64_t                  writes_skipped;
+	uint64_t                  dmi_skipped;
+#ifdef CONFIG_SPECTRA_KUNIT_TEST
+	struct cam_cdm_test_mmio_backend *test_mmio;
+#endif
+};
+
+#ifdef CONFIG_SPECTRA_KUNIT_TEST
+/**
+ * struct cam_cdm_test_reg_backend - Stand-in CDM register space for tests
+ *
+ * @read:                read a register, returns true on failure like
+ *                       cam_cdm_read_hw_reg
+ * @write:               write a register, returns true on failure like
+ *                       cam_cdm_write_hw_reg
+ * @priv:                backend private data
+ */
+struct cam_cdm_test_reg_backend {
+	bool (*read)(void *priv, uint32_t reg, uint32_t *value);
+	bool (*write)(void *priv, uint32_t reg, uint32_t value);
+	void *priv;
+};
+#endif
+
 /**
  * struct cam_cdm - CDM hw device struct
  *
@@ -541,6 +675,10 @@ struct cam_cdm_bl_fifo {
  * @cpas_handle:         handle for cpas driver
  * @arbitration:         type of arbitration to be used for the CDM
  * @num_active_clients:  Number of currently active clients
+ * @shadow:              shadow register cache used by virtual CDM, NULL for
+ *                       HW CDMs
+ * @test_regs:           stand-in register backend installed by KUnit tests,
+ *                       CDM registers are accessed through it when set
  */
 struct cam_cdm {
 	uint32_t index;
@@ -563,6 +701,10 @@ struct cam_cdm {
 	uint32_t cpas_handle;
 	enum cam_cdm_arbitration arbitration;
 	uint8_t num_active_clients;
+	struct cam_cdm_shadow_regs *shadow;
+#ifdef CONFIG_SPECTRA_KUNIT_TEST
+	struct cam_cdm_test_reg_backend *test_regs;
+#endif
 };
 
 /* struct cam_cdm_private_dt_data - CDM hw custom dt data */
@@ -18,6 +18,7 @@
 #include "cam_cdm.h"
 #include "cam_cdm_soc.h"
 #include "cam_cdm_core_common.h"
+#include "cam_cdm_virtual.h"
 
 int cam_cdm_util_cpas_start(struct cam_hw_info *cdm_hw)
 {
@@ -419,6 +420,8 @@ int cam_cdm_stream_ops_internal(void *hw_priv,
 			if (core->id == CAM_CDM_VIRTUAL) {
 				CAM_DBG(CAM_CDM,
 					"Virtual CDM HW init first time");
+				cam_cdm_util_shadow_regs_invalidate(
+					core->shadow);
 				rc = 0;
 			} else {
 				CAM_DBG(CAM_CDM, "CDM HW init first time");
@@ -448,6 +451,8 @@ int cam_cdm_stream_ops_internal(void *hw_priv,
 				if (core->id == CAM_CDM_VIRTUAL) {
 					CAM_DBG(CAM_CDM,
 						"Virtual CDM HW Deinit");
+					cam_cdm_util_shadow_regs_invalidate(
+						core->shadow);
 					rc = 0;
 				} else {
 					CAM_DBG(CAM_CDM, "CDM HW Deinit now");
@@ -518,6 +523,7 @@ int cam_cdm_pf_stream_off_all_clients(struct cam_hw_info *cdm_hw)
 	if (rc)
 		CAM_ERR(CAM_CDM, "CPAS stop failed in stream off rc %d", rc);
 
+	cam_cdm_util_shadow_regs_invalidate(core->shadow);
 	cdm_hw->open_count = 0;
 
 	return rc;
@@ -549,6 +555,34 @@ int cam_cdm_stream_stop(void *hw_priv,
 
 }
 
+static int cam_cdm_validate_always_write(struct cam_cdm_acquire_data *data)
+{
+	uint32_t i, base_idx;
+
+	if (data->always_write_cnt > CAM_CDM_ALWAYS_WRITE_MAX) {
+		CAM_ERR(CAM_CDM, "Invalid always write count %u for %s",
+			data->always_write_cnt, data->identifier);
+		return -EINVAL;
+	}
+
+	for (i = 0; i < data->always_write_cnt; i++) {
+		base_idx = data->always_write[i].base_idx;
+		if ((base_idx >= data->base_array_cnt) ||
+			(base_idx >= CAM_SOC_MAX_BLOCK) ||
+			(!data->base_array[base_idx]) ||
+			(data->always_write[i].offset >=
+			data->base_array[base_idx]->size)) {
+			CAM_ERR(CAM_CDM,
+				"Invalid always write reg %u base %u offset 0x%x for %s",
+				i, base_idx, data->always_write[i].offset,
+				data->identifier);
+			return -EINVAL;
+		}
+	}
+
+	return 0;
+}
+
 int cam_cdm_process_cmd(void *hw_priv,
 	uint32_t cmd, void *cmd_args, uint32_t arg_size)
 {
@@ -626,6 +660,7 @@ int cam_cdm_process_cmd(void *hw_priv,
 	case CAM_CDM_HW_INTF_CMD_ACQUIRE: {
 		struct cam_cdm_acquire_data *data;
 		int idx;
+		uint32_t i;
 		struct cam_cdm_client *client;
 
 		if (sizeof(struct cam_cdm_acquire_data) != arg_size) {
@@ -648,6 +683,13 @@ int cam_cdm_process_cmd(void *hw_priv,
 			break;
 		}
 
+		if ((core->id == CAM_CDM_VIRTUAL) &&
+			(cam_cdm_validate_always_write(data))) {
+			mutex_unlock(&cdm_hw->hw_mutex);
+			rc = -EINVAL;
+			break;
+		}
+
 		if (core->id != CAM_CDM_VIRTUAL &&
 				core->bl_fifo[data->priority].bl_depth == 0) {
 			mutex_unlock(&cdm_hw->hw_mutex);
@@ -712,6 +754,18 @@ int cam_cdm_process_cmd(void *hw_priv,
 					data->priority,
 					idx);
 		client->stream_on = false;
+		if (core->id == CAM_CDM_VIRTUAL) {
+			struct cam_cdm_always_write_reg *reg;
+			struct cam_soc_reg_map *reg_map;
+
+			for (i = 0; i < data->always_write_cnt; i++) {
+				reg = &data->always_write[i];
+				reg_map = data->base_array[reg->base_idx];
+				client->always_write.addr[i] =
+					reg_map->mem_base + reg->offset;
+			}
+			client->always_write.num = data->always_write_cnt;
+		}
 		data->handle = client->handle;
 		CAM_DBG(CAM_CDM, "Acquired client=%s in hwidx=%d",
 			data->identifier, core->index);
@@ -797,6 +851,7 @@ int cam_cdm_process_cmd(void *hw_priv,
 			mutex_unlock(&cdm_hw->hw_mutex);
 			break;
 		}
+		cam_cdm_util_shadow_regs_invalidate(core->shadow);
 		rc = cam_hw_cdm_reset_hw(cdm_hw, *handle);
 		if (rc) {
 			CAM_ERR(CAM_CDM,
@@ -929,6 +984,31 @@ int cam_cdm_process_cmd(void *hw_priv,
 		rc = cam_hw_cdm_hang_detect(cdm_hw, *handle);
 		break;
 	}
+	case CAM_CDM_HW_INTF_CMD_INVALIDATE_SHADOW: {
+		uint32_t *handle = cmd_args;
+		int idx;
+		struct cam_cdm_client *client;
+
+		if (sizeof(uint32_t) != arg_size) {
+			CAM_ERR(CAM_CDM,
+				"Invalid CDM cmd %d size=%x for handle=%x",
+				cmd, arg_size, *handle);
+			return -EINVAL;
+		}
+		idx = CAM_CDM_GET_CLIENT_IDX(*handle);
+		mutex_lock(&cdm_hw->hw_mutex);
+		client = core->clients[idx];
+		if ((!client) || (*handle != client->handle)) {
+			CAM_ERR(CAM_CDM, "Invalid client %pK hdl=%x",
+				client, *handle);
+			mutex_unlock(&cdm_hw->hw_mutex);
+			break;
+		}
+		cam_cdm_util_shadow_regs_invalidate(core->shadow);
+		mutex_unlock(&cdm_hw->hw_mutex);
+		rc = 0;
+		break;
+	}
 	case CAM_CDM_HW_INTF_DUMP_DBG_REGS:
 	{
 		uint32_t *handle = cmd_args;
@@ -37,6 +37,7 @@
 #define CAM_CDM_FIFO_LEN_REG_TAG_MASK        0xFF
 #define CAM_CDM_FIFO_LEN_REG_TAG_SHIFT       24
 #define CAM_CDM_FIFO_LEN_REG_ARB_SHIFT       20
+#define CAM_CDM_SUBMIT_BL_PREPARE_MAX        32
 
 static void cam_hw_cdm_work(struct work_struct *work);
 
@@ -1007,6 +1008,107 @@ int cam_hw_cdm_submit_debug_gen_irq(
 	return rc;
 }
 
+/**
+ * struct cam_cdm_bl_addr_cache - Last mem handle resolved while preparing
+ *                                the BLs of one request
+ *
+ * @valid        : Cache holds a resolved handle
+ * @mem_handle   : Resolved mem handle
+ * @hw_vaddr_ptr : HW address of @mem_handle
+ * @len          : Length of the buffer of @mem_handle
+ */
+struct cam_cdm_bl_addr_cache {
+	bool       valid;
+	int32_t    mem_handle;
+	dma_addr_t hw_vaddr_ptr;
+	size_t     len;
+};
+
+/**
+ * cam_hw_cdm_get_bl_hw_addr() - Validate a BL cmd and resolve the HW address
+ *                               it starts at
+ *
+ * @core       : CDM core
+ * @cdm_cmd    : BL request
+ * @i          : Index of the BL cmd in @cdm_cmd
+ * @cache      : Last resolved mem handle, BLs of a request usually share
+ *               the same command buffer so most lookups are skipped
+ * @bl_hw_addr : HW address of the BL cmd
+ *
+ * Return: 0 on success, negative error code otherwise
+ */
+static int cam_hw_cdm_get_bl_hw_addr(struct cam_cdm *core,
+	struct cam_cdm_bl_request *cdm_cmd, uint32_t i,
+	struct cam_cdm_bl_addr_cache *cache, uint32_t *bl_hw_addr)
+{
+	struct cam_cdm_bl_cmd *cmd = &cdm_cmd->cmd[i];
+	dma_addr_t hw_vaddr_ptr = 0;
+	size_t len = 0;
+	int rc;
+
+	if ((!cmd->len) || (cmd->len > CAM_CDM_MAX_BL_LENGTH)) {
+		CAM_ERR(CAM_CDM,
+			"cmd len=: %d is invalid_ent: %d, num_cmd_ent: %d",
+			cmd->len, i, cdm_cmd->cmd_arrary_count);
+		return -EINVAL;
+	}
+
+	if (cdm_cmd->type == CAM_CDM_BL_CMD_TYPE_MEM_HANDLE) {
+		if (!cache->valid ||
+			(cache->mem_handle != cmd->bl_addr.mem_handle)) {
+			rc = cam_mem_get_io_buf(cmd->bl_addr.mem_handle,
+				core->iommu_hdl.non_secure, &cache->hw_vaddr_ptr,
+				&cache->len, NULL, NULL);
+			if (rc) {
+				CAM_ERR(CAM_CDM,
+					"Getting a hwva from mem_hdl failed. rc: %d, cmd_ent: %u",
+					rc, i);
+				cache->valid = false;
+				return -EINVAL;
+			}
+			cache->mem_handle = cmd->bl_addr.mem_handle;
+			cache->valid = true;
+		}
+		hw_vaddr_ptr = cache->hw_vaddr_ptr;
+		len = cache->len;
+	} else if (cdm_cmd->type == CAM_CDM_BL_CMD_TYPE_HW_IOVA) {
+		if (!cmd->bl_addr.hw_iova) {
+			CAM_ERR(CAM_CDM, "hw_iova is null for ent: %d", i);
+			return -EINVAL;
+		}
+
+		hw_vaddr_ptr = (dma_addr_t)cmd->bl_addr.hw_iova;
+		len = cmd->len + cmd->offset;
+	} else {
+		CAM_ERR(CAM_CDM,
+			"Only mem hdl/hw va type is supported %d",
+			cdm_cmd->type);
+		return -EINVAL;
+	}
+
+	if ((!hw_vaddr_ptr) || (!len) || (len < cmd->offset)) {
+		CAM_ERR(CAM_CDM,
+			"Sanity check failed for cdm_cmd: %d, Hdl: 0x%x, len: %zu, offset: 0x%x, num_cmds: %d",
+			i, cmd->bl_addr.mem_handle, len, cmd->offset,
+			cdm_cmd->cmd_arrary_count);
+		return -EINVAL;
+	}
+
+	if ((len - cmd->offset) < cmd->len) {
+		CAM_ERR(CAM_CDM,
+			"Not enough buffer cmd offset: %u cmd length: %u",
+			cmd->offset, cmd->len);
+		return -EINVAL;
+	}
+
+	CAM_DBG(CAM_CDM, "Got the hwva: %pK, type: %u",
+		hw_vaddr_ptr, cdm_cmd->type);
+
+	*bl_hw_addr = (uint32_t)hw_vaddr_ptr + cmd->offset;
+
+	return 0;
+}
+
 int cam_hw_cdm_submit_bl(struct cam_hw_info *cdm_hw,
 	struct cam_cdm_hw_intf_cmd_submit_bl *req,
 	struct cam_cdm_client *client)
@@ -1016,6 +1118,9 @@ int cam_hw_cdm_submit_bl(struct cam_hw_info *cdm_hw,
 	struct cam_cdm_bl_request *cdm_cmd = req->data;
 	struct cam_cdm *core = (struct cam_cdm *)cdm_hw->core_info;
 	struct cam_cdm_bl_fifo *bl_fifo = NULL;
+	struct cam_cdm_bl_addr_cache addr_cache = {0};
+	uint32_t bl_hw_addr[CAM_CDM_SUBMIT_BL_PREPARE_MAX];
+	uint32_t num_prepared, hw_addr;
 	uint32_t fifo_idx = 0;
 	int write_count = 0;
 
@@ -1046,6 +1151,24 @@ int cam_hw_cdm_submit_bl(struct cam_hw_info *cdm_hw,
 			bl_fifo->bl_depth);
 	}
 
+	/*
+	 * Validate all BLs and resolve their HW addresses before taking the
+	 * FIFO lock, so handle lookups stay off the submission path and a bad
+	 * entry fails the request before any of its BLs is written. Only the
+	 * first CAM_CDM_SUBMIT_BL_PREPARE_MAX addresses are kept, the rest
+	 * are resolved again, mostly from the cache, while writing.
+	 */
+	num_prepared = min_t(uint32_t, cdm_cmd->cmd_arrary_count,
+		CAM_CDM_SUBMIT_BL_PREPARE_MAX);
+	for (i = 0; i < cdm_cmd->cmd_arrary_count; i++) {
+		rc = cam_hw_cdm_get_bl_hw_addr(core, cdm_cmd, i, &addr_cache,
+			&hw_addr);
+		if (rc)
+			goto end;
+		if (i < num_prepared)
+			bl_hw_addr[i] = hw_addr;
+	}
+
 	mutex_lock(&core->bl_fifo[fifo_idx].fifo_lock);
 	mutex_lock(&client->lock);
 
@@ -1061,18 +1184,6 @@ int cam_hw_cdm_submit_bl(struct cam_hw_info *cdm_hw,
 	}
 
 	for (i = 0; i < req->data->cmd_arrary_count ; i++) {
-		dma_addr_t hw_vaddr_ptr = 0;
-		size_t len = 0;
-
-		if ((!cdm_cmd->cmd[i].len) || (cdm_cmd->cmd[i].len > CAM_CDM_MAX_BL_LENGTH)) {
-			CAM_ERR(CAM_CDM,
-				"cmd len=: %d is invalid_ent: %d, num_cmd_ent: %d",
-				cdm_cmd->cmd[i].len, i,
-				req->data->cmd_arrary_count);
-			rc = -EINVAL;
-			break;
-		}
-
 		/*
 		 * While commands submission is ongoing, if error/reset/PF occurs, prevent
 		 * further command submission.
@@ -1098,136 +1209,95 @@ int cam_hw_cdm_submit_bl(struct cam_hw_info *cdm_hw,
 			}
 		}
 
-		if (req->data->type == CAM_CDM_BL_CMD_TYPE_MEM_HANDLE) {
-			rc = cam_mem_get_io_buf(cdm_cmd->cmd[i].bl_addr.mem_handle,
-				core->iommu_hdl.non_secure, &hw_vaddr_ptr,
-				&len, NULL, NULL);
-			if (rc) {
-				CAM_ERR(CAM_CDM,
-					"Getting a hwva from mem_hdl failed. rc: %d, cmd_ent: %u",
-					rc, i);
-				rc = -EINVAL;
-				break;
-			}
-		} else if (req->data->type == CAM_CDM_BL_CMD_TYPE_HW_IOVA) {
-			if (!cdm_cmd->cmd[i].bl_addr.hw_iova) {
-				CAM_ERR(CAM_CDM, "hw_iova is null for ent: %d", i);
-				rc = -EINVAL;
+		if (i < num_prepared) {
+			hw_addr = bl_hw_addr[i];
+		} else {
+			rc = cam_hw_cdm_get_bl_hw_addr(core, cdm_cmd, i,
+				&addr_cache, &hw_addr);
+			if (rc)
 				break;
-			}
+		}
 
-			hw_vaddr_ptr = (dma_addr_t)cdm_cmd->cmd[i].bl_addr.hw_iova;
-			len = cdm_cmd->cmd[i].len + cdm_cmd->cmd[i].offset;
-		} else {
-			CAM_ERR(CAM_CDM,
-				"Only mem hdl/hw va type is supported %d",
-				req->data->type);
-			rc = -EINVAL;
+		rc = cam_hw_cdm_bl_write(cdm_hw, hw_addr,
+			(cdm_cmd->cmd[i].len - 1),
+			core->bl_fifo[fifo_idx].bl_tag,
+			cdm_cmd->cmd[i].arbitrate,
+			fifo_idx);
+		if (rc) {
+			CAM_ERR(CAM_CDM, "Hw bl write failed %d:%d",
+				i, req->data->cmd_arrary_count);
+			rc = -EIO;
 			break;
 		}
 
-		if ((hw_vaddr_ptr) && (len) && (len >= cdm_cmd->cmd[i].offset)) {
-			if ((len - cdm_cmd->cmd[i].offset) < cdm_cmd->cmd[i].len) {
-				CAM_ERR(CAM_CDM,
-					"Not enough buffer cmd offset: %u cmd length: %u",
-					cdm_cmd->cmd[i].offset,
-					cdm_cmd->cmd[i].len);
-				rc = -EINVAL;
-				break;
-			}
+		if (cam_hw_cdm_commit_bl_write(cdm_hw, fifo_idx)) {
+			CAM_ERR(CAM_CDM, "Commit failed for BL: %d Tag: %u",
+				i, core->bl_fifo[fifo_idx].bl_tag);
+			rc = -EIO;
+			break;
+		}
 
-			CAM_DBG(CAM_CDM, "Got the hwva: %pK, type: %u",
-				hw_vaddr_ptr, req->data->type);
+		CAM_DBG(CAM_CDM, "Commit success for BL: %d of %d, Tag: %u", (i + 1),
+			req->data->cmd_arrary_count,
+			core->bl_fifo[fifo_idx].bl_tag);
 
-			rc = cam_hw_cdm_bl_write(cdm_hw,
-				((uint32_t)hw_vaddr_ptr + cdm_cmd->cmd[i].offset),
-				(cdm_cmd->cmd[i].len - 1),
-				core->bl_fifo[fifo_idx].bl_tag,
-				cdm_cmd->cmd[i].arbitrate,
-				fifo_idx);
-			if (rc) {
-				CAM_ERR(CAM_CDM, "Hw bl write failed %d:%d",
-					i, req->data->cmd_arrary_count);
-				rc = -EIO;
-				break;
+		write_count--;
+		core->bl_fifo[fifo_idx].bl_tag++;
+		core->bl_fifo[fifo_idx].bl_tag %= (bl_fifo->bl_depth - 1);
+
+		if (cdm_cmd->cmd[i].enable_debug_gen_irq) {
+			if (write_count == 0) {
+				write_count =
+					cam_hw_cdm_wait_for_bl_fifo(cdm_hw, 1, fifo_idx);
+				if (write_count < 0) {
+					CAM_ERR(CAM_CDM, "wait for bl fifo failed %d:%d",
+						i, req->data->cmd_arrary_count);
+					rc = -EIO;
+					break;
+				}
 			}
 
-			if (cam_hw_cdm_commit_bl_write(cdm_hw, fifo_idx)) {
-				CAM_ERR(CAM_CDM, "Commit failed for BL: %d Tag: %u",
-					i, core->bl_fifo[fifo_idx].bl_tag);
-				rc = -EIO;
-				break;
+			rc = cam_hw_cdm_submit_debug_gen_irq(cdm_hw, req, fifo_idx);
+			if (!rc) {
+				CAM_DBG(CAM_CDM,
+					"Commit success for Dbg_GenIRQ_BL, Tag: %d",
+					core->bl_fifo[fifo_idx].bl_tag);
+				write_count--;
+				core->bl_fifo[fifo_idx].bl_tag++;
+				core->bl_fifo[fifo_idx].bl_tag %= (bl_fifo->bl_depth - 1);
+			} else {
+				CAM_WARN(CAM_CDM,
+					"Failed in submitting the debug gen entry. rc: %d",
+					rc);
+				continue;
 			}
+		}
 
-			CAM_DBG(CAM_CDM, "Commit success for BL: %d of %d, Tag: %u", (i + 1),
-				req->data->cmd_arrary_count,
-				core->bl_fifo[fifo_idx].bl_tag);
-
-			write_count--;
-			core->bl_fifo[fifo_idx].bl_tag++;
-			core->bl_fifo[fifo_idx].bl_tag %= (bl_fifo->bl_depth - 1);
-
-			if (cdm_cmd->cmd[i].enable_debug_gen_irq) {
-				if (write_count == 0) {
-					write_count =
-						cam_hw_cdm_wait_for_bl_fifo(cdm_hw, 1, fifo_idx);
-					if (write_count < 0) {
-						CAM_ERR(CAM_CDM, "wait for bl fifo failed %d:%d",
-							i, req->data->cmd_arrary_count);
-						rc = -EIO;
-						break;
-					}
-				}
+		if (req->data->flag && (i == (req->data->cmd_arrary_count - 1))) {
 
-				rc = cam_hw_cdm_submit_debug_gen_irq(cdm_hw, req, fifo_idx);
-				if (!rc) {
-					CAM_DBG(CAM_CDM,
-						"Commit success for Dbg_GenIRQ_BL, Tag: %d",
-						core->bl_fifo[fifo_idx].bl_tag);
-					write_count--;
-					core->bl_fifo[fifo_idx].bl_tag++;
-					core->bl_fifo[fifo_idx].bl_tag %= (bl_fifo->bl_depth - 1);
-				} else {
-					CAM_WARN(CAM_CDM,
-						"Failed in submitting the debug gen entry. rc: %d",
-						rc);
-					continue;
+			if (write_count == 0) {
+				write_count =
+					cam_hw_cdm_wait_for_bl_fifo(cdm_hw, 1, fifo_idx);
+				if (write_count < 0) {
+					CAM_ERR(CAM_CDM, "wait for bl fifo failed %d:%d",
+						i, req->data->cmd_arrary_count);
+					rc = -EIO;
+					break;
 				}
 			}
 
-			if (req->data->flag && (i == (req->data->cmd_arrary_count - 1))) {
-
-				if (write_count == 0) {
-					write_count =
-						cam_hw_cdm_wait_for_bl_fifo(cdm_hw, 1, fifo_idx);
-					if (write_count < 0) {
-						CAM_ERR(CAM_CDM, "wait for bl fifo failed %d:%d",
-							i, req->data->cmd_arrary_count);
-						rc = -EIO;
-						break;
-					}
-				}
-
-				if (core->arbitration == CAM_CDM_ARBITRATION_PRIORITY_BASED)
-					cdm_cmd->gen_irq_arb = true;
-				else
-					cdm_cmd->gen_irq_arb = false;
-
-				rc = cam_hw_cdm_submit_gen_irq(cdm_hw, req, fifo_idx);
-				if (!rc) {
-					CAM_DBG(CAM_CDM, "Commit success for GenIRQ_BL, Tag: %d",
-						core->bl_fifo[fifo_idx].bl_tag);
-					core->bl_fifo[fifo_idx].bl_tag++;
-					core->bl_fifo[fifo_idx].bl_tag %= (bl_fifo->bl_depth - 1);
-				}
+			if (core->arbitration == CAM_CDM_ARBITRATION_PRIORITY_BASED)
+				cdm_cmd->gen_irq_arb = true;
+			else
+				cdm_cmd->gen_irq_arb = false;
+
+			rc = cam_hw_cdm_submit_gen_irq(cdm_hw, req, fifo_idx);
+			if (!rc) {
+				CAM_DBG(CAM_CDM, "Commit success for GenIRQ_BL, Tag: %d",
+					core->bl_fifo[fifo_idx].bl_tag);
+				core->bl_fifo[fifo_idx].bl_tag++;
+				core->bl_fifo[fifo_idx].bl_tag %= (bl_fifo->bl_depth - 1);
 			}
-		} else {
-			CAM_ERR(CAM_CDM,
-				"Sanity check failed for cdm_cmd: %d, Hdl: 0x%x, len: %zu, offset: 0x%x, num_cmds: %d",
-				i, cdm_cmd->cmd[i].bl_addr.mem_handle, len, cdm_cmd->cmd[i].offset,
-				req->data->cmd_arrary_count);
-			rc = -EINVAL;
-			break;
 		}
 	}
 	mutex_unlock(&client->lock);
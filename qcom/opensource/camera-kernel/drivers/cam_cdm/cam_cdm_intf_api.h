@@ -13,6 +13,7 @@
 #include "cam_packet_util.h"
 
 #define CAM_CDM_BL_CMD_MAX  25
+#define CAM_CDM_ALWAYS_WRITE_MAX  12
 
 /* enum cam_cdm_id - Enum for possible CAM CDM hardwares */
 enum cam_cdm_id {
@@ -59,6 +60,18 @@ enum cam_cdm_bl_fifo_queue {
 	CAM_CDM_BL_FIFO_MAX,
 };
 
+/**
+ * struct cam_cdm_always_write_reg - Register the virtual CDM must write on
+ *                                   every replay
+ *
+ * @base_idx : Index of the register block in the acquire base_array
+ * @offset   : Offset of the register from the start of the block
+ */
+struct cam_cdm_always_write_reg {
+	uint32_t base_idx;
+	uint32_t offset;
+};
+
 /**
  * struct cam_cdm_acquire_data - Cam CDM acquire data structure
  *
@@ -90,6 +103,11 @@ enum cam_cdm_bl_fifo_queue {
  *                     util ops for this HW version of CDM acquired.
  * @handle  : Output Unique handle generated for this acquire
  * @hw_idx  : The physical CDM acquired
+ * @always_write_cnt : Input number of entries in always_write, used only
+ *                     if selected cdm is a virtual.
+ * @always_write : Input registers that trigger an action on write, like
+ *                     command, IRQ clear or reset registers. The virtual
+ *                     CDM never skips writes to them as unchanged.
  *
  */
 struct cam_cdm_acquire_data {
@@ -106,6 +124,8 @@ struct cam_cdm_acquire_data {
 	struct cam_cdm_utils_ops *ops;
 	uint32_t handle;
 	uint32_t hw_idx;
+	uint32_t always_write_cnt;
+	struct cam_cdm_always_write_reg always_write[CAM_CDM_ALWAYS_WRITE_MAX];
 };
 
 /**
@@ -267,6 +287,18 @@ int cam_cdm_stream_off(uint32_t handle);
  */
 int cam_cdm_reset_hw(uint32_t handle);
 
+/**
+ * @brief : API to drop the register values the virtual CDM remembers
+ *          from earlier replays. Clients must call it after they reset,
+ *          power collapse or program their HW directly, since those
+ *          changes bypass the CDM. It is a no-op for HW CDMs.
+ *
+ * @handle : Input handle of the CDM
+ *
+ * @return 0 on success
+ */
+int cam_cdm_invalidate_shadow(uint32_t handle);
+
 /**
  * @brief : API to publish CDM ops to HW blocks like IFE
  *
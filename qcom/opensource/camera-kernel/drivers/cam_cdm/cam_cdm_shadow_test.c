@@ -0,0 +1,478 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ * Copyright (c) 2024 Qualcomm Innovation Center, Inc. All rights reserved.
+ */
+
+#include <kunit/test.h>
+#include <linux/hash.h>
+
+#include "cam_cdm.h"
+#include "cam_cdm_core_common.h"
+#include "cam_cdm_util.h"
+#include "cam_cdm_virtual.h"
+
+/*
+ * KUnit tests for the virtual CDM shadow register cache. Command buffers are
+ * replayed through cam_cdm_util_cmd_buf_write() with a stand-in MMIO backend
+ * that logs every register and DMI write instead of touching HW, so the
+ * writes each frame saves can be counted exactly. A LUT must be uploaded
+ * again whenever the DMI config register in effect for it changes, even if
+ * the LUT itself did not.
+ */
+
+#define CAM_CDM_SHADOW_TEST_CAM_BASE      0x1000
+#define CAM_CDM_SHADOW_TEST_REG_SPACE     0x1000
+#define CAM_CDM_SHADOW_TEST_TRIGGER       0x10
+#define CAM_CDM_SHADOW_TEST_RANDOM_BASE   0x100
+#define CAM_CDM_SHADOW_TEST_NUM_RANDOM    16
+#define CAM_CDM_SHADOW_TEST_CONT_BASE     0x400
+#define CAM_CDM_SHADOW_TEST_NUM_CONT      32
+#define CAM_CDM_SHADOW_TEST_DMI_ADDR      0x800
+#define CAM_CDM_SHADOW_TEST_DMI_CFG       (CAM_CDM_SHADOW_TEST_DMI_ADDR + 0)
+#define CAM_CDM_SHADOW_TEST_DMI_LUT_ADDR  (CAM_CDM_SHADOW_TEST_DMI_ADDR + 4)
+#define CAM_CDM_SHADOW_TEST_DMI_DATA      (CAM_CDM_SHADOW_TEST_DMI_ADDR + 8)
+#define CAM_CDM_SHADOW_TEST_DMI_SEL       0x2
+#define CAM_CDM_SHADOW_TEST_DMI_BANK(b)   (0x100 | (b))
+#define CAM_CDM_SHADOW_TEST_NO_CFG        (-1)
+#define CAM_CDM_SHADOW_TEST_LUT_WORDS     16
+#define CAM_CDM_SHADOW_TEST_BUF_WORDS     256
+#define CAM_CDM_SHADOW_TEST_FRAMES        100
+
+/*
+ * Trigger register is written first and last in every frame, the DMI config
+ * and address registers right before the closing trigger
+ */
+#define CAM_CDM_SHADOW_TEST_NUM_REGS      (CAM_CDM_SHADOW_TEST_NUM_RANDOM + \
+	4 + CAM_CDM_SHADOW_TEST_NUM_CONT)
+#define CAM_CDM_SHADOW_TEST_FRAME_WRITES  (CAM_CDM_SHADOW_TEST_NUM_REGS + \
+	CAM_CDM_SHADOW_TEST_LUT_WORDS)
+
+/**
+ * struct cam_cdm_shadow_test_write - Logged register write
+ *
+ * @offset : Offset from the start of the register space
+ * @value  : Written value
+ */
+struct cam_cdm_shadow_test_write {
+	uint32_t offset;
+	uint32_t value;
+};
+
+/**
+ * struct cam_cdm_shadow_test_ctx - Shadow cache under test and its backend
+ *
+ * @shadow       : Shadow register cache under test
+ * @mmio         : Stand-in MMIO backend installed in @shadow
+ * @always_write : Always-write list of the replaying client
+ * @reg_map      : Register block the command buffers change base to
+ * @base_table   : Base table handed to the replay
+ * @ops          : Virtual CDM command builders
+ * @reg_space    : Backing store standing in for the mapped registers
+ * @cmd_buf      : Command buffer of the current frame
+ * @cmd_size     : Size of the current frame in bytes
+ * @frame_regs   : Register writes of the current frame in replay order
+ * @num_regs     : Valid entries in @frame_regs
+ * @model_addr   : Reference model of the shadow slots, addresses
+ * @model_value  : Reference model of the shadow slots, values
+ * @writes       : Logged writes of the last replay
+ * @num_writes   : Number of writes in the last replay, may exceed the log
+ */
+struct cam_cdm_shadow_test_ctx {
+	struct cam_cdm_shadow_regs *shadow;
+	struct cam_cdm_test_mmio_backend mmio;
+	struct cam_cdm_always_write_regs always_write;
+	struct cam_soc_reg_map reg_map;
+	struct cam_soc_reg_map *base_table[CAM_SOC_MAX_BLOCK];
+	struct cam_cdm_utils_ops *ops;
+	void *reg_space;
+	uint32_t *cmd_buf;
+	uint32_t cmd_size;
+	struct cam_cdm_shadow_test_write
+		frame_regs[CAM_CDM_SHADOW_TEST_NUM_REGS];
+	uint32_t num_regs;
+	void __iomem *model_addr[CAM_CDM_SHADOW_REG_NUM];
+	uint32_t model_value[CAM_CDM_SHADOW_REG_NUM];
+	struct cam_cdm_shadow_test_write
+		writes[CAM_CDM_SHADOW_TEST_FRAME_WRITES];
+	uint32_t num_writes;
+};
+
+static inline void __iomem *cam_cdm_shadow_test_addr(
+	struct cam_cdm_shadow_test_ctx *ctx, uint32_t offset)
+{
+	return ctx->reg_map.mem_base + offset;
+}
+
+static void cam_cdm_shadow_test_mmio_write(void *priv, void __iomem *addr,
+	uint32_t value)
+{
+	struct cam_cdm_shadow_test_ctx *ctx = priv;
+
+	if (ctx->num_writes < CAM_CDM_SHADOW_TEST_FRAME_WRITES) {
+		ctx->writes[ctx->num_writes].offset =
+			(uint32_t)(addr - ctx->reg_map.mem_base);
+		ctx->writes[ctx->num_writes].value = value;
+	}
+	ctx->num_writes++;
+}
+
+/*
+ * Build one frame. @bank selects the DMI config value programmed ahead of
+ * the LUT, CAM_CDM_SHADOW_TEST_NO_CFG leaves the DMI port registers to an
+ * earlier buffer.
+ */
+static void cam_cdm_shadow_test_build_frame(
+	struct cam_cdm_shadow_test_ctx *ctx, uint32_t reg_delta,
+	uint32_t lut_seed, int bank)
+{
+	uint32_t pairs[(CAM_CDM_SHADOW_TEST_NUM_RANDOM + 4) * 2];
+	uint32_t vals[CAM_CDM_SHADOW_TEST_NUM_CONT];
+	uint32_t *buf = ctx->cmd_buf;
+	uint32_t num_pairs = 0, num_regs = 0, i;
+
+	pairs[num_pairs++] = CAM_CDM_SHADOW_TEST_TRIGGER;
+	pairs[num_pairs++] = 1;
+	for (i = 0; i < CAM_CDM_SHADOW_TEST_NUM_RANDOM; i++) {
+		pairs[num_pairs++] = CAM_CDM_SHADOW_TEST_RANDOM_BASE + (i * 4);
+		pairs[num_pairs++] = 0xA000 + i + (i ? 0 : reg_delta);
+	}
+	if (bank != CAM_CDM_SHADOW_TEST_NO_CFG) {
+		pairs[num_pairs++] = CAM_CDM_SHADOW_TEST_DMI_CFG;
+		pairs[num_pairs++] = CAM_CDM_SHADOW_TEST_DMI_BANK(bank);
+		pairs[num_pairs++] = CAM_CDM_SHADOW_TEST_DMI_LUT_ADDR;
+		pairs[num_pairs++] = 0;
+	}
+	pairs[num_pairs++] = CAM_CDM_SHADOW_TEST_TRIGGER;
+	pairs[num_pairs++] = 1;
+	for (i = 0; i < num_pairs; i += 2) {
+		ctx->frame_regs[num_regs].offset = pairs[i];
+		ctx->frame_regs[num_regs++].value = pairs[i + 1];
+	}
+
+	for (i = 0; i < CAM_CDM_SHADOW_TEST_NUM_CONT; i++) {
+		vals[i] = 0xB000 + i;
+		ctx->frame_regs[num_regs].offset =
+			CAM_CDM_SHADOW_TEST_CONT_BASE + (i * 4);
+		ctx->frame_regs[num_regs++].value = vals[i];
+	}
+	ctx->num_regs = num_regs;
+
+	buf = ctx->ops->cdm_write_changebase(buf,
+		CAM_CDM_SHADOW_TEST_CAM_BASE);
+	buf = ctx->ops->cdm_write_regrandom(buf, num_pairs / 2, pairs);
+	buf = ctx->ops->cdm_write_regcontinuous(buf,
+		CAM_CDM_SHADOW_TEST_CONT_BASE, CAM_CDM_SHADOW_TEST_NUM_CONT,
+		vals);
+	/* The virtual CDM takes the LUT inline, right after the header */
+	buf = ctx->ops->cdm_write_dmi(buf, 0, CAM_CDM_SHADOW_TEST_DMI_ADDR,
+		CAM_CDM_SHADOW_TEST_DMI_SEL, 0,
+		(CAM_CDM_SHADOW_TEST_LUT_WORDS * sizeof(uint32_t)) - 1);
+	for (i = 0; i < CAM_CDM_SHADOW_TEST_LUT_WORDS; i++)
+		*buf++ = lut_seed + i;
+
+	ctx->cmd_size = (uint32_t)((buf - ctx->cmd_buf) * sizeof(uint32_t));
+}
+
+static void cam_cdm_shadow_test_model_reset(
+	struct cam_cdm_shadow_test_ctx *ctx)
+{
+	memset(ctx->model_addr, 0, sizeof(ctx->model_addr));
+	memset(ctx->model_value, 0, sizeof(ctx->model_value));
+}
+
+/*
+ * Register writes the current frame must issue. The shadow is direct mapped,
+ * so registers whose address hashes collide evict each other and are always
+ * rewritten; the model follows the same slots to keep the count exact.
+ */
+static uint32_t cam_cdm_shadow_test_model_replay(
+	struct cam_cdm_shadow_test_ctx *ctx, bool skip_unchanged)
+{
+	void __iomem *addr;
+	uint32_t slot, value, issued = 0, i;
+
+	for (i = 0; i < ctx->num_regs; i++) {
+		addr = cam_cdm_shadow_test_addr(ctx, ctx->frame_regs[i].offset);
+		value = ctx->frame_regs[i].value;
+		slot = hash_ptr((__force void *)addr,
+			CAM_CDM_SHADOW_REG_HASH_BITS);
+		if (skip_unchanged && (ctx->model_addr[slot] == addr) &&
+			(ctx->model_value[slot] == value) &&
+			(ctx->frame_regs[i].offset !=
+			CAM_CDM_SHADOW_TEST_TRIGGER))
+			continue;
+
+		ctx->model_addr[slot] = addr;
+		ctx->model_value[slot] = value;
+		issued++;
+	}
+
+	return issued;
+}
+
+static int cam_cdm_shadow_test_replay(struct cam_cdm_shadow_test_ctx *ctx)
+{
+	void __iomem *device_base = NULL;
+
+	ctx->num_writes = 0;
+	return cam_cdm_util_cmd_buf_write(&device_base, ctx->cmd_buf,
+		ctx->cmd_size, ctx->base_table, 1, 0, ctx->shadow,
+		&ctx->always_write);
+}
+
+static uint32_t cam_cdm_shadow_test_count(struct cam_cdm_shadow_test_ctx *ctx,
+	uint32_t offset)
+{
+	uint32_t i, count = 0;
+
+	for (i = 0; i < min_t(uint32_t, ctx->num_writes,
+		CAM_CDM_SHADOW_TEST_FRAME_WRITES); i++) {
+		if (ctx->writes[i].offset == offset)
+			count++;
+	}
+
+	return count;
+}
+
+static int cam_cdm_shadow_test_init(struct kunit *test)
+{
+	struct cam_cdm_shadow_test_ctx *ctx;
+	struct cam_hw_version version = { .major = 1 };
+
+	ctx = kunit_kzalloc(test, sizeof(*ctx), GFP_KERNEL);
+	KUNIT_ASSERT_NOT_NULL(test, ctx);
+	ctx->shadow = kunit_kzalloc(test, sizeof(*ctx->shadow), GFP_KERNEL);
+	KUNIT_ASSERT_NOT_NULL(test, ctx->shadow);
+	ctx->reg_space = kunit_kzalloc(test, CAM_CDM_SHADOW_TEST_REG_SPACE,
+		GFP_KERNEL);
+	KUNIT_ASSERT_NOT_NULL(test, ctx->reg_space);
+	ctx->cmd_buf = kunit_kcalloc(test, CAM_CDM_SHADOW_TEST_BUF_WORDS,
+		sizeof(uint32_t), GFP_KERNEL);
+	KUNIT_ASSERT_NOT_NULL(test, ctx->cmd_buf);
+
+	ctx->ops = cam_cdm_get_ops(0, &version, true);
+	KUNIT_ASSERT_NOT_NULL(test, ctx->ops);
+
+	/* Never dereferenced, every replay write goes to the backend */
+	ctx->reg_map.mem_base = (__force void __iomem *)ctx->reg_space;
+	ctx->reg_map.mem_cam_base = CAM_CDM_SHADOW_TEST_CAM_BASE;
+	ctx->reg_map.size = CAM_CDM_SHADOW_TEST_REG_SPACE;
+	ctx->base_table[0] = &ctx->reg_map;
+
+	ctx->always_write.addr[0] = cam_cdm_shadow_test_addr(ctx,
+		CAM_CDM_SHADOW_TEST_TRIGGER);
+	ctx->always_write.num = 1;
+
+	mutex_init(&ctx->shadow->lock);
+	ctx->mmio.write = cam_cdm_shadow_test_mmio_write;
+	ctx->mmio.priv = ctx;
+	ctx->shadow->test_mmio = &ctx->mmio;
+
+	test->priv = ctx;
+	return 0;
+}
+
+static void cam_cdm_shadow_test_exit(struct kunit *test)
+{
+	struct cam_cdm_shadow_test_ctx *ctx = test->priv;
+
+	mutex_destroy(&ctx->shadow->lock);
+}
+
+static void cam_cdm_shadow_test_repeat_frame(struct kunit *test)
+{
+	struct cam_cdm_shadow_test_ctx *ctx = test->priv;
+	uint32_t expected, saved = 0, i;
+
+	cam_cdm_shadow_test_build_frame(ctx, 0, 0x100, 0);
+
+	/* First replay writes everything, the LUT is new */
+	KUNIT_ASSERT_EQ(test, cam_cdm_shadow_test_replay(ctx), 0);
+	KUNIT_EXPECT_EQ(test, ctx->num_writes,
+		(uint32_t)CAM_CDM_SHADOW_TEST_FRAME_WRITES);
+	cam_cdm_shadow_test_model_reset(ctx);
+	cam_cdm_shadow_test_model_replay(ctx, false);
+
+	for (i = 0; i < CAM_CDM_SHADOW_TEST_FRAMES; i++) {
+		expected = cam_cdm_shadow_test_model_replay(ctx, true);
+		KUNIT_ASSERT_EQ(test, cam_cdm_shadow_test_replay(ctx), 0);
+		KUNIT_EXPECT_EQ(test, ctx->num_writes, expected);
+		KUNIT_EXPECT_EQ(test, cam_cdm_shadow_test_count(ctx,
+			CAM_CDM_SHADOW_TEST_DMI_DATA), 0);
+		/* Both trigger writes go out even though nothing changed */
+		KUNIT_EXPECT_EQ(test, cam_cdm_shadow_test_count(ctx,
+			CAM_CDM_SHADOW_TEST_TRIGGER), 2);
+		saved += CAM_CDM_SHADOW_TEST_FRAME_WRITES - ctx->num_writes;
+	}
+
+	KUNIT_EXPECT_EQ(test, ctx->shadow->dmi_skipped,
+		(uint64_t)CAM_CDM_SHADOW_TEST_FRAMES);
+	kunit_info(test, "%u of %u writes saved per repeated frame\n",
+		saved / CAM_CDM_SHADOW_TEST_FRAMES,
+		CAM_CDM_SHADOW_TEST_FRAME_WRITES);
+}
+
+static void cam_cdm_shadow_test_changed_reg(struct kunit *test)
+{
+	struct cam_cdm_shadow_test_ctx *ctx = test->priv;
+	uint32_t expected, i;
+
+	cam_cdm_shadow_test_build_frame(ctx, 0, 0x100, 0);
+	KUNIT_ASSERT_EQ(test, cam_cdm_shadow_test_replay(ctx), 0);
+	cam_cdm_shadow_test_model_reset(ctx);
+	cam_cdm_shadow_test_model_replay(ctx, false);
+
+	cam_cdm_shadow_test_build_frame(ctx, 1, 0x100, 0);
+	expected = cam_cdm_shadow_test_model_replay(ctx, true);
+	KUNIT_ASSERT_EQ(test, cam_cdm_shadow_test_replay(ctx), 0);
+	KUNIT_EXPECT_EQ(test, ctx->num_writes, expected);
+
+	/* The changed register must be among the writes, with its new value */
+	for (i = 0; i < ctx->num_writes; i++) {
+		if (ctx->writes[i].offset == CAM_CDM_SHADOW_TEST_RANDOM_BASE)
+			break;
+	}
+	KUNIT_ASSERT_LT(test, i, ctx->num_writes);
+	KUNIT_EXPECT_EQ(test, ctx->writes[i].value, 0xA001);
+}
+
+static void cam_cdm_shadow_test_changed_lut(struct kunit *test)
+{
+	struct cam_cdm_shadow_test_ctx *ctx = test->priv;
+
+	cam_cdm_shadow_test_build_frame(ctx, 0, 0x100, 0);
+	KUNIT_ASSERT_EQ(test, cam_cdm_shadow_test_replay(ctx), 0);
+
+	/* A new LUT needs its DMI config registers, the whole frame goes out */
+	cam_cdm_shadow_test_build_frame(ctx, 0, 0x200, 0);
+	KUNIT_ASSERT_EQ(test, cam_cdm_shadow_test_replay(ctx), 0);
+	KUNIT_EXPECT_EQ(test, ctx->num_writes,
+		(uint32_t)CAM_CDM_SHADOW_TEST_FRAME_WRITES);
+	KUNIT_EXPECT_EQ(test, cam_cdm_shadow_test_count(ctx,
+		CAM_CDM_SHADOW_TEST_DMI_DATA),
+		(uint32_t)CAM_CDM_SHADOW_TEST_LUT_WORDS);
+}
+
+static void cam_cdm_shadow_test_lut_other_bank(struct kunit *test)
+{
+	struct cam_cdm_shadow_test_ctx *ctx = test->priv;
+	int bank[] = { 0, 0, 1, 1, 0 };
+	bool upload[] = { true, false, true, false, true };
+	uint32_t i;
+
+	/* Same LUT every frame, only the bank it is uploaded to changes */
+	for (i = 0; i < ARRAY_SIZE(bank); i++) {
+		cam_cdm_shadow_test_build_frame(ctx, 0, 0x100, bank[i]);
+		KUNIT_ASSERT_EQ(test, cam_cdm_shadow_test_replay(ctx), 0);
+		KUNIT_EXPECT_EQ_MSG(test, cam_cdm_shadow_test_count(ctx,
+			CAM_CDM_SHADOW_TEST_DMI_DATA), upload[i] ?
+			(uint32_t)CAM_CDM_SHADOW_TEST_LUT_WORDS : 0,
+			"frame %u bank %d", i, bank[i]);
+	}
+}
+
+static void cam_cdm_shadow_test_bank_from_earlier_buf(struct kunit *test)
+{
+	struct cam_cdm_shadow_test_ctx *ctx = test->priv;
+	uint32_t pair[2] = { CAM_CDM_SHADOW_TEST_DMI_CFG,
+		CAM_CDM_SHADOW_TEST_DMI_BANK(1) };
+	uint32_t *buf;
+
+	cam_cdm_shadow_test_build_frame(ctx, 0, 0x100, 0);
+	KUNIT_ASSERT_EQ(test, cam_cdm_shadow_test_replay(ctx), 0);
+
+	/* Frames that rely on the port registers an earlier buffer left */
+	cam_cdm_shadow_test_build_frame(ctx, 0, 0x100,
+		CAM_CDM_SHADOW_TEST_NO_CFG);
+	KUNIT_ASSERT_EQ(test, cam_cdm_shadow_test_replay(ctx), 0);
+	KUNIT_EXPECT_EQ(test, cam_cdm_shadow_test_count(ctx,
+		CAM_CDM_SHADOW_TEST_DMI_DATA), 0);
+
+	/* A buffer without any LUT moves the port to the other bank */
+	buf = ctx->ops->cdm_write_changebase(ctx->cmd_buf,
+		CAM_CDM_SHADOW_TEST_CAM_BASE);
+	buf = ctx->ops->cdm_write_regrandom(buf, 1, pair);
+	ctx->cmd_size = (uint32_t)((buf - ctx->cmd_buf) * sizeof(uint32_t));
+	KUNIT_ASSERT_EQ(test, cam_cdm_shadow_test_replay(ctx), 0);
+	KUNIT_EXPECT_EQ(test, cam_cdm_shadow_test_count(ctx,
+		CAM_CDM_SHADOW_TEST_DMI_CFG), 1);
+
+	cam_cdm_shadow_test_build_frame(ctx, 0, 0x100,
+		CAM_CDM_SHADOW_TEST_NO_CFG);
+	KUNIT_ASSERT_EQ(test, cam_cdm_shadow_test_replay(ctx), 0);
+	KUNIT_EXPECT_EQ(test, cam_cdm_shadow_test_count(ctx,
+		CAM_CDM_SHADOW_TEST_DMI_DATA),
+		(uint32_t)CAM_CDM_SHADOW_TEST_LUT_WORDS);
+	KUNIT_EXPECT_EQ(test, ctx->num_writes,
+		ctx->num_regs + CAM_CDM_SHADOW_TEST_LUT_WORDS);
+}
+
+static void cam_cdm_shadow_test_invalidate(struct kunit *test)
+{
+	struct cam_cdm_shadow_test_ctx *ctx = test->priv;
+
+	cam_cdm_shadow_test_build_frame(ctx, 0, 0x100, 0);
+	KUNIT_ASSERT_EQ(test, cam_cdm_shadow_test_replay(ctx), 0);
+	KUNIT_ASSERT_EQ(test, cam_cdm_shadow_test_replay(ctx), 0);
+	KUNIT_ASSERT_LT(test, ctx->num_writes,
+		(uint32_t)CAM_CDM_SHADOW_TEST_FRAME_WRITES);
+
+	/* What a client does after resetting or power collapsing its HW */
+	cam_cdm_util_shadow_regs_invalidate(ctx->shadow);
+	KUNIT_ASSERT_EQ(test, cam_cdm_shadow_test_replay(ctx), 0);
+	KUNIT_EXPECT_EQ(test, ctx->num_writes,
+		(uint32_t)CAM_CDM_SHADOW_TEST_FRAME_WRITES);
+}
+
+static void cam_cdm_shadow_test_truncated(struct kunit *test)
+{
+	struct cam_cdm_shadow_test_ctx *ctx = test->priv;
+	void __iomem *device_base = cam_cdm_shadow_test_addr(ctx, 0);
+	uint32_t pair[2] = { CAM_CDM_SHADOW_TEST_TRIGGER, 1 };
+	uint8_t *short_buf;
+
+	/* Seed the shadow so a failed replay has something to drop */
+	cam_cdm_shadow_test_build_frame(ctx, 0, 0x100, 0);
+	KUNIT_ASSERT_EQ(test, cam_cdm_shadow_test_replay(ctx), 0);
+	KUNIT_ASSERT_TRUE(test, ctx->shadow->valid);
+
+	/* Shorter than a REG_RANDOM header, KASAN flags any overread */
+	short_buf = kunit_kzalloc(test, 2, GFP_KERNEL);
+	KUNIT_ASSERT_NOT_NULL(test, short_buf);
+	ctx->ops->cdm_write_regrandom(ctx->cmd_buf, 1, pair);
+	memcpy(short_buf, ctx->cmd_buf, 2);
+
+	ctx->num_writes = 0;
+	KUNIT_EXPECT_EQ(test, cam_cdm_util_cmd_buf_write(&device_base,
+		(uint32_t *)short_buf, 2, ctx->base_table, 1, 0, ctx->shadow,
+		&ctx->always_write), -EINVAL);
+	KUNIT_EXPECT_EQ(test, ctx->num_writes, 0);
+	KUNIT_EXPECT_FALSE(test, ctx->shadow->valid);
+
+	/* Header fits but the count runs past the end of the buffer */
+	ctx->ops->cdm_write_regrandom(ctx->cmd_buf, 1, pair);
+	KUNIT_EXPECT_EQ(test, cam_cdm_util_cmd_buf_write(&device_base,
+		ctx->cmd_buf, sizeof(uint32_t), ctx->base_table, 1, 0,
+		ctx->shadow, &ctx->always_write), -EINVAL);
+	KUNIT_EXPECT_EQ(test, ctx->num_writes, 0);
+}
+
+static struct kunit_case cam_cdm_shadow_test_cases[] = {
+	KUNIT_CASE(cam_cdm_shadow_test_repeat_frame),
+	KUNIT_CASE(cam_cdm_shadow_test_changed_reg),
+	KUNIT_CASE(cam_cdm_shadow_test_changed_lut),
+	KUNIT_CASE(cam_cdm_shadow_test_lut_other_bank),
+	KUNIT_CASE(cam_cdm_shadow_test_bank_from_earlier_buf),
+	KUNIT_CASE(cam_cdm_shadow_test_invalidate),
+	KUNIT_CASE(cam_cdm_shadow_test_truncated),
+	{}
+};
+
+static struct kunit_suite cam_cdm_shadow_test_suite = {
+	.name = "cam_cdm_shadow",
+	.init = cam_cdm_shadow_test_init,
+	.exit = cam_cdm_shadow_test_exit,
+	.test_cases = cam_cdm_shadow_test_cases,
+};
+
+kunit_test_suite(cam_cdm_shadow_test_suite);
@@ -28,6 +28,13 @@ bool cam_cdm_read_hw_reg(struct cam_hw_info *cdm_hw,
 		cdm_hw->soc_info.reg_map[CAM_HW_CDM_BASE_INDEX].mem_base;
 	resource_size_t mem_len =
 		cdm_hw->soc_info.reg_map[CAM_HW_CDM_BASE_INDEX].size;
+#ifdef CONFIG_SPECTRA_KUNIT_TEST
+	struct cam_cdm *core = (struct cam_cdm *)cdm_hw->core_info;
+
+	if (core && core->test_regs)
+		return core->test_regs->read(core->test_regs->priv, reg,
+			value);
+#endif
 
 	CAM_DBG(CAM_CDM, "E: b=%pK blen=%d off=%x", (void __iomem *)base,
 		(int)mem_len, reg);
@@ -58,6 +65,13 @@ bool cam_cdm_write_hw_reg(struct cam_hw_info *cdm_hw,
 		cdm_hw->soc_info.reg_map[CAM_HW_CDM_BASE_INDEX].mem_base;
 	resource_size_t mem_len =
 		cdm_hw->soc_info.reg_map[CAM_HW_CDM_BASE_INDEX].size;
+#ifdef CONFIG_SPECTRA_KUNIT_TEST
+	struct cam_cdm *core = (struct cam_cdm *)cdm_hw->core_info;
+
+	if (core && core->test_regs)
+		return core->test_regs->write(core->test_regs->priv, reg,
+			value);
+#endif
 
 	CAM_DBG(CAM_CDM, "E: b=%pK off=%x val=%x", (void __iomem *)base,
 		reg, value);
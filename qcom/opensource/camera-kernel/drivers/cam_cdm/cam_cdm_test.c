@@ -0,0 +1,323 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ * Copyright (c) 2024 Qualcomm Innovation Center, Inc. All rights reserved.
+ */
+
+#include <kunit/test.h>
+
+#include "cam_cdm.h"
+#include "cam_cdm_core_common.h"
+#include "cam_cdm_util.h"
+
+/*
+ * KUnit tests for BL submission on a HW CDM. The CDM registers are replaced
+ * by a stand-in backend that logs every write and reports a configurable
+ * number of pending BLs, so submissions can be checked register by register
+ * and timed without the CDM, its clocks or the SMMU.
+ */
+
+#define CAM_CDM_TEST_BL_DEPTH         64
+#define CAM_CDM_TEST_MAX_BLS          (CAM_CDM_TEST_BL_DEPTH - 1)
+#define CAM_CDM_TEST_MAX_WRITES       (CAM_CDM_TEST_MAX_BLS * 3)
+#define CAM_CDM_TEST_IOVA             0x10000000
+#define CAM_CDM_TEST_IOVA_STRIDE      0x1000
+#define CAM_CDM_TEST_BL_OFFSET        0x40
+#define CAM_CDM_TEST_BL_LEN           0x200
+#define CAM_CDM_TEST_BENCH_ITERS      1000
+
+/* Must match the BL_FIFO_LEN layout used by cam_hw_cdm_bl_write() */
+#define CAM_CDM_TEST_LEN_MASK         0xFFFFF
+#define CAM_CDM_TEST_TAG_MASK         0xFF
+#define CAM_CDM_TEST_TAG_SHIFT        24
+#define CAM_CDM_TEST_MAX_BL_LENGTH    0x100000
+
+extern struct cam_cdm_hw_reg_offset cam_cdm_2_1_reg_offset;
+
+/**
+ * struct cam_cdm_test_write - Logged register write
+ *
+ * @reg   : Register offset
+ * @value : Written value
+ */
+struct cam_cdm_test_write {
+	uint32_t reg;
+	uint32_t value;
+};
+
+/**
+ * struct cam_cdm_test_ctx - Stand-in CDM and its register backend
+ *
+ * @hw          : CDM HW info handed to the submit path
+ * @core        : CDM core of @hw
+ * @client      : Client submitting on BL FIFO 0
+ * @backend     : Stand-in register backend installed in @core
+ * @genirq_buff : GenIRQ command buffer, only its size is checked
+ * @writes      : Logged register writes
+ * @num_writes  : Number of writes since the last reset, may exceed the log
+ * @num_reads   : Number of register reads since the last reset
+ * @pending     : Pending BLs reported for FIFO 0
+ */
+struct cam_cdm_test_ctx {
+	struct cam_hw_info hw;
+	struct cam_cdm core;
+	struct cam_cdm_client client;
+	struct cam_cdm_test_reg_backend backend;
+	struct cam_kmd_buf_info genirq_buff;
+	struct cam_cdm_test_write writes[CAM_CDM_TEST_MAX_WRITES];
+	uint32_t num_writes;
+	uint32_t num_reads;
+	uint32_t pending;
+};
+
+static bool cam_cdm_test_reg_read(void *priv, uint32_t reg, uint32_t *value)
+{
+	struct cam_cdm_test_ctx *ctx = priv;
+
+	ctx->num_reads++;
+	if (reg == ctx->core.offsets->cmn_reg->pending_req[0]->rb_offset)
+		*value = ctx->pending;
+	else
+		*value = 0;
+
+	return false;
+}
+
+static bool cam_cdm_test_reg_write(void *priv, uint32_t reg, uint32_t value)
+{
+	struct cam_cdm_test_ctx *ctx = priv;
+
+	if (ctx->num_writes < CAM_CDM_TEST_MAX_WRITES) {
+		ctx->writes[ctx->num_writes].reg = reg;
+		ctx->writes[ctx->num_writes].value = value;
+	}
+	ctx->num_writes++;
+
+	return false;
+}
+
+static void cam_cdm_test_reset_log(struct cam_cdm_test_ctx *ctx)
+{
+	ctx->num_writes = 0;
+	ctx->num_reads = 0;
+}
+
+static struct cam_cdm_bl_request *cam_cdm_test_alloc_req(struct kunit *test,
+	uint32_t num_bls)
+{
+	struct cam_cdm_test_ctx *ctx = test->priv;
+	struct cam_cdm_bl_request *cdm_cmd;
+	uint32_t i;
+
+	cdm_cmd = kunit_kzalloc(test, sizeof(*cdm_cmd) +
+		((num_bls - 1) * sizeof(struct cam_cdm_bl_cmd)), GFP_KERNEL);
+	KUNIT_ASSERT_NOT_NULL(test, cdm_cmd);
+
+	cdm_cmd->type = CAM_CDM_BL_CMD_TYPE_HW_IOVA;
+	cdm_cmd->cmd_arrary_count = num_bls;
+	cdm_cmd->genirq_buff = &ctx->genirq_buff;
+	for (i = 0; i < num_bls; i++) {
+		cdm_cmd->cmd[i].bl_addr.hw_iova = (uint32_t *)(uintptr_t)
+			(CAM_CDM_TEST_IOVA + (i * CAM_CDM_TEST_IOVA_STRIDE));
+		cdm_cmd->cmd[i].offset = CAM_CDM_TEST_BL_OFFSET;
+		cdm_cmd->cmd[i].len = CAM_CDM_TEST_BL_LEN;
+	}
+
+	return cdm_cmd;
+}
+
+static int cam_cdm_test_submit(struct cam_cdm_test_ctx *ctx,
+	struct cam_cdm_bl_request *cdm_cmd)
+{
+	struct cam_cdm_hw_intf_cmd_submit_bl req = {
+		.handle = ctx->client.handle,
+		.data = cdm_cmd,
+	};
+
+	return cam_hw_cdm_submit_bl(&ctx->hw, &req, &ctx->client);
+}
+
+static int cam_cdm_test_init(struct kunit *test)
+{
+	struct cam_cdm_test_ctx *ctx;
+
+	ctx = kunit_kzalloc(test, sizeof(*ctx), GFP_KERNEL);
+	KUNIT_ASSERT_NOT_NULL(test, ctx);
+
+	ctx->core.offsets = &cam_cdm_2_1_reg_offset;
+	ctx->core.ops = cam_cdm_get_ops(CAM_CDM210_VERSION, NULL, false);
+	KUNIT_ASSERT_NOT_NULL(test, ctx->core.ops);
+	ctx->core.bl_fifo[0].bl_depth = CAM_CDM_TEST_BL_DEPTH;
+	mutex_init(&ctx->core.bl_fifo[0].fifo_lock);
+	init_completion(&ctx->core.bl_fifo[0].bl_complete);
+
+	ctx->backend.read = cam_cdm_test_reg_read;
+	ctx->backend.write = cam_cdm_test_reg_write;
+	ctx->backend.priv = ctx;
+	ctx->core.test_regs = &ctx->backend;
+
+	ctx->hw.core_info = &ctx->core;
+	ctx->hw.soc_info.label_name = "cam_cdm_kunit";
+
+	ctx->client.handle = CAM_CDM_CREATE_CLIENT_HANDLE(0, 0, 0);
+	mutex_init(&ctx->client.lock);
+
+	ctx->genirq_buff.size = PAGE_SIZE;
+
+	test->priv = ctx;
+	return 0;
+}
+
+static void cam_cdm_test_check_bl_writes(struct kunit *test,
+	struct cam_cdm_bl_request *cdm_cmd, uint32_t first_tag)
+{
+	struct cam_cdm_test_ctx *ctx = test->priv;
+	struct cam_cdm_bl_fifo_regs *fifo_reg =
+		ctx->core.offsets->bl_fifo_reg[0];
+	struct cam_cdm_test_write *w;
+	uint32_t tag = first_tag, i;
+
+	KUNIT_ASSERT_EQ(test, ctx->num_writes, cdm_cmd->cmd_arrary_count * 3);
+
+	/* One base, one len/tag and one commit per BL, in request order */
+	for (i = 0; i < cdm_cmd->cmd_arrary_count; i++) {
+		w = &ctx->writes[i * 3];
+		KUNIT_EXPECT_EQ(test, w[0].reg, fifo_reg->bl_fifo_base);
+		KUNIT_EXPECT_EQ(test, w[0].value,
+			(uint32_t)(uintptr_t)cdm_cmd->cmd[i].bl_addr.hw_iova +
+			cdm_cmd->cmd[i].offset);
+		KUNIT_EXPECT_EQ(test, w[1].reg, fifo_reg->bl_fifo_len);
+		KUNIT_EXPECT_EQ(test, w[1].value,
+			((cdm_cmd->cmd[i].len - 1) & CAM_CDM_TEST_LEN_MASK) |
+			((tag & CAM_CDM_TEST_TAG_MASK) <<
+			CAM_CDM_TEST_TAG_SHIFT));
+		KUNIT_EXPECT_EQ(test, w[2].reg, fifo_reg->bl_fifo_store);
+		KUNIT_EXPECT_EQ(test, w[2].value, 1);
+		tag = (tag + 1) % (CAM_CDM_TEST_BL_DEPTH - 1);
+	}
+
+	KUNIT_EXPECT_EQ(test, (uint32_t)ctx->core.bl_fifo[0].bl_tag, tag);
+}
+
+static void cam_cdm_test_submit_writes(struct kunit *test)
+{
+	static const uint32_t num_bls[] = {
+		1, 8, 31, 32, 33, CAM_CDM_TEST_MAX_BLS};
+	struct cam_cdm_test_ctx *ctx = test->priv;
+	struct cam_cdm_bl_request *cdm_cmd;
+	uint32_t first_tag, i;
+
+	for (i = 0; i < ARRAY_SIZE(num_bls); i++) {
+		cdm_cmd = cam_cdm_test_alloc_req(test, num_bls[i]);
+		cam_cdm_test_reset_log(ctx);
+		first_tag = ctx->core.bl_fifo[0].bl_tag;
+
+		KUNIT_EXPECT_EQ(test, cam_cdm_test_submit(ctx, cdm_cmd), 0);
+		cam_cdm_test_check_bl_writes(test, cdm_cmd, first_tag);
+
+		/* An empty FIFO is reserved once for the whole request */
+		KUNIT_EXPECT_EQ(test, ctx->num_reads, 1);
+	}
+}
+
+static void cam_cdm_test_submit_fifo_blocks(struct kunit *test)
+{
+	struct cam_cdm_test_ctx *ctx = test->priv;
+	struct cam_cdm_bl_request *cdm_cmd;
+	uint32_t free_slots = 7, num_bls = 20;
+
+	/* FIFO space is rechecked only once each reserved block is used up */
+	ctx->pending = CAM_CDM_TEST_BL_DEPTH - 1 - free_slots;
+	cdm_cmd = cam_cdm_test_alloc_req(test, num_bls);
+	cam_cdm_test_reset_log(ctx);
+
+	KUNIT_EXPECT_EQ(test, cam_cdm_test_submit(ctx, cdm_cmd), 0);
+	cam_cdm_test_check_bl_writes(test, cdm_cmd, 0);
+	KUNIT_EXPECT_EQ(test, ctx->num_reads,
+		DIV_ROUND_UP(num_bls, free_slots));
+}
+
+static void cam_cdm_test_submit_reject(struct kunit *test)
+{
+	static const uint32_t bad_idx[] = {0, 31, 32, 39};
+	struct cam_cdm_test_ctx *ctx = test->priv;
+	struct cam_cdm_bl_request *cdm_cmd;
+	uint32_t i, j;
+
+	/*
+	 * A bad BL anywhere in the request, also past the addresses kept from
+	 * the prepare pass, fails it before any BL reaches the FIFO
+	 */
+	for (i = 0; i < ARRAY_SIZE(bad_idx); i++) {
+		for (j = 0; j < 3; j++) {
+			cdm_cmd = cam_cdm_test_alloc_req(test, 40);
+			if (j == 0)
+				cdm_cmd->cmd[bad_idx[i]].len = 0;
+			else if (j == 1)
+				cdm_cmd->cmd[bad_idx[i]].len =
+					CAM_CDM_TEST_MAX_BL_LENGTH + 1;
+			else
+				cdm_cmd->cmd[bad_idx[i]].bl_addr.hw_iova = NULL;
+
+			cam_cdm_test_reset_log(ctx);
+			KUNIT_EXPECT_EQ(test, cam_cdm_test_submit(ctx, cdm_cmd),
+				-EINVAL);
+			KUNIT_EXPECT_EQ(test, ctx->num_writes, 0);
+			KUNIT_EXPECT_EQ(test, ctx->num_reads, 0);
+			KUNIT_EXPECT_EQ(test,
+				(uint32_t)ctx->core.bl_fifo[0].bl_tag, 0);
+		}
+	}
+
+	cdm_cmd = cam_cdm_test_alloc_req(test, 4);
+	cdm_cmd->type = CAM_CDM_BL_CMD_TYPE_KERNEL_IOVA;
+	cam_cdm_test_reset_log(ctx);
+	KUNIT_EXPECT_EQ(test, cam_cdm_test_submit(ctx, cdm_cmd), -EINVAL);
+	KUNIT_EXPECT_EQ(test, ctx->num_writes, 0);
+}
+
+static void cam_cdm_test_submit_latency(struct kunit *test)
+{
+	static const uint32_t num_bls[] = {1, 8, 32, CAM_CDM_TEST_MAX_BLS};
+	struct cam_cdm_test_ctx *ctx = test->priv;
+	struct cam_cdm_bl_request *cdm_cmd;
+	uint32_t i, j, writes;
+	ktime_t start;
+	s64 elapsed_ns;
+
+	/* Software cost only, the stand-in registers are plain memory */
+	for (i = 0; i < ARRAY_SIZE(num_bls); i++) {
+		cdm_cmd = cam_cdm_test_alloc_req(test, num_bls[i]);
+		cam_cdm_test_reset_log(ctx);
+
+		start = ktime_get();
+		for (j = 0; j < CAM_CDM_TEST_BENCH_ITERS; j++) {
+			if (cam_cdm_test_submit(ctx, cdm_cmd))
+				break;
+		}
+		elapsed_ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+
+		KUNIT_EXPECT_EQ(test, j, CAM_CDM_TEST_BENCH_ITERS);
+		writes = ctx->num_writes / CAM_CDM_TEST_BENCH_ITERS;
+		KUNIT_EXPECT_EQ(test, writes, num_bls[i] * 3);
+		kunit_info(test,
+			"%u BLs: %u MMIO writes, %lld ns per request\n",
+			num_bls[i], writes,
+			div_s64(elapsed_ns, CAM_CDM_TEST_BENCH_ITERS));
+	}
+}
+
+static struct kunit_case cam_cdm_test_cases[] = {
+	KUNIT_CASE(cam_cdm_test_submit_writes),
+	KUNIT_CASE(cam_cdm_test_submit_fifo_blocks),
+	KUNIT_CASE(cam_cdm_test_submit_reject),
+	KUNIT_CASE(cam_cdm_test_submit_latency),
+	{}
+};
+
+static struct kunit_suite cam_cdm_test_suite = {
+	.name = "cam_cdm",
+	.init = cam_cdm_test_init,
+	.test_cases = cam_cdm_test_cases,
+};
+
+kunit_test_suite(cam_cdm_test_suite);
@@ -8,6 +8,9 @@
 #include <linux/kernel.h>
 #include <linux/errno.h>
 #include <linux/bug.h>
+#include <linux/hash.h>
+#include <linux/jhash.h>
+#include <linux/string.h>
 
 #include "cam_cdm_intf_api.h"
 #include "cam_cdm_util.h"
@@ -20,6 +23,8 @@
 #define CAM_CMD_LENGTH_MASK     0xFFFF
 #define CAM_CDM_REG_OFFSET_MASK 0x00FFFFFF
 
+#define CAM_CDM_DMI_CFG_OFFSET       0
+#define CAM_CDM_DMI_ADDR_OFFSET      4
 #define CAM_CDM_DMI_DATA_HI_OFFSET   8
 #define CAM_CDM_DMI_DATA_OFFSET      8
 #define CAM_CDM_DMI_DATA_LO_OFFSET   12
@@ -489,8 +494,289 @@ int cam_cdm_get_ioremap_from_base(uint32_t hw_base,
 	return ret;
 }
 
+static void cam_cdm_util_shadow_regs_reset(
+	struct cam_cdm_shadow_regs *shadow)
+{
+	memset(shadow->regs, 0, sizeof(shadow->regs));
+	memset(shadow->dmi, 0, sizeof(shadow->dmi));
+	shadow->dmi_next = 0;
+	shadow->valid = true;
+}
+
+void cam_cdm_util_shadow_regs_invalidate(struct cam_cdm_shadow_regs *shadow)
+{
+	if (!shadow)
+		return;
+
+	mutex_lock(&shadow->lock);
+	shadow->valid = false;
+	mutex_unlock(&shadow->lock);
+}
+
+static inline void cam_cdm_util_replay_io_w(
+	struct cam_cdm_shadow_regs *shadow, uint32_t value,
+	void __iomem *addr, bool mb)
+{
+#ifdef CONFIG_SPECTRA_KUNIT_TEST
+	if (shadow && shadow->test_mmio) {
+		shadow->test_mmio->write(shadow->test_mmio->priv, addr, value);
+		return;
+	}
+#endif
+	if (mb)
+		cam_io_w_mb(value, addr);
+	else
+		cam_io_w(value, addr);
+}
+
+static bool cam_cdm_util_shadow_is_always_write(
+	struct cam_cdm_shadow_regs *shadow, void __iomem *addr)
+{
+	const struct cam_cdm_always_write_regs *always_write =
+		shadow->always_write;
+	uint32_t i;
+
+	if (!always_write)
+		return false;
+
+	for (i = 0; i < always_write->num; i++) {
+		if (always_write->addr[i] == addr)
+			return true;
+	}
+
+	return false;
+}
+
+static struct cam_cdm_shadow_dmi *cam_cdm_util_shadow_dmi_find(
+	struct cam_cdm_shadow_regs *shadow, void __iomem *addr, uint32_t sel)
+{
+	uint32_t i;
+
+	for (i = 0; i < CAM_CDM_SHADOW_DMI_NUM; i++) {
+		if ((shadow->dmi[i].addr == addr) && (shadow->dmi[i].sel == sel))
+			return &shadow->dmi[i];
+	}
+
+	return NULL;
+}
+
+/*
+ * Follow a register write into the state of the known DMI ports, either the
+ * scan's copy @ctx, indexed like shadow->dmi, or the ports' own @cur.
+ */
+static void cam_cdm_util_shadow_dmi_track(struct cam_cdm_shadow_regs *shadow,
+	struct cam_cdm_shadow_dmi_ctx *ctx, void __iomem *addr, uint32_t value)
+{
+	struct cam_cdm_shadow_dmi_ctx *port_ctx;
+	void __iomem *port;
+	uint32_t i;
+
+	for (i = 0; i < CAM_CDM_SHADOW_DMI_NUM; i++) {
+		port = shadow->dmi[i].addr;
+		if (!port)
+			continue;
+
+		port_ctx = ctx ? &ctx[i] : &shadow->dmi[i].cur;
+		if (addr == (port + CAM_CDM_DMI_CFG_OFFSET)) {
+			port_ctx->cfg = value;
+			port_ctx->cfg_known = true;
+		} else if (addr == (port + CAM_CDM_DMI_ADDR_OFFSET)) {
+			port_ctx->addr = value;
+			port_ctx->addr_known = true;
+		}
+	}
+}
+
+static inline void cam_cdm_util_shadow_reg_write(
+	struct cam_cdm_shadow_regs *shadow, bool skip_unchanged,
+	uint32_t value, void __iomem *addr)
+{
+	struct cam_cdm_shadow_reg *reg;
+
+	/* Skipped or not, the value is what the port holds from now on */
+	cam_cdm_util_shadow_dmi_track(shadow, NULL, addr, value);
+
+	reg = &shadow->regs[hash_ptr((__force void *)addr,
+		CAM_CDM_SHADOW_REG_HASH_BITS)];
+	/* Trigger registers act on every write, never elide them */
+	if (skip_unchanged && (reg->addr == addr) && (reg->value == value) &&
+		!cam_cdm_util_shadow_is_always_write(shadow, addr)) {
+		shadow->writes_skipped++;
+		return;
+	}
+
+	cam_cdm_util_replay_io_w(shadow, value, addr, false);
+	reg->addr = addr;
+	reg->value = value;
+	shadow->writes_issued++;
+}
+
+static bool cam_cdm_util_shadow_dmi_ctx_equal(
+	const struct cam_cdm_shadow_dmi_ctx *a,
+	const struct cam_cdm_shadow_dmi_ctx *b)
+{
+	return a->cfg_known && a->addr_known && b->cfg_known &&
+		b->addr_known && (a->cfg == b->cfg) && (a->addr == b->addr);
+}
+
+/*
+ * Compare every DMI LUT in the command buffer against the fingerprint of the
+ * last upload through the same port, and record the new fingerprints. The
+ * fingerprint covers the DMI config and address registers in effect for the
+ * upload, since the same LUT sent to the other bank is a different upload.
+ * Those registers may be programmed anywhere before the upload, in this
+ * buffer or an earlier one, so their values are followed from what the
+ * shadow last wrote through every register write of the buffer.
+ *
+ * DMI uploads depend on registers programmed just before them in the same
+ * buffer, so unchanged register writes may only be elided if no LUT in the
+ * buffer changed. Returns true in that case.
+ */
+static bool cam_cdm_util_shadow_dmi_scan(struct cam_cdm_shadow_regs *shadow,
+	void __iomem *device_base, uint32_t *cmd_buf, uint32_t cmd_buf_size,
+	struct cam_soc_reg_map *base_table[CAM_SOC_MAX_BLOCK],
+	uint32_t base_array_size)
+{
+	struct cam_cdm_shadow_dmi_ctx ctx[CAM_CDM_SHADOW_DMI_NUM];
+	bool unchanged = true;
+	uint32_t cdm_cmd_type, used_bytes, i;
+
+	for (i = 0; i < CAM_CDM_SHADOW_DMI_NUM; i++)
+		ctx[i] = shadow->dmi[i].cur;
+
+	while (cmd_buf_size > 0) {
+		if (cmd_buf_size < CAM_CDM_DWORD)
+			return false;
+
+		cdm_cmd_type = (*cmd_buf >> CAM_CDM_COMMAND_OFFSET);
+		switch (cdm_cmd_type) {
+		case CAM_CDM_CMD_REG_CONT: {
+			struct cdm_regcontinuous_cmd *reg_cont =
+				(struct cdm_regcontinuous_cmd *)cmd_buf;
+			uint32_t *data;
+
+			if ((!device_base) || (cmd_buf_size < (CAM_CDM_DWORD *
+				cam_cdm_get_cmd_header_size(
+				CAM_CDM_CMD_REG_CONT))))
+				return false;
+			used_bytes = (reg_cont->count * sizeof(uint32_t)) +
+				(CAM_CDM_DWORD * cam_cdm_get_cmd_header_size(
+				CAM_CDM_CMD_REG_CONT));
+			if (used_bytes > cmd_buf_size)
+				return false;
+
+			data = cmd_buf + cam_cdm_get_cmd_header_size(
+				CAM_CDM_CMD_REG_CONT);
+			for (i = 0; i < reg_cont->count; i++)
+				cam_cdm_util_shadow_dmi_track(shadow, ctx,
+					device_base + reg_cont->offset +
+					(i * sizeof(uint32_t)), data[i]);
+			}
+			break;
+		case CAM_CDM_CMD_REG_RANDOM: {
+			struct cdm_regrandom_cmd *reg_random =
+				(struct cdm_regrandom_cmd *)cmd_buf;
+			uint32_t *data;
+
+			if ((!device_base) || (cmd_buf_size < (CAM_CDM_DWORD *
+				cam_cdm_get_cmd_header_size(
+				CAM_CDM_CMD_REG_RANDOM))))
+				return false;
+			used_bytes = (reg_random->count *
+				(sizeof(uint32_t) * 2)) +
+				(CAM_CDM_DWORD * cam_cdm_get_cmd_header_size(
+				CAM_CDM_CMD_REG_RANDOM));
+			if (used_bytes > cmd_buf_size)
+				return false;
+
+			data = cmd_buf + cam_cdm_get_cmd_header_size(
+				CAM_CDM_CMD_REG_RANDOM);
+			for (i = 0; i < reg_random->count; i++)
+				cam_cdm_util_shadow_dmi_track(shadow, ctx,
+					device_base + data[2 * i],
+					data[(2 * i) + 1]);
+			}
+			break;
+		case CAM_CDM_CMD_DMI:
+		case CAM_CDM_CMD_SWD_DMI_32:
+		case CAM_CDM_CMD_SWD_DMI_64: {
+			struct cdm_dmi_cmd *swd_dmi =
+				(struct cdm_dmi_cmd *)cmd_buf;
+			struct cam_cdm_shadow_dmi *dmi;
+			void __iomem *addr;
+			uint32_t *data, sel, num_words;
+			uint64_t hash;
+
+			if ((!device_base) || (cmd_buf_size < (CAM_CDM_DWORD *
+				cam_cdm_required_size_dmi())))
+				return false;
+			used_bytes = (CAM_CDM_DWORD *
+				cam_cdm_required_size_dmi()) +
+				swd_dmi->length + 1;
+			if (used_bytes > cmd_buf_size)
+				return false;
+
+			addr = device_base + swd_dmi->DMIAddr;
+			sel = (swd_dmi->DMISel << 8) | cdm_cmd_type;
+			data = cmd_buf + cam_cdm_required_size_dmi();
+			num_words = (swd_dmi->length + 1) / CAM_CDM_DWORD;
+			hash = ((uint64_t)jhash2(data, num_words, 0) << 32) |
+				jhash2(data, num_words, swd_dmi->length);
+
+			dmi = cam_cdm_util_shadow_dmi_find(shadow, addr, sel);
+			if (dmi && (dmi->length == swd_dmi->length) &&
+				(dmi->hash == hash) &&
+				cam_cdm_util_shadow_dmi_ctx_equal(&dmi->ctx,
+				&ctx[dmi - shadow->dmi]))
+				break;
+
+			if (!dmi) {
+				i = shadow->dmi_next;
+				dmi = &shadow->dmi[i];
+				shadow->dmi_next = (i + 1) %
+					CAM_CDM_SHADOW_DMI_NUM;
+				/* Writes to a new port before here were missed */
+				memset(dmi, 0, sizeof(*dmi));
+				memset(&ctx[i], 0, sizeof(ctx[i]));
+			}
+			dmi->addr = addr;
+			dmi->sel = sel;
+			dmi->length = swd_dmi->length;
+			dmi->hash = hash;
+			/* Recorded by the replay once the upload is issued */
+			memset(&dmi->ctx, 0, sizeof(dmi->ctx));
+			unchanged = false;
+			}
+			break;
+		case CAM_CDM_CMD_CHANGE_BASE: {
+			struct cdm_changebase_cmd *change_base_cmd =
+				(struct cdm_changebase_cmd *)cmd_buf;
+
+			if (cam_cdm_get_ioremap_from_base(
+				change_base_cmd->base, base_array_size,
+				base_table, &device_base))
+				return false;
+			used_bytes = CAM_CDM_DWORD *
+				cam_cdm_required_size_changebase();
+			}
+			break;
+		default:
+			return false;
+		}
+
+		if ((!used_bytes) || (used_bytes > cmd_buf_size))
+			return false;
+
+		cmd_buf_size -= used_bytes;
+		cmd_buf += used_bytes / CAM_CDM_DWORD;
+	}
+
+	return unchanged;
+}
+
 static int cam_cdm_util_reg_cont_write(void __iomem *base_addr,
-	uint32_t *cmd_buf, uint32_t cmd_buf_size, uint32_t *used_bytes)
+	uint32_t *cmd_buf, uint32_t cmd_buf_size, uint32_t *used_bytes,
+	struct cam_cdm_shadow_regs *shadow, bool skip_unchanged)
 {
 	int ret = 0;
 	uint32_t *data;
@@ -512,8 +798,17 @@ static int cam_cdm_util_reg_cont_write(void __iomem *base_addr,
 		return -EINVAL;
 	}
 	data = cmd_buf + cam_cdm_get_cmd_header_size(CAM_CDM_CMD_REG_CONT);
-	cam_io_memcpy(base_addr + reg_cont->offset,	data,
-		reg_cont->count * sizeof(uint32_t));
+	if (shadow) {
+		uint32_t i;
+
+		for (i = 0; i < reg_cont->count; i++)
+			cam_cdm_util_shadow_reg_write(shadow, skip_unchanged,
+				data[i], base_addr + reg_cont->offset +
+				(i * sizeof(uint32_t)));
+	} else {
+		cam_io_memcpy(base_addr + reg_cont->offset, data,
+			reg_cont->count * sizeof(uint32_t));
+	}
 
 	*used_bytes = (reg_cont->count * sizeof(uint32_t)) +
 		(4 * cam_cdm_get_cmd_header_size(CAM_CDM_CMD_REG_CONT));
@@ -522,14 +817,17 @@ static int cam_cdm_util_reg_cont_write(void __iomem *base_addr,
 }
 
 static int cam_cdm_util_reg_random_write(void __iomem *base_addr,
-	uint32_t *cmd_buf, uint32_t cmd_buf_size, uint32_t *used_bytes)
+	uint32_t *cmd_buf, uint32_t cmd_buf_size, uint32_t *used_bytes,
+	struct cam_cdm_shadow_regs *shadow, bool skip_unchanged)
 {
 	uint32_t i;
 	struct cdm_regrandom_cmd *reg_random;
 	uint32_t *data;
 
-	if (!base_addr) {
-		CAM_ERR(CAM_CDM, "invalid base address");
+	if ((!base_addr) || (cmd_buf_size < (CAM_CDM_DWORD *
+		cam_cdm_get_cmd_header_size(CAM_CDM_CMD_REG_RANDOM)))) {
+		CAM_ERR(CAM_CDM, "invalid base addr and data length %d %pK",
+			cmd_buf_size, base_addr);
 		return -EINVAL;
 	}
 
@@ -547,7 +845,11 @@ static int cam_cdm_util_reg_random_write(void __iomem *base_addr,
 		CAM_DBG(CAM_CDM, "reg random: offset %pK, value 0x%x",
 			((void __iomem *)(base_addr + data[0])),
 			data[1]);
-		cam_io_w(data[1], base_addr + data[0]);
+		if (shadow)
+			cam_cdm_util_shadow_reg_write(shadow, skip_unchanged,
+				data[1], base_addr + data[0]);
+		else
+			cam_io_w(data[1], base_addr + data[0]);
 		data += 2;
 	}
 
@@ -559,7 +861,8 @@ static int cam_cdm_util_reg_random_write(void __iomem *base_addr,
 
 static int cam_cdm_util_swd_dmi_write(uint32_t cdm_cmd_type,
 	void __iomem *base_addr, uint32_t *cmd_buf, uint32_t cmd_buf_size,
-	uint32_t *used_bytes)
+	uint32_t *used_bytes, struct cam_cdm_shadow_regs *shadow,
+	bool skip_unchanged)
 {
 	uint32_t i;
 	struct cdm_dmi_cmd *swd_dmi;
@@ -573,29 +876,52 @@ static int cam_cdm_util_swd_dmi_write(uint32_t cdm_cmd_type,
 		return -EINVAL;
 	}
 	data = cmd_buf + cam_cdm_required_size_dmi();
+	*used_bytes = (4 * cam_cdm_required_size_dmi()) + swd_dmi->length + 1;
+
+	if (shadow) {
+		struct cam_cdm_shadow_dmi *dmi;
+		void __iomem *port = base_addr + swd_dmi->DMIAddr;
+
+		/* LUT fingerprint was already recorded by the DMI scan */
+		if (skip_unchanged) {
+			shadow->writes_skipped += (swd_dmi->length + 1) / 4;
+			shadow->dmi_skipped++;
+			return 0;
+		}
+		shadow->writes_issued += (swd_dmi->length + 1) / 4;
+
+		/* Port registers written before this upload are in @cur */
+		dmi = cam_cdm_util_shadow_dmi_find(shadow, port,
+			(swd_dmi->DMISel << 8) | cdm_cmd_type);
+		if (dmi)
+			dmi->ctx = dmi->cur;
+	}
 
 	if (cdm_cmd_type == CAM_CDM_CMD_SWD_DMI_64) {
 		for (i = 0; i < (swd_dmi->length + 1)/8; i++) {
-			cam_io_w_mb(data[0], base_addr +
-				swd_dmi->DMIAddr + CAM_CDM_DMI_DATA_LO_OFFSET);
-			cam_io_w_mb(data[1], base_addr +
-				swd_dmi->DMIAddr + CAM_CDM_DMI_DATA_HI_OFFSET);
+			cam_cdm_util_replay_io_w(shadow, data[0], base_addr +
+				swd_dmi->DMIAddr + CAM_CDM_DMI_DATA_LO_OFFSET,
+				true);
+			cam_cdm_util_replay_io_w(shadow, data[1], base_addr +
+				swd_dmi->DMIAddr + CAM_CDM_DMI_DATA_HI_OFFSET,
+				true);
 			data += 2;
 		}
 	} else if (cdm_cmd_type == CAM_CDM_CMD_DMI) {
 		for (i = 0; i < (swd_dmi->length + 1)/4; i++) {
-			cam_io_w_mb(data[0], base_addr +
-				swd_dmi->DMIAddr + CAM_CDM_DMI_DATA_OFFSET);
+			cam_cdm_util_replay_io_w(shadow, data[0], base_addr +
+				swd_dmi->DMIAddr + CAM_CDM_DMI_DATA_OFFSET,
+				true);
 			data += 1;
 		}
 	} else {
 		for (i = 0; i < (swd_dmi->length + 1)/4; i++) {
-			cam_io_w_mb(data[0], base_addr +
-				swd_dmi->DMIAddr + CAM_CDM_DMI_DATA_LO_OFFSET);
+			cam_cdm_util_replay_io_w(shadow, data[0], base_addr +
+				swd_dmi->DMIAddr + CAM_CDM_DMI_DATA_LO_OFFSET,
+				true);
 			data += 1;
 		}
 	}
-	*used_bytes = (4 * cam_cdm_required_size_dmi()) + swd_dmi->length + 1;
 
 	return 0;
 }
@@ -603,19 +929,41 @@ static int cam_cdm_util_swd_dmi_write(uint32_t cdm_cmd_type,
 int cam_cdm_util_cmd_buf_write(void __iomem **current_device_base,
 	uint32_t *cmd_buf, uint32_t cmd_buf_size,
 	struct cam_soc_reg_map *base_table[CAM_SOC_MAX_BLOCK],
-	uint32_t base_array_size, uint8_t bl_tag)
+	uint32_t base_array_size, uint8_t bl_tag,
+	struct cam_cdm_shadow_regs *shadow,
+	const struct cam_cdm_always_write_regs *always_write)
 {
 	int ret = 0;
 	uint32_t cdm_cmd_type = 0;
 	uint32_t used_bytes = 0;
+	uint64_t writes_skipped = 0;
+	bool skip_unchanged = false;
+
+	if (shadow) {
+		mutex_lock(&shadow->lock);
+		if (!shadow->valid)
+			cam_cdm_util_shadow_regs_reset(shadow);
+		shadow->always_write = always_write;
+		writes_skipped = shadow->writes_skipped;
+		skip_unchanged = cam_cdm_util_shadow_dmi_scan(shadow,
+			*current_device_base, cmd_buf, cmd_buf_size,
+			base_table, base_array_size);
+	}
 
 	while (cmd_buf_size > 0) {
+		if (cmd_buf_size < CAM_CDM_DWORD) {
+			CAM_ERR(CAM_CDM, "truncated cdm command, %u bytes left",
+				cmd_buf_size);
+			ret = -EINVAL;
+			break;
+		}
 		CAM_DBG(CAM_CDM, "cmd data=%x", *cmd_buf);
 		cdm_cmd_type = (*cmd_buf >> CAM_CDM_COMMAND_OFFSET);
 		switch (cdm_cmd_type) {
 		case CAM_CDM_CMD_REG_CONT: {
 			ret = cam_cdm_util_reg_cont_write(*current_device_base,
-				cmd_buf, cmd_buf_size, &used_bytes);
+				cmd_buf, cmd_buf_size, &used_bytes, shadow,
+				skip_unchanged);
 			if (ret)
 				break;
 
@@ -628,7 +976,7 @@ int cam_cdm_util_cmd_buf_write(void __iomem **current_device_base,
 		case CAM_CDM_CMD_REG_RANDOM: {
 			ret = cam_cdm_util_reg_random_write(
 				*current_device_base, cmd_buf, cmd_buf_size,
-				&used_bytes);
+				&used_bytes, shadow, skip_unchanged);
 			if (ret)
 				break;
 
@@ -650,7 +998,7 @@ int cam_cdm_util_cmd_buf_write(void __iomem **current_device_base,
 			}
 			ret = cam_cdm_util_swd_dmi_write(cdm_cmd_type,
 				*current_device_base, cmd_buf, cmd_buf_size,
-				&used_bytes);
+				&used_bytes, shadow, skip_unchanged);
 			if (ret)
 				break;
 
@@ -692,6 +1040,20 @@ int cam_cdm_util_cmd_buf_write(void __iomem **current_device_base,
 			break;
 	}
 
+	if (shadow) {
+		/* A partially replayed buffer leaves the shadow untrusted */
+		if (ret)
+			shadow->valid = false;
+		else
+			CAM_DBG(CAM_CDM,
+				"BL tag %u skipped %llu writes, total issued %llu skipped %llu dmi %llu",
+				bl_tag, shadow->writes_skipped - writes_skipped,
+				shadow->writes_issued, shadow->writes_skipped,
+				shadow->dmi_skipped);
+		shadow->always_write = NULL;
+		mutex_unlock(&shadow->lock);
+	}
+
 	return ret;
 }
 
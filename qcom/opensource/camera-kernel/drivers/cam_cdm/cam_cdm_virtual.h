@@ -8,11 +8,17 @@
 
 #include "cam_cdm_intf_api.h"
 
+struct cam_cdm_shadow_regs;
+struct cam_cdm_always_write_regs;
+
 int cam_virtual_cdm_probe(struct platform_device *pdev);
 int cam_virtual_cdm_remove(struct platform_device *pdev);
 int cam_cdm_util_cmd_buf_write(void __iomem **current_device_base,
 	uint32_t *cmd_buf, uint32_t cmd_buf_size,
 	struct cam_soc_reg_map *base_table[CAM_SOC_MAX_BLOCK],
-	uint32_t base_array_size, uint8_t bl_tag);
+	uint32_t base_array_size, uint8_t bl_tag,
+	struct cam_cdm_shadow_regs *shadow,
+	const struct cam_cdm_always_write_regs *always_write);
+void cam_cdm_util_shadow_regs_invalidate(struct cam_cdm_shadow_regs *shadow);
 
 #endif /* _CAM_CDM_VIRTUAL_H_ */
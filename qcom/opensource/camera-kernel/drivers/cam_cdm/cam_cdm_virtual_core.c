@@ -25,6 +25,27 @@
 
 #define CAM_CDM_VIRTUAL_NAME "qcom,cam_virtual_cdm"
 
+static uint cam_cdm_virtual_shadow_regs;
+module_param(cam_cdm_virtual_shadow_regs, uint, 0644);
+MODULE_PARM_DESC(cam_cdm_virtual_shadow_regs,
+	"Skip virtual CDM register writes and DMI uploads that do not change HW state");
+
+static struct cam_cdm_shadow_regs *cam_virtual_cdm_get_shadow(
+	struct cam_cdm *core)
+{
+	if (!core->shadow)
+		return NULL;
+
+	/* Writes done while disabled are not tracked, drop the shadow */
+	if (!READ_ONCE(cam_cdm_virtual_shadow_regs)) {
+		if (READ_ONCE(core->shadow->valid))
+			cam_cdm_util_shadow_regs_invalidate(core->shadow);
+		return NULL;
+	}
+
+	return core->shadow;
+}
+
 static void cam_virtual_cdm_work(struct work_struct *work)
 {
 	struct cam_cdm_work_payload *payload;
@@ -84,6 +105,7 @@ int cam_virtual_cdm_submit_bl(struct cam_hw_info *cdm_hw,
 	int i, rc = -EINVAL;
 	struct cam_cdm_bl_request *cdm_cmd = req->data;
 	struct cam_cdm *core = (struct cam_cdm *)cdm_hw->core_info;
+	struct cam_cdm_shadow_regs *shadow = cam_virtual_cdm_get_shadow(core);
 
 	mutex_lock(&client->lock);
 	for (i = 0; i < req->data->cmd_arrary_count ; i++) {
@@ -140,7 +162,8 @@ int cam_virtual_cdm_submit_bl(struct cam_hw_info *cdm_hw,
 				((uint32_t *)vaddr_ptr +
 					((cdm_cmd->cmd[i].offset)/4)),
 				cdm_cmd->cmd[i].len, client->data.base_array,
-				client->data.base_array_cnt, core->bl_tag);
+				client->data.base_array_cnt, core->bl_tag,
+				shadow, &client->always_write);
 			if (rc) {
 				CAM_ERR(CAM_CDM,
 					"write failed for cnt=%d:%d len %u",
@@ -276,6 +299,15 @@ int cam_virtual_cdm_probe(struct platform_device *pdev)
 	else
 		cdm_core->flags = CAM_CDM_FLAG_PRIVATE_CDM;
 
+	cdm_core->shadow = kzalloc(sizeof(struct cam_cdm_shadow_regs),
+		GFP_KERNEL);
+	if (!cdm_core->shadow) {
+		rc = -ENOMEM;
+		kfree(cdm_hw->soc_info.soc_private);
+		goto soc_load_failed;
+	}
+	mutex_init(&cdm_core->shadow->lock);
+
 	cdm_core->bl_tag = 0;
 	INIT_LIST_HEAD(&cdm_core->bl_request_list);
 	init_completion(&cdm_core->reset_complete);
@@ -345,6 +377,8 @@ cpas_registration_failed:
 	destroy_workqueue(cdm_core->work_queue);
 	mutex_unlock(&cdm_hw->hw_mutex);
 	mutex_destroy(&cdm_hw->hw_mutex);
+	mutex_destroy(&cdm_core->shadow->lock);
+	kfree(cdm_core->shadow);
 soc_load_failed:
 	kfree(cdm_hw->core_info);
 	kfree(cdm_hw);
@@ -399,6 +433,8 @@ int cam_virtual_cdm_remove(struct platform_device *pdev)
 	flush_workqueue(cdm_core->work_queue);
 	destroy_workqueue(cdm_core->work_queue);
 	mutex_destroy(&cdm_hw->hw_mutex);
+	mutex_destroy(&cdm_core->shadow->lock);
+	kfree(cdm_core->shadow);
 	kfree(cdm_hw->soc_info.soc_private);
 	kfree(cdm_hw->core_info);
 	kfree(cdm_hw);
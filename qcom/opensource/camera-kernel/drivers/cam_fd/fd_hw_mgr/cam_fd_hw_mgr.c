@@ -1430,6 +1430,8 @@ static int cam_fd_mgr_hw_flush_req(void *hw_mgr_priv,
 
 			if (hw_device->hw_intf->hw_ops.stop) {
 				hw_stop_args.hw_ctx = hw_ctx;
+				hw_stop_args.ctx_hw_private =
+					hw_ctx->ctx_hw_private;
 				rc = hw_device->hw_intf->hw_ops.stop(
 					hw_device->hw_intf->hw_priv,
 					&hw_stop_args,
@@ -1517,6 +1519,7 @@ static int cam_fd_mgr_hw_flush_ctx(void *hw_mgr_priv,
 
 		if (hw_device->hw_intf->hw_ops.stop) {
 			hw_stop_args.hw_ctx = hw_ctx;
+			hw_stop_args.ctx_hw_private = hw_ctx->ctx_hw_private;
 			rc = hw_device->hw_intf->hw_ops.stop(
 				hw_device->hw_intf->hw_priv, &hw_stop_args,
 				sizeof(hw_stop_args));
@@ -789,6 +789,14 @@ int cam_fd_hw_init(void *hw_priv, void *init_hw_args, uint32_t arg_size)
 
 	cam_fd_hw_util_enable_power_on_settings(fd_hw);
 
+	if (init_args->ctx_hw_private) {
+		struct cam_fd_ctx_hw_private *ctx_hw_private =
+			init_args->ctx_hw_private;
+
+		/* Reset and power on settings bypass the CDM, drop its shadow */
+		cam_cdm_invalidate_shadow(ctx_hw_private->cdm_handle);
+	}
+
 cdm_streamon:
 	fd_hw->open_count++;
 	CAM_DBG(CAM_FD, "FD HW Init ref count after %d", fd_hw->open_count);
@@ -863,6 +871,14 @@ int cam_fd_hw_deinit(void *hw_priv, void *deinit_hw_args, uint32_t arg_size)
 	if (rc)
 		CAM_ERR(CAM_FD, "Failed in Disable SOC, rc=%d", rc);
 
+	if (deinit_args->ctx_hw_private) {
+		struct cam_fd_ctx_hw_private *ctx_hw_private =
+			deinit_args->ctx_hw_private;
+
+		/* Register state is lost on power collapse */
+		cam_cdm_invalidate_shadow(ctx_hw_private->cdm_handle);
+	}
+
 	fd_hw->hw_state = CAM_HW_STATE_POWER_DOWN;
 	fd_core = (struct cam_fd_core *)fd_hw->core_info;
 
@@ -1045,6 +1061,8 @@ error:
 int cam_fd_hw_halt_reset(void *hw_priv, void *stop_args, uint32_t arg_size)
 {
 	struct cam_hw_info *fd_hw = (struct cam_hw_info *)hw_priv;
+	struct cam_fd_hw_stop_args *hw_stop_args =
+		(struct cam_fd_hw_stop_args *)stop_args;
 	struct cam_fd_core *fd_core;
 	struct cam_fd_hw_static_info *hw_static_info;
 	struct cam_hw_soc_info *soc_info;
@@ -1092,6 +1110,14 @@ int cam_fd_hw_halt_reset(void *hw_priv, void *stop_args, uint32_t arg_size)
 	cam_fd_soc_register_write(soc_info, CAM_FD_REG_WRAPPER,
 		hw_static_info->wrapper_regs.cgc_disable, 0x0);
 
+	if (hw_stop_args && hw_stop_args->ctx_hw_private) {
+		struct cam_fd_ctx_hw_private *ctx_hw_private =
+			hw_stop_args->ctx_hw_private;
+
+		/* The reset dropped every register the CDM programmed */
+		cam_cdm_invalidate_shadow(ctx_hw_private->cdm_handle);
+	}
+
 	spin_lock_irqsave(&fd_core->spin_lock, flags);
 	fd_core->core_state = CAM_FD_CORE_STATE_IDLE;
 	spin_unlock_irqrestore(&fd_core->spin_lock, flags);
@@ -1099,6 +1125,29 @@ int cam_fd_hw_halt_reset(void *hw_priv, void *stop_args, uint32_t arg_size)
 	return rc;
 }
 
+static void cam_fd_hw_util_fill_always_write(struct cam_hw_info *fd_hw,
+	struct cam_cdm_acquire_data *cdm_acquire)
+{
+	struct cam_fd_core *fd_core = (struct cam_fd_core *)fd_hw->core_info;
+	struct cam_fd_hw_static_info *hw_static_info = fd_core->hw_static_info;
+	struct cam_fd_soc_private *soc_private =
+		(struct cam_fd_soc_private *)fd_hw->soc_info.soc_private;
+	uint32_t core_idx = soc_private->regbase_index[CAM_FD_REG_CORE];
+	uint32_t wrapper_idx = soc_private->regbase_index[CAM_FD_REG_WRAPPER];
+	struct cam_cdm_always_write_reg regs[] = {
+		{ core_idx, hw_static_info->core_regs.control },
+		{ wrapper_idx, hw_static_info->wrapper_regs.hw_stop },
+		{ wrapper_idx, hw_static_info->wrapper_regs.sw_reset },
+		{ wrapper_idx, hw_static_info->wrapper_regs.irq_clear },
+	};
+
+	BUILD_BUG_ON(ARRAY_SIZE(regs) > CAM_CDM_ALWAYS_WRITE_MAX);
+
+	/* Start, stop, reset and IRQ clear act on every write */
+	memcpy(cdm_acquire->always_write, regs, sizeof(regs));
+	cdm_acquire->always_write_cnt = ARRAY_SIZE(regs);
+}
+
 int cam_fd_hw_reserve(void *hw_priv, void *hw_reserve_args, uint32_t arg_size)
 {
 	struct cam_hw_info *fd_hw = (struct cam_hw_info *)hw_priv;
@@ -1145,6 +1194,7 @@ int cam_fd_hw_reserve(void *hw_priv, void *hw_reserve_args, uint32_t arg_size)
 	cdm_acquire.priority = CAM_CDM_BL_FIFO_0;
 	for (i = 0; i < fd_hw->soc_info.num_reg_map; i++)
 		cdm_acquire.base_array[i] = &fd_hw->soc_info.reg_map[i];
+	cam_fd_hw_util_fill_always_write(fd_hw, &cdm_acquire);
 
 	rc = cam_cdm_acquire(&cdm_acquire);
 	if (rc) {
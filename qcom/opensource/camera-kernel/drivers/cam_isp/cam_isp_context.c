@@ -1066,6 +1066,19 @@ static int cam_isp_ctx_dump_req(
 	return rc;
 }
 
+static struct cam_ctx_request *__cam_isp_ctx_find_req_by_id(
+	struct list_head *req_list, uint64_t request_id)
+{
+	struct cam_ctx_request *req;
+
+	list_for_each_entry(req, req_list, list) {
+		if (req->request_id == request_id)
+			return req;
+	}
+
+	return NULL;
+}
+
 static int __cam_isp_ctx_enqueue_request_in_order(
 	struct cam_context *ctx, struct cam_ctx_request *req, bool lock)
 {
@@ -5305,7 +5318,8 @@ static void __cam_isp_ctx_find_mup_for_default_settings(
 	int64_t req_id, struct cam_context *ctx,
 	struct cam_ctx_request **switch_req)
 {
-	struct cam_ctx_request *req, *temp_req;
+	struct cam_ctx_request *req;
+	struct cam_isp_ctx_req *req_isp;
 
 	if (list_empty(&ctx->pending_req_list)) {
 		CAM_DBG(CAM_ISP,
@@ -5314,17 +5328,21 @@ static void __cam_isp_ctx_find_mup_for_default_settings(
 		return;
 	}
 
-	list_for_each_entry_safe(
-		req, temp_req, &ctx->pending_req_list, list) {
-		if (req->request_id == req_id) {
-			struct cam_isp_ctx_req *req_isp = (struct cam_isp_ctx_req *)req->req_priv;
+	/*
+	 * Request ids can repeat in the pending list, use the last matching
+	 * request that has mup enabled.
+	 */
+	list_for_each_entry_reverse(req, &ctx->pending_req_list, list) {
+		if (req->request_id != req_id)
+			continue;
 
-			if (req_isp->hw_update_data.mup_en) {
-				*switch_req = req;
-				CAM_DBG(CAM_ISP,
-					"Found mup for last applied max pd req: %lld in ctx: %u",
-					req_id, ctx->ctx_id);
-			}
+		req_isp = (struct cam_isp_ctx_req *)req->req_priv;
+		if (req_isp->hw_update_data.mup_en) {
+			*switch_req = req;
+			CAM_DBG(CAM_ISP,
+				"Found mup for last applied max pd req: %lld in ctx: %u",
+				req_id, ctx->ctx_id);
+			return;
 		}
 	}
 }
@@ -5583,40 +5601,36 @@ static int __cam_isp_ctx_dump_in_top_state(
 	struct cam_isp_context             *ctx_isp;
 	struct cam_ctx_request             *req = NULL;
 	struct cam_isp_ctx_req             *req_isp;
-	struct cam_ctx_request             *req_temp;
 	struct cam_hw_dump_args             ife_dump_args;
 	struct cam_common_hw_dump_args      dump_args;
 	struct cam_hw_cmd_args              hw_cmd_args;
 	struct cam_isp_hw_cmd_args          isp_hw_cmd_args;
 
 	spin_lock_bh(&ctx->lock);
-	list_for_each_entry_safe(req, req_temp,
-		&ctx->active_req_list, list) {
-		if (req->request_id == dump_info->req_id) {
-			CAM_INFO(CAM_ISP, "isp dump active list req: %lld, ctx_idx: %u, link: 0x%x",
-			    dump_info->req_id, ctx->ctx_id, ctx->link_hdl);
-			req_type = 'a';
-			goto hw_dump;
-		}
+	req = __cam_isp_ctx_find_req_by_id(&ctx->active_req_list,
+		dump_info->req_id);
+	if (req) {
+		CAM_INFO(CAM_ISP, "isp dump active list req: %lld, ctx_idx: %u, link: 0x%x",
+		    dump_info->req_id, ctx->ctx_id, ctx->link_hdl);
+		req_type = 'a';
+		goto hw_dump;
 	}
-	list_for_each_entry_safe(req, req_temp,
-		&ctx->wait_req_list, list) {
-		if (req->request_id == dump_info->req_id) {
-			CAM_INFO(CAM_ISP, "isp dump wait list req: %lld, ctx_idx: %u, link: 0x%x",
-			    dump_info->req_id, ctx->ctx_id, ctx->link_hdl);
-			req_type = 'w';
-			goto hw_dump;
-		}
+	req = __cam_isp_ctx_find_req_by_id(&ctx->wait_req_list,
+		dump_info->req_id);
+	if (req) {
+		CAM_INFO(CAM_ISP, "isp dump wait list req: %lld, ctx_idx: %u, link: 0x%x",
+		    dump_info->req_id, ctx->ctx_id, ctx->link_hdl);
+		req_type = 'w';
+		goto hw_dump;
 	}
-	list_for_each_entry_safe(req, req_temp,
-		&ctx->pending_req_list, list) {
-		if (req->request_id == dump_info->req_id) {
-			CAM_INFO(CAM_ISP,
-			    "isp dump pending list req: %lld, ctx_idx: %u, link: 0x%x",
-			    dump_info->req_id, ctx->ctx_id, ctx->link_hdl);
-			req_type = 'p';
-			goto hw_dump;
-		}
+	req = __cam_isp_ctx_find_req_by_id(&ctx->pending_req_list,
+		dump_info->req_id);
+	if (req) {
+		CAM_INFO(CAM_ISP,
+		    "isp dump pending list req: %lld, ctx_idx: %u, link: 0x%x",
+		    dump_info->req_id, ctx->ctx_id, ctx->link_hdl);
+		req_type = 'p';
+		goto hw_dump;
 	}
 	goto end;
 hw_dump:
@@ -9433,6 +9447,36 @@ int cam_isp_context_deinit(struct cam_isp_context *ctx)
 
 	return 0;
 }
+
+#ifdef CONFIG_SPECTRA_KUNIT_TEST
+int cam_isp_context_test_apply(struct cam_context *ctx,
+	struct cam_req_mgr_apply_request *apply)
+{
+	return __cam_isp_ctx_apply_req_in_sof(ctx, apply);
+}
+
+int cam_isp_context_test_flush(struct cam_context *ctx,
+	struct list_head *req_list, struct cam_req_mgr_flush_request *flush_req)
+{
+	return __cam_isp_ctx_flush_req(ctx, req_list, flush_req);
+}
+
+struct cam_ctx_request *cam_isp_context_test_find_mup(
+	struct cam_context *ctx, int64_t req_id)
+{
+	struct cam_ctx_request *req = NULL;
+
+	__cam_isp_ctx_find_mup_for_default_settings(req_id, ctx, &req);
+
+	return req;
+}
+
+int cam_isp_context_test_apply_default(struct cam_context *ctx,
+	struct cam_req_mgr_apply_request *apply)
+{
+	return __cam_isp_ctx_apply_default_req_settings(ctx, apply);
+}
+#endif
 /*xiaomi added detect framerate begin*/
 void cam_isp_detect_framerate(struct cam_isp_context *ctx, uint interval)
 {
@@ -651,6 +651,59 @@ int cam_isp_context_init(struct cam_isp_context *ctx,
  */
 int cam_isp_context_deinit(struct cam_isp_context *ctx);
 
+#ifdef CONFIG_SPECTRA_KUNIT_TEST
+/**
+ * cam_isp_context_test_apply()
+ *
+ * @brief:              Apply the head of the pending list as in the SOF
+ *                      substate, for KUnit tests
+ *
+ * @ctx:                Context with a cam_isp_context as private data
+ * @apply:              Apply request from the CRM
+ *
+ */
+int cam_isp_context_test_apply(struct cam_context *ctx,
+	struct cam_req_mgr_apply_request *apply);
+
+/**
+ * cam_isp_context_test_flush()
+ *
+ * @brief:              Flush one request list, for KUnit tests
+ *
+ * @ctx:                Context with a cam_isp_context as private data
+ * @req_list:           Request list to flush
+ * @flush_req:          Flush request from the CRM
+ *
+ */
+int cam_isp_context_test_flush(struct cam_context *ctx,
+	struct list_head *req_list, struct cam_req_mgr_flush_request *flush_req);
+
+/**
+ * cam_isp_context_test_find_mup()
+ *
+ * @brief:              Pending request whose IQ settings are reapplied with
+ *                      the default settings, for KUnit tests
+ *
+ * @ctx:                Context with a cam_isp_context as private data
+ * @req_id:             Last applied max pipeline delay request id
+ *
+ */
+struct cam_ctx_request *cam_isp_context_test_find_mup(
+	struct cam_context *ctx, int64_t req_id);
+
+/**
+ * cam_isp_context_test_apply_default()
+ *
+ * @brief:              Apply the default settings, for KUnit tests
+ *
+ * @ctx:                Context with a cam_isp_context as private data
+ * @apply:              Apply request from the CRM
+ *
+ */
+int cam_isp_context_test_apply_default(struct cam_context *ctx,
+	struct cam_req_mgr_apply_request *apply);
+#endif
+
 /*xiaomi added detect framerate begin*/
 /**
  * cam_isp_detect_framerate()
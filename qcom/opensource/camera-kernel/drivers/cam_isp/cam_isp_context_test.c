@@ -0,0 +1,359 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ * Copyright (c) 2024 Qualcomm Innovation Center, Inc. All rights reserved.
+ */
+
+#include <kunit/test.h>
+
+#include "cam_isp_context.h"
+
+/*
+ * KUnit replay of ISP context request transitions. A context is built with
+ * a stand-in hw mgr that logs every hw_config call, requests are queued on
+ * its lists directly, and apply, flush and the mode switch (MUP) lookup of
+ * the default settings are replayed against it. No hw mgr, CDM or CRM link
+ * is needed.
+ */
+
+#define CAM_ISP_CTX_TEST_NUM_REQS     8
+#define CAM_ISP_CTX_TEST_MAX_CONFIGS  8
+
+/**
+ * struct cam_isp_ctx_test_config - Logged hw_config call
+ *
+ * @request_id   : Request id passed to the hw mgr
+ * @reapply_type : Reapply type passed to the hw mgr
+ * @priv         : Prepare data of the request passed to the hw mgr
+ */
+struct cam_isp_ctx_test_config {
+	uint64_t                        request_id;
+	enum cam_hw_config_reapply_type reapply_type;
+	void                           *priv;
+};
+
+/**
+ * struct cam_isp_ctx_test - Context under test and its stand-in hw mgr
+ *
+ * @ctx         : Base context
+ * @ctx_isp     : ISP context
+ * @hw_intf     : Stand-in hw mgr interface
+ * @req         : Requests, queued on the context lists by each case
+ * @req_isp     : ISP private data of @req
+ * @configs     : hw_config calls seen so far
+ * @num_configs : Number of entries in @configs
+ * @config_rc   : Return code of the next hw_config calls
+ */
+struct cam_isp_ctx_test {
+	struct cam_context              ctx;
+	struct cam_isp_context         *ctx_isp;
+	struct cam_hw_mgr_intf          hw_intf;
+	struct cam_ctx_request          req[CAM_ISP_CTX_TEST_NUM_REQS];
+	struct cam_isp_ctx_req          req_isp[CAM_ISP_CTX_TEST_NUM_REQS];
+	struct cam_isp_ctx_test_config  configs[CAM_ISP_CTX_TEST_MAX_CONFIGS];
+	uint32_t                        num_configs;
+	int                             config_rc;
+};
+
+static int cam_isp_ctx_test_hw_config(void *hw_priv, void *hw_config_args)
+{
+	struct cam_isp_ctx_test *t = hw_priv;
+	struct cam_hw_config_args *cfg = hw_config_args;
+
+	if (t->num_configs < CAM_ISP_CTX_TEST_MAX_CONFIGS) {
+		t->configs[t->num_configs].request_id = cfg->request_id;
+		t->configs[t->num_configs].reapply_type = cfg->reapply_type;
+		t->configs[t->num_configs].priv = cfg->priv;
+	}
+	t->num_configs++;
+
+	return t->config_rc;
+}
+
+static int cam_isp_ctx_test_init(struct kunit *test)
+{
+	struct cam_isp_ctx_test *t;
+	struct cam_context *ctx;
+	int i;
+
+	t = kunit_kzalloc(test, sizeof(*t), GFP_KERNEL);
+	if (!t)
+		return -ENOMEM;
+
+	t->ctx_isp = kunit_kzalloc(test, sizeof(*t->ctx_isp), GFP_KERNEL);
+	if (!t->ctx_isp)
+		return -ENOMEM;
+
+	ctx = &t->ctx;
+	spin_lock_init(&ctx->lock);
+	INIT_LIST_HEAD(&ctx->active_req_list);
+	INIT_LIST_HEAD(&ctx->pending_req_list);
+	INIT_LIST_HEAD(&ctx->wait_req_list);
+	INIT_LIST_HEAD(&ctx->free_req_list);
+	ctx->ctx_priv = t->ctx_isp;
+
+	t->hw_intf.hw_mgr_priv = t;
+	t->hw_intf.hw_config = cam_isp_ctx_test_hw_config;
+	ctx->hw_mgr_intf = &t->hw_intf;
+
+	t->ctx_isp->base = ctx;
+	t->ctx_isp->substate_activated = CAM_ISP_CTX_ACTIVATED_SOF;
+	INIT_LIST_HEAD(&t->ctx_isp->fcg_tracker.skipped_list);
+
+	for (i = 0; i < CAM_ISP_CTX_TEST_NUM_REQS; i++) {
+		INIT_LIST_HEAD(&t->req[i].list);
+		INIT_LIST_HEAD(&t->req[i].buf_tracker);
+		t->req[i].ctx = ctx;
+		t->req[i].req_priv = &t->req_isp[i];
+		t->req_isp[i].base = &t->req[i];
+	}
+
+	test->priv = t;
+	return 0;
+}
+
+/* Queue request slot @idx on @list with the given id and MUP flag */
+static void cam_isp_ctx_test_queue(struct cam_isp_ctx_test *t,
+	struct list_head *list, int idx, uint64_t request_id, bool mup_en)
+{
+	t->req[idx].request_id = request_id;
+	t->req_isp[idx].hw_update_data.mup_en = mup_en;
+	list_add_tail(&t->req[idx].list, list);
+}
+
+/* Check the ids on @list, in order, against @ids */
+static void cam_isp_ctx_test_expect_ids(struct kunit *test,
+	struct list_head *list, const uint64_t *ids, int num_ids)
+{
+	struct cam_ctx_request *req;
+	int i = 0;
+
+	list_for_each_entry(req, list, list) {
+		KUNIT_ASSERT_LT(test, i, num_ids);
+		KUNIT_EXPECT_EQ(test, req->request_id, ids[i]);
+		i++;
+	}
+	KUNIT_EXPECT_EQ(test, i, num_ids);
+}
+
+static int cam_isp_ctx_test_apply(struct cam_isp_ctx_test *t,
+	uint64_t request_id)
+{
+	struct cam_req_mgr_apply_request apply = {
+		.request_id = request_id,
+	};
+
+	return cam_isp_context_test_apply(&t->ctx, &apply);
+}
+
+static int cam_isp_ctx_test_flush(struct cam_isp_ctx_test *t,
+	struct list_head *list, uint32_t type, uint64_t req_id)
+{
+	struct cam_req_mgr_flush_request flush = {
+		.type = type,
+		.req_id = req_id,
+	};
+
+	return cam_isp_context_test_flush(&t->ctx, list, &flush);
+}
+
+/* Only the head of the pending list is applied, and it moves to wait */
+static void cam_isp_ctx_test_apply_order(struct kunit *test)
+{
+	struct cam_isp_ctx_test *t = test->priv;
+	static const uint64_t wait_ids[] = {1, 2};
+	static const uint64_t pending_ids[] = {3};
+	int i;
+
+	for (i = 0; i < 3; i++)
+		cam_isp_ctx_test_queue(t, &t->ctx.pending_req_list, i, i + 1,
+			false);
+
+	KUNIT_EXPECT_EQ(test, cam_isp_ctx_test_apply(t, 1), 0);
+	KUNIT_EXPECT_EQ(test, t->ctx_isp->substate_activated,
+		CAM_ISP_CTX_ACTIVATED_APPLIED);
+	KUNIT_EXPECT_EQ(test, t->ctx_isp->last_applied_req_id, 1);
+
+	/* Not the tip of the pending list, rejected before the hw mgr */
+	KUNIT_EXPECT_EQ(test, cam_isp_ctx_test_apply(t, 3), -EFAULT);
+	KUNIT_EXPECT_EQ(test, t->num_configs, 1);
+
+	KUNIT_EXPECT_EQ(test, cam_isp_ctx_test_apply(t, 2), 0);
+	KUNIT_EXPECT_EQ(test, t->ctx_isp->last_applied_req_id, 2);
+
+	KUNIT_ASSERT_EQ(test, t->num_configs, 2);
+	KUNIT_EXPECT_EQ(test, t->configs[0].request_id, 1);
+	KUNIT_EXPECT_EQ(test, t->configs[1].request_id, 2);
+	cam_isp_ctx_test_expect_ids(test, &t->ctx.wait_req_list, wait_ids,
+		ARRAY_SIZE(wait_ids));
+	cam_isp_ctx_test_expect_ids(test, &t->ctx.pending_req_list,
+		pending_ids, ARRAY_SIZE(pending_ids));
+}
+
+/* A bubble on apply parks the request on active and blocks further applies */
+static void cam_isp_ctx_test_apply_bubble(struct kunit *test)
+{
+	struct cam_isp_ctx_test *t = test->priv;
+	static const uint64_t active_ids[] = {1};
+	static const uint64_t pending_ids[] = {2};
+
+	cam_isp_ctx_test_queue(t, &t->ctx.pending_req_list, 0, 1, false);
+	cam_isp_ctx_test_queue(t, &t->ctx.pending_req_list, 1, 2, false);
+
+	t->config_rc = -EALREADY;
+	KUNIT_EXPECT_EQ(test, cam_isp_ctx_test_apply(t, 1), -EALREADY);
+	KUNIT_EXPECT_EQ(test, t->ctx_isp->active_req_cnt, 1);
+	KUNIT_EXPECT_TRUE(test, t->req_isp[0].bubble_detected);
+	KUNIT_EXPECT_EQ(test, t->ctx_isp->last_applied_req_id, 0);
+
+	t->config_rc = 0;
+	KUNIT_EXPECT_EQ(test, cam_isp_ctx_test_apply(t, 2), -EFAULT);
+	KUNIT_EXPECT_EQ(test, t->num_configs, 1);
+
+	cam_isp_ctx_test_expect_ids(test, &t->ctx.active_req_list, active_ids,
+		ARRAY_SIZE(active_ids));
+	cam_isp_ctx_test_expect_ids(test, &t->ctx.pending_req_list,
+		pending_ids, ARRAY_SIZE(pending_ids));
+}
+
+/* Cancel takes the first request with the id, the rest keep their order */
+static void cam_isp_ctx_test_flush_cancel(struct kunit *test)
+{
+	struct cam_isp_ctx_test *t = test->priv;
+	static const uint64_t ids[] = {1, 2, 3, 2, 4};
+	static const uint64_t pending_ids[] = {1, 3, 2, 4};
+	static const uint64_t free_ids[] = {2};
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(ids); i++)
+		cam_isp_ctx_test_queue(t, &t->ctx.pending_req_list, i, ids[i],
+			false);
+
+	KUNIT_EXPECT_EQ(test, cam_isp_ctx_test_flush(t,
+		&t->ctx.pending_req_list, CAM_REQ_MGR_FLUSH_TYPE_CANCEL_REQ, 2),
+		0);
+	KUNIT_EXPECT_PTR_EQ(test, list_first_entry(&t->ctx.free_req_list,
+		struct cam_ctx_request, list), &t->req[1]);
+
+	/* An id that was never queued leaves every list alone */
+	KUNIT_EXPECT_EQ(test, cam_isp_ctx_test_flush(t,
+		&t->ctx.pending_req_list, CAM_REQ_MGR_FLUSH_TYPE_CANCEL_REQ, 9),
+		0);
+
+	cam_isp_ctx_test_expect_ids(test, &t->ctx.pending_req_list,
+		pending_ids, ARRAY_SIZE(pending_ids));
+	cam_isp_ctx_test_expect_ids(test, &t->ctx.free_req_list, free_ids,
+		ARRAY_SIZE(free_ids));
+
+	/* Cancel on an empty list is refused, flush all is not */
+	KUNIT_EXPECT_EQ(test, cam_isp_ctx_test_flush(t,
+		&t->ctx.wait_req_list, CAM_REQ_MGR_FLUSH_TYPE_CANCEL_REQ, 1),
+		-EINVAL);
+	KUNIT_EXPECT_EQ(test, cam_isp_ctx_test_flush(t,
+		&t->ctx.wait_req_list, CAM_REQ_MGR_FLUSH_TYPE_ALL, 0), 0);
+	KUNIT_EXPECT_EQ(test, t->num_configs, 0);
+}
+
+/*
+ * Flushing the pending list after an apply keeps the applied request on
+ * wait, moves the rest to free in order, and leaves nothing to apply.
+ */
+static void cam_isp_ctx_test_apply_then_flush(struct kunit *test)
+{
+	struct cam_isp_ctx_test *t = test->priv;
+	static const uint64_t wait_ids[] = {1};
+	static const uint64_t free_ids[] = {2, 3};
+	int i;
+
+	for (i = 0; i < 3; i++)
+		cam_isp_ctx_test_queue(t, &t->ctx.pending_req_list, i, i + 1,
+			false);
+
+	KUNIT_EXPECT_EQ(test, cam_isp_ctx_test_apply(t, 1), 0);
+	KUNIT_EXPECT_EQ(test, cam_isp_ctx_test_flush(t,
+		&t->ctx.pending_req_list, CAM_REQ_MGR_FLUSH_TYPE_ALL, 0), 0);
+
+	KUNIT_EXPECT_TRUE(test, list_empty(&t->ctx.pending_req_list));
+	cam_isp_ctx_test_expect_ids(test, &t->ctx.wait_req_list, wait_ids,
+		ARRAY_SIZE(wait_ids));
+	cam_isp_ctx_test_expect_ids(test, &t->ctx.free_req_list, free_ids,
+		ARRAY_SIZE(free_ids));
+
+	KUNIT_EXPECT_EQ(test, cam_isp_ctx_test_apply(t, 2), -EFAULT);
+	KUNIT_EXPECT_EQ(test, t->num_configs, 1);
+}
+
+/* Among duplicate ids, the last pending request with MUP enabled wins */
+static void cam_isp_ctx_test_mup_last_match(struct kunit *test)
+{
+	struct cam_isp_ctx_test *t = test->priv;
+	struct list_head *pending = &t->ctx.pending_req_list;
+
+	KUNIT_EXPECT_NULL(test, cam_isp_context_test_find_mup(&t->ctx, 6));
+
+	cam_isp_ctx_test_queue(t, pending, 0, 5, false);
+	cam_isp_ctx_test_queue(t, pending, 1, 6, true);
+	cam_isp_ctx_test_queue(t, pending, 2, 6, false);
+	cam_isp_ctx_test_queue(t, pending, 3, 6, true);
+	cam_isp_ctx_test_queue(t, pending, 4, 6, false);
+	cam_isp_ctx_test_queue(t, pending, 5, 7, true);
+
+	KUNIT_EXPECT_PTR_EQ(test, cam_isp_context_test_find_mup(&t->ctx, 6),
+		&t->req[3]);
+	KUNIT_EXPECT_NULL(test, cam_isp_context_test_find_mup(&t->ctx, 5));
+	KUNIT_EXPECT_NULL(test, cam_isp_context_test_find_mup(&t->ctx, 8));
+
+	/* With a single MUP duplicate it is found wherever it sits */
+	t->req_isp[3].hw_update_data.mup_en = false;
+	KUNIT_EXPECT_PTR_EQ(test, cam_isp_context_test_find_mup(&t->ctx, 6),
+		&t->req[1]);
+}
+
+/*
+ * The default settings reapply the IQ of the MUP request found above once
+ * the mode switch delay has run out, and not before.
+ */
+static void cam_isp_ctx_test_mup_default_apply(struct kunit *test)
+{
+	struct cam_isp_ctx_test *t = test->priv;
+	struct cam_req_mgr_apply_request apply = {
+		.last_applied_max_pd_req = 6,
+	};
+
+	cam_isp_ctx_test_queue(t, &t->ctx.pending_req_list, 0, 6, true);
+	cam_isp_ctx_test_queue(t, &t->ctx.pending_req_list, 1, 6, true);
+
+	t->ctx_isp->mode_switch_en = true;
+	t->ctx_isp->handle_mswitch = true;
+	atomic_set(&t->ctx_isp->mswitch_default_apply_delay_ref_cnt, 2);
+
+	KUNIT_EXPECT_EQ(test, cam_isp_context_test_apply_default(&t->ctx,
+		&apply), 0);
+	KUNIT_EXPECT_EQ(test, t->num_configs, 0);
+
+	KUNIT_EXPECT_EQ(test, cam_isp_context_test_apply_default(&t->ctx,
+		&apply), 0);
+	KUNIT_ASSERT_EQ(test, t->num_configs, 1);
+	KUNIT_EXPECT_EQ(test, t->configs[0].request_id, 6);
+	KUNIT_EXPECT_EQ(test, t->configs[0].reapply_type,
+		CAM_CONFIG_REAPPLY_IQ);
+	KUNIT_EXPECT_PTR_EQ(test, t->configs[0].priv,
+		(void *)&t->req_isp[1].hw_update_data);
+}
+
+static struct kunit_case cam_isp_ctx_test_cases[] = {
+	KUNIT_CASE(cam_isp_ctx_test_apply_order),
+	KUNIT_CASE(cam_isp_ctx_test_apply_bubble),
+	KUNIT_CASE(cam_isp_ctx_test_flush_cancel),
+	KUNIT_CASE(cam_isp_ctx_test_apply_then_flush),
+	KUNIT_CASE(cam_isp_ctx_test_mup_last_match),
+	KUNIT_CASE(cam_isp_ctx_test_mup_default_apply),
+	{}
+};
+
+static struct kunit_suite cam_isp_ctx_test_suite = {
+	.name = "cam_isp_context",
+	.init = cam_isp_ctx_test_init,
+	.test_cases = cam_isp_ctx_test_cases,
+};
+
+kunit_test_suite(cam_isp_ctx_test_suite);
@@ -273,6 +273,12 @@ static int cam_jpeg_process_next_hw_update(void *priv, void *data,
 		goto end_error;
 	}
 
+	/*
+	 * Every frame is preceded by a power up and reset, neither goes
+	 * through the CDM, so nothing it wrote before may be assumed intact.
+	 */
+	cam_cdm_invalidate_shadow(hw_mgr->cdm_info[dev_type][0].cdm_handle);
+
 	cdm_cmd = ctx_data->cdm_cmd;
 	cdm_cmd->type = CAM_CDM_BL_CMD_TYPE_MEM_HANDLE;
 	cdm_cmd->flag = false;
@@ -1473,7 +1479,10 @@ static int cam_jpeg_mgr_acquire_hw(void *hw_mgr_priv, void *acquire_hw_args)
 	CAM_DBG(CAM_JPEG, "ctx_id: %u, dev_type: %u",
 		ctx_id, dev_type);
 	if (!hw_mgr->cdm_info[dev_type][0].ref_cnt) {
+		struct cam_jpeg_trigger_regs_args trigger_regs;
+		uint32_t i;
 
+		memset(&cdm_acquire, 0, sizeof(cdm_acquire));
 		if (dev_type == CAM_JPEG_RES_TYPE_ENC) {
 			memcpy(cdm_acquire.identifier,
 				"jpegenc", sizeof("jpegenc"));
@@ -1493,6 +1502,23 @@ static int cam_jpeg_mgr_acquire_hw(void *hw_mgr_priv, void *acquire_hw_args)
 		cdm_acquire.cam_cdm_callback = NULL;
 		cdm_acquire.priority = CAM_CDM_BL_FIFO_0;
 
+		/* The CDM must not elide writes to command/IRQ/reset regs */
+		memset(&trigger_regs, 0, sizeof(trigger_regs));
+		rc = hw_mgr->devices[dev_type][0]->hw_ops.process_cmd(
+			hw_mgr->devices[dev_type][0]->hw_priv,
+			CAM_JPEG_CMD_GET_TRIGGER_REGS,
+			&trigger_regs, sizeof(trigger_regs));
+		if (rc) {
+			CAM_ERR(CAM_JPEG, "Failed to get trigger regs %d", rc);
+			goto acq_cdm_hdl_failed;
+		}
+		for (i = 0; i < trigger_regs.num_regs; i++) {
+			cdm_acquire.always_write[i].base_idx = 0;
+			cdm_acquire.always_write[i].offset =
+				trigger_regs.offset[i];
+		}
+		cdm_acquire.always_write_cnt = trigger_regs.num_regs;
+
 		rc = cam_cdm_acquire(&cdm_acquire);
 		if (rc) {
 			CAM_ERR(CAM_JPEG, "Failed to acquire the CDM HW %d",
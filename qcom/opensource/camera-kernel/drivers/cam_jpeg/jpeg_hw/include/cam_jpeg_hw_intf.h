@@ -25,6 +25,7 @@
 #define CAM_JPEG_MISR_ID_LOW_RD      1
 #define CAM_JPEG_MISR_ID_LOW_WR      2
 #define CAM_JPEG_MEM_BASE_INDEX      0
+#define CAM_JPEG_TRIGGER_REGS_MAX    3
 
 /**
  * struct cam_jpeg_irq_cb_data - Data that gets passed from IRQ when the cb function is called
@@ -83,6 +84,17 @@ struct cam_jpeg_misr_dump_args {
 	bool        enable_bug;
 };
 
+/**
+ * struct cam_jpeg_trigger_regs_args
+ * @num_regs : Number of valid entries in offset
+ * @offset   : Offsets from CAM_JPEG_MEM_BASE_INDEX of the registers that act
+ *             on every write, like command, IRQ clear and reset
+ */
+struct cam_jpeg_trigger_regs_args {
+	uint32_t    num_regs;
+	uint32_t    offset[CAM_JPEG_TRIGGER_REGS_MAX];
+};
+
 /**
  * struct cam_jpeg_hw_buf_done_evt_data
  * @buf_done_data:    buf done payload
@@ -103,6 +115,7 @@ enum cam_jpeg_cmd_type {
 	CAM_JPEG_CMD_CONFIG_HW_MISR,
 	CAM_JPEG_CMD_DUMP_HW_MISR_VAL,
 	CAM_JPEG_CMD_DUMP_DEBUG_REGS,
+	CAM_JPEG_CMD_GET_TRIGGER_REGS,
 	CAM_JPEG_CMD_MAX,
 };
 
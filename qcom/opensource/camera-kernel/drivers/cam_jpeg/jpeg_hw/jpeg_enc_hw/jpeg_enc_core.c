@@ -903,6 +903,20 @@ int cam_jpeg_enc_process_cmd(void *device_priv, uint32_t cmd_type,
 	case CAM_JPEG_CMD_DUMP_DEBUG_REGS:
 		rc = cam_jpeg_enc_dump_debug_regs(jpeg_enc_dev);
 		break;
+	case CAM_JPEG_CMD_GET_TRIGGER_REGS: {
+		struct cam_jpeg_trigger_regs_args *trigger_regs = cmd_args;
+
+		if (!cmd_args) {
+			CAM_ERR(CAM_JPEG, "cmd args NULL");
+			return -EINVAL;
+		}
+
+		trigger_regs->offset[0] = hw_info->reg_offset.hw_cmd;
+		trigger_regs->offset[1] = hw_info->reg_offset.int_clr;
+		trigger_regs->offset[2] = hw_info->reg_offset.reset_cmd;
+		trigger_regs->num_regs = 3;
+		break;
+	}
 	default:
 		rc = -EINVAL;
 		break;
@@ -467,6 +467,7 @@ static int cam_lrme_hw_util_reset(struct cam_hw_info *lrme_hw,
 	struct cam_hw_soc_info *soc_info = &lrme_hw->soc_info;
 	struct cam_lrme_hw_info *hw_info;
 	long time_left;
+	int rc = 0;
 
 	lrme_core = lrme_hw->core_info;
 	hw_info = lrme_core->hw_info;
@@ -483,7 +484,7 @@ static int cam_lrme_hw_util_reset(struct cam_hw_info *lrme_hw,
 			CAM_ERR(CAM_LRME,
 				"HW reset wait failed time_left=%ld",
 				time_left);
-			return -ETIMEDOUT;
+			rc = -ETIMEDOUT;
 		}
 		break;
 	case CAM_LRME_HW_RESET_TYPE_SW_RESET:
@@ -501,12 +502,16 @@ static int cam_lrme_hw_util_reset(struct cam_hw_info *lrme_hw,
 			CAM_ERR(CAM_LRME,
 				"SW reset wait failed time_left=%ld",
 				time_left);
-			return -ETIMEDOUT;
+			rc = -ETIMEDOUT;
 		}
 		break;
 	}
 
-	return 0;
+	/* Even a timed out reset may have cleared CDM programmed registers */
+	if (lrme_core->hw_cdm_info)
+		cam_cdm_invalidate_shadow(lrme_core->hw_cdm_info->cdm_handle);
+
+	return rc;
 }
 
 int cam_lrme_hw_util_get_caps(struct cam_hw_info *lrme_hw,
@@ -1062,6 +1067,10 @@ int cam_lrme_hw_stop(void *hw_priv, void *hw_stop_args, uint32_t arg_size)
 	if (rc)
 		CAM_ERR(CAM_LRME, "Failed in Disable SOC, rc=%d", rc);
 
+	/* Register state is lost on power collapse */
+	if (lrme_core->hw_cdm_info)
+		cam_cdm_invalidate_shadow(lrme_core->hw_cdm_info->cdm_handle);
+
 	lrme_hw->hw_state = CAM_HW_STATE_POWER_DOWN;
 	if (lrme_core->state == CAM_LRME_CORE_STATE_IDLE) {
 		lrme_core->state = CAM_LRME_CORE_STATE_INIT;
@@ -22,6 +22,36 @@
 #include "cam_smmu_api.h"
 #include "camera_main.h"
 
+static void cam_lrme_hw_dev_util_fill_always_write(
+	struct cam_lrme_core *lrme_core,
+	struct cam_cdm_acquire_data *cdm_acquire)
+{
+	struct cam_lrme_hw_info *hw_info = lrme_core->hw_info;
+	uint32_t offsets[] = {
+		hw_info->bus_rd_reg.common_reg.cmd,
+		hw_info->bus_rd_reg.common_reg.sw_reset,
+		hw_info->bus_rd_reg.common_reg.irq_clear,
+		hw_info->bus_rd_reg.common_reg.irq_cmd,
+		hw_info->bus_wr_reg.common_reg.sw_reset,
+		hw_info->bus_wr_reg.common_reg.irq_clear_0,
+		hw_info->bus_wr_reg.common_reg.irq_clear_1,
+		hw_info->bus_wr_reg.common_reg.irq_cmd,
+		hw_info->titan_reg.top_rst_cmd,
+		hw_info->titan_reg.top_irq_clear,
+		hw_info->titan_reg.top_irq_cmd,
+	};
+	int i;
+
+	BUILD_BUG_ON(ARRAY_SIZE(offsets) > CAM_CDM_ALWAYS_WRITE_MAX);
+
+	/* All LRME registers live in reg_map[0], see submit_go and reset */
+	for (i = 0; i < ARRAY_SIZE(offsets); i++) {
+		cdm_acquire->always_write[i].base_idx = 0;
+		cdm_acquire->always_write[i].offset = offsets[i];
+	}
+	cdm_acquire->always_write_cnt = ARRAY_SIZE(offsets);
+}
+
 static int cam_lrme_hw_dev_util_cdm_acquire(struct cam_lrme_core *lrme_core,
 	struct cam_hw_info *lrme_hw)
 {
@@ -57,6 +87,7 @@ static int cam_lrme_hw_dev_util_cdm_acquire(struct cam_lrme_core *lrme_core,
 	cdm_acquire.priority = CAM_CDM_BL_FIFO_0;
 	for (i = 0; i < lrme_hw->soc_info.num_reg_map; i++)
 		cdm_acquire.base_array[i] = &lrme_hw->soc_info.reg_map[i];
+	cam_lrme_hw_dev_util_fill_always_write(lrme_core, &cdm_acquire);
 
 	rc = cam_cdm_acquire(&cdm_acquire);
 	if (rc) {
@@ -8,43 +8,45 @@
 #include "cam_debug_util.h"
 #include "cam_common_util.h"
 
-#define WORKQ_ACQUIRE_LOCK(workq, flags) {\
+#define WORKQ_ACQUIRE_LOCK(workq, lock, flags) {\
 	if ((workq)->in_irq) \
-		spin_lock_irqsave(&(workq)->lock_bh, (flags)); \
+		spin_lock_irqsave((lock), (flags)); \
 	else \
-		spin_lock_bh(&(workq)->lock_bh); \
+		spin_lock_bh(lock); \
 }
 
-#define WORKQ_RELEASE_LOCK(workq, flags) {\
+#define WORKQ_RELEASE_LOCK(workq, lock, flags) {\
 	if ((workq)->in_irq) \
-		spin_unlock_irqrestore(&(workq)->lock_bh, (flags)); \
+		spin_unlock_irqrestore((lock), (flags)); \
 	else	\
-		spin_unlock_bh(&(workq)->lock_bh); \
+		spin_unlock_bh(lock); \
 }
 
+static uint cam_req_mgr_workq_delay_detect = 1;
+module_param(cam_req_mgr_workq_delay_detect, uint, 0644);
+MODULE_PARM_DESC(cam_req_mgr_workq_delay_detect,
+	"Flag to enable/disable scheduling and execution delay detection for crm workq tasks");
+
 struct crm_workq_task *cam_req_mgr_workq_get_task(
 	struct cam_req_mgr_core_workq *workq)
 {
 	struct crm_workq_task *task = NULL;
+	struct llist_node *node;
 	unsigned long flags = 0;
 
 	if (!workq)
 		return NULL;
 
-	WORKQ_ACQUIRE_LOCK(workq, flags);
-	if (list_empty(&workq->task.empty_head))
-		goto end;
+	/* llist_del_first() needs consumers serialized, producers are not */
+	WORKQ_ACQUIRE_LOCK(workq, &workq->task.empty_lock, flags);
+	node = llist_del_first(&workq->task.empty_head);
+	WORKQ_RELEASE_LOCK(workq, &workq->task.empty_lock, flags);
 
-	task = list_first_entry(&workq->task.empty_head,
-		struct crm_workq_task, entry);
-	if (task) {
+	if (node) {
+		task = llist_entry(node, struct crm_workq_task, entry);
 		atomic_sub(1, &workq->task.free_cnt);
-		list_del_init(&task->entry);
 	}
 
-end:
-	WORKQ_RELEASE_LOCK(workq, flags);
-
 	return task;
 }
 
@@ -52,17 +54,12 @@ static void cam_req_mgr_workq_put_task(struct crm_workq_task *task)
 {
 	struct cam_req_mgr_core_workq *workq =
 		(struct cam_req_mgr_core_workq *)task->parent;
-	unsigned long flags = 0;
 
-	list_del_init(&task->entry);
 	task->cancel = 0;
 	task->process_cb = NULL;
 	task->priv = NULL;
-	WORKQ_ACQUIRE_LOCK(workq, flags);
-	list_add_tail(&task->entry,
-		&workq->task.empty_head);
+	llist_add(&task->entry, &workq->task.empty_head);
 	atomic_add(1, &workq->task.free_cnt);
-	WORKQ_RELEASE_LOCK(workq, flags);
 }
 
 void cam_req_mgr_workq_flush(struct cam_req_mgr_core_workq *workq)
@@ -95,6 +92,35 @@ static int cam_req_mgr_process_task(struct crm_workq_task *task)
 	return 0;
 }
 
+/**
+ * cam_req_mgr_workq_dequeue_task() - Pick the next task in strict priority
+ * @workq: workq whose worker is dequeuing
+ *
+ * Only the worker of @workq may call this. Every call starts again from the
+ * highest priority, so a task enqueued while lower priority tasks are being
+ * processed runs next.
+ */
+static struct crm_workq_task *cam_req_mgr_workq_dequeue_task(
+	struct cam_req_mgr_core_workq *workq)
+{
+	struct llist_node *node;
+	int32_t i;
+
+	for (i = CRM_TASK_PRIORITY_0; i < CRM_TASK_PRIORITY_MAX; i++) {
+		node = workq->task.process_batch[i];
+		if (!node) {
+			node = llist_del_all(&workq->task.process_head[i]);
+			if (!node)
+				continue;
+			node = llist_reverse_order(node);
+		}
+		workq->task.process_batch[i] = node->next;
+		return llist_entry(node, struct crm_workq_task, entry);
+	}
+
+	return NULL;
+}
+
 /**
  * cam_req_mgr_process_workq() - main loop handling
  * @w: workqueue task pointer
@@ -103,8 +129,6 @@ void cam_req_mgr_process_workq(struct work_struct *w)
 {
 	struct cam_req_mgr_core_workq *workq = NULL;
 	struct crm_workq_task         *task;
-	int32_t                        i = CRM_TASK_PRIORITY_0;
-	unsigned long                  flags = 0;
 	ktime_t                        sched_start_time;
 	void                          *cb = NULL;
 
@@ -115,32 +139,28 @@ void cam_req_mgr_process_workq(struct work_struct *w)
 	workq = (struct cam_req_mgr_core_workq *)
 		container_of(w, struct cam_req_mgr_core_workq, work);
 
-	while (i < CRM_TASK_PRIORITY_MAX) {
-		WORKQ_ACQUIRE_LOCK(workq, flags);
-		while (!list_empty(&workq->task.process_head[i])) {
-			task = list_first_entry(&workq->task.process_head[i],
-				struct crm_workq_task, entry);
-			cb = (void *)task->process_cb;
-			cam_common_util_thread_switch_delay_detect(
+	while ((task = cam_req_mgr_workq_dequeue_task(workq))) {
+		cb = (void *)task->process_cb;
+		sched_start_time = 0;
+		if (task->task_scheduled_ts) {
+			sched_start_time = ktime_get();
+			cam_common_util_thread_switch_delay_detect_ts(
 				workq->workq_name, "schedule", cb,
-				task->task_scheduled_ts,
+				task->task_scheduled_ts, sched_start_time,
 				CAM_WORKQ_SCHEDULE_TIME_THRESHOLD);
-			sched_start_time = ktime_get();
-			atomic_sub(1, &workq->task.pending_cnt);
-			list_del_init(&task->entry);
-			WORKQ_RELEASE_LOCK(workq, flags);
-			if (!unlikely(atomic_read(&workq->flush)))
-				cam_req_mgr_process_task(task);
+		}
+		atomic_sub(1, &workq->task.pending_cnt);
+		if (!unlikely(atomic_read(&workq->flush)))
+			cam_req_mgr_process_task(task);
+		else
+			cam_req_mgr_workq_put_task(task);
+		if (sched_start_time)
 			cam_common_util_thread_switch_delay_detect(
 				workq->workq_name, "execution", cb,
 				sched_start_time,
 				CAM_WORKQ_SCHEDULE_TIME_THRESHOLD);
-			CAM_DBG(CAM_CRM, "processed task %pK free_cnt %d",
-				task, atomic_read(&workq->task.free_cnt));
-			WORKQ_ACQUIRE_LOCK(workq, flags);
-		}
-		WORKQ_RELEASE_LOCK(workq, flags);
-		i++;
+		CAM_DBG(CAM_CRM, "processed task %pK free_cnt %d",
+			task, atomic_read(&workq->task.free_cnt));
 	}
 }
 
@@ -149,7 +169,7 @@ int cam_req_mgr_workq_enqueue_task(struct crm_workq_task *task,
 {
 	int rc = 0;
 	struct cam_req_mgr_core_workq *workq = NULL;
-	unsigned long flags = 0;
+	struct workqueue_struct *job;
 
 	if (!task) {
 		CAM_WARN(CAM_CRM, "NULL task pointer can not schedule");
@@ -161,36 +181,42 @@ int cam_req_mgr_workq_enqueue_task(struct crm_workq_task *task,
 		return -EINVAL;
 	}
 
+	/*
+	 * The read side keeps the workq alive until the task is queued or put
+	 * back, destroy waits for a grace period after clearing job.
+	 */
+	rcu_read_lock();
 	if (task->cancel == 1 || atomic_read(&workq->flush)) {
 		rc = 0;
 		goto abort;
 	}
-	task->priv = priv;
-	task->priority =
-		(prio < CRM_TASK_PRIORITY_MAX && prio >= CRM_TASK_PRIORITY_0)
-		? prio : CRM_TASK_PRIORITY_0;
-	task->task_scheduled_ts = ktime_get();
 
-	WORKQ_ACQUIRE_LOCK(workq, flags);
-	if (!workq->job) {
+	job = rcu_dereference(workq->job);
+	if (!job) {
 		rc = -EINVAL;
-		WORKQ_RELEASE_LOCK(workq, flags);
 		goto abort;
 	}
 
-	list_add_tail(&task->entry,
-		&workq->task.process_head[task->priority]);
+	task->priv = priv;
+	task->priority =
+		(prio < CRM_TASK_PRIORITY_MAX && prio >= CRM_TASK_PRIORITY_0)
+		? prio : CRM_TASK_PRIORITY_0;
+	task->task_scheduled_ts = READ_ONCE(cam_req_mgr_workq_delay_detect) ?
+		ktime_get() : 0;
 
 	atomic_add(1, &workq->task.pending_cnt);
+	llist_add(&task->entry,
+		&workq->task.process_head[task->priority]);
 	CAM_DBG(CAM_CRM, "enq task %pK pending_cnt %d",
 		task, atomic_read(&workq->task.pending_cnt));
 
-	queue_work(workq->job, &workq->work);
-	WORKQ_RELEASE_LOCK(workq, flags);
+	queue_work(job, &workq->work);
+	rcu_read_unlock();
 
 	return rc;
 abort:
 	cam_req_mgr_workq_put_task(task);
+	rcu_read_unlock();
 	CAM_INFO(CAM_CRM, "task aborted and queued back to pool");
 	return rc;
 }
@@ -202,6 +228,7 @@ int cam_req_mgr_workq_create(char *name, int32_t num_tasks,
 	int32_t i, wq_flags = 0, max_active_tasks = 0;
 	struct crm_workq_task  *task;
 	struct cam_req_mgr_core_workq *crm_workq = NULL;
+	struct workqueue_struct *job;
 	char buf[128] = "crm_workq-";
 
 	if (!*workq) {
@@ -219,26 +246,26 @@ int cam_req_mgr_workq_create(char *name, int32_t num_tasks,
 
 		strlcat(buf, name, sizeof(buf));
 		CAM_DBG(CAM_CRM, "create workque crm_workq-%s", name);
-		crm_workq->job = alloc_workqueue(buf,
-			wq_flags, max_active_tasks, NULL);
-		if (!crm_workq->job) {
+		job = alloc_workqueue(buf, wq_flags, max_active_tasks, NULL);
+		if (!job) {
 			kfree(crm_workq);
 			return -ENOMEM;
 		}
+		RCU_INIT_POINTER(crm_workq->job, job);
 
 		/* Workq attributes initialization */
 		strlcpy(crm_workq->workq_name, buf, sizeof(crm_workq->workq_name));
 		INIT_WORK(&crm_workq->work, func);
-		spin_lock_init(&crm_workq->lock_bh);
-		CAM_DBG(CAM_CRM, "LOCK_DBG workq %s lock %pK",
-			name, &crm_workq->lock_bh);
+		spin_lock_init(&crm_workq->task.empty_lock);
 
 		/* Task attributes initialization */
 		atomic_set(&crm_workq->task.pending_cnt, 0);
 		atomic_set(&crm_workq->task.free_cnt, 0);
-		for (i = CRM_TASK_PRIORITY_0; i < CRM_TASK_PRIORITY_MAX; i++)
-			INIT_LIST_HEAD(&crm_workq->task.process_head[i]);
-		INIT_LIST_HEAD(&crm_workq->task.empty_head);
+		for (i = CRM_TASK_PRIORITY_0; i < CRM_TASK_PRIORITY_MAX; i++) {
+			init_llist_head(&crm_workq->task.process_head[i]);
+			crm_workq->task.process_batch[i] = NULL;
+		}
+		init_llist_head(&crm_workq->task.empty_head);
 		atomic_set(&crm_workq->flush, 0);
 		crm_workq->in_irq = in_irq;
 		crm_workq->task.num_task = num_tasks;
@@ -248,6 +275,7 @@ int cam_req_mgr_workq_create(char *name, int32_t num_tasks,
 			CAM_WARN(CAM_CRM, "Insufficient memory %zu",
 				sizeof(struct crm_workq_task) *
 				crm_workq->task.num_task);
+			destroy_workqueue(job);
 			kfree(crm_workq);
 			return -ENOMEM;
 		}
@@ -256,7 +284,6 @@ int cam_req_mgr_workq_create(char *name, int32_t num_tasks,
 			task = &crm_workq->task.pool[i];
 			task->parent = (void *)crm_workq;
 			/* Put all tasks in free pool */
-			INIT_LIST_HEAD(&task->entry);
 			cam_req_mgr_workq_put_task(task);
 		}
 		*workq = crm_workq;
@@ -269,34 +296,31 @@ int cam_req_mgr_workq_create(char *name, int32_t num_tasks,
 
 void cam_req_mgr_workq_destroy(struct cam_req_mgr_core_workq **crm_workq)
 {
-	unsigned long flags = 0;
 	struct workqueue_struct   *job;
 	struct cam_req_mgr_core_workq *workq;
-	int i;
 
 	if (crm_workq && *crm_workq) {
 		workq = *crm_workq;
 		CAM_DBG(CAM_CRM, "destroy workque %s", workq->workq_name);
-		WORKQ_ACQUIRE_LOCK(workq, flags);
 		/* prevent any processing of callbacks */
 		atomic_set(&workq->flush, 1);
-		if (workq->job) {
-			job = workq->job;
-			workq->job = NULL;
-			WORKQ_RELEASE_LOCK(workq, flags);
+		job = rcu_replace_pointer(workq->job, NULL, true);
+
+		/*
+		 * Enqueues that saw the job have queued their work once the
+		 * grace period ends, so destroying the job drains them. The
+		 * second grace period waits out enqueues that raced with the
+		 * first one and are only putting their task back.
+		 */
+		synchronize_rcu();
+		if (job)
 			destroy_workqueue(job);
-			WORKQ_ACQUIRE_LOCK(workq, flags);
-		}
+		synchronize_rcu();
+
 		/* Destroy workq payload data */
 		kfree(workq->task.pool[0].payload);
 		kfree(workq->task.pool);
-
-		/* Leave lists in stable state after freeing pool */
-		INIT_LIST_HEAD(&workq->task.empty_head);
-		for (i = 0; i < CRM_TASK_PRIORITY_MAX; i++)
-			INIT_LIST_HEAD(&workq->task.process_head[i]);
 		*crm_workq = NULL;
-		WORKQ_RELEASE_LOCK(workq, flags);
 		kfree(workq);
 	}
 }
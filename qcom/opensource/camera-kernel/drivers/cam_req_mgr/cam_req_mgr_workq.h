@@ -14,6 +14,8 @@
 #include <linux/workqueue.h>
 #include <linux/slab.h>
 #include <linux/timer.h>
+#include <linux/llist.h>
+#include <linux/rcupdate.h>
 
 /* Threshold for scheduling delay in ms */
 #define CAM_WORKQ_SCHEDULE_TIME_THRESHOLD   5
@@ -51,13 +53,15 @@ enum crm_workq_context {
  * @process_cb       : registered callback called by workq when task enqueued is
  *                     ready for processing in workq thread context
  * @parent           : workq's parent is link which is enqqueing taks to this workq
- * @entry            : list head of this list entry is worker's empty_head
+ * @entry            : lock-less list node, linked either on worker's
+ *                     empty_head or on one of its process_head lists
  * @cancel           : if caller has got free task from pool but wants to abort
  *                     or put back without using it
  * @priv             : when task is enqueuer caller can attach priv along which
  *                     it will get in process callback
  * @ret              : return value in future to use for blocking calls
- * @task_scheduled_ts: enqueue time of task
+ * @task_scheduled_ts: enqueue time of task, zero if delay detection was
+ *                     disabled when the task was enqueued
  */
 struct crm_workq_task {
 	int32_t                    priority;
@@ -65,7 +69,7 @@ struct crm_workq_task {
 	void                      *payload;
 	int32_t                  (*process_cb)(void *priv, void *data);
 	void                      *parent;
-	struct list_head           entry;
+	struct llist_node          entry;
 	uint8_t                    cancel;
 	void                      *priv;
 	ktime_t                    task_scheduled_ts;
@@ -73,8 +77,8 @@ struct crm_workq_task {
 
 /** struct cam_req_mgr_core_workq
  * @work        : work token used by workqueue
- * @job         : workqueue internal job struct
- * @lock_bh     : lock for task structs
+ * @job         : workqueue internal job struct, RCU protected so enqueue
+ *                can check it against workqueue destruction without a lock
  * @in_irq      : set true if workque can be used in irq context
  * @flush       : used to track if flush has been called on workqueue
  * @work_q_name : name of the workq
@@ -83,7 +87,11 @@ struct crm_workq_task {
  * @lock        : Current task's lock handle
  * @pending_cnt : # of tasks left in queue
  * @free_cnt    : # of free/available tasks
- * @process_head:
+ * @empty_lock  : serializes consumers of empty_head, producers are lock-less
+ * @process_head: lock-less multi producer lists of enqueued tasks, one per
+ *                priority, in LIFO order
+ * @process_batch: tasks moved off process_head in FIFO order, owned by the
+ *                worker
  * @empty_head  : list  head of available taska which can be used
  *                or acquired in order to enqueue a task to workq
  * @pool        : pool of tasks used for handling events in workq context
@@ -91,8 +99,7 @@ struct crm_workq_task {
  */
 struct cam_req_mgr_core_workq {
 	struct work_struct         work;
-	struct workqueue_struct   *job;
-	spinlock_t                 lock_bh;
+	struct workqueue_struct __rcu *job;
 	uint32_t                   in_irq;
 	ktime_t                    workq_scheduled_ts;
 	atomic_t                   flush;
@@ -103,9 +110,11 @@ struct cam_req_mgr_core_workq {
 		struct mutex           lock;
 		atomic_t               pending_cnt;
 		atomic_t               free_cnt;
+		spinlock_t             empty_lock;
 
-		struct list_head       process_head[CRM_TASK_PRIORITY_MAX];
-		struct list_head       empty_head;
+		struct llist_head      process_head[CRM_TASK_PRIORITY_MAX];
+		struct llist_node     *process_batch[CRM_TASK_PRIORITY_MAX];
+		struct llist_head      empty_head;
 		struct crm_workq_task *pool;
 		uint32_t               num_task;
 	} task;
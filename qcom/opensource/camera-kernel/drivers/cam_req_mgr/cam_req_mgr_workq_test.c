@@ -0,0 +1,324 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ * Copyright (c) 2024 Qualcomm Innovation Center, Inc. All rights reserved.
+ */
+
+#include <kunit/test.h>
+#include <linux/completion.h>
+#include <linux/kthread.h>
+
+#include "cam_req_mgr_workq.h"
+
+/*
+ * KUnit tests for the crm workq. Several producer threads enqueue a mix of
+ * priorities while the worker records how long each task waited, reported
+ * per priority. A second case holds the worker in a callback, queues both
+ * priorities behind it and checks that they run in strict priority and in
+ * FIFO order within a priority.
+ */
+
+#define CAM_WORKQ_TEST_NUM_TASKS     256
+#define CAM_WORKQ_TEST_PRODUCERS     4
+#define CAM_WORKQ_TEST_PER_PRODUCER  4096
+#define CAM_WORKQ_TEST_ORDERED       64
+#define CAM_WORKQ_TEST_TIMEOUT_MS    10000
+
+/**
+ * struct cam_workq_test_payload - Per pool task payload
+ *
+ * @enq_ts : Time the producer enqueued the task
+ * @prio   : Priority the task was enqueued with
+ * @seq    : Enqueue sequence number within @prio
+ */
+struct cam_workq_test_payload {
+	ktime_t enq_ts;
+	int32_t prio;
+	uint32_t seq;
+};
+
+/**
+ * struct cam_workq_test_stats - Per priority latency, updated by the worker
+ *
+ * @count  : Tasks run
+ * @sum_ns : Total enqueue to run time
+ * @max_ns : Worst enqueue to run time
+ */
+struct cam_workq_test_stats {
+	uint32_t count;
+	s64 sum_ns;
+	s64 max_ns;
+};
+
+/**
+ * struct cam_workq_test_ctx - Test state
+ *
+ * @workq       : Workq under test
+ * @stats       : Latency per priority
+ * @order       : Tasks in the order the worker ran them, ordered case only
+ * @num_order   : Valid entries in @order
+ * @blocker     : Completed to release the blocking callback
+ * @blocked     : Completed once the blocking callback runs
+ * @remaining   : Tasks that have not run yet
+ * @all_done    : Completed when @remaining drops to zero
+ * @enq_errors  : Enqueue calls that failed
+ * @stop        : Set to make the producers give up early
+ * @producers   : Producers still running
+ * @producers_done: Completed when @producers drops to zero
+ */
+struct cam_workq_test_ctx {
+	struct cam_req_mgr_core_workq *workq;
+	struct cam_workq_test_stats stats[CRM_TASK_PRIORITY_MAX];
+	struct cam_workq_test_payload order[2 * CAM_WORKQ_TEST_ORDERED];
+	uint32_t num_order;
+	struct completion blocker;
+	struct completion blocked;
+	atomic_t remaining;
+	struct completion all_done;
+	atomic_t enq_errors;
+	bool stop;
+	atomic_t producers;
+	struct completion producers_done;
+};
+
+static int cam_workq_test_latency_cb(void *priv, void *data)
+{
+	struct cam_workq_test_ctx *ctx = priv;
+	struct cam_workq_test_payload *payload = data;
+	struct cam_workq_test_stats *stats = &ctx->stats[payload->prio];
+	s64 delay_ns;
+
+	delay_ns = ktime_to_ns(ktime_sub(ktime_get(), payload->enq_ts));
+	stats->count++;
+	stats->sum_ns += delay_ns;
+	if (delay_ns > stats->max_ns)
+		stats->max_ns = delay_ns;
+
+	if (atomic_dec_and_test(&ctx->remaining))
+		complete(&ctx->all_done);
+
+	return 0;
+}
+
+static int cam_workq_test_order_cb(void *priv, void *data)
+{
+	struct cam_workq_test_ctx *ctx = priv;
+	struct cam_workq_test_payload *payload = data;
+
+	if (ctx->num_order < ARRAY_SIZE(ctx->order))
+		ctx->order[ctx->num_order++] = *payload;
+
+	if (atomic_dec_and_test(&ctx->remaining))
+		complete(&ctx->all_done);
+
+	return 0;
+}
+
+static int cam_workq_test_block_cb(void *priv, void *data)
+{
+	struct cam_workq_test_ctx *ctx = priv;
+
+	complete(&ctx->blocked);
+	wait_for_completion(&ctx->blocker);
+
+	return 0;
+}
+
+static int cam_workq_test_enqueue(struct cam_workq_test_ctx *ctx,
+	int32_t (*cb)(void *priv, void *data), int32_t prio, uint32_t seq)
+{
+	struct crm_workq_task *task;
+	struct cam_workq_test_payload *payload;
+
+	/* The pool is smaller than the load, wait for the worker to refill */
+	while (!(task = cam_req_mgr_workq_get_task(ctx->workq))) {
+		if (READ_ONCE(ctx->stop))
+			return -ETIMEDOUT;
+		cond_resched();
+	}
+
+	payload = task->payload;
+	payload->prio = prio;
+	payload->seq = seq;
+	payload->enq_ts = ktime_get();
+	task->process_cb = cb;
+
+	return cam_req_mgr_workq_enqueue_task(task, ctx, prio);
+}
+
+static int cam_workq_test_producer(void *data)
+{
+	struct cam_workq_test_ctx *ctx = data;
+	int32_t prio;
+	uint32_t i;
+
+	for (i = 0; i < CAM_WORKQ_TEST_PER_PRODUCER; i++) {
+		/* One in four tasks is high priority */
+		prio = (i & 3) ? CRM_TASK_PRIORITY_1 : CRM_TASK_PRIORITY_0;
+		if (cam_workq_test_enqueue(ctx, cam_workq_test_latency_cb,
+			prio, i)) {
+			atomic_inc(&ctx->enq_errors);
+			if (atomic_dec_and_test(&ctx->remaining))
+				complete(&ctx->all_done);
+		}
+	}
+
+	if (atomic_dec_and_test(&ctx->producers))
+		complete(&ctx->producers_done);
+
+	return 0;
+}
+
+static int cam_workq_test_init(struct kunit *test)
+{
+	struct cam_workq_test_ctx *ctx;
+	struct cam_workq_test_payload *payloads;
+	int rc, i;
+
+	ctx = kunit_kzalloc(test, sizeof(*ctx), GFP_KERNEL);
+	if (!ctx)
+		return -ENOMEM;
+
+	rc = cam_req_mgr_workq_create("kunit", CAM_WORKQ_TEST_NUM_TASKS,
+		&ctx->workq, CRM_WORKQ_USAGE_NON_IRQ,
+		CAM_WORKQ_FLAG_HIGH_PRIORITY | CAM_WORKQ_FLAG_SERIAL,
+		cam_req_mgr_process_workq);
+	if (rc)
+		return rc;
+
+	/* Freed by cam_req_mgr_workq_destroy() like any other workq payload */
+	payloads = kcalloc(CAM_WORKQ_TEST_NUM_TASKS, sizeof(*payloads),
+		GFP_KERNEL);
+	if (!payloads) {
+		cam_req_mgr_workq_destroy(&ctx->workq);
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < CAM_WORKQ_TEST_NUM_TASKS; i++)
+		ctx->workq->task.pool[i].payload = &payloads[i];
+
+	init_completion(&ctx->blocker);
+	init_completion(&ctx->blocked);
+	init_completion(&ctx->all_done);
+	init_completion(&ctx->producers_done);
+	atomic_set(&ctx->enq_errors, 0);
+	test->priv = ctx;
+
+	return 0;
+}
+
+static void cam_workq_test_exit(struct kunit *test)
+{
+	struct cam_workq_test_ctx *ctx = test->priv;
+
+	if (!ctx)
+		return;
+
+	/* A failed case may have left the worker blocked in a callback */
+	complete_all(&ctx->blocker);
+	cam_req_mgr_workq_destroy(&ctx->workq);
+}
+
+static void cam_workq_test_latency(struct kunit *test)
+{
+	struct cam_workq_test_ctx *ctx = test->priv;
+	struct task_struct *producer;
+	struct cam_workq_test_stats *stats;
+	uint32_t total = CAM_WORKQ_TEST_PRODUCERS * CAM_WORKQ_TEST_PER_PRODUCER;
+	uint32_t ran = 0, i;
+	bool timeout;
+
+	atomic_set(&ctx->remaining, total);
+	atomic_set(&ctx->producers, CAM_WORKQ_TEST_PRODUCERS);
+	for (i = 0; i < CAM_WORKQ_TEST_PRODUCERS; i++) {
+		producer = kthread_run(cam_workq_test_producer, ctx,
+			"cam_workq_kunit%u", i);
+		if (IS_ERR(producer)) {
+			KUNIT_FAIL(test, "producer %u failed to start", i);
+			WRITE_ONCE(ctx->stop, true);
+			if (atomic_dec_and_test(&ctx->producers))
+				complete(&ctx->producers_done);
+		}
+	}
+
+	timeout = !wait_for_completion_timeout(&ctx->all_done,
+		msecs_to_jiffies(CAM_WORKQ_TEST_TIMEOUT_MS));
+
+	/* The workq is destroyed on exit, no producer may still be using it */
+	WRITE_ONCE(ctx->stop, true);
+	wait_for_completion(&ctx->producers_done);
+	KUNIT_ASSERT_FALSE(test, timeout);
+	KUNIT_EXPECT_EQ(test, atomic_read(&ctx->enq_errors), 0);
+
+	for (i = 0; i < CRM_TASK_PRIORITY_MAX; i++) {
+		stats = &ctx->stats[i];
+		ran += stats->count;
+		if (!stats->count)
+			continue;
+
+		kunit_info(test, "priority %u: %u tasks, avg %lld ns, max %lld ns\n",
+			i, stats->count, div_s64(stats->sum_ns, stats->count),
+			stats->max_ns);
+	}
+
+	KUNIT_EXPECT_EQ(test, ran, total);
+	KUNIT_EXPECT_EQ(test, ctx->stats[CRM_TASK_PRIORITY_0].count, total / 4);
+	KUNIT_EXPECT_EQ(test, atomic_read(&ctx->workq->task.pending_cnt), 0);
+	KUNIT_EXPECT_EQ(test, atomic_read(&ctx->workq->task.free_cnt),
+		CAM_WORKQ_TEST_NUM_TASKS);
+}
+
+static void cam_workq_test_strict_priority(struct kunit *test)
+{
+	struct cam_workq_test_ctx *ctx = test->priv;
+	struct cam_workq_test_payload *entry;
+	uint32_t next_seq[CRM_TASK_PRIORITY_MAX] = {0};
+	uint32_t i, out_of_order = 0;
+	bool low_seen = false;
+
+	KUNIT_ASSERT_EQ(test, cam_workq_test_enqueue(ctx,
+		cam_workq_test_block_cb, CRM_TASK_PRIORITY_0, 0), 0);
+	KUNIT_ASSERT_TRUE(test, wait_for_completion_timeout(&ctx->blocked,
+		msecs_to_jiffies(CAM_WORKQ_TEST_TIMEOUT_MS)));
+
+	/* Low priority first, so FIFO alone would run it first */
+	atomic_set(&ctx->remaining, 2 * CAM_WORKQ_TEST_ORDERED);
+	for (i = 0; i < CAM_WORKQ_TEST_ORDERED; i++)
+		KUNIT_EXPECT_EQ(test, cam_workq_test_enqueue(ctx,
+			cam_workq_test_order_cb, CRM_TASK_PRIORITY_1, i), 0);
+	for (i = 0; i < CAM_WORKQ_TEST_ORDERED; i++)
+		KUNIT_EXPECT_EQ(test, cam_workq_test_enqueue(ctx,
+			cam_workq_test_order_cb, CRM_TASK_PRIORITY_0, i), 0);
+
+	complete(&ctx->blocker);
+	KUNIT_ASSERT_TRUE(test, wait_for_completion_timeout(&ctx->all_done,
+		msecs_to_jiffies(CAM_WORKQ_TEST_TIMEOUT_MS)));
+	KUNIT_ASSERT_EQ(test, ctx->num_order, 2 * CAM_WORKQ_TEST_ORDERED);
+
+	for (i = 0; i < ctx->num_order; i++) {
+		entry = &ctx->order[i];
+		if (entry->prio == CRM_TASK_PRIORITY_1)
+			low_seen = true;
+		else if (low_seen)
+			out_of_order++;
+
+		if (entry->seq != next_seq[entry->prio]++)
+			out_of_order++;
+	}
+
+	KUNIT_EXPECT_EQ(test, out_of_order, 0);
+}
+
+static struct kunit_case cam_workq_test_cases[] = {
+	KUNIT_CASE(cam_workq_test_latency),
+	KUNIT_CASE(cam_workq_test_strict_priority),
+	{}
+};
+
+static struct kunit_suite cam_workq_test_suite = {
+	.name = "cam_req_mgr_workq",
+	.init = cam_workq_test_init,
+	.exit = cam_workq_test_exit,
+	.test_cases = cam_workq_test_cases,
+};
+
+kunit_test_suite(cam_workq_test_suite);
@@ -144,6 +144,7 @@ int cam_sync_register_callback(sync_callback cb_func,
 {
 	struct sync_callback_info *sync_cb;
 	struct sync_table_row *row = NULL;
+	struct list_head cb_list;
 	int status = 0, rc = 0;
 
 	if ((sync_obj >= CAM_SYNC_MAX_OBJS) || (sync_obj <= 0) || (!cb_func))
@@ -160,7 +161,7 @@ int cam_sync_register_callback(sync_callback cb_func,
 		goto monitor_dump;
 	}
 
-	sync_cb = kzalloc(sizeof(*sync_cb), GFP_ATOMIC);
+	sync_cb = cam_sync_util_cb_alloc();
 	if (!sync_cb) {
 		rc = -ENOMEM;
 		goto monitor_dump;
@@ -181,22 +182,21 @@ int cam_sync_register_callback(sync_callback cb_func,
 				row->name,
 				sync_obj);
 			status = row->state;
-			kfree(sync_cb);
+			cam_sync_util_cb_free(sync_cb);
 			spin_unlock_bh(&sync_dev->row_spinlocks[sync_obj]);
 			cb_func(sync_obj, status, userdata);
 		} else {
 			sync_cb->callback_func = cb_func;
 			sync_cb->cb_data = userdata;
 			sync_cb->sync_obj = sync_obj;
-			INIT_WORK(&sync_cb->cb_dispatch_work,
-				cam_sync_util_cb_dispatch);
 			sync_cb->status = row->state;
 			CAM_DBG(CAM_SYNC, "Enqueue callback for sync object:%s[%d]",
 				row->name,
 				sync_cb->sync_obj);
 			sync_cb->workq_scheduled_ts = ktime_get();
-			queue_work(sync_dev->work_queue,
-				&sync_cb->cb_dispatch_work);
+			INIT_LIST_HEAD(&cb_list);
+			list_add_tail(&sync_cb->list, &cb_list);
+			cam_sync_util_cb_enqueue(&cb_list);
 			spin_unlock_bh(&sync_dev->row_spinlocks[sync_obj]);
 		}
 
@@ -206,7 +206,6 @@ int cam_sync_register_callback(sync_callback cb_func,
 	sync_cb->callback_func = cb_func;
 	sync_cb->cb_data = userdata;
 	sync_cb->sync_obj = sync_obj;
-	INIT_WORK(&sync_cb->cb_dispatch_work, cam_sync_util_cb_dispatch);
 	list_add_tail(&sync_cb->list, &row->callback_list);
 
 	if (test_bit(CAM_GENERIC_FENCE_TYPE_SYNC_OBJ, &cam_sync_monitor_mask))
@@ -252,7 +251,7 @@ int cam_sync_deregister_callback(sync_callback cb_func,
 		if ((sync_cb->callback_func == cb_func) &&
 			(sync_cb->cb_data == userdata)) {
 			list_del_init(&sync_cb->list);
-			kfree(sync_cb);
+			cam_sync_util_cb_free(sync_cb);
 			found = true;
 		}
 	}
@@ -2790,6 +2789,8 @@ static int cam_sync_component_bind(struct device *dev,
 	for (idx = 0; idx < CAM_SYNC_MAX_OBJS; idx++)
 		spin_lock_init(&sync_dev->row_spinlocks[idx]);
 
+	cam_sync_util_cb_init();
+
 	sync_dev->vdev = video_device_alloc();
 	if (!sync_dev->vdev) {
 		rc = -ENOMEM;
@@ -44,6 +44,7 @@
 #define CAM_SYNC_PAYLOAD_WORDS          2
 #define CAM_SYNC_NAME                   "cam_sync"
 #define CAM_SYNC_WORKQUEUE_NAME         "HIPRIO_SYNC_WORK_QUEUE"
+#define CAM_SYNC_CB_POOL_SIZE           256
 
 #define CAM_SYNC_TYPE_INDV              0
 #define CAM_SYNC_TYPE_GROUP             1
@@ -135,7 +136,6 @@ struct sync_child_info {
  * @status             : Status with which callback will be invoked in client
  * @sync_obj           : Sync id of the object for which callback is registered
  * @workq_scheduled_ts : workqueue scheduled timestamp
- * @cb_dispatch_work   : Work representing the call dispatch
  * @list               : List member used to append this node to a linked list
  */
 struct sync_callback_info {
@@ -144,7 +144,6 @@ struct sync_callback_info {
 	int status;
 	int32_t sync_obj;
 	ktime_t workq_scheduled_ts;
-	struct work_struct cb_dispatch_work;
 	struct list_head list;
 };
 
@@ -351,6 +350,15 @@ struct cam_signalable_info {
  * @open_cnt        : Count of file open calls made on the sync driver
  * @dentry          : Debugfs entry
  * @work_queue      : Work queue used for dispatching kernel callbacks
+ * @cb_dispatch_work : Single work item dispatching all signaled kernel
+ *                     callbacks queued in @cb_dispatch_list
+ * @cb_dispatch_list : Kernel callbacks of signaled objects pending dispatch
+ * @cb_dispatch_lock : Lock protecting @cb_dispatch_list
+ * @cb_pool         : Preallocated kernel callback nodes
+ * @cb_free_list    : Free nodes of @cb_pool
+ * @cb_pool_lock    : Lock protecting @cb_free_list
+ * @cb_allocs       : Callback nodes allocated because @cb_pool was empty,
+ *                    only kept for KUnit tests
  * @cam_sync_eventq : Event queue used to dispatch user payloads to user space
  * @bitmap          : Bitmap representation of all sync objects
  * @mon_data        : Objects monitor data
@@ -366,6 +374,15 @@ struct sync_device {
 	int open_cnt;
 	struct dentry *dentry;
 	struct workqueue_struct *work_queue;
+	struct work_struct cb_dispatch_work;
+	struct list_head cb_dispatch_list;
+	spinlock_t cb_dispatch_lock;
+	struct sync_callback_info cb_pool[CAM_SYNC_CB_POOL_SIZE];
+	struct list_head cb_free_list;
+	spinlock_t cb_pool_lock;
+#ifdef CONFIG_SPECTRA_KUNIT_TEST
+	atomic_t cb_allocs;
+#endif
 	struct v4l2_fh *cam_sync_eventq;
 	spinlock_t cam_sync_eventq_lock;
 	DECLARE_BITMAP(bitmap, CAM_SYNC_MAX_OBJS);
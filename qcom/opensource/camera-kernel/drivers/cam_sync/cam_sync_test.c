@@ -0,0 +1,411 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ * Copyright (c) 2024 Qualcomm Innovation Center, Inc. All rights reserved.
+ */
+
+#include <kunit/test.h>
+#include <linux/completion.h>
+#include <linux/kthread.h>
+#include <linux/sort.h>
+
+#include "cam_sync_api.h"
+#include "cam_sync_util.h"
+
+/*
+ * KUnit tests for the pooled callback nodes and the batched kernel callback
+ * dispatch of cam_sync. They run against the bound sync device through the
+ * exported API, so they are meant to run at module load before any camera
+ * session has been opened.
+ */
+
+#define CAM_SYNC_TEST_WORKERS      4
+#define CAM_SYNC_TEST_ROUNDS       64
+#define CAM_SYNC_TEST_OBJS         16
+#define CAM_SYNC_TEST_CBS          8
+#define CAM_SYNC_TEST_EXTRA_NODES  16
+#define CAM_SYNC_TEST_TIMEOUT_MS   5000
+#define CAM_SYNC_TEST_LAT_SIGNALS  256
+
+struct cam_sync_test_obj;
+struct cam_sync_test_worker;
+
+/**
+ * struct cam_sync_test_cb - Per registered callback test record
+ *
+ * @obj   : Object the callback was registered on
+ * @idx   : Registration index on @obj, CAM_SYNC_TEST_CBS for a callback
+ *          registered after the signal
+ * @calls : Number of times the callback ran
+ */
+struct cam_sync_test_cb {
+	struct cam_sync_test_obj *obj;
+	uint32_t idx;
+	atomic_t calls;
+};
+
+/**
+ * struct cam_sync_test_obj - Per sync object test state
+ *
+ * @sync_obj : Sync object handle
+ * @seq      : Number of in-order callbacks that ran on @sync_obj
+ * @cbs      : Callback records, the last one is registered after the signal
+ * @worker   : Owning worker
+ */
+struct cam_sync_test_obj {
+	int32_t sync_obj;
+	atomic_t seq;
+	struct cam_sync_test_cb cbs[CAM_SYNC_TEST_CBS + 1];
+	struct cam_sync_test_worker *worker;
+};
+
+/**
+ * struct cam_sync_test_worker - Stress worker state
+ *
+ * @objs         : Objects created in each round
+ * @remaining    : Callbacks of the current round that have not run yet
+ * @round_done   : Completed when @remaining drops to zero
+ * @done         : Completed when the worker exits
+ * @dispatched   : Callbacks run over all rounds
+ * @order_errors : Callbacks that ran out of registration order
+ * @status_errors: Callbacks that ran with a wrong status
+ * @dup_errors   : Callbacks that ran more than once
+ * @api_errors   : Failed create/register/signal/destroy calls
+ * @timeouts     : Rounds whose callbacks did not all run in time
+ */
+struct cam_sync_test_worker {
+	struct cam_sync_test_obj objs[CAM_SYNC_TEST_OBJS];
+	atomic_t remaining;
+	struct completion round_done;
+	struct completion done;
+	atomic_t dispatched;
+	atomic_t order_errors;
+	atomic_t status_errors;
+	atomic_t dup_errors;
+	uint32_t api_errors;
+	uint32_t timeouts;
+};
+
+/**
+ * struct cam_sync_test_lat - Per signal latency test state
+ *
+ * @remaining : Callbacks of the signaled object that have not run yet
+ * @done      : Completed when @remaining drops to zero
+ * @done_ts   : Time the last callback of the object ran
+ */
+struct cam_sync_test_lat {
+	atomic_t remaining;
+	struct completion done;
+	ktime_t done_ts;
+};
+
+static void cam_sync_test_cb_func(int32_t sync_obj, int status, void *data)
+{
+	struct cam_sync_test_cb *cb = data;
+	struct cam_sync_test_obj *obj = cb->obj;
+	struct cam_sync_test_worker *worker = obj->worker;
+
+	if (atomic_inc_return(&cb->calls) != 1)
+		atomic_inc(&worker->dup_errors);
+
+	if ((sync_obj != obj->sync_obj) ||
+		(status != CAM_SYNC_STATE_SIGNALED_SUCCESS))
+		atomic_inc(&worker->status_errors);
+
+	/*
+	 * Callbacks registered before the signal are dispatched by the single
+	 * dispatch work in registration order. The late one may run inline.
+	 */
+	if ((cb->idx < CAM_SYNC_TEST_CBS) &&
+		((atomic_inc_return(&obj->seq) - 1) != cb->idx))
+		atomic_inc(&worker->order_errors);
+
+	atomic_inc(&worker->dispatched);
+	if (atomic_dec_and_test(&worker->remaining))
+		complete(&worker->round_done);
+}
+
+static void cam_sync_test_round(struct cam_sync_test_worker *worker)
+{
+	struct cam_sync_test_obj *obj;
+	int i, j;
+
+	reinit_completion(&worker->round_done);
+	atomic_set(&worker->remaining,
+		CAM_SYNC_TEST_OBJS * (CAM_SYNC_TEST_CBS + 1));
+
+	for (i = 0; i < CAM_SYNC_TEST_OBJS; i++) {
+		obj = &worker->objs[i];
+		obj->worker = worker;
+		atomic_set(&obj->seq, 0);
+		for (j = 0; j <= CAM_SYNC_TEST_CBS; j++) {
+			obj->cbs[j].obj = obj;
+			obj->cbs[j].idx = j;
+			atomic_set(&obj->cbs[j].calls, 0);
+		}
+
+		if (cam_sync_create(&obj->sync_obj, "cam_sync_kunit")) {
+			worker->api_errors++;
+			obj->sync_obj = 0;
+			atomic_sub(CAM_SYNC_TEST_CBS + 1, &worker->remaining);
+			continue;
+		}
+
+		for (j = 0; j < CAM_SYNC_TEST_CBS; j++) {
+			if (cam_sync_register_callback(cam_sync_test_cb_func,
+				&obj->cbs[j], obj->sync_obj)) {
+				worker->api_errors++;
+				atomic_dec(&worker->remaining);
+			}
+		}
+	}
+
+	for (i = 0; i < CAM_SYNC_TEST_OBJS; i++) {
+		obj = &worker->objs[i];
+		if (!obj->sync_obj)
+			continue;
+
+		if (cam_sync_signal(obj->sync_obj,
+			CAM_SYNC_STATE_SIGNALED_SUCCESS,
+			CAM_SYNC_COMMON_EVENT_SUCCESS))
+			worker->api_errors++;
+
+		/* Already signaled, takes the late registration path */
+		if (cam_sync_register_callback(cam_sync_test_cb_func,
+			&obj->cbs[CAM_SYNC_TEST_CBS], obj->sync_obj)) {
+			worker->api_errors++;
+			atomic_dec(&worker->remaining);
+		}
+	}
+
+	if (atomic_read(&worker->remaining) &&
+		!wait_for_completion_timeout(&worker->round_done,
+		msecs_to_jiffies(CAM_SYNC_TEST_TIMEOUT_MS)))
+		worker->timeouts++;
+
+	for (i = 0; i < CAM_SYNC_TEST_OBJS; i++) {
+		obj = &worker->objs[i];
+		if (obj->sync_obj && cam_sync_destroy(obj->sync_obj))
+			worker->api_errors++;
+	}
+}
+
+static int cam_sync_test_worker_fn(void *data)
+{
+	struct cam_sync_test_worker *worker = data;
+	int i;
+
+	for (i = 0; i < CAM_SYNC_TEST_ROUNDS; i++) {
+		cam_sync_test_round(worker);
+		if (worker->timeouts)
+			break;
+	}
+
+	complete(&worker->done);
+	return 0;
+}
+
+static int cam_sync_test_init(struct kunit *test)
+{
+	if (!sync_dev)
+		kunit_skip(test, "sync device is not bound");
+
+	return 0;
+}
+
+static void cam_sync_test_lat_cb_func(int32_t sync_obj, int status,
+	void *data)
+{
+	struct cam_sync_test_lat *lat = data;
+
+	if (atomic_dec_and_test(&lat->remaining)) {
+		lat->done_ts = ktime_get();
+		complete(&lat->done);
+	}
+}
+
+static int cam_sync_test_cmp_s64(const void *a, const void *b)
+{
+	s64 x = *(const s64 *)a, y = *(const s64 *)b;
+
+	return (x > y) - (x < y);
+}
+
+static inline bool cam_sync_test_is_pooled(struct sync_callback_info *cb_info)
+{
+	return (cb_info >= sync_dev->cb_pool) &&
+		(cb_info < sync_dev->cb_pool + CAM_SYNC_CB_POOL_SIZE);
+}
+
+static void cam_sync_test_cb_pool(struct kunit *test)
+{
+	struct sync_callback_info **nodes;
+	uint32_t num_nodes = CAM_SYNC_CB_POOL_SIZE + CAM_SYNC_TEST_EXTRA_NODES;
+	uint32_t pooled[2] = {0}, zeroed, round, i;
+
+	nodes = kunit_kcalloc(test, num_nodes, sizeof(*nodes), GFP_KERNEL);
+	KUNIT_ASSERT_NOT_NULL(test, nodes);
+
+	/* Drain the pool twice, the second run must see every node back */
+	for (round = 0; round < 2; round++) {
+		zeroed = 0;
+		for (i = 0; i < num_nodes; i++) {
+			nodes[i] = cam_sync_util_cb_alloc();
+			KUNIT_ASSERT_NOT_NULL(test, nodes[i]);
+			if (cam_sync_test_is_pooled(nodes[i]))
+				pooled[round]++;
+			if (!nodes[i]->callback_func && !nodes[i]->cb_data &&
+				!nodes[i]->sync_obj)
+				zeroed++;
+			nodes[i]->callback_func = cam_sync_test_cb_func;
+			nodes[i]->cb_data = nodes;
+			nodes[i]->sync_obj = i + 1;
+		}
+
+		KUNIT_EXPECT_EQ(test, zeroed, num_nodes);
+		KUNIT_EXPECT_LE(test, pooled[round],
+			(uint32_t)CAM_SYNC_CB_POOL_SIZE);
+		KUNIT_EXPECT_GE(test, num_nodes - pooled[round],
+			(uint32_t)CAM_SYNC_TEST_EXTRA_NODES);
+
+		for (i = 0; i < num_nodes; i++)
+			cam_sync_util_cb_free(nodes[i]);
+	}
+
+	KUNIT_EXPECT_EQ(test, pooled[0], pooled[1]);
+}
+
+static void cam_sync_test_cb_stress(struct kunit *test)
+{
+	struct cam_sync_test_worker *workers;
+	struct task_struct *task;
+	uint32_t expected, dispatched = 0, signals, allocs, i;
+	ktime_t start;
+	s64 elapsed_us;
+
+	workers = kunit_kcalloc(test, CAM_SYNC_TEST_WORKERS, sizeof(*workers),
+		GFP_KERNEL);
+	KUNIT_ASSERT_NOT_NULL(test, workers);
+
+	allocs = atomic_read(&sync_dev->cb_allocs);
+	start = ktime_get();
+	for (i = 0; i < CAM_SYNC_TEST_WORKERS; i++) {
+		init_completion(&workers[i].round_done);
+		init_completion(&workers[i].done);
+		task = kthread_run(cam_sync_test_worker_fn, &workers[i],
+			"cam_sync_kunit%u", i);
+		if (IS_ERR(task)) {
+			workers[i].api_errors++;
+			complete(&workers[i].done);
+		}
+	}
+
+	for (i = 0; i < CAM_SYNC_TEST_WORKERS; i++) {
+		wait_for_completion(&workers[i].done);
+		KUNIT_EXPECT_EQ(test, workers[i].api_errors, 0);
+		KUNIT_EXPECT_EQ(test, workers[i].timeouts, 0);
+		KUNIT_EXPECT_EQ(test, atomic_read(&workers[i].order_errors), 0);
+		KUNIT_EXPECT_EQ(test,
+			atomic_read(&workers[i].status_errors), 0);
+		KUNIT_EXPECT_EQ(test, atomic_read(&workers[i].dup_errors), 0);
+		dispatched += atomic_read(&workers[i].dispatched);
+	}
+	elapsed_us = ktime_us_delta(ktime_get(), start);
+	allocs = atomic_read(&sync_dev->cb_allocs) - allocs;
+
+	/* Nothing may still reference the records once they are freed */
+	flush_workqueue(sync_dev->work_queue);
+
+	expected = CAM_SYNC_TEST_WORKERS * CAM_SYNC_TEST_ROUNDS *
+		CAM_SYNC_TEST_OBJS * (CAM_SYNC_TEST_CBS + 1);
+	KUNIT_EXPECT_EQ(test, dispatched, expected);
+
+	/*
+	 * All workers together keep more callbacks registered than the pool
+	 * holds, so some nodes are allocated. Report how many per signal.
+	 */
+	signals = CAM_SYNC_TEST_WORKERS * CAM_SYNC_TEST_ROUNDS *
+		CAM_SYNC_TEST_OBJS;
+	kunit_info(test,
+		"%u callbacks on %u objects in %lld us, %u node allocations (%u.%02u per signal)\n",
+		dispatched, signals, elapsed_us, allocs,
+		allocs / signals, ((allocs % signals) * 100) / signals);
+}
+
+/*
+ * Time from cam_sync_signal() to the last of its callbacks having run,
+ * which is the delay a signaled client sees through the dispatch work,
+ * and the callback nodes allocated on the way while the pool is not
+ * exhausted.
+ */
+static void cam_sync_test_cb_latency(struct kunit *test)
+{
+	struct cam_sync_test_lat lat;
+	ktime_t signal_ts;
+	s64 *samples, total_ns = 0;
+	uint32_t allocs, signals = 0, i, j;
+	int32_t sync_obj;
+
+	samples = kunit_kcalloc(test, CAM_SYNC_TEST_LAT_SIGNALS,
+		sizeof(*samples), GFP_KERNEL);
+	KUNIT_ASSERT_NOT_NULL(test, samples);
+
+	init_completion(&lat.done);
+	allocs = atomic_read(&sync_dev->cb_allocs);
+
+	for (i = 0; i < CAM_SYNC_TEST_LAT_SIGNALS; i++) {
+		KUNIT_ASSERT_EQ(test,
+			cam_sync_create(&sync_obj, "cam_sync_kunit_lat"), 0);
+
+		reinit_completion(&lat.done);
+		atomic_set(&lat.remaining, CAM_SYNC_TEST_CBS);
+		for (j = 0; j < CAM_SYNC_TEST_CBS; j++)
+			KUNIT_EXPECT_EQ(test, cam_sync_register_callback(
+				cam_sync_test_lat_cb_func, &lat, sync_obj), 0);
+
+		signal_ts = ktime_get();
+		KUNIT_EXPECT_EQ(test, cam_sync_signal(sync_obj,
+			CAM_SYNC_STATE_SIGNALED_SUCCESS,
+			CAM_SYNC_COMMON_EVENT_SUCCESS), 0);
+
+		if (!wait_for_completion_timeout(&lat.done,
+			msecs_to_jiffies(CAM_SYNC_TEST_TIMEOUT_MS))) {
+			KUNIT_FAIL(test, "callbacks of signal %u did not run", i);
+			/* The callbacks may still run on the stack record */
+			flush_workqueue(sync_dev->work_queue);
+			cam_sync_destroy(sync_obj);
+			break;
+		}
+
+		samples[signals] = ktime_to_ns(ktime_sub(lat.done_ts,
+			signal_ts));
+		total_ns += samples[signals++];
+		KUNIT_EXPECT_EQ(test, cam_sync_destroy(sync_obj), 0);
+	}
+	allocs = atomic_read(&sync_dev->cb_allocs) - allocs;
+
+	KUNIT_ASSERT_GT(test, signals, 0U);
+	sort(samples, signals, sizeof(*samples), cam_sync_test_cmp_s64, NULL);
+
+	/* Every node comes from the pool while it is not exhausted */
+	KUNIT_EXPECT_EQ(test, allocs, 0U);
+	kunit_info(test,
+		"%u signals of %u callbacks: avg %lld ns p50 %lld ns p99 %lld ns max %lld ns, %u node allocations\n",
+		signals, CAM_SYNC_TEST_CBS, div_s64(total_ns, signals),
+		samples[signals / 2], samples[(signals * 99) / 100],
+		samples[signals - 1], allocs);
+}
+
+static struct kunit_case cam_sync_test_cases[] = {
+	KUNIT_CASE(cam_sync_test_cb_pool),
+	KUNIT_CASE(cam_sync_test_cb_stress),
+	KUNIT_CASE(cam_sync_test_cb_latency),
+	{}
+};
+
+static struct kunit_suite cam_sync_test_suite = {
+	.name = "cam_sync",
+	.init = cam_sync_test_init,
+	.test_cases = cam_sync_test_cases,
+};
+
+kunit_test_suite(cam_sync_test_suite);
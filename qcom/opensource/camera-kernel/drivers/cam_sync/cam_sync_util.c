@@ -580,7 +580,7 @@ int cam_sync_deinit_object(struct sync_table_row *table, uint32_t idx,
 	list_for_each_entry_safe(sync_cb, temp_cb,
 			&row->callback_list, list) {
 		list_del_init(&sync_cb->list);
-		kfree(sync_cb);
+		cam_sync_util_cb_free(sync_cb);
 	}
 
 	/* Decrement ref cnt for imported dma fence */
@@ -623,21 +623,144 @@ int cam_sync_deinit_object(struct sync_table_row *table, uint32_t idx,
 	return 0;
 }
 
+void cam_sync_util_cb_init(void)
+{
+	int i;
+
+	INIT_LIST_HEAD(&sync_dev->cb_free_list);
+	spin_lock_init(&sync_dev->cb_pool_lock);
+	for (i = 0; i < CAM_SYNC_CB_POOL_SIZE; i++)
+		list_add_tail(&sync_dev->cb_pool[i].list, &sync_dev->cb_free_list);
+
+	INIT_LIST_HEAD(&sync_dev->cb_dispatch_list);
+	spin_lock_init(&sync_dev->cb_dispatch_lock);
+	INIT_WORK(&sync_dev->cb_dispatch_work, cam_sync_util_cb_dispatch);
+}
+
+static inline bool cam_sync_util_cb_is_pooled(
+	struct sync_callback_info *cb_info)
+{
+	return (cb_info >= sync_dev->cb_pool) &&
+		(cb_info < sync_dev->cb_pool + CAM_SYNC_CB_POOL_SIZE);
+}
+
+struct sync_callback_info *cam_sync_util_cb_alloc(void)
+{
+	struct sync_callback_info *cb_info = NULL;
+
+	spin_lock_bh(&sync_dev->cb_pool_lock);
+	if (!list_empty(&sync_dev->cb_free_list)) {
+		cb_info = list_first_entry(&sync_dev->cb_free_list,
+			struct sync_callback_info, list);
+		list_del(&cb_info->list);
+	}
+	spin_unlock_bh(&sync_dev->cb_pool_lock);
+
+	if (!cb_info) {
+		CAM_DBG(CAM_SYNC, "Callback pool exhausted, allocating node");
+#ifdef CONFIG_SPECTRA_KUNIT_TEST
+		atomic_inc(&sync_dev->cb_allocs);
+#endif
+		return kzalloc(sizeof(*cb_info), GFP_ATOMIC);
+	}
+
+	memset(cb_info, 0, sizeof(*cb_info));
+	return cb_info;
+}
+
+void cam_sync_util_cb_free(struct sync_callback_info *cb_info)
+{
+	if (!cam_sync_util_cb_is_pooled(cb_info)) {
+		kfree(cb_info);
+		return;
+	}
+
+	spin_lock_bh(&sync_dev->cb_pool_lock);
+	list_add(&cb_info->list, &sync_dev->cb_free_list);
+	spin_unlock_bh(&sync_dev->cb_pool_lock);
+}
+
+void cam_sync_util_cb_enqueue(struct list_head *cb_list)
+{
+	if (list_empty(cb_list))
+		return;
+
+	spin_lock_bh(&sync_dev->cb_dispatch_lock);
+	list_splice_tail_init(cb_list, &sync_dev->cb_dispatch_list);
+	spin_unlock_bh(&sync_dev->cb_dispatch_lock);
+
+	/* No-op if already pending, the pending run picks these up too */
+	queue_work(sync_dev->work_queue, &sync_dev->cb_dispatch_work);
+}
+
 void cam_sync_util_cb_dispatch(struct work_struct *cb_dispatch_work)
 {
-	struct sync_callback_info *cb_info = container_of(cb_dispatch_work,
-		struct sync_callback_info,
-		cb_dispatch_work);
-	sync_callback sync_data = cb_info->callback_func;
-	void *cb = cb_info->callback_func;
-
-	cam_common_util_thread_switch_delay_detect(
-		"cam_sync_workq", "schedule", cb,
-		cb_info->workq_scheduled_ts,
-		CAM_WORKQ_SCHEDULE_TIME_THRESHOLD);
-	sync_data(cb_info->sync_obj, cb_info->status, cb_info->cb_data);
-
-	kfree(cb_info);
+	struct sync_callback_info *cb_info, *temp_cb_info;
+	struct list_head dispatch_list;
+
+	INIT_LIST_HEAD(&dispatch_list);
+	spin_lock_bh(&sync_dev->cb_dispatch_lock);
+	list_splice_init(&sync_dev->cb_dispatch_list, &dispatch_list);
+	spin_unlock_bh(&sync_dev->cb_dispatch_lock);
+
+	list_for_each_entry_safe(cb_info, temp_cb_info, &dispatch_list, list) {
+		sync_callback sync_data = cb_info->callback_func;
+		void *cb = cb_info->callback_func;
+
+		list_del_init(&cb_info->list);
+		cam_common_util_thread_switch_delay_detect(
+			"cam_sync_workq", "schedule", cb,
+			cb_info->workq_scheduled_ts,
+			CAM_WORKQ_SCHEDULE_TIME_THRESHOLD);
+		sync_data(cb_info->sync_obj, cb_info->status, cb_info->cb_data);
+
+		cam_sync_util_cb_free(cb_info);
+	}
+}
+
+/**
+ * cam_sync_util_prepare_v4l2_event() - Fill the V4L2 event header for a
+ * sync object notification
+ *
+ * @event       : Event to fill
+ * @id          : V4L event id to send
+ * @sync_obj    : Sync obj for which event needs to be sent
+ * @status      : Status of the event
+ * @event_cause : Event paramenter
+ *
+ * Return: Pointer to the payload area of @event
+ */
+static __u64 *cam_sync_util_prepare_v4l2_event(struct v4l2_event *event,
+	uint32_t id, uint32_t sync_obj, int status, uint32_t event_cause)
+{
+	__u64 *payload_data = NULL;
+
+	if (sync_dev->version == CAM_SYNC_V4L_EVENT_V2) {
+		struct cam_sync_ev_header_v2 *ev_header = NULL;
+
+		event->id = id;
+		event->type = CAM_SYNC_V4L_EVENT_V2;
+
+		ev_header = CAM_SYNC_GET_HEADER_PTR_V2((*event));
+		ev_header->sync_obj = sync_obj;
+		ev_header->status = status;
+		ev_header->version = sync_dev->version;
+		ev_header->evt_param[CAM_SYNC_EVENT_REASON_CODE_INDEX] =
+			event_cause;
+		payload_data = CAM_SYNC_GET_PAYLOAD_PTR_V2((*event), __u64);
+	} else {
+		struct cam_sync_ev_header *ev_header = NULL;
+
+		event->id = id;
+		event->type = CAM_SYNC_V4L_EVENT;
+
+		ev_header = CAM_SYNC_GET_HEADER_PTR((*event));
+		ev_header->sync_obj = sync_obj;
+		ev_header->status = status;
+		payload_data = CAM_SYNC_GET_PAYLOAD_PTR((*event), __u64);
+	}
+
+	return payload_data;
 }
 
 void cam_sync_util_dispatch_signaled_cb(int32_t sync_obj,
@@ -648,6 +771,11 @@ void cam_sync_util_dispatch_signaled_cb(int32_t sync_obj,
 	struct sync_callback_info  *temp_sync_cb;
 	struct sync_table_row      *signalable_row;
 	struct sync_user_payload   *temp_payload_info;
+	struct list_head            cb_list;
+	struct v4l2_event           event;
+	__u64                      *payload_data;
+	ktime_t                     scheduled_ts;
+	bool                        eventq_valid;
 
 	signalable_row = sync_dev->sync_table + sync_obj;
 	if (signalable_row->state == CAM_SYNC_STATE_INVALID) {
@@ -657,37 +785,45 @@ void cam_sync_util_dispatch_signaled_cb(int32_t sync_obj,
 		return;
 	}
 
-	/* Dispatch kernel callbacks if any were registered earlier */
+	/*
+	 * Dispatch kernel callbacks if any were registered earlier, all of
+	 * them are run by one work item along with other pending signals
+	 */
+	INIT_LIST_HEAD(&cb_list);
+	scheduled_ts = ktime_get();
 	list_for_each_entry_safe(sync_cb,
 		temp_sync_cb, &signalable_row->callback_list, list) {
 		sync_cb->status = status;
-		list_del_init(&sync_cb->list);
+		sync_cb->workq_scheduled_ts = scheduled_ts;
+		list_move_tail(&sync_cb->list, &cb_list);
 		if (test_bit(CAM_GENERIC_FENCE_TYPE_SYNC_OBJ,
 			&cam_sync_monitor_mask))
 			cam_generic_fence_update_monitor_array(sync_obj,
 				&sync_dev->table_lock, sync_dev->mon_data,
 				CAM_FENCE_OP_UNREGISTER_ON_SIGNAL);
-		queue_work(sync_dev->work_queue,
-			&sync_cb->cb_dispatch_work);
 	}
+	cam_sync_util_cb_enqueue(&cb_list);
 
 	/* Dispatch user payloads if any were registered earlier */
+	if (list_empty(&signalable_row->user_payload_list))
+		goto complete;
+
+	spin_lock_bh(&sync_dev->cam_sync_eventq_lock);
+	eventq_valid = !!sync_dev->cam_sync_eventq;
+	spin_unlock_bh(&sync_dev->cam_sync_eventq_lock);
+	if (!eventq_valid)
+		goto complete;
+
+	/* Header is common to all payloads of this signal */
+	payload_data = cam_sync_util_prepare_v4l2_event(&event,
+		CAM_SYNC_V4L_EVENT_ID_CB_TRIG, sync_obj, status,
+		event_cause);
+
 	list_for_each_entry_safe(payload_info, temp_payload_info,
 		&signalable_row->user_payload_list, list) {
-		spin_lock_bh(&sync_dev->cam_sync_eventq_lock);
-		if (!sync_dev->cam_sync_eventq) {
-			spin_unlock_bh(
-				&sync_dev->cam_sync_eventq_lock);
-			break;
-		}
-		spin_unlock_bh(&sync_dev->cam_sync_eventq_lock);
-		cam_sync_util_send_v4l2_event(
-			CAM_SYNC_V4L_EVENT_ID_CB_TRIG,
-			sync_obj,
-			status,
-			payload_info->payload_data,
-			CAM_SYNC_PAYLOAD_WORDS * sizeof(__u64),
-			event_cause);
+		memcpy(payload_data, payload_info->payload_data,
+			CAM_SYNC_PAYLOAD_WORDS * sizeof(__u64));
+		v4l2_event_queue(sync_dev->vdev, &event);
 
 		list_del_init(&payload_info->list);
 
@@ -704,6 +840,7 @@ void cam_sync_util_dispatch_signaled_cb(int32_t sync_obj,
 		kfree(payload_info);
 	}
 
+complete:
 	/*
 	 * This needs to be done because we want to unblock anyone
 	 * who might be blocked and waiting on this sync object
@@ -720,30 +857,8 @@ void cam_sync_util_send_v4l2_event(uint32_t id,
 	struct v4l2_event event;
 	__u64 *payload_data = NULL;
 
-	if (sync_dev->version == CAM_SYNC_V4L_EVENT_V2) {
-		struct cam_sync_ev_header_v2 *ev_header = NULL;
-
-		event.id = id;
-		event.type = CAM_SYNC_V4L_EVENT_V2;
-
-		ev_header = CAM_SYNC_GET_HEADER_PTR_V2(event);
-		ev_header->sync_obj = sync_obj;
-		ev_header->status = status;
-		ev_header->version = sync_dev->version;
-		ev_header->evt_param[CAM_SYNC_EVENT_REASON_CODE_INDEX] =
-			event_cause;
-		payload_data = CAM_SYNC_GET_PAYLOAD_PTR_V2(event, __u64);
-	} else {
-		struct cam_sync_ev_header *ev_header = NULL;
-
-		event.id = id;
-		event.type = CAM_SYNC_V4L_EVENT;
-
-		ev_header = CAM_SYNC_GET_HEADER_PTR(event);
-		ev_header->sync_obj = sync_obj;
-		ev_header->status = status;
-		payload_data = CAM_SYNC_GET_PAYLOAD_PTR(event, __u64);
-	}
+	payload_data = cam_sync_util_prepare_v4l2_event(&event, id, sync_obj,
+		status, event_cause);
 
 	memcpy(payload_data, payload, len);
 	v4l2_event_queue(sync_dev->vdev, &event);
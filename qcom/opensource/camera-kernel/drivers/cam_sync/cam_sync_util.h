@@ -108,15 +108,51 @@ int cam_sync_init_group_object(struct sync_table_row *table,
 	uint32_t num_objs);
 
 /**
- * @brief: Function to dispatch a kernel callback for a sync callback
+ * @brief: Function to dispatch all pending kernel callbacks of signaled
+ *         sync objects from a single work item
  *
- * @param cb_dispatch_work : Pointer to the work_struct that needs to be
- *                           dispatched
+ * @param cb_dispatch_work : Pointer to the sync device dispatch work_struct
  *
  * @return None
  */
 void cam_sync_util_cb_dispatch(struct work_struct *cb_dispatch_work);
 
+/**
+ * @brief: Function to initialize the kernel callback node pool and the
+ *         batched callback dispatch
+ *
+ * @return None
+ */
+void cam_sync_util_cb_init(void);
+
+/**
+ * @brief: Function to get a zeroed kernel callback node, from the
+ *         preallocated pool if possible. May be called in atomic context.
+ *
+ * @return Callback node, NULL if out of memory
+ */
+struct sync_callback_info *cam_sync_util_cb_alloc(void);
+
+/**
+ * @brief: Function to release a kernel callback node obtained from
+ *         cam_sync_util_cb_alloc()
+ *
+ * @param cb_info : Callback node to release
+ *
+ * @return None
+ */
+void cam_sync_util_cb_free(struct sync_callback_info *cb_info);
+
+/**
+ * @brief: Function to queue kernel callbacks for dispatch. Callbacks
+ *         queued while a dispatch is pending are run by the same work item.
+ *
+ * @param cb_list : List of callback nodes, emptied on return
+ *
+ * @return None
+ */
+void cam_sync_util_cb_enqueue(struct list_head *cb_list);
+
 /**
  * @brief: Function to dispatch callbacks for a signaled sync object
  *
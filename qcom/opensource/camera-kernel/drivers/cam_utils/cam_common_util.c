@@ -144,13 +144,19 @@ int cam_common_modify_timer(struct timer_list *timer, int32_t timeout_val)
 
 void cam_common_util_thread_switch_delay_detect(char *wq_name, const char *state,
 	void *cb, ktime_t scheduled_time, uint32_t threshold)
+{
+	cam_common_util_thread_switch_delay_detect_ts(wq_name, state, cb,
+		scheduled_time, ktime_get(), threshold);
+}
+
+void cam_common_util_thread_switch_delay_detect_ts(char *wq_name,
+	const char *state, void *cb, ktime_t scheduled_time, ktime_t cur_time,
+	uint32_t threshold)
 {
 	uint64_t                         diff;
-	ktime_t                          cur_time;
 	struct timespec64                cur_ts;
 	struct timespec64                scheduled_ts;
 
-	cur_time = ktime_get();
 	diff = ktime_ms_delta(cur_time, scheduled_time);
 
 	if (diff > threshold) {
@@ -342,6 +342,24 @@ int cam_common_modify_timer(struct timer_list *timer, int32_t timeout_val);
 void cam_common_util_thread_switch_delay_detect(char *wq_name, const char *state,
 	void *cb, ktime_t scheduled_time, uint32_t threshold);
 
+/**
+ * cam_common_util_thread_switch_delay_detect_ts()
+ *
+ * @brief                  Detect if there is any scheduling delay, against
+ *                          a current time already sampled by the caller
+ *
+ * @wq_name:               workq name
+ * @state:                 either schedule or execution
+ * @cb:                    callback scheduled or executed
+ * @scheduled_time:        Time when workq or tasklet was scheduled
+ * @cur_time:              Current time
+ * @threshold:             Threshold time
+ *
+ */
+void cam_common_util_thread_switch_delay_detect_ts(char *wq_name,
+	const char *state, void *cb, ktime_t scheduled_time, ktime_t cur_time,
+	uint32_t threshold);
+
 /**
  * cam_common_register_mini_dump_cb()
  *
@@ -6,20 +6,39 @@
 
 #include <linux/types.h>
 #include <linux/slab.h>
+#include <linux/hash.h>
 
 #include "cam_mem_mgr.h"
 #include "cam_packet_util.h"
 #include "cam_debug_util.h"
 #include "cam_common_util.h"
 
-#define CAM_UNIQUE_SRC_HDL_MAX 50
+#define CAM_UNIQUE_SRC_HDL_HASH_BITS 5
+#define CAM_UNIQUE_SRC_HDL_MAX (1 << CAM_UNIQUE_SRC_HDL_HASH_BITS)
+#define CAM_UNIQUE_DST_HDL_MAX 8
 #define CAM_PRESIL_UNIQUE_HDL_MAX 50
 
 struct cam_patch_unique_src_buf_tbl {
 	int32_t       hdl;
+	uint32_t      flags;
 	dma_addr_t    iova;
 	size_t        buf_size;
-	uint32_t      flags;
+};
+
+struct cam_patch_unique_dst_buf_tbl {
+	int32_t       hdl;
+	uintptr_t     cpu_addr;
+	size_t        buf_len;
+};
+
+/*
+ * Sized to stay below the 50 entry source table this replaced, so both
+ * handle tables live on the stack of the config ioctl path. Handles beyond
+ * them fall back to a lookup per patch.
+ */
+struct cam_patch_unique_buf_tbls {
+	struct cam_patch_unique_src_buf_tbl src[CAM_UNIQUE_SRC_HDL_MAX];
+	struct cam_patch_unique_dst_buf_tbl dst[CAM_UNIQUE_DST_HDL_MAX];
 };
 
 int cam_packet_util_get_packet_addr(struct cam_packet **packet,
@@ -309,12 +328,14 @@ static int cam_packet_util_get_patch_iova(
 	size_t *buf_size, uint32_t *flags, struct list_head *mapped_io_list)
 {
 	int idx = 0;
+	int probe;
 	int rc = 0;
 	size_t src_buf_size;
 	dma_addr_t iova_addr;
-	bool is_found = false;
 
-	for (idx = 0; idx < CAM_UNIQUE_SRC_HDL_MAX; idx++) {
+	/* Open addressed on the handle, a zero handle marks a free slot */
+	idx = hash_32(buf_hdl, CAM_UNIQUE_SRC_HDL_HASH_BITS);
+	for (probe = 0; probe < CAM_UNIQUE_SRC_HDL_MAX; probe++) {
 		if (buf_hdl == tbl[idx].hdl) {
 			CAM_DBG(CAM_UTIL,
 				"Matched entry for src_buf_hdl: 0x%x with src_hdl[%d]: 0x%x",
@@ -322,44 +343,81 @@ static int cam_packet_util_get_patch_iova(
 			*iova = tbl[idx].iova;
 			*buf_size = tbl[idx].buf_size;
 			*flags = tbl[idx].flags;
-			is_found = true;
-			break;
-		} else if ((tbl[idx].hdl == 0) || (tbl[idx].iova == 0)) {
+			return 0;
+		} else if (tbl[idx].hdl == 0) {
 			CAM_DBG(CAM_UTIL, "New src handle detected 0x%x", buf_hdl);
-			is_found = false;
 			break;
 		}
-		CAM_DBG(CAM_UTIL,
-			"Index: %d is filled with differnt src_hdl: 0x%x",
-			idx, buf_hdl);
+		idx = (idx + 1) & (CAM_UNIQUE_SRC_HDL_MAX - 1);
 	}
 
-	if (!is_found) {
-		CAM_DBG(CAM_UTIL, "src_hdl 0x%x not found in table entries",
+	CAM_DBG(CAM_UTIL, "src_hdl 0x%x not found in table entries",
+		buf_hdl);
+	rc = cam_mem_get_io_buf(buf_hdl, hdl, &iova_addr, &src_buf_size, flags,
+		mapped_io_list);
+	if (rc < 0) {
+		CAM_ERR(CAM_UTIL,
+			"unable to get iova for src_hdl: 0x%x",
 			buf_hdl);
-		rc = cam_mem_get_io_buf(buf_hdl, hdl, &iova_addr, &src_buf_size, flags,
-			mapped_io_list);
-		if (rc < 0) {
-			CAM_ERR(CAM_UTIL,
-				"unable to get iova for src_hdl: 0x%x",
-				buf_hdl);
-			return rc;
+		return rc;
+	}
+	/* Update the table entry with unique src buf handle */
+	if (probe < CAM_UNIQUE_SRC_HDL_MAX && iova_addr) {
+		tbl[idx].buf_size = src_buf_size;
+		tbl[idx].iova = iova_addr;
+		tbl[idx].hdl = buf_hdl;
+		tbl[idx].flags = *flags;
+		CAM_DBG(CAM_UTIL,
+			"Updated table index: %d with src_buf_hdl: 0x%x flags: %x",
+			idx, tbl[idx].hdl, *flags);
+	}
+	*iova = iova_addr;
+	*buf_size = src_buf_size;
+
+	return rc;
+}
+
+/*
+ * Patches of a packet mostly target a handful of command buffers, so keep
+ * each destination mapped for the whole patch walk instead of taking and
+ * dropping a mem mgr reference for every patch. Handles beyond the table
+ * size fall back to a per patch reference, signalled by *cached = false.
+ */
+static int cam_packet_util_get_patch_dst(
+	struct cam_patch_unique_dst_buf_tbl *tbl, uint32_t *num_entries,
+	int32_t buf_hdl, uintptr_t *cpu_addr, size_t *buf_len, bool *cached)
+{
+	uint32_t idx;
+	int rc;
+
+	for (idx = *num_entries; idx > 0; idx--) {
+		if (tbl[idx - 1].hdl == buf_hdl) {
+			*cpu_addr = tbl[idx - 1].cpu_addr;
+			*buf_len = tbl[idx - 1].buf_len;
+			*cached = true;
+			return 0;
 		}
-		/* Update the table entry with unique src buf handle */
-		if (idx < CAM_UNIQUE_SRC_HDL_MAX && tbl[idx].hdl == 0) {
-			tbl[idx].buf_size = src_buf_size;
-			tbl[idx].iova = iova_addr;
-			tbl[idx].hdl = buf_hdl;
-			tbl[idx].flags = *flags;
-			CAM_DBG(CAM_UTIL,
-				"Updated table index: %d with src_buf_hdl: 0x%x flags: %x",
-				idx, tbl[idx].hdl, *flags);
+	}
+
+	rc = cam_mem_get_cpu_buf(buf_hdl, cpu_addr, buf_len);
+	if (rc < 0 || !(*cpu_addr) || (*buf_len == 0)) {
+		CAM_ERR(CAM_UTIL, "unable to get dst buf address");
+		if (!rc) {
+			cam_mem_put_cpu_buf(buf_hdl);
+			rc = -EINVAL;
 		}
-		*iova = iova_addr;
-		*buf_size = src_buf_size;
+		return rc;
 	}
 
-	return rc;
+	*cached = (*num_entries < CAM_UNIQUE_DST_HDL_MAX);
+	if (*cached) {
+		tbl[*num_entries].hdl = buf_hdl;
+		tbl[*num_entries].cpu_addr = *cpu_addr;
+		tbl[*num_entries].buf_len = *buf_len;
+		(*num_entries)++;
+	}
+
+	return 0;
 }
 
 int cam_packet_util_process_patches(struct cam_packet *packet,
@@ -376,12 +434,10 @@ int cam_packet_util_process_patches(struct cam_packet *packet,
 	int        i  = 0;
 	int        rc = 0;
 	uint32_t   flags = 0;
+	uint32_t   num_dst = 0;
+	bool       dst_cached;
 	int32_t hdl;
-	struct cam_patch_unique_src_buf_tbl
-		tbl[CAM_UNIQUE_SRC_HDL_MAX];
-
-	memset(tbl, 0, CAM_UNIQUE_SRC_HDL_MAX *
-		sizeof(struct cam_patch_unique_src_buf_tbl));
+	struct cam_patch_unique_buf_tbls tbls = {0};
 
 	/* process patch descriptor */
 	patch_desc = (struct cam_patch_desc *)
@@ -395,31 +451,31 @@ int cam_packet_util_process_patches(struct cam_packet *packet,
 		hdl = cam_mem_is_secure_buf(patch_desc[i].src_buf_hdl) ?
 			sec_mmu_hdl : iommu_hdl;
 
-		rc = cam_packet_util_get_patch_iova(&tbl[0], hdl, patch_desc[i].src_buf_hdl,
+		rc = cam_packet_util_get_patch_iova(tbls.src, hdl, patch_desc[i].src_buf_hdl,
 			&iova_addr, &src_buf_size, &flags, mapped_io_list);
 
 		if (rc) {
 			CAM_ERR(CAM_UTIL,
 				"get_iova failed for patch[%d], src_buf_hdl: 0x%x: rc: %d",
 				i, patch_desc[i].src_buf_hdl, rc);
-			return rc;
+			goto put_dst_bufs;
 		}
 
 		if ((size_t)patch_desc[i].src_offset >= src_buf_size) {
 			CAM_ERR(CAM_UTIL,
 				"Invalid src buf patch offset: patch:src_offset: 0x%x, src_buf_size: %zu",
 				patch_desc[i].src_offset, src_buf_size);
-			return -EINVAL;
+			rc = -EINVAL;
+			goto put_dst_bufs;
 		}
 
 		temp = iova_addr;
 
-		rc = cam_mem_get_cpu_buf(patch_desc[i].dst_buf_hdl,
-			&cpu_addr, &dst_buf_len);
-		if (rc < 0 || !cpu_addr || (dst_buf_len == 0)) {
-			CAM_ERR(CAM_UTIL, "unable to get dst buf address");
-			return rc;
-		}
+		rc = cam_packet_util_get_patch_dst(tbls.dst, &num_dst,
+			(int32_t)patch_desc[i].dst_buf_hdl, &cpu_addr,
+			&dst_buf_len, &dst_cached);
+		if (rc)
+			goto put_dst_bufs;
 		dst_cpu_addr = (uint32_t *)cpu_addr;
 
 		CAM_DBG(CAM_UTIL, "i = %d patch info = %x %x %x %x", i,
@@ -431,8 +487,11 @@ int cam_packet_util_process_patches(struct cam_packet *packet,
 			(size_t)patch_desc[i].dst_offset)) {
 			CAM_ERR(CAM_UTIL,
 				"Invalid dst buf patch offset");
-			cam_mem_put_cpu_buf((int32_t)patch_desc[i].dst_buf_hdl);
-			return -EINVAL;
+			if (!dst_cached)
+				cam_mem_put_cpu_buf(
+					(int32_t)patch_desc[i].dst_buf_hdl);
+			rc = -EINVAL;
+			goto put_dst_bufs;
 		}
 
 		dst_cpu_addr = (uint32_t *)((uint8_t *)dst_cpu_addr +
@@ -461,9 +520,14 @@ int cam_packet_util_process_patches(struct cam_packet *packet,
 			CAM_BOOL_TO_YESNO(flags & CAM_MEM_FLAG_HW_SHARED_ACCESS),
 			CAM_BOOL_TO_YESNO(flags & CAM_MEM_FLAG_CMD_BUF_TYPE),
 			CAM_BOOL_TO_YESNO(flags & CAM_MEM_FLAG_HW_AND_CDM_OR_SHARED));
-		cam_mem_put_cpu_buf((int32_t)patch_desc[i].dst_buf_hdl);
+		if (!dst_cached)
+			cam_mem_put_cpu_buf((int32_t)patch_desc[i].dst_buf_hdl);
 	}
 
+put_dst_bufs:
+	while (num_dst)
+		cam_mem_put_cpu_buf(tbls.dst[--num_dst].hdl);
+
 	return rc;
 }
 
@@ -0,0 +1,273 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ * Copyright (c) 2024 Qualcomm Innovation Center, Inc. All rights reserved.
+ */
+
+#include <kunit/test.h>
+#include <linux/ktime.h>
+
+#include "cam_mem_mgr_api.h"
+#include "cam_packet_util.h"
+#include "cam_smmu_api.h"
+
+/*
+ * KUnit benchmark for cam_packet_util_process_patches(). Packets of 16 to
+ * 1024 patches are built over kernel allocated buffers and patched through
+ * the real mem mgr lookups. More source and destination handles are used
+ * than the per call handle tables hold, so the uncached fallbacks are hit
+ * as well. The mappings go to a context bank no hw mgr holds, which is
+ * handed back on exit, so the suite is skipped when the mem mgr or every
+ * candidate bank is unavailable.
+ */
+
+#define CAM_PACKET_UTIL_TEST_NUM_SRC   80
+#define CAM_PACKET_UTIL_TEST_NUM_DST   20
+#define CAM_PACKET_UTIL_TEST_BUF_SIZE  4096
+#define CAM_PACKET_UTIL_TEST_SRC_STEP  64
+#define CAM_PACKET_UTIL_TEST_ITERS     100
+
+static const uint32_t cam_packet_util_test_sizes[] = {16, 64, 256, 1024};
+
+/* Context banks of hw mgrs that are often absent or not bound */
+static const char * const cam_packet_util_test_cbs[] = {
+	"lrme", "fd", "cre", "ope", "jpeg",
+};
+
+/**
+ * struct cam_packet_util_test_ctx - Buffers shared by the test cases
+ *
+ * @iommu_hdl : SMMU handle the buffers are mapped on
+ * @src       : Patch source buffers
+ * @dst       : Patch destination buffers
+ * @num_src   : Number of allocated entries in @src
+ * @num_dst   : Number of allocated entries in @dst
+ */
+struct cam_packet_util_test_ctx {
+	int32_t iommu_hdl;
+	struct cam_mem_mgr_memory_desc src[CAM_PACKET_UTIL_TEST_NUM_SRC];
+	struct cam_mem_mgr_memory_desc dst[CAM_PACKET_UTIL_TEST_NUM_DST];
+	uint32_t num_src;
+	uint32_t num_dst;
+};
+
+static int cam_packet_util_test_alloc(struct cam_packet_util_test_ctx *ctx,
+	struct cam_mem_mgr_memory_desc *out)
+{
+	struct cam_mem_mgr_request_desc alloc = {
+		.size = CAM_PACKET_UTIL_TEST_BUF_SIZE,
+		.align = 0,
+		.flags = CAM_MEM_FLAG_HW_READ_WRITE |
+			CAM_MEM_FLAG_HW_SHARED_ACCESS,
+		.smmu_hdl = ctx->iommu_hdl,
+	};
+
+	return cam_mem_mgr_request_mem(&alloc, out);
+}
+
+static int cam_packet_util_test_get_cb(struct cam_packet_util_test_ctx *ctx)
+{
+	uint32_t i;
+
+	/* A bank already taken by its hw mgr returns -EALREADY */
+	for (i = 0; i < ARRAY_SIZE(cam_packet_util_test_cbs); i++) {
+		if (!cam_smmu_get_handle((char *)cam_packet_util_test_cbs[i],
+			&ctx->iommu_hdl))
+			return 0;
+	}
+
+	return -ENODEV;
+}
+
+static void cam_packet_util_test_free(struct cam_packet_util_test_ctx *ctx)
+{
+	while (ctx->num_src)
+		cam_mem_mgr_release_mem(&ctx->src[--ctx->num_src]);
+
+	while (ctx->num_dst)
+		cam_mem_mgr_release_mem(&ctx->dst[--ctx->num_dst]);
+
+	/* Let the owning hw mgr acquire the bank if it binds later */
+	cam_smmu_destroy_handle(ctx->iommu_hdl);
+}
+
+static int cam_packet_util_test_init(struct kunit *test)
+{
+	struct cam_packet_util_test_ctx *ctx;
+
+	ctx = kunit_kzalloc(test, sizeof(*ctx), GFP_KERNEL);
+	if (!ctx)
+		return -ENOMEM;
+
+	if (cam_packet_util_test_get_cb(ctx))
+		kunit_skip(test, "no free context bank is available");
+
+	for (; ctx->num_src < CAM_PACKET_UTIL_TEST_NUM_SRC; ctx->num_src++) {
+		if (cam_packet_util_test_alloc(ctx, &ctx->src[ctx->num_src]))
+			goto skip;
+	}
+
+	for (; ctx->num_dst < CAM_PACKET_UTIL_TEST_NUM_DST; ctx->num_dst++) {
+		if (cam_packet_util_test_alloc(ctx, &ctx->dst[ctx->num_dst]))
+			goto skip;
+	}
+
+	test->priv = ctx;
+	return 0;
+
+skip:
+	cam_packet_util_test_free(ctx);
+	kunit_skip(test, "mem mgr could not allocate test buffers");
+	return 0;
+}
+
+static void cam_packet_util_test_exit(struct kunit *test)
+{
+	struct cam_packet_util_test_ctx *ctx = test->priv;
+
+	if (ctx)
+		cam_packet_util_test_free(ctx);
+}
+
+/*
+ * Patch i reads source i % NUM_SRC and writes the next free word of
+ * destination i % NUM_DST, so every destination word is patched once.
+ */
+static struct cam_packet *cam_packet_util_test_build(struct kunit *test,
+	struct cam_packet_util_test_ctx *ctx, uint32_t num_patches)
+{
+	struct cam_packet *packet;
+	struct cam_patch_desc *patch_desc;
+	uint32_t i;
+
+	packet = kunit_kzalloc(test, sizeof(*packet) +
+		num_patches * sizeof(*patch_desc), GFP_KERNEL);
+	KUNIT_ASSERT_NOT_NULL(test, packet);
+
+	packet->patch_offset = 0;
+	packet->num_patches = num_patches;
+	patch_desc = (struct cam_patch_desc *)&packet->payload;
+
+	for (i = 0; i < num_patches; i++) {
+		patch_desc[i].src_buf_hdl =
+			ctx->src[i % CAM_PACKET_UTIL_TEST_NUM_SRC].mem_handle;
+		patch_desc[i].src_offset = (i * CAM_PACKET_UTIL_TEST_SRC_STEP) %
+			CAM_PACKET_UTIL_TEST_BUF_SIZE;
+		patch_desc[i].dst_buf_hdl =
+			ctx->dst[i % CAM_PACKET_UTIL_TEST_NUM_DST].mem_handle;
+		patch_desc[i].dst_offset =
+			(i / CAM_PACKET_UTIL_TEST_NUM_DST) * sizeof(uint32_t);
+	}
+
+	return packet;
+}
+
+static void cam_packet_util_test_check(struct kunit *test,
+	struct cam_packet_util_test_ctx *ctx, struct cam_packet *packet)
+{
+	struct cam_patch_desc *patch_desc;
+	uint32_t *dst_word, expected, i, mismatches = 0;
+
+	patch_desc = (struct cam_patch_desc *)&packet->payload;
+	for (i = 0; i < packet->num_patches; i++) {
+		dst_word = (uint32_t *)(ctx->dst[i %
+			CAM_PACKET_UTIL_TEST_NUM_DST].kva +
+			patch_desc[i].dst_offset);
+		expected = ctx->src[i % CAM_PACKET_UTIL_TEST_NUM_SRC].iova +
+			patch_desc[i].src_offset;
+		if (*dst_word != expected)
+			mismatches++;
+	}
+
+	KUNIT_EXPECT_EQ(test, mismatches, 0);
+}
+
+static void cam_packet_util_test_clear_dst(
+	struct cam_packet_util_test_ctx *ctx)
+{
+	uint32_t i;
+
+	for (i = 0; i < ctx->num_dst; i++)
+		memset((void *)ctx->dst[i].kva, 0,
+			CAM_PACKET_UTIL_TEST_BUF_SIZE);
+}
+
+static void cam_packet_util_test_patch_values(struct kunit *test)
+{
+	struct cam_packet_util_test_ctx *ctx = test->priv;
+	struct cam_packet *packet;
+	uint32_t i;
+
+	for (i = 0; i < ARRAY_SIZE(cam_packet_util_test_sizes); i++) {
+		packet = cam_packet_util_test_build(test, ctx,
+			cam_packet_util_test_sizes[i]);
+		cam_packet_util_test_clear_dst(ctx);
+		KUNIT_ASSERT_EQ(test, cam_packet_util_process_patches(packet,
+			NULL, ctx->iommu_hdl, -1, false), 0);
+		cam_packet_util_test_check(test, ctx, packet);
+	}
+}
+
+static void cam_packet_util_test_bad_dst_offset(struct kunit *test)
+{
+	struct cam_packet_util_test_ctx *ctx = test->priv;
+	struct cam_packet *packet;
+	struct cam_patch_desc *patch_desc;
+
+	/* The failing patch comes after cached destinations were taken */
+	packet = cam_packet_util_test_build(test, ctx, 64);
+	patch_desc = (struct cam_patch_desc *)&packet->payload;
+	patch_desc[63].dst_offset = CAM_PACKET_UTIL_TEST_BUF_SIZE;
+
+	KUNIT_EXPECT_EQ(test, cam_packet_util_process_patches(packet, NULL,
+		ctx->iommu_hdl, -1, false), -EINVAL);
+
+	/* The failed walk must leave the buffers usable for the next one */
+	patch_desc[63].dst_offset = 0;
+	cam_packet_util_test_clear_dst(ctx);
+	KUNIT_EXPECT_EQ(test, cam_packet_util_process_patches(packet, NULL,
+		ctx->iommu_hdl, -1, false), 0);
+}
+
+static void cam_packet_util_test_bench(struct kunit *test)
+{
+	struct cam_packet_util_test_ctx *ctx = test->priv;
+	struct cam_packet *packet;
+	uint32_t i, iter, num_patches;
+	int rc = 0;
+	ktime_t start;
+	s64 elapsed_ns;
+
+	for (i = 0; i < ARRAY_SIZE(cam_packet_util_test_sizes); i++) {
+		num_patches = cam_packet_util_test_sizes[i];
+		packet = cam_packet_util_test_build(test, ctx, num_patches);
+
+		start = ktime_get();
+		for (iter = 0; iter < CAM_PACKET_UTIL_TEST_ITERS && !rc; iter++)
+			rc = cam_packet_util_process_patches(packet, NULL,
+				ctx->iommu_hdl, -1, false);
+		elapsed_ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+
+		KUNIT_ASSERT_EQ(test, rc, 0);
+		kunit_info(test, "%u patches: %lld ns per packet, %lld ns per patch\n",
+			num_patches,
+			div_s64(elapsed_ns, CAM_PACKET_UTIL_TEST_ITERS),
+			div_s64(elapsed_ns,
+			CAM_PACKET_UTIL_TEST_ITERS * num_patches));
+	}
+}
+
+static struct kunit_case cam_packet_util_test_cases[] = {
+	KUNIT_CASE(cam_packet_util_test_patch_values),
+	KUNIT_CASE(cam_packet_util_test_bad_dst_offset),
+	KUNIT_CASE(cam_packet_util_test_bench),
+	{}
+};
+
+static struct kunit_suite cam_packet_util_test_suite = {
+	.name = "cam_packet_util",
+	.init = cam_packet_util_test_init,
+	.exit = cam_packet_util_test_exit,
+	.test_cases = cam_packet_util_test_cases,
+};
+
+kunit_test_suite(cam_packet_util_test_suite);
@@ -4930,6 +4930,8 @@ struct kgsl_driver kgsl_driver  = {
 	 * 8064 and 8974 once the region to be flushed is > 16mb.
 	 */
 	.full_cache_threshold = SZ_16M,
+	/* Map up to 64K of resident neighbours on each CPU fault */
+	.fault_around_pages = 16,
 
 	.stats.vmalloc = ATOMIC_LONG_INIT(0),
 	.stats.vmalloc_max = ATOMIC_LONG_INIT(0),
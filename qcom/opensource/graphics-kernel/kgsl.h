@@ -151,6 +151,9 @@ static inline void KGSL_STATS_ADD(uint64_t size, atomic_long_t *stat,
 struct kgsl_device;
 struct kgsl_context;
 
+/* Upper bound for the CPU fault-around window on paged memory */
+#define KGSL_FAULT_AROUND_MAX_PAGES 32
+
 /**
  * struct kgsl_driver - main container for global KGSL things
  * @cdev: Character device struct
@@ -168,6 +171,7 @@ struct kgsl_context;
  * @devlock: Mutex protecting the device list
  * @stats: Struct containing atomic memory statistics
  * @full_cache_threshold: the threshold that triggers a full cache flush
+ * @fault_around_pages: Number of pages mapped around a faulting CPU address
  * @workqueue: Pointer to a single threaded workqueue
  */
 struct kgsl_driver {
@@ -201,6 +205,7 @@ struct kgsl_driver {
 		atomic_long_t mapped_max;
 	} stats;
 	unsigned int full_cache_threshold;
+	unsigned int fault_around_pages;
 	struct workqueue_struct *workqueue;
 	/* @lockless_workqueue: Pointer to a workqueue handler which doesn't hold device mutex */
 	struct workqueue_struct *lockless_workqueue;
@@ -16,6 +16,7 @@
 #include <linux/delay.h>
 #include <linux/qcom_scm.h>
 #include <linux/random.h>
+#include <linux/rbtree_augmented.h>
 #include <linux/regulator/consumer.h>
 #include <soc/qcom/secure_buffer.h>
 
@@ -44,16 +45,48 @@ static struct page *kgsl_vbo_zero_page;
  * struct kgsl_iommu_addr_entry - entry in the kgsl_pagetable rbtree.
  * @base: starting virtual address of the entry
  * @size: size of the entry
+ * @gap: free VA between the end of the previous entry (or 0) and @base
+ * @subtree_gap: largest @gap in the subtree rooted at this entry
  * @node: the rbtree node
  */
 struct kgsl_iommu_addr_entry {
 	uint64_t base;
 	uint64_t size;
+	uint64_t gap;
+	uint64_t subtree_gap;
 	struct rb_node node;
 };
 
 static struct kmem_cache *addr_entry_cache;
 
+static inline uint64_t _addr_entry_gap(struct kgsl_iommu_addr_entry *entry)
+{
+	return entry->gap;
+}
+
+RB_DECLARE_CALLBACKS_MAX(static, addr_gap_callbacks,
+	struct kgsl_iommu_addr_entry, node, uint64_t, subtree_gap,
+	_addr_entry_gap)
+
+#define to_addr_entry(_node) \
+	rb_entry_safe(_node, struct kgsl_iommu_addr_entry, node)
+
+static inline uint64_t _addr_entry_end(struct kgsl_iommu_addr_entry *entry)
+{
+	return entry ? entry->base + entry->size : 0;
+}
+
+/* Recompute the gap in front of @entry after its predecessor changed */
+static void _update_addr_entry_gap(struct kgsl_iommu_addr_entry *entry)
+{
+	if (!entry)
+		return;
+
+	entry->gap = entry->base -
+		_addr_entry_end(to_addr_entry(rb_prev(&entry->node)));
+	addr_gap_callbacks.propagate(&entry->node, NULL);
+}
+
 /* These are dummy TLB ops for the io-pgtable instances */
 
 static void _tlb_flush_all(void *cookie)
@@ -1913,7 +1946,7 @@ static struct kgsl_iommu_addr_entry *_find_gpuaddr(
 static int _remove_gpuaddr(struct kgsl_pagetable *pagetable,
 		uint64_t gpuaddr)
 {
-	struct kgsl_iommu_addr_entry *entry;
+	struct kgsl_iommu_addr_entry *entry, *next;
 
 	entry = _find_gpuaddr(pagetable, gpuaddr);
 
@@ -1935,7 +1968,10 @@ static int _remove_gpuaddr(struct kgsl_pagetable *pagetable,
 							pagetable->va_start);
 	}
 
-	rb_erase(&entry->node, &pagetable->rbtree);
+	next = to_addr_entry(rb_next(&entry->node));
+	rb_erase_augmented(&entry->node, &pagetable->rbtree,
+		&addr_gap_callbacks);
+	_update_addr_entry_gap(next);
 	kmem_cache_free(addr_entry_cache, entry);
 	return 0;
 }
@@ -1974,7 +2010,15 @@ static int _insert_gpuaddr(struct kgsl_pagetable *pagetable,
 	}
 
 	rb_link_node(&new->node, parent, node);
-	rb_insert_color(&new->node, &pagetable->rbtree);
+
+	/* Augmented data on the path to the new leaf must be current */
+	new->gap = new->base - _addr_entry_end(to_addr_entry(rb_prev(&new->node)));
+	new->subtree_gap = new->gap;
+	addr_gap_callbacks.propagate(parent, NULL);
+	rb_insert_augmented(&new->node, &pagetable->rbtree,
+		&addr_gap_callbacks);
+
+	_update_addr_entry_gap(to_addr_entry(rb_next(&new->node)));
 
 	return 0;
 }
@@ -2008,11 +2052,54 @@ static u64 _get_unmapped_area_hint(struct kgsl_pagetable *pagetable,
 	return hint;
 }
 
+/*
+ * Lowest aligned address for @size bytes in the free range [@gap_start,
+ * @gap_end) clipped to [@bottom, @top), or -ENOMEM if it does not fit.
+ */
+static uint64_t _fit_gap_bottomup(uint64_t gap_start, uint64_t gap_end,
+		uint64_t bottom, uint64_t top, uint64_t size, uint64_t align)
+{
+	uint64_t start;
+
+	gap_start = max_t(uint64_t, gap_start, bottom);
+	gap_end = min_t(uint64_t, gap_end, top);
+
+	start = ALIGN(gap_start, align);
+	if ((start >= gap_start) && (start < gap_end) &&
+		((gap_end - start) >= size))
+		return start;
+
+	return (uint64_t) -ENOMEM;
+}
+
+/*
+ * Highest aligned address for @size bytes in the free range [@gap_start,
+ * @gap_end) clipped to [@bottom, @top), or -ENOMEM if it does not fit.
+ */
+static uint64_t _fit_gap_topdown(uint64_t gap_start, uint64_t gap_end,
+		uint64_t bottom, uint64_t top, uint64_t size, uint64_t align)
+{
+	uint64_t chunk;
+
+	gap_start = max_t(uint64_t, gap_start, bottom);
+	gap_end = min_t(uint64_t, gap_end, top);
+
+	if (gap_end <= size)
+		return (uint64_t) -ENOMEM;
+
+	chunk = (gap_end - size) & ~(align - 1);
+	if (chunk >= gap_start)
+		return chunk;
+
+	return (uint64_t) -ENOMEM;
+}
+
 static uint64_t _get_unmapped_area(struct kgsl_pagetable *pagetable,
 		uint64_t bottom, uint64_t top, uint64_t size,
 		uint64_t align)
 {
-	struct rb_node *node;
+	struct kgsl_iommu_addr_entry *entry, *child;
+	struct rb_node *prev;
 	uint64_t start;
 
 	/* Check if we can assign a gpuaddr based on the last allocation */
@@ -2020,62 +2107,66 @@ static uint64_t _get_unmapped_area(struct kgsl_pagetable *pagetable,
 	if (!IS_ERR_VALUE(start))
 		return start;
 
-	/* Fall back to searching through the range. */
-	node = rb_first(&pagetable->rbtree);
-	bottom = ALIGN(bottom, align);
-	start = bottom;
-
-	while (node != NULL) {
-		uint64_t gap;
-		struct kgsl_iommu_addr_entry *entry = rb_entry(node,
-			struct kgsl_iommu_addr_entry, node);
-
-		/*
-		 * Skip any entries that are outside of the range, but make sure
-		 * to account for some that might straddle the lower bound
-		 */
-		if (entry->base < bottom) {
-			if (entry->base + entry->size > bottom)
-				start = ALIGN(entry->base + entry->size, align);
-			node = rb_next(node);
+	/*
+	 * Fall back to searching through the range. Gaps are visited in
+	 * address order, skipping subtrees whose largest gap is too small,
+	 * so the first fit is the same one a linear walk would pick.
+	 */
+	entry = to_addr_entry(pagetable->rbtree.rb_node);
+	if (!entry || entry->subtree_gap < size)
+		goto check_highest;
+
+	while (true) {
+		/* Gaps in the left subtree all end at or below entry->base */
+		child = to_addr_entry(entry->node.rb_left);
+		if (child && (entry->base > bottom) &&
+			(child->subtree_gap >= size)) {
+			entry = child;
 			continue;
 		}
+check_current:
+		/* Every following gap starts above the range */
+		if ((entry->base - entry->gap) >= top)
+			return (uint64_t) -ENOMEM;
 
-		/* Stop if we went over the top */
-		if (entry->base >= top)
-			break;
-
-		/* Make sure there is a gap to consider */
-		if (start < entry->base) {
-			gap = entry->base - start;
-
-			if (gap >= size)
+		if (entry->gap >= size) {
+			start = _fit_gap_bottomup(entry->base - entry->gap,
+				entry->base, bottom, top, size, align);
+			if (!IS_ERR_VALUE(start))
 				return start;
 		}
 
-		/* Stop if there is no more room in the region */
-		if (entry->base + entry->size >= top)
-			return (uint64_t) -ENOMEM;
+		child = to_addr_entry(entry->node.rb_right);
+		if (child && (child->subtree_gap >= size)) {
+			entry = child;
+			continue;
+		}
 
-		/* Start the next cycle at the end of the current entry */
-		start = ALIGN(entry->base + entry->size, align);
-		node = rb_next(node);
+		/* Climb until we come up from a left child */
+		while (true) {
+			prev = &entry->node;
+			if (!rb_parent(prev))
+				goto check_highest;
+			entry = to_addr_entry(rb_parent(prev));
+			if (prev == entry->node.rb_left)
+				goto check_current;
+		}
 	}
 
-	if (start + size <= top)
-		return start;
-
-	return (uint64_t) -ENOMEM;
+check_highest:
+	/* The gap above the last entry is not tracked in the tree */
+	return _fit_gap_bottomup(
+		_addr_entry_end(to_addr_entry(rb_last(&pagetable->rbtree))),
+		top, bottom, top, size, align);
 }
 
 static uint64_t _get_unmapped_area_topdown(struct kgsl_pagetable *pagetable,
 		uint64_t bottom, uint64_t top, uint64_t size,
 		uint64_t align)
 {
-	struct rb_node *node = rb_last(&pagetable->rbtree);
-	uint64_t end = top;
-	uint64_t mask = ~(align - 1);
-	struct kgsl_iommu_addr_entry *entry;
+	struct kgsl_iommu_addr_entry *entry, *child;
+	struct rb_node *prev;
+	uint64_t addr;
 
 	/* Make sure that the bottom is correctly aligned */
 	bottom = ALIGN(bottom, align);
@@ -2084,58 +2175,54 @@ static uint64_t _get_unmapped_area_topdown(struct kgsl_pagetable *pagetable,
 	if (size > (top - bottom))
 		return -ENOMEM;
 
-	/* Walk back through the list to find the highest entry in the range */
-	for (node = rb_last(&pagetable->rbtree); node != NULL; node = rb_prev(node)) {
-		entry = rb_entry(node, struct kgsl_iommu_addr_entry, node);
-		if (entry->base < top)
-			break;
-	}
-
-	while (node != NULL) {
-		uint64_t offset;
-
-		entry = rb_entry(node, struct kgsl_iommu_addr_entry, node);
-
-		/* If the entire entry is below the range the search is over */
-		if ((entry->base + entry->size) < bottom)
-			break;
-
-		/* Get the top of the entry properly aligned */
-		offset = ALIGN(entry->base + entry->size, align);
-
-		/*
-		 * Try to allocate the memory from the top of the gap,
-		 * making sure that it fits between the top of this entry and
-		 * the bottom of the previous one
-		 */
-
-		if ((end > size) && (offset < end)) {
-			uint64_t chunk = (end - size) & mask;
-
-			if (chunk >= offset)
-				return chunk;
+	/* The gap above the last entry is not tracked in the tree */
+	addr = _fit_gap_topdown(
+		_addr_entry_end(to_addr_entry(rb_last(&pagetable->rbtree))),
+		top, bottom, top, size, align);
+	if (!IS_ERR_VALUE(addr))
+		return addr;
+
+	/* Visit the remaining gaps from the top down, mirroring the above */
+	entry = to_addr_entry(pagetable->rbtree.rb_node);
+	if (!entry || entry->subtree_gap < size)
+		return (uint64_t) -ENOMEM;
+
+	while (true) {
+		/* Gaps in the right subtree all start at or above the entry end */
+		child = to_addr_entry(entry->node.rb_right);
+		if (child && (_addr_entry_end(entry) < top) &&
+			(child->subtree_gap >= size)) {
+			entry = child;
+			continue;
 		}
-
-		/*
-		 * If we get here and the current entry is outside of the range
-		 * then we are officially out of room
-		 */
-
-		if (entry->base < bottom)
+check_current:
+		/* Every following gap ends below the range */
+		if (entry->base <= bottom)
 			return (uint64_t) -ENOMEM;
 
-		/* Set the top of the gap to the current entry->base */
-		end = entry->base;
-
-		/* And move on to the next lower entry */
-		node = rb_prev(node);
-	}
+		if (entry->gap >= size) {
+			addr = _fit_gap_topdown(entry->base - entry->gap,
+				entry->base, bottom, top, size, align);
+			if (!IS_ERR_VALUE(addr))
+				return addr;
+		}
 
-	/* If we get here then there are no more entries in the region */
-	if ((end > size) && (((end - size) & mask) >= bottom))
-		return (end - size) & mask;
+		child = to_addr_entry(entry->node.rb_left);
+		if (child && (child->subtree_gap >= size)) {
+			entry = child;
+			continue;
+		}
 
-	return (uint64_t) -ENOMEM;
+		/* Climb until we come up from a right child */
+		while (true) {
+			prev = &entry->node;
+			if (!rb_parent(prev))
+				return (uint64_t) -ENOMEM;
+			entry = to_addr_entry(rb_parent(prev));
+			if (prev == entry->node.rb_right)
+				goto check_current;
+		}
+	}
 }
 
 static uint64_t kgsl_iommu_find_svm_region(struct kgsl_pagetable *pagetable,
@@ -2755,3 +2842,7 @@ static const struct kgsl_mmu_pt_ops default_pt_ops = {
 	.put_gpuaddr = kgsl_iommu_put_gpuaddr,
 	.addr_in_range = kgsl_iommu_addr_in_range,
 };
+
+#if IS_ENABLED(CONFIG_QCOM_KGSL_KUNIT_TEST)
+#include "kgsl_iommu_test.c"
+#endif
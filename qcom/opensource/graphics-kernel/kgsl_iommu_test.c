@@ -0,0 +1,466 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ * Copyright (c) 2024 Qualcomm Innovation Center, Inc. All rights reserved.
+ */
+
+/*
+ * KUnit tests for the GPU VA gap search. This file is included at the end of
+ * kgsl_iommu.c so that it can reach the static pagetable helpers.
+ *
+ * Random layouts are built with _insert_gpuaddr() and thinned out with
+ * _remove_gpuaddr(). The augmented gap data is checked after every change,
+ * then both searches are compared with the linear walks they replaced.
+ * A last case times both on a pagetable with tens of thousands of entries.
+ */
+
+#include <kunit/test.h>
+#include <linux/prandom.h>
+
+#define KGSL_IOMMU_TEST_LAYOUTS		200
+#define KGSL_IOMMU_TEST_QUERIES		1500
+#define KGSL_IOMMU_TEST_MAX_ENTRIES	96
+#define KGSL_IOMMU_TEST_SEED		0x6b67736cULL
+#define KGSL_IOMMU_TEST_SCALE_ENTRIES	16384
+#define KGSL_IOMMU_TEST_SCALE_QUERIES	2000
+
+/**
+ * struct kgsl_iommu_test_ctx - State shared by the gap search tests
+ * @pt: Pagetable that only carries the address rbtree
+ * @bases: Base address of every entry inserted into @pt
+ * @num_bases: Number of valid entries in @bases
+ * @max_bases: Number of entries @bases has room for
+ * @own_cache: True if the test created addr_entry_cache
+ * @rnd: Random state for the layouts and queries
+ */
+struct kgsl_iommu_test_ctx {
+	struct kgsl_pagetable *pt;
+	u64 *bases;
+	u32 num_bases;
+	u32 max_bases;
+	bool own_cache;
+	struct rnd_state rnd;
+};
+
+/**
+ * struct kgsl_iommu_test_query - One timed lookup
+ * @bottom: Lowest address of the range
+ * @top: End of the range
+ * @size: Size to find
+ * @align: Alignment of the address found
+ */
+struct kgsl_iommu_test_query {
+	u64 bottom;
+	u64 top;
+	u64 size;
+	u64 align;
+};
+
+typedef u64 (*kgsl_iommu_test_search)(struct kgsl_pagetable *pagetable,
+		u64 bottom, u64 top, u64 size, u64 align);
+
+/* The bottom up linear walk that the gap search replaced, without the hint */
+static u64 _ref_get_unmapped_area(struct kgsl_pagetable *pagetable,
+		u64 bottom, u64 top, u64 size, u64 align)
+{
+	struct rb_node *node = rb_first(&pagetable->rbtree);
+	u64 start;
+
+	bottom = ALIGN(bottom, align);
+	start = bottom;
+
+	while (node != NULL) {
+		struct kgsl_iommu_addr_entry *entry = rb_entry(node,
+			struct kgsl_iommu_addr_entry, node);
+
+		if (entry->base < bottom) {
+			if (entry->base + entry->size > bottom)
+				start = ALIGN(entry->base + entry->size, align);
+			node = rb_next(node);
+			continue;
+		}
+
+		if (entry->base >= top)
+			break;
+
+		if ((start < entry->base) && ((entry->base - start) >= size))
+			return start;
+
+		if (entry->base + entry->size >= top)
+			return (u64) -ENOMEM;
+
+		start = ALIGN(entry->base + entry->size, align);
+		node = rb_next(node);
+	}
+
+	if (start + size <= top)
+		return start;
+
+	return (u64) -ENOMEM;
+}
+
+/* The top down linear walk that the gap search replaced */
+static u64 _ref_get_unmapped_area_topdown(struct kgsl_pagetable *pagetable,
+		u64 bottom, u64 top, u64 size, u64 align)
+{
+	struct rb_node *node;
+	struct kgsl_iommu_addr_entry *entry;
+	u64 end = top;
+	u64 mask = ~(align - 1);
+
+	bottom = ALIGN(bottom, align);
+
+	if (size > (top - bottom))
+		return -ENOMEM;
+
+	for (node = rb_last(&pagetable->rbtree); node != NULL; node = rb_prev(node)) {
+		entry = rb_entry(node, struct kgsl_iommu_addr_entry, node);
+		if (entry->base < top)
+			break;
+	}
+
+	while (node != NULL) {
+		u64 offset;
+
+		entry = rb_entry(node, struct kgsl_iommu_addr_entry, node);
+
+		if ((entry->base + entry->size) < bottom)
+			break;
+
+		offset = ALIGN(entry->base + entry->size, align);
+
+		if ((end > size) && (offset < end)) {
+			u64 chunk = (end - size) & mask;
+
+			if (chunk >= offset)
+				return chunk;
+		}
+
+		if (entry->base < bottom)
+			return (u64) -ENOMEM;
+
+		end = entry->base;
+		node = rb_prev(node);
+	}
+
+	if ((end > size) && (((end - size) & mask) >= bottom))
+		return (end - size) & mask;
+
+	return (u64) -ENOMEM;
+}
+
+static u64 _test_subtree_gap(struct rb_node *node)
+{
+	return node ? to_addr_entry(node)->subtree_gap : 0;
+}
+
+/* Count entries whose gap or subtree gap does not match the tree */
+static u32 _test_check_gaps(struct kgsl_pagetable *pt)
+{
+	struct kgsl_iommu_addr_entry *entry;
+	struct rb_node *node;
+	u64 prev_end = 0, max_gap;
+	u32 errors = 0;
+
+	for (node = rb_first(&pt->rbtree); node; node = rb_next(node)) {
+		entry = to_addr_entry(node);
+
+		if (entry->gap != entry->base - prev_end)
+			errors++;
+
+		max_gap = max3(entry->gap, _test_subtree_gap(node->rb_left),
+			_test_subtree_gap(node->rb_right));
+		if (entry->subtree_gap != max_gap)
+			errors++;
+
+		prev_end = entry->base + entry->size;
+	}
+
+	return errors;
+}
+
+static u64 _test_rand(struct kgsl_iommu_test_ctx *ctx, u32 range)
+{
+	return prandom_u32_state(&ctx->rnd) % range;
+}
+
+static void _test_remove_all(struct kgsl_iommu_test_ctx *ctx)
+{
+	while (ctx->num_bases)
+		_remove_gpuaddr(ctx->pt, ctx->bases[--ctx->num_bases]);
+}
+
+/*
+ * Lay out entries of 1 to 8 pages separated by 0 to 8 free pages, then
+ * remove about a quarter of them at random. Returns the end of the layout.
+ */
+static u64 _test_build_layout(struct kunit *test,
+		struct kgsl_iommu_test_ctx *ctx)
+{
+	u64 addr = _test_rand(ctx, 64) << PAGE_SHIFT;
+	u64 size;
+	u32 i, num = 1 + _test_rand(ctx, KGSL_IOMMU_TEST_MAX_ENTRIES);
+
+	for (i = 0; i < num; i++) {
+		addr += _test_rand(ctx, 9) << PAGE_SHIFT;
+		size = (1 + _test_rand(ctx, 8)) << PAGE_SHIFT;
+		KUNIT_ASSERT_EQ(test, _insert_gpuaddr(ctx->pt, addr, size), 0);
+		ctx->bases[ctx->num_bases++] = addr;
+		addr += size;
+	}
+
+	for (i = 0; i < ctx->num_bases; ) {
+		if (_test_rand(ctx, 4)) {
+			i++;
+			continue;
+		}
+
+		KUNIT_ASSERT_EQ(test, _remove_gpuaddr(ctx->pt, ctx->bases[i]),
+			0);
+		ctx->bases[i] = ctx->bases[--ctx->num_bases];
+	}
+
+	KUNIT_EXPECT_EQ(test, _test_check_gaps(ctx->pt), 0);
+
+	return addr;
+}
+
+/*
+ * Pack entries of 1 to 4 pages back to back, with a hole of 1 to 3 pages
+ * after about one in 64 of them, the way a long running process fragments
+ * its VA space. Returns the end of the layout.
+ */
+static u64 _test_build_dense_layout(struct kunit *test,
+		struct kgsl_iommu_test_ctx *ctx)
+{
+	u64 addr = 0, size;
+
+	while (ctx->num_bases < ctx->max_bases) {
+		if (!_test_rand(ctx, 64))
+			addr += (1 + _test_rand(ctx, 3)) << PAGE_SHIFT;
+		size = (1 + _test_rand(ctx, 4)) << PAGE_SHIFT;
+		KUNIT_ASSERT_EQ(test, _insert_gpuaddr(ctx->pt, addr, size), 0);
+		ctx->bases[ctx->num_bases++] = addr;
+		addr += size;
+	}
+
+	KUNIT_EXPECT_EQ(test, _test_check_gaps(ctx->pt), 0);
+
+	return addr;
+}
+
+static s64 _test_time_search(struct kgsl_iommu_test_ctx *ctx,
+		kgsl_iommu_test_search search,
+		const struct kgsl_iommu_test_query *queries, u64 *results)
+{
+	ktime_t start = ktime_get();
+	u32 i;
+
+	for (i = 0; i < KGSL_IOMMU_TEST_SCALE_QUERIES; i++)
+		results[i] = search(ctx->pt, queries[i].bottom, queries[i].top,
+			queries[i].size, queries[i].align);
+
+	return ktime_to_ns(ktime_sub(ktime_get(), start));
+}
+
+static u32 _test_count_mismatches(const u64 *got, const u64 *want)
+{
+	u32 i, mismatches = 0;
+
+	for (i = 0; i < KGSL_IOMMU_TEST_SCALE_QUERIES; i++)
+		mismatches += got[i] != want[i];
+
+	return mismatches;
+}
+
+static int kgsl_iommu_test_init(struct kunit *test)
+{
+	struct kgsl_iommu_test_ctx *ctx;
+
+	ctx = kunit_kzalloc(test, sizeof(*ctx), GFP_KERNEL);
+	if (!ctx)
+		return -ENOMEM;
+
+	ctx->pt = kunit_kzalloc(test, sizeof(*ctx->pt), GFP_KERNEL);
+	if (!ctx->pt)
+		return -ENOMEM;
+
+	ctx->max_bases = KGSL_IOMMU_TEST_MAX_ENTRIES;
+	ctx->bases = kunit_kcalloc(test, ctx->max_bases, sizeof(*ctx->bases),
+		GFP_KERNEL);
+	if (!ctx->bases)
+		return -ENOMEM;
+
+	/* No va_hint, every lookup takes the gap search */
+	ctx->pt->rbtree = RB_ROOT;
+
+	/* Suites run before the driver probes, when the cache may not exist */
+	if (!addr_entry_cache) {
+		addr_entry_cache = KMEM_CACHE(kgsl_iommu_addr_entry, 0);
+		if (!addr_entry_cache)
+			return -ENOMEM;
+		ctx->own_cache = true;
+	}
+
+	prandom_seed_state(&ctx->rnd, KGSL_IOMMU_TEST_SEED);
+	test->priv = ctx;
+	return 0;
+}
+
+static void kgsl_iommu_test_exit(struct kunit *test)
+{
+	struct kgsl_iommu_test_ctx *ctx = test->priv;
+
+	if (!ctx)
+		return;
+
+	_test_remove_all(ctx);
+
+	if (ctx->own_cache) {
+		kmem_cache_destroy(addr_entry_cache);
+		addr_entry_cache = NULL;
+	}
+}
+
+static void kgsl_iommu_test_empty(struct kunit *test)
+{
+	struct kgsl_iommu_test_ctx *ctx = test->priv;
+	u64 bottom = SZ_1M + SZ_4K, top = SZ_16M;
+
+	KUNIT_EXPECT_EQ(test, _get_unmapped_area(ctx->pt, bottom, top,
+		SZ_64K, SZ_64K), (u64) (SZ_1M + SZ_64K));
+	KUNIT_EXPECT_EQ(test, _get_unmapped_area_topdown(ctx->pt, bottom,
+		top, SZ_64K, SZ_64K), (u64) (SZ_16M - SZ_64K));
+	KUNIT_EXPECT_TRUE(test, IS_ERR_VALUE(_get_unmapped_area(ctx->pt,
+		bottom, top, SZ_16M, SZ_4K)));
+	KUNIT_EXPECT_TRUE(test, IS_ERR_VALUE(_get_unmapped_area_topdown(
+		ctx->pt, bottom, top, SZ_16M, SZ_4K)));
+}
+
+static void kgsl_iommu_test_match_linear(struct kunit *test)
+{
+	struct kgsl_iommu_test_ctx *ctx = test->priv;
+	u64 span, bottom, top, size, align;
+	u32 layout, query, mismatches = 0, fits = 0;
+	u64 got, want;
+
+	for (layout = 0; layout < KGSL_IOMMU_TEST_LAYOUTS; layout++) {
+		span = _test_build_layout(test, ctx) >> PAGE_SHIFT;
+
+		for (query = 0; query < KGSL_IOMMU_TEST_QUERIES; query++) {
+			bottom = _test_rand(ctx, span + 32) << PAGE_SHIFT;
+			/* Callers do not always pass an aligned bottom */
+			if (!_test_rand(ctx, 4))
+				bottom += _test_rand(ctx, PAGE_SIZE);
+			top = ALIGN(bottom, PAGE_SIZE) +
+				((1 + _test_rand(ctx, span + 32)) << PAGE_SHIFT);
+			size = (1 + _test_rand(ctx, 16)) << PAGE_SHIFT;
+			align = PAGE_SIZE << _test_rand(ctx, 4);
+
+			want = _ref_get_unmapped_area(ctx->pt, bottom, top,
+				size, align);
+			got = _get_unmapped_area(ctx->pt, bottom, top, size,
+				align);
+			if (got != want) {
+				mismatches++;
+				kunit_err(test, "bottomup 0x%llx-0x%llx size 0x%llx align 0x%llx: got 0x%llx want 0x%llx\n",
+					bottom, top, size, align, got, want);
+			}
+			fits += !IS_ERR_VALUE(want);
+
+			want = _ref_get_unmapped_area_topdown(ctx->pt, bottom,
+				top, size, align);
+			got = _get_unmapped_area_topdown(ctx->pt, bottom, top,
+				size, align);
+			if (got != want) {
+				mismatches++;
+				kunit_err(test, "topdown 0x%llx-0x%llx size 0x%llx align 0x%llx: got 0x%llx want 0x%llx\n",
+					bottom, top, size, align, got, want);
+			}
+			fits += !IS_ERR_VALUE(want);
+
+			if (mismatches > 16)
+				break;
+		}
+
+		_test_remove_all(ctx);
+		KUNIT_ASSERT_EQ(test, mismatches, 0);
+	}
+
+	/* Make sure the layouts are not so dense that nothing ever fits */
+	KUNIT_EXPECT_GT(test, fits, 0);
+	kunit_info(test, "%u queries matched, %u of them found a range\n",
+		2 * KGSL_IOMMU_TEST_LAYOUTS * KGSL_IOMMU_TEST_QUERIES, fits);
+}
+
+/*
+ * Time both searches against the linear walks on a large, densely packed
+ * pagetable. Requests of up to 16 pages are larger than most holes, so
+ * many of them only fit past the last entry and make the walks visit the
+ * whole tree.
+ */
+static void kgsl_iommu_test_scale(struct kunit *test)
+{
+	struct kgsl_iommu_test_ctx *ctx = test->priv;
+	struct kgsl_iommu_test_query *queries;
+	u64 *want, *got, span;
+	s64 ref_ns, gap_ns, ref_topdown_ns, gap_topdown_ns;
+	u32 i, mismatches;
+
+	ctx->max_bases = KGSL_IOMMU_TEST_SCALE_ENTRIES;
+	ctx->bases = kunit_kcalloc(test, ctx->max_bases, sizeof(*ctx->bases),
+		GFP_KERNEL);
+	queries = kunit_kcalloc(test, KGSL_IOMMU_TEST_SCALE_QUERIES,
+		sizeof(*queries), GFP_KERNEL);
+	want = kunit_kcalloc(test, KGSL_IOMMU_TEST_SCALE_QUERIES,
+		sizeof(*want), GFP_KERNEL);
+	got = kunit_kcalloc(test, KGSL_IOMMU_TEST_SCALE_QUERIES,
+		sizeof(*got), GFP_KERNEL);
+	KUNIT_ASSERT_NOT_NULL(test, ctx->bases);
+	KUNIT_ASSERT_NOT_NULL(test, queries);
+	KUNIT_ASSERT_NOT_NULL(test, want);
+	KUNIT_ASSERT_NOT_NULL(test, got);
+
+	span = _test_build_dense_layout(test, ctx) >> PAGE_SHIFT;
+
+	for (i = 0; i < KGSL_IOMMU_TEST_SCALE_QUERIES; i++) {
+		queries[i].bottom = _test_rand(ctx, span) << PAGE_SHIFT;
+		queries[i].top = (span + 64) << PAGE_SHIFT;
+		queries[i].size = PAGE_SIZE << _test_rand(ctx, 5);
+		queries[i].align = PAGE_SIZE;
+	}
+
+	ref_ns = _test_time_search(ctx, _ref_get_unmapped_area, queries,
+		want);
+	gap_ns = _test_time_search(ctx, _get_unmapped_area, queries, got);
+	mismatches = _test_count_mismatches(got, want);
+
+	ref_topdown_ns = _test_time_search(ctx,
+		_ref_get_unmapped_area_topdown, queries, want);
+	gap_topdown_ns = _test_time_search(ctx, _get_unmapped_area_topdown,
+		queries, got);
+	mismatches += _test_count_mismatches(got, want);
+
+	KUNIT_EXPECT_EQ(test, mismatches, 0);
+	kunit_info(test, "%u entries, ns per query: bottomup %lld linear %lld gap search, topdown %lld linear %lld gap search\n",
+		ctx->num_bases,
+		div_s64(ref_ns, KGSL_IOMMU_TEST_SCALE_QUERIES),
+		div_s64(gap_ns, KGSL_IOMMU_TEST_SCALE_QUERIES),
+		div_s64(ref_topdown_ns, KGSL_IOMMU_TEST_SCALE_QUERIES),
+		div_s64(gap_topdown_ns, KGSL_IOMMU_TEST_SCALE_QUERIES));
+}
+
+static struct kunit_case kgsl_iommu_test_cases[] = {
+	KUNIT_CASE(kgsl_iommu_test_empty),
+	KUNIT_CASE(kgsl_iommu_test_match_linear),
+	KUNIT_CASE(kgsl_iommu_test_scale),
+	{}
+};
+
+static struct kunit_suite kgsl_iommu_test_suite = {
+	.name = "kgsl_iommu_gap",
+	.init = kgsl_iommu_test_init,
+	.exit = kgsl_iommu_test_exit,
+	.test_cases = kgsl_iommu_test_cases,
+};
+
+kunit_test_suite(kgsl_iommu_test_suite);
@@ -479,6 +479,32 @@ static ssize_t full_cache_threshold_show(struct device *dev,
 			kgsl_driver.full_cache_threshold);
 }
 
+static ssize_t fault_around_pages_store(struct device *dev,
+					 struct device_attribute *attr,
+					 const char *buf, size_t count)
+{
+	int ret;
+	unsigned int pages = 0;
+
+	ret = kstrtou32(buf, 0, &pages);
+	if (ret)
+		return ret;
+
+	if (!pages || pages > KGSL_FAULT_AROUND_MAX_PAGES)
+		return -EINVAL;
+
+	WRITE_ONCE(kgsl_driver.fault_around_pages, pages);
+	return count;
+}
+
+static ssize_t fault_around_pages_show(struct device *dev,
+					struct device_attribute *attr,
+					char *buf)
+{
+	return scnprintf(buf, PAGE_SIZE, "%u\n",
+			READ_ONCE(kgsl_driver.fault_around_pages));
+}
+
 static DEVICE_ATTR(vmalloc, 0444, memstat_show, NULL);
 static DEVICE_ATTR(vmalloc_max, 0444, memstat_show, NULL);
 static DEVICE_ATTR(page_alloc, 0444, memstat_show, NULL);
@@ -490,6 +516,7 @@ static DEVICE_ATTR(secure_max, 0444, memstat_show, NULL);
 static DEVICE_ATTR(mapped, 0444, memstat_show, NULL);
 static DEVICE_ATTR(mapped_max, 0444, memstat_show, NULL);
 static DEVICE_ATTR_RW(full_cache_threshold);
+static DEVICE_ATTR_RW(fault_around_pages);
 
 static const struct attribute *drv_attr_list[] = {
 	&dev_attr_vmalloc.attr,
@@ -503,6 +530,7 @@ static const struct attribute *drv_attr_list[] = {
 	&dev_attr_mapped.attr,
 	&dev_attr_mapped_max.attr,
 	&dev_attr_full_cache_threshold.attr,
+	&dev_attr_fault_around_pages.attr,
 #ifdef CONFIG_QCOM_KGSL_PROCESS_RECLAIM
 	&dev_attr_max_reclaim_limit.attr,
 	&dev_attr_page_reclaim_per_call.attr,
@@ -516,53 +544,174 @@ kgsl_sharedmem_init_sysfs(void)
 	return sysfs_create_files(&kgsl_driver.virtdev.kobj, drv_attr_list);
 }
 
-static vm_fault_t kgsl_paged_vmfault(struct kgsl_memdesc *memdesc,
-				struct vm_area_struct *vma,
-				struct vm_fault *vmf)
+/*
+ * Bring the reclaimed pages of the fault window back from shmem. Only the
+ * faulting page may be read from swap; a neighbour is taken only if it is
+ * still in the page cache, so the fault never waits on I/O for a page that
+ * was not asked for. Every page brought back is published in the pages
+ * array under a single hold of the memdesc lock.
+ */
+static int kgsl_paged_fault_readahead(struct kgsl_memdesc *memdesc,
+		struct vm_area_struct *vma, struct page **batch,
+		int start, int end, int pgoff)
 {
-	int pgoff, ret;
+	struct kgsl_process_private *priv =
+		((struct kgsl_mem_entry *)vma->vm_private_data)->priv;
+	struct address_space *mapping = memdesc->shmem_filp->f_mapping;
 	struct page *page;
-	unsigned int offset = vmf->address - vma->vm_start;
+	int i;
 
-	if (offset >= memdesc->size)
-		return VM_FAULT_SIGBUS;
+	page = shmem_read_mapping_page_gfp(mapping, pgoff, kgsl_gfp_mask(0));
+	if (IS_ERR(page))
+		return PTR_ERR(page);
 
-	pgoff = offset >> PAGE_SHIFT;
+	kgsl_page_sync(memdesc->dev, page, PAGE_SIZE, DMA_BIDIRECTIONAL);
+	batch[pgoff - start] = page;
 
-	spin_lock(&memdesc->lock);
-	if (memdesc->pages[pgoff]) {
-		page = memdesc->pages[pgoff];
-		get_page(page);
-	} else {
-		struct kgsl_process_private *priv =
-			((struct kgsl_mem_entry *)vma->vm_private_data)->priv;
+	for (i = start; i < end; i++) {
+		if (batch[i - start])
+			continue;
 
-		/* We are here because page was reclaimed */
-		memdesc->priv |= KGSL_MEMDESC_SKIP_RECLAIM;
-		spin_unlock(&memdesc->lock);
+		page = find_get_page(mapping, i);
+		if (!page)
+			continue;
+
+		if (!PageUptodate(page)) {
+			put_page(page);
+			continue;
+		}
 
-		page = shmem_read_mapping_page_gfp(
-			memdesc->shmem_filp->f_mapping, pgoff,
-			kgsl_gfp_mask(0));
-		if (IS_ERR(page))
-			return VM_FAULT_SIGBUS;
 		kgsl_page_sync(memdesc->dev, page, PAGE_SIZE, DMA_BIDIRECTIONAL);
+		batch[i - start] = page;
+	}
 
-		spin_lock(&memdesc->lock);
+	spin_lock(&memdesc->lock);
+	for (i = start; i < end; i++) {
+		page = batch[i - start];
 		/*
 		 * Update the pages array only if the page was
 		 * not already brought back.
 		 */
-		if (!memdesc->pages[pgoff]) {
-			memdesc->pages[pgoff] = page;
+		if (page && !memdesc->pages[i]) {
+			memdesc->pages[i] = page;
 			atomic_dec(&priv->unpinned_page_count);
 			get_page(page);
 		}
 	}
 	spin_unlock(&memdesc->lock);
 
-	ret = vmf_insert_page(vma, vmf->address, page);
-	put_page(page);
+	return 0;
+}
+
+/*
+ * A PTE that is already populated only skips its own page, the rest of the
+ * run is still inserted. Any other error ends the run.
+ */
+static void kgsl_paged_insert_pages(struct vm_area_struct *vma,
+		unsigned long addr, struct page **pages, unsigned long num)
+{
+#if (KERNEL_VERSION(5, 8, 0) <= LINUX_VERSION_CODE)
+	unsigned long left, done;
+
+	while (num) {
+		left = num;
+		/* Stops at the first PTE that is already populated */
+		if (vm_insert_pages(vma, addr, pages, &left) != -EBUSY || !left)
+			break;
+
+		done = num - left + 1;
+		addr += done << PAGE_SHIFT;
+		pages += done;
+		num -= done;
+	}
+#else
+	unsigned long i;
+	int ret;
+
+	for (i = 0; i < num; i++) {
+		ret = vm_insert_page(vma, addr + (i << PAGE_SHIFT), pages[i]);
+		if (ret && ret != -EBUSY)
+			break;
+	}
+#endif
+}
+
+/*
+ * Map the resident neighbours of the faulting page so that sequential CPU
+ * access does not take a fault per page. Runs of pages are inserted with one
+ * page table lock each, around any PTE that is already populated.
+ */
+static void kgsl_paged_fault_around(struct vm_area_struct *vma,
+		struct page **batch, int start, int end, int pgoff)
+{
+	int i, run = start;
+
+	for (i = start; i <= end; i++) {
+		if (i < end && i != pgoff && batch[i - start])
+			continue;
+
+		if (i > run)
+			kgsl_paged_insert_pages(vma,
+				vma->vm_start + ((unsigned long)run << PAGE_SHIFT),
+				&batch[run - start], i - run);
+		run = i + 1;
+	}
+}
+
+static vm_fault_t kgsl_paged_vmfault(struct kgsl_memdesc *memdesc,
+				struct vm_area_struct *vma,
+				struct vm_fault *vmf)
+{
+	struct page *batch[KGSL_FAULT_AROUND_MAX_PAGES];
+	int pgoff, start, end, i, ret;
+	unsigned int window;
+	bool reclaimed;
+	unsigned int offset = vmf->address - vma->vm_start;
+
+	if (offset >= memdesc->size)
+		return VM_FAULT_SIGBUS;
+
+	pgoff = offset >> PAGE_SHIFT;
+
+	window = clamp_t(unsigned int, READ_ONCE(kgsl_driver.fault_around_pages),
+			1, KGSL_FAULT_AROUND_MAX_PAGES);
+	start = pgoff - (pgoff % window);
+	end = min_t(u64, start + window, memdesc->size >> PAGE_SHIFT);
+	end = min_t(u64, end, vma_pages(vma));
+
+	spin_lock(&memdesc->lock);
+	for (i = start; i < end; i++) {
+		batch[i - start] = memdesc->pages[i];
+		if (batch[i - start])
+			get_page(batch[i - start]);
+	}
+
+	reclaimed = !batch[pgoff - start];
+	/* We are here because page was reclaimed */
+	if (reclaimed)
+		memdesc->priv |= KGSL_MEMDESC_SKIP_RECLAIM;
+	spin_unlock(&memdesc->lock);
+
+	/*
+	 * Reclaimed pages tend to be reclaimed together, so read the rest of
+	 * the window back with the faulting page instead of one per fault.
+	 */
+	if (reclaimed && kgsl_paged_fault_readahead(memdesc, vma, batch,
+			start, end, pgoff)) {
+		ret = VM_FAULT_SIGBUS;
+		goto out;
+	}
+
+	ret = vmf_insert_page(vma, vmf->address, batch[pgoff - start]);
+	if (ret == VM_FAULT_NOPAGE && window > 1)
+		kgsl_paged_fault_around(vma, batch, start, end, pgoff);
+
+out:
+	for (i = start; i < end; i++) {
+		if (batch[i - start])
+			put_page(batch[i - start]);
+	}
+
 	return ret;
 }
 
@@ -0,0 +1,390 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ * Copyright (c) 2024 Qualcomm Innovation Center, Inc. All rights reserved.
+ */
+
+/*
+ * Userspace test for the CPU fault-around on paged KGSL memory.
+ *
+ * A write-combined buffer is mapped and touched one page at a time, for
+ * each fault_around_pages setting. Every pass reports the minor faults
+ * taken and the touch time. The fault count must match the window size,
+ * and every page must keep the pattern written in the first pass. Passes:
+ *
+ *  seq      - sequential touch of a fresh mapping
+ *  prefault - one page in every window is faulted with a window of 1
+ *             first, so each fault-around run has to skip a populated PTE
+ *  reclaim  - only with -r: the process is put in the background and
+ *             memory pressure is applied until KGSL reclaims the buffer,
+ *             then the buffer is faulted back in through shmem
+ *
+ * Build against the uapi header of this tree, e.g.
+ *   $CC -O2 -Wall -I include/uapi -o kgsl_fault_around \
+ *	tests/kgsl_fault_around.c
+ * Must run as root to change fault_around_pages and the process state.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#ifndef __user
+#define __user
+#endif
+#include <linux/msm_kgsl.h>
+
+#define KGSL_DEVICE		"/dev/kgsl-3d0"
+#define KGSL_SYSFS		"/sys/class/kgsl/kgsl"
+#define FAULT_AROUND_MAX	32
+#define PATTERN			0x6b67736cU
+#define PRESSURE_CHUNK		(64UL << 20)
+
+static long page_size;
+/* KGSL tracks the process that opened the device, not the pressure child */
+static pid_t test_pid;
+
+struct pass_result {
+	long faults;
+	double touch_us;
+	unsigned long bad_pages;
+};
+
+static int sysfs_read(const char *path, char *buf, size_t len)
+{
+	int fd = open(path, O_RDONLY);
+	ssize_t ret;
+
+	if (fd < 0)
+		return -errno;
+
+	ret = read(fd, buf, len - 1);
+	close(fd);
+	if (ret < 0)
+		return -errno;
+
+	buf[ret] = '\0';
+	return 0;
+}
+
+static int sysfs_write(const char *path, const char *val)
+{
+	int fd = open(path, O_WRONLY);
+	ssize_t ret;
+
+	if (fd < 0)
+		return -errno;
+
+	ret = write(fd, val, strlen(val));
+	close(fd);
+	return ret < 0 ? -errno : 0;
+}
+
+static int set_window(unsigned int pages)
+{
+	char val[16];
+
+	snprintf(val, sizeof(val), "%u", pages);
+	return sysfs_write(KGSL_SYSFS "/fault_around_pages", val);
+}
+
+static int proc_attr(const char *attr, char *buf, size_t len)
+{
+	char path[128];
+
+	snprintf(path, sizeof(path), KGSL_SYSFS "/proc/%d/%s", test_pid, attr);
+	return sysfs_read(path, buf, len);
+}
+
+static int set_proc_state(const char *state)
+{
+	char path[128];
+
+	snprintf(path, sizeof(path), KGSL_SYSFS "/proc/%d/state", test_pid);
+	return sysfs_write(path, state);
+}
+
+static long minflt(void)
+{
+	struct rusage usage;
+
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_minflt;
+}
+
+static double now_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static void *map_buf(int fd, unsigned int id, size_t size)
+{
+	void *ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+		(off_t)id * page_size);
+
+	return ptr == MAP_FAILED ? NULL : ptr;
+}
+
+/*
+ * Touch every page in order. The first pass writes the pattern, later passes
+ * check it. Faults and time only cover the touch loop.
+ */
+static void touch(volatile uint32_t *buf, unsigned long pages, bool write,
+		struct pass_result *res)
+{
+	unsigned long i, stride = page_size / sizeof(*buf);
+	long faults = minflt();
+	double start = now_us();
+
+	for (i = 0; i < pages; i++) {
+		if (write)
+			buf[i * stride] = PATTERN ^ i;
+		else if (buf[i * stride] != (PATTERN ^ i))
+			res->bad_pages++;
+	}
+
+	res->touch_us = now_us() - start;
+	res->faults = minflt() - faults;
+}
+
+/* A few faults on the stack or the libc may land in the measured loop */
+static bool check_faults(const char *name, unsigned int window,
+		long expected, const struct pass_result *res)
+{
+	long slack = 4 + expected / 64;
+	bool ok = (res->faults >= expected) &&
+		(res->faults <= expected + slack) && !res->bad_pages;
+
+	printf("%-8s window %2u: %7ld faults (expected %7ld) %10.0f us %s\n",
+		name, window, res->faults, expected, res->touch_us,
+		ok ? "ok" : "FAIL");
+	if (res->bad_pages)
+		printf("  %lu pages lost their contents\n", res->bad_pages);
+
+	return ok;
+}
+
+static bool pass_seq(int fd, unsigned int id, size_t size,
+		unsigned int window, bool write)
+{
+	struct pass_result res = { 0 };
+	unsigned long pages = size / page_size;
+	void *buf;
+
+	buf = map_buf(fd, id, size);
+	if (!buf) {
+		perror("mmap");
+		return false;
+	}
+
+	touch(buf, pages, write, &res);
+	munmap(buf, size);
+
+	return check_faults("seq", window, (pages + window - 1) / window,
+		&res);
+}
+
+/*
+ * Fault the middle page of every window with a window of 1. The sequential
+ * touch then faults at the start of each window only: its run skips the
+ * populated middle PTE and maps the rest of the window.
+ */
+static bool pass_prefault(int fd, unsigned int id, size_t size,
+		unsigned int window)
+{
+	struct pass_result res = { 0 };
+	unsigned long pages = size / page_size, i, windows;
+	volatile uint32_t *buf;
+
+	if (window < 4)
+		return true;
+
+	buf = map_buf(fd, id, size);
+	if (!buf) {
+		perror("mmap");
+		return false;
+	}
+
+	set_window(1);
+	for (i = window / 2; i < pages; i += window)
+		(void)buf[i * (page_size / sizeof(*buf))];
+	set_window(window);
+
+	touch(buf, pages, false, &res);
+	munmap((void *)buf, size);
+
+	windows = pages / window;
+	return check_faults("prefault", window, windows, &res);
+}
+
+/* Allocate and touch anonymous memory until KGSL reports reclaimed pages */
+static long apply_pressure(unsigned long max_mb)
+{
+	unsigned long used = 0;
+	char buf[32];
+	pid_t child;
+	int status;
+	void *chunk;
+
+	child = fork();
+	if (child < 0)
+		return -errno;
+
+	if (!child) {
+		while (used < (max_mb << 20)) {
+			chunk = mmap(NULL, PRESSURE_CHUNK,
+				PROT_READ | PROT_WRITE,
+				MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (chunk == MAP_FAILED)
+				break;
+			memset(chunk, 0x5a, PRESSURE_CHUNK);
+			used += PRESSURE_CHUNK;
+
+			if (!proc_attr("gpumem_reclaimed", buf, sizeof(buf)) &&
+				strtol(buf, NULL, 0) > 0)
+				break;
+		}
+		_exit(0);
+	}
+
+	waitpid(child, &status, 0);
+
+	/* The reclaim worker may still be running, give it a moment */
+	sleep(1);
+	if (proc_attr("gpumem_reclaimed", buf, sizeof(buf)))
+		return -ENOENT;
+
+	return strtol(buf, NULL, 0);
+}
+
+static bool pass_reclaim(int fd, unsigned int id, size_t size,
+		unsigned int window, unsigned long max_mb)
+{
+	struct pass_result res = { 0 };
+	unsigned long pages = size / page_size;
+	long reclaimed, after;
+	char buf[32];
+	void *ptr;
+	bool ok;
+
+	if (set_proc_state("background")) {
+		printf("reclaim  window %2u: process state not writable, skipped\n",
+			window);
+		return true;
+	}
+
+	reclaimed = apply_pressure(max_mb);
+	if (reclaimed <= 0) {
+		printf("reclaim  window %2u: nothing reclaimed, skipped\n",
+			window);
+		set_proc_state("foreground");
+		return true;
+	}
+
+	ptr = map_buf(fd, id, size);
+	if (!ptr) {
+		perror("mmap");
+		set_proc_state("foreground");
+		return false;
+	}
+
+	touch(ptr, pages, false, &res);
+	munmap(ptr, size);
+
+	after = proc_attr("gpumem_reclaimed", buf, sizeof(buf)) ? -1 :
+		strtol(buf, NULL, 0);
+	printf("  %ld bytes reclaimed before the touch, %ld after\n",
+		reclaimed, after);
+
+	ok = check_faults("reclaim", window, (pages + window - 1) / window,
+		&res);
+
+	set_proc_state("foreground");
+	return ok;
+}
+
+int main(int argc, char **argv)
+{
+	static const unsigned int windows[] = { 1, 16, FAULT_AROUND_MAX };
+	struct kgsl_gpuobj_alloc alloc = { 0 };
+	struct kgsl_gpuobj_free gpuobj_free = { 0 };
+	unsigned long size_mb = 64, pressure_mb = 0;
+	unsigned int i, old_window = 16;
+	bool ok = true;
+	char buf[32];
+	int fd, opt;
+
+	while ((opt = getopt(argc, argv, "s:r:")) != -1) {
+		switch (opt) {
+		case 's':
+			size_mb = strtoul(optarg, NULL, 0);
+			break;
+		case 'r':
+			pressure_mb = strtoul(optarg, NULL, 0);
+			break;
+		default:
+			fprintf(stderr, "usage: %s [-s buffer MB] [-r max pressure MB]\n",
+				argv[0]);
+			return 2;
+		}
+	}
+
+	page_size = sysconf(_SC_PAGESIZE);
+	test_pid = getpid();
+
+	fd = open(KGSL_DEVICE, O_RDWR);
+	if (fd < 0) {
+		perror(KGSL_DEVICE);
+		return 2;
+	}
+
+	if (!sysfs_read(KGSL_SYSFS "/fault_around_pages", buf, sizeof(buf)))
+		old_window = strtoul(buf, NULL, 0);
+
+	/* Write-combined, so mmap does not map the pages up front */
+	alloc.size = size_mb << 20;
+	alloc.flags = (uint64_t)KGSL_CACHEMODE_WRITECOMBINE <<
+		KGSL_CACHEMODE_SHIFT;
+	if (ioctl(fd, IOCTL_KGSL_GPUOBJ_ALLOC, &alloc)) {
+		perror("IOCTL_KGSL_GPUOBJ_ALLOC");
+		close(fd);
+		return 2;
+	}
+
+	for (i = 0; i < sizeof(windows) / sizeof(windows[0]); i++) {
+		if (set_window(windows[i])) {
+			fprintf(stderr, "cannot set fault_around_pages to %u\n",
+				windows[i]);
+			ok = false;
+			break;
+		}
+
+		ok &= pass_seq(fd, alloc.id, alloc.mmapsize, windows[i], !i);
+		ok &= pass_prefault(fd, alloc.id, alloc.mmapsize, windows[i]);
+		if (pressure_mb)
+			ok &= pass_reclaim(fd, alloc.id, alloc.mmapsize,
+				windows[i], pressure_mb);
+	}
+
+	snprintf(buf, sizeof(buf), "%u", old_window);
+	sysfs_write(KGSL_SYSFS "/fault_around_pages", buf);
+
+	gpuobj_free.id = alloc.id;
+	ioctl(fd, IOCTL_KGSL_GPUOBJ_FREE, &gpuobj_free);
+	close(fd);
+
+	printf("%s\n", ok ? "PASS" : "FAIL");
+	return ok ? 0 : 1;
+}
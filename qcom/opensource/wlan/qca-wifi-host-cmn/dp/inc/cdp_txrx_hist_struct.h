@@ -88,17 +88,49 @@ struct cdp_hist_bucket {
 	uint64_t freq[CDP_HIST_BUCKET_MAX];
 };
 
+struct cdp_hist_log_linear;
+
+#ifdef DP_HIST_LOG_LINEAR
+/*
+ * Log-linear histogram geometry: values below 2^CDP_HIST_LL_SUB_BITS get
+ * one bucket each, every power of two above that is split into
+ * 2^CDP_HIST_LL_SUB_BITS equal sub-buckets, so a bucket is never wider
+ * than 1/8th of its lower bound. Values at or above 2^CDP_HIST_LL_MAX_BITS
+ * are clamped into the last bucket.
+ */
+#define CDP_HIST_LL_SUB_BITS 3
+#define CDP_HIST_LL_SUB_CNT (1 << CDP_HIST_LL_SUB_BITS)
+#define CDP_HIST_LL_MAX_BITS 24
+#define CDP_HIST_LL_BUCKET_MAX \
+	((CDP_HIST_LL_MAX_BITS - CDP_HIST_LL_SUB_BITS + 1) * CDP_HIST_LL_SUB_CNT)
+
+/**
+ * struct cdp_hist_log_linear - Log-linear frequency distribution
+ * @count: Total number of samples recorded
+ * @freq: Frequency per log-linear bucket
+ */
+struct cdp_hist_log_linear {
+	uint64_t count;
+	uint32_t freq[CDP_HIST_LL_BUCKET_MAX];
+};
+#endif
+
 /**
  * struct cdp_hist_stats - Histogram of a stats type
  * @hist: Frequency distribution
  * @max: Max frequency
  * @min: Minimum frequency
  * @avg: Average frequency
+ * @ll: Log-linear frequency distribution used for percentile queries.
+ *	Owned by whoever set up the histogram, NULL when not tracked
  */
 struct cdp_hist_stats {
 	struct cdp_hist_bucket hist;
 	int max;
 	int min;
 	int avg;
+#ifdef DP_HIST_LOG_LINEAR
+	struct cdp_hist_log_linear *ll;
+#endif
 };
 #endif /* _CDP_TXRX_HIST_STRUCT_H_ */
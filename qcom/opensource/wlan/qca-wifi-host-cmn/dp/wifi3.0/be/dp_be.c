@@ -2809,6 +2809,7 @@ static void dp_get_vdev_stats_for_unmap_peer_mlo(struct dp_vdev *vdev,
 	if (!txrx_peer)
 		goto link_stats;
 
+	DP_STATS_PCPU_FOLD(txrx_peer);
 	dp_peer_aggregate_tid_stats(peer);
 
 	if (!IS_MLO_DP_LINK_PEER(peer)) {
@@ -548,7 +548,7 @@ more_data:
 				num_rx_bufs_reaped++;
 			}
 			rx_desc->msdu_done_fail = 1;
-			DP_STATS_INC(soc, rx.err.msdu_done_fail, 1);
+			DP_STATS_INC_DIRECT(soc, rx.err.msdu_done_fail, 1);
 			dp_err("MSDU DONE failure %d",
 			       soc->stats.rx.err.msdu_done_fail);
 			dp_rx_msdu_done_fail_event_record(soc, rx_desc,
@@ -748,7 +748,7 @@ done:
 		 */
 		if (qdf_unlikely(!qdf_nbuf_is_rx_chfrag_cont(nbuf) &&
 				 !hal_rx_tlv_msdu_done_get_be(rx_tlv_hdr))) {
-			DP_STATS_INC(soc, rx.err.msdu_done_fail, 1);
+			DP_STATS_INC_DIRECT(soc, rx.err.msdu_done_fail, 1);
 			dp_err("MSDU DONE failure %d",
 			       soc->stats.rx.err.msdu_done_fail);
 			hal_rx_dump_pkt_tlvs(hal_soc, rx_tlv_hdr,
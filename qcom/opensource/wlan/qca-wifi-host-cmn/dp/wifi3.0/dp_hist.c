@@ -260,6 +260,137 @@ static void dp_hist_fill_buckets(struct cdp_hist_bucket *hist_bucket, int value)
 	hist_bucket->freq[idx]++;
 }
 
+#ifdef DP_HIST_LOG_LINEAR
+/**
+ * dp_hist_ll_bucket_idx() - Find the log-linear bucket index of a value
+ * @value: Value to be bucketed
+ *
+ * Values below CDP_HIST_LL_SUB_CNT map one to one. Above that the bucket
+ * is picked from the position of the most significant bit (the octave)
+ * and the CDP_HIST_LL_SUB_BITS bits right below it (the sub-bucket).
+ *
+ * Return: The bucket index
+ */
+static inline uint32_t dp_hist_ll_bucket_idx(int value)
+{
+	uint32_t val, shift;
+
+	if (qdf_unlikely(value < 0))
+		return 0;
+
+	val = value;
+	if (qdf_unlikely(val >= (1U << CDP_HIST_LL_MAX_BITS)))
+		val = (1U << CDP_HIST_LL_MAX_BITS) - 1;
+
+	if (val < CDP_HIST_LL_SUB_CNT)
+		return val;
+
+	/* qdf_fls() is 1 based, val >= 2^SUB_BITS so shift is >= 0 */
+	shift = qdf_fls(val) - 1 - CDP_HIST_LL_SUB_BITS;
+
+	return ((shift + 1) << CDP_HIST_LL_SUB_BITS) +
+	       ((val >> shift) & (CDP_HIST_LL_SUB_CNT - 1));
+}
+
+/**
+ * dp_hist_ll_bucket_mid() - Get the midpoint of a log-linear bucket
+ * @idx: Bucket index
+ *
+ * Return: Midpoint value of the bucket
+ */
+static uint32_t dp_hist_ll_bucket_mid(uint32_t idx)
+{
+	uint32_t octave = idx >> CDP_HIST_LL_SUB_BITS;
+	uint32_t sub = idx & (CDP_HIST_LL_SUB_CNT - 1);
+	uint32_t low;
+
+	if (!octave)
+		return sub;
+
+	low = (CDP_HIST_LL_SUB_CNT + sub) << (octave - 1);
+
+	return low + ((1U << (octave - 1)) >> 1);
+}
+
+/**
+ * dp_hist_ll_update() - Record a value in the log-linear histogram
+ * @ll: Log-linear histogram
+ * @value: Value to be recorded
+ *
+ * Return: void
+ */
+static inline void dp_hist_ll_update(struct cdp_hist_log_linear *ll,
+				     int value)
+{
+	ll->freq[dp_hist_ll_bucket_idx(value)]++;
+	ll->count++;
+}
+
+/**
+ * dp_hist_ll_accumulate() - Merge a log-linear histogram into another
+ * @src: Source histogram
+ * @dst: Destination histogram
+ *
+ * Return: void
+ */
+static void dp_hist_ll_accumulate(struct cdp_hist_log_linear *src,
+				  struct cdp_hist_log_linear *dst)
+{
+	uint32_t idx;
+
+	if (!src->count)
+		return;
+
+	for (idx = 0; idx < CDP_HIST_LL_BUCKET_MAX; idx++)
+		dst->freq[idx] += src->freq[idx];
+	dst->count += src->count;
+}
+
+uint32_t dp_hist_get_percentile(struct cdp_hist_stats *hist_stats,
+				uint32_t pctl)
+{
+	struct cdp_hist_log_linear *ll;
+	uint64_t rank, cum = 0;
+	uint32_t idx;
+
+	if (qdf_unlikely(!hist_stats))
+		return 0;
+
+	ll = hist_stats->ll;
+	if (!ll || !ll->count)
+		return 0;
+
+	if (pctl > DP_HIST_PCTL_DENOM)
+		pctl = DP_HIST_PCTL_DENOM;
+
+	/* Nearest rank, 1 based: ceil(count * pctl / DENOM) */
+	rank = qdf_do_div(ll->count * pctl + DP_HIST_PCTL_DENOM - 1,
+			  DP_HIST_PCTL_DENOM);
+	if (!rank)
+		rank = 1;
+
+	for (idx = 0; idx < CDP_HIST_LL_BUCKET_MAX; idx++) {
+		cum += ll->freq[idx];
+		if (cum >= rank)
+			break;
+	}
+
+	if (idx == CDP_HIST_LL_BUCKET_MAX)
+		idx = CDP_HIST_LL_BUCKET_MAX - 1;
+
+	return dp_hist_ll_bucket_mid(idx);
+}
+
+void dp_hist_ll_attach(struct cdp_hist_stats *hist_stats,
+		       struct cdp_hist_log_linear *ll)
+{
+	if (ll)
+		qdf_mem_zero(ll, sizeof(*ll));
+
+	hist_stats->ll = ll;
+}
+#endif
+
 void dp_hist_update_stats(struct cdp_hist_stats *hist_stats, int value)
 {
 	if (qdf_unlikely(!hist_stats))
@@ -270,6 +401,11 @@ void dp_hist_update_stats(struct cdp_hist_stats *hist_stats, int value)
 	 */
 	dp_hist_fill_buckets(&hist_stats->hist, value);
 
+#ifdef DP_HIST_LOG_LINEAR
+	if (hist_stats->ll)
+		dp_hist_ll_update(hist_stats->ll, value);
+#endif
+
 	/*
 	 * Compute the min, max and average. Average computed is weighted
 	 * average
@@ -297,6 +433,11 @@ void dp_copy_hist_stats(struct cdp_hist_stats *src_hist_stats,
 	dst_hist_stats->min = src_hist_stats->min;
 	dst_hist_stats->max = src_hist_stats->max;
 	dst_hist_stats->avg = src_hist_stats->avg;
+#ifdef DP_HIST_LOG_LINEAR
+	if (src_hist_stats->ll && dst_hist_stats->ll)
+		qdf_mem_copy(dst_hist_stats->ll, src_hist_stats->ll,
+			     sizeof(*dst_hist_stats->ll));
+#endif
 }
 
 void dp_accumulate_hist_stats(struct cdp_hist_stats *src_hist_stats,
@@ -322,6 +463,11 @@ void dp_accumulate_hist_stats(struct cdp_hist_stats *src_hist_stats,
 		dst_hist_stats->avg = (src_hist_stats->avg +
 				       dst_hist_stats->avg) >> 1;
 	}
+
+#ifdef DP_HIST_LOG_LINEAR
+	if (src_hist_stats->ll && dst_hist_stats->ll)
+		dp_hist_ll_accumulate(src_hist_stats->ll, dst_hist_stats->ll);
+#endif
 }
 
 void dp_hist_init(struct cdp_hist_stats *hist_stats,
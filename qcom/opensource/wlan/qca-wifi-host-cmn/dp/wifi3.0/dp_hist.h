@@ -64,6 +64,59 @@ void dp_accumulate_hist_stats(struct cdp_hist_stats *src_hist_stats,
 void dp_copy_hist_stats(struct cdp_hist_stats *src_hist_stats,
 			struct cdp_hist_stats *dst_hist_stats);
 
+/*
+ * Percentile ranks for dp_hist_get_percentile(), in units of 0.01%
+ */
+#define DP_HIST_P50 5000
+#define DP_HIST_P90 9000
+#define DP_HIST_P99 9900
+#define DP_HIST_P999 9990
+#define DP_HIST_PCTL_DENOM 10000
+
+#ifdef DP_HIST_LOG_LINEAR
+/**
+ * dp_hist_get_percentile() - Get a percentile of the recorded values
+ * @hist_stats: Histogram stats, possibly merged from several contexts
+ * @pctl: Percentile rank in units of 0.01%, e.g. DP_HIST_P99
+ *
+ * The value returned is the midpoint of the log-linear bucket holding
+ * the requested rank, so the error is bounded by half a bucket width,
+ * i.e. about 6% of the value.
+ *
+ * Return: Percentile value, 0 if no samples were recorded or no
+ *	   log-linear storage is attached
+ */
+uint32_t dp_hist_get_percentile(struct cdp_hist_stats *hist_stats,
+				uint32_t pctl);
+
+/**
+ * dp_hist_ll_attach() - Attach log-linear storage to a histogram
+ * @hist_stats: Histogram stats, already set up by dp_hist_init()
+ * @ll: Zeroed and used for percentile tracking, NULL to stop tracking
+ *
+ * The log-linear buckets are too large to embed in every cdp_hist_stats,
+ * so only histograms that report percentiles get storage attached. The
+ * caller owns @ll and must keep it around as long as @hist_stats is used.
+ *
+ * Return: void
+ */
+void dp_hist_ll_attach(struct cdp_hist_stats *hist_stats,
+		       struct cdp_hist_log_linear *ll);
+#else
+static inline
+uint32_t dp_hist_get_percentile(struct cdp_hist_stats *hist_stats,
+				uint32_t pctl)
+{
+	return 0;
+}
+
+static inline
+void dp_hist_ll_attach(struct cdp_hist_stats *hist_stats,
+		       struct cdp_hist_log_linear *ll)
+{
+}
+#endif
+
 const char *dp_hist_tx_hw_delay_str(uint8_t index);
 const char *dp_hist_delay_percentile_str(uint8_t index);
 #endif /* __DP_HIST_H_ */
@@ -1118,6 +1118,162 @@ void DP_PRINT_STATS(const char *fmt, ...);
 #endif
 #endif /* WLAN_SYSFS_DP_STATS */
 
+#define DP_STATS_DIRECT_add(_counter, _delta) ((_counter) += (_delta))
+#define DP_STATS_DIRECT_sub(_counter, _delta) ((_counter) -= (_delta))
+
+#ifdef WLAN_DP_PERCPU_STATS
+/*
+ * The hot TX/RX counters of the soc, pdev, vdev and txrx_peer stats are
+ * incremented in a per-CPU copy and folded back into the stats structure by
+ * dp_stats_pcpu_fold() when the stats are read. Other counters and handles,
+ * and updates which assign rather than add, keep writing the stats
+ * structure directly.
+ */
+#define DP_STATS_PCPU(_handle) \
+	_Generic((_handle), \
+		 struct dp_soc *: ((struct dp_soc *)(_handle))->stats_pcpu, \
+		 struct dp_pdev *: ((struct dp_pdev *)(_handle))->stats_pcpu, \
+		 struct dp_vdev *: ((struct dp_vdev *)(_handle))->stats_pcpu, \
+		 struct dp_txrx_peer *: \
+			((struct dp_txrx_peer *)(_handle))->stats_pcpu, \
+		 default: (struct dp_stats_pcpu *)NULL)
+
+/**
+ * dp_stats_pcpu_attach() - allocate the per-CPU copies of the hot counters
+ *	of a stats structure
+ * @pcs: filled with the per-CPU backend, NULL if it could not be allocated
+ *	in which case counters are updated in the stats structure directly
+ * @base: offset of the hot counter window in each stats element
+ * @len: size of the hot counter window
+ * @stride: size of one stats element
+ * @count: number of stats elements
+ *
+ * Return: None
+ */
+void dp_stats_pcpu_attach(struct dp_stats_pcpu **pcs, uint32_t base,
+			  uint32_t len, uint32_t stride, uint32_t count);
+
+/**
+ * dp_stats_pcpu_detach() - free the per-CPU copies of a stats structure
+ * @pcs: per-CPU backend, set to NULL
+ *
+ * Return: None
+ */
+void dp_stats_pcpu_detach(struct dp_stats_pcpu **pcs);
+
+/**
+ * dp_stats_pcpu_fold() - add the increments done since the last fold on
+ *	every CPU to the stats structure
+ * @pcs: per-CPU backend, may be NULL
+ * @stats: stats structure @pcs belongs to
+ *
+ * Return: None
+ */
+void dp_stats_pcpu_fold(struct dp_stats_pcpu *pcs, void *stats);
+
+/**
+ * dp_stats_pcpu_reset() - drop the increments not folded yet
+ * @pcs: per-CPU backend, may be NULL
+ *
+ * Used when the stats structure is cleared.
+ *
+ * Return: None
+ */
+void dp_stats_pcpu_reset(struct dp_stats_pcpu *pcs);
+
+/**
+ * dp_stats_pcpu_slot() - counter at @offset in the per-CPU copies
+ * @pcs: per-CPU backend
+ * @offset: offset of the counter in the stats structure
+ *
+ * Return: per-CPU address of the counter
+ */
+static inline void qdf_percpu *dp_stats_pcpu_slot(struct dp_stats_pcpu *pcs,
+						  uint32_t offset)
+{
+	return pcs->slots + offset;
+}
+
+/*
+ * @_elem is the stats element @_counter lives in and @_idx its index, the
+ * link for txrx_peer stats. The offset of a counter in its element is a
+ * compile time constant, so a counter outside the hot window costs one
+ * compare before taking the direct path. qdf_this_cpu_add/sub keep the
+ * update atomic against preemption and against softirqs touching the same
+ * counter on the local CPU.
+ */
+#define DP_STATS_COUNTER_OP(_handle, _elem, _idx, _counter, _op, _delta) \
+{ \
+	struct dp_stats_pcpu *__pcs = DP_STATS_PCPU(_handle); \
+	uint32_t __off = (uint8_t *)&(_counter) - (uint8_t *)&(_elem); \
+	\
+	if (__pcs && (__off - __pcs->base) < __pcs->len) { \
+		__off += ((_idx) * __pcs->len) - __pcs->base; \
+		qdf_this_cpu_##_op(*(typeof(_counter) qdf_percpu *) \
+				   dp_stats_pcpu_slot(__pcs, __off), \
+				   (_delta)); \
+		if (qdf_unlikely(!__pcs->width[__off])) \
+			__pcs->width[__off] = sizeof(_counter); \
+	} else { \
+		DP_STATS_DIRECT_##_op(_counter, _delta); \
+	} \
+}
+
+/* Keep the counters from @_first to @_last of the stats per CPU */
+#define DP_STATS_PCPU_ATTACH(_handle, _first, _last) \
+	dp_stats_pcpu_attach(&(_handle)->stats_pcpu, \
+			     (uint8_t *)&(_handle)->stats._first - \
+			     (uint8_t *)&(_handle)->stats, \
+			     (uint8_t *)(&(_handle)->stats._last + 1) - \
+			     (uint8_t *)&(_handle)->stats._first, \
+			     sizeof((_handle)->stats), 1)
+
+/* Keep the per packet stats of every link per CPU */
+#define DP_TXRX_PEER_STATS_PCPU_ATTACH(_handle, _count) \
+	dp_stats_pcpu_attach(&(_handle)->stats_pcpu, \
+			     offsetof(struct dp_peer_stats, per_pkt_stats), \
+			     sizeof(struct dp_peer_per_pkt_stats), \
+			     sizeof(struct dp_peer_stats), _count)
+
+#define DP_STATS_PCPU_DETACH(_handle) \
+	dp_stats_pcpu_detach(&(_handle)->stats_pcpu)
+
+#define DP_STATS_PCPU_FOLD(_handle) \
+do { \
+	typeof(_handle) __fold_handle = (_handle); \
+	\
+	if (__fold_handle) \
+		dp_stats_pcpu_fold(DP_STATS_PCPU(__fold_handle), \
+				   &__fold_handle->stats); \
+} while (0)
+
+#define DP_STATS_INIT(_handle) \
+do { \
+	qdf_mem_zero(&((_handle)->stats), sizeof((_handle)->stats)); \
+	dp_stats_pcpu_reset(DP_STATS_PCPU(_handle)); \
+} while (0)
+
+#define DP_TXRX_PEER_STATS_INIT(_handle, size) \
+do { \
+	qdf_mem_zero(&((_handle)->stats[0]), size); \
+	dp_stats_pcpu_reset((_handle)->stats_pcpu); \
+} while (0)
+
+#define DP_STATS_CLR(_handle) DP_STATS_INIT(_handle)
+
+#define DP_TXRX_PEER_STATS_CLR(_handle, size) \
+	DP_TXRX_PEER_STATS_INIT(_handle, size)
+#else
+#define DP_STATS_COUNTER_OP(_handle, _elem, _idx, _counter, _op, _delta) \
+{ \
+	DP_STATS_DIRECT_##_op(_counter, _delta); \
+}
+
+#define DP_STATS_PCPU_ATTACH(_handle, _first, _last) do { } while (0)
+#define DP_TXRX_PEER_STATS_PCPU_ATTACH(_handle, _count) do { } while (0)
+#define DP_STATS_PCPU_DETACH(_handle) do { } while (0)
+#define DP_STATS_PCPU_FOLD(_handle) do { } while (0)
+
 #define DP_STATS_INIT(_handle) \
 	qdf_mem_zero(&((_handle)->stats), sizeof((_handle)->stats))
 
@@ -1129,18 +1285,33 @@ void DP_PRINT_STATS(const char *fmt, ...);
 
 #define DP_TXRX_PEER_STATS_CLR(_handle, size) \
 	qdf_mem_zero(&((_handle)->stats[0]), size)
+#endif /* WLAN_DP_PERCPU_STATS */
 
 #ifndef DISABLE_DP_STATS
 #define DP_STATS_INC(_handle, _field, _delta) \
 { \
 	if (likely(_handle)) \
-		_handle->stats._field += _delta; \
+		DP_STATS_COUNTER_OP(_handle, _handle->stats, 0, \
+				    _handle->stats._field, \
+				    add, _delta) \
 }
 
 #define DP_PEER_LINK_STATS_INC(_handle, _field, _delta, _link) \
 { \
 	if (likely(_handle)) \
-		_handle->stats[_link]._field += _delta; \
+		DP_STATS_COUNTER_OP(_handle, _handle->stats[_link], _link, \
+				    _handle->stats[_link]._field, \
+				    add, _delta) \
+}
+
+/*
+ * Counters which the datapath itself reads back, e.g. to decide on a
+ * recovery, are kept in the stats structure even with the per-CPU backend.
+ */
+#define DP_STATS_INC_DIRECT(_handle, _field, _delta) \
+{ \
+	if (likely(_handle)) \
+		_handle->stats._field += _delta; \
 }
 
 #define DP_PEER_STATS_FLAT_INC(_handle, _field, _delta) \
@@ -1152,19 +1323,25 @@ void DP_PRINT_STATS(const char *fmt, ...);
 #define DP_STATS_INCC(_handle, _field, _delta, _cond) \
 { \
 	if (_cond && likely(_handle)) \
-		_handle->stats._field += _delta; \
+		DP_STATS_COUNTER_OP(_handle, _handle->stats, 0, \
+				    _handle->stats._field, \
+				    add, _delta) \
 }
 
 #define DP_PEER_LINK_STATS_INCC(_handle, _field, _delta, _cond, _link) \
 { \
 	if (_cond && likely(_handle)) \
-		_handle->stats[_link]._field += _delta; \
+		DP_STATS_COUNTER_OP(_handle, _handle->stats[_link], _link, \
+				    _handle->stats[_link]._field, \
+				    add, _delta) \
 }
 
 #define DP_STATS_DEC(_handle, _field, _delta) \
 { \
 	if (likely(_handle)) \
-		_handle->stats._field -= _delta; \
+		DP_STATS_COUNTER_OP(_handle, _handle->stats, 0, \
+				    _handle->stats._field, \
+				    sub, _delta) \
 }
 
 #define DP_PEER_STATS_FLAT_DEC(_handle, _field, _delta) \
@@ -1232,6 +1409,7 @@ void DP_PRINT_STATS(const char *fmt, ...);
 
 #else
 #define DP_STATS_INC(_handle, _field, _delta)
+#define DP_STATS_INC_DIRECT(_handle, _field, _delta)
 #define DP_PEER_LINK_STATS_INC(_handle, _field, _delta, _link)
 #define DP_PEER_STATS_FLAT_INC(_handle, _field, _delta)
 #define DP_STATS_INCC(_handle, _field, _delta, _cond)
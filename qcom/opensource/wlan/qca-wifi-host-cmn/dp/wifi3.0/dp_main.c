@@ -1153,6 +1153,8 @@ dp_print_peer_ast_entries(struct dp_soc *soc, struct dp_peer *peer, void *arg)
 
 void dp_print_ast_stats(struct dp_soc *soc)
 {
+	DP_STATS_PCPU_FOLD(soc);
+
 	DP_PRINT_STATS("AST Stats:");
 	DP_PRINT_STATS("	Entries Added   = %d", soc->stats.ast.added);
 	DP_PRINT_STATS("	Entries Deleted = %d", soc->stats.ast.deleted);
@@ -3686,6 +3688,8 @@ QDF_STATUS dp_pdev_attach_wifi3(struct cdp_soc_t *txrx_soc,
 		goto fail7;
 	}
 
+	DP_STATS_PCPU_ATTACH(pdev, tx_i, rx);
+
 	return QDF_STATUS_SUCCESS;
 
 fail7:
@@ -3954,6 +3958,7 @@ static void dp_pdev_detach(struct cdp_pdev *txrx_pdev, int force)
 	soc->pdev_list[pdev->pdev_id] = NULL;
 
 	wlan_cfg_pdev_detach(pdev->wlan_cfg_ctx);
+	DP_STATS_PCPU_DETACH(pdev);
 	wlan_minidump_remove(pdev, sizeof(*pdev), soc->ctrl_psoc,
 			     WLAN_MD_DP_PDEV, "dp_pdev");
 	dp_context_free_mem(soc, DP_PDEV_TYPE, pdev);
@@ -4059,6 +4064,7 @@ static void dp_soc_detach(struct cdp_soc_t *txrx_soc)
 
 	dp_soc_unset_qref_debug_list(soc);
 	dp_sysfs_deinitialize_stats(soc);
+	DP_STATS_PCPU_DETACH(soc);
 	dp_soc_swlm_detach(soc);
 	dp_soc_tx_desc_sw_pools_free(soc);
 	dp_soc_srng_free(soc);
@@ -4854,6 +4860,7 @@ static QDF_STATUS dp_vdev_attach_wifi3(struct cdp_soc_t *cdp_soc,
 	dp_cfg_event_record_vdev_evt(soc, DP_CFG_EVENT_VDEV_ATTACH, vdev);
 	dp_info("Created vdev %pK ("QDF_MAC_ADDR_FMT") vdev_id %d", vdev,
 		QDF_MAC_ADDR_REF(vdev->mac_addr.raw), vdev->vdev_id);
+	DP_STATS_PCPU_ATTACH(vdev, tx_i, rx);
 	DP_STATS_INIT(vdev);
 
 	if (QDF_IS_STATUS_ERROR(soc->arch_ops.txrx_vdev_attach(soc, vdev)))
@@ -5487,6 +5494,7 @@ static QDF_STATUS dp_txrx_peer_detach(struct dp_soc *soc, struct dp_peer *peer)
 		dp_peer_rx_bufq_resources_deinit(txrx_peer);
 		dp_peer_jitter_stats_ctx_dealloc(pdev, txrx_peer);
 		dp_peer_sawf_stats_ctx_free(soc, txrx_peer);
+		DP_STATS_PCPU_DETACH(txrx_peer);
 
 		qdf_mem_free(txrx_peer);
 	}
@@ -5527,6 +5535,7 @@ static QDF_STATUS dp_txrx_peer_attach(struct dp_soc *soc, struct dp_peer *peer)
 	pdev = peer->vdev->pdev;
 	txrx_peer->stats_arr_size = stats_arr_size;
 
+	DP_TXRX_PEER_STATS_PCPU_ATTACH(txrx_peer, txrx_peer->stats_arr_size);
 	DP_TXRX_PEER_STATS_INIT(txrx_peer,
 				(txrx_peer->stats_arr_size *
 				sizeof(struct dp_peer_stats)));
@@ -5662,6 +5671,7 @@ dp_peer_create_wifi3(struct cdp_soc_t *soc_hdl, uint8_t vdev_id,
 		dp_peer_cleanup(vdev, peer);
 
 		dp_peer_vdev_list_add(soc, vdev, peer);
+		dp_peer_hash_relink_wait(peer);
 		dp_peer_find_hash_add(soc, peer);
 
 		if (dp_peer_rx_tids_create(peer) != QDF_STATUS_SUCCESS) {
@@ -6149,7 +6159,7 @@ static QDF_STATUS dp_cp_peer_del_resp_handler(struct cdp_soc_t *soc_hdl,
 		   cookie,
 		   CDP_TXRX_AST_DELETED);
 	}
-	qdf_mem_free(ast_entry);
+	dp_peer_ast_mem_free(ast_entry);
 
 	return QDF_STATUS_SUCCESS;
 }
@@ -6403,6 +6413,7 @@ free_vdev:
 				     vdev);
 	wlan_minidump_remove(vdev, sizeof(*vdev), soc->ctrl_psoc,
 			     WLAN_MD_DP_VDEV, "dp_vdev");
+	DP_STATS_PCPU_DETACH(vdev);
 	qdf_mem_free(vdev);
 	vdev = NULL;
 
@@ -6480,7 +6491,7 @@ void dp_peer_unref_delete(struct dp_peer *peer, enum dp_mod_id mod_id)
 		dp_txrx_peer_detach(soc, peer);
 		dp_cfg_event_record_peer_evt(soc, DP_CFG_EVENT_PEER_UNREF_DEL,
 					     peer, vdev, 0);
-		qdf_mem_free(peer);
+		dp_peer_mem_free(peer);
 
 		/*
 		 * Decrement ref count taken at peer create
@@ -6927,6 +6938,7 @@ void dp_aggregate_vdev_stats(struct dp_vdev *vdev,
 	if (!vdev || !vdev->pdev)
 		return;
 
+	DP_STATS_PCPU_FOLD(vdev);
 	dp_update_vdev_ingress_stats(vdev);
 
 	dp_copy_vdev_stats_to_tgt_buf(vdev_stats,
@@ -6958,6 +6970,8 @@ void dp_aggregate_pdev_stats(struct dp_pdev *pdev)
 
 	soc = pdev->soc;
 
+	DP_STATS_PCPU_FOLD(pdev);
+
 	qdf_mem_zero(&pdev->stats.tx, sizeof(pdev->stats.tx));
 	qdf_mem_zero(&pdev->stats.rx, sizeof(pdev->stats.rx));
 	qdf_mem_zero(&pdev->stats.tx_i, sizeof(pdev->stats.tx_i));
@@ -7648,6 +7662,8 @@ void dp_get_peer_tx_per(struct cdp_peer_stats *peer_stats)
 
 void dp_get_peer_stats(struct dp_peer *peer, struct cdp_peer_stats *peer_stats)
 {
+	DP_STATS_PCPU_FOLD(dp_get_txrx_peer(peer));
+
 	dp_get_peer_calibr_stats(peer, peer_stats);
 
 	dp_get_peer_basic_stats(peer, peer_stats);
@@ -9678,6 +9694,8 @@ dp_txrx_get_peer_stats_param(struct cdp_soc_t *soc, uint8_t vdev_id,
 		return QDF_STATUS_E_FAILURE;
 	}
 
+	DP_STATS_PCPU_FOLD(dp_get_txrx_peer(peer));
+
 	if (type >= cdp_peer_per_pkt_stats_min &&
 	    type < cdp_peer_per_pkt_stats_max) {
 		ret = dp_txrx_get_peer_per_pkt_stats_param(peer, type, buf);
@@ -13077,6 +13095,7 @@ dp_txrx_ext_stats_request(struct cdp_soc_t *soc_hdl, uint8_t pdev_id,
 	}
 
 	dp_aggregate_pdev_stats(pdev);
+	DP_STATS_PCPU_FOLD(soc);
 
 	for(i = 0 ; i < MAX_TCL_DATA_RINGS; i++)
 		tcl_ring_full += soc->stats.tx.tcl_ring_full[i];
@@ -13808,6 +13827,7 @@ dp_soc_attach(struct cdp_ctrl_objmgr_psoc *ctrl_psoc,
 	}
 
 	dp_soc_swlm_attach(soc);
+	DP_STATS_PCPU_ATTACH(soc, tx, rx);
 	dp_soc_set_interrupt_mode(soc);
 	dp_soc_set_def_pdev(soc);
 	dp_soc_set_qref_debug_list(soc);
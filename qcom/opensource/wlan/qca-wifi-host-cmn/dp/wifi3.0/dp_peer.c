@@ -368,6 +368,40 @@ dp_peer_find_hash_index(struct dp_soc *soc,
 	return index;
 }
 
+#ifdef WLAN_DP_PEER_HASH_RCU
+/**
+ * dp_peer_mem_free_rcu_cb() - Free peer memory after the grace period
+ * @head: RCU head embedded in the peer
+ *
+ * Return: None
+ */
+static void dp_peer_mem_free_rcu_cb(qdf_rcu_head_t *head)
+{
+	qdf_mem_free(qdf_container_of(head, struct dp_peer, rcu_head));
+}
+
+void dp_peer_mem_free(struct dp_peer *peer)
+{
+	qdf_call_rcu(&peer->rcu_head, dp_peer_mem_free_rcu_cb);
+}
+
+/**
+ * dp_peer_ast_mem_free_rcu_cb() - Free AST entry after the grace period
+ * @head: RCU head embedded in the AST entry
+ *
+ * Return: None
+ */
+static void dp_peer_ast_mem_free_rcu_cb(qdf_rcu_head_t *head)
+{
+	qdf_mem_free(qdf_container_of(head, struct dp_ast_entry, rcu_head));
+}
+
+void dp_peer_ast_mem_free(struct dp_ast_entry *ase)
+{
+	qdf_call_rcu(&ase->rcu_head, dp_peer_ast_mem_free_rcu_cb);
+}
+#endif
+
 struct dp_peer *dp_peer_find_hash_find(
 				struct dp_soc *soc, uint8_t *peer_mac_addr,
 				int mac_addr_is_aligned, uint8_t vdev_id,
@@ -389,21 +423,28 @@ struct dp_peer *dp_peer_find_hash_find(
 		mac_addr = &local_mac_addr_aligned;
 	}
 	index = dp_peer_find_hash_index(soc, mac_addr);
-	qdf_spin_lock_bh(&soc->peer_hash_lock);
-	TAILQ_FOREACH(peer, &soc->peer_hash.bins[index], hash_list_elem) {
-		if (dp_peer_find_mac_addr_cmp(mac_addr, &peer->mac_addr) == 0 &&
-		    ((peer->vdev->vdev_id == vdev_id) ||
-		     (vdev_id == DP_VDEV_ALL))) {
-			/* take peer reference before returning */
-			if (dp_peer_get_ref(soc, peer, mod_id) !=
-						QDF_STATUS_SUCCESS)
-				peer = NULL;
+	dp_peer_hash_read_lock(soc);
+	DP_HASH_BIN_FOREACH_RCU(peer, &soc->peer_hash.bins[index],
+				hash_list_elem) {
+		if (dp_peer_find_mac_addr_cmp(mac_addr, &peer->mac_addr))
+			continue;
 
-			qdf_spin_unlock_bh(&soc->peer_hash_lock);
-			return peer;
-		}
+		if ((vdev_id != DP_VDEV_ALL) &&
+		    (dp_peer_hash_vdev_id(peer) != vdev_id))
+			continue;
+
+		/*
+		 * A peer whose last reference is already gone may still be
+		 * on the bin for lockless readers until the grace period
+		 * ends, skip it.
+		 */
+		if (dp_peer_get_ref(soc, peer, mod_id) != QDF_STATUS_SUCCESS)
+			continue;
+
+		dp_peer_hash_read_unlock(soc);
+		return peer;
 	}
-	qdf_spin_unlock_bh(&soc->peer_hash_lock);
+	dp_peer_hash_read_unlock(soc);
 	return NULL; /* failure */
 }
 
@@ -490,8 +531,9 @@ void dp_peer_find_hash_add(struct dp_soc *soc, struct dp_peer *peer)
 		 * this ensures that if two entries with the same MAC address
 		 * are stored, the one added first will be found first.
 		 */
-		TAILQ_INSERT_TAIL(&soc->peer_hash.bins[index], peer,
-				  hash_list_elem);
+		dp_peer_hash_set_vdev_id(peer);
+		DP_HASH_BIN_INSERT_TAIL_RCU(&soc->peer_hash.bins[index], peer,
+					    hash_list_elem);
 
 		qdf_spin_unlock_bh(&soc->peer_hash_lock);
 	} else if (peer->peer_type == CDP_MLD_PEER_TYPE) {
@@ -523,8 +565,9 @@ void dp_peer_find_hash_remove(struct dp_soc *soc, struct dp_peer *peer)
 			}
 		}
 		QDF_ASSERT(found);
-		TAILQ_REMOVE(&soc->peer_hash.bins[index], peer,
-			     hash_list_elem);
+		DP_HASH_BIN_REMOVE_RCU(&soc->peer_hash.bins[index], peer,
+				       hash_list_elem);
+		dp_peer_hash_unlinked(peer);
 
 		dp_peer_unref_delete(peer, DP_MOD_ID_CONFIG);
 		qdf_spin_unlock_bh(&soc->peer_hash_lock);
@@ -603,7 +646,9 @@ void dp_peer_find_hash_add(struct dp_soc *soc, struct dp_peer *peer)
 	 * the same MAC address are stored, the one added first will be
 	 * found first.
 	 */
-	TAILQ_INSERT_TAIL(&soc->peer_hash.bins[index], peer, hash_list_elem);
+	dp_peer_hash_set_vdev_id(peer);
+	DP_HASH_BIN_INSERT_TAIL_RCU(&soc->peer_hash.bins[index], peer,
+				    hash_list_elem);
 
 	qdf_spin_unlock_bh(&soc->peer_hash_lock);
 }
@@ -626,7 +671,9 @@ void dp_peer_find_hash_remove(struct dp_soc *soc, struct dp_peer *peer)
 		}
 	}
 	QDF_ASSERT(found);
-	TAILQ_REMOVE(&soc->peer_hash.bins[index], peer, hash_list_elem);
+	DP_HASH_BIN_REMOVE_RCU(&soc->peer_hash.bins[index], peer,
+			       hash_list_elem);
+	dp_peer_hash_unlinked(peer);
 
 	dp_peer_unref_delete(peer, DP_MOD_ID_CONFIG);
 	qdf_spin_unlock_bh(&soc->peer_hash_lock);
@@ -1186,7 +1233,8 @@ static inline void dp_peer_ast_hash_add(struct dp_soc *soc,
 	uint32_t index;
 
 	index = dp_peer_ast_hash_index(soc, &ase->mac_addr);
-	TAILQ_INSERT_TAIL(&soc->ast_hash.bins[index], ase, hash_list_elem);
+	DP_HASH_BIN_INSERT_TAIL_RCU(&soc->ast_hash.bins[index], ase,
+				    hash_list_elem);
 }
 
 void dp_peer_ast_hash_remove(struct dp_soc *soc,
@@ -1216,7 +1264,8 @@ void dp_peer_ast_hash_remove(struct dp_soc *soc,
 	QDF_ASSERT(found);
 
 	if (found)
-		TAILQ_REMOVE(&soc->ast_hash.bins[index], ase, hash_list_elem);
+		DP_HASH_BIN_REMOVE_RCU(&soc->ast_hash.bins[index], ase,
+				       hash_list_elem);
 }
 
 struct dp_ast_entry *dp_peer_ast_hash_find_by_vdevid(struct dp_soc *soc,
@@ -1316,6 +1365,70 @@ struct dp_ast_entry *dp_peer_ast_hash_find_soc_by_type(
 	return NULL;
 }
 
+QDF_STATUS dp_peer_ast_hash_find_peer_id_by_pdevid(struct dp_soc *soc,
+						   uint8_t *ast_mac_addr,
+						   uint8_t pdev_id,
+						   uint16_t *peer_id)
+{
+	union dp_align_mac_addr local_mac_addr_aligned, *mac_addr;
+	QDF_STATUS status = QDF_STATUS_E_NOENT;
+	uint32_t index;
+	struct dp_ast_entry *ase;
+
+	if (!soc->ast_hash.bins)
+		return QDF_STATUS_E_NOENT;
+
+	qdf_mem_copy(&local_mac_addr_aligned.raw[0],
+		     ast_mac_addr, QDF_MAC_ADDR_SIZE);
+	mac_addr = &local_mac_addr_aligned;
+
+	index = dp_peer_ast_hash_index(soc, mac_addr);
+	dp_ast_hash_read_lock(soc);
+	DP_HASH_BIN_FOREACH_RCU(ase, &soc->ast_hash.bins[index],
+				hash_list_elem) {
+		if ((pdev_id == ase->pdev_id) &&
+		    !dp_peer_find_mac_addr_cmp(mac_addr, &ase->mac_addr)) {
+			*peer_id = ase->peer_id;
+			status = QDF_STATUS_SUCCESS;
+			break;
+		}
+	}
+	dp_ast_hash_read_unlock(soc);
+
+	return status;
+}
+
+bool dp_peer_ast_hash_exist_by_vdevid(struct dp_soc *soc,
+				      uint8_t *ast_mac_addr,
+				      uint8_t vdev_id)
+{
+	union dp_align_mac_addr local_mac_addr_aligned, *mac_addr;
+	bool found = false;
+	uint32_t index;
+	struct dp_ast_entry *ase;
+
+	if (!soc->ast_hash.bins)
+		return false;
+
+	qdf_mem_copy(&local_mac_addr_aligned.raw[0],
+		     ast_mac_addr, QDF_MAC_ADDR_SIZE);
+	mac_addr = &local_mac_addr_aligned;
+
+	index = dp_peer_ast_hash_index(soc, mac_addr);
+	dp_ast_hash_read_lock(soc);
+	DP_HASH_BIN_FOREACH_RCU(ase, &soc->ast_hash.bins[index],
+				hash_list_elem) {
+		if ((vdev_id == ase->vdev_id) &&
+		    !dp_peer_find_mac_addr_cmp(mac_addr, &ase->mac_addr)) {
+			found = true;
+			break;
+		}
+	}
+	dp_ast_hash_read_unlock(soc);
+
+	return found;
+}
+
 /**
  * dp_peer_map_ipa_evt() - Send peer map event to IPA
  * @soc: SoC handle
@@ -1938,7 +2051,7 @@ void dp_peer_free_ast_entry(struct dp_soc *soc,
 	DP_STATS_INC(soc, ast.deleted, 1);
 	dp_peer_ast_hash_remove(soc, ast_entry);
 	dp_peer_ast_cleanup(soc, ast_entry);
-	qdf_mem_free(ast_entry);
+	dp_peer_ast_mem_free(ast_entry);
 	soc->num_ast_entries--;
 }
 
@@ -2218,6 +2331,21 @@ struct dp_ast_entry *dp_peer_ast_hash_find_soc_by_type(
 	return NULL;
 }
 
+QDF_STATUS dp_peer_ast_hash_find_peer_id_by_pdevid(struct dp_soc *soc,
+						   uint8_t *ast_mac_addr,
+						   uint8_t pdev_id,
+						   uint16_t *peer_id)
+{
+	return QDF_STATUS_E_NOENT;
+}
+
+bool dp_peer_ast_hash_exist_by_vdevid(struct dp_soc *soc,
+				      uint8_t *ast_mac_addr,
+				      uint8_t vdev_id)
+{
+	return false;
+}
+
 static inline
 QDF_STATUS dp_peer_host_add_map_ast(struct dp_soc *soc, uint16_t peer_id,
 				    uint8_t *mac_addr, uint16_t hw_peer_id,
@@ -2344,7 +2472,7 @@ static uint32_t dp_peer_ast_free_wds_entries(struct dp_soc *soc,
 					    ast_entry->cookie,
 					    CDP_TXRX_AST_DELETED);
 
-		qdf_mem_free(ast_entry);
+		dp_peer_ast_mem_free(ast_entry);
 	}
 
 	return num_ast;
@@ -3217,6 +3345,7 @@ dp_peer_find_detach(struct dp_soc *soc)
 	dp_peer_ast_hash_detach(soc);
 	dp_peer_ast_table_detach(soc);
 	dp_peer_mec_hash_detach(soc);
+	dp_peer_hash_rcu_barrier();
 }
 #else
 void
@@ -3224,6 +3353,7 @@ dp_peer_find_detach(struct dp_soc *soc)
 {
 	dp_peer_find_map_detach(soc);
 	dp_peer_find_hash_detach(soc);
+	dp_peer_hash_rcu_barrier();
 }
 #endif
 
@@ -3440,11 +3570,119 @@ dp_rx_sec_ind_handler(struct dp_soc *soc, uint16_t peer_id,
 }
 
 #ifdef QCA_PEER_EXT_STATS
-QDF_STATUS dp_peer_delay_stats_ctx_alloc(struct dp_soc *soc,
-					 struct dp_txrx_peer *txrx_peer)
+#ifdef DP_HIST_LOG_LINEAR
+/**
+ * dp_peer_delay_stats_ll_alloc() - Allocate log-linear delay histograms
+ * @delay_stats: Peer delay stats
+ *
+ * The percentile buckets are allocated per TID rather than as part of
+ * the delay stats, which keeps each allocation small. A TID whose
+ * allocation fails still gets the fixed buckets and reports no
+ * percentiles.
+ *
+ * Return: void
+ */
+static void
+dp_peer_delay_stats_ll_alloc(struct dp_peer_delay_stats *delay_stats)
+{
+	uint8_t tid;
+
+	for (tid = 0; tid < CDP_MAX_DATA_TIDS; tid++)
+		delay_stats->ll[tid] =
+			qdf_mem_malloc(sizeof(struct cdp_hist_log_linear) *
+				       DP_PEER_DELAY_LL_PER_TID);
+}
+
+/**
+ * dp_peer_delay_stats_ll_free() - Free log-linear delay histograms
+ * @delay_stats: Peer delay stats
+ *
+ * Return: void
+ */
+static void
+dp_peer_delay_stats_ll_free(struct dp_peer_delay_stats *delay_stats)
+{
+	uint8_t tid;
+
+	for (tid = 0; tid < CDP_MAX_DATA_TIDS; tid++) {
+		qdf_mem_free(delay_stats->ll[tid]);
+		delay_stats->ll[tid] = NULL;
+	}
+}
+
+/**
+ * dp_peer_delay_stats_ll_attach() - Attach log-linear storage of a context
+ * @delay_stats: Peer delay stats
+ * @tid: TID
+ * @ctx_id: TX/RX context
+ *
+ * Return: void
+ */
+static void
+dp_peer_delay_stats_ll_attach(struct dp_peer_delay_stats *delay_stats,
+			      uint8_t tid, uint8_t ctx_id)
+{
+	struct cdp_delay_tid_stats *tid_stats =
+				&delay_stats->delay_tid_stats[tid][ctx_id];
+	struct cdp_hist_log_linear *ll = delay_stats->ll[tid];
+
+	if (!ll)
+		return;
+
+	ll += ctx_id * DP_PEER_DELAY_LL_PER_CTX;
+	dp_hist_ll_attach(&tid_stats->tx_delay.tx_swq_delay, &ll[0]);
+	dp_hist_ll_attach(&tid_stats->tx_delay.hwtx_delay, &ll[1]);
+	dp_hist_ll_attach(&tid_stats->rx_delay.to_stack_delay, &ll[2]);
+}
+#else
+static inline void
+dp_peer_delay_stats_ll_alloc(struct dp_peer_delay_stats *delay_stats)
+{
+}
+
+static inline void
+dp_peer_delay_stats_ll_free(struct dp_peer_delay_stats *delay_stats)
+{
+}
+
+static inline void
+dp_peer_delay_stats_ll_attach(struct dp_peer_delay_stats *delay_stats,
+			      uint8_t tid, uint8_t ctx_id)
+{
+}
+#endif
+
+/**
+ * dp_peer_delay_stats_init() - Set up the delay histograms of a peer
+ * @delay_stats: Peer delay stats, log-linear storage already allocated
+ *
+ * Return: void
+ */
+static void dp_peer_delay_stats_init(struct dp_peer_delay_stats *delay_stats)
 {
 	uint8_t tid, ctx_id;
 
+	for (tid = 0; tid < CDP_MAX_DATA_TIDS; tid++) {
+		for (ctx_id = 0; ctx_id < CDP_MAX_TXRX_CTX; ctx_id++) {
+			struct cdp_delay_tx_stats *tx_delay =
+			&delay_stats->delay_tid_stats[tid][ctx_id].tx_delay;
+			struct cdp_delay_rx_stats *rx_delay =
+			&delay_stats->delay_tid_stats[tid][ctx_id].rx_delay;
+
+			dp_hist_init(&tx_delay->tx_swq_delay,
+				     CDP_HIST_TYPE_SW_ENQEUE_DELAY);
+			dp_hist_init(&tx_delay->hwtx_delay,
+				     CDP_HIST_TYPE_HW_COMP_DELAY);
+			dp_hist_init(&rx_delay->to_stack_delay,
+				     CDP_HIST_TYPE_REAP_STACK);
+			dp_peer_delay_stats_ll_attach(delay_stats, tid, ctx_id);
+		}
+	}
+}
+
+QDF_STATUS dp_peer_delay_stats_ctx_alloc(struct dp_soc *soc,
+					 struct dp_txrx_peer *txrx_peer)
+{
 	if (!soc || !txrx_peer) {
 		dp_warn("Null soc%pK or peer%pK", soc, txrx_peer);
 		return QDF_STATUS_E_INVAL;
@@ -3463,21 +3701,8 @@ QDF_STATUS dp_peer_delay_stats_ctx_alloc(struct dp_soc *soc,
 		return QDF_STATUS_E_NOMEM;
 	}
 
-	for (tid = 0; tid < CDP_MAX_DATA_TIDS; tid++) {
-		for (ctx_id = 0; ctx_id < CDP_MAX_TXRX_CTX; ctx_id++) {
-			struct cdp_delay_tx_stats *tx_delay =
-			&txrx_peer->delay_stats->delay_tid_stats[tid][ctx_id].tx_delay;
-			struct cdp_delay_rx_stats *rx_delay =
-			&txrx_peer->delay_stats->delay_tid_stats[tid][ctx_id].rx_delay;
-
-			dp_hist_init(&tx_delay->tx_swq_delay,
-				     CDP_HIST_TYPE_SW_ENQEUE_DELAY);
-			dp_hist_init(&tx_delay->hwtx_delay,
-				     CDP_HIST_TYPE_HW_COMP_DELAY);
-			dp_hist_init(&rx_delay->to_stack_delay,
-				     CDP_HIST_TYPE_REAP_STACK);
-		}
-	}
+	dp_peer_delay_stats_ll_alloc(txrx_peer->delay_stats);
+	dp_peer_delay_stats_init(txrx_peer->delay_stats);
 
 	return QDF_STATUS_SUCCESS;
 }
@@ -3496,15 +3721,18 @@ void dp_peer_delay_stats_ctx_dealloc(struct dp_soc *soc,
 	if (!txrx_peer->delay_stats)
 		return;
 
+	dp_peer_delay_stats_ll_free(txrx_peer->delay_stats);
 	qdf_mem_free(txrx_peer->delay_stats);
 	txrx_peer->delay_stats = NULL;
 }
 
 void dp_peer_delay_stats_ctx_clr(struct dp_txrx_peer *txrx_peer)
 {
-	if (txrx_peer->delay_stats)
-		qdf_mem_zero(txrx_peer->delay_stats,
-			     sizeof(struct dp_peer_delay_stats));
+	if (txrx_peer->delay_stats) {
+		qdf_mem_zero(txrx_peer->delay_stats->delay_tid_stats,
+			     sizeof(txrx_peer->delay_stats->delay_tid_stats));
+		dp_peer_delay_stats_init(txrx_peer->delay_stats);
+	}
 }
 #endif
 
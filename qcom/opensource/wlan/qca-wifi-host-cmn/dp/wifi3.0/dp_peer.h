@@ -229,6 +229,219 @@ struct dp_peer *dp_peer_find_hash_find(struct dp_soc *soc,
 				       uint8_t vdev_id,
 				       enum dp_mod_id mod_id);
 
+#ifdef WLAN_DP_PEER_HASH_RCU
+/*
+ * Peer and AST hash bins are walked by lookups under RCU only, while
+ * add/remove keep serializing on soc->peer_hash_lock and soc->ast_lock.
+ * Writers publish with release semantics and never clear the next
+ * pointer of an unlinked element, so a reader sitting on it can still
+ * finish its walk. The element is freed after a grace period.
+ */
+#define DP_HASH_BIN_FOREACH_RCU(_var, _head, _field) \
+	for ((_var) = qdf_rcu_dereference_bh(TAILQ_FIRST(_head)); \
+	     (_var); \
+	     (_var) = qdf_rcu_dereference_bh(TAILQ_NEXT(_var, _field)))
+
+#define DP_HASH_BIN_INSERT_TAIL_RCU(_head, _elm, _field) do { \
+	TAILQ_NEXT(_elm, _field) = NULL; \
+	(_elm)->_field.tqe_prev = (_head)->tqh_last; \
+	qdf_rcu_assign_pointer(*(_head)->tqh_last, (_elm)); \
+	(_head)->tqh_last = &TAILQ_NEXT(_elm, _field); \
+} while (0)
+
+#define DP_HASH_BIN_REMOVE_RCU(_head, _elm, _field) do { \
+	if (TAILQ_NEXT(_elm, _field)) \
+		TAILQ_NEXT(_elm, _field)->_field.tqe_prev = \
+			(_elm)->_field.tqe_prev; \
+	else \
+		(_head)->tqh_last = (_elm)->_field.tqe_prev; \
+	qdf_rcu_assign_pointer(*(_elm)->_field.tqe_prev, \
+			       TAILQ_NEXT(_elm, _field)); \
+} while (0)
+
+/**
+ * dp_peer_hash_read_lock() - Start a lockless walk of the peer hash
+ * @soc: soc handle
+ *
+ * Return: None
+ */
+static inline void dp_peer_hash_read_lock(struct dp_soc *soc)
+{
+	qdf_rcu_read_lock_bh();
+}
+
+/**
+ * dp_peer_hash_read_unlock() - End a lockless walk of the peer hash
+ * @soc: soc handle
+ *
+ * Return: None
+ */
+static inline void dp_peer_hash_read_unlock(struct dp_soc *soc)
+{
+	qdf_rcu_read_unlock_bh();
+}
+
+/**
+ * dp_ast_hash_read_lock() - Start a lockless walk of the AST hash
+ * @soc: soc handle
+ *
+ * Return: None
+ */
+static inline void dp_ast_hash_read_lock(struct dp_soc *soc)
+{
+	qdf_rcu_read_lock_bh();
+}
+
+/**
+ * dp_ast_hash_read_unlock() - End a lockless walk of the AST hash
+ * @soc: soc handle
+ *
+ * Return: None
+ */
+static inline void dp_ast_hash_read_unlock(struct dp_soc *soc)
+{
+	qdf_rcu_read_unlock_bh();
+}
+
+/**
+ * dp_peer_mem_free() - Free peer memory once hash readers are done
+ * @peer: peer already unlinked from the peer hash
+ *
+ * Return: None
+ */
+void dp_peer_mem_free(struct dp_peer *peer);
+
+/**
+ * dp_peer_ast_mem_free() - Free AST entry once hash readers are done
+ * @ase: AST entry already unlinked from the AST hash
+ *
+ * Return: None
+ */
+void dp_peer_ast_mem_free(struct dp_ast_entry *ase);
+
+/**
+ * dp_peer_hash_rcu_barrier() - Wait for all deferred peer/AST frees
+ *
+ * Return: None
+ */
+static inline void dp_peer_hash_rcu_barrier(void)
+{
+	qdf_rcu_barrier();
+}
+
+/**
+ * dp_peer_hash_set_vdev_id() - Cache the vdev id for lockless hash readers
+ * @peer: peer about to be linked into the peer hash
+ *
+ * Readers match the vdev before they own a peer reference, at which point
+ * peer->vdev may already be released.
+ *
+ * Return: None
+ */
+static inline void dp_peer_hash_set_vdev_id(struct dp_peer *peer)
+{
+	peer->hash_vdev_id = peer->vdev->vdev_id;
+}
+
+/**
+ * dp_peer_hash_vdev_id() - vdev id of a peer found on the peer hash
+ * @peer: peer linked into the peer hash
+ *
+ * Return: vdev id
+ */
+static inline uint8_t dp_peer_hash_vdev_id(struct dp_peer *peer)
+{
+	return peer->hash_vdev_id;
+}
+
+/**
+ * dp_peer_hash_unlinked() - Note the grace period a peer left the hash in
+ * @peer: peer just unlinked from the peer hash
+ *
+ * Return: None
+ */
+static inline void dp_peer_hash_unlinked(struct dp_peer *peer)
+{
+	peer->hash_unlink_gp = qdf_rcu_get_state();
+}
+
+/**
+ * dp_peer_hash_relink_wait() - Wait until no reader can still be on the
+ *	links a peer had before it was unlinked
+ * @peer: unlinked peer which is about to be linked back
+ *
+ * Linking clears the peer's next pointer. A reader still on the peer from
+ * before the unlink would then end its walk early and miss the rest of
+ * the bin. Must be called from a context that can sleep.
+ *
+ * Return: None
+ */
+static inline void dp_peer_hash_relink_wait(struct dp_peer *peer)
+{
+	qdf_cond_synchronize_rcu(peer->hash_unlink_gp);
+}
+#else
+#define DP_HASH_BIN_FOREACH_RCU(_var, _head, _field) \
+	TAILQ_FOREACH(_var, _head, _field)
+
+#define DP_HASH_BIN_INSERT_TAIL_RCU(_head, _elm, _field) \
+	TAILQ_INSERT_TAIL(_head, _elm, _field)
+
+#define DP_HASH_BIN_REMOVE_RCU(_head, _elm, _field) \
+	TAILQ_REMOVE(_head, _elm, _field)
+
+static inline void dp_peer_hash_read_lock(struct dp_soc *soc)
+{
+	qdf_spin_lock_bh(&soc->peer_hash_lock);
+}
+
+static inline void dp_peer_hash_read_unlock(struct dp_soc *soc)
+{
+	qdf_spin_unlock_bh(&soc->peer_hash_lock);
+}
+
+static inline void dp_ast_hash_read_lock(struct dp_soc *soc)
+{
+	qdf_spin_lock_bh(&soc->ast_lock);
+}
+
+static inline void dp_ast_hash_read_unlock(struct dp_soc *soc)
+{
+	qdf_spin_unlock_bh(&soc->ast_lock);
+}
+
+static inline void dp_peer_mem_free(struct dp_peer *peer)
+{
+	qdf_mem_free(peer);
+}
+
+static inline void dp_peer_ast_mem_free(struct dp_ast_entry *ase)
+{
+	qdf_mem_free(ase);
+}
+
+static inline void dp_peer_hash_rcu_barrier(void)
+{
+}
+
+static inline void dp_peer_hash_set_vdev_id(struct dp_peer *peer)
+{
+}
+
+static inline uint8_t dp_peer_hash_vdev_id(struct dp_peer *peer)
+{
+	return peer->vdev->vdev_id;
+}
+
+static inline void dp_peer_hash_unlinked(struct dp_peer *peer)
+{
+}
+
+static inline void dp_peer_hash_relink_wait(struct dp_peer *peer)
+{
+}
+#endif /* WLAN_DP_PEER_HASH_RCU */
+
 /**
  * dp_peer_find_by_id_valid - check if peer exists for given id
  * @soc: core DP soc context
@@ -921,6 +1134,41 @@ struct dp_ast_entry *dp_peer_ast_hash_find_soc_by_type(
 					uint8_t *ast_mac_addr,
 					enum cdp_txrx_ast_entry_type type);
 
+/**
+ * dp_peer_ast_hash_find_peer_id_by_pdevid() - Find the peer id of the AST
+ * entry matching MAC address and pdev
+ * @soc: SoC handle
+ * @ast_mac_addr: Mac address
+ * @pdev_id: pdev Id
+ *
+ * @peer_id: filled with the peer id of the matching entry
+ *
+ * Takes the AST hash read side itself, the caller must not hold ast_lock.
+ * Only the peer id is handed out so no AST entry outlives the lookup.
+ *
+ * Return: QDF_STATUS_SUCCESS if an entry matches,
+ *         QDF_STATUS_E_NOENT otherwise
+ */
+QDF_STATUS dp_peer_ast_hash_find_peer_id_by_pdevid(struct dp_soc *soc,
+						   uint8_t *ast_mac_addr,
+						   uint8_t pdev_id,
+						   uint16_t *peer_id);
+
+/**
+ * dp_peer_ast_hash_exist_by_vdevid() - Check for an AST entry matching
+ * MAC address and vdev
+ * @soc: SoC handle
+ * @ast_mac_addr: Mac address
+ * @vdev_id: vdev Id
+ *
+ * Takes the AST hash read side itself, the caller must not hold ast_lock.
+ *
+ * Return: true if an entry exists
+ */
+bool dp_peer_ast_hash_exist_by_vdevid(struct dp_soc *soc,
+				      uint8_t *ast_mac_addr,
+				      uint8_t vdev_id);
+
 /**
  * dp_peer_ast_get_pdev_id() - get pdev_id from the ast entry
  * @soc: SoC handle
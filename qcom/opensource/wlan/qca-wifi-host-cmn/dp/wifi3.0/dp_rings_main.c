@@ -2340,6 +2340,7 @@ void dp_soc_deinit(void *txrx_soc)
 
 	dp_reo_desc_freelist_destroy(soc);
 	dp_reo_desc_deferred_freelist_destroy(soc);
+	dp_reo_qdesc_pool_destroy(soc);
 
 	DEINIT_RX_HW_STATS_LOCK(soc);
 
@@ -3645,6 +3646,7 @@ void *dp_soc_init(struct dp_soc *soc, HTC_HANDLE htc_handle,
 	qdf_create_work(0, &soc->htt_stats.work, htt_t2h_stats_handler, soc);
 
 	dp_reo_desc_deferred_freelist_create(soc);
+	dp_reo_qdesc_pool_create(soc);
 
 	dp_info("Mem stats: DMA = %u HEAP = %u SKB = %u",
 		qdf_dma_mem_stats_read(),
@@ -511,7 +511,7 @@ static inline uint32_t dp_rx_get_le32_split(uint8_t b0, uint8_t b1, uint8_t b2,
  */
 static inline uint32_t dp_rx_get_le32(const uint8_t *p)
 {
-	return dp_rx_get_le32_split(p[0], p[1], p[2], p[3]);
+	return qdf_get_unaligned_le32(p);
 }
 
 /**
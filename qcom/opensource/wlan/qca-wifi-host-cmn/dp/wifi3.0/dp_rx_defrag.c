@@ -640,8 +640,9 @@ static QDF_STATUS dp_rx_defrag_mic(struct dp_soc *soc, const uint8_t *key,
 				   uint16_t data_len, uint8_t mic[])
 {
 	uint8_t hdr[16] = { 0, };
+	uint8_t last[sizeof(uint32_t)];
 	uint32_t l, r;
-	const uint8_t *data;
+	const uint8_t *data, *end;
 	uint32_t space;
 	int rx_desc_len = soc->rx_pkt_tlv_size;
 
@@ -669,16 +670,37 @@ static QDF_STATUS dp_rx_defrag_mic(struct dp_soc *soc, const uint8_t *key,
 		if (space > data_len)
 			space = data_len;
 
-		/* collect 32-bit blocks from current buffer */
-		while (space >= sizeof(uint32_t)) {
+		/*
+		 * Collect 32-bit blocks from current buffer, one word load
+		 * per block straight out of the fragment data
+		 */
+		end = data + (space & ~(sizeof(uint32_t) - 1));
+		space -= end - data;
+		data_len -= end - data;
+		while (data < end) {
 			l ^= dp_rx_get_le32(data);
 			dp_rx_michael_block(l, r);
 			data += sizeof(uint32_t);
-			space -= sizeof(uint32_t);
-			data_len -= sizeof(uint32_t);
 		}
-		if (data_len < sizeof(uint32_t))
+		if (data_len < sizeof(uint32_t)) {
+			/*
+			 * The last partial block continues in, or sits
+			 * entirely in, the next fragment; gather it here.
+			 */
+			if (space < data_len) {
+				wbuf = qdf_nbuf_next(wbuf);
+				if (!wbuf || qdf_nbuf_len(wbuf) <
+					     off + data_len - space)
+					return QDF_STATUS_E_DEFRAG_ERROR;
+
+				qdf_mem_copy(last, data, space);
+				qdf_mem_copy(&last[space],
+					     (uint8_t *)qdf_nbuf_data(wbuf) + off,
+					     data_len - space);
+				data = last;
+			}
 			break;
+		}
 
 		wbuf = qdf_nbuf_next(wbuf);
 		if (!wbuf)
@@ -691,8 +713,8 @@ static QDF_STATUS dp_rx_defrag_mic(struct dp_soc *soc, const uint8_t *key,
 			 */
 			data_next =
 				(uint8_t *)qdf_nbuf_data(wbuf) + off;
-			if ((qdf_nbuf_len(wbuf)) <
-				sizeof(uint32_t) - space) {
+			if (qdf_nbuf_len(wbuf) <
+			    off + sizeof(uint32_t) - space) {
 				return QDF_STATUS_E_DEFRAG_ERROR;
 			}
 			switch (space) {
@@ -797,15 +819,18 @@ static QDF_STATUS dp_rx_defrag_tkip_demic(struct dp_soc *soc,
 			return QDF_STATUS_E_DEFRAG_ERROR;
 		}
 		len0 = dp_f_tkip.ic_miclen - (uint8_t)prev_data_len;
-		qdf_nbuf_copy_bits(prev0, qdf_nbuf_len(prev0) - len0, len0,
-				   (caddr_t)mic0);
+		if (qdf_nbuf_len(prev0) < hdrlen + len0)
+			return QDF_STATUS_E_DEFRAG_ERROR;
+
+		/* Fragments are still linear, read the MIC tail in place */
+		qdf_mem_copy(mic0, qdf_nbuf_data(prev0) +
+			     qdf_nbuf_len(prev0) - len0, len0);
 		qdf_nbuf_trim_tail(prev0, len0);
 	}
 
-	qdf_nbuf_copy_bits(prev, (qdf_nbuf_len(prev) -
-			   (dp_f_tkip.ic_miclen - len0)),
-			   (dp_f_tkip.ic_miclen - len0),
-			   (caddr_t)(&mic0[len0]));
+	qdf_mem_copy(&mic0[len0], qdf_nbuf_data(prev) + qdf_nbuf_len(prev) -
+		     (dp_f_tkip.ic_miclen - len0),
+		     dp_f_tkip.ic_miclen - len0);
 	qdf_nbuf_trim_tail(prev, (dp_f_tkip.ic_miclen - len0));
 	pktlen -= dp_f_tkip.ic_miclen;
 
@@ -826,6 +851,15 @@ static QDF_STATUS dp_rx_defrag_tkip_demic(struct dp_soc *soc,
 	return QDF_STATUS_SUCCESS;
 }
 
+#ifdef WLAN_DP_RX_DEFRAG_TEST
+QDF_STATUS dp_rx_defrag_tkip_demic_test(struct dp_soc *soc,
+					const uint8_t *key,
+					qdf_nbuf_t msdu, uint16_t hdrlen)
+{
+	return dp_rx_defrag_tkip_demic(soc, key, msdu, hdrlen);
+}
+#endif
+
 /**
  * dp_rx_frag_pull_hdr() - Pulls the RXTLV & the 802.11 headers
  * @soc: DP SOC
@@ -1013,38 +1047,15 @@ dp_rx_defrag_nwifi_to_8023(struct dp_soc *soc, struct dp_txrx_peer *txrx_peer,
 	struct ethernet_hdr_t *eth_hdr;
 	uint8_t ether_type[2];
 	uint16_t fc = 0;
-	union dp_align_mac_addr mac_addr;
-	uint8_t *rx_desc_info = qdf_mem_malloc(soc->rx_pkt_tlv_size);
+	union dp_align_mac_addr da = {0}, sa = {0};
+	uint8_t *rx_desc_info = qdf_nbuf_data(nbuf);
 	struct dp_rx_tid_defrag *rx_tid = &txrx_peer->rx_tid[tid];
-	struct ieee80211_frame_addr4 wh = {0};
-
-	hal_rx_tlv_get_pn_num(soc->hal_soc, qdf_nbuf_data(nbuf), rx_tid->pn128);
-
-	hal_rx_print_pn(soc->hal_soc, qdf_nbuf_data(nbuf));
-
-	if (!rx_desc_info) {
-		QDF_TRACE(QDF_MODULE_ID_DP, QDF_TRACE_LEVEL_ERROR,
-			"%s: Memory alloc failed ! ", __func__);
-		QDF_ASSERT(0);
-		return;
-	}
-
-	qdf_mem_zero(&wh, sizeof(struct ieee80211_frame_addr4));
-	if (hal_rx_get_mpdu_mac_ad4_valid(soc->hal_soc, qdf_nbuf_data(nbuf)))
-		qdf_mem_copy(&wh, qdf_nbuf_data(nbuf) + soc->rx_pkt_tlv_size,
-			     hdrsize);
-
-	qdf_mem_copy(rx_desc_info, qdf_nbuf_data(nbuf), soc->rx_pkt_tlv_size);
-
-	llchdr = (struct llc_snap_hdr_t *)(qdf_nbuf_data(nbuf) +
-					soc->rx_pkt_tlv_size + hdrsize);
-	qdf_mem_copy(ether_type, llchdr->ethertype, 2);
+	struct ieee80211_frame_addr4 *wh;
+	uint16_t shift;
 
-	qdf_nbuf_pull_head(nbuf, (soc->rx_pkt_tlv_size + hdrsize +
-				  sizeof(struct llc_snap_hdr_t) -
-				  sizeof(struct ethernet_hdr_t)));
+	hal_rx_tlv_get_pn_num(soc->hal_soc, rx_desc_info, rx_tid->pn128);
 
-	eth_hdr = (struct ethernet_hdr_t *)(qdf_nbuf_data(nbuf));
+	hal_rx_print_pn(soc->hal_soc, rx_desc_info);
 
 	if (hal_rx_get_mpdu_frame_control_valid(soc->hal_soc,
 						rx_desc_info))
@@ -1052,45 +1063,32 @@ dp_rx_defrag_nwifi_to_8023(struct dp_soc *soc, struct dp_txrx_peer *txrx_peer,
 
 	dp_debug("Frame control type: 0x%x", fc);
 
+	/*
+	 * Pick up everything needed from the RX TLVs and the 802.11 header
+	 * before the TLVs get slid over the header below.
+	 */
 	switch (((fc & 0xff00) >> 8) & IEEE80211_FC1_DIR_MASK) {
 	case IEEE80211_FC1_DIR_NODS:
-		hal_rx_mpdu_get_addr1(soc->hal_soc, rx_desc_info,
-				      &mac_addr.raw[0]);
-		qdf_mem_copy(eth_hdr->dest_addr, &mac_addr.raw[0],
-			QDF_MAC_ADDR_SIZE);
-		hal_rx_mpdu_get_addr2(soc->hal_soc, rx_desc_info,
-				      &mac_addr.raw[0]);
-		qdf_mem_copy(eth_hdr->src_addr, &mac_addr.raw[0],
-			QDF_MAC_ADDR_SIZE);
+		hal_rx_mpdu_get_addr1(soc->hal_soc, rx_desc_info, &da.raw[0]);
+		hal_rx_mpdu_get_addr2(soc->hal_soc, rx_desc_info, &sa.raw[0]);
 		break;
 	case IEEE80211_FC1_DIR_TODS:
-		hal_rx_mpdu_get_addr3(soc->hal_soc, rx_desc_info,
-				      &mac_addr.raw[0]);
-		qdf_mem_copy(eth_hdr->dest_addr, &mac_addr.raw[0],
-			QDF_MAC_ADDR_SIZE);
-		hal_rx_mpdu_get_addr2(soc->hal_soc, rx_desc_info,
-				      &mac_addr.raw[0]);
-		qdf_mem_copy(eth_hdr->src_addr, &mac_addr.raw[0],
-			QDF_MAC_ADDR_SIZE);
+		hal_rx_mpdu_get_addr3(soc->hal_soc, rx_desc_info, &da.raw[0]);
+		hal_rx_mpdu_get_addr2(soc->hal_soc, rx_desc_info, &sa.raw[0]);
 		break;
 	case IEEE80211_FC1_DIR_FROMDS:
-		hal_rx_mpdu_get_addr1(soc->hal_soc, rx_desc_info,
-				      &mac_addr.raw[0]);
-		qdf_mem_copy(eth_hdr->dest_addr, &mac_addr.raw[0],
-			QDF_MAC_ADDR_SIZE);
-		hal_rx_mpdu_get_addr3(soc->hal_soc, rx_desc_info,
-				      &mac_addr.raw[0]);
-		qdf_mem_copy(eth_hdr->src_addr, &mac_addr.raw[0],
-			QDF_MAC_ADDR_SIZE);
+		hal_rx_mpdu_get_addr1(soc->hal_soc, rx_desc_info, &da.raw[0]);
+		hal_rx_mpdu_get_addr3(soc->hal_soc, rx_desc_info, &sa.raw[0]);
 		break;
 
 	case IEEE80211_FC1_DIR_DSTODS:
-		hal_rx_mpdu_get_addr3(soc->hal_soc, rx_desc_info,
-				      &mac_addr.raw[0]);
-		qdf_mem_copy(eth_hdr->dest_addr, &mac_addr.raw[0],
-			QDF_MAC_ADDR_SIZE);
-		qdf_mem_copy(eth_hdr->src_addr, &wh.i_addr4[0],
-			     QDF_MAC_ADDR_SIZE);
+		hal_rx_mpdu_get_addr3(soc->hal_soc, rx_desc_info, &da.raw[0]);
+		if (hal_rx_get_mpdu_mac_ad4_valid(soc->hal_soc, rx_desc_info)) {
+			wh = (struct ieee80211_frame_addr4 *)
+				(rx_desc_info + soc->rx_pkt_tlv_size);
+			qdf_mem_copy(&sa.raw[0], &wh->i_addr4[0],
+				     QDF_MAC_ADDR_SIZE);
+		}
 		break;
 
 	default:
@@ -1098,12 +1096,26 @@ dp_rx_defrag_nwifi_to_8023(struct dp_soc *soc, struct dp_txrx_peer *txrx_peer,
 		"%s: Unknown frame control type: 0x%x", __func__, fc);
 	}
 
+	llchdr = (struct llc_snap_hdr_t *)(rx_desc_info +
+					soc->rx_pkt_tlv_size + hdrsize);
+	qdf_mem_copy(ether_type, llchdr->ethertype, 2);
+
+	/*
+	 * The 802.3 header is shorter than 802.11 header + LLC/SNAP, so
+	 * slide the RX TLVs forward in place rather than bouncing them
+	 * through an allocated scratch buffer.
+	 */
+	shift = hdrsize + sizeof(struct llc_snap_hdr_t) -
+		sizeof(struct ethernet_hdr_t);
+	qdf_mem_move(rx_desc_info + shift, rx_desc_info, soc->rx_pkt_tlv_size);
+	qdf_nbuf_pull_head(nbuf, shift);
+
+	eth_hdr = (struct ethernet_hdr_t *)(qdf_nbuf_data(nbuf) +
+					    soc->rx_pkt_tlv_size);
+	qdf_mem_copy(eth_hdr->dest_addr, &da.raw[0], QDF_MAC_ADDR_SIZE);
+	qdf_mem_copy(eth_hdr->src_addr, &sa.raw[0], QDF_MAC_ADDR_SIZE);
 	qdf_mem_copy(eth_hdr->ethertype, ether_type,
 			sizeof(ether_type));
-
-	qdf_nbuf_push_head(nbuf, soc->rx_pkt_tlv_size);
-	qdf_mem_copy(qdf_nbuf_data(nbuf), rx_desc_info, soc->rx_pkt_tlv_size);
-	qdf_mem_free(rx_desc_info);
 }
 
 #ifdef RX_DEFRAG_DO_NOT_REINJECT
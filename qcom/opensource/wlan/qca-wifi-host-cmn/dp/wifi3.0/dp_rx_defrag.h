@@ -249,4 +249,22 @@ void dp_rx_defrag_cleanup(struct dp_txrx_peer *txrx_peer, unsigned int tid);
 QDF_STATUS dp_rx_defrag_add_last_frag(struct dp_soc *soc,
 				      struct dp_txrx_peer *peer, uint16_t tid,
 				      uint16_t rxseq, qdf_nbuf_t nbuf);
+
+#ifdef WLAN_DP_RX_DEFRAG_TEST
+/**
+ * dp_rx_defrag_tkip_demic_test() - Run TKIP demic on a fragment chain
+ * @soc: DP SOC, only rx_pkt_tlv_size is used
+ * @key: Michael key
+ * @msdu: Fragment chain, each with @hdrlen bytes of TLV and headers
+ * @hdrlen: Length of the RX TLVs, 802.11 header and IV of each fragment
+ *
+ * Unit test entry to dp_rx_defrag_tkip_demic(). The MIC is stripped off
+ * the tail of the chain, which may free a last fragment left empty.
+ *
+ * Return: QDF_STATUS_SUCCESS if the MIC matched
+ */
+QDF_STATUS dp_rx_defrag_tkip_demic_test(struct dp_soc *soc,
+					const uint8_t *key,
+					qdf_nbuf_t msdu, uint16_t hdrlen);
+#endif
 #endif /* _DP_RX_DEFRAG_H */
@@ -227,7 +227,7 @@ dp_rx_link_desc_return_by_addr(struct dp_soc *soc,
 	} else {
 		struct hal_srng *srng = (struct hal_srng *)wbm_rel_srng;
 
-		DP_STATS_INC(soc, rx.err.hal_ring_access_full_fail, 1);
+		DP_STATS_INC_DIRECT(soc, rx.err.hal_ring_access_full_fail, 1);
 
 		dp_info_rl("WBM Release Ring (Id %d) Full(Fail CNT %u)",
 			   srng->ring_id,
@@ -1903,7 +1903,7 @@ static int dp_rx_err_exception(struct dp_soc *soc, hal_ring_desc_t ring_desc)
 	int ret;
 	uint64_t cur_time_stamp;
 
-	DP_STATS_INC(soc, rx.err.reo_err_msdu_buf_rcved, 1);
+	DP_STATS_INC_DIRECT(soc, rx.err.reo_err_msdu_buf_rcved, 1);
 
 	/* Recover if overall error count exceeds threshold */
 	if (soc->stats.rx.err.reo_err_msdu_buf_rcved >
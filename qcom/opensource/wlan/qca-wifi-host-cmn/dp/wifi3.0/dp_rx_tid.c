@@ -396,6 +396,283 @@ dp_rx_tid_update_wifi3(struct dp_peer *peer, int tid, uint32_t ba_window_size,
 	return QDF_STATUS_SUCCESS;
 }
 
+#ifdef WLAN_DP_REO_QDESC_POOL
+#ifdef WLAN_DP_REO_QDESC_POOL_TEST
+/**
+ * dp_reo_qdesc_unmap_free() - Unmap and free a REO queue descriptor
+ * @soc: Datapath soc handle
+ * @vaddr_unaligned: allocator address of the descriptor
+ * @paddr: DMA address of the aligned descriptor
+ * @alloc_size: REO queue descriptor size
+ *
+ * The pool churn test has no device to map for, it takes over unmapping
+ * and freeing through @test_unmap_free of the pool.
+ *
+ * Return: None
+ */
+static void dp_reo_qdesc_unmap_free(struct dp_soc *soc,
+				    void *vaddr_unaligned,
+				    qdf_dma_addr_t paddr, uint32_t alloc_size)
+{
+	struct dp_reo_qdesc_pool *pool = &soc->reo_qdesc_pool;
+
+	if (pool->test_unmap_free) {
+		pool->test_unmap_free(soc, vaddr_unaligned, paddr, alloc_size);
+		return;
+	}
+
+	qdf_mem_unmap_nbytes_single(soc->osdev, paddr, QDF_DMA_BIDIRECTIONAL,
+				    alloc_size);
+	qdf_mem_free(vaddr_unaligned);
+}
+#else
+static inline void dp_reo_qdesc_unmap_free(struct dp_soc *soc,
+					   void *vaddr_unaligned,
+					   qdf_dma_addr_t paddr,
+					   uint32_t alloc_size)
+{
+	qdf_mem_unmap_nbytes_single(soc->osdev, paddr, QDF_DMA_BIDIRECTIONAL,
+				    alloc_size);
+	qdf_mem_free(vaddr_unaligned);
+}
+#endif /* WLAN_DP_REO_QDESC_POOL_TEST */
+
+void dp_reo_qdesc_pool_create(struct dp_soc *soc)
+{
+	struct dp_reo_qdesc_pool *pool = &soc->reo_qdesc_pool;
+	struct dp_reo_qdesc_pool_elem *elems;
+	uint32_t i;
+
+	qdf_mem_zero(pool, sizeof(*pool));
+	qdf_spinlock_create(&pool->lock);
+
+	/*
+	 * The qref debug lists follow freed descriptors by address and
+	 * check_free_list_for_invalid_flush() reads them back after the free,
+	 * which a reused descriptor would defeat.
+	 */
+	if (wlan_cfg_qref_control_size(soc->wlan_cfg_ctx)) {
+		dp_info("REO qdesc pool disabled, qref debug lists enabled");
+		return;
+	}
+
+	elems = qdf_mem_malloc(sizeof(*elems) * DP_REO_QDESC_POOL_NUM_CLASS *
+			       DP_REO_QDESC_POOL_CLASS_DEPTH);
+	if (!elems) {
+		dp_err("REO qdesc pool alloc failed, pooling disabled");
+		return;
+	}
+
+	for (i = 0; i < DP_REO_QDESC_POOL_NUM_CLASS; i++)
+		pool->cls[i].elems = &elems[i * DP_REO_QDESC_POOL_CLASS_DEPTH];
+
+	pool->init = true;
+}
+
+void dp_reo_qdesc_pool_destroy(struct dp_soc *soc)
+{
+	struct dp_reo_qdesc_pool *pool = &soc->reo_qdesc_pool;
+	struct dp_reo_qdesc_pool_class *cls;
+	struct dp_reo_qdesc_pool_elem *elem;
+	uint32_t i;
+
+	qdf_spin_lock_bh(&pool->lock);
+	pool->init = false;
+	qdf_spin_unlock_bh(&pool->lock);
+
+	for (i = 0; i < DP_REO_QDESC_POOL_NUM_CLASS; i++) {
+		cls = &pool->cls[i];
+		while (cls->count) {
+			elem = &cls->elems[--cls->count];
+			dp_reo_qdesc_unmap_free(soc, elem->vaddr_unaligned,
+						elem->paddr, cls->alloc_size);
+		}
+	}
+
+	dp_info("REO qdesc pool: hit %u miss %u cached %u freed %u trimmed %u",
+		pool->alloc_hit, pool->alloc_miss,
+		pool->release_cached, pool->release_freed, pool->trimmed);
+
+	/* elems of all classes come from one allocation owned by cls[0] */
+	qdf_mem_free(pool->cls[0].elems);
+	pool->cls[0].elems = NULL;
+	qdf_spinlock_destroy(&pool->lock);
+}
+
+/**
+ * dp_reo_qdesc_pool_get() - Take an aligned, DMA mapped REO queue
+ *			     descriptor of the given size from the pool
+ * @soc: Datapath soc handle
+ * @alloc_size: REO queue descriptor size
+ * @vaddr_unaligned: filled with the allocator address of the descriptor
+ * @paddr: filled with the DMA address of the aligned descriptor
+ *
+ * Return: true if a pooled descriptor was returned, false otherwise
+ */
+static bool dp_reo_qdesc_pool_get(struct dp_soc *soc, uint32_t alloc_size,
+				  void **vaddr_unaligned,
+				  qdf_dma_addr_t *paddr)
+{
+	struct dp_reo_qdesc_pool *pool = &soc->reo_qdesc_pool;
+	struct dp_reo_qdesc_pool_class *cls;
+	struct dp_reo_qdesc_pool_elem *elem;
+	uint32_t i;
+
+	qdf_spin_lock_bh(&pool->lock);
+	pool->last_get_ts = qdf_get_system_timestamp();
+	for (i = 0; pool->init && i < DP_REO_QDESC_POOL_NUM_CLASS; i++) {
+		cls = &pool->cls[i];
+		if (cls->alloc_size != alloc_size || !cls->count)
+			continue;
+
+		elem = &cls->elems[--cls->count];
+		*vaddr_unaligned = elem->vaddr_unaligned;
+		*paddr = elem->paddr;
+		pool->cached--;
+		pool->alloc_hit++;
+		qdf_spin_unlock_bh(&pool->lock);
+		return true;
+	}
+	pool->alloc_miss++;
+	qdf_spin_unlock_bh(&pool->lock);
+
+	return false;
+}
+
+/**
+ * dp_reo_qdesc_release() - Release a REO queue descriptor no longer
+ *			    referenced by HW
+ * @soc: Datapath soc handle
+ * @vaddr_unaligned: allocator address of the descriptor
+ * @paddr: DMA address of the aligned descriptor
+ * @alloc_size: REO queue descriptor size
+ *
+ * The descriptor is kept mapped in the pool for a later rx TID setup of
+ * the same size, or unmapped and freed if its class is full or the pool
+ * holds DP_REO_QDESC_POOL_HIGH_WM descriptors already.
+ *
+ * Return: None
+ */
+static void dp_reo_qdesc_release(struct dp_soc *soc, void *vaddr_unaligned,
+				 qdf_dma_addr_t paddr, uint32_t alloc_size)
+{
+	struct dp_reo_qdesc_pool *pool = &soc->reo_qdesc_pool;
+	struct dp_reo_qdesc_pool_class *cls = NULL;
+	struct dp_reo_qdesc_pool_elem *elem;
+	uint32_t i;
+
+	qdf_spin_lock_bh(&pool->lock);
+	for (i = 0; pool->init && i < DP_REO_QDESC_POOL_NUM_CLASS; i++) {
+		if (pool->cls[i].alloc_size == alloc_size) {
+			cls = &pool->cls[i];
+			break;
+		}
+		if (!cls && !pool->cls[i].alloc_size)
+			cls = &pool->cls[i];
+	}
+
+	if (cls && cls->count < DP_REO_QDESC_POOL_CLASS_DEPTH &&
+	    pool->cached < DP_REO_QDESC_POOL_HIGH_WM) {
+		cls->alloc_size = alloc_size;
+		elem = &cls->elems[cls->count++];
+		elem->vaddr_unaligned = vaddr_unaligned;
+		elem->paddr = paddr;
+		pool->cached++;
+		pool->release_cached++;
+		qdf_spin_unlock_bh(&pool->lock);
+		return;
+	}
+	pool->release_freed++;
+	qdf_spin_unlock_bh(&pool->lock);
+
+	dp_reo_qdesc_unmap_free(soc, vaddr_unaligned, paddr, alloc_size);
+}
+
+/**
+ * dp_reo_qdesc_pool_trim() - Shrink an idle REO queue descriptor pool
+ * @soc: Datapath soc handle
+ *
+ * Once no rx TID was set up for DP_REO_QDESC_POOL_IDLE_MS, unmap and free
+ * cached descriptors until each class holds DP_REO_QDESC_POOL_LOW_WM, so
+ * the peak of an association storm is not kept for the life of the soc.
+ *
+ * Return: None
+ */
+static void dp_reo_qdesc_pool_trim(struct dp_soc *soc)
+{
+	struct dp_reo_qdesc_pool *pool = &soc->reo_qdesc_pool;
+	struct dp_reo_qdesc_pool_class *cls;
+	struct dp_reo_qdesc_pool_elem elem;
+	unsigned long curr_ts = qdf_get_system_timestamp();
+	uint32_t alloc_size, i;
+
+	for (i = 0; i < DP_REO_QDESC_POOL_NUM_CLASS; i++) {
+		cls = &pool->cls[i];
+		while (true) {
+			qdf_spin_lock_bh(&pool->lock);
+			if (!pool->init ||
+			    cls->count <= DP_REO_QDESC_POOL_LOW_WM ||
+			    curr_ts < (pool->last_get_ts +
+				       DP_REO_QDESC_POOL_IDLE_MS)) {
+				qdf_spin_unlock_bh(&pool->lock);
+				break;
+			}
+
+			elem = cls->elems[--cls->count];
+			alloc_size = cls->alloc_size;
+			pool->cached--;
+			pool->trimmed++;
+			qdf_spin_unlock_bh(&pool->lock);
+
+			dp_reo_qdesc_unmap_free(soc, elem.vaddr_unaligned,
+						elem.paddr, alloc_size);
+		}
+	}
+}
+
+#ifdef WLAN_DP_REO_QDESC_POOL_TEST
+bool dp_reo_qdesc_pool_test_get(struct dp_soc *soc, uint32_t alloc_size,
+				void **vaddr_unaligned, qdf_dma_addr_t *paddr)
+{
+	return dp_reo_qdesc_pool_get(soc, alloc_size, vaddr_unaligned, paddr);
+}
+
+void dp_reo_qdesc_pool_test_release(struct dp_soc *soc,
+				    void *vaddr_unaligned,
+				    qdf_dma_addr_t paddr, uint32_t alloc_size)
+{
+	dp_reo_qdesc_release(soc, vaddr_unaligned, paddr, alloc_size);
+}
+
+void dp_reo_qdesc_pool_test_trim(struct dp_soc *soc)
+{
+	dp_reo_qdesc_pool_trim(soc);
+}
+#endif /* WLAN_DP_REO_QDESC_POOL_TEST */
+#else
+static inline bool dp_reo_qdesc_pool_get(struct dp_soc *soc,
+					 uint32_t alloc_size,
+					 void **vaddr_unaligned,
+					 qdf_dma_addr_t *paddr)
+{
+	return false;
+}
+
+static inline void dp_reo_qdesc_release(struct dp_soc *soc,
+					void *vaddr_unaligned,
+					qdf_dma_addr_t paddr,
+					uint32_t alloc_size)
+{
+	qdf_mem_unmap_nbytes_single(soc->osdev, paddr, QDF_DMA_BIDIRECTIONAL,
+				    alloc_size);
+	qdf_mem_free(vaddr_unaligned);
+}
+
+static inline void dp_reo_qdesc_pool_trim(struct dp_soc *soc)
+{
+}
+#endif /* WLAN_DP_REO_QDESC_POOL */
+
 #ifdef WLAN_DP_FEATURE_DEFERRED_REO_QDESC_DESTROY
 /**
  * dp_reo_desc_defer_free_enqueue() - enqueue REO QDESC to be freed into
@@ -459,11 +736,9 @@ static void dp_reo_desc_defer_free(struct dp_soc *soc)
 
 		DP_RX_REO_QDESC_DEFERRED_FREE_EVT(desc);
 
-		qdf_mem_unmap_nbytes_single(soc->osdev,
-					    desc->hw_qdesc_paddr,
-					    QDF_DMA_BIDIRECTIONAL,
-					    desc->hw_qdesc_alloc_size);
-		qdf_mem_free(desc->hw_qdesc_vaddr_unaligned);
+		dp_reo_qdesc_release(soc, desc->hw_qdesc_vaddr_unaligned,
+				     desc->hw_qdesc_paddr,
+				     desc->hw_qdesc_alloc_size);
 		qdf_mem_free(desc);
 
 		curr_ts = qdf_get_system_timestamp();
@@ -549,14 +824,12 @@ static void dp_reo_desc_free(struct dp_soc *soc, void *cb_ctxt,
 	add_entry_free_list(soc, rx_tid);
 
 	hal_reo_shared_qaddr_cache_clear(soc->hal_soc);
-	qdf_mem_unmap_nbytes_single(soc->osdev,
-				    rx_tid->hw_qdesc_paddr,
-				    QDF_DMA_BIDIRECTIONAL,
-				    rx_tid->hw_qdesc_alloc_size);
 	check_free_list_for_invalid_flush(soc);
 
 	*(uint32_t *)rx_tid->hw_qdesc_vaddr_unaligned = 0;
-	qdf_mem_free(rx_tid->hw_qdesc_vaddr_unaligned);
+	dp_reo_qdesc_release(soc, rx_tid->hw_qdesc_vaddr_unaligned,
+			     rx_tid->hw_qdesc_paddr,
+			     rx_tid->hw_qdesc_alloc_size);
 out:
 	qdf_mem_free(freedesc);
 }
@@ -594,12 +867,12 @@ dp_rx_tid_setup_error_process(uint32_t tid_bitmap, struct dp_peer *peer)
 
 		if (dp_reo_desc_addr_chk(rx_tid->hw_qdesc_paddr) ==
 		    QDF_STATUS_SUCCESS)
-			qdf_mem_unmap_nbytes_single(
-				soc->osdev,
-				rx_tid->hw_qdesc_paddr,
-				QDF_DMA_BIDIRECTIONAL,
-				rx_tid->hw_qdesc_alloc_size);
-		qdf_mem_free(rx_tid->hw_qdesc_vaddr_unaligned);
+			dp_reo_qdesc_release(soc,
+					     rx_tid->hw_qdesc_vaddr_unaligned,
+					     rx_tid->hw_qdesc_paddr,
+					     rx_tid->hw_qdesc_alloc_size);
+		else
+			qdf_mem_free(rx_tid->hw_qdesc_vaddr_unaligned);
 		rx_tid->hw_qdesc_vaddr_unaligned = NULL;
 		rx_tid->hw_qdesc_paddr = 0;
 	}
@@ -619,6 +892,7 @@ dp_single_rx_tid_setup(struct dp_peer *peer, int tid,
 	uint32_t alloc_tries = 0, ret;
 	QDF_STATUS status = QDF_STATUS_SUCCESS;
 	struct dp_txrx_peer *txrx_peer;
+	bool pooled;
 
 	rx_tid->delba_tx_status = 0;
 	rx_tid->ppdu_id_2k = 0;
@@ -648,6 +922,17 @@ dp_single_rx_tid_setup(struct dp_peer *peer, int tid,
 	 */
 	rx_tid->hw_qdesc_alloc_size = hw_qdesc_size;
 
+	/* A pooled descriptor is already aligned and DMA mapped */
+	pooled = dp_reo_qdesc_pool_get(soc, rx_tid->hw_qdesc_alloc_size,
+				       &rx_tid->hw_qdesc_vaddr_unaligned,
+				       &rx_tid->hw_qdesc_paddr);
+	if (pooled) {
+		hw_qdesc_vaddr = (void *)qdf_align((unsigned long)
+			rx_tid->hw_qdesc_vaddr_unaligned,
+			hw_qdesc_align);
+		goto desc_ready;
+	}
+
 try_desc_alloc:
 	rx_tid->hw_qdesc_vaddr_unaligned =
 		qdf_mem_malloc(rx_tid->hw_qdesc_alloc_size);
@@ -685,6 +970,8 @@ try_desc_alloc:
 	} else {
 		hw_qdesc_vaddr = rx_tid->hw_qdesc_vaddr_unaligned;
 	}
+
+desc_ready:
 	rx_tid->hw_qdesc_vaddr_aligned = hw_qdesc_vaddr;
 
 	txrx_peer = dp_get_txrx_peer(peer);
@@ -716,6 +1003,15 @@ try_desc_alloc:
 		hw_qdesc_vaddr, rx_tid->hw_qdesc_paddr, hal_pn_type,
 		vdev->vdev_stats_id);
 
+	if (pooled) {
+		qdf_mem_dma_sync_single_for_device(soc->osdev,
+						   rx_tid->hw_qdesc_paddr,
+						   rx_tid->hw_qdesc_alloc_size,
+						   QDF_DMA_BIDIRECTIONAL);
+		add_entry_alloc_list(soc, rx_tid, peer, hw_qdesc_vaddr);
+		return QDF_STATUS_SUCCESS;
+	}
+
 	ret = qdf_mem_map_nbytes_single(soc->osdev, hw_qdesc_vaddr,
 					QDF_DMA_BIDIRECTIONAL,
 					rx_tid->hw_qdesc_alloc_size,
@@ -1118,6 +1414,7 @@ void dp_rx_tid_delete_cb(struct dp_soc *soc, void *cb_ctxt,
 	qdf_spin_unlock_bh(&soc->reo_desc_freelist_lock);
 
 	dp_reo_desc_defer_free(soc);
+	dp_reo_qdesc_pool_trim(soc);
 }
 
 /**
@@ -384,4 +384,68 @@ dp_rx_tid_setup_wifi3(struct dp_peer *peer, int tid,
 	return QDF_STATUS_SUCCESS;
 }
 #endif
+
+#if defined(WLAN_DP_REO_QDESC_POOL) && !defined(WLAN_SOFTUMAC_SUPPORT)
+/**
+ * dp_reo_qdesc_pool_create() - Initialize the REO queue descriptor pool
+ * @soc: Datapath soc handle
+ *
+ * Return: None
+ */
+void dp_reo_qdesc_pool_create(struct dp_soc *soc);
+
+/**
+ * dp_reo_qdesc_pool_destroy() - Unmap and free all pooled REO queue
+ *				 descriptors
+ * @soc: Datapath soc handle
+ *
+ * Return: None
+ */
+void dp_reo_qdesc_pool_destroy(struct dp_soc *soc);
+
+#ifdef WLAN_DP_REO_QDESC_POOL_TEST
+/**
+ * dp_reo_qdesc_pool_test_get() - Take a REO queue descriptor from the pool
+ *				  as rx TID setup does
+ * @soc: Datapath soc handle
+ * @alloc_size: REO queue descriptor size
+ * @vaddr_unaligned: filled with the allocator address of the descriptor
+ * @paddr: filled with the DMA address of the aligned descriptor
+ *
+ * Return: true if a pooled descriptor was returned, false otherwise
+ */
+bool dp_reo_qdesc_pool_test_get(struct dp_soc *soc, uint32_t alloc_size,
+				void **vaddr_unaligned, qdf_dma_addr_t *paddr);
+
+/**
+ * dp_reo_qdesc_pool_test_release() - Release a REO queue descriptor as
+ *				      the REO flush completion does
+ * @soc: Datapath soc handle
+ * @vaddr_unaligned: allocator address of the descriptor
+ * @paddr: DMA address of the aligned descriptor
+ * @alloc_size: REO queue descriptor size
+ *
+ * Return: None
+ */
+void dp_reo_qdesc_pool_test_release(struct dp_soc *soc,
+				    void *vaddr_unaligned,
+				    qdf_dma_addr_t paddr, uint32_t alloc_size);
+
+/**
+ * dp_reo_qdesc_pool_test_trim() - Trim the pool as rx TID deletion does
+ * @soc: Datapath soc handle
+ *
+ * Return: None
+ */
+void dp_reo_qdesc_pool_test_trim(struct dp_soc *soc);
+#endif /* WLAN_DP_REO_QDESC_POOL_TEST */
+#else
+static inline void dp_reo_qdesc_pool_create(struct dp_soc *soc)
+{
+}
+
+static inline void dp_reo_qdesc_pool_destroy(struct dp_soc *soc)
+{
+}
+#endif
 #endif /* _DP_RX_TID_H_ */
@@ -6239,6 +6239,7 @@ void dp_print_soc_tx_stats(struct dp_soc *soc)
 	uint8_t desc_pool_id;
 	struct dp_tx_desc_pool_s *tx_desc_pool;
 
+	DP_STATS_PCPU_FOLD(soc);
 	soc->stats.tx.desc_in_use = 0;
 
 	DP_PRINT_STATS("SOC Tx Stats:\n");
@@ -6442,6 +6443,7 @@ void dp_print_soc_tx_stats(struct dp_soc *soc)
 {
 	uint8_t desc_pool_id;
 
+	DP_STATS_PCPU_FOLD(soc);
 	soc->stats.tx.desc_in_use = 0;
 
 	DP_PRINT_STATS("SOC Tx Stats:\n");
@@ -6881,6 +6883,18 @@ static void dp_print_hist_stats(struct cdp_hist_stats *hstats,
 		DP_PRINT_STATS("Min = %u", hstats->min);
 		DP_PRINT_STATS("Max = %u", hstats->max);
 		DP_PRINT_STATS("Avg = %u\n", hstats->avg);
+#ifdef DP_HIST_LOG_LINEAR
+		if (hstats->ll)
+			DP_PRINT_STATS("P50 = %u P90 = %u P99 = %u P99.9 = %u\n",
+				       dp_hist_get_percentile(hstats,
+							      DP_HIST_P50),
+				       dp_hist_get_percentile(hstats,
+							      DP_HIST_P90),
+				       dp_hist_get_percentile(hstats,
+							      DP_HIST_P99),
+				       dp_hist_get_percentile(hstats,
+							      DP_HIST_P999));
+#endif
 	}
 }
 
@@ -6932,6 +6946,24 @@ static void dp_accumulate_delay_avg_stats(struct cdp_delay_tid_stats stats[]
 }
 #endif
 
+#ifdef DP_HIST_LOG_LINEAR
+/*
+ * The merged histograms printed per TID live on the stack, their
+ * log-linear buckets are too big for that and come from the heap.
+ */
+static inline
+struct cdp_hist_log_linear *dp_peer_delay_ll_scratch_alloc(void)
+{
+	return qdf_mem_malloc(sizeof(struct cdp_hist_log_linear));
+}
+#else
+static inline
+struct cdp_hist_log_linear *dp_peer_delay_ll_scratch_alloc(void)
+{
+	return NULL;
+}
+#endif
+
 /**
  * dp_accumulate_delay_tid_stats(): Accumulate the tid stats to the
  *                                  hist stats.
@@ -7013,6 +7045,7 @@ static void dp_peer_print_tx_delay_stats(struct dp_pdev *pdev,
 	struct dp_peer_delay_stats *delay_stats;
 	struct dp_soc *soc = NULL;
 	struct cdp_hist_stats hist_stats;
+	struct cdp_hist_log_linear *ll;
 	uint8_t tid;
 
 	if (!peer || !peer->txrx_peer)
@@ -7029,10 +7062,13 @@ static void dp_peer_print_tx_delay_stats(struct dp_pdev *pdev,
 	if (!delay_stats)
 		return;
 
+	ll = dp_peer_delay_ll_scratch_alloc();
+
 	for (tid = 0; tid < CDP_MAX_DATA_TIDS; tid++) {
 		DP_PRINT_STATS("----TID: %d----", tid);
 		DP_PRINT_STATS("Software Enqueue Delay:");
 		dp_hist_init(&hist_stats, CDP_HIST_TYPE_SW_ENQEUE_DELAY);
+		dp_hist_ll_attach(&hist_stats, ll);
 		dp_accumulate_delay_tid_stats(soc, delay_stats->delay_tid_stats,
 					      &hist_stats, tid,
 					      CDP_HIST_TYPE_SW_ENQEUE_DELAY);
@@ -7040,11 +7076,14 @@ static void dp_peer_print_tx_delay_stats(struct dp_pdev *pdev,
 
 		DP_PRINT_STATS("Hardware Transmission Delay:");
 		dp_hist_init(&hist_stats, CDP_HIST_TYPE_HW_COMP_DELAY);
+		dp_hist_ll_attach(&hist_stats, ll);
 		dp_accumulate_delay_tid_stats(soc, delay_stats->delay_tid_stats,
 					      &hist_stats, tid,
 					      CDP_HIST_TYPE_HW_COMP_DELAY);
 		dp_print_hist_stats(&hist_stats, CDP_HIST_TYPE_HW_COMP_DELAY);
 	}
+
+	qdf_mem_free(ll);
 }
 
 /**
@@ -7060,6 +7099,7 @@ static void dp_peer_print_rx_delay_stats(struct dp_pdev *pdev,
 	struct dp_peer_delay_stats *delay_stats;
 	struct dp_soc *soc = NULL;
 	struct cdp_hist_stats hist_stats;
+	struct cdp_hist_log_linear *ll;
 	uint8_t tid;
 
 	if (!peer || !peer->txrx_peer)
@@ -7076,15 +7116,20 @@ static void dp_peer_print_rx_delay_stats(struct dp_pdev *pdev,
 	if (!delay_stats)
 		return;
 
+	ll = dp_peer_delay_ll_scratch_alloc();
+
 	for (tid = 0; tid < CDP_MAX_DATA_TIDS; tid++) {
 		DP_PRINT_STATS("----TID: %d----", tid);
 		DP_PRINT_STATS("Rx Reap2stack Deliver Delay:");
 		dp_hist_init(&hist_stats, CDP_HIST_TYPE_REAP_STACK);
+		dp_hist_ll_attach(&hist_stats, ll);
 		dp_accumulate_delay_tid_stats(soc, delay_stats->delay_tid_stats,
 					      &hist_stats, tid,
 					      CDP_HIST_TYPE_REAP_STACK);
 		dp_print_hist_stats(&hist_stats, CDP_HIST_TYPE_REAP_STACK);
 	}
+
+	qdf_mem_free(ll);
 }
 
 #else
@@ -7761,6 +7806,8 @@ void dp_txrx_path_stats(struct dp_soc *soc)
 		return;
 	}
 
+	DP_STATS_PCPU_FOLD(soc);
+
 	for (loop_pdev = 0; loop_pdev < soc->pdev_count; loop_pdev++) {
 		pdev = soc->pdev_list[loop_pdev];
 		dp_aggregate_pdev_stats(pdev);
@@ -8412,6 +8459,8 @@ dp_print_soc_rx_stats(struct dp_soc *soc)
 	char rxdma_error[DP_RXDMA_ERR_LENGTH];
 	uint8_t index = 0;
 
+	DP_STATS_PCPU_FOLD(soc);
+
 	DP_PRINT_STATS("No of AST Entries = %d", soc->num_ast_entries);
 	DP_PRINT_STATS("SOC Rx Stats:\n");
 	DP_PRINT_STATS("Fast recycled packets: %llu",
@@ -8528,6 +8577,14 @@ dp_print_soc_rx_stats(struct dp_soc *soc)
 	DP_PRINT_STATS("REO Error(0-14):%s", reo_error);
 	DP_PRINT_STATS("REO CMD SEND FAIL: %d",
 		       soc->stats.rx.err.reo_cmd_send_fail);
+#ifdef WLAN_DP_REO_QDESC_POOL
+	DP_PRINT_STATS("REO qdesc pool hit: %u miss: %u cached: %u freed: %u trimmed: %u",
+		       soc->reo_qdesc_pool.alloc_hit,
+		       soc->reo_qdesc_pool.alloc_miss,
+		       soc->reo_qdesc_pool.release_cached,
+		       soc->reo_qdesc_pool.release_freed,
+		       soc->reo_qdesc_pool.trimmed);
+#endif
 
 	DP_PRINT_STATS("Rx BAR frames:%d", soc->stats.rx.bar_frame);
 	DP_PRINT_STATS("Rxdma2rel route drop:%d",
@@ -8927,6 +8984,129 @@ bool dp_peer_get_hw_txrx_stats_en(struct dp_txrx_peer *txrx_peer)
 }
 #endif
 
+#ifdef WLAN_DP_PERCPU_STATS
+void dp_stats_pcpu_attach(struct dp_stats_pcpu **pcs, uint32_t base,
+			  uint32_t len, uint32_t stride, uint32_t count)
+{
+	struct dp_stats_pcpu *stats_pcpu;
+	uint32_t size = len * count;
+
+	*pcs = NULL;
+
+	/* header, folded sums and then the width map */
+	stats_pcpu = qdf_mem_malloc(sizeof(*stats_pcpu) + 2 * size);
+	if (!stats_pcpu) {
+		dp_stats_err("per-CPU stats alloc failed, size %u", size);
+		return;
+	}
+
+	stats_pcpu->slots = qdf_percpu_alloc(size);
+	if (!stats_pcpu->slots) {
+		dp_stats_err("per-CPU stats area alloc failed, size %u", size);
+		qdf_mem_free(stats_pcpu);
+		return;
+	}
+
+	stats_pcpu->base = base;
+	stats_pcpu->len = len;
+	stats_pcpu->stride = stride;
+	stats_pcpu->count = count;
+	stats_pcpu->size = size;
+	stats_pcpu->folded = (uint8_t *)(stats_pcpu + 1);
+	stats_pcpu->width = stats_pcpu->folded + size;
+	qdf_spinlock_create(&stats_pcpu->lock);
+
+	*pcs = stats_pcpu;
+}
+
+void dp_stats_pcpu_detach(struct dp_stats_pcpu **pcs)
+{
+	if (!*pcs)
+		return;
+
+	qdf_spinlock_destroy(&(*pcs)->lock);
+	qdf_percpu_free((*pcs)->slots);
+	qdf_mem_free(*pcs);
+	*pcs = NULL;
+}
+
+/*
+ * Sum the per-CPU copies of the counter at _off of the slots and, if _stats
+ * is given, add what was counted since the previous fold to its counter at
+ * _stats_off. The per-CPU copies only ever grow (modulo the counter width),
+ * so the owning CPUs never have to be stopped or reset.
+ */
+#define DP_STATS_PCPU_FOLD_CTR(_type, _pcs, _stats, _off, _stats_off) \
+do { \
+	_type __sum = 0; \
+	int __cpu; \
+	\
+	qdf_for_each_possible_cpu(__cpu) \
+		__sum += *(_type *)((uint8_t *) \
+			qdf_percpu_ptr((_pcs)->slots, __cpu) + (_off)); \
+	if (_stats) \
+		*(_type *)((uint8_t *)(_stats) + (_stats_off)) += \
+			(_type)(__sum - *(_type *)&(_pcs)->folded[_off]); \
+	*(_type *)&(_pcs)->folded[_off] = __sum; \
+} while (0)
+
+/**
+ * dp_stats_pcpu_sync() - bring the folded sums up to date
+ * @pcs: per-CPU backend
+ * @stats: stats structure to add the new increments to, NULL to drop them
+ *
+ * Return: None
+ */
+static void dp_stats_pcpu_sync(struct dp_stats_pcpu *pcs, void *stats)
+{
+	uint32_t off = 0, stats_off;
+	uint8_t width;
+
+	qdf_spin_lock_bh(&pcs->lock);
+	while (off < pcs->size) {
+		width = pcs->width[off];
+		/* slots hold the window of each element back to back */
+		stats_off = ((off / pcs->len) * pcs->stride) + pcs->base +
+			    (off % pcs->len);
+		switch (width) {
+		case sizeof(uint64_t):
+			DP_STATS_PCPU_FOLD_CTR(uint64_t, pcs, stats, off,
+					       stats_off);
+			break;
+		case sizeof(uint32_t):
+			DP_STATS_PCPU_FOLD_CTR(uint32_t, pcs, stats, off,
+					       stats_off);
+			break;
+		case sizeof(uint16_t):
+			DP_STATS_PCPU_FOLD_CTR(uint16_t, pcs, stats, off,
+					       stats_off);
+			break;
+		case sizeof(uint8_t):
+			DP_STATS_PCPU_FOLD_CTR(uint8_t, pcs, stats, off,
+					       stats_off);
+			break;
+		default:
+			width = 1;
+			break;
+		}
+		off += width;
+	}
+	qdf_spin_unlock_bh(&pcs->lock);
+}
+
+void dp_stats_pcpu_fold(struct dp_stats_pcpu *pcs, void *stats)
+{
+	if (pcs)
+		dp_stats_pcpu_sync(pcs, stats);
+}
+
+void dp_stats_pcpu_reset(struct dp_stats_pcpu *pcs)
+{
+	if (pcs)
+		dp_stats_pcpu_sync(pcs, NULL);
+}
+#endif /* WLAN_DP_PERCPU_STATS */
+
 #ifdef WLAN_FEATURE_11BE_MLO
 static inline struct dp_peer *dp_get_stats_peer(struct dp_peer *peer)
 {
@@ -8987,6 +9167,8 @@ void dp_update_vdev_stats(struct dp_soc *soc, struct dp_peer *srcobj,
 	if (qdf_unlikely(!txrx_peer))
 		goto link_stats;
 
+	DP_STATS_PCPU_FOLD(txrx_peer);
+
 	if (dp_peer_is_primary_link_peer(srcobj)) {
 		dp_update_vdev_basic_stats(txrx_peer, vdev_stats);
 		per_pkt_stats = &txrx_peer->stats[0].per_pkt_stats;
@@ -9032,6 +9214,8 @@ void dp_update_vdev_stats_on_peer_unmap(struct dp_vdev *vdev,
 {
 	struct dp_soc *soc = vdev->pdev->soc;
 
+	DP_STATS_PCPU_FOLD(dp_get_txrx_peer(peer));
+
 	if (soc->arch_ops.dp_get_vdev_stats_for_unmap_peer)
 		soc->arch_ops.dp_get_vdev_stats_for_unmap_peer(vdev, peer);
 }
@@ -9056,6 +9240,8 @@ void dp_update_vdev_stats(struct dp_soc *soc, struct dp_peer *srcobj,
 	if (!dp_peer_is_primary_link_peer(srcobj))
 		return;
 
+	DP_STATS_PCPU_FOLD(txrx_peer);
+
 	stats_arr_size = txrx_peer->stats_arr_size;
 	dp_update_vdev_basic_stats(txrx_peer, vdev_stats);
 
@@ -9081,6 +9267,8 @@ void dp_update_vdev_stats_on_peer_unmap(struct dp_vdev *vdev,
 	if (!txrx_peer)
 		return;
 
+	DP_STATS_PCPU_FOLD(txrx_peer);
+
 	stats_arr_size = txrx_peer->stats_arr_size;
 	dp_update_vdev_be_basic_stats(txrx_peer, vdev_stats);
 
@@ -9528,6 +9716,8 @@ QDF_STATUS dp_txrx_get_soc_stats(struct cdp_soc_t *soc_hdl,
 	uint8_t inx;
 	uint8_t cpus;
 
+	DP_STATS_PCPU_FOLD(soc);
+
 	/* soc tx stats */
 	soc_stats->tx.egress = soc->stats.tx.egress[0];
 	soc_stats->tx.tx_invalid_peer = soc->stats.tx.tx_invalid_peer;
@@ -9707,10 +9897,14 @@ dp_txrx_get_peer_delay_stats(struct cdp_soc_t *soc_hdl, uint8_t vdev_id,
 
 	for (tid = 0; tid < CDP_MAX_DATA_TIDS; tid++) {
 		rx_delay = &delay_stats[tid].rx_delay;
+		tx_delay = &delay_stats[tid].tx_delay;
+		/* percentile buckets are not exported through cdp */
+		dp_hist_ll_attach(&rx_delay->to_stack_delay, NULL);
+		dp_hist_ll_attach(&tx_delay->tx_swq_delay, NULL);
+		dp_hist_ll_attach(&tx_delay->hwtx_delay, NULL);
 		dp_accumulate_delay_tid_stats(soc, pext_stats->delay_tid_stats,
 					      &rx_delay->to_stack_delay, tid,
 					      CDP_HIST_TYPE_REAP_STACK);
-		tx_delay = &delay_stats[tid].tx_delay;
 		dp_accumulate_delay_avg_stats(pext_stats->delay_tid_stats,
 					      tx_delay,
 					      tid);
@@ -539,6 +539,335 @@ dp_tx_desc_free_list(struct dp_tx_desc_pool_s *pool,
 {
 }
 
+#ifdef WLAN_DP_TX_DESC_PCPU_CACHE
+#ifdef QCA_AC_BASED_FLOW_CONTROL
+#define DP_TX_POOL_MAX_STOP_TH(_pool) ((_pool)->stop_th[DP_TH_BE_BK])
+#else
+#define DP_TX_POOL_MAX_STOP_TH(_pool) ((_pool)->stop_th)
+#endif
+
+/**
+ * dp_tx_desc_cache_release() - give cached descriptors back to flow pool
+ * @soc: Handle to DP SoC structure
+ * @head: chain of free descriptors taken out of a per-CPU cache
+ * @desc_pool_id: ID of the flow pool
+ *
+ * Descriptors are returned one at a time through dp_tx_desc_free(), so
+ * that every unpause transition of the pool is evaluated as usual.
+ *
+ * Return: None
+ */
+void dp_tx_desc_cache_release(struct dp_soc *soc, struct dp_tx_desc_s *head,
+			      uint8_t desc_pool_id);
+
+/**
+ * dp_tx_desc_cache_flush() - empty the per-CPU caches of a flow pool
+ * @soc: Handle to DP SoC structure
+ * @pool: flow pool
+ * @disable: stop parking descriptors of @pool in its caches
+ *
+ * Return: None
+ */
+void dp_tx_desc_cache_flush(struct dp_soc *soc, struct dp_tx_desc_pool_s *pool,
+			    bool disable);
+
+/**
+ * dp_tx_desc_cache_attach() - create the per-CPU caches of a flow pool
+ * @pool: flow pool
+ *
+ * If the per-CPU area cannot be allocated the pool simply runs without
+ * caches.
+ *
+ * Return: None
+ */
+static inline void dp_tx_desc_cache_attach(struct dp_tx_desc_pool_s *pool)
+{
+	struct dp_tx_desc_cache *cache;
+	int cpu;
+
+	pool->cache_enabled = false;
+	pool->cache = qdf_percpu_alloc(sizeof(*cache));
+	if (!pool->cache) {
+		dp_info("no per-CPU tx desc caches for pool %d",
+			pool->flow_pool_id);
+		return;
+	}
+
+	qdf_for_each_possible_cpu(cpu) {
+		cache = qdf_percpu_ptr(pool->cache, cpu);
+		qdf_spinlock_create(&cache->lock);
+	}
+}
+
+/**
+ * dp_tx_desc_cache_detach() - destroy the per-CPU caches of a flow pool
+ * @pool: flow pool
+ *
+ * Return: None
+ */
+static inline void dp_tx_desc_cache_detach(struct dp_tx_desc_pool_s *pool)
+{
+	struct dp_tx_desc_cache *cache;
+	int cpu;
+
+	if (!pool->cache)
+		return;
+
+	pool->cache_enabled = false;
+	qdf_for_each_possible_cpu(cpu) {
+		cache = qdf_percpu_ptr(pool->cache, cpu);
+		qdf_spinlock_destroy(&cache->lock);
+	}
+	qdf_percpu_free(pool->cache);
+	pool->cache = NULL;
+}
+
+/**
+ * dp_tx_desc_cache_enable() - allow descriptors of a flow pool to be cached
+ * @pool: flow pool
+ *
+ * Return: None
+ */
+static inline void dp_tx_desc_cache_enable(struct dp_tx_desc_pool_s *pool)
+{
+	pool->cache_enabled = !!pool->cache;
+}
+
+/**
+ * dp_tx_desc_cache_reset() - forget the descriptors held by the caches
+ * @pool: flow pool
+ *
+ * Only for teardown, when the pool memory is released regardless of the
+ * descriptors still outstanding.
+ *
+ * Return: None
+ */
+static inline void dp_tx_desc_cache_reset(struct dp_tx_desc_pool_s *pool)
+{
+	struct dp_tx_desc_cache *cache;
+	int cpu;
+
+	pool->cache_enabled = false;
+	if (!pool->cache)
+		return;
+
+	qdf_for_each_possible_cpu(cpu) {
+		cache = qdf_percpu_ptr(pool->cache, cpu);
+		cache->freelist = NULL;
+		cache->count = 0;
+	}
+}
+
+/**
+ * dp_tx_desc_cache_refill_allowed() - check if a batch can leave the pool
+ * @pool: flow pool
+ *
+ * Caller needs to take flow_pool_lock. A batch is handed out only while
+ * the pool stays above its highest stop threshold afterwards, so every
+ * threshold crossing still happens one descriptor at a time on the locked
+ * path.
+ *
+ * Return: true if a batch can be moved to a per-CPU cache
+ */
+static inline bool
+dp_tx_desc_cache_refill_allowed(struct dp_tx_desc_pool_s *pool)
+{
+	return pool->status == FLOW_POOL_ACTIVE_UNPAUSED &&
+	       pool->avail_desc > DP_TX_POOL_MAX_STOP_TH(pool) +
+				  DP_TX_DESC_CACHE_BATCH;
+}
+
+/**
+ * dp_tx_desc_cache_alloc() - allocate a tx descriptor from the cache of
+ *			      the current CPU
+ * @soc: Handle to DP SoC structure
+ * @pool: flow pool
+ * @desc_pool_id: ID of the flow pool
+ *
+ * An empty cache is refilled with a batch from the pool. Once the pool
+ * leaves FLOW_POOL_ACTIVE_UNPAUSED the cache is given back to the pool
+ * and the caller falls back to the locked per-descriptor path.
+ *
+ * Return: tx descriptor, or NULL to allocate from the pool directly
+ */
+static inline struct dp_tx_desc_s *
+dp_tx_desc_cache_alloc(struct dp_soc *soc, struct dp_tx_desc_pool_s *pool,
+		       uint8_t desc_pool_id)
+{
+	struct dp_tx_desc_cache *cache;
+	struct dp_tx_desc_s *tx_desc = NULL;
+	struct dp_tx_desc_s *stale = NULL;
+	struct dp_tx_desc_s *tail;
+	uint16_t i;
+
+	if (qdf_unlikely(!pool->cache))
+		return NULL;
+
+	cache = qdf_raw_cpu_ptr(pool->cache);
+	qdf_spin_lock_bh(&cache->lock);
+	if (qdf_unlikely(!pool->cache_enabled))
+		goto unlock;
+
+	if (qdf_unlikely(pool->status != FLOW_POOL_ACTIVE_UNPAUSED)) {
+		stale = cache->freelist;
+		cache->freelist = NULL;
+		cache->count = 0;
+		goto unlock;
+	}
+
+	if (!cache->count) {
+		qdf_spin_lock_bh(&pool->flow_pool_lock);
+		if (!dp_tx_desc_cache_refill_allowed(pool)) {
+			qdf_spin_unlock_bh(&pool->flow_pool_lock);
+			goto unlock;
+		}
+
+		tail = pool->freelist;
+		for (i = 1; i < DP_TX_DESC_CACHE_BATCH; i++)
+			tail = tail->next;
+		cache->freelist = pool->freelist;
+		pool->freelist = tail->next;
+		pool->avail_desc -= DP_TX_DESC_CACHE_BATCH;
+		qdf_spin_unlock_bh(&pool->flow_pool_lock);
+
+		tail->next = NULL;
+		cache->count = DP_TX_DESC_CACHE_BATCH;
+	}
+
+	tx_desc = cache->freelist;
+	cache->freelist = tx_desc->next;
+	cache->count--;
+	tx_desc->pool_id = desc_pool_id;
+	tx_desc->flags = DP_TX_DESC_FLAG_ALLOCATED;
+	dp_tx_desc_set_magic(tx_desc, DP_TX_MAGIC_PATTERN_INUSE);
+
+unlock:
+	qdf_spin_unlock_bh(&cache->lock);
+
+	if (qdf_unlikely(stale))
+		dp_tx_desc_cache_release(soc, stale, desc_pool_id);
+
+	return tx_desc;
+}
+
+/**
+ * dp_tx_desc_cache_free() - free a tx descriptor to the cache of the
+ *			     current CPU
+ * @soc: Handle to DP SoC structure
+ * @pool: flow pool
+ * @tx_desc: the tx descriptor to be freed
+ * @desc_pool_id: ID of the flow pool
+ *
+ * A cache growing beyond DP_TX_DESC_CACHE_SIZE gives a batch back to the
+ * pool under a single flow_pool_lock. Once the pool leaves
+ * FLOW_POOL_ACTIVE_UNPAUSED nothing is cached anymore, so that the unpause
+ * thresholds see every free.
+ *
+ * Return: true if @tx_desc was taken by the cache, false if the caller
+ *	   has to give it back to the pool directly
+ */
+static inline bool
+dp_tx_desc_cache_free(struct dp_soc *soc, struct dp_tx_desc_pool_s *pool,
+		      struct dp_tx_desc_s *tx_desc, uint8_t desc_pool_id)
+{
+	struct dp_tx_desc_cache *cache;
+	struct dp_tx_desc_s *stale = NULL;
+	struct dp_tx_desc_s *head = NULL;
+	struct dp_tx_desc_s *tail;
+	bool cached = false;
+	uint16_t i;
+
+	if (qdf_unlikely(!pool->cache))
+		return false;
+
+	cache = qdf_raw_cpu_ptr(pool->cache);
+	qdf_spin_lock_bh(&cache->lock);
+	if (qdf_unlikely(!pool->cache_enabled))
+		goto unlock;
+
+	if (qdf_unlikely(pool->status != FLOW_POOL_ACTIVE_UNPAUSED)) {
+		stale = cache->freelist;
+		cache->freelist = NULL;
+		cache->count = 0;
+		goto unlock;
+	}
+
+	tx_desc->vdev_id = DP_INVALID_VDEV_ID;
+	tx_desc->nbuf = NULL;
+	tx_desc->flags = 0;
+	dp_tx_desc_set_magic(tx_desc, DP_TX_MAGIC_PATTERN_FREE);
+	tx_desc->next = cache->freelist;
+	cache->freelist = tx_desc;
+	cached = true;
+
+	if (++cache->count <= DP_TX_DESC_CACHE_SIZE)
+		goto unlock;
+
+	head = cache->freelist;
+	tail = head;
+	for (i = 1; i < DP_TX_DESC_CACHE_BATCH; i++)
+		tail = tail->next;
+	cache->freelist = tail->next;
+	cache->count -= DP_TX_DESC_CACHE_BATCH;
+	tail->next = NULL;
+
+	qdf_spin_lock_bh(&pool->flow_pool_lock);
+	if (qdf_likely(pool->status == FLOW_POOL_ACTIVE_UNPAUSED)) {
+		tail->next = pool->freelist;
+		pool->freelist = head;
+		pool->avail_desc += DP_TX_DESC_CACHE_BATCH;
+		head = NULL;
+	}
+	qdf_spin_unlock_bh(&pool->flow_pool_lock);
+
+unlock:
+	qdf_spin_unlock_bh(&cache->lock);
+
+	if (qdf_unlikely(stale))
+		dp_tx_desc_cache_release(soc, stale, desc_pool_id);
+	if (qdf_unlikely(head))
+		dp_tx_desc_cache_release(soc, head, desc_pool_id);
+
+	return cached;
+}
+#else
+static inline void
+dp_tx_desc_cache_flush(struct dp_soc *soc, struct dp_tx_desc_pool_s *pool,
+		       bool disable)
+{
+}
+
+static inline void dp_tx_desc_cache_attach(struct dp_tx_desc_pool_s *pool)
+{
+}
+
+static inline void dp_tx_desc_cache_detach(struct dp_tx_desc_pool_s *pool)
+{
+}
+
+static inline void dp_tx_desc_cache_enable(struct dp_tx_desc_pool_s *pool)
+{
+}
+
+static inline void dp_tx_desc_cache_reset(struct dp_tx_desc_pool_s *pool)
+{
+}
+
+static inline struct dp_tx_desc_s *
+dp_tx_desc_cache_alloc(struct dp_soc *soc, struct dp_tx_desc_pool_s *pool,
+		       uint8_t desc_pool_id)
+{
+	return NULL;
+}
+
+static inline bool
+dp_tx_desc_cache_free(struct dp_soc *soc, struct dp_tx_desc_pool_s *pool,
+		      struct dp_tx_desc_s *tx_desc, uint8_t desc_pool_id)
+{
+	return false;
+}
+#endif /* WLAN_DP_TX_DESC_PCPU_CACHE */
+
 #ifdef QCA_AC_BASED_FLOW_CONTROL
 
 /**
@@ -652,6 +981,10 @@ dp_tx_desc_alloc(struct dp_soc *soc, uint8_t desc_pool_id)
 	enum dp_fl_ctrl_threshold level = DP_TH_BE_BK;
 	enum netif_reason_type reason;
 
+	tx_desc = dp_tx_desc_cache_alloc(soc, pool, desc_pool_id);
+	if (qdf_likely(tx_desc))
+		return tx_desc;
+
 	if (qdf_likely(pool)) {
 		qdf_spin_lock_bh(&pool->flow_pool_lock);
 		if (qdf_likely(pool->avail_desc &&
@@ -743,10 +1076,14 @@ dp_tx_desc_free(struct dp_soc *soc, struct dp_tx_desc_s *tx_desc,
 		uint8_t desc_pool_id)
 {
 	struct dp_tx_desc_pool_s *pool = &soc->tx_desc[desc_pool_id];
-	qdf_time_t unpause_time = qdf_get_system_timestamp(), pause_dur;
+	qdf_time_t unpause_time, pause_dur;
 	enum netif_action_type act = WLAN_WAKE_ALL_NETIF_QUEUE;
 	enum netif_reason_type reason;
 
+	if (qdf_likely(dp_tx_desc_cache_free(soc, pool, tx_desc, desc_pool_id)))
+		return;
+
+	unpause_time = qdf_get_system_timestamp();
 	qdf_spin_lock_bh(&pool->flow_pool_lock);
 	tx_desc->vdev_id = DP_INVALID_VDEV_ID;
 	tx_desc->nbuf = NULL;
@@ -868,6 +1205,10 @@ dp_tx_desc_alloc(struct dp_soc *soc, uint8_t desc_pool_id)
 	struct dp_tx_desc_s *tx_desc = NULL;
 	struct dp_tx_desc_pool_s *pool = &soc->tx_desc[desc_pool_id];
 
+	tx_desc = dp_tx_desc_cache_alloc(soc, pool, desc_pool_id);
+	if (qdf_likely(tx_desc))
+		return tx_desc;
+
 	if (pool) {
 		qdf_spin_lock_bh(&pool->flow_pool_lock);
 		if (pool->status <= FLOW_POOL_ACTIVE_PAUSED &&
@@ -917,6 +1258,9 @@ dp_tx_desc_free(struct dp_soc *soc, struct dp_tx_desc_s *tx_desc,
 {
 	struct dp_tx_desc_pool_s *pool = &soc->tx_desc[desc_pool_id];
 
+	if (qdf_likely(dp_tx_desc_cache_free(soc, pool, tx_desc, desc_pool_id)))
+		return;
+
 	qdf_spin_lock_bh(&pool->flow_pool_lock);
 	tx_desc->vdev_id = DP_INVALID_VDEV_ID;
 	tx_desc->nbuf = NULL;
@@ -312,6 +312,49 @@ void dp_tx_clear_flow_pool_stats(struct dp_soc *soc)
 	qdf_mem_zero(&soc->pool_stats, sizeof(soc->pool_stats));
 }
 
+#ifdef WLAN_DP_TX_DESC_PCPU_CACHE
+void dp_tx_desc_cache_release(struct dp_soc *soc, struct dp_tx_desc_s *head,
+			      uint8_t desc_pool_id)
+{
+	struct dp_tx_desc_s *next;
+
+	while (head) {
+		next = head->next;
+		dp_tx_desc_free(soc, head, desc_pool_id);
+		head = next;
+	}
+}
+
+void dp_tx_desc_cache_flush(struct dp_soc *soc, struct dp_tx_desc_pool_s *pool,
+			    bool disable)
+{
+	struct dp_tx_desc_cache *cache;
+	struct dp_tx_desc_s *head;
+	int cpu;
+
+	if (!pool->cache)
+		return;
+
+	qdf_for_each_possible_cpu(cpu) {
+		cache = qdf_percpu_ptr(pool->cache, cpu);
+
+		qdf_spin_lock_bh(&cache->lock);
+		/*
+		 * Cleared under every cache lock in turn, so a CPU taking a
+		 * cache after it was flushed no longer parks descriptors in it
+		 */
+		if (disable)
+			pool->cache_enabled = false;
+		head = cache->freelist;
+		cache->freelist = NULL;
+		cache->count = 0;
+		qdf_spin_unlock_bh(&cache->lock);
+
+		dp_tx_desc_cache_release(soc, head, pool->flow_pool_id);
+	}
+}
+#endif
+
 /**
  * dp_tx_create_flow_pool() - create flow pool
  * @soc: Handle to struct dp_soc
@@ -335,6 +378,7 @@ struct dp_tx_desc_pool_s *dp_tx_create_flow_pool(struct dp_soc *soc,
 	qdf_spin_lock_bh(&pool->flow_pool_lock);
 	if ((pool->status != FLOW_POOL_INACTIVE) || pool->pool_create_cnt) {
 		dp_tx_flow_pool_reattach(pool);
+		dp_tx_desc_cache_enable(pool);
 		qdf_spin_unlock_bh(&pool->flow_pool_lock);
 		dp_err("cannot alloc desc, status=%d, create_cnt=%d",
 		       pool->status, pool->pool_create_cnt);
@@ -366,6 +410,7 @@ struct dp_tx_desc_pool_s *dp_tx_create_flow_pool(struct dp_soc *soc,
 	pool->status = FLOW_POOL_ACTIVE_UNPAUSED;
 	dp_tx_initialize_threshold(pool, start_threshold, stop_threshold,
 				   flow_pool_size);
+	dp_tx_desc_cache_enable(pool);
 	pool->pool_create_cnt++;
 
 	qdf_spin_unlock_bh(&pool->flow_pool_lock);
@@ -457,6 +502,9 @@ int dp_tx_delete_flow_pool(struct dp_soc *soc, struct dp_tx_desc_pool_s *pool,
 		return -EAGAIN;
 	}
 
+	/* descriptors parked in the per-CPU caches count as available */
+	dp_tx_desc_cache_flush(soc, pool, true);
+
 	qdf_spin_lock_bh(&pool->flow_pool_lock);
 	if (!pool->pool_create_cnt) {
 		qdf_spin_unlock_bh(&pool->flow_pool_lock);
@@ -465,6 +513,7 @@ int dp_tx_delete_flow_pool(struct dp_soc *soc, struct dp_tx_desc_pool_s *pool,
 	}
 	pool->pool_create_cnt--;
 	if (pool->pool_create_cnt) {
+		dp_tx_desc_cache_enable(pool);
 		qdf_spin_unlock_bh(&pool->flow_pool_lock);
 		dp_err("pool is still attached, pending detach %d",
 		       pool->pool_create_cnt);
@@ -683,6 +732,7 @@ static inline void dp_tx_desc_pool_dealloc(struct dp_soc *soc)
 		if (!tx_desc_pool->desc_pages.num_pages)
 			continue;
 
+		dp_tx_desc_cache_reset(tx_desc_pool);
 		dp_tx_desc_pool_deinit(soc, i, false);
 		dp_tx_desc_pool_free(soc, i, false);
 	}
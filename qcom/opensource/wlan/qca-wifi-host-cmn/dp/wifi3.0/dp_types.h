@@ -797,6 +797,26 @@ struct dp_tx_tso_num_seg_pool_s {
 	qdf_spinlock_t lock;
 };
 
+#ifdef WLAN_DP_TX_DESC_PCPU_CACHE
+/* Descriptors moved between a cache and its flow pool at once */
+#define DP_TX_DESC_CACHE_BATCH 16
+/* Cache depth above which a batch is given back to the flow pool */
+#define DP_TX_DESC_CACHE_SIZE (2 * DP_TX_DESC_CACHE_BATCH)
+
+/**
+ * struct dp_tx_desc_cache - per-CPU cache of free descriptors of a flow pool
+ * @lock: protects the cache against a flush from another CPU and against
+ *	  a task that migrated between picking the cache and locking it
+ * @freelist: chain of free descriptors held by the cache
+ * @count: number of descriptors in @freelist
+ */
+struct dp_tx_desc_cache {
+	qdf_spinlock_t lock;
+	struct dp_tx_desc_s *freelist;
+	uint16_t count;
+};
+#endif
+
 /**
  * struct dp_tx_desc_pool_s - Tx Descriptor pool information
  * @elem_size: Size of each descriptor in the pool
@@ -817,6 +837,9 @@ struct dp_tx_tso_num_seg_pool_s {
  * @flow_pool_lock:
  * @pool_create_cnt:
  * @pool_owner_ctx:
+ * @cache_enabled: descriptors may be parked in @cache
+ * @cache: per-CPU caches of free descriptors taken from @freelist, one
+ *	   copy per possible CPU, NULL if they could not be allocated
  * @elem_count:
  * @num_free: Number of free descriptors
  * @lock: Lock for descriptor allocation/free from/to the pool
@@ -846,6 +869,10 @@ struct dp_tx_desc_pool_s {
 	qdf_spinlock_t flow_pool_lock;
 	uint8_t pool_create_cnt;
 	void *pool_owner_ctx;
+#ifdef WLAN_DP_TX_DESC_PCPU_CACHE
+	bool cache_enabled;
+	struct dp_tx_desc_cache qdf_percpu *cache;
+#endif
 #else
 	uint16_t elem_count;
 	uint32_t num_free;
@@ -919,9 +946,24 @@ struct dp_reo_cmd_info {
 	TAILQ_ENTRY(dp_reo_cmd_info) reo_cmd_list_elem;
 };
 
+#ifdef DP_HIST_LOG_LINEAR
+/* log-linear histograms per TID and context: tx swq, hw tx, rx to stack */
+#define DP_PEER_DELAY_LL_PER_CTX 3
+#define DP_PEER_DELAY_LL_PER_TID (CDP_MAX_TXRX_CTX * DP_PEER_DELAY_LL_PER_CTX)
+#endif
+
+/**
+ * struct dp_peer_delay_stats - Peer extended delay stats
+ * @delay_tid_stats: Delay histograms per TID and TX/RX context
+ * @ll: Log-linear storage attached to the histograms of a TID, allocated
+ *	per TID and NULL if that allocation failed
+ */
 struct dp_peer_delay_stats {
 	struct cdp_delay_tid_stats delay_tid_stats[CDP_MAX_DATA_TIDS]
 						  [CDP_MAX_TXRX_CTX];
+#ifdef DP_HIST_LOG_LINEAR
+	struct cdp_hist_log_linear *ll[CDP_MAX_DATA_TIDS];
+#endif
 };
 
 /* Rx TID defrag*/
@@ -1166,6 +1208,74 @@ struct reo_desc_deferred_freelist_node {
 };
 #endif /* WLAN_DP_FEATURE_DEFERRED_REO_QDESC_DESTROY */
 
+#ifdef WLAN_DP_REO_QDESC_POOL
+/* Distinct REO queue descriptor sizes, one per BA window class */
+#define DP_REO_QDESC_POOL_NUM_CLASS 6
+/* Max cached descriptors per class */
+#define DP_REO_QDESC_POOL_CLASS_DEPTH 128
+/* Max cached descriptors across all classes */
+#define DP_REO_QDESC_POOL_HIGH_WM 512
+/* Cached descriptors a class keeps once the pool went idle */
+#define DP_REO_QDESC_POOL_LOW_WM 8
+/* Time without rx TID setups after which the pool is trimmed */
+#define DP_REO_QDESC_POOL_IDLE_MS 10000
+
+/**
+ * struct dp_reo_qdesc_pool_elem - cached REO queue descriptor
+ * @vaddr_unaligned: address returned by the allocator
+ * @paddr: DMA address of the aligned descriptor, still mapped
+ */
+struct dp_reo_qdesc_pool_elem {
+	void *vaddr_unaligned;
+	qdf_dma_addr_t paddr;
+};
+
+/**
+ * struct dp_reo_qdesc_pool_class - cached descriptors of one size
+ * @alloc_size: descriptor size of this class, 0 if the class is unused
+ * @count: number of cached descriptors in @elems
+ * @elems: stack of cached descriptors
+ */
+struct dp_reo_qdesc_pool_class {
+	uint32_t alloc_size;
+	uint32_t count;
+	struct dp_reo_qdesc_pool_elem *elems;
+};
+
+/**
+ * struct dp_reo_qdesc_pool - pool of aligned and DMA mapped REO queue
+ *			      descriptors reused across rx TID setups
+ * @lock: protects the pool
+ * @init: pool is ready to take descriptors
+ * @cls: per size class descriptor caches
+ * @cached: cached descriptors across all classes
+ * @last_get_ts: time of the last rx TID setup which asked the pool
+ * @alloc_hit: setups served from the pool, no alloc and no DMA map
+ * @alloc_miss: setups which had to alloc and DMA map a descriptor
+ * @release_cached: released descriptors kept in the pool
+ * @release_freed: released descriptors unmapped and freed
+ * @trimmed: cached descriptors freed because the pool went idle
+ * @test_unmap_free: unmaps and frees descriptors in place of the DMA API
+ *		     while the pool churn test runs
+ */
+struct dp_reo_qdesc_pool {
+	qdf_spinlock_t lock;
+	bool init;
+	struct dp_reo_qdesc_pool_class cls[DP_REO_QDESC_POOL_NUM_CLASS];
+	uint32_t cached;
+	unsigned long last_get_ts;
+	uint32_t alloc_hit;
+	uint32_t alloc_miss;
+	uint32_t release_cached;
+	uint32_t release_freed;
+	uint32_t trimmed;
+#ifdef WLAN_DP_REO_QDESC_POOL_TEST
+	void (*test_unmap_free)(struct dp_soc *soc, void *vaddr_unaligned,
+				qdf_dma_addr_t paddr, uint32_t alloc_size);
+#endif
+};
+#endif /* WLAN_DP_REO_QDESC_POOL */
+
 #ifdef WLAN_FEATURE_DP_EVENT_HISTORY
 /**
  * struct reo_cmd_event_record: Elements to record for each reo command
@@ -1468,6 +1578,7 @@ struct dp_ast_free_cb_params {
  * @callback: ast free/unmap callback
  * @cookie: argument to callback
  * @hash_list_elem: node in soc AST hash list (mac address used as hash)
+ * @rcu_head: defers the free until lockless AST hash readers are done
  */
 struct dp_ast_entry {
 	uint16_t ast_idx;
@@ -1486,6 +1597,9 @@ struct dp_ast_entry {
 	void *cookie;
 	TAILQ_ENTRY(dp_ast_entry) ase_list_elem;
 	TAILQ_ENTRY(dp_ast_entry) hash_list_elem;
+#ifdef WLAN_DP_PEER_HASH_RCU
+	qdf_rcu_head_t rcu_head;
+#endif
 };
 
 /**
@@ -2669,6 +2783,38 @@ struct dp_rx_msdu_done_fail_desc_list {
 };
 #endif
 
+#ifdef WLAN_DP_PERCPU_STATS
+/**
+ * struct dp_stats_pcpu - per-CPU counter backend of a stats structure
+ * @lock: serializes folds of the per-CPU copies into the stats structure
+ * @base: offset of the hot counter window in each stats element
+ * @len: size in bytes of the hot counter window
+ * @stride: size in bytes of one stats element
+ * @count: number of stats elements, one per link for txrx_peer stats
+ * @size: size in bytes of the per-CPU copy, @count windows of @len
+ * @slots: per-CPU copy of the hot counter windows, holding the running
+ *	sums of the increments done on that CPU
+ * @folded: sum over all copies already added to the stats structure
+ * @width: width in bytes of the counter at each offset of @slots, 0 if no
+ *	counter at that offset was ever updated through the backend
+ *
+ * Only the hot TX/RX counters of a stats structure are kept per CPU, so
+ * the per-CPU copy stays small. Counters outside the window are updated
+ * in the stats structure directly.
+ */
+struct dp_stats_pcpu {
+	qdf_spinlock_t lock;
+	uint32_t base;
+	uint32_t len;
+	uint32_t stride;
+	uint32_t count;
+	uint32_t size;
+	uint8_t qdf_percpu *slots;
+	uint8_t *folded;
+	uint8_t *width;
+};
+#endif
+
 /* SOC level structure for data path */
 struct dp_soc {
 	/**
@@ -2935,6 +3081,10 @@ struct dp_soc {
 
 	/* SoC level data path statistics */
 	struct dp_soc_stats stats;
+#ifdef WLAN_DP_PERCPU_STATS
+	/* per-CPU copies of the counters in stats */
+	struct dp_stats_pcpu *stats_pcpu;
+#endif
 #ifdef WLAN_SYSFS_DP_STATS
 	/* sysfs config for DP stats */
 	struct sysfs_stats_config *sysfs_config;
@@ -3149,6 +3299,9 @@ struct dp_soc {
 	qdf_list_t reo_desc_deferred_freelist;
 	qdf_spinlock_t reo_desc_deferred_freelist_lock;
 	bool reo_desc_deferred_freelist_init;
+#endif
+#ifdef WLAN_DP_REO_QDESC_POOL
+	struct dp_reo_qdesc_pool reo_qdesc_pool;
 #endif
 	/* BM id for first WBM2SW  ring */
 	uint32_t wbm_sw0_bm_id;
@@ -3669,6 +3822,10 @@ struct dp_pdev {
 
 	/* PDEV level data path statistics */
 	struct cdp_pdev_stats stats;
+#ifdef WLAN_DP_PERCPU_STATS
+	/* per-CPU copies of the counters in stats */
+	struct dp_stats_pcpu *stats_pcpu;
+#endif
 
 	/* Global RX decap mode for the device */
 	enum htt_pkt_type rx_decap_mode;
@@ -4149,6 +4306,10 @@ struct dp_vdev {
 
 	/* VDEV Stats */
 	struct dp_vdev_stats stats;
+#ifdef WLAN_DP_PERCPU_STATS
+	/* per-CPU copies of the counters in stats */
+	struct dp_stats_pcpu *stats_pcpu;
+#endif
 
 	/* Is this a proxySTA VAP */
 	uint8_t proxysta_vdev : 1, /* Is this a proxySTA VAP */
@@ -4966,6 +5127,7 @@ struct dp_local_link_id_peer_map {
  * @ll_id_peer_map: Mapping table for link peer mac address to local_link_id
  * @ll_band: Local link id band mapping
  * @stats_arr_size: peer stats array size
+ * @stats_pcpu: per-CPU copies of the counters in @stats
  * @stats: Peer link and mld statistics
  */
 struct dp_txrx_peer {
@@ -5023,6 +5185,9 @@ struct dp_txrx_peer {
 	uint8_t ll_band[DP_MAX_MLO_LINKS + 1];
 #endif
 	uint8_t stats_arr_size;
+#ifdef WLAN_DP_PERCPU_STATS
+	struct dp_stats_pcpu *stats_pcpu;
+#endif
 
 	/* dp_peer_stats should be the last member in the structure */
 	struct dp_peer_stats stats[];
@@ -5050,6 +5215,14 @@ struct dp_peer {
 	TAILQ_ENTRY(dp_peer) peer_list_elem;
 	/* node in the hash table bin's list of peers */
 	TAILQ_ENTRY(dp_peer) hash_list_elem;
+#ifdef WLAN_DP_PEER_HASH_RCU
+	/* defers the free until lockless hash readers are done */
+	qdf_rcu_head_t rcu_head;
+	/* grace period state when the peer was unlinked from the hash */
+	unsigned long hash_unlink_gp;
+	/* vdev id matched by lockless hash readers */
+	uint8_t hash_vdev_id;
+#endif
 
 	/* TID structures pointer */
 	struct dp_rx_tid *rx_tid;
@@ -1475,6 +1475,7 @@ dp_peer_get_tx_rx_stats(struct dp_peer *peer,
 	peer_stats_intf->rx_packet_count = txrx_peer->to_stack.num;
 	peer_stats_intf->rx_byte_count = txrx_peer->to_stack.bytes;
 	stats_arr_size = txrx_peer->stats_arr_size;
+	DP_STATS_PCPU_FOLD(txrx_peer);
 
 	for (inx = 0; inx < stats_arr_size; inx++) {
 		peer_stats_intf->tx_packet_count +=
@@ -2315,6 +2316,7 @@ dp_peer_cal_clients_stats_update(struct dp_soc *soc,
 	txrx_peer = tgt_peer->txrx_peer;
 	peer_stats_intf.to_stack = txrx_peer->to_stack;
 	stats_arr_size = txrx_peer->stats_arr_size;
+	DP_STATS_PCPU_FOLD(txrx_peer);
 
 	for (inx = 0; inx < stats_arr_size; inx++) {
 		peer_stats_intf.tx_success.num +=
@@ -2671,6 +2673,7 @@ void dp_send_stats_event(struct dp_pdev *pdev, struct dp_peer *peer,
 	if (qdf_likely(txrx_peer)) {
 		stats_arr_size = txrx_peer->stats_arr_size;
 		peer_stats_intf.rx_byte_count = txrx_peer->to_stack.bytes;
+		DP_STATS_PCPU_FOLD(txrx_peer);
 		for (inx = 0; inx < stats_arr_size; inx++)
 			peer_stats_intf.tx_byte_count +=
 			txrx_peer->stats[inx].per_pkt_stats.tx.tx_success.bytes;
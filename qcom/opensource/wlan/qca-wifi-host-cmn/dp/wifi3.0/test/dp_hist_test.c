@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2024 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted, provided that the
+ * above copyright notice and this permission notice appear in all
+ * copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+ * AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR
+ * PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+ * TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "dp_hist.h"
+#include "dp_hist_test.h"
+#include "qdf_mem.h"
+#include "qdf_trace.h"
+#include "qdf_util.h"
+
+#define DP_HIST_TEST_MAX_VALUE ((1U << CDP_HIST_LL_MAX_BITS) - 1)
+/* i * i stays below 2^CDP_HIST_LL_MAX_BITS for every sample index */
+#define DP_HIST_TEST_SAMPLES 4096
+/* odd stride, so i * stride visits every index once in scrambled order */
+#define DP_HIST_TEST_STRIDE 1597
+#define DP_HIST_TEST_SHARDS 4
+
+struct dp_hist_test_ctx {
+	struct cdp_hist_stats single;
+	struct cdp_hist_stats merged;
+	struct cdp_hist_stats shard[DP_HIST_TEST_SHARDS];
+	struct cdp_hist_log_linear ll_single;
+	struct cdp_hist_log_linear ll_merged;
+	struct cdp_hist_log_linear ll_shard[DP_HIST_TEST_SHARDS];
+};
+
+static const uint32_t dp_hist_test_pctl[] = {
+	1, 1000, DP_HIST_P50, DP_HIST_P90, DP_HIST_P99, DP_HIST_P999,
+	DP_HIST_PCTL_DENOM,
+};
+
+static void dp_hist_test_reset(struct cdp_hist_stats *hist_stats,
+			       struct cdp_hist_log_linear *ll)
+{
+	dp_hist_init(hist_stats, CDP_HIST_TYPE_SW_ENQEUE_DELAY);
+	dp_hist_ll_attach(hist_stats, ll);
+}
+
+/* a bucket midpoint may be off by half a bucket, at most 1/16th of v */
+static bool dp_hist_test_close(uint32_t got, uint32_t exact)
+{
+	uint32_t diff = got > exact ? got - exact : exact - got;
+
+	if (exact < CDP_HIST_LL_SUB_CNT)
+		return !diff;
+
+	return (uint64_t)diff * 16 <= exact;
+}
+
+static uint32_t dp_hist_test_single_value(struct dp_hist_test_ctx *ctx,
+					  int value, uint32_t *got)
+{
+	dp_hist_test_reset(&ctx->single, &ctx->ll_single);
+	dp_hist_update_stats(&ctx->single, value);
+	*got = dp_hist_get_percentile(&ctx->single, DP_HIST_P50);
+
+	return ctx->ll_single.count == 1 ? 0 : 1;
+}
+
+/**
+ * dp_hist_test_buckets() - check bucket error bound and ordering
+ * @ctx: test context
+ *
+ * Every value below 2^16 and the values around each power of two up to
+ * the clamp must come back within the error bound, and a larger value
+ * must never land in a lower bucket.
+ *
+ * Return: number of failures
+ */
+static uint32_t dp_hist_test_buckets(struct dp_hist_test_ctx *ctx)
+{
+	uint32_t value, prev = 0, got;
+	uint32_t errors = 0;
+	int bit, delta;
+
+	for (value = 0; value < (1U << 16); value++) {
+		errors += dp_hist_test_single_value(ctx, value, &got);
+		if (!dp_hist_test_close(got, value) || got < prev) {
+			qdf_nofl_err("value %u -> %u, previous %u",
+				     value, got, prev);
+			errors++;
+		}
+		prev = got;
+	}
+
+	for (bit = 16; bit <= CDP_HIST_LL_MAX_BITS; bit++) {
+		for (delta = -1; delta <= 1; delta++) {
+			value = (1U << bit) + delta;
+			if (value > DP_HIST_TEST_MAX_VALUE)
+				continue;
+
+			errors += dp_hist_test_single_value(ctx, value, &got);
+			if (!dp_hist_test_close(got, value)) {
+				qdf_nofl_err("value %u -> %u", value, got);
+				errors++;
+			}
+		}
+	}
+
+	/* out of range values are clamped, not dropped */
+	errors += dp_hist_test_single_value(ctx, -5, &got);
+	if (got) {
+		qdf_nofl_err("negative value -> %u", got);
+		errors++;
+	}
+
+	errors += dp_hist_test_single_value(ctx, 1 << 30, &got);
+	if (!dp_hist_test_close(got, DP_HIST_TEST_MAX_VALUE)) {
+		qdf_nofl_err("clamped value -> %u", got);
+		errors++;
+	}
+
+	return errors;
+}
+
+static uint32_t dp_hist_test_sample(uint32_t i)
+{
+	return i * i;
+}
+
+/**
+ * dp_hist_test_quantiles() - check percentiles against nearest rank
+ * @ctx: test context
+ *
+ * Samples i * i are recorded in scrambled order, so the exact nearest
+ * rank percentile is known without sorting. The same stream is also
+ * sharded over several histograms the way peer delay stats are spread
+ * over TX/RX contexts; merging them must give the very same answer.
+ *
+ * Return: number of failures
+ */
+static uint32_t dp_hist_test_quantiles(struct dp_hist_test_ctx *ctx)
+{
+	uint32_t i, idx, rank, exact, got, got_merged;
+	uint32_t errors = 0;
+
+	dp_hist_test_reset(&ctx->single, &ctx->ll_single);
+	dp_hist_test_reset(&ctx->merged, &ctx->ll_merged);
+	for (i = 0; i < DP_HIST_TEST_SHARDS; i++)
+		dp_hist_test_reset(&ctx->shard[i], &ctx->ll_shard[i]);
+
+	for (i = 0; i < DP_HIST_TEST_SAMPLES; i++) {
+		idx = (i * DP_HIST_TEST_STRIDE) % DP_HIST_TEST_SAMPLES;
+		dp_hist_update_stats(&ctx->single, dp_hist_test_sample(idx));
+		dp_hist_update_stats(&ctx->shard[i % DP_HIST_TEST_SHARDS],
+				     dp_hist_test_sample(idx));
+	}
+
+	for (i = 0; i < DP_HIST_TEST_SHARDS; i++)
+		dp_accumulate_hist_stats(&ctx->shard[i], &ctx->merged);
+
+	if (ctx->ll_merged.count != DP_HIST_TEST_SAMPLES) {
+		qdf_nofl_err("merged count %llu",
+			     (unsigned long long)ctx->ll_merged.count);
+		errors++;
+	}
+
+	for (i = 0; i < QDF_ARRAY_SIZE(dp_hist_test_pctl); i++) {
+		rank = (DP_HIST_TEST_SAMPLES * dp_hist_test_pctl[i] +
+			DP_HIST_PCTL_DENOM - 1) / DP_HIST_PCTL_DENOM;
+		if (!rank)
+			rank = 1;
+		exact = dp_hist_test_sample(rank - 1);
+
+		got = dp_hist_get_percentile(&ctx->single,
+					     dp_hist_test_pctl[i]);
+		got_merged = dp_hist_get_percentile(&ctx->merged,
+						    dp_hist_test_pctl[i]);
+
+		qdf_nofl_info("P%u/%u exact %u got %u merged %u",
+			      dp_hist_test_pctl[i], DP_HIST_PCTL_DENOM,
+			      exact, got, got_merged);
+
+		if (!dp_hist_test_close(got, exact)) {
+			qdf_nofl_err("P%u out of bound", dp_hist_test_pctl[i]);
+			errors++;
+		}
+
+		if (got_merged != got) {
+			qdf_nofl_err("P%u merged %u != %u",
+				     dp_hist_test_pctl[i], got_merged, got);
+			errors++;
+		}
+	}
+
+	/* histograms without log-linear storage report no percentiles */
+	dp_hist_ll_attach(&ctx->single, NULL);
+	dp_hist_update_stats(&ctx->single, 100);
+	if (dp_hist_get_percentile(&ctx->single, DP_HIST_P50)) {
+		qdf_nofl_err("percentile without storage");
+		errors++;
+	}
+
+	return errors;
+}
+
+uint32_t dp_hist_unit_test(void)
+{
+	struct dp_hist_test_ctx *ctx;
+	uint32_t errors = 0;
+
+	ctx = qdf_mem_malloc(sizeof(*ctx));
+	if (!ctx)
+		return 1;
+
+	errors += dp_hist_test_buckets(ctx);
+	errors += dp_hist_test_quantiles(ctx);
+
+	QDF_BUG(!errors);
+	qdf_mem_free(ctx);
+
+	return errors;
+}
@@ -0,0 +1,326 @@
+/*
+ * Copyright (c) 2024 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted, provided that the
+ * above copyright notice and this permission notice appear in all
+ * copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+ * AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR
+ * PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+ * TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#include "dp_types.h"
+#include "dp_internal.h"
+#include "dp_peer.h"
+#include "dp_peer_hash_test.h"
+#include "qdf_mem.h"
+#include "qdf_threads.h"
+#include "qdf_time.h"
+#include "qdf_trace.h"
+
+/* few bins so every bin carries stable and churning peers */
+#define DP_PEER_HASH_TEST_BIN_BITS 3
+#define DP_PEER_HASH_TEST_BINS (1 << DP_PEER_HASH_TEST_BIN_BITS)
+#define DP_PEER_HASH_TEST_PEERS 32
+#define DP_PEER_HASH_TEST_VDEV_ID 1
+#define DP_PEER_HASH_TEST_MAX_READERS 8
+#define DP_PEER_HASH_TEST_RUN_MS 100
+
+struct dp_peer_hash_test_ctx {
+	struct dp_soc *soc;
+	struct dp_vdev *vdev;
+	union dp_align_mac_addr stable[DP_PEER_HASH_TEST_PEERS];
+	struct dp_peer *stable_peer[DP_PEER_HASH_TEST_PEERS];
+	struct dp_peer *churn_peer[DP_PEER_HASH_TEST_PEERS];
+};
+
+struct dp_peer_hash_test_reader {
+	struct dp_peer_hash_test_ctx *ctx;
+	uint32_t seed;
+	uint64_t lookups;
+	uint32_t errors;
+};
+
+static struct dp_peer *
+dp_peer_hash_test_peer_alloc(struct dp_peer_hash_test_ctx *ctx,
+			     union dp_align_mac_addr *mac)
+{
+	struct dp_peer *peer;
+
+	peer = qdf_mem_malloc(sizeof(*peer));
+	if (!peer)
+		return NULL;
+
+	peer->vdev = ctx->vdev;
+	peer->peer_id = HTT_INVALID_PEER;
+	qdf_mem_copy(&peer->mac_addr, mac, sizeof(peer->mac_addr));
+	DP_PEER_SET_TYPE(peer, CDP_LINK_PEER_TYPE);
+	/* the test's own reference, dropped when the peer is retired */
+	qdf_atomic_init(&peer->ref_cnt);
+	qdf_atomic_inc(&peer->ref_cnt);
+
+	return peer;
+}
+
+/* dp_peer_unref_delete() minus the teardown of state the test never sets */
+static void dp_peer_hash_test_put(struct dp_peer *peer, enum dp_mod_id mod_id)
+{
+	if (mod_id > DP_MOD_ID_RX)
+		qdf_atomic_dec(&peer->mod_refs[mod_id]);
+
+	if (qdf_atomic_dec_and_test(&peer->ref_cnt))
+		dp_peer_mem_free(peer);
+}
+
+/*
+ * Churning peers use the stable peer's MAC with its 16-bit words rotated,
+ * the XOR fold in dp_peer_find_hash_index() then lands both in one bin.
+ */
+static void dp_peer_hash_test_churn_mac(union dp_align_mac_addr *stable,
+					union dp_align_mac_addr *churn)
+{
+	churn->align2.bytes_ab = stable->align2.bytes_cd;
+	churn->align2.bytes_cd = stable->align2.bytes_ef;
+	churn->align2.bytes_ef = stable->align2.bytes_ab;
+}
+
+static QDF_STATUS dp_peer_hash_test_reader_thread(void *context)
+{
+	struct dp_peer_hash_test_reader *reader = context;
+	struct dp_peer_hash_test_ctx *ctx = reader->ctx;
+	struct dp_peer *peer;
+	uint32_t i;
+
+	while (!qdf_thread_should_stop()) {
+		reader->seed = reader->seed * 1103515245 + 12345;
+		i = (reader->seed >> 16) % DP_PEER_HASH_TEST_PEERS;
+
+		/* a stable peer must be found on every single walk ... */
+		peer = dp_peer_find_hash_find(ctx->soc, ctx->stable[i].raw, 1,
+					      DP_PEER_HASH_TEST_VDEV_ID,
+					      DP_MOD_ID_CDP);
+		if (!peer || peer != ctx->stable_peer[i])
+			reader->errors++;
+		if (peer)
+			dp_peer_hash_test_put(peer, DP_MOD_ID_CDP);
+
+		/* ... and never for a vdev it is not on */
+		peer = dp_peer_find_hash_find(ctx->soc, ctx->stable[i].raw, 1,
+					      DP_PEER_HASH_TEST_VDEV_ID + 1,
+					      DP_MOD_ID_CDP);
+		if (peer) {
+			reader->errors++;
+			dp_peer_hash_test_put(peer, DP_MOD_ID_CDP);
+		}
+
+		reader->lookups += 2;
+	}
+
+	return QDF_STATUS_SUCCESS;
+}
+
+/* move one churning peer to the bin tail, either relinked or replaced */
+static void dp_peer_hash_test_churn(struct dp_peer_hash_test_ctx *ctx,
+				    uint32_t i, bool reuse)
+{
+	struct dp_peer *peer = ctx->churn_peer[i];
+	struct dp_peer *new_peer;
+
+	dp_peer_find_hash_remove(ctx->soc, peer);
+
+	if (reuse) {
+		dp_peer_hash_relink_wait(peer);
+		dp_peer_find_hash_add(ctx->soc, peer);
+		return;
+	}
+
+	new_peer = dp_peer_hash_test_peer_alloc(ctx, &peer->mac_addr);
+	dp_peer_hash_test_put(peer, DP_MOD_ID_CONFIG);
+	QDF_BUG(new_peer);
+	if (!new_peer) {
+		ctx->churn_peer[i] = NULL;
+		return;
+	}
+
+	dp_peer_find_hash_add(ctx->soc, new_peer);
+	ctx->churn_peer[i] = new_peer;
+}
+
+static uint32_t dp_peer_hash_test_run(struct dp_peer_hash_test_ctx *ctx,
+				      uint32_t num_readers)
+{
+	struct dp_peer_hash_test_reader readers[DP_PEER_HASH_TEST_MAX_READERS];
+	qdf_thread_t *threads[DP_PEER_HASH_TEST_MAX_READERS];
+	unsigned long start, elapsed;
+	uint64_t lookups = 0;
+	uint32_t errors = 0;
+	uint32_t cycles = 0;
+	uint32_t i;
+
+	for (i = 0; i < num_readers; i++) {
+		readers[i].ctx = ctx;
+		readers[i].seed = i + 1;
+		readers[i].lookups = 0;
+		readers[i].errors = 0;
+		threads[i] = qdf_thread_run(dp_peer_hash_test_reader_thread,
+					    &readers[i]);
+		QDF_BUG(threads[i]);
+		if (!threads[i])
+			num_readers = i;
+	}
+
+	start = qdf_get_system_timestamp();
+	do {
+		i = cycles % DP_PEER_HASH_TEST_PEERS;
+		if (ctx->churn_peer[i])
+			dp_peer_hash_test_churn(ctx, i, cycles & 1);
+		cycles++;
+		elapsed = qdf_get_system_timestamp() - start;
+	} while (elapsed < DP_PEER_HASH_TEST_RUN_MS);
+
+	for (i = 0; i < num_readers; i++) {
+		qdf_thread_join(threads[i]);
+		lookups += readers[i].lookups;
+		errors += readers[i].errors;
+	}
+
+	QDF_BUG(!errors);
+
+	qdf_nofl_info("dp_peer_hash: %u readers %llu lookups/ms %u churns/ms %u misses",
+		      num_readers, lookups / (elapsed ? elapsed : 1),
+		      (uint32_t)(cycles / (elapsed ? elapsed : 1)), errors);
+
+	return errors;
+}
+
+static QDF_STATUS dp_peer_hash_test_setup(struct dp_peer_hash_test_ctx *ctx)
+{
+	struct dp_soc *soc;
+	struct dp_pdev *pdev;
+	struct dp_vdev *vdev;
+	union dp_align_mac_addr churn;
+	uint32_t i;
+
+	soc = qdf_mem_valloc(sizeof(*soc));
+	if (!soc)
+		return QDF_STATUS_E_NOMEM;
+	ctx->soc = soc;
+
+	soc->peer_hash.bins = qdf_mem_malloc(DP_PEER_HASH_TEST_BINS *
+					     sizeof(*soc->peer_hash.bins));
+	if (!soc->peer_hash.bins)
+		return QDF_STATUS_E_NOMEM;
+
+	soc->peer_hash.mask = DP_PEER_HASH_TEST_BINS - 1;
+	soc->peer_hash.idx_bits = DP_PEER_HASH_TEST_BIN_BITS;
+	for (i = 0; i < DP_PEER_HASH_TEST_BINS; i++)
+		TAILQ_INIT(&soc->peer_hash.bins[i]);
+	qdf_spinlock_create(&soc->peer_hash_lock);
+
+	pdev = qdf_mem_malloc(sizeof(*pdev));
+	if (!pdev)
+		return QDF_STATUS_E_NOMEM;
+	pdev->soc = soc;
+
+	vdev = qdf_mem_malloc(sizeof(*vdev));
+	if (!vdev) {
+		qdf_mem_free(pdev);
+		return QDF_STATUS_E_NOMEM;
+	}
+	vdev->pdev = pdev;
+	vdev->vdev_id = DP_PEER_HASH_TEST_VDEV_ID;
+	ctx->vdev = vdev;
+
+	/*
+	 * Link the churning peer of each bin ahead of the stable one so
+	 * readers always walk across a peer that is being moved.
+	 */
+	for (i = 0; i < DP_PEER_HASH_TEST_PEERS; i++) {
+		ctx->stable[i].align2.bytes_ab = 0x0200 | i;
+		ctx->stable[i].align2.bytes_cd = 0x1100 + 3 * i;
+		ctx->stable[i].align2.bytes_ef = 0x2200 + 5 * i;
+		dp_peer_hash_test_churn_mac(&ctx->stable[i], &churn);
+
+		ctx->churn_peer[i] = dp_peer_hash_test_peer_alloc(ctx, &churn);
+		if (!ctx->churn_peer[i])
+			return QDF_STATUS_E_NOMEM;
+		dp_peer_find_hash_add(soc, ctx->churn_peer[i]);
+
+		ctx->stable_peer[i] =
+			dp_peer_hash_test_peer_alloc(ctx, &ctx->stable[i]);
+		if (!ctx->stable_peer[i])
+			return QDF_STATUS_E_NOMEM;
+		dp_peer_find_hash_add(soc, ctx->stable_peer[i]);
+	}
+
+	return QDF_STATUS_SUCCESS;
+}
+
+static void dp_peer_hash_test_teardown(struct dp_peer_hash_test_ctx *ctx)
+{
+	struct dp_soc *soc = ctx->soc;
+	uint32_t i;
+
+	if (!soc)
+		return;
+
+	for (i = 0; i < DP_PEER_HASH_TEST_PEERS; i++) {
+		if (ctx->churn_peer[i]) {
+			dp_peer_find_hash_remove(soc, ctx->churn_peer[i]);
+			dp_peer_hash_test_put(ctx->churn_peer[i],
+					      DP_MOD_ID_CONFIG);
+		}
+		if (ctx->stable_peer[i]) {
+			dp_peer_find_hash_remove(soc, ctx->stable_peer[i]);
+			dp_peer_hash_test_put(ctx->stable_peer[i],
+					      DP_MOD_ID_CONFIG);
+		}
+	}
+
+	/* peers are freed after a grace period, wait for all of them */
+	dp_peer_hash_rcu_barrier();
+
+	if (ctx->vdev) {
+		qdf_mem_free(ctx->vdev->pdev);
+		qdf_mem_free(ctx->vdev);
+	}
+	if (soc->peer_hash.bins) {
+		qdf_spinlock_destroy(&soc->peer_hash_lock);
+		qdf_mem_free(soc->peer_hash.bins);
+	}
+	qdf_mem_vfree(soc);
+}
+
+uint32_t dp_peer_hash_unit_test(void)
+{
+	struct dp_peer_hash_test_ctx *ctx;
+	uint32_t num_readers;
+	uint32_t errors = 0;
+
+	ctx = qdf_mem_malloc(sizeof(*ctx));
+	if (!ctx)
+		return 1;
+
+	if (QDF_IS_STATUS_ERROR(dp_peer_hash_test_setup(ctx))) {
+		errors++;
+		goto teardown;
+	}
+
+	for (num_readers = 1; num_readers <= DP_PEER_HASH_TEST_MAX_READERS;
+	     num_readers <<= 1)
+		errors += dp_peer_hash_test_run(ctx, num_readers);
+
+teardown:
+	dp_peer_hash_test_teardown(ctx);
+	qdf_mem_free(ctx);
+
+	return errors;
+}
@@ -0,0 +1,416 @@
+/*
+ * Copyright (c) 2024 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted, provided that the
+ * above copyright notice and this permission notice appear in all
+ * copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+ * AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR
+ * PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+ * TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "dp_types.h"
+#include "dp_rx_tid.h"
+#include "dp_reo_qdesc_pool_test.h"
+#include "qdf_mem.h"
+#include "qdf_trace.h"
+
+/* stand-ins for the REO queue descriptor size of each BA window class */
+static const uint32_t dp_reo_qdesc_pool_test_sizes[] = {
+	256, 384, 512, 1152, 2176, 4224,
+};
+
+#define DP_REO_QDESC_POOL_TEST_NUM_SIZES \
+	QDF_ARRAY_SIZE(dp_reo_qdesc_pool_test_sizes)
+/* one size more than the pool has classes */
+#define DP_REO_QDESC_POOL_TEST_EXTRA_SIZE 8320
+#define DP_REO_QDESC_POOL_TEST_PEERS 256
+#define DP_REO_QDESC_POOL_TEST_TIDS 8
+#define DP_REO_QDESC_POOL_TEST_ROUNDS 32
+#define DP_REO_QDESC_POOL_TEST_HELD \
+	(DP_REO_QDESC_POOL_TEST_PEERS * DP_REO_QDESC_POOL_TEST_TIDS)
+#define DP_REO_QDESC_POOL_TEST_MAGIC 0x5eed0dec
+#define DP_REO_QDESC_POOL_TEST_DEAD 0xdeadd0de
+
+/* kept at the start of every descriptor the test allocates */
+struct dp_reo_qdesc_pool_test_tag {
+	uint32_t magic;
+	uint32_t size;
+	qdf_dma_addr_t paddr;
+	bool in_use;
+};
+
+struct dp_reo_qdesc_pool_test_desc {
+	void *vaddr;
+	qdf_dma_addr_t paddr;
+	uint32_t size;
+};
+
+struct dp_reo_qdesc_pool_test_ctx {
+	struct dp_soc *soc;
+	struct dp_reo_qdesc_pool_test_desc held[DP_REO_QDESC_POOL_TEST_HELD];
+	uint32_t num_held;
+	uint32_t seed;
+	/* fake DMA addresses, never zero and never reused */
+	qdf_dma_addr_t next_paddr;
+	/* what rx TID setup and teardown would have cost */
+	uint32_t gets;
+	uint32_t releases;
+	uint32_t allocs;
+	uint32_t maps;
+	uint32_t unmaps;
+	uint32_t frees;
+	uint32_t errors;
+};
+
+/* the pool has no context for the hook, the test owns its only soc */
+static struct dp_reo_qdesc_pool_test_ctx *dp_reo_qdesc_pool_test_ctx;
+
+static uint32_t dp_reo_qdesc_pool_test_rand(
+		struct dp_reo_qdesc_pool_test_ctx *ctx, uint32_t range)
+{
+	ctx->seed = ctx->seed * 1664525 + 1013904223;
+
+	return (ctx->seed >> 8) % range;
+}
+
+static void dp_reo_qdesc_pool_test_unmap_free(struct dp_soc *soc,
+					      void *vaddr_unaligned,
+					      qdf_dma_addr_t paddr,
+					      uint32_t alloc_size)
+{
+	struct dp_reo_qdesc_pool_test_ctx *ctx = dp_reo_qdesc_pool_test_ctx;
+	struct dp_reo_qdesc_pool_test_tag *tag = vaddr_unaligned;
+
+	if (tag->magic != DP_REO_QDESC_POOL_TEST_MAGIC ||
+	    tag->size != alloc_size || tag->paddr != paddr || tag->in_use) {
+		qdf_nofl_err("dp_reo_qdesc_pool: bad free of %pK size %u",
+			     vaddr_unaligned, alloc_size);
+		ctx->errors++;
+		return;
+	}
+
+	tag->magic = DP_REO_QDESC_POOL_TEST_DEAD;
+	ctx->unmaps++;
+	ctx->frees++;
+	qdf_mem_free(vaddr_unaligned);
+}
+
+/* what dp_single_rx_tid_setup() does for the descriptor */
+static bool dp_reo_qdesc_pool_test_setup(struct dp_reo_qdesc_pool_test_ctx *ctx,
+					 uint32_t size)
+{
+	struct dp_reo_qdesc_pool_test_desc *desc = &ctx->held[ctx->num_held];
+	struct dp_reo_qdesc_pool_test_tag *tag;
+	bool pooled;
+
+	ctx->gets++;
+	pooled = dp_reo_qdesc_pool_test_get(ctx->soc, size, &desc->vaddr,
+					    &desc->paddr);
+	if (pooled) {
+		tag = desc->vaddr;
+		if (tag->magic != DP_REO_QDESC_POOL_TEST_MAGIC ||
+		    tag->size != size || tag->paddr != desc->paddr ||
+		    tag->in_use) {
+			qdf_nofl_err("dp_reo_qdesc_pool: bad hit %pK size %u for size %u",
+				     desc->vaddr, tag->size, size);
+			ctx->errors++;
+			return false;
+		}
+	} else {
+		desc->vaddr = qdf_mem_malloc(size);
+		if (!desc->vaddr) {
+			ctx->errors++;
+			return false;
+		}
+
+		tag = desc->vaddr;
+		tag->magic = DP_REO_QDESC_POOL_TEST_MAGIC;
+		tag->size = size;
+		ctx->next_paddr += size;
+		tag->paddr = ctx->next_paddr;
+		desc->paddr = tag->paddr;
+		ctx->allocs++;
+		ctx->maps++;
+	}
+
+	tag->in_use = true;
+	desc->size = size;
+	ctx->num_held++;
+
+	return pooled;
+}
+
+/* what the REO flush completion does once HW let go of the descriptor */
+static void dp_reo_qdesc_pool_test_teardown(
+		struct dp_reo_qdesc_pool_test_ctx *ctx, uint32_t idx)
+{
+	struct dp_reo_qdesc_pool_test_desc desc = ctx->held[idx];
+	struct dp_reo_qdesc_pool_test_tag *tag = desc.vaddr;
+
+	ctx->held[idx] = ctx->held[--ctx->num_held];
+	tag->in_use = false;
+	ctx->releases++;
+	dp_reo_qdesc_pool_test_release(ctx->soc, desc.vaddr, desc.paddr,
+				       desc.size);
+}
+
+static void dp_reo_qdesc_pool_test_teardown_all(
+		struct dp_reo_qdesc_pool_test_ctx *ctx)
+{
+	while (ctx->num_held)
+		dp_reo_qdesc_pool_test_teardown(ctx, ctx->num_held - 1);
+}
+
+static void dp_reo_qdesc_pool_test_expect(
+		struct dp_reo_qdesc_pool_test_ctx *ctx, bool cond,
+		const char *what)
+{
+	if (cond)
+		return;
+
+	qdf_nofl_err("dp_reo_qdesc_pool: %s", what);
+	ctx->errors++;
+}
+
+static void dp_reo_qdesc_pool_test_basic(struct dp_reo_qdesc_pool_test_ctx *ctx)
+{
+	struct dp_reo_qdesc_pool *pool = &ctx->soc->reo_qdesc_pool;
+	uint32_t size = dp_reo_qdesc_pool_test_sizes[0];
+	uint32_t extra = DP_REO_QDESC_POOL_TEST_EXTRA_SIZE;
+	uint32_t frees, cached, i, j;
+	void *vaddr;
+
+	dp_reo_qdesc_pool_test_expect(ctx,
+				      !dp_reo_qdesc_pool_test_setup(ctx, size),
+				      "hit on an empty pool");
+	vaddr = ctx->held[0].vaddr;
+	dp_reo_qdesc_pool_test_teardown(ctx, 0);
+	dp_reo_qdesc_pool_test_expect(ctx, ctx->frees == 0,
+				      "released descriptor was not kept");
+
+	dp_reo_qdesc_pool_test_expect(ctx,
+				      !dp_reo_qdesc_pool_test_setup(ctx,
+					dp_reo_qdesc_pool_test_sizes[1]),
+				      "hit for a size never released");
+	dp_reo_qdesc_pool_test_expect(ctx,
+				      dp_reo_qdesc_pool_test_setup(ctx, size),
+				      "miss for a released size");
+	dp_reo_qdesc_pool_test_expect(ctx, ctx->held[1].vaddr == vaddr,
+				      "hit returned another descriptor");
+	dp_reo_qdesc_pool_test_teardown_all(ctx);
+
+	/* every class taken, a further size has nowhere to go */
+	for (i = 0; i < DP_REO_QDESC_POOL_TEST_NUM_SIZES; i++)
+		dp_reo_qdesc_pool_test_setup(ctx,
+					     dp_reo_qdesc_pool_test_sizes[i]);
+	dp_reo_qdesc_pool_test_teardown_all(ctx);
+	dp_reo_qdesc_pool_test_setup(ctx, extra);
+	frees = ctx->frees;
+	dp_reo_qdesc_pool_test_teardown_all(ctx);
+	dp_reo_qdesc_pool_test_expect(ctx, ctx->frees == frees + 1,
+				      "size beyond the classes was not freed");
+	dp_reo_qdesc_pool_test_expect(ctx,
+				      !dp_reo_qdesc_pool_test_setup(ctx,
+								    extra),
+				      "hit for a size beyond the classes");
+	dp_reo_qdesc_pool_test_teardown_all(ctx);
+
+	/* a class never holds more than its depth */
+	for (i = 0; i < DP_REO_QDESC_POOL_CLASS_DEPTH + 5; i++)
+		dp_reo_qdesc_pool_test_setup(ctx, size);
+	frees = ctx->frees;
+	dp_reo_qdesc_pool_test_teardown_all(ctx);
+	dp_reo_qdesc_pool_test_expect(ctx, ctx->frees == frees + 5,
+				      "class overflow was not freed");
+
+	/* nor does the pool hold more than its high watermark */
+	for (i = 1; i < DP_REO_QDESC_POOL_TEST_NUM_SIZES; i++)
+		for (j = 0; j < DP_REO_QDESC_POOL_CLASS_DEPTH; j++)
+			dp_reo_qdesc_pool_test_setup(ctx,
+					dp_reo_qdesc_pool_test_sizes[i]);
+	cached = pool->cached + ctx->num_held;
+	frees = ctx->frees;
+	dp_reo_qdesc_pool_test_teardown_all(ctx);
+	dp_reo_qdesc_pool_test_expect(ctx, cached > DP_REO_QDESC_POOL_HIGH_WM,
+				      "high watermark not reached");
+	dp_reo_qdesc_pool_test_expect(ctx, pool->cached ==
+				      DP_REO_QDESC_POOL_HIGH_WM,
+				      "pool grew beyond its high watermark");
+	dp_reo_qdesc_pool_test_expect(ctx, ctx->frees - frees ==
+				      cached - DP_REO_QDESC_POOL_HIGH_WM,
+				      "pool overflow was not freed");
+}
+
+/* a pool nobody took from for a while shrinks to its low watermark */
+static void dp_reo_qdesc_pool_test_idle(struct dp_reo_qdesc_pool_test_ctx *ctx)
+{
+	struct dp_reo_qdesc_pool *pool = &ctx->soc->reo_qdesc_pool;
+	uint32_t cached = pool->cached, trimmed = pool->trimmed;
+	uint32_t frees = ctx->frees, kept = 0, i;
+
+	dp_reo_qdesc_pool_test_trim(ctx->soc);
+	dp_reo_qdesc_pool_test_expect(ctx, pool->cached == cached,
+				      "pool in use was trimmed");
+
+	pool->last_get_ts = qdf_get_system_timestamp() -
+			    DP_REO_QDESC_POOL_IDLE_MS;
+	dp_reo_qdesc_pool_test_trim(ctx->soc);
+	for (i = 0; i < DP_REO_QDESC_POOL_NUM_CLASS; i++) {
+		dp_reo_qdesc_pool_test_expect(ctx, pool->cls[i].count <=
+					      DP_REO_QDESC_POOL_LOW_WM,
+					      "idle class above low watermark");
+		kept += pool->cls[i].count;
+	}
+	dp_reo_qdesc_pool_test_expect(ctx, pool->cached == kept,
+				      "cached count after trim");
+	dp_reo_qdesc_pool_test_expect(ctx, kept < cached &&
+				      ctx->frees - frees == cached - kept &&
+				      pool->trimmed - trimmed == cached - kept,
+				      "trimmed descriptors were not freed");
+}
+
+/* with the qref debug lists on, every descriptor is freed as before */
+static void dp_reo_qdesc_pool_test_qref(struct dp_reo_qdesc_pool_test_ctx *ctx)
+{
+	struct dp_reo_qdesc_pool *pool = &ctx->soc->reo_qdesc_pool;
+	uint32_t size = dp_reo_qdesc_pool_test_sizes[0];
+	uint32_t frees;
+
+	ctx->soc->wlan_cfg_ctx->qref_control_size = 1;
+	dp_reo_qdesc_pool_create(ctx->soc);
+	pool->test_unmap_free = dp_reo_qdesc_pool_test_unmap_free;
+	dp_reo_qdesc_pool_test_expect(ctx, !pool->init,
+				      "pool enabled with qref debug lists");
+
+	dp_reo_qdesc_pool_test_setup(ctx, size);
+	frees = ctx->frees;
+	dp_reo_qdesc_pool_test_teardown_all(ctx);
+	dp_reo_qdesc_pool_test_expect(ctx, ctx->frees == frees + 1,
+				      "descriptor pooled with qref debug lists");
+	dp_reo_qdesc_pool_test_expect(ctx,
+				      !dp_reo_qdesc_pool_test_setup(ctx, size),
+				      "hit with qref debug lists");
+	dp_reo_qdesc_pool_test_teardown_all(ctx);
+
+	dp_reo_qdesc_pool_destroy(ctx->soc);
+	ctx->soc->wlan_cfg_ctx->qref_control_size = 0;
+}
+
+/*
+ * Association storms: every peer sets up all its TIDs with a BA window
+ * class of its own, then the peers leave in random order.
+ */
+static void dp_reo_qdesc_pool_test_churn(struct dp_reo_qdesc_pool_test_ctx *ctx)
+{
+	uint32_t round, peer, tid, size, hits = 0, gets = 0;
+	uint32_t allocs = ctx->allocs, maps = ctx->maps;
+	uint32_t start_gets = ctx->gets;
+
+	for (round = 0; round < DP_REO_QDESC_POOL_TEST_ROUNDS; round++) {
+		for (peer = 0; peer < DP_REO_QDESC_POOL_TEST_PEERS; peer++) {
+			size = dp_reo_qdesc_pool_test_sizes[
+				dp_reo_qdesc_pool_test_rand(ctx,
+					DP_REO_QDESC_POOL_TEST_NUM_SIZES)];
+			for (tid = 0; tid < DP_REO_QDESC_POOL_TEST_TIDS;
+			     tid++) {
+				gets++;
+				if (dp_reo_qdesc_pool_test_setup(ctx, size))
+					hits++;
+			}
+		}
+
+		while (ctx->num_held)
+			dp_reo_qdesc_pool_test_teardown(ctx,
+				dp_reo_qdesc_pool_test_rand(ctx,
+							    ctx->num_held));
+	}
+
+	dp_reo_qdesc_pool_test_expect(ctx, gets == ctx->gets - start_gets,
+				      "setups lost");
+	dp_reo_qdesc_pool_test_expect(ctx, hits, "no setup was served");
+
+	qdf_nofl_info("dp_reo_qdesc_pool: %u peers x %u TIDs x %u rounds: %u setups, %u allocs and DMA maps with the pool, %u without",
+		      DP_REO_QDESC_POOL_TEST_PEERS, DP_REO_QDESC_POOL_TEST_TIDS,
+		      DP_REO_QDESC_POOL_TEST_ROUNDS, gets,
+		      ctx->allocs - allocs, gets);
+	dp_reo_qdesc_pool_test_expect(ctx, ctx->maps - maps == gets - hits,
+				      "maps do not match pool misses");
+}
+
+uint32_t dp_reo_qdesc_pool_unit_test(void)
+{
+	struct dp_reo_qdesc_pool_test_ctx *ctx;
+	struct dp_reo_qdesc_pool *pool;
+	uint32_t errors;
+
+	ctx = qdf_mem_valloc(sizeof(*ctx));
+	if (!ctx)
+		return 1;
+
+	ctx->soc = qdf_mem_valloc(sizeof(*ctx->soc));
+	if (!ctx->soc) {
+		qdf_mem_vfree(ctx);
+		return 1;
+	}
+
+	/* the pool only reads the qref debug list size from the config */
+	ctx->soc->wlan_cfg_ctx = qdf_mem_malloc(sizeof(*ctx->soc->wlan_cfg_ctx));
+	if (!ctx->soc->wlan_cfg_ctx) {
+		qdf_mem_vfree(ctx->soc);
+		qdf_mem_vfree(ctx);
+		return 1;
+	}
+
+	ctx->seed = 1;
+	dp_reo_qdesc_pool_test_ctx = ctx;
+	pool = &ctx->soc->reo_qdesc_pool;
+	dp_reo_qdesc_pool_create(ctx->soc);
+	pool->test_unmap_free = dp_reo_qdesc_pool_test_unmap_free;
+	if (!pool->init) {
+		ctx->errors++;
+		goto destroy;
+	}
+
+	dp_reo_qdesc_pool_test_basic(ctx);
+	dp_reo_qdesc_pool_test_idle(ctx);
+	dp_reo_qdesc_pool_test_churn(ctx);
+
+	dp_reo_qdesc_pool_test_expect(ctx,
+				      pool->alloc_hit + pool->alloc_miss ==
+				      ctx->gets, "hit and miss counts");
+	dp_reo_qdesc_pool_test_expect(ctx, pool->alloc_miss == ctx->allocs,
+				      "miss count");
+	dp_reo_qdesc_pool_test_expect(ctx,
+				      pool->release_cached +
+				      pool->release_freed == ctx->releases,
+				      "release counts");
+
+destroy:
+	dp_reo_qdesc_pool_destroy(ctx->soc);
+	dp_reo_qdesc_pool_test_expect(ctx, ctx->frees == ctx->allocs &&
+				      ctx->unmaps == ctx->maps,
+				      "descriptors leaked at destroy");
+
+	dp_reo_qdesc_pool_test_qref(ctx);
+	dp_reo_qdesc_pool_test_expect(ctx, ctx->frees == ctx->allocs &&
+				      ctx->unmaps == ctx->maps,
+				      "descriptors leaked with qref debug lists");
+
+	errors = ctx->errors;
+	dp_reo_qdesc_pool_test_ctx = NULL;
+	qdf_mem_free(ctx->soc->wlan_cfg_ctx);
+	qdf_mem_vfree(ctx->soc);
+	qdf_mem_vfree(ctx);
+
+	QDF_BUG(!errors);
+
+	return errors;
+}
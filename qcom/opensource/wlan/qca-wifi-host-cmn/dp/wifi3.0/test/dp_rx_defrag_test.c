@@ -0,0 +1,465 @@
+/*
+ * Copyright (c) 2024 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted, provided that the
+ * above copyright notice and this permission notice appear in all
+ * copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+ * AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR
+ * PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+ * TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "hal_hw_headers.h"
+#include "dp_types.h"
+#include "dp_rx.h"
+#include "dp_rx_defrag.h"
+#include "dp_rx_defrag_test.h"
+#include "qdf_mem.h"
+#include "qdf_nbuf.h"
+#include "qdf_str.h"
+#include "qdf_time.h"
+#include "qdf_trace.h"
+
+#define DP_RX_DEFRAG_TEST_TLV_SIZE 128
+/* TKIP IV and extended IV */
+#define DP_RX_DEFRAG_TEST_IV_LEN 8
+#define DP_RX_DEFRAG_TEST_HDRLEN (DP_RX_DEFRAG_TEST_TLV_SIZE + \
+				  sizeof(struct ieee80211_qosframe) + \
+				  DP_RX_DEFRAG_TEST_IV_LEN)
+#define DP_RX_DEFRAG_TEST_MIN_FRAGS 2
+#define DP_RX_DEFRAG_TEST_MAX_FRAGS 16
+#define DP_RX_DEFRAG_TEST_BUF_SIZE 2048
+/* data bytes in fragment i, lengths walk through every residue mod 4 */
+#define DP_RX_DEFRAG_TEST_FRAG_LEN(i) (61 + 7 * (i))
+#define DP_RX_DEFRAG_TEST_MAX_DATA \
+	(DP_RX_DEFRAG_TEST_FRAG_LEN(DP_RX_DEFRAG_TEST_MAX_FRAGS) * \
+	 DP_RX_DEFRAG_TEST_MAX_FRAGS)
+#define DP_RX_DEFRAG_TEST_PSEUDO_HDR_LEN 16
+#define DP_RX_DEFRAG_TEST_TID 5
+/* MSDUs timed per fragment count */
+#define DP_RX_DEFRAG_TEST_BENCH_ROUNDS 2000
+/* last fragment of the timed chains: 3 payload bytes, then the MIC */
+#define DP_RX_DEFRAG_TEST_BENCH_TAIL 11
+
+struct dp_rx_defrag_test_ctx {
+	struct dp_soc *soc;
+	struct rx_desc_pool pool;
+	uint8_t key[DEFRAG_IEEE80211_KEY_LEN];
+	uint8_t da[QDF_MAC_ADDR_SIZE];
+	uint8_t sa[QDF_MAC_ADDR_SIZE];
+	/* Michael pseudo header followed by the MSDU payload and the MIC */
+	uint8_t stream[DP_RX_DEFRAG_TEST_PSEUDO_HDR_LEN +
+		       DP_RX_DEFRAG_TEST_MAX_DATA];
+	qdf_nbuf_t frags[DP_RX_DEFRAG_TEST_MAX_FRAGS];
+};
+
+/**
+ * struct dp_rx_defrag_test_vector - Michael test vector
+ * @key: Michael key
+ * @msg: Message
+ * @mic: Expected MIC, the key of the next vector
+ */
+struct dp_rx_defrag_test_vector {
+	uint8_t key[DEFRAG_IEEE80211_KEY_LEN];
+	const char *msg;
+	uint8_t mic[IEEE80211_WEP_MICLEN];
+};
+
+/* IEEE Std 802.11 Michael test vectors */
+static const struct dp_rx_defrag_test_vector dp_rx_defrag_test_vectors[] = {
+	{ { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, "",
+	  { 0x82, 0x92, 0x5c, 0x1c, 0xa1, 0xd1, 0x30, 0xb8 } },
+	{ { 0x82, 0x92, 0x5c, 0x1c, 0xa1, 0xd1, 0x30, 0xb8 }, "M",
+	  { 0x43, 0x47, 0x21, 0xca, 0x40, 0x63, 0x9b, 0x3f } },
+	{ { 0x43, 0x47, 0x21, 0xca, 0x40, 0x63, 0x9b, 0x3f }, "Mi",
+	  { 0xe8, 0xf9, 0xbe, 0xca, 0xe9, 0x7e, 0x5d, 0x29 } },
+	{ { 0xe8, 0xf9, 0xbe, 0xca, 0xe9, 0x7e, 0x5d, 0x29 }, "Mic",
+	  { 0x90, 0x03, 0x8f, 0xc6, 0xcf, 0x13, 0xc1, 0xdb } },
+	{ { 0x90, 0x03, 0x8f, 0xc6, 0xcf, 0x13, 0xc1, 0xdb }, "Mich",
+	  { 0xd5, 0x5e, 0x10, 0x05, 0x10, 0x12, 0x89, 0x86 } },
+	{ { 0xd5, 0x5e, 0x10, 0x05, 0x10, 0x12, 0x89, 0x86 }, "Michael",
+	  { 0x0a, 0x94, 0x2b, 0x12, 0x4e, 0xca, 0xa5, 0x46 } },
+};
+
+static inline uint32_t dp_rx_defrag_test_rotl(uint32_t v, uint32_t n)
+{
+	return (v << n) | (v >> (32 - n));
+}
+
+static void dp_rx_defrag_test_block(uint32_t *l, uint32_t *r)
+{
+	*r ^= dp_rx_defrag_test_rotl(*l, 17);
+	*l += *r;
+	*r ^= ((*l & 0xff00ff00) >> 8) | ((*l & 0x00ff00ff) << 8);
+	*l += *r;
+	*r ^= dp_rx_defrag_test_rotl(*l, 3);
+	*l += *r;
+	*r ^= dp_rx_defrag_test_rotl(*l, 30);
+	*l += *r;
+}
+
+/**
+ * dp_rx_defrag_test_michael() - Reference Michael, one byte at a time
+ * @key: Michael key
+ * @data: Message
+ * @len: Message length
+ * @mic: Resulting MIC
+ *
+ * Written straight from the spec and independent of the word loads in
+ * dp_rx_defrag_mic(): 0x5a, then at least four zero bytes padding the
+ * message to a multiple of four.
+ *
+ * Return: void
+ */
+static void dp_rx_defrag_test_michael(const uint8_t *key, const uint8_t *data,
+				      uint32_t len, uint8_t *mic)
+{
+	uint32_t l = 0, r = 0, m = 0;
+	uint32_t i;
+	uint8_t b;
+
+	for (i = 0; i < 4; i++) {
+		l |= (uint32_t)key[i] << (8 * i);
+		r |= (uint32_t)key[4 + i] << (8 * i);
+	}
+
+	for (i = 0; i < len + 5 || (i & 3); i++) {
+		if (i < len)
+			b = data[i];
+		else
+			b = i == len ? 0x5a : 0;
+
+		m |= (uint32_t)b << (8 * (i & 3));
+		if ((i & 3) == 3) {
+			l ^= m;
+			dp_rx_defrag_test_block(&l, &r);
+			m = 0;
+		}
+	}
+
+	for (i = 0; i < 4; i++) {
+		mic[i] = (l >> (8 * i)) & 0xff;
+		mic[4 + i] = (r >> (8 * i)) & 0xff;
+	}
+}
+
+static uint32_t dp_rx_defrag_test_reference(void)
+{
+	const struct dp_rx_defrag_test_vector *vec;
+	uint8_t mic[IEEE80211_WEP_MICLEN];
+	uint32_t errors = 0;
+	uint32_t i;
+
+	for (i = 0; i < QDF_ARRAY_SIZE(dp_rx_defrag_test_vectors); i++) {
+		vec = &dp_rx_defrag_test_vectors[i];
+		dp_rx_defrag_test_michael(vec->key, (const uint8_t *)vec->msg,
+					  qdf_str_len(vec->msg), mic);
+		if (qdf_mem_cmp(mic, vec->mic, sizeof(mic))) {
+			qdf_nofl_err("Michael vector \"%s\" mismatch",
+				     vec->msg);
+			errors++;
+		}
+	}
+
+	return errors;
+}
+
+static void dp_rx_defrag_test_free(qdf_nbuf_t head)
+{
+	qdf_nbuf_t next;
+
+	while (head) {
+		next = qdf_nbuf_next(head);
+		dp_rx_nbuf_free(head);
+		head = next;
+	}
+}
+
+/**
+ * dp_rx_defrag_test_build() - Build a TKIP fragment chain
+ * @ctx: test context
+ * @num_frags: number of fragments
+ * @lead: extra bytes in the first fragment, shifts every word boundary
+ * @tail: data bytes in the last fragment, MIC included
+ * @data_len: total data bytes of the chain, MIC included
+ *
+ * The payload and MIC in ctx->stream are cut into fragments behind
+ * fake RX TLVs, a QoS data header and an IV, as dp_rx_defrag() hands
+ * them to dp_rx_defrag_tkip_demic() once FCS and IV checks are done.
+ *
+ * Return: head of the chain, NULL on allocation failure
+ */
+static qdf_nbuf_t dp_rx_defrag_test_build(struct dp_rx_defrag_test_ctx *ctx,
+					  uint32_t num_frags, uint32_t lead,
+					  uint32_t tail, uint32_t data_len)
+{
+	const uint8_t *data = &ctx->stream[DP_RX_DEFRAG_TEST_PSEUDO_HDR_LEN];
+	struct ieee80211_qosframe *wh;
+	uint32_t i, len;
+	uint8_t *buf;
+
+	for (i = 0; i < num_frags; i++) {
+		ctx->frags[i] = dp_rx_nbuf_alloc(ctx->soc, &ctx->pool);
+		if (!ctx->frags[i]) {
+			if (i)
+				dp_rx_defrag_test_free(ctx->frags[0]);
+			return NULL;
+		}
+
+		if (i == num_frags - 1)
+			len = tail;
+		else
+			len = DP_RX_DEFRAG_TEST_FRAG_LEN(i) + (i ? 0 : lead);
+
+		buf = qdf_nbuf_put_tail(ctx->frags[i],
+					DP_RX_DEFRAG_TEST_HDRLEN + len);
+		qdf_mem_zero(buf, DP_RX_DEFRAG_TEST_HDRLEN);
+
+		wh = (struct ieee80211_qosframe *)
+			(buf + DP_RX_DEFRAG_TEST_TLV_SIZE);
+		wh->i_fc[0] = IEEE80211_FC0_TYPE_DATA |
+			      QDF_IEEE80211_FC0_SUBTYPE_QOS;
+		wh->i_fc[1] = IEEE80211_FC1_DIR_NODS;
+		qdf_mem_copy(wh->i_addr1, ctx->da, QDF_MAC_ADDR_SIZE);
+		qdf_mem_copy(wh->i_addr2, ctx->sa, QDF_MAC_ADDR_SIZE);
+		wh->i_qos[0] = DP_RX_DEFRAG_TEST_TID;
+
+		qdf_mem_copy(buf + DP_RX_DEFRAG_TEST_HDRLEN, data, len);
+		data += len;
+
+		qdf_nbuf_set_next(ctx->frags[i], NULL);
+		if (i)
+			qdf_nbuf_set_next(ctx->frags[i - 1], ctx->frags[i]);
+	}
+
+	QDF_BUG(data == &ctx->stream[DP_RX_DEFRAG_TEST_PSEUDO_HDR_LEN +
+				     data_len]);
+
+	return ctx->frags[0];
+}
+
+/**
+ * dp_rx_defrag_test_fill() - Fill ctx->stream for one fragment layout
+ * @ctx: test context
+ * @num_frags: number of fragments
+ * @lead: extra bytes in the first fragment
+ * @tail: data bytes in the last fragment, MIC included
+ * @corrupt: flip a MIC bit
+ *
+ * Return: total data bytes of the chain, MIC included
+ */
+static uint32_t dp_rx_defrag_test_fill(struct dp_rx_defrag_test_ctx *ctx,
+				       uint32_t num_frags, uint32_t lead,
+				       uint32_t tail, bool corrupt)
+{
+	uint8_t *hdr = ctx->stream;
+	uint8_t *payload = &ctx->stream[DP_RX_DEFRAG_TEST_PSEUDO_HDR_LEN];
+	uint32_t data_len, payload_len;
+	uint32_t i;
+
+	data_len = lead + tail;
+	for (i = 0; i < num_frags - 1; i++)
+		data_len += DP_RX_DEFRAG_TEST_FRAG_LEN(i);
+	payload_len = data_len - IEEE80211_WEP_MICLEN;
+
+	/* pseudo header: DA, SA, priority, 3 x 0 */
+	qdf_mem_copy(hdr, ctx->da, QDF_MAC_ADDR_SIZE);
+	qdf_mem_copy(hdr + QDF_MAC_ADDR_SIZE, ctx->sa, QDF_MAC_ADDR_SIZE);
+	hdr[12] = DP_RX_DEFRAG_TEST_TID;
+	hdr[13] = hdr[14] = hdr[15] = 0;
+
+	for (i = 0; i < payload_len; i++)
+		payload[i] = (i * 37 + num_frags * 11 + lead) & 0xff;
+
+	dp_rx_defrag_test_michael(ctx->key, ctx->stream,
+				  DP_RX_DEFRAG_TEST_PSEUDO_HDR_LEN +
+				  payload_len, &payload[payload_len]);
+	if (corrupt)
+		payload[payload_len + num_frags % IEEE80211_WEP_MICLEN] ^= 0x10;
+
+	return data_len;
+}
+
+/**
+ * dp_rx_defrag_test_chain() - Check one fragment layout
+ * @ctx: test context
+ * @num_frags: number of fragments
+ * @lead: extra bytes in the first fragment
+ * @tail: data bytes in the last fragment, MIC included
+ * @corrupt: flip a MIC bit, the chain must then be rejected
+ *
+ * Return: number of failures
+ */
+static uint32_t dp_rx_defrag_test_chain(struct dp_rx_defrag_test_ctx *ctx,
+					uint32_t num_frags, uint32_t lead,
+					uint32_t tail, bool corrupt)
+{
+	uint32_t data_len, payload_len, left = 0;
+	qdf_nbuf_t head, nbuf;
+	QDF_STATUS status;
+
+	data_len = dp_rx_defrag_test_fill(ctx, num_frags, lead, tail, corrupt);
+	payload_len = data_len - IEEE80211_WEP_MICLEN;
+
+	head = dp_rx_defrag_test_build(ctx, num_frags, lead, tail, data_len);
+	if (!head)
+		return 1;
+
+	status = dp_rx_defrag_tkip_demic_test(ctx->soc, ctx->key, head,
+					      DP_RX_DEFRAG_TEST_HDRLEN);
+
+	for (nbuf = head; nbuf; nbuf = qdf_nbuf_next(nbuf))
+		left += qdf_nbuf_len(nbuf) - DP_RX_DEFRAG_TEST_HDRLEN;
+
+	dp_rx_defrag_test_free(head);
+
+	if (corrupt != QDF_IS_STATUS_ERROR(status)) {
+		qdf_nofl_err("%u frags lead %u tail %u corrupt %d: status %d",
+			     num_frags, lead, tail, corrupt, status);
+		return 1;
+	}
+
+	if (!corrupt && left != payload_len) {
+		qdf_nofl_err("%u frags lead %u tail %u: %u bytes left, want %u",
+			     num_frags, lead, tail, left, payload_len);
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * dp_rx_defrag_test_bench() - Time the demic of one fragment count
+ * @ctx: test context
+ * @num_frags: number of fragments
+ *
+ * Only the dp_rx_defrag_tkip_demic() call is timed, building and freeing
+ * the chains is not. The byte at a time reference Michael over the same
+ * bytes in one flat buffer is timed next to it, each round keyed with
+ * the MIC of the previous one so that no round can be left out.
+ *
+ * Return: number of failures
+ */
+static uint32_t dp_rx_defrag_test_bench(struct dp_rx_defrag_test_ctx *ctx,
+					uint32_t num_frags)
+{
+	uint8_t key[DEFRAG_IEEE80211_KEY_LEN];
+	uint32_t data_len, payload_len, round;
+	uint64_t demic_ns = 0, ref_ns;
+	uint32_t errors = 0;
+	qdf_ktime_t start;
+	qdf_nbuf_t head;
+	QDF_STATUS status;
+
+	data_len = dp_rx_defrag_test_fill(ctx, num_frags, 0,
+					  DP_RX_DEFRAG_TEST_BENCH_TAIL, false);
+	payload_len = data_len - IEEE80211_WEP_MICLEN;
+
+	for (round = 0; round < DP_RX_DEFRAG_TEST_BENCH_ROUNDS; round++) {
+		head = dp_rx_defrag_test_build(ctx, num_frags, 0,
+					       DP_RX_DEFRAG_TEST_BENCH_TAIL,
+					       data_len);
+		if (!head)
+			return errors + 1;
+
+		start = qdf_ktime_get();
+		status = dp_rx_defrag_tkip_demic_test(ctx->soc, ctx->key, head,
+						      DP_RX_DEFRAG_TEST_HDRLEN);
+		demic_ns += qdf_ktime_to_ns(qdf_ktime_get()) -
+			    qdf_ktime_to_ns(start);
+
+		dp_rx_defrag_test_free(head);
+		if (QDF_IS_STATUS_ERROR(status))
+			errors++;
+	}
+
+	qdf_mem_copy(key, ctx->key, sizeof(key));
+	start = qdf_ktime_get();
+	for (round = 0; round < DP_RX_DEFRAG_TEST_BENCH_ROUNDS; round++)
+		dp_rx_defrag_test_michael(key, ctx->stream,
+					  DP_RX_DEFRAG_TEST_PSEUDO_HDR_LEN +
+					  payload_len, key);
+	ref_ns = qdf_ktime_to_ns(qdf_ktime_get()) - qdf_ktime_to_ns(start);
+
+	qdf_nofl_info("%u frags, %u bytes: demic %llu ns/MSDU, reference %llu ns/MSDU, key %02x",
+		      num_frags, payload_len,
+		      qdf_do_div(demic_ns, DP_RX_DEFRAG_TEST_BENCH_ROUNDS),
+		      qdf_do_div(ref_ns, DP_RX_DEFRAG_TEST_BENCH_ROUNDS),
+		      key[0]);
+
+	if (errors)
+		qdf_nofl_err("%u frags: %u of %u timed chains rejected",
+			     num_frags, errors, DP_RX_DEFRAG_TEST_BENCH_ROUNDS);
+
+	return errors;
+}
+
+/*
+ * Bytes in the last fragment: MIC split over the last two fragments,
+ * MIC alone in the last fragment (which is then dropped), and MIC after
+ * the 1 to 3 payload bytes of a last partial Michael block.
+ */
+static const uint32_t dp_rx_defrag_test_tails[] = { 1, 3, 8, 9, 10, 11 };
+
+uint32_t dp_rx_defrag_unit_test(void)
+{
+	struct dp_rx_defrag_test_ctx *ctx;
+	uint32_t num_frags, lead, i;
+	uint32_t errors = 0;
+
+	errors += dp_rx_defrag_test_reference();
+
+	ctx = qdf_mem_valloc(sizeof(*ctx));
+	if (!ctx)
+		return errors + 1;
+
+	ctx->soc = qdf_mem_valloc(sizeof(*ctx->soc));
+	if (!ctx->soc) {
+		qdf_mem_vfree(ctx);
+		return errors + 1;
+	}
+
+	ctx->soc->rx_pkt_tlv_size = DP_RX_DEFRAG_TEST_TLV_SIZE;
+	ctx->pool.buf_size = DP_RX_DEFRAG_TEST_BUF_SIZE;
+	ctx->pool.buf_alignment = sizeof(uint32_t);
+	for (i = 0; i < DEFRAG_IEEE80211_KEY_LEN; i++)
+		ctx->key[i] = 0xa0 + i;
+	for (i = 0; i < QDF_MAC_ADDR_SIZE; i++) {
+		ctx->da[i] = 0x10 + i;
+		ctx->sa[i] = 0x20 + i;
+	}
+
+	for (num_frags = DP_RX_DEFRAG_TEST_MIN_FRAGS;
+	     num_frags <= DP_RX_DEFRAG_TEST_MAX_FRAGS; num_frags++) {
+		for (lead = 0; lead < sizeof(uint32_t); lead++) {
+			for (i = 0; i < QDF_ARRAY_SIZE(dp_rx_defrag_test_tails);
+			     i++) {
+				errors += dp_rx_defrag_test_chain(ctx,
+						num_frags, lead,
+						dp_rx_defrag_test_tails[i],
+						false);
+				errors += dp_rx_defrag_test_chain(ctx,
+						num_frags, lead,
+						dp_rx_defrag_test_tails[i],
+						true);
+			}
+		}
+	}
+
+	for (num_frags = DP_RX_DEFRAG_TEST_MIN_FRAGS;
+	     num_frags <= DP_RX_DEFRAG_TEST_MAX_FRAGS; num_frags++)
+		errors += dp_rx_defrag_test_bench(ctx, num_frags);
+
+	QDF_BUG(!errors);
+	qdf_mem_vfree(ctx->soc);
+	qdf_mem_vfree(ctx);
+
+	return errors;
+}
@@ -0,0 +1,262 @@
+/*
+ * Copyright (c) 2024 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted, provided that the
+ * above copyright notice and this permission notice appear in all
+ * copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+ * AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR
+ * PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+ * TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "dp_types.h"
+#include "dp_internal.h"
+#include "dp_stats_pcpu_test.h"
+#include "qdf_mem.h"
+#include "qdf_threads.h"
+#include "qdf_time.h"
+#include "qdf_trace.h"
+
+#define DP_STATS_PCPU_TEST_ITERS (1 << 20)
+#define DP_STATS_PCPU_TEST_MAX_WRITERS 8
+#define DP_STATS_PCPU_TEST_LINKS 2
+#define DP_STATS_PCPU_TEST_BYTES 1500
+#define DP_STATS_PCPU_TEST_PEER_STATS_SIZE \
+	(DP_STATS_PCPU_TEST_LINKS * sizeof(struct dp_peer_stats))
+
+struct dp_stats_pcpu_test_ctx {
+	struct dp_soc *soc;
+	struct dp_txrx_peer *txrx_peer;
+	/* backends of the handles, taken away for the direct runs */
+	struct dp_stats_pcpu *soc_pcs;
+	struct dp_stats_pcpu *peer_pcs;
+	uint32_t handle_evals;
+};
+
+struct dp_stats_pcpu_test_writer {
+	struct dp_stats_pcpu_test_ctx *ctx;
+	uint8_t link;
+};
+
+/* what the TX completion path counts for every packet */
+static QDF_STATUS dp_stats_pcpu_test_writer_thread(void *context)
+{
+	struct dp_stats_pcpu_test_writer *writer = context;
+	struct dp_soc *soc = writer->ctx->soc;
+	struct dp_txrx_peer *txrx_peer = writer->ctx->txrx_peer;
+	uint8_t link = writer->link;
+	uint32_t i;
+
+	for (i = 0; i < DP_STATS_PCPU_TEST_ITERS; i++) {
+		DP_STATS_INC_PKT(soc, tx.egress[0], 1,
+				 DP_STATS_PCPU_TEST_BYTES);
+		DP_PEER_PER_PKT_STATS_INC_PKT(txrx_peer, tx.ucast, 1,
+					      DP_STATS_PCPU_TEST_BYTES, link);
+	}
+
+	return QDF_STATUS_SUCCESS;
+}
+
+static struct dp_soc *
+dp_stats_pcpu_test_get_soc(struct dp_stats_pcpu_test_ctx *ctx)
+{
+	ctx->handle_evals++;
+
+	return ctx->soc;
+}
+
+/*
+ * Hot counters only show up in the stats once folded, the others are
+ * written straight through, and each link folds into its own element.
+ */
+static uint32_t dp_stats_pcpu_test_window(struct dp_stats_pcpu_test_ctx *ctx)
+{
+	struct dp_soc *soc = ctx->soc;
+	struct dp_txrx_peer *txrx_peer = ctx->txrx_peer;
+	uint32_t errors = 0;
+
+	DP_STATS_CLR(soc);
+	DP_TXRX_PEER_STATS_CLR(txrx_peer, DP_STATS_PCPU_TEST_PEER_STATS_SIZE);
+
+	DP_STATS_INC(soc, ast.added, 1);
+	DP_STATS_INC(soc, tx.tcl_enq[0], 1);
+	DP_PEER_PER_PKT_STATS_INC(txrx_peer, tx.ucast.num, 1, 1);
+#ifndef QCA_ENHANCED_STATS_SUPPORT
+	DP_PEER_EXTD_STATS_INC(txrx_peer, tx.retries, 1, 1);
+	if (txrx_peer->stats[1].extd_stats.tx.retries != 1)
+		errors++;
+#endif
+	if (soc->stats.ast.added != 1 || soc->stats.tx.tcl_enq[0] ||
+	    txrx_peer->stats[1].per_pkt_stats.tx.ucast.num)
+		errors++;
+
+	ctx->handle_evals = 0;
+	DP_STATS_PCPU_FOLD(dp_stats_pcpu_test_get_soc(ctx));
+	DP_STATS_PCPU_FOLD(txrx_peer);
+	if (ctx->handle_evals != 1)
+		errors++;
+
+	if (soc->stats.ast.added != 1 || soc->stats.tx.tcl_enq[0] != 1 ||
+	    txrx_peer->stats[0].per_pkt_stats.tx.ucast.num ||
+	    txrx_peer->stats[1].per_pkt_stats.tx.ucast.num != 1)
+		errors++;
+
+	if (errors)
+		qdf_nofl_err("dp_stats_pcpu: hot window routing, %u errors",
+			     errors);
+
+	return errors;
+}
+
+static uint32_t dp_stats_pcpu_test_run(struct dp_stats_pcpu_test_ctx *ctx,
+				       uint32_t num_writers, bool pcpu)
+{
+	struct dp_stats_pcpu_test_writer *writers;
+	qdf_thread_t *threads[DP_STATS_PCPU_TEST_MAX_WRITERS];
+	struct dp_soc *soc = ctx->soc;
+	struct dp_txrx_peer *txrx_peer = ctx->txrx_peer;
+	uint64_t expected, soc_pkts, peer_pkts = 0;
+	uint64_t link_expected[DP_STATS_PCPU_TEST_LINKS] = { 0 };
+	qdf_ktime_t start;
+	int64_t elapsed_us;
+	uint32_t errors = 0;
+	uint32_t i;
+
+	writers = qdf_mem_malloc(num_writers * sizeof(*writers));
+	if (!writers)
+		return 1;
+
+	soc->stats_pcpu = pcpu ? ctx->soc_pcs : NULL;
+	txrx_peer->stats_pcpu = pcpu ? ctx->peer_pcs : NULL;
+	DP_STATS_CLR(soc);
+	DP_TXRX_PEER_STATS_CLR(txrx_peer, DP_STATS_PCPU_TEST_PEER_STATS_SIZE);
+
+	start = qdf_ktime_get();
+	for (i = 0; i < num_writers; i++) {
+		writers[i].ctx = ctx;
+		writers[i].link = i % DP_STATS_PCPU_TEST_LINKS;
+		threads[i] = qdf_thread_run(dp_stats_pcpu_test_writer_thread,
+					    &writers[i]);
+		QDF_BUG(threads[i]);
+		if (!threads[i])
+			num_writers = i;
+	}
+
+	for (i = 0; i < num_writers; i++) {
+		qdf_thread_join(threads[i]);
+		link_expected[writers[i].link] += DP_STATS_PCPU_TEST_ITERS;
+	}
+	elapsed_us = qdf_ktime_to_us(qdf_ktime_get()) - qdf_ktime_to_us(start);
+	qdf_mem_free(writers);
+
+	expected = (uint64_t)num_writers * DP_STATS_PCPU_TEST_ITERS;
+	if (pcpu) {
+		if (soc->stats.tx.egress[0].num)
+			errors++;
+		DP_STATS_PCPU_FOLD(soc);
+		DP_STATS_PCPU_FOLD(txrx_peer);
+	}
+
+	soc_pkts = soc->stats.tx.egress[0].num;
+	for (i = 0; i < DP_STATS_PCPU_TEST_LINKS; i++) {
+		peer_pkts += txrx_peer->stats[i].per_pkt_stats.tx.ucast.num;
+		/* the per-CPU copies must not lose a single update */
+		if (pcpu &&
+		    (txrx_peer->stats[i].per_pkt_stats.tx.ucast.num !=
+		     link_expected[i] ||
+		     txrx_peer->stats[i].per_pkt_stats.tx.ucast.bytes !=
+		     link_expected[i] * DP_STATS_PCPU_TEST_BYTES))
+			errors++;
+	}
+	if (pcpu && (soc_pkts != expected ||
+		     soc->stats.tx.egress[0].bytes !=
+		     expected * DP_STATS_PCPU_TEST_BYTES))
+		errors++;
+
+	/* direct updates race, report what they lost */
+	qdf_nofl_info("dp_stats_pcpu: %u writers %s: %lld us, %llu ns per packet, %llu soc %llu peer updates lost, %u errors",
+		      num_writers, pcpu ? "per-CPU" : "direct", elapsed_us,
+		      (unsigned long long)(elapsed_us * 1000 /
+					   DP_STATS_PCPU_TEST_ITERS),
+		      (unsigned long long)(expected - soc_pkts),
+		      (unsigned long long)(expected - peer_pkts), errors);
+
+	return errors;
+}
+
+static QDF_STATUS dp_stats_pcpu_test_setup(struct dp_stats_pcpu_test_ctx *ctx)
+{
+	ctx->soc = qdf_mem_valloc(sizeof(*ctx->soc));
+	if (!ctx->soc)
+		return QDF_STATUS_E_NOMEM;
+
+	ctx->txrx_peer = qdf_mem_malloc(sizeof(*ctx->txrx_peer) +
+					DP_STATS_PCPU_TEST_PEER_STATS_SIZE);
+	if (!ctx->txrx_peer)
+		return QDF_STATUS_E_NOMEM;
+
+	ctx->txrx_peer->stats_arr_size = DP_STATS_PCPU_TEST_LINKS;
+	DP_STATS_PCPU_ATTACH(ctx->soc, tx, rx);
+	DP_TXRX_PEER_STATS_PCPU_ATTACH(ctx->txrx_peer,
+				       DP_STATS_PCPU_TEST_LINKS);
+	ctx->soc_pcs = ctx->soc->stats_pcpu;
+	ctx->peer_pcs = ctx->txrx_peer->stats_pcpu;
+	if (!ctx->soc_pcs || !ctx->peer_pcs)
+		return QDF_STATUS_E_NOMEM;
+
+	return QDF_STATUS_SUCCESS;
+}
+
+static void dp_stats_pcpu_test_teardown(struct dp_stats_pcpu_test_ctx *ctx)
+{
+	if (ctx->txrx_peer) {
+		ctx->txrx_peer->stats_pcpu = ctx->peer_pcs;
+		DP_STATS_PCPU_DETACH(ctx->txrx_peer);
+		qdf_mem_free(ctx->txrx_peer);
+	}
+	if (ctx->soc) {
+		ctx->soc->stats_pcpu = ctx->soc_pcs;
+		DP_STATS_PCPU_DETACH(ctx->soc);
+		qdf_mem_vfree(ctx->soc);
+	}
+}
+
+uint32_t dp_stats_pcpu_unit_test(void)
+{
+	struct dp_stats_pcpu_test_ctx *ctx;
+	uint32_t num_writers;
+	uint32_t errors = 0;
+
+	ctx = qdf_mem_malloc(sizeof(*ctx));
+	if (!ctx)
+		return 1;
+
+	if (QDF_IS_STATUS_ERROR(dp_stats_pcpu_test_setup(ctx))) {
+		errors++;
+		goto teardown;
+	}
+
+	errors += dp_stats_pcpu_test_window(ctx);
+
+	for (num_writers = 1;
+	     num_writers <= DP_STATS_PCPU_TEST_MAX_WRITERS;
+	     num_writers <<= 1) {
+		errors += dp_stats_pcpu_test_run(ctx, num_writers, false);
+		errors += dp_stats_pcpu_test_run(ctx, num_writers, true);
+	}
+
+teardown:
+	dp_stats_pcpu_test_teardown(ctx);
+	qdf_mem_free(ctx);
+
+	QDF_BUG(!errors);
+
+	return errors;
+}
@@ -0,0 +1,434 @@
+/*
+ * Copyright (c) 2024 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted, provided that the
+ * above copyright notice and this permission notice appear in all
+ * copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+ * AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR
+ * PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+ * TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "dp_types.h"
+#include "dp_tx.h"
+#include "dp_tx_desc.h"
+#include "dp_tx_desc_cache_test.h"
+#include "qdf_atomic.h"
+#include "qdf_defer.h"
+#include "qdf_mem.h"
+#include "qdf_threads.h"
+#include "qdf_time.h"
+#include "qdf_trace.h"
+
+#define DP_TX_DESC_CACHE_TEST_POOL 0
+#define DP_TX_DESC_CACHE_TEST_POOL_SIZE 1024
+#define DP_TX_DESC_CACHE_TEST_STOP_TH 128
+#define DP_TX_DESC_CACHE_TEST_START_TH 192
+/* more than one cache holds, so every round spills a batch to the pool */
+#define DP_TX_DESC_CACHE_TEST_BURST (DP_TX_DESC_CACHE_SIZE + 8)
+#define DP_TX_DESC_CACHE_TEST_ROUNDS 2000
+#define DP_TX_DESC_CACHE_TEST_MAX_THREADS 4
+
+#ifdef QCA_AC_BASED_FLOW_CONTROL
+#define DP_TX_DESC_CACHE_TEST_LEVELS FL_TH_MAX
+/* the first queue is stopped when BE/BK hits its threshold ... */
+#define DP_TX_DESC_CACHE_TEST_PAUSE_AVAIL DP_TX_DESC_CACHE_TEST_STOP_TH
+/* ... and the first one woken is the high priority one */
+#define DP_TX_DESC_CACHE_TEST_RESUME_AVAIL \
+	(DP_TX_DESC_CACHE_TEST_START_TH - 16 * DP_TH_HI + 1)
+
+static void dp_tx_desc_cache_test_set_th(struct dp_tx_desc_pool_s *pool)
+{
+	int level;
+
+	for (level = DP_TH_BE_BK; level < FL_TH_MAX; level++) {
+		pool->stop_th[level] = DP_TX_DESC_CACHE_TEST_STOP_TH -
+				       16 * level;
+		pool->start_th[level] = DP_TX_DESC_CACHE_TEST_START_TH -
+					16 * level;
+	}
+}
+
+static bool dp_tx_desc_cache_test_is_pause(enum netif_action_type action)
+{
+	return action == WLAN_NETIF_BE_BK_QUEUE_OFF ||
+	       action == WLAN_NETIF_VI_QUEUE_OFF ||
+	       action == WLAN_NETIF_VO_QUEUE_OFF ||
+	       action == WLAN_NETIF_PRIORITY_QUEUE_OFF;
+}
+#else
+#define DP_TX_DESC_CACHE_TEST_LEVELS 1
+#define DP_TX_DESC_CACHE_TEST_PAUSE_AVAIL (DP_TX_DESC_CACHE_TEST_STOP_TH - 1)
+#define DP_TX_DESC_CACHE_TEST_RESUME_AVAIL (DP_TX_DESC_CACHE_TEST_START_TH + 1)
+
+static void dp_tx_desc_cache_test_set_th(struct dp_tx_desc_pool_s *pool)
+{
+	pool->stop_th = DP_TX_DESC_CACHE_TEST_STOP_TH;
+	pool->start_th = DP_TX_DESC_CACHE_TEST_START_TH;
+}
+
+static bool dp_tx_desc_cache_test_is_pause(enum netif_action_type action)
+{
+	return action == WLAN_STOP_ALL_NETIF_QUEUE;
+}
+#endif
+
+struct dp_tx_desc_cache_test_ctx {
+	struct dp_soc *soc;
+	struct dp_tx_desc_pool_s *pool;
+	struct dp_tx_desc_s *descs;
+	struct dp_tx_desc_s *held[DP_TX_DESC_CACHE_TEST_POOL_SIZE];
+	uint8_t seen[DP_TX_DESC_CACHE_TEST_POOL_SIZE];
+};
+
+struct dp_tx_desc_cache_test_worker {
+	struct dp_tx_desc_cache_test_ctx *ctx;
+	struct dp_tx_desc_s *held[DP_TX_DESC_CACHE_TEST_BURST];
+	uint32_t no_desc;
+	uint32_t errors;
+};
+
+/* pause_cb carries no context, the test owns the single pool of its soc */
+static struct dp_tx_desc_cache_test_ctx *dp_tx_desc_cache_test_cur;
+static qdf_atomic_t dp_tx_desc_cache_test_pauses;
+static qdf_atomic_t dp_tx_desc_cache_test_resumes;
+static int32_t dp_tx_desc_cache_test_pause_avail;
+static int32_t dp_tx_desc_cache_test_resume_avail;
+
+static void dp_tx_desc_cache_test_pause_cb(uint8_t vdev_id,
+					   enum netif_action_type action,
+					   enum netif_reason_type reason)
+{
+	struct dp_tx_desc_pool_s *pool = dp_tx_desc_cache_test_cur->pool;
+
+	if (dp_tx_desc_cache_test_is_pause(action)) {
+		if (!qdf_atomic_read(&dp_tx_desc_cache_test_pauses))
+			dp_tx_desc_cache_test_pause_avail = pool->avail_desc;
+		qdf_atomic_inc(&dp_tx_desc_cache_test_pauses);
+	} else {
+		if (!qdf_atomic_read(&dp_tx_desc_cache_test_resumes))
+			dp_tx_desc_cache_test_resume_avail = pool->avail_desc;
+		qdf_atomic_inc(&dp_tx_desc_cache_test_resumes);
+	}
+}
+
+static void dp_tx_desc_cache_test_reset_cb(void)
+{
+	qdf_atomic_init(&dp_tx_desc_cache_test_pauses);
+	qdf_atomic_init(&dp_tx_desc_cache_test_resumes);
+	dp_tx_desc_cache_test_pause_avail = -1;
+	dp_tx_desc_cache_test_resume_avail = -1;
+}
+
+static int32_t
+dp_tx_desc_cache_test_index(struct dp_tx_desc_cache_test_ctx *ctx,
+			    struct dp_tx_desc_s *tx_desc)
+{
+	if (tx_desc < ctx->descs ||
+	    tx_desc >= ctx->descs + DP_TX_DESC_CACHE_TEST_POOL_SIZE)
+		return -1;
+
+	return tx_desc - ctx->descs;
+}
+
+/*
+ * Flush every cache and walk the pool: each descriptor must be back on
+ * the freelist exactly once and accounted for in avail_desc.
+ */
+static uint32_t
+dp_tx_desc_cache_test_check_idle(struct dp_tx_desc_cache_test_ctx *ctx)
+{
+	struct dp_tx_desc_pool_s *pool = ctx->pool;
+	struct dp_tx_desc_s *tx_desc;
+	uint32_t errors = 0;
+	uint32_t count = 0;
+	int32_t idx;
+
+	dp_tx_desc_cache_flush(ctx->soc, pool, false);
+
+	qdf_mem_zero(ctx->seen, sizeof(ctx->seen));
+	qdf_spin_lock_bh(&pool->flow_pool_lock);
+	for (tx_desc = pool->freelist; tx_desc; tx_desc = tx_desc->next) {
+		idx = dp_tx_desc_cache_test_index(ctx, tx_desc);
+		if (idx < 0 || ctx->seen[idx] ||
+		    count == DP_TX_DESC_CACHE_TEST_POOL_SIZE) {
+			errors++;
+			break;
+		}
+		ctx->seen[idx] = 1;
+		count++;
+	}
+	qdf_spin_unlock_bh(&pool->flow_pool_lock);
+
+	if (errors || count != DP_TX_DESC_CACHE_TEST_POOL_SIZE ||
+	    pool->avail_desc != DP_TX_DESC_CACHE_TEST_POOL_SIZE ||
+	    pool->status != FLOW_POOL_ACTIVE_UNPAUSED) {
+		qdf_nofl_err("idle pool: %u on freelist avail %u status %d",
+			     count, pool->avail_desc, pool->status);
+		errors++;
+	}
+
+	return errors;
+}
+
+/*
+ * Take every descriptor and give them all back from one CPU, so the
+ * caches of other CPUs cannot hide any. The pool must cross each stop
+ * and start threshold exactly where the locked path alone would.
+ */
+static uint32_t
+dp_tx_desc_cache_test_drain(struct dp_tx_desc_cache_test_ctx *ctx)
+{
+	struct dp_tx_desc_s *tx_desc;
+	uint32_t errors = 0;
+	uint32_t held = 0;
+	int32_t idx;
+
+	dp_tx_desc_cache_test_reset_cb();
+	qdf_mem_zero(ctx->seen, sizeof(ctx->seen));
+
+	qdf_local_bh_disable();
+	while (held < DP_TX_DESC_CACHE_TEST_POOL_SIZE) {
+		tx_desc = dp_tx_desc_alloc(ctx->soc,
+					   DP_TX_DESC_CACHE_TEST_POOL);
+		if (!tx_desc)
+			break;
+
+		idx = dp_tx_desc_cache_test_index(ctx, tx_desc);
+		if (idx < 0 || ctx->seen[idx] ||
+		    tx_desc->flags != DP_TX_DESC_FLAG_ALLOCATED) {
+			errors++;
+			continue;
+		}
+		ctx->seen[idx] = 1;
+		ctx->held[held++] = tx_desc;
+	}
+	if (dp_tx_desc_alloc(ctx->soc, DP_TX_DESC_CACHE_TEST_POOL))
+		errors++;
+	qdf_local_bh_enable();
+
+	if (errors || held != DP_TX_DESC_CACHE_TEST_POOL_SIZE ||
+	    qdf_atomic_read(&dp_tx_desc_cache_test_pauses) !=
+	    DP_TX_DESC_CACHE_TEST_LEVELS ||
+	    dp_tx_desc_cache_test_pause_avail !=
+	    DP_TX_DESC_CACHE_TEST_PAUSE_AVAIL) {
+		qdf_nofl_err("drain: %u bad descs, %u allocated, %d pauses, first at %d",
+			     errors, held,
+			     qdf_atomic_read(&dp_tx_desc_cache_test_pauses),
+			     dp_tx_desc_cache_test_pause_avail);
+		errors++;
+	}
+
+	qdf_local_bh_disable();
+	while (held)
+		dp_tx_desc_free(ctx->soc, ctx->held[--held],
+				DP_TX_DESC_CACHE_TEST_POOL);
+	qdf_local_bh_enable();
+
+	if (qdf_atomic_read(&dp_tx_desc_cache_test_resumes) !=
+	    DP_TX_DESC_CACHE_TEST_LEVELS ||
+	    dp_tx_desc_cache_test_resume_avail !=
+	    DP_TX_DESC_CACHE_TEST_RESUME_AVAIL) {
+		qdf_nofl_err("drain: %d resumes, first at %d",
+			     qdf_atomic_read(&dp_tx_desc_cache_test_resumes),
+			     dp_tx_desc_cache_test_resume_avail);
+		errors++;
+	}
+
+	return errors + dp_tx_desc_cache_test_check_idle(ctx);
+}
+
+static QDF_STATUS dp_tx_desc_cache_test_worker_thread(void *context)
+{
+	struct dp_tx_desc_cache_test_worker *worker = context;
+	struct dp_tx_desc_cache_test_ctx *ctx = worker->ctx;
+	struct dp_soc *soc = ctx->soc;
+	struct dp_tx_desc_s *tx_desc;
+	uint32_t round, i, held;
+
+	for (round = 0; round < DP_TX_DESC_CACHE_TEST_ROUNDS; round++) {
+		held = 0;
+		for (i = 0; i < DP_TX_DESC_CACHE_TEST_BURST; i++) {
+			tx_desc = dp_tx_desc_alloc(soc,
+						   DP_TX_DESC_CACHE_TEST_POOL);
+			if (!tx_desc) {
+				worker->no_desc++;
+				continue;
+			}
+
+			/* a descriptor handed out twice is still tagged */
+			if (dp_tx_desc_cache_test_index(ctx, tx_desc) < 0 ||
+			    tx_desc->nbuf ||
+			    tx_desc->flags != DP_TX_DESC_FLAG_ALLOCATED) {
+				worker->errors++;
+				continue;
+			}
+			tx_desc->nbuf = (qdf_nbuf_t)worker;
+			worker->held[held++] = tx_desc;
+		}
+
+		/* free in allocation order, the opposite of the cache LIFO */
+		for (i = 0; i < held; i++) {
+			tx_desc = worker->held[i];
+			if (tx_desc->nbuf != (qdf_nbuf_t)worker)
+				worker->errors++;
+			dp_tx_desc_free(soc, tx_desc,
+					DP_TX_DESC_CACHE_TEST_POOL);
+		}
+	}
+
+	return QDF_STATUS_SUCCESS;
+}
+
+static uint32_t
+dp_tx_desc_cache_test_churn(struct dp_tx_desc_cache_test_ctx *ctx,
+			    uint32_t num_workers, bool cached)
+{
+	struct dp_tx_desc_cache_test_worker *workers;
+	qdf_thread_t *threads[DP_TX_DESC_CACHE_TEST_MAX_THREADS];
+	qdf_ktime_t start;
+	int64_t elapsed_us;
+	uint32_t no_desc = 0;
+	uint32_t errors = 0;
+	uint32_t i;
+
+	workers = qdf_mem_malloc(num_workers * sizeof(*workers));
+	if (!workers)
+		return 1;
+
+	if (cached)
+		dp_tx_desc_cache_enable(ctx->pool);
+	else
+		dp_tx_desc_cache_flush(ctx->soc, ctx->pool, true);
+	dp_tx_desc_cache_test_reset_cb();
+
+	start = qdf_ktime_get();
+	for (i = 0; i < num_workers; i++) {
+		workers[i].ctx = ctx;
+		threads[i] = qdf_thread_run(dp_tx_desc_cache_test_worker_thread,
+					    &workers[i]);
+		QDF_BUG(threads[i]);
+		if (!threads[i])
+			num_workers = i;
+	}
+
+	for (i = 0; i < num_workers; i++) {
+		qdf_thread_join(threads[i]);
+		no_desc += workers[i].no_desc;
+		errors += workers[i].errors;
+	}
+	elapsed_us = qdf_ktime_to_us(qdf_ktime_get()) - qdf_ktime_to_us(start);
+	qdf_mem_free(workers);
+
+	/* the pool never runs dry with this few descriptors in flight */
+	if (no_desc)
+		errors++;
+
+	/* every queue stopped on the way must be woken once all is back */
+	errors += dp_tx_desc_cache_test_check_idle(ctx);
+	if (qdf_atomic_read(&dp_tx_desc_cache_test_pauses) !=
+	    qdf_atomic_read(&dp_tx_desc_cache_test_resumes))
+		errors++;
+
+	qdf_nofl_info("dp_tx_desc_cache: %u threads cache %s %lld us %u misses %u errors",
+		      num_workers, cached ? "on" : "off", elapsed_us, no_desc,
+		      errors);
+
+	return errors;
+}
+
+static QDF_STATUS
+dp_tx_desc_cache_test_setup(struct dp_tx_desc_cache_test_ctx *ctx)
+{
+	struct dp_tx_desc_pool_s *pool;
+	uint32_t i;
+
+	ctx->soc = qdf_mem_valloc(sizeof(*ctx->soc));
+	if (!ctx->soc)
+		return QDF_STATUS_E_NOMEM;
+
+	ctx->descs = qdf_mem_malloc(DP_TX_DESC_CACHE_TEST_POOL_SIZE *
+				    sizeof(*ctx->descs));
+	if (!ctx->descs)
+		return QDF_STATUS_E_NOMEM;
+
+	for (i = 0; i < DP_TX_DESC_CACHE_TEST_POOL_SIZE - 1; i++)
+		ctx->descs[i].next = &ctx->descs[i + 1];
+
+	pool = &ctx->soc->tx_desc[DP_TX_DESC_CACHE_TEST_POOL];
+	pool->elem_size = sizeof(*ctx->descs);
+	pool->freelist = ctx->descs;
+	pool->flow_pool_id = DP_TX_DESC_CACHE_TEST_POOL;
+	pool->pool_size = DP_TX_DESC_CACHE_TEST_POOL_SIZE;
+	pool->avail_desc = DP_TX_DESC_CACHE_TEST_POOL_SIZE;
+	pool->status = FLOW_POOL_ACTIVE_UNPAUSED;
+	dp_tx_desc_cache_test_set_th(pool);
+	qdf_spinlock_create(&pool->flow_pool_lock);
+	ctx->pool = pool;
+
+	ctx->soc->pause_cb = dp_tx_desc_cache_test_pause_cb;
+	dp_tx_desc_cache_test_cur = ctx;
+
+	dp_tx_desc_cache_attach(pool);
+	if (!pool->cache)
+		return QDF_STATUS_E_NOMEM;
+	dp_tx_desc_cache_enable(pool);
+
+	return QDF_STATUS_SUCCESS;
+}
+
+static void
+dp_tx_desc_cache_test_teardown(struct dp_tx_desc_cache_test_ctx *ctx)
+{
+	if (ctx->pool) {
+		dp_tx_desc_cache_detach(ctx->pool);
+		qdf_spinlock_destroy(&ctx->pool->flow_pool_lock);
+	}
+	dp_tx_desc_cache_test_cur = NULL;
+	qdf_mem_free(ctx->descs);
+	if (ctx->soc)
+		qdf_mem_vfree(ctx->soc);
+}
+
+uint32_t dp_tx_desc_cache_unit_test(void)
+{
+	struct dp_tx_desc_cache_test_ctx *ctx;
+	uint32_t num_workers;
+	uint32_t errors = 0;
+
+	ctx = qdf_mem_malloc(sizeof(*ctx));
+	if (!ctx)
+		return 1;
+
+	if (QDF_IS_STATUS_ERROR(dp_tx_desc_cache_test_setup(ctx))) {
+		errors++;
+		goto teardown;
+	}
+
+	errors += dp_tx_desc_cache_test_drain(ctx);
+
+	for (num_workers = 1;
+	     num_workers <= DP_TX_DESC_CACHE_TEST_MAX_THREADS;
+	     num_workers <<= 1) {
+		errors += dp_tx_desc_cache_test_churn(ctx, num_workers, false);
+		errors += dp_tx_desc_cache_test_churn(ctx, num_workers, true);
+	}
+
+	/* the thresholds must still hold after the caches were in use */
+	errors += dp_tx_desc_cache_test_drain(ctx);
+
+teardown:
+	dp_tx_desc_cache_test_teardown(ctx);
+	qdf_mem_free(ctx);
+
+	QDF_BUG(!errors);
+
+	return errors;
+}
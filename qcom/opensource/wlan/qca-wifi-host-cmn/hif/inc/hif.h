@@ -1223,6 +1223,28 @@ void hif_trigger_dump(struct hif_opaque_softc *hif_ctx,
 QDF_STATUS hif_send_head(struct hif_opaque_softc *hif_ctx, uint8_t PipeID,
 				  uint32_t transferID, uint32_t nbytes,
 				  qdf_nbuf_t wbuf, uint32_t data_attr);
+
+/**
+ * hif_send_batch_start() - start a batch of hif_send_head() calls on a pipe
+ * @hif_ctx: HIF context
+ * @PipeID: pipe the batch is sent on
+ *
+ * The target is notified of the buffers sent in the batch once, by
+ * hif_send_batch_end(), instead of once per buffer. Batches may nest.
+ * Buses without support for batching treat this as a no-op.
+ *
+ * Return: None
+ */
+void hif_send_batch_start(struct hif_opaque_softc *hif_ctx, uint8_t PipeID);
+
+/**
+ * hif_send_batch_end() - end a batch of hif_send_head() calls on a pipe
+ * @hif_ctx: HIF context
+ * @PipeID: pipe the batch is sent on
+ *
+ * Return: None
+ */
+void hif_send_batch_end(struct hif_opaque_softc *hif_ctx, uint8_t PipeID);
 void hif_send_complete_check(struct hif_opaque_softc *hif_ctx, uint8_t PipeID,
 			     int force);
 void hif_schedule_ce_tasklet(struct hif_opaque_softc *hif_ctx, uint8_t PipeID);
@@ -240,6 +240,30 @@ QDF_STATUS ce_sendlist_send(struct CE_handle *copyeng,
 			    struct ce_sendlist *sendlist,
 			    unsigned int transfer_id);
 
+/**
+ * ce_send_batch_start() - start a batch of sends on a copy engine
+ * @copyeng: which copy engine to use
+ *
+ * Until the matching ce_send_batch_end(), descriptors posted to the source
+ * ring are made visible to the target with a single head pointer update
+ * instead of one per descriptor. Batches may nest. Copy engines without
+ * support for batching ignore the call.
+ *
+ * Return: None
+ */
+void ce_send_batch_start(struct CE_handle *copyeng);
+
+/**
+ * ce_send_batch_end() - end a batch of sends on a copy engine
+ * @copyeng: which copy engine to use
+ *
+ * Writes the head pointer of the source ring to the target if descriptors
+ * were posted since the outermost ce_send_batch_start().
+ *
+ * Return: None
+ */
+void ce_send_batch_end(struct CE_handle *copyeng);
+
 /*==================Recv=====================================================*/
 
 /**
@@ -624,6 +648,8 @@ struct ce_ops {
 				       void *per_transfer_context,
 				       struct ce_sendlist *sendlist,
 				       unsigned int transfer_id);
+	void (*ce_send_batch_start)(struct CE_state *CE_state);
+	void (*ce_send_batch_end)(struct CE_state *CE_state);
 	QDF_STATUS (*ce_revoke_recv_next)(struct CE_handle *copyeng,
 			void **per_CE_contextp,
 			void **per_transfer_contextp,
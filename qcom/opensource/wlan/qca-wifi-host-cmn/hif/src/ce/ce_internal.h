@@ -154,6 +154,16 @@ struct ce_reg_write_stats {
 };
 #endif
 
+/**
+ * struct ce_send_batch_stats - stats of source ring head pointer updates
+ * @descs: descriptors posted to the source ring
+ * @hp_writes: head pointer updates written to the target
+ */
+struct ce_send_batch_stats {
+	uint32_t descs;
+	uint32_t hp_writes;
+};
+
 /* Copy Engine internal state */
 struct CE_state {
 	struct hif_softc *scn;
@@ -229,6 +239,13 @@ struct CE_state {
 	qdf_time_t last_dequeue_time;
 #endif
 	uint32_t ce_wrt_idx_offset;
+	/*
+	 * Source ring head pointer updates are deferred while a send batch
+	 * is open, protected by ce_index_lock
+	 */
+	uint8_t send_batch_depth;
+	bool send_batch_hp_pending;
+	struct ce_send_batch_stats send_batch_stats;
 };
 
 /* Descriptor rings must be aligned to this boundary */
@@ -3400,6 +3400,28 @@ hif_send_head(struct hif_opaque_softc *hif_ctx,
 	return status;
 }
 
+void hif_send_batch_start(struct hif_opaque_softc *hif_ctx, uint8_t pipe)
+{
+	struct HIF_CE_state *hif_state = HIF_GET_CE_STATE(hif_ctx);
+	struct CE_handle *ce_hdl = hif_state->pipe_info[pipe].ce_hdl;
+
+	if (qdf_unlikely(!ce_hdl))
+		return;
+
+	ce_send_batch_start(ce_hdl);
+}
+
+void hif_send_batch_end(struct hif_opaque_softc *hif_ctx, uint8_t pipe)
+{
+	struct HIF_CE_state *hif_state = HIF_GET_CE_STATE(hif_ctx);
+	struct CE_handle *ce_hdl = hif_state->pipe_info[pipe].ce_hdl;
+
+	if (qdf_unlikely(!ce_hdl))
+		return;
+
+	ce_send_batch_end(ce_hdl);
+}
+
 void hif_send_complete_check(struct hif_opaque_softc *hif_ctx, uint8_t pipe,
 								int force)
 {
@@ -569,6 +569,32 @@ ce_sendlist_send(struct CE_handle *copyeng,
 			per_transfer_context, sendlist, transfer_id);
 }
 
+void ce_send_batch_start(struct CE_handle *copyeng)
+{
+	struct CE_state *CE_state = (struct CE_state *)copyeng;
+	struct HIF_CE_state *hif_state = HIF_GET_CE_STATE(CE_state->scn);
+
+	if (!hif_state->ce_services->ce_send_batch_start)
+		return;
+
+	qdf_spin_lock_bh(&CE_state->ce_index_lock);
+	hif_state->ce_services->ce_send_batch_start(CE_state);
+	qdf_spin_unlock_bh(&CE_state->ce_index_lock);
+}
+
+void ce_send_batch_end(struct CE_handle *copyeng)
+{
+	struct CE_state *CE_state = (struct CE_state *)copyeng;
+	struct HIF_CE_state *hif_state = HIF_GET_CE_STATE(CE_state->scn);
+
+	if (!hif_state->ce_services->ce_send_batch_end)
+		return;
+
+	qdf_spin_lock_bh(&CE_state->ce_index_lock);
+	hif_state->ce_services->ce_send_batch_end(CE_state);
+	qdf_spin_unlock_bh(&CE_state->ce_index_lock);
+}
+
 #ifndef AH_NEED_TX_DATA_SWAP
 #define AH_NEED_TX_DATA_SWAP 0
 #endif
@@ -157,6 +157,55 @@ void hif_record_ce_srng_desc_event(struct hif_softc *scn, int ce_id,
 }
 #endif /* HIF_CONFIG_SLUB_DEBUG_ON || HIF_CE_DEBUG_DATA_BUF */
 
+/**
+ * ce_send_batch_hp_flush_srng() - write the deferred source ring head pointer
+ * @CE_state: copy engine state
+ *
+ * Must be called under ce_index_lock. If target access fails the update
+ * stays pending, the next head pointer write covers it.
+ *
+ * Return: None
+ */
+static void ce_send_batch_hp_flush_srng(struct CE_state *CE_state)
+{
+	struct CE_ring_state *src_ring = CE_state->src_ring;
+	struct hif_softc *scn = CE_state->scn;
+
+	if (!CE_state->send_batch_hp_pending)
+		return;
+
+	if (Q_TARGET_ACCESS_BEGIN(scn) < 0)
+		return;
+
+	if (hal_srng_access_start(scn->hal_soc, src_ring->srng_ctx)) {
+		Q_TARGET_ACCESS_END(scn);
+		return;
+	}
+
+	hal_srng_access_end(scn->hal_soc, src_ring->srng_ctx);
+	CE_state->send_batch_hp_pending = false;
+	CE_state->send_batch_stats.hp_writes++;
+	Q_TARGET_ACCESS_END(scn);
+}
+
+static void ce_send_batch_start_srng(struct CE_state *CE_state)
+{
+	CE_state->send_batch_depth++;
+}
+
+static void ce_send_batch_end_srng(struct CE_state *CE_state)
+{
+	if (qdf_unlikely(!CE_state->send_batch_depth)) {
+		QDF_ASSERT(0);
+		return;
+	}
+
+	if (--CE_state->send_batch_depth)
+		return;
+
+	ce_send_batch_hp_flush_srng(CE_state);
+}
+
 static QDF_STATUS
 ce_send_nolock_srng(struct CE_handle *copyeng,
 			   void *per_transfer_context,
@@ -222,7 +271,19 @@ ce_send_nolock_srng(struct CE_handle *copyeng,
 			per_transfer_context;
 		write_index = CE_RING_IDX_INCR(nentries_mask, write_index);
 
-		hal_srng_access_end(scn->hal_soc, src_ring->srng_ctx);
+		/*
+		 * Within a send batch only the software head pointer is
+		 * advanced, the target is updated once when the batch ends.
+		 */
+		if (CE_state->send_batch_depth) {
+			hal_srng_access_end_reap(scn->hal_soc,
+						 src_ring->srng_ctx);
+			CE_state->send_batch_hp_pending = true;
+		} else {
+			hal_srng_access_end(scn->hal_soc, src_ring->srng_ctx);
+			CE_state->send_batch_stats.hp_writes++;
+		}
+		CE_state->send_batch_stats.descs++;
 
 		/* src_ring->write index hasn't been updated event though
 		 * the register has already been written to.
@@ -265,6 +326,8 @@ ce_sendlist_send_srng(struct CE_handle *copyeng,
 		struct ce_sendlist_item *item;
 		int i;
 
+		/* post all the gather fragments with one head pointer update */
+		ce_send_batch_start_srng(CE_state);
 		/* handle all but the last item uniformly */
 		for (i = 0; i < num_items - 1; i++) {
 			item = &sl->item[i];
@@ -288,6 +351,7 @@ ce_sendlist_send_srng(struct CE_handle *copyeng,
 					transfer_id, item->flags,
 					item->user_flags);
 		QDF_ASSERT(status == QDF_STATUS_SUCCESS);
+		ce_send_batch_end_srng(CE_state);
 		QDF_NBUF_UPDATE_TX_PKT_COUNT((qdf_nbuf_t)per_transfer_context,
 					QDF_NBUF_TX_PKT_CE);
 		DPTRACE(qdf_dp_trace((qdf_nbuf_t)per_transfer_context,
@@ -1288,6 +1352,8 @@ static struct ce_ops ce_service_srng = {
 	.ce_ring_setup = ce_ring_setup_srng,
 	.ce_srng_cleanup = ce_ring_cleanup_srng,
 	.ce_sendlist_send = ce_sendlist_send_srng,
+	.ce_send_batch_start = ce_send_batch_start_srng,
+	.ce_send_batch_end = ce_send_batch_end_srng,
 	.ce_completed_recv_next_nolock = ce_completed_recv_next_nolock_srng,
 	.ce_revoke_recv_next = ce_revoke_recv_next_srng,
 	.ce_cancel_send_next = ce_cancel_send_next_srng,
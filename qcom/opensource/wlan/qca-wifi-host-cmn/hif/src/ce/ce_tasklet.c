@@ -687,6 +687,18 @@ void hif_display_ce_stats(struct hif_softc *hif_ctx)
 		qdf_debug("CE id[%2d] - %s", i, str_buffer);
 	}
 
+	qdf_debug("CE source ring head pointer updates:");
+	for (i = 0; i < hif_ctx->ce_count; i++) {
+		struct CE_state *ce_state = hif_ctx->ce_id_to_state[i];
+
+		if (!ce_state || !ce_state->send_batch_stats.descs)
+			continue;
+
+		qdf_debug("CE id[%2d] - descs %u hp writes %u", i,
+			  ce_state->send_batch_stats.descs,
+			  ce_state->send_batch_stats.hp_writes);
+	}
+
 	if (hif_ctx->ce_latency_stats)
 		hif_ce_latency_stats(hif_ctx);
 #undef STR_SIZE
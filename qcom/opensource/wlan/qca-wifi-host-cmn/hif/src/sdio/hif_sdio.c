@@ -229,3 +229,11 @@ void hif_send_complete_check(struct hif_opaque_softc *hif_ctx, uint8_t pipe,
 
 }
 
+void hif_send_batch_start(struct hif_opaque_softc *hif_ctx, uint8_t pipe)
+{
+}
+
+void hif_send_batch_end(struct hif_opaque_softc *hif_ctx, uint8_t pipe)
+{
+}
+
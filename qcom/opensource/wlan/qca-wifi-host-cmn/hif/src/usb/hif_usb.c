@@ -906,6 +906,16 @@ void hif_send_complete_check(struct hif_opaque_softc *scn,
 	/* NO-OP*/
 }
 
+void hif_send_batch_start(struct hif_opaque_softc *scn, uint8_t PipeID)
+{
+	/* NO-OP*/
+}
+
+void hif_send_batch_end(struct hif_opaque_softc *scn, uint8_t PipeID)
+{
+	/* NO-OP*/
+}
+
 /* diagnostic command definitions */
 #define USB_CTRL_DIAG_CC_READ       0
 #define USB_CTRL_DIAG_CC_WRITE      1
@@ -752,6 +752,11 @@ static QDF_STATUS htc_issue_packets(HTC_TARGET *target,
 	AR_DEBUG_PRINTF(ATH_DEBUG_SEND,
 			("+htc_issue_packets: Queue: %pK, Pkts %d\n", pPktQueue,
 			 HTC_PACKET_QUEUE_DEPTH(pPktQueue)));
+	/*
+	 * Let HIF notify the target of all the packets issued from this
+	 * queue at once, instead of with a register write per packet.
+	 */
+	hif_send_batch_start(target->hif_dev, pEndpoint->UL_PipeID);
 	while (true) {
 		rt_put_in_resp = false;
 		if (HTC_TX_BUNDLE_ENABLED(target) &&
@@ -894,6 +899,14 @@ static QDF_STATUS htc_issue_packets(HTC_TARGET *target,
 				       HTC_HDR_LENGTH + pPacket->ActualLength,
 				       netbuf, data_attr);
 
+		/* the suspend message must reach the target right away */
+		if (pPacket->PktInfo.AsTx.Tag == HTC_TX_PACKET_SYSTEM_SUSPEND) {
+			hif_send_batch_end(target->hif_dev,
+					   pEndpoint->UL_PipeID);
+			hif_send_batch_start(target->hif_dev,
+					     pEndpoint->UL_PipeID);
+		}
+
 		if (status != QDF_STATUS_SUCCESS) {
 			if (rt_put_in_resp)
 				htc_dec_return_htt_runtime_cnt((void *)target);
@@ -970,6 +983,7 @@ static QDF_STATUS htc_issue_packets(HTC_TARGET *target,
 			rt_put = false;
 		}
 	}
+	hif_send_batch_end(target->hif_dev, pEndpoint->UL_PipeID);
 
 	if (qdf_unlikely(QDF_IS_STATUS_ERROR(status))) {
 		if (((status == QDF_STATUS_E_RESOURCES) &&
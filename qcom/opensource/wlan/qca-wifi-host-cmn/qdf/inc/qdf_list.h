@@ -105,6 +105,19 @@ static inline void qdf_list_create(__qdf_list_t *list, uint32_t max_size)
 #define qdf_list_for_each_del(list_ptr, cursor, next, node_field) \
 	__qdf_list_for_each_del(list_ptr, cursor, next, node_field)
 
+/**
+ * qdf_list_for_each_rcu() - iterate a list inside an RCU read section
+ * @list_ptr: list to iterate
+ * @cursor: entry pointer used as the loop cursor
+ * @node_field: name of the list node member within the entry
+ *
+ * Writers must modify the list with qdf_list_insert_back_rcu() and
+ * qdf_list_remove_node_rcu(), and defer freeing removed entries with
+ * qdf_call_rcu().
+ */
+#define qdf_list_for_each_rcu(list_ptr, cursor, node_field) \
+	__qdf_list_for_each_rcu(list_ptr, cursor, node_field)
+
 #define qdf_list_for_each_from(list_ptr, cursor, node_field) \
 	__qdf_list_for_each_from(list_ptr, cursor, node_field)
 
@@ -172,6 +185,38 @@ QDF_STATUS qdf_list_peek_front(qdf_list_t *list, qdf_list_node_t **node1);
 QDF_STATUS qdf_list_remove_node(qdf_list_t *list,
 				qdf_list_node_t *node_to_remove);
 
+/**
+ * qdf_list_insert_back_rcu() - insert node at back of a list read under RCU
+ * @list: pointer to list
+ * @node: node to insert
+ *
+ * Caller must serialize against other writers of @list.
+ *
+ * Return: none
+ */
+static inline void qdf_list_insert_back_rcu(qdf_list_t *list,
+					    qdf_list_node_t *node)
+{
+	__qdf_list_insert_back_rcu(list, node);
+}
+
+/**
+ * qdf_list_remove_node_rcu() - remove node from a list read under RCU
+ * @list: pointer to list
+ * @node: node to remove
+ *
+ * Readers may still hold @node until a grace period has elapsed, so it must
+ * neither be freed nor inserted into a list before then. Caller must
+ * serialize against other writers of @list.
+ *
+ * Return: none
+ */
+static inline void qdf_list_remove_node_rcu(qdf_list_t *list,
+					    qdf_list_node_t *node)
+{
+	__qdf_list_remove_node_rcu(list, node);
+}
+
 bool qdf_list_empty(qdf_list_t *list);
 
 /**
@@ -936,4 +936,108 @@ QDF_STATUS qdf_rtpm_sync_resume(void)
 
 #endif /* FEATURE_RUNTIME_PM */
 
+/**
+ * typedef qdf_rcu_head_t - Head embedded in an object whose free is
+ *                          deferred past an RCU grace period
+ */
+typedef __qdf_rcu_head_t qdf_rcu_head_t;
+
+/**
+ * typedef qdf_rcu_cb_t - Callback invoked once the grace period expired
+ */
+typedef __qdf_rcu_cb_t qdf_rcu_cb_t;
+
+/**
+ * qdf_rcu_read_lock_bh() - Enter an RCU read side critical section
+ *                          with soft irqs disabled
+ *
+ * Return: none
+ */
+static inline void qdf_rcu_read_lock_bh(void)
+{
+	__qdf_rcu_read_lock_bh();
+}
+
+/**
+ * qdf_rcu_read_unlock_bh() - Leave an RCU read side critical section
+ *
+ * Return: none
+ */
+static inline void qdf_rcu_read_unlock_bh(void)
+{
+	__qdf_rcu_read_unlock_bh();
+}
+
+/**
+ * qdf_rcu_dereference_bh() - Load a pointer published by
+ *                            qdf_rcu_assign_pointer()
+ * @_p: pointer to load, only valid inside qdf_rcu_read_lock_bh()
+ */
+#define qdf_rcu_dereference_bh(_p) __qdf_rcu_dereference_bh(_p)
+
+/**
+ * qdf_rcu_assign_pointer() - Publish a pointer to RCU readers
+ * @_p: pointer to be updated
+ * @_v: value to publish, fully initialized before the call
+ */
+#define qdf_rcu_assign_pointer(_p, _v) __qdf_rcu_assign_pointer(_p, _v)
+
+/**
+ * qdf_call_rcu() - Invoke a callback once all current readers are done
+ * @head: RCU head embedded in the object
+ * @func: callback, typically freeing the object
+ *
+ * Return: none
+ */
+static inline void qdf_call_rcu(qdf_rcu_head_t *head, qdf_rcu_cb_t func)
+{
+	__qdf_call_rcu(head, func);
+}
+
+/**
+ * qdf_rcu_barrier() - Wait for all pending qdf_call_rcu() callbacks
+ *
+ * Return: none
+ */
+static inline void qdf_rcu_barrier(void)
+{
+	__qdf_rcu_barrier();
+}
+
+/**
+ * qdf_synchronize_rcu() - Wait until all current readers are done
+ *
+ * May sleep.
+ *
+ * Return: none
+ */
+static inline void qdf_synchronize_rcu(void)
+{
+	__qdf_synchronize_rcu();
+}
+
+/**
+ * qdf_rcu_get_state() - Snapshot the current RCU grace period state
+ *
+ * Return: cookie to pass to qdf_cond_synchronize_rcu()
+ */
+static inline unsigned long qdf_rcu_get_state(void)
+{
+	return __qdf_rcu_get_state();
+}
+
+/**
+ * qdf_cond_synchronize_rcu() - Wait for a grace period unless one already
+ *                              elapsed since @state was taken
+ * @state: cookie from qdf_rcu_get_state()
+ *
+ * May sleep.
+ *
+ * Return: none
+ */
+static inline void qdf_cond_synchronize_rcu(unsigned long state)
+{
+	__qdf_cond_synchronize_rcu(state);
+}
+
 #endif /* _QDF_LOCK_H */
@@ -232,6 +232,14 @@ enum diag_tx_status wlan_get_diag_tx_status(enum qdf_dp_tx_rx_status tx_status);
 #define MAX_QDF_DP_TRACE_RECORDS       2000
 #endif
 
+/*
+ * The record table is split into one ring per CPU, up to this many rings,
+ * each holding MAX_QDF_DP_TRACE_RECORDS / number of rings records.
+ */
+#ifndef QDF_DP_TRACE_MAX_RINGS
+#define QDF_DP_TRACE_MAX_RINGS         8
+#endif
+
 #define QDF_DP_TRACE_RECORD_SIZE       66 /* bytes */
 #define INVALID_QDF_DP_TRACE_ADDR      0xffffffff
 #define QDF_DP_TRACE_VERBOSITY_HIGH		4
@@ -494,9 +502,6 @@ struct qdf_dp_trace_record_s {
 
 /**
  * struct s_qdf_dp_trace_data - Parameters to configure/control DP trace
- * @head: Position of first record
- * @tail: Position of last record
- * @num:  Current index
  * @proto_bitmap: defines which protocol to be traced
  * @no_of_record: defines every nth packet to be traced
  * @num_records_to_dump: defines number of records to be dumped
@@ -508,8 +513,7 @@ struct qdf_dp_trace_record_s {
  * @live_mode_config: configuration as received during initialization
  * @live_mode: current live mode, enabled or disabled, can be throttled based
  *             on throughput
- * @curr_pos:
- * @saved_tail:
+ * @curr_pos: number of records already written to the debugfs file
  * @force_live_mode: flag to enable live mode all the time for all packets.
  *                  This can be set/unset from userspace and overrides other
  *                  live mode flags.
@@ -546,9 +550,6 @@ struct qdf_dp_trace_record_s {
  *  for bitmap.
  */
 struct s_qdf_dp_trace_data {
-	uint32_t head;
-	uint32_t tail;
-	uint32_t num;
 	uint32_t proto_bitmap;
 	uint8_t no_of_record;
 	uint16_t num_records_to_dump;
@@ -559,7 +560,6 @@ struct s_qdf_dp_trace_data {
 	bool live_mode_config;
 	bool live_mode;
 	uint32_t curr_pos;
-	uint32_t saved_tail;
 	bool force_live_mode;
 	bool dynamic_verbosity_modify;
 	uint8_t print_pkt_cnt;
@@ -1029,14 +1029,17 @@ void qdf_dp_trace_dump_all(uint32_t count, uint8_t pdev_id);
  * @file: debugfs file to read
  * @state: state to control read to debugfs file
  *
- * Return: curr pos
+ * On a new read the per-CPU rings are snapshotted into a merge cursor
+ * which qdf_dpt_dump_stats_debugfs() then walks, newest record first.
+ *
+ * Return: number of records already dumped in this read
  */
 uint32_t qdf_dpt_get_curr_pos_debugfs(qdf_debugfs_file_t file,
 				enum qdf_dpt_debugfs_state state);
 /**
  * qdf_dpt_dump_stats_debugfs() - dump DP Trace stats to debugfs file
  * @file: debugfs file to read
- * @curr_pos: curr position to start read
+ * @curr_pos: records already dumped, from qdf_dpt_get_curr_pos_debugfs()
  *
  * Return: QDF_STATUS
  */
@@ -1363,6 +1366,79 @@ void qdf_dp_log_proto_pkt_info(uint8_t *sa, uint8_t *da, uint8_t type,
  * Return: none
  */
 void qdf_dp_track_noack_check(qdf_nbuf_t nbuf, enum qdf_proto_subtype *subtype);
+
+#ifdef WLAN_DP_TRACE_TEST
+/**
+ * qdf_dp_trace_test_begin() - take over the DP trace table for a unit test
+ * @num_rings: number of rings to split the table into
+ *
+ * Tracing is disabled and the table emptied until qdf_dp_trace_test_end().
+ *
+ * Return: QDF_STATUS_SUCCESS if the table can be used by the test
+ */
+QDF_STATUS qdf_dp_trace_test_begin(uint32_t num_rings);
+
+/**
+ * qdf_dp_trace_test_ring_size() - number of records each ring holds
+ *
+ * Return: ring size
+ */
+uint32_t qdf_dp_trace_test_ring_size(void);
+
+/**
+ * qdf_dp_trace_test_add() - record an empty entry into a given ring
+ * @ring_id: ring to record into, taken modulo the number of rings
+ * @time: timestamp of the record
+ *
+ * Return: none
+ */
+void qdf_dp_trace_test_add(uint32_t ring_id, uint64_t time);
+
+/**
+ * qdf_dp_trace_test_add_local() - record into the ring of the current CPU
+ *	through the same path as live DP trace records
+ * @data: payload of the record
+ * @data_size: size of @data
+ *
+ * Return: none
+ */
+void qdf_dp_trace_test_add_local(uint8_t *data, uint8_t data_size);
+
+/**
+ * qdf_dp_trace_test_num_records() - number of records held by all rings
+ *
+ * Return: record count
+ */
+uint32_t qdf_dp_trace_test_num_records(void);
+
+/**
+ * qdf_dp_trace_test_walk_newest() - walk all rings merged, newest first
+ * @times: filled with the timestamps of the records visited
+ * @max: size of @times
+ *
+ * Return: number of records visited
+ */
+uint32_t qdf_dp_trace_test_walk_newest(uint64_t *times, uint32_t max);
+
+/**
+ * qdf_dp_trace_test_walk_window() - walk the @count newest records merged,
+ *	oldest first, as qdf_dp_trace_dump_all() does
+ * @count: number of records in the window
+ * @times: filled with the timestamps of the records visited
+ * @max: size of @times
+ *
+ * Return: number of records visited
+ */
+uint32_t qdf_dp_trace_test_walk_window(uint32_t count, uint64_t *times,
+				       uint32_t max);
+
+/**
+ * qdf_dp_trace_test_end() - hand the DP trace table back to tracing
+ *
+ * Return: none
+ */
+void qdf_dp_trace_test_end(void);
+#endif /* WLAN_DP_TRACE_TEST */
 #else
 static inline
 bool qdf_dp_trace_log_pkt(uint8_t vdev_id, struct sk_buff *skb,
@@ -452,6 +452,31 @@ static inline void qdf_set_macaddr_broadcast(struct qdf_mac_addr *mac_addr)
 	__qdf_set_macaddr_broadcast(mac_addr);
 }
 
+/* 2^32 / golden ratio, spreads sequential keys across the hash bits */
+#define QDF_MAC_ADDR_HASH_MULT 0x9E3779B1
+
+/**
+ * qdf_mac_addr_hash() - hash a MAC address into a power of 2 sized table
+ * @addr: MAC address
+ * @bits: table size as a power of 2, in the range [1, 32]
+ *
+ * All six bytes of the address are folded into the key. Sequential and
+ * locally administered addresses, or the BSSIDs of an MBSSID set, often
+ * differ only in a few bits of one byte, so no single byte is a good key.
+ *
+ * Return: hash index in the range [0, 1 << @bits)
+ */
+static inline uint32_t qdf_mac_addr_hash(const uint8_t *addr, uint32_t bits)
+{
+	uint32_t key;
+
+	key = ((uint32_t)addr[2] << 24 | (uint32_t)addr[3] << 16 |
+	       (uint32_t)addr[4] << 8 | addr[5]) ^
+	      ((uint32_t)addr[0] << 8 | addr[1]);
+
+	return (key * QDF_MAC_ADDR_HASH_MULT) >> (32 - bits);
+}
+
 /**
  * qdf_set_u16() - Assign 16-bit unsigned value to a byte array base on CPU's
  * endianness.
@@ -601,6 +626,14 @@ static inline uint8_t *qdf_get_u32(uint8_t *ptr, uint32_t *value)
  */
 #define qdf_le64_to_cpu(x)                   __qdf_le64_to_cpu(x)
 
+/**
+ * qdf_get_unaligned_le32() - Load a little-endian 32-bit value from a
+ * possibly unaligned address in CPU byte order
+ *
+ * @p: address to load from
+ */
+#define qdf_get_unaligned_le32(p)            __qdf_get_unaligned_le32(p)
+
 /**
  * qdf_cpu_to_be16() - Convert a 16-bit value from CPU byte order to
  * big-endian byte order
@@ -965,4 +998,63 @@ static inline bool qdf_in_atomic(void)
 {
 	return __qdf_in_atomic();
 }
+
+/* Marks a pointer to an area allocated with qdf_percpu_alloc() */
+#define qdf_percpu __qdf_percpu
+
+/**
+ * qdf_percpu_alloc() - Allocate a zeroed area on every possible CPU
+ * @size: bytes needed on each CPU
+ *
+ * Return: per-CPU area, NULL on failure or if @size is too large for
+ *	   the per-CPU allocator
+ */
+static inline void qdf_percpu *qdf_percpu_alloc(size_t size)
+{
+	return __qdf_percpu_alloc(size);
+}
+
+/**
+ * qdf_percpu_free() - Free an area allocated with qdf_percpu_alloc()
+ * @ptr: per-CPU area, may be NULL
+ *
+ * Return: none
+ */
+static inline void qdf_percpu_free(void qdf_percpu *ptr)
+{
+	__qdf_percpu_free(ptr);
+}
+
+/**
+ * qdf_percpu_ptr() - Copy of a per-CPU area belonging to a given CPU
+ * @_ptr: per-CPU area
+ * @_cpu: CPU whose copy is wanted
+ */
+#define qdf_percpu_ptr(_ptr, _cpu) __qdf_percpu_ptr(_ptr, _cpu)
+
+/**
+ * qdf_raw_cpu_ptr() - Copy of a per-CPU area belonging to the current CPU
+ * @_ptr: per-CPU area
+ *
+ * Preemption is not disabled, the caller may migrate right after the
+ * lookup. Only for copies that carry their own lock.
+ */
+#define qdf_raw_cpu_ptr(_ptr) __qdf_raw_cpu_ptr(_ptr)
+
+/**
+ * qdf_this_cpu_add() - Add to the current CPU's copy of a per-CPU variable
+ * @_var: per-CPU lvalue
+ * @_val: value to add
+ *
+ * Safe against preemption and interrupts on the local CPU.
+ */
+#define qdf_this_cpu_add(_var, _val) __qdf_this_cpu_add(_var, _val)
+
+/**
+ * qdf_this_cpu_sub() - Subtract from the current CPU's copy of a per-CPU
+ *			variable
+ * @_var: per-CPU lvalue
+ * @_val: value to subtract
+ */
+#define qdf_this_cpu_sub(_var, _val) __qdf_this_cpu_sub(_var, _val)
 #endif /*_QDF_UTIL_H*/
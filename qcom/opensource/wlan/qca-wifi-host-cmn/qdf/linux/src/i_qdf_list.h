@@ -26,6 +26,7 @@
 #define __I_QDF_LIST_H
 
 #include <linux/list.h>
+#include <linux/rculist.h>
 
 /* Type declarations */
 typedef struct list_head __qdf_list_node_t;
@@ -95,6 +96,9 @@ static inline uint32_t __qdf_list_max_size(__qdf_list_t *list)
 #define __qdf_list_for_each_del(list_ptr, cursor, next, node_field) \
 	list_for_each_entry_safe(cursor, next, &(list_ptr)->anchor, node_field)
 
+#define __qdf_list_for_each_rcu(list_ptr, cursor, node_field) \
+	list_for_each_entry_rcu(cursor, &(list_ptr)->anchor, node_field)
+
 #define __qdf_list_for_each_from(list_ptr, cursor, node_field) \
 	list_for_each_entry_from(cursor, &(list_ptr)->anchor, node_field)
 
@@ -117,4 +121,33 @@ static inline void __qdf_init_list_head(__qdf_list_node_t *list_head)
 {
 	INIT_LIST_HEAD(list_head);
 }
+
+/**
+ * __qdf_list_insert_back_rcu() - insert node at back of a list read under RCU
+ * @list: object of list
+ * @node: node to insert
+ *
+ * Return: none
+ */
+static inline void __qdf_list_insert_back_rcu(__qdf_list_t *list,
+					      __qdf_list_node_t *node)
+{
+	list_add_tail_rcu(node, &list->anchor);
+	list->count++;
+}
+
+/**
+ * __qdf_list_remove_node_rcu() - remove node from a list read under RCU
+ * @list: object of list
+ * @node: node to remove
+ *
+ * Return: none
+ */
+static inline void __qdf_list_remove_node_rcu(__qdf_list_t *list,
+					      __qdf_list_node_t *node)
+{
+	list_del_rcu(node);
+	list->count--;
+}
+
 #endif
@@ -39,6 +39,7 @@
 #endif
 #include <linux/interrupt.h>
 #include <linux/pm_wakeup.h>
+#include <linux/rcupdate.h>
 
 /* define for flag */
 #define QDF_LINUX_UNLOCK_BH  1
@@ -360,6 +361,26 @@ static inline bool __qdf_in_softirq(void)
 	return in_softirq();
 }
 
+/**
+ * typedef __qdf_rcu_head_t - RCU callback head abstraction
+ */
+typedef struct rcu_head __qdf_rcu_head_t;
+
+/**
+ * typedef __qdf_rcu_cb_t - RCU callback abstraction
+ */
+typedef rcu_callback_t __qdf_rcu_cb_t;
+
+#define __qdf_rcu_read_lock_bh()		rcu_read_lock_bh()
+#define __qdf_rcu_read_unlock_bh()		rcu_read_unlock_bh()
+#define __qdf_rcu_dereference_bh(_p)		rcu_dereference_bh(_p)
+#define __qdf_rcu_assign_pointer(_p, _v)	rcu_assign_pointer(_p, _v)
+#define __qdf_call_rcu(_head, _func)		call_rcu(_head, _func)
+#define __qdf_rcu_barrier()			rcu_barrier()
+#define __qdf_synchronize_rcu()			synchronize_rcu()
+#define __qdf_rcu_get_state()			get_state_synchronize_rcu()
+#define __qdf_cond_synchronize_rcu(_state)	cond_synchronize_rcu(_state)
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -31,6 +31,7 @@
 #include <linux/mm.h>
 #include <linux/errno.h>
 #include <linux/average.h>
+#include <linux/percpu.h>
 
 #include <linux/random.h>
 #include <linux/io.h>
@@ -58,6 +59,11 @@
 #endif
 
 #include <linux/rcupdate.h>
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 12, 0)
+#include <linux/unaligned.h>
+#else
+#include <asm/unaligned.h>
+#endif
 
 typedef wait_queue_head_t __qdf_wait_queue_head_t;
 
@@ -252,6 +258,8 @@ static inline bool __qdf_is_macaddr_equal(const struct qdf_mac_addr *mac_addr1,
 #define __qdf_le32_to_cpu le32_to_cpu
 #define __qdf_le64_to_cpu le64_to_cpu
 
+#define __qdf_get_unaligned_le32 get_unaligned_le32
+
 #define __qdf_cpu_to_be16 cpu_to_be16
 #define __qdf_cpu_to_be32 cpu_to_be32
 #define __qdf_cpu_to_be64 cpu_to_be64
@@ -542,4 +550,28 @@ static inline bool __qdf_in_atomic(void)
 	return false;
 }
 
+#define __qdf_percpu __percpu
+
+/**
+ * __qdf_percpu_alloc() - Allocate a zeroed area on every possible CPU
+ * @size: bytes needed on each CPU
+ *
+ * Return: per-CPU area, NULL on failure or if @size is above what the
+ *	   per-CPU allocator hands out
+ */
+static inline void __percpu *__qdf_percpu_alloc(size_t size)
+{
+	if (size > PCPU_MIN_UNIT_SIZE)
+		return NULL;
+
+	return __alloc_percpu_gfp(size, SMP_CACHE_BYTES,
+				  __qdf_in_atomic() ? GFP_ATOMIC : GFP_KERNEL);
+}
+
+#define __qdf_percpu_free(_ptr)			free_percpu(_ptr)
+#define __qdf_percpu_ptr(_ptr, _cpu)		per_cpu_ptr(_ptr, _cpu)
+#define __qdf_raw_cpu_ptr(_ptr)			raw_cpu_ptr(_ptr)
+#define __qdf_this_cpu_add(_var, _val)		this_cpu_add(_var, _val)
+#define __qdf_this_cpu_sub(_var, _val)		this_cpu_sub(_var, _val)
+
 #endif /*_I_QDF_UTIL_H*/
@@ -31,6 +31,8 @@
 #include <qdf_util.h>
 #include <qdf_mem.h>
 #include <qdf_list.h>
+#include <qdf_lock.h>
+#include <linux/seqlock.h>
 
 /* macro to map qdf trace levels into the bitmask */
 #define QDF_TRACE_LEVEL_TO_MODULE_BITMASK(_level) ((1 << (_level)))
@@ -100,6 +102,46 @@ static struct qdf_dp_trace_record_s
 #endif
 static spinlock_t l_dp_trace_lock;
 
+/**
+ * struct qdf_dp_trace_ring - per-CPU slice of the DP trace table
+ * @seq: bumped around every update so readers can retry torn copies
+ * @lock: serializes writers of this slice when CPUs share it, and
+ *	resets of the slice
+ * @base: index of the first slot of this slice in g_qdf_dp_trace_tbl
+ * @head: slice offset of the oldest record
+ * @tail: slice offset of the newest record
+ * @num: number of valid records in the slice
+ */
+struct qdf_dp_trace_ring {
+	seqcount_t seq;
+	spinlock_t lock;
+	uint32_t base;
+	uint32_t head;
+	uint32_t tail;
+	uint32_t num;
+} ____cacheline_aligned_in_smp;
+
+static struct qdf_dp_trace_ring g_qdf_dp_trace_ring[QDF_DP_TRACE_MAX_RINGS];
+static uint32_t g_qdf_dp_trace_num_rings = 1;
+static uint32_t g_qdf_dp_trace_ring_size = MAX_QDF_DP_TRACE_RECORDS;
+/* true when some CPUs have to share a ring and writers must lock it */
+static bool g_qdf_dp_trace_rings_shared;
+/* non-zero while the rings are being reset, writers drop their records */
+static qdf_atomic_t g_qdf_dp_trace_paused;
+
+/**
+ * struct qdf_dp_trace_iter - cursor merging the rings by record timestamp
+ * @pos: slice offset of the next record to visit in each ring
+ * @left: number of records still to visit in each ring
+ */
+struct qdf_dp_trace_iter {
+	uint32_t pos[QDF_DP_TRACE_MAX_RINGS];
+	uint32_t left[QDF_DP_TRACE_MAX_RINGS];
+};
+
+/* cursor of the debugfs read in progress, resumed on every page */
+static struct qdf_dp_trace_iter g_qdf_dpt_debugfs_iter;
+
 /*
  * all the options to configure/control DP trace are
  * defined in this structure
@@ -557,6 +599,357 @@ static inline void free_g_qdf_dp_trace_tbl_buffer(void)
 { }
 #endif
 
+/**
+ * qdf_dp_trace_rings_setup() - split the DP trace table into rings
+ * @num_rings: number of rings, at most QDF_DP_TRACE_MAX_RINGS
+ *
+ * Return: None
+ */
+static void qdf_dp_trace_rings_setup(uint32_t num_rings)
+{
+	uint32_t i;
+
+	g_qdf_dp_trace_num_rings = num_rings;
+	g_qdf_dp_trace_ring_size = MAX_QDF_DP_TRACE_RECORDS / num_rings;
+	g_qdf_dp_trace_rings_shared = num_rings < nr_cpu_ids;
+
+	for (i = 0; i < num_rings; i++)
+		g_qdf_dp_trace_ring[i].base = i * g_qdf_dp_trace_ring_size;
+}
+
+/**
+ * qdf_dp_trace_rings_init() - split the DP trace table into per-CPU rings
+ *
+ * Every possible CPU, up to QDF_DP_TRACE_MAX_RINGS, gets an equal slice of
+ * the table so that writers on different CPUs never contend on a lock or
+ * a cacheline. CPUs beyond that share the rings round robin, and only
+ * then do writers take the ring lock.
+ *
+ * Return: None
+ */
+static void qdf_dp_trace_rings_init(void)
+{
+	uint32_t num_rings = num_possible_cpus();
+
+	num_rings = qdf_min(num_rings, (uint32_t)QDF_MAX_AVAILABLE_CPU);
+	num_rings = qdf_min(num_rings, (uint32_t)QDF_DP_TRACE_MAX_RINGS);
+	if (!num_rings)
+		num_rings = 1;
+
+	qdf_dp_trace_rings_setup(num_rings);
+}
+
+/**
+ * qdf_dp_trace_write_begin() - claim the ring of the current CPU for a write
+ *
+ * Soft irqs stay disabled until qdf_dp_trace_write_end(), so nothing else
+ * on this CPU can write the ring and, as long as every CPU has a ring of
+ * its own, no lock is needed. The section also is an RCU read side one,
+ * which qdf_dp_trace_pause() waits for.
+ *
+ * Return: ring to record into, NULL while the rings are being reset
+ */
+static inline struct qdf_dp_trace_ring *qdf_dp_trace_write_begin(void)
+{
+	struct qdf_dp_trace_ring *ring;
+
+	qdf_rcu_read_lock_bh();
+	if (qdf_atomic_read(&g_qdf_dp_trace_paused)) {
+		qdf_rcu_read_unlock_bh();
+		return NULL;
+	}
+
+	ring = &g_qdf_dp_trace_ring[smp_processor_id() %
+				    g_qdf_dp_trace_num_rings];
+	if (g_qdf_dp_trace_rings_shared)
+		spin_lock(&ring->lock);
+	write_seqcount_begin(&ring->seq);
+
+	return ring;
+}
+
+/**
+ * qdf_dp_trace_write_end() - release a ring claimed by
+ *	qdf_dp_trace_write_begin()
+ * @ring: ring recorded into
+ *
+ * Return: None
+ */
+static inline void qdf_dp_trace_write_end(struct qdf_dp_trace_ring *ring)
+{
+	write_seqcount_end(&ring->seq);
+	if (g_qdf_dp_trace_rings_shared)
+		spin_unlock(&ring->lock);
+	qdf_rcu_read_unlock_bh();
+}
+
+/**
+ * qdf_dp_trace_pause() - stop all writers so the rings can be reset
+ *
+ * May sleep. Writers that already claimed a ring are waited for, later
+ * ones drop their record until qdf_dp_trace_resume().
+ *
+ * Return: None
+ */
+static void qdf_dp_trace_pause(void)
+{
+	qdf_atomic_inc(&g_qdf_dp_trace_paused);
+	qdf_synchronize_rcu();
+}
+
+static void qdf_dp_trace_resume(void)
+{
+	qdf_atomic_dec(&g_qdf_dp_trace_paused);
+}
+
+/**
+ * qdf_dp_trace_ring_reset() - empty a ring while writers are paused
+ * @ring: ring to empty
+ *
+ * Return: None
+ */
+static void qdf_dp_trace_ring_reset(struct qdf_dp_trace_ring *ring)
+{
+	spin_lock_bh(&ring->lock);
+	write_seqcount_begin(&ring->seq);
+	ring->head = INVALID_QDF_DP_TRACE_ADDR;
+	ring->tail = INVALID_QDF_DP_TRACE_ADDR;
+	ring->num = 0;
+	write_seqcount_end(&ring->seq);
+	spin_unlock_bh(&ring->lock);
+}
+
+static inline uint32_t qdf_dp_trace_ring_prev(uint32_t pos)
+{
+	return pos ? pos - 1 : g_qdf_dp_trace_ring_size - 1;
+}
+
+static inline uint32_t qdf_dp_trace_ring_next(uint32_t pos)
+{
+	return (pos + 1 == g_qdf_dp_trace_ring_size) ? 0 : pos + 1;
+}
+
+/**
+ * qdf_dp_trace_ring_advance() - claim the slot for a new record in a ring
+ * @ring: ring to record into, claimed by the caller
+ *
+ * The oldest record is dropped once the ring is full.
+ *
+ * Return: index of the claimed slot in g_qdf_dp_trace_tbl
+ */
+static uint32_t qdf_dp_trace_ring_advance(struct qdf_dp_trace_ring *ring)
+{
+	if (ring->num < g_qdf_dp_trace_ring_size)
+		ring->num++;
+
+	if (INVALID_QDF_DP_TRACE_ADDR == ring->head) {
+		/* first record */
+		ring->head = 0;
+		ring->tail = 0;
+	} else {
+		/* queue is not empty */
+		ring->tail = qdf_dp_trace_ring_next(ring->tail);
+
+		/* full */
+		if (ring->head == ring->tail)
+			ring->head = qdf_dp_trace_ring_next(ring->head);
+	}
+
+	return ring->base + ring->tail;
+}
+
+/**
+ * qdf_dp_trace_total_records() - number of records held by all rings
+ *
+ * Return: record count, may be stale by the time it is used
+ */
+static uint32_t qdf_dp_trace_total_records(void)
+{
+	uint32_t total = 0;
+	uint32_t i;
+
+	for (i = 0; i < g_qdf_dp_trace_num_rings; i++)
+		total += READ_ONCE(g_qdf_dp_trace_ring[i].num);
+
+	return total;
+}
+
+/**
+ * qdf_dp_trace_iter_init() - point a merge cursor at the newest record of
+ *	every ring
+ * @iter: cursor to initialize
+ *
+ * Return: None
+ */
+static void qdf_dp_trace_iter_init(struct qdf_dp_trace_iter *iter)
+{
+	struct qdf_dp_trace_ring *ring;
+	unsigned int seq;
+	uint32_t i;
+
+	qdf_mem_zero(iter, sizeof(*iter));
+	for (i = 0; i < g_qdf_dp_trace_num_rings; i++) {
+		ring = &g_qdf_dp_trace_ring[i];
+		do {
+			seq = read_seqcount_begin(&ring->seq);
+			iter->pos[i] = ring->tail;
+			iter->left[i] = ring->num;
+		} while (read_seqcount_retry(&ring->seq, seq));
+	}
+}
+
+/**
+ * qdf_dp_trace_iter_pick() - select the ring holding the next merged record
+ * @iter: merge cursor
+ * @newest: true to pick the newest remaining record, false for the oldest
+ *
+ * Return: ring index, or -1 once every ring has been walked
+ */
+static int qdf_dp_trace_iter_pick(struct qdf_dp_trace_iter *iter,
+				  bool newest)
+{
+	struct qdf_dp_trace_ring *ring;
+	uint64_t time, best_time = 0;
+	unsigned int seq;
+	int best = -1;
+	uint32_t i;
+
+	for (i = 0; i < g_qdf_dp_trace_num_rings; i++) {
+		if (!iter->left[i])
+			continue;
+
+		ring = &g_qdf_dp_trace_ring[i];
+		do {
+			seq = read_seqcount_begin(&ring->seq);
+			time = g_qdf_dp_trace_tbl[ring->base + iter->pos[i]].time;
+		} while (read_seqcount_retry(&ring->seq, seq));
+
+		if (best < 0 ||
+		    (newest ? time > best_time : time < best_time)) {
+			best = i;
+			best_time = time;
+		}
+	}
+
+	return best;
+}
+
+/**
+ * qdf_dp_trace_iter_copy() - copy out the record a merge cursor points at
+ * @ring_id: ring picked by qdf_dp_trace_iter_pick()
+ * @pos: slice offset of the record in that ring
+ * @record: filled with a copy of the record, may be NULL
+ *
+ * Return: index of the record in g_qdf_dp_trace_tbl
+ */
+static uint32_t qdf_dp_trace_iter_copy(int ring_id, uint32_t pos,
+				       struct qdf_dp_trace_record_s *record)
+{
+	struct qdf_dp_trace_ring *ring = &g_qdf_dp_trace_ring[ring_id];
+	uint32_t index = ring->base + pos;
+	unsigned int seq;
+
+	if (record) {
+		do {
+			seq = read_seqcount_begin(&ring->seq);
+			*record = g_qdf_dp_trace_tbl[index];
+		} while (read_seqcount_retry(&ring->seq, seq));
+	}
+
+	return index;
+}
+
+/**
+ * qdf_dp_trace_iter_prev() - visit the newest record not yet visited
+ * @iter: merge cursor, moved one record towards the oldest
+ * @record: filled with a copy of the record, may be NULL
+ * @index: filled with the index of the record in g_qdf_dp_trace_tbl
+ *
+ * Return: false once every ring has been walked
+ */
+static bool qdf_dp_trace_iter_prev(struct qdf_dp_trace_iter *iter,
+				   struct qdf_dp_trace_record_s *record,
+				   uint32_t *index)
+{
+	int i = qdf_dp_trace_iter_pick(iter, true);
+
+	if (i < 0)
+		return false;
+
+	*index = qdf_dp_trace_iter_copy(i, iter->pos[i], record);
+	iter->pos[i] = qdf_dp_trace_ring_prev(iter->pos[i]);
+	iter->left[i]--;
+
+	return true;
+}
+
+/**
+ * qdf_dp_trace_iter_next() - visit the oldest record not yet visited
+ * @iter: merge cursor, moved one record towards the newest
+ * @record: filled with a copy of the record
+ * @index: filled with the index of the record in g_qdf_dp_trace_tbl
+ *
+ * Return: false once every ring has been walked
+ */
+static bool qdf_dp_trace_iter_next(struct qdf_dp_trace_iter *iter,
+				   struct qdf_dp_trace_record_s *record,
+				   uint32_t *index)
+{
+	int i = qdf_dp_trace_iter_pick(iter, false);
+
+	if (i < 0)
+		return false;
+
+	*index = qdf_dp_trace_iter_copy(i, iter->pos[i], record);
+	iter->pos[i] = qdf_dp_trace_ring_next(iter->pos[i]);
+	iter->left[i]--;
+
+	return true;
+}
+
+/**
+ * qdf_dp_trace_iter_reverse() - turn a backward walk into a forward one
+ * @iter: cursor after walking back with qdf_dp_trace_iter_prev()
+ * @start: the same cursor as it was before the backward walk
+ *
+ * Afterwards @iter visits, oldest first, exactly the records the backward
+ * walk went over.
+ *
+ * Return: None
+ */
+static void qdf_dp_trace_iter_reverse(struct qdf_dp_trace_iter *iter,
+				      const struct qdf_dp_trace_iter *start)
+{
+	uint32_t i;
+
+	for (i = 0; i < g_qdf_dp_trace_num_rings; i++) {
+		iter->left[i] = start->left[i] - iter->left[i];
+		iter->pos[i] = qdf_dp_trace_ring_next(iter->pos[i]);
+	}
+}
+
+/**
+ * qdf_dp_trace_iter_window() - point a merge cursor at the oldest of the
+ *	@count newest records of the merged timeline
+ * @iter: cursor to initialize, then walked with qdf_dp_trace_iter_next()
+ * @count: number of records in the window
+ *
+ * Return: None
+ */
+static void qdf_dp_trace_iter_window(struct qdf_dp_trace_iter *iter,
+				     uint32_t count)
+{
+	struct qdf_dp_trace_iter start;
+	uint32_t i, index;
+
+	qdf_dp_trace_iter_init(iter);
+	start = *iter;
+	for (i = 0; i < count; i++)
+		if (!qdf_dp_trace_iter_prev(iter, NULL, &index))
+			break;
+	qdf_dp_trace_iter_reverse(iter, &start);
+}
+
 #define QDF_DP_TRACE_PREPEND_STR_SIZE 100
 /*
  * one dp trace record can't be greater than 300 bytes.
@@ -585,6 +978,7 @@ void qdf_dp_trace_init(bool live_mode_config, uint8_t thresh,
 		return;
 	}
 	qdf_dp_trace_spin_lock_init();
+	qdf_dp_trace_rings_init();
 	qdf_dp_trace_clear_buffer();
 	g_qdf_dp_trace_data.enable = true;
 	g_qdf_dp_trace_data.no_of_record = 1;
@@ -1222,6 +1616,7 @@ static void qdf_dp_add_record(enum QDF_DP_TRACE_ID code, uint8_t pdev_id,
 
 {
 	struct qdf_dp_trace_record_s *rec = NULL;
+	struct qdf_dp_trace_ring *ring;
 	int index;
 	bool print_this_record = false;
 	u8 info = 0;
@@ -1233,7 +1628,10 @@ static void qdf_dp_add_record(enum QDF_DP_TRACE_ID code, uint8_t pdev_id,
 		return;
 	}
 
-	spin_lock_bh(&l_dp_trace_lock);
+	/* only the local ring is claimed; live mode counters are advisory */
+	ring = qdf_dp_trace_write_begin();
+	if (!ring)
+		return;
 
 	if (print || g_qdf_dp_trace_data.force_live_mode) {
 		print_this_record = true;
@@ -1249,32 +1647,8 @@ static void qdf_dp_add_record(enum QDF_DP_TRACE_ID code, uint8_t pdev_id,
 		}
 	}
 
-	g_qdf_dp_trace_data.num++;
-
-	if (g_qdf_dp_trace_data.num > MAX_QDF_DP_TRACE_RECORDS)
-		g_qdf_dp_trace_data.num = MAX_QDF_DP_TRACE_RECORDS;
-
-	if (INVALID_QDF_DP_TRACE_ADDR == g_qdf_dp_trace_data.head) {
-		/* first record */
-		g_qdf_dp_trace_data.head = 0;
-		g_qdf_dp_trace_data.tail = 0;
-	} else {
-		/* queue is not empty */
-		g_qdf_dp_trace_data.tail++;
-
-		if (MAX_QDF_DP_TRACE_RECORDS == g_qdf_dp_trace_data.tail)
-			g_qdf_dp_trace_data.tail = 0;
-
-		if (g_qdf_dp_trace_data.head == g_qdf_dp_trace_data.tail) {
-			/* full */
-			if (MAX_QDF_DP_TRACE_RECORDS ==
-				++g_qdf_dp_trace_data.head)
-				g_qdf_dp_trace_data.head = 0;
-		}
-	}
-
-	rec = &g_qdf_dp_trace_tbl[g_qdf_dp_trace_data.tail];
-	index = g_qdf_dp_trace_data.tail;
+	index = qdf_dp_trace_ring_advance(ring);
+	rec = &g_qdf_dp_trace_tbl[index];
 	rec->code = code;
 	rec->pdev_id = pdev_id;
 	rec->size = 0;
@@ -1283,14 +1657,7 @@ static void qdf_dp_add_record(enum QDF_DP_TRACE_ID code, uint8_t pdev_id,
 	rec->time = qdf_get_log_timestamp();
 	rec->pid = (in_interrupt() ? 0 : current->pid);
 
-	if (rec->code >= QDF_DP_TRACE_MAX) {
-		QDF_TRACE_ERROR(QDF_MODULE_ID_QDF,
-				"invalid record code %u, max code %u",
-				rec->code, QDF_DP_TRACE_MAX);
-		return;
-	}
-
-	spin_unlock_bh(&l_dp_trace_lock);
+	qdf_dp_trace_write_end(ring);
 
 	info |= QDF_DP_TRACE_RECORD_INFO_LIVE;
 	if (print_this_record)
@@ -2609,7 +2976,13 @@ qdf_export_symbol(qdf_dp_trace);
 
 void qdf_dp_trace_spin_lock_init(void)
 {
+	uint32_t i;
+
 	spin_lock_init(&l_dp_trace_lock);
+	for (i = 0; i < QDF_DP_TRACE_MAX_RINGS; i++) {
+		seqcount_init(&g_qdf_dp_trace_ring[i].seq);
+		spin_lock_init(&g_qdf_dp_trace_ring[i].lock);
+	}
 }
 qdf_export_symbol(qdf_dp_trace_spin_lock_init);
 
@@ -2627,15 +3000,21 @@ qdf_export_symbol(qdf_dp_trace_enable_live_mode);
 
 void qdf_dp_trace_clear_buffer(void)
 {
-	g_qdf_dp_trace_data.head = INVALID_QDF_DP_TRACE_ADDR;
-	g_qdf_dp_trace_data.tail = INVALID_QDF_DP_TRACE_ADDR;
-	g_qdf_dp_trace_data.num = 0;
+	struct qdf_dp_trace_ring *ring;
+	uint32_t i;
+
+	qdf_dp_trace_pause();
+	for (i = 0; i < g_qdf_dp_trace_num_rings; i++) {
+		ring = &g_qdf_dp_trace_ring[i];
+		qdf_dp_trace_ring_reset(ring);
+		if (g_qdf_dp_trace_data.enable)
+			memset(&g_qdf_dp_trace_tbl[ring->base], 0,
+			       g_qdf_dp_trace_ring_size *
+			       sizeof(struct qdf_dp_trace_record_s));
+	}
+	qdf_dp_trace_resume();
 	g_qdf_dp_trace_data.dump_counter = 0;
 	g_qdf_dp_trace_data.num_records_to_dump = MAX_QDF_DP_TRACE_RECORDS;
-	if (g_qdf_dp_trace_data.enable)
-		memset(g_qdf_dp_trace_tbl, 0,
-		       MAX_QDF_DP_TRACE_RECORDS *
-		       sizeof(struct qdf_dp_trace_record_s));
 }
 qdf_export_symbol(qdf_dp_trace_clear_buffer);
 
@@ -2842,9 +3221,7 @@ static void qdf_dpt_display_record_debugfs(qdf_debugfs_file_t file,
 uint32_t qdf_dpt_get_curr_pos_debugfs(qdf_debugfs_file_t file,
 				      enum qdf_dpt_debugfs_state state)
 {
-	uint32_t i = 0;
-	uint32_t tail;
-	uint32_t count = g_qdf_dp_trace_data.num;
+	uint32_t count = qdf_dp_trace_total_records();
 
 	if (!g_qdf_dp_trace_data.enable) {
 		QDF_TRACE(QDF_MODULE_ID_QDF, QDF_TRACE_LEVEL_DEBUG,
@@ -2896,29 +3273,13 @@ uint32_t qdf_dpt_get_curr_pos_debugfs(qdf_debugfs_file_t file,
 		g_qdf_dp_trace_data.eapol_others);
 
 	qdf_debugfs_printf(file,
-		"DPT: Total Records: %d, Head: %d, Tail: %d\n",
-		g_qdf_dp_trace_data.num, g_qdf_dp_trace_data.head,
-		g_qdf_dp_trace_data.tail);
+		"DPT: Total Records: %u, Rings: %u\n",
+		count, g_qdf_dp_trace_num_rings);
 
-	spin_lock_bh(&l_dp_trace_lock);
-	if (g_qdf_dp_trace_data.head != INVALID_QDF_DP_TRACE_ADDR) {
-		i = g_qdf_dp_trace_data.head;
-		tail = g_qdf_dp_trace_data.tail;
-
-		if (count > g_qdf_dp_trace_data.num)
-			count = g_qdf_dp_trace_data.num;
-
-		if (tail >= (count - 1))
-			i = tail - count + 1;
-		else if (count != MAX_QDF_DP_TRACE_RECORDS)
-			i = MAX_QDF_DP_TRACE_RECORDS - ((count - 1) -
-						     tail);
-		g_qdf_dp_trace_data.curr_pos = 0;
-		g_qdf_dp_trace_data.saved_tail = tail;
-	}
-	spin_unlock_bh(&l_dp_trace_lock);
+	qdf_dp_trace_iter_init(&g_qdf_dpt_debugfs_iter);
+	g_qdf_dp_trace_data.curr_pos = 0;
 
-	return g_qdf_dp_trace_data.saved_tail;
+	return g_qdf_dp_trace_data.curr_pos;
 }
 qdf_export_symbol(qdf_dpt_get_curr_pos_debugfs);
 
@@ -2926,8 +3287,9 @@ QDF_STATUS qdf_dpt_dump_stats_debugfs(qdf_debugfs_file_t file,
 				      uint32_t curr_pos)
 {
 	struct qdf_dp_trace_record_s p_record;
-	uint32_t i = curr_pos;
-	uint16_t num_records_to_dump = g_qdf_dp_trace_data.num_records_to_dump;
+	uint32_t i;
+	uint32_t num_records_to_dump = g_qdf_dp_trace_data.num_records_to_dump;
+	uint32_t total = qdf_dp_trace_total_records();
 
 	if (!g_qdf_dp_trace_data.enable) {
 		QDF_TRACE(QDF_MODULE_ID_QDF, QDF_TRACE_LEVEL_ERROR,
@@ -2935,8 +3297,11 @@ QDF_STATUS qdf_dpt_dump_stats_debugfs(qdf_debugfs_file_t file,
 		return QDF_STATUS_E_FAILURE;
 	}
 
-	if (num_records_to_dump > g_qdf_dp_trace_data.num)
-		num_records_to_dump = g_qdf_dp_trace_data.num;
+	if (num_records_to_dump > total)
+		num_records_to_dump = total;
+
+	if (!num_records_to_dump)
+		return QDF_STATUS_SUCCESS;
 
 	/*
 	 * Max dp trace record size should always be less than
@@ -2946,23 +3311,25 @@ QDF_STATUS qdf_dpt_dump_stats_debugfs(qdf_debugfs_file_t file,
 				QDF_DP_TRACE_PREPEND_STR_SIZE + BUFFER_SIZE))
 		return QDF_STATUS_E_FAILURE;
 
-	spin_lock_bh(&l_dp_trace_lock);
-	p_record = g_qdf_dp_trace_tbl[i];
-	spin_unlock_bh(&l_dp_trace_lock);
+	g_qdf_dp_trace_data.dump_counter = curr_pos;
 
-	for (;; ) {
+	while (g_qdf_dp_trace_data.dump_counter < num_records_to_dump) {
 		/*
 		 * Initially we get file as 1 page size, and
 		 * if remaining size in file is less than one record max size,
 		 * then return so that it gets an extra page.
 		 */
 		if ((file->size - file->count) < QDF_DP_TRACE_MAX_RECORD_SIZE) {
-			spin_lock_bh(&l_dp_trace_lock);
-			g_qdf_dp_trace_data.curr_pos = i;
-			spin_unlock_bh(&l_dp_trace_lock);
+			g_qdf_dp_trace_data.curr_pos =
+					g_qdf_dp_trace_data.dump_counter;
 			return QDF_STATUS_E_FAILURE;
 		}
 
+		/* newest first, merged across the per-CPU rings */
+		if (!qdf_dp_trace_iter_prev(&g_qdf_dpt_debugfs_iter,
+					    &p_record, &i))
+			break;
+
 		switch (p_record.code) {
 		case QDF_DP_TRACE_TXRX_PACKET_PTR_RECORD:
 		case QDF_DP_TRACE_TXRX_FAST_PACKET_PTR_RECORD:
@@ -3034,16 +3401,7 @@ QDF_STATUS qdf_dpt_dump_stats_debugfs(qdf_debugfs_file_t file,
 			break;
 		}
 
-		if (++g_qdf_dp_trace_data.dump_counter == num_records_to_dump)
-			break;
-
-		spin_lock_bh(&l_dp_trace_lock);
-		if (i == 0)
-			i = MAX_QDF_DP_TRACE_RECORDS;
-
-		i -= 1;
-		p_record = g_qdf_dp_trace_tbl[i];
-		spin_unlock_bh(&l_dp_trace_lock);
+		g_qdf_dp_trace_data.dump_counter++;
 	}
 
 	g_qdf_dp_trace_data.dump_counter = 0;
@@ -3068,7 +3426,9 @@ qdf_export_symbol(qdf_dpt_set_value_debugfs);
 void qdf_dp_trace_dump_all(uint32_t count, uint8_t pdev_id)
 {
 	struct qdf_dp_trace_record_s p_record;
-	int32_t i, tail;
+	struct qdf_dp_trace_iter iter;
+	uint32_t total = qdf_dp_trace_total_records();
+	uint32_t index;
 
 	if (!g_qdf_dp_trace_data.enable) {
 		DPTRACE_PRINT("Tracing Disabled");
@@ -3086,48 +3446,22 @@ void qdf_dp_trace_dump_all(uint32_t count, uint8_t pdev_id)
 
 	qdf_dp_trace_dump_stats();
 
-	DPTRACE_PRINT("DPT: Total Records: %d, Head: %d, Tail: %d",
-		      g_qdf_dp_trace_data.num, g_qdf_dp_trace_data.head,
-		      g_qdf_dp_trace_data.tail);
-
-	/* acquire the lock so that only one thread at a time can read
-	 * the ring buffer
-	 */
-	spin_lock_bh(&l_dp_trace_lock);
-
-	if (g_qdf_dp_trace_data.head != INVALID_QDF_DP_TRACE_ADDR) {
-		i = g_qdf_dp_trace_data.head;
-		tail = g_qdf_dp_trace_data.tail;
-
-		if (count) {
-			if (count > g_qdf_dp_trace_data.num)
-				count = g_qdf_dp_trace_data.num;
-			if (tail >= (count - 1))
-				i = tail - count + 1;
-			else if (count != MAX_QDF_DP_TRACE_RECORDS)
-				i = MAX_QDF_DP_TRACE_RECORDS - ((count - 1) -
-							     tail);
-		}
+	DPTRACE_PRINT("DPT: Total Records: %u, Rings: %u",
+		      total, g_qdf_dp_trace_num_rings);
 
-		p_record = g_qdf_dp_trace_tbl[i];
-		spin_unlock_bh(&l_dp_trace_lock);
-		for (;; ) {
-			qdf_dp_trace_cb_table[p_record.code](&p_record,
-							(uint16_t)i, pdev_id, false);
-			if (i == tail)
-				break;
-			i += 1;
+	if (!count || count > total)
+		count = total;
 
-			spin_lock_bh(&l_dp_trace_lock);
-			if (MAX_QDF_DP_TRACE_RECORDS == i)
-				i = 0;
+	/*
+	 * Walk back over the @count newest records of the merged timeline
+	 * to find where each ring starts, then print them oldest first.
+	 */
+	qdf_dp_trace_iter_window(&iter, count);
 
-			p_record = g_qdf_dp_trace_tbl[i];
-			spin_unlock_bh(&l_dp_trace_lock);
-		}
-	} else {
-		spin_unlock_bh(&l_dp_trace_lock);
-	}
+	while (qdf_dp_trace_iter_next(&iter, &p_record, &index))
+		qdf_dp_trace_cb_table[p_record.code](&p_record,
+						     (uint16_t)index,
+						     pdev_id, false);
 }
 qdf_export_symbol(qdf_dp_trace_dump_all);
 
@@ -3178,6 +3512,134 @@ void qdf_dp_trace_apply_tput_policy(bool is_data_traffic)
 check_live_mode:
 	qdf_dp_trace_throttle_live_mode(is_data_traffic);
 }
+
+#ifdef WLAN_DP_TRACE_TEST
+static bool qdf_dp_trace_test_saved_enable;
+
+/**
+ * qdf_dp_trace_test_reset() - empty every ring and the record table
+ *
+ * Return: None
+ */
+static void qdf_dp_trace_test_reset(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < g_qdf_dp_trace_num_rings; i++)
+		qdf_dp_trace_ring_reset(&g_qdf_dp_trace_ring[i]);
+	memset(g_qdf_dp_trace_tbl, 0,
+	       MAX_QDF_DP_TRACE_RECORDS * sizeof(struct qdf_dp_trace_record_s));
+}
+
+QDF_STATUS qdf_dp_trace_test_begin(uint32_t num_rings)
+{
+	if (!num_rings || num_rings > QDF_DP_TRACE_MAX_RINGS)
+		return QDF_STATUS_E_INVAL;
+
+#ifdef WLAN_LOGGING_BUFFERS_DYNAMICALLY
+	if (!g_qdf_dp_trace_tbl)
+		return QDF_STATUS_E_NOSUPPORT;
+#endif
+
+	qdf_dp_trace_test_saved_enable = g_qdf_dp_trace_data.enable;
+	g_qdf_dp_trace_data.enable = false;
+
+	/* let writers that passed the enable check finish their record */
+	qdf_dp_trace_pause();
+	qdf_dp_trace_rings_setup(num_rings);
+	qdf_dp_trace_test_reset();
+	qdf_dp_trace_resume();
+
+	return QDF_STATUS_SUCCESS;
+}
+qdf_export_symbol(qdf_dp_trace_test_begin);
+
+uint32_t qdf_dp_trace_test_ring_size(void)
+{
+	return g_qdf_dp_trace_ring_size;
+}
+qdf_export_symbol(qdf_dp_trace_test_ring_size);
+
+void qdf_dp_trace_test_add(uint32_t ring_id, uint64_t time)
+{
+	struct qdf_dp_trace_ring *ring;
+	uint32_t index;
+
+	ring = &g_qdf_dp_trace_ring[ring_id % g_qdf_dp_trace_num_rings];
+	spin_lock_bh(&ring->lock);
+	write_seqcount_begin(&ring->seq);
+	index = qdf_dp_trace_ring_advance(ring);
+	g_qdf_dp_trace_tbl[index].code = QDF_DP_TRACE_DROP_PACKET_RECORD;
+	g_qdf_dp_trace_tbl[index].time = time;
+	write_seqcount_end(&ring->seq);
+	spin_unlock_bh(&ring->lock);
+}
+qdf_export_symbol(qdf_dp_trace_test_add);
+
+void qdf_dp_trace_test_add_local(uint8_t *data, uint8_t data_size)
+{
+	struct qdf_dp_trace_record_s *rec;
+	struct qdf_dp_trace_ring *ring;
+
+	ring = qdf_dp_trace_write_begin();
+	if (!ring)
+		return;
+
+	rec = &g_qdf_dp_trace_tbl[qdf_dp_trace_ring_advance(ring)];
+	rec->code = QDF_DP_TRACE_DROP_PACKET_RECORD;
+	rec->pdev_id = QDF_TRACE_DEFAULT_PDEV_ID;
+	rec->size = 0;
+	qdf_dp_fill_record_data(rec, data, data_size, NULL, 0);
+	rec->time = qdf_get_log_timestamp();
+	rec->pid = (in_interrupt() ? 0 : current->pid);
+
+	qdf_dp_trace_write_end(ring);
+}
+qdf_export_symbol(qdf_dp_trace_test_add_local);
+
+uint32_t qdf_dp_trace_test_num_records(void)
+{
+	return qdf_dp_trace_total_records();
+}
+qdf_export_symbol(qdf_dp_trace_test_num_records);
+
+uint32_t qdf_dp_trace_test_walk_newest(uint64_t *times, uint32_t max)
+{
+	struct qdf_dp_trace_record_s record;
+	struct qdf_dp_trace_iter iter;
+	uint32_t index, n = 0;
+
+	qdf_dp_trace_iter_init(&iter);
+	while (n < max && qdf_dp_trace_iter_prev(&iter, &record, &index))
+		times[n++] = record.time;
+
+	return n;
+}
+qdf_export_symbol(qdf_dp_trace_test_walk_newest);
+
+uint32_t qdf_dp_trace_test_walk_window(uint32_t count, uint64_t *times,
+				       uint32_t max)
+{
+	struct qdf_dp_trace_record_s record;
+	struct qdf_dp_trace_iter iter;
+	uint32_t index, n = 0;
+
+	qdf_dp_trace_iter_window(&iter, count);
+	while (n < max && qdf_dp_trace_iter_next(&iter, &record, &index))
+		times[n++] = record.time;
+
+	return n;
+}
+qdf_export_symbol(qdf_dp_trace_test_walk_window);
+
+void qdf_dp_trace_test_end(void)
+{
+	qdf_dp_trace_rings_init();
+	qdf_dp_trace_test_reset();
+	g_qdf_dp_trace_data.enable = qdf_dp_trace_test_saved_enable;
+}
+qdf_export_symbol(qdf_dp_trace_test_end);
+#endif /* WLAN_DP_TRACE_TEST */
 #endif
 
 struct qdf_print_ctrl print_ctrl_obj[MAX_PRINT_CONFIG_SUPPORTED];
@@ -0,0 +1,263 @@
+/*
+ * Copyright (c) 2024 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted, provided that the
+ * above copyright notice and this permission notice appear in all
+ * copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+ * AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR
+ * PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+ * TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#include "qdf_dp_trace_test.h"
+#include "qdf_mem.h"
+#include "qdf_threads.h"
+#include "qdf_time.h"
+#include "qdf_trace.h"
+#include "qdf_util.h"
+
+#define QDF_DP_TRACE_TEST_TIME_BASE 1000
+#define QDF_DP_TRACE_TEST_MAX_WRITERS 8
+#define QDF_DP_TRACE_TEST_ITERS (1 << 18)
+#define QDF_DP_TRACE_TEST_DATA_SIZE 16
+
+struct qdf_dp_trace_test_ctx {
+	uint8_t ring_of[MAX_QDF_DP_TRACE_RECORDS * 3];
+	uint64_t expected[MAX_QDF_DP_TRACE_RECORDS];
+	uint64_t single[MAX_QDF_DP_TRACE_RECORDS];
+	uint64_t merged[MAX_QDF_DP_TRACE_RECORDS];
+};
+
+static void qdf_dp_trace_test_spread(struct qdf_dp_trace_test_ctx *ctx,
+				     uint32_t count)
+{
+	uint32_t seed = 0x2545f491;
+	uint32_t i;
+
+	/* bursty: runs of 1..8 records on one ring, as with NAPI polling */
+	for (i = 0; i < count; ) {
+		uint32_t run, ring;
+
+		seed = seed * 1103515245 + 12345;
+		ring = (seed >> 16) % QDF_DP_TRACE_MAX_RINGS;
+		run = 1 + ((seed >> 8) & 7);
+		while (run-- && i < count)
+			ctx->ring_of[i++] = ring;
+	}
+}
+
+static void qdf_dp_trace_test_record(struct qdf_dp_trace_test_ctx *ctx,
+				     uint32_t count)
+{
+	uint32_t i;
+
+	for (i = 0; i < count; i++)
+		qdf_dp_trace_test_add(ctx->ring_of[i],
+				      QDF_DP_TRACE_TEST_TIME_BASE + i);
+}
+
+static uint32_t qdf_dp_trace_test_compare(const uint64_t *a, const uint64_t *b,
+					  uint32_t count)
+{
+	uint32_t i;
+
+	for (i = 0; i < count; i++)
+		if (a[i] != b[i])
+			return 1;
+
+	return 0;
+}
+
+/*
+ * As long as no ring wraps, walking the merged rings must give exactly
+ * what a single shared ring gives for the same records.
+ */
+static uint32_t qdf_dp_trace_test_merge_order(struct qdf_dp_trace_test_ctx *ctx,
+					      uint32_t num_rings)
+{
+	uint32_t count, n, window, i;
+	uint32_t errors = 0;
+
+	if (QDF_IS_STATUS_ERROR(qdf_dp_trace_test_begin(num_rings)))
+		return 1;
+	count = qdf_dp_trace_test_ring_size();
+	qdf_dp_trace_test_end();
+
+	qdf_dp_trace_test_spread(ctx, count);
+
+	/* reference: one ring holding every record */
+	if (QDF_IS_STATUS_ERROR(qdf_dp_trace_test_begin(1)))
+		return 1;
+	qdf_dp_trace_test_record(ctx, count);
+	n = qdf_dp_trace_test_walk_newest(ctx->single, count);
+	qdf_dp_trace_test_end();
+	QDF_BUG(n == count);
+	if (n != count)
+		errors++;
+
+	if (QDF_IS_STATUS_ERROR(qdf_dp_trace_test_begin(num_rings)))
+		return errors + 1;
+	qdf_dp_trace_test_record(ctx, count);
+
+	/* newest first, as the debugfs dump reads */
+	n = qdf_dp_trace_test_walk_newest(ctx->merged, count);
+	QDF_BUG(n == count);
+	if (n != count ||
+	    qdf_dp_trace_test_compare(ctx->single, ctx->merged, count))
+		errors++;
+
+	/* oldest first over the newest third, as qdf_dp_trace_dump_all() */
+	window = count / 3;
+	for (i = 0; i < window; i++)
+		ctx->expected[i] = ctx->single[window - 1 - i];
+	n = qdf_dp_trace_test_walk_window(window, ctx->merged, count);
+	if (n != window ||
+	    qdf_dp_trace_test_compare(ctx->expected, ctx->merged, window))
+		errors++;
+
+	qdf_dp_trace_test_end();
+	QDF_BUG(!errors);
+
+	return errors;
+}
+
+/*
+ * Once rings wrap, the merged walk must hold, newest first, the last
+ * ring size records of every ring and nothing else.
+ */
+static uint32_t qdf_dp_trace_test_wrap(struct qdf_dp_trace_test_ctx *ctx,
+				       uint32_t num_rings)
+{
+	uint32_t kept[QDF_DP_TRACE_MAX_RINGS] = {0};
+	uint32_t ring_size, count, expected = 0, n;
+	uint32_t errors = 0;
+	int i;
+
+	if (QDF_IS_STATUS_ERROR(qdf_dp_trace_test_begin(num_rings)))
+		return 1;
+
+	ring_size = qdf_dp_trace_test_ring_size();
+	count = qdf_min((uint32_t)sizeof(ctx->ring_of),
+			3 * ring_size * num_rings);
+	qdf_dp_trace_test_spread(ctx, count);
+	qdf_dp_trace_test_record(ctx, count);
+
+	for (i = count - 1; i >= 0; i--) {
+		uint32_t ring = ctx->ring_of[i] % num_rings;
+
+		if (kept[ring] == ring_size)
+			continue;
+		kept[ring]++;
+		ctx->expected[expected++] = QDF_DP_TRACE_TEST_TIME_BASE + i;
+	}
+
+	n = qdf_dp_trace_test_walk_newest(ctx->merged,
+					  MAX_QDF_DP_TRACE_RECORDS);
+	if (n != expected ||
+	    qdf_dp_trace_test_compare(ctx->expected, ctx->merged, expected))
+		errors++;
+
+	qdf_dp_trace_test_end();
+	QDF_BUG(!errors);
+
+	return errors;
+}
+
+/* what every traced TX/RX packet costs the writer */
+static QDF_STATUS qdf_dp_trace_test_writer_thread(void *context)
+{
+	uint8_t data[QDF_DP_TRACE_TEST_DATA_SIZE] = { 0 };
+	uint32_t i;
+
+	for (i = 0; i < QDF_DP_TRACE_TEST_ITERS; i++) {
+		data[0] = i;
+		qdf_dp_trace_test_add_local(data, sizeof(data));
+	}
+
+	return QDF_STATUS_SUCCESS;
+}
+
+/*
+ * With a single ring every writer serializes on its lock, as all of them
+ * did before the table was split; with one ring per CPU they do not.
+ */
+static uint32_t qdf_dp_trace_test_writers(uint32_t num_writers,
+					  uint32_t num_rings)
+{
+	qdf_thread_t *threads[QDF_DP_TRACE_TEST_MAX_WRITERS];
+	uint32_t ring_size, records, expected;
+	qdf_ktime_t start;
+	int64_t elapsed_us;
+	uint32_t errors = 0;
+	uint32_t i;
+
+	if (QDF_IS_STATUS_ERROR(qdf_dp_trace_test_begin(num_rings)))
+		return 1;
+	ring_size = qdf_dp_trace_test_ring_size();
+
+	start = qdf_ktime_get();
+	for (i = 0; i < num_writers; i++) {
+		threads[i] = qdf_thread_run(qdf_dp_trace_test_writer_thread,
+					    NULL);
+		QDF_BUG(threads[i]);
+		if (!threads[i])
+			num_writers = i;
+	}
+
+	for (i = 0; i < num_writers; i++)
+		qdf_thread_join(threads[i]);
+	elapsed_us = qdf_ktime_to_us(qdf_ktime_get()) - qdf_ktime_to_us(start);
+
+	/* however writers spread over the rings, these many are kept */
+	expected = qdf_min(num_writers * QDF_DP_TRACE_TEST_ITERS, ring_size);
+	records = qdf_dp_trace_test_num_records();
+	if (records < expected || records > ring_size * num_rings)
+		errors++;
+
+	qdf_dp_trace_test_end();
+
+	qdf_nofl_info("qdf_dp_trace: %u writers %u rings: %lld us, %llu ns per record, %u records kept, %u errors",
+		      num_writers, num_rings, elapsed_us,
+		      (unsigned long long)(elapsed_us * 1000 /
+					   (num_writers *
+					    QDF_DP_TRACE_TEST_ITERS)),
+		      records, errors);
+
+	return errors;
+}
+
+uint32_t qdf_dp_trace_unit_test(void)
+{
+	struct qdf_dp_trace_test_ctx *ctx;
+	uint32_t num_rings, num_writers;
+	uint32_t errors = 0;
+
+	ctx = qdf_mem_valloc(sizeof(*ctx));
+	if (!ctx)
+		return 1;
+
+	for (num_rings = 1; num_rings <= QDF_DP_TRACE_MAX_RINGS;
+	     num_rings <<= 1) {
+		errors += qdf_dp_trace_test_merge_order(ctx, num_rings);
+		errors += qdf_dp_trace_test_wrap(ctx, num_rings);
+	}
+
+	for (num_writers = 1; num_writers <= QDF_DP_TRACE_TEST_MAX_WRITERS;
+	     num_writers <<= 1) {
+		errors += qdf_dp_trace_test_writers(num_writers, 1);
+		errors += qdf_dp_trace_test_writers(num_writers,
+						    QDF_DP_TRACE_MAX_RINGS);
+	}
+
+	qdf_mem_vfree(ctx);
+
+	return errors;
+}
@@ -34,6 +34,14 @@
 #define SCHEDULER_NUMBER_OF_MSG_QUEUE 6
 #define SCHEDULER_WRAPPER_MAX_FAIL_COUNT (SCHEDULER_CORE_MAX_MESSAGES * 3)
 #define SCHEDULER_WATCHDOG_TIMEOUT (10 * 1000) /* 10s */
+/* watchdog polls the running message this many times per timeout period */
+#define SCHEDULER_WATCHDOG_POLL_DIVISOR 4
+/* watchdog_flags bit set while the watchdog poll timer is pending */
+#define SCHEDULER_WATCHDOG_ARMED 0
+#ifndef SCHEDULER_MSG_BATCH_SIZE
+/* max messages dequeued from one queue before rechecking higher priority */
+#define SCHEDULER_MSG_BATCH_SIZE 8
+#endif
 
 #ifdef CONFIG_AP_PLATFORM
 #define SCHED_DEBUG_PANIC(msg)
@@ -107,8 +115,11 @@ struct scheduler_mq_ctx {
  * @legacy_wma_handler: legacy wma message handler
  * @legacy_sys_handler: legacy sys message handler
  * @timeout: timeout value for scheduler watchdog timer
- * @watchdog_timer: timer for triggering a scheduler watchdog bite
+ * @watchdog_timer: periodic timer checking the run time of the current msg
  * @watchdog_callback: the callback of the current msg being processed
+ * @watchdog_msg_start_us: timestamp when the current msg started execution
+ *	in microseconds, 0 when no msg is being processed
+ * @watchdog_flags: watchdog state flags
  */
 struct scheduler_ctx {
 	struct scheduler_mq_ctx queue_ctx;
@@ -127,6 +138,8 @@ struct scheduler_ctx {
 	uint32_t timeout;
 	qdf_timer_t watchdog_timer;
 	void *watchdog_callback;
+	uint64_t watchdog_msg_start_us;
+	unsigned long watchdog_flags;
 };
 
 /**
@@ -147,6 +160,14 @@ struct scheduler_msg *scheduler_core_msg_dup(struct scheduler_msg *msg);
  */
 void scheduler_core_msg_free(struct scheduler_msg *msg);
 
+/**
+ * scheduler_watchdog_arm() - start the watchdog poll timer if not pending
+ * @sched_ctx: pointer to scheduler context
+ *
+ * Return: None
+ */
+void scheduler_watchdog_arm(struct scheduler_ctx *sched_ctx);
+
 /**
  * scheduler_get_context() - to get scheduler context
  *
@@ -217,6 +238,21 @@ void scheduler_mq_put_front(struct scheduler_mq_type *msg_q,
  */
 struct scheduler_msg *scheduler_mq_get(struct scheduler_mq_type *msg_q);
 
+/**
+ * scheduler_mq_get_batch() - to get a batch of messages from message queue
+ * @msg_q: Pointer to the message queue
+ * @msgs: array to fill with the dequeued messages
+ * @max_msgs: size of @msgs
+ *
+ * This function is used to get up to @max_msgs messages from given message
+ * queue under a single acquisition of the queue lock
+ *
+ * Return: number of messages dequeued
+ */
+uint32_t scheduler_mq_get_batch(struct scheduler_mq_type *msg_q,
+				struct scheduler_msg **msgs,
+				uint32_t max_msgs);
+
 /**
  * scheduler_queues_init() - to initialize all the modules' queues
  * @sched_ctx: pointer to scheduler context
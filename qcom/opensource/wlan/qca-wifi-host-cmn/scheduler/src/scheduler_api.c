@@ -75,6 +75,21 @@ static inline void scheduler_watchdog_notify(struct scheduler_ctx *sched)
 static void scheduler_watchdog_timeout(void *arg)
 {
 	struct scheduler_ctx *sched = arg;
+	uint64_t start_us;
+
+	qdf_atomic_test_and_clear_bit(SCHEDULER_WATCHDOG_ARMED,
+				      &sched->watchdog_flags);
+
+	/* nothing is running, the thread re-arms us on its next message */
+	start_us = sched->watchdog_msg_start_us;
+	if (!start_us)
+		return;
+
+	if (qdf_get_log_timestamp_usecs() - start_us <
+	    (uint64_t)sched->timeout * 1000) {
+		scheduler_watchdog_arm(sched);
+		return;
+	}
 
 	if (qdf_is_recovering()) {
 		sched_debug("Recovery is in progress ignore timeout");
@@ -177,6 +192,8 @@ QDF_STATUS scheduler_init(void)
 	qdf_init_waitqueue_head(&sched_ctx->sch_wait_queue);
 	sched_ctx->sch_event_flag = 0;
 	sched_ctx->timeout = SCHEDULER_WATCHDOG_TIMEOUT;
+	sched_ctx->watchdog_msg_start_us = 0;
+	sched_ctx->watchdog_flags = 0;
 	qdf_timer_init(NULL,
 		       &sched_ctx->watchdog_timer,
 		       &scheduler_watchdog_timeout,
@@ -38,6 +38,10 @@ DEFINE_QDF_FLEX_MEM_POOL(sched_pool, sizeof(struct scheduler_msg),
 			       "--------------------------------------" \
 			       "--------------------------------------"
 
+#define SCHEDULER_RESIDENCY_HEADER "|Queue Id|Messages  " \
+				   "|Avg Queue Duration(us)" \
+				   "|Max Queue Duration(us)|"
+
 /**
  * struct sched_history_item - metrics for a scheduler message
  * @callback: the message's execution callback
@@ -60,8 +64,24 @@ struct sched_history_item {
 	uint32_t run_duration_us;
 };
 
+/**
+ * struct sched_residency_stats - queue residency metrics of a message queue
+ * @queue_id: Id of the queue
+ * @count: number of messages processed from the queue
+ * @total_us: total time messages were queued in microseconds
+ * @max_us: longest time a message was queued in microseconds
+ */
+struct sched_residency_stats {
+	QDF_MODULE_ID queue_id;
+	uint32_t count;
+	uint64_t total_us;
+	uint32_t max_us;
+};
+
 static struct sched_history_item sched_history[WLAN_SCHED_HISTORY_SIZE];
 static uint32_t sched_history_index;
+static struct sched_residency_stats
+	sched_residency[SCHEDULER_NUMBER_OF_MSG_QUEUE];
 
 static void sched_history_queue(struct scheduler_mq_type *queue,
 				struct scheduler_msg *msg)
@@ -71,12 +91,14 @@ static void sched_history_queue(struct scheduler_mq_type *queue,
 	msg->queued_at_us = qdf_get_log_timestamp_usecs();
 }
 
-static void sched_history_start(struct scheduler_msg *msg)
+static void sched_history_start(struct scheduler_msg *msg, uint32_t qidx,
+				uint64_t started_at_us)
 {
-	uint64_t started_at_us = qdf_get_log_timestamp_usecs();
+	struct sched_residency_stats *res = &sched_residency[qidx];
 	struct sched_history_item hist = {
 		.callback = msg->callback,
 		.type_id = msg->type,
+		.queue_id = msg->queue_id,
 		.queue_start_us = msg->queued_at_us,
 		.queue_duration_us = started_at_us - msg->queued_at_us,
 		.queue_depth = msg->queue_depth,
@@ -84,6 +106,12 @@ static void sched_history_start(struct scheduler_msg *msg)
 	};
 
 	sched_history[sched_history_index] = hist;
+
+	res->queue_id = msg->queue_id;
+	res->count++;
+	res->total_us += hist.queue_duration_us;
+	if (hist.queue_duration_us > res->max_us)
+		res->max_us = hist.queue_duration_us;
 }
 
 static void sched_history_stop(void)
@@ -132,6 +160,22 @@ void sched_history_print(void)
 				 item->run_duration_us);
 	}
 
+	sched_nofl_fatal(SCHEDULER_HISTORY_LINE);
+	sched_nofl_fatal(SCHEDULER_RESIDENCY_HEADER);
+	sched_nofl_fatal(SCHEDULER_HISTORY_LINE);
+
+	for (idx = 0; idx < SCHEDULER_NUMBER_OF_MSG_QUEUE; idx++) {
+		struct sched_residency_stats *res = &sched_residency[idx];
+
+		if (!res->count)
+			continue;
+
+		sched_nofl_fatal("|%8d|%10u|%22llu|%22u|",
+				 res->queue_id, res->count,
+				 qdf_do_div(res->total_us, res->count),
+				 res->max_us);
+	}
+
 	sched_nofl_fatal(SCHEDULER_HISTORY_LINE);
 
 	qdf_mem_free(history);
@@ -140,7 +184,9 @@ void sched_history_print(void)
 
 static inline void sched_history_queue(struct scheduler_mq_type *queue,
 				       struct scheduler_msg *msg) { }
-static inline void sched_history_start(struct scheduler_msg *msg) { }
+static inline void sched_history_start(struct scheduler_msg *msg,
+				       uint32_t qidx,
+				       uint64_t started_at_us) { }
 static inline void sched_history_stop(void) { }
 void sched_history_print(void) { }
 
@@ -281,6 +327,44 @@ struct scheduler_msg *scheduler_mq_get(struct scheduler_mq_type *msg_q)
 	return qdf_container_of(node, struct scheduler_msg, node);
 }
 
+uint32_t scheduler_mq_get_batch(struct scheduler_mq_type *msg_q,
+				struct scheduler_msg **msgs,
+				uint32_t max_msgs)
+{
+	qdf_list_node_t *node;
+	uint32_t count = 0;
+
+	qdf_spin_lock_irqsave(&msg_q->mq_lock);
+	while (count < max_msgs &&
+	       QDF_IS_STATUS_SUCCESS(qdf_list_remove_front(&msg_q->mq_list,
+							    &node)))
+		msgs[count++] = qdf_container_of(node, struct scheduler_msg,
+						 node);
+	qdf_spin_unlock_irqrestore(&msg_q->mq_lock);
+
+	return count;
+}
+
+/**
+ * scheduler_mq_return_batch() - put unprocessed messages back in the queue
+ * @msg_q: Pointer to the message queue
+ * @msgs: messages returned by scheduler_mq_get_batch()
+ * @count: number of messages in @msgs
+ *
+ * Messages are put back at the front of the queue in their original order.
+ *
+ * Return: none
+ */
+static void scheduler_mq_return_batch(struct scheduler_mq_type *msg_q,
+				      struct scheduler_msg **msgs,
+				      uint32_t count)
+{
+	qdf_spin_lock_irqsave(&msg_q->mq_lock);
+	while (count--)
+		qdf_list_insert_front(&msg_q->mq_list, &msgs[count]->node);
+	qdf_spin_unlock_irqrestore(&msg_q->mq_lock);
+}
+
 QDF_STATUS scheduler_queues_deinit(struct scheduler_ctx *sched_ctx)
 {
 	return scheduler_all_queues_deinit(sched_ctx);
@@ -348,12 +432,54 @@ void scheduler_core_msg_free(struct scheduler_msg *msg)
 	qdf_atomic_dec(&__sched_queue_depth);
 }
 
+void scheduler_watchdog_arm(struct scheduler_ctx *sched_ctx)
+{
+	if (qdf_atomic_test_and_set_bit(SCHEDULER_WATCHDOG_ARMED,
+					&sched_ctx->watchdog_flags))
+		return;
+
+	qdf_timer_mod(&sched_ctx->watchdog_timer,
+		      sched_ctx->timeout / SCHEDULER_WATCHDOG_POLL_DIVISOR);
+}
+
+/**
+ * scheduler_shutdown_requested() - check for a pending shutdown request
+ * @sch_ctx: pointer to scheduler context
+ * @shutdown: set to true when the scheduler thread has to exit
+ *
+ * Return: true if the scheduler thread was signaled to shutdown
+ */
+static bool scheduler_shutdown_requested(struct scheduler_ctx *sch_ctx,
+					 bool *shutdown)
+{
+	if (!qdf_atomic_test_bit(MC_SHUTDOWN_EVENT_MASK,
+				 &sch_ctx->sch_event_flag))
+		return false;
+
+	sched_debug("scheduler thread signaled to shutdown");
+	*shutdown = true;
+
+	/* Check for any Suspend Indication */
+	if (qdf_atomic_test_and_clear_bit(MC_SUSPEND_EVENT_MASK,
+					  &sch_ctx->sch_event_flag)) {
+		/* Unblock anyone waiting on suspend */
+		if (gp_sched_ctx->hdd_callback)
+			gp_sched_ctx->hdd_callback();
+	}
+
+	return true;
+}
+
 static void scheduler_thread_process_queues(struct scheduler_ctx *sch_ctx,
 					    bool *shutdown)
 {
 	int i;
 	QDF_STATUS status;
 	struct scheduler_msg *msg;
+	struct scheduler_msg *batch[SCHEDULER_MSG_BATCH_SIZE];
+	struct scheduler_mq_type *msg_q;
+	uint32_t num_msgs, j;
+	uint64_t ts_us;
 
 	if (!sch_ctx) {
 		QDF_DEBUG_PANIC("sch_ctx is null");
@@ -364,48 +490,53 @@ static void scheduler_thread_process_queues(struct scheduler_ctx *sch_ctx,
 	i = 0;
 	while (i < SCHEDULER_NUMBER_OF_MSG_QUEUE) {
 		/* Check if MC needs to shutdown */
-		if (qdf_atomic_test_bit(MC_SHUTDOWN_EVENT_MASK,
-					&sch_ctx->sch_event_flag)) {
-			sched_debug("scheduler thread signaled to shutdown");
-			*shutdown = true;
-
-			/* Check for any Suspend Indication */
-			if (qdf_atomic_test_and_clear_bit(MC_SUSPEND_EVENT_MASK,
-						&sch_ctx->sch_event_flag)) {
-				/* Unblock anyone waiting on suspend */
-				if (gp_sched_ctx->hdd_callback)
-					gp_sched_ctx->hdd_callback();
-			}
-
+		if (scheduler_shutdown_requested(sch_ctx, shutdown))
 			break;
-		}
 
-		msg = scheduler_mq_get(&sch_ctx->queue_ctx.sch_msg_q[i]);
-		if (!msg) {
+		msg_q = &sch_ctx->queue_ctx.sch_msg_q[i];
+		num_msgs = scheduler_mq_get_batch(msg_q, batch,
+						  SCHEDULER_MSG_BATCH_SIZE);
+		if (!num_msgs) {
 			/* check next queue */
 			i++;
 			continue;
 		}
 
-		if (sch_ctx->queue_ctx.scheduler_msg_process_fn[i]) {
+		for (j = 0; j < num_msgs; j++) {
+			if (j && scheduler_shutdown_requested(sch_ctx,
+							      shutdown)) {
+				/* leave the rest for scheduler_queues_flush */
+				scheduler_mq_return_batch(msg_q, &batch[j],
+							  num_msgs - j);
+				break;
+			}
+
+			msg = batch[j];
+			if (!sch_ctx->queue_ctx.scheduler_msg_process_fn[i])
+				continue;
+
 			sch_ctx->watchdog_msg_type = msg->type;
 			sch_ctx->watchdog_callback = msg->callback;
 
-			sched_history_start(msg);
-			qdf_timer_start(&sch_ctx->watchdog_timer,
-					sch_ctx->timeout);
+			ts_us = qdf_get_log_timestamp_usecs();
+			sched_history_start(msg, i, ts_us);
+			sch_ctx->watchdog_msg_start_us = ts_us;
+			scheduler_watchdog_arm(sch_ctx);
 			status = sch_ctx->queue_ctx.
 					scheduler_msg_process_fn[i](msg);
-			qdf_timer_stop(&sch_ctx->watchdog_timer);
+			sch_ctx->watchdog_msg_start_us = 0;
 			sched_history_stop();
 
 			if (QDF_IS_STATUS_ERROR(status))
 				sched_err("Failed processing Qid[%d] message",
-					  sch_ctx->queue_ctx.sch_msg_q[i].qid);
+					  msg_q->qid);
 
 			scheduler_core_msg_free(msg);
 		}
 
+		if (*shutdown)
+			break;
+
 		/* start again with highest priority queue at index 0 */
 		i = 0;
 	}
@@ -2195,6 +2195,190 @@ target_if_spectral_dump_phyerr_data_gen2(uint8_t *data, uint32_t datalen,
 	return 0;
 }
 
+/**
+ * target_if_spectral_unpack_fft_bins_generic() - Unpack FFT bins of any width
+ * @src: Source DWORDs
+ * @dest: Destination 8-bit FFT bins
+ * @num_dwords: Number of source DWORDs
+ * @hw_fft_bin_width: FFT bin width in bytes as reported by the HW
+ * @pwr_format: Spectral FFT bin format (linear/dBm mode)
+ *
+ * Reference unpacker, used for bin widths without a specialized path.
+ *
+ * Return: None
+ */
+static void
+target_if_spectral_unpack_fft_bins_generic(const uint32_t *src, uint8_t *dest,
+					   uint32_t num_dwords,
+					   uint8_t hw_fft_bin_width,
+					   uint16_t pwr_format)
+{
+	uint8_t num_bins_per_dword, hw_fft_bin_width_bits;
+	uint16_t fft_bin_val;
+	uint32_t dword_idx;
+	uint8_t idx;
+	uint32_t dword;
+
+	num_bins_per_dword = SPECTRAL_DWORD_SIZE / hw_fft_bin_width;
+	hw_fft_bin_width_bits = hw_fft_bin_width * QDF_CHAR_BIT;
+
+	for (dword_idx = 0; dword_idx < num_dwords; dword_idx++) {
+		dword = *src++; /* Read a DWORD */
+		for (idx = 0; idx < num_bins_per_dword; idx++) {
+			/**
+			 * If we use QDF_GET_BITS, when hw_fft_bin_width_bits is
+			 * 32, on certain platforms, we could end up doing a
+			 * 32-bit left shift operation on 32-bit constant
+			 * integer '1'. As per C standard, result of shifting an
+			 * operand by a count greater than or equal to width
+			 * (in bits) of the operand is undefined.
+			 * If we use QDF_GET_BITS_64, we can avoid that.
+			 */
+			fft_bin_val = (uint16_t)QDF_GET_BITS64(
+					dword,
+					idx * hw_fft_bin_width_bits,
+					hw_fft_bin_width_bits);
+
+			*dest++ = clamp_fft_bin_value(fft_bin_val, pwr_format);
+		}
+	}
+}
+
+/**
+ * target_if_spectral_clamp_dbm() - Clamp a signed FFT bin value to 8 bits
+ * @fft_bin_val: FFT bin value as reported by the HW
+ *
+ * Same result as clamp_fft_bin_value() in dBm mode, without branches.
+ *
+ * Return: Clamped FFT bin value
+ */
+static inline uint8_t target_if_spectral_clamp_dbm(int16_t fft_bin_val)
+{
+	int32_t val = fft_bin_val;
+
+	val = (val > MAX_FFTBIN_VALUE_DBM_MODE) ?
+	      MAX_FFTBIN_VALUE_DBM_MODE : val;
+	val = (val < MIN_FFTBIN_VALUE_DBM_MODE) ?
+	      MIN_FFTBIN_VALUE_DBM_MODE : val;
+
+	return (uint8_t)val;
+}
+
+/**
+ * target_if_spectral_unpack_fft_bins_8() - Unpack 8-bit FFT bins
+ * @src: Source DWORDs
+ * @dest: Destination 8-bit FFT bins
+ * @num_dwords: Number of source DWORDs
+ * @pwr_format: Spectral FFT bin format (linear/dBm mode)
+ *
+ * Linear bins need no clamping. dBm bins are read as unsigned 8-bit values
+ * by clamp_fft_bin_value(), so the ones above S8_MAX are clamped four at a
+ * time from their top bits.
+ *
+ * Return: None
+ */
+static void
+target_if_spectral_unpack_fft_bins_8(const uint32_t *src, uint8_t *dest,
+				     uint32_t num_dwords, uint16_t pwr_format)
+{
+	const uint32_t *end = src + num_dwords;
+	uint32_t dword, mask;
+
+#ifndef BIG_ENDIAN_HOST
+	if (pwr_format == SPECTRAL_PWR_FORMAT_LINEAR) {
+		qdf_mem_copy(dest, src, num_dwords * SPECTRAL_DWORD_SIZE);
+		return;
+	}
+#endif
+
+	while (src < end) {
+		dword = *src++;
+		if (pwr_format == SPECTRAL_PWR_FORMAT_DBM) {
+			/* 0xff in every byte above S8_MAX */
+			mask = ((dword & 0x80808080) >> 7) * 0xff;
+			dword = (dword & ~mask) | (0x7f7f7f7f & mask);
+		}
+		dest[0] = (uint8_t)dword;
+		dest[1] = (uint8_t)(dword >> 8);
+		dest[2] = (uint8_t)(dword >> 16);
+		dest[3] = (uint8_t)(dword >> 24);
+		dest += 4;
+	}
+}
+
+/**
+ * target_if_spectral_unpack_fft_bins_16() - Unpack 16-bit FFT bins
+ * @src: Source DWORDs
+ * @dest: Destination 8-bit FFT bins
+ * @num_dwords: Number of source DWORDs
+ * @pwr_format: Spectral FFT bin format (linear/dBm mode)
+ *
+ * Linear bins are saturated two at a time: a non-zero high byte in a
+ * 16-bit lane sets the low byte of that lane to U8_MAX.
+ *
+ * Return: None
+ */
+static void
+target_if_spectral_unpack_fft_bins_16(const uint32_t *src, uint8_t *dest,
+				      uint32_t num_dwords, uint16_t pwr_format)
+{
+	const uint32_t *end = src + num_dwords;
+	uint32_t dword, high, mask;
+
+	if (pwr_format == SPECTRAL_PWR_FORMAT_DBM) {
+		while (src < end) {
+			dword = *src++;
+			*dest++ = target_if_spectral_clamp_dbm((int16_t)dword);
+			*dest++ = target_if_spectral_clamp_dbm(
+					(int16_t)(dword >> 16));
+		}
+		return;
+	}
+
+	while (src < end) {
+		dword = *src++;
+		high = (dword >> 8) & 0x00ff00ff;
+		/* bit 8 of a lane is set if its high byte is non-zero */
+		mask = (((high + 0x00ff00ff) & 0x01000100) >> 8) * 0xff;
+		dword = (dword & 0x00ff00ff) | mask;
+		*dest++ = (uint8_t)dword;
+		*dest++ = (uint8_t)(dword >> 16);
+	}
+}
+
+/**
+ * target_if_spectral_unpack_fft_bins_32() - Unpack 32-bit FFT bins
+ * @src: Source DWORDs
+ * @dest: Destination 8-bit FFT bins
+ * @num_dwords: Number of source DWORDs
+ * @pwr_format: Spectral FFT bin format (linear/dBm mode)
+ *
+ * Only the low 16 bits of each bin are significant, as in
+ * clamp_fft_bin_value().
+ *
+ * Return: None
+ */
+static void
+target_if_spectral_unpack_fft_bins_32(const uint32_t *src, uint8_t *dest,
+				      uint32_t num_dwords, uint16_t pwr_format)
+{
+	const uint32_t *end = src + num_dwords;
+	uint16_t fft_bin_val;
+
+	if (pwr_format == SPECTRAL_PWR_FORMAT_DBM) {
+		while (src < end)
+			*dest++ = target_if_spectral_clamp_dbm(
+					(int16_t)*src++);
+		return;
+	}
+
+	while (src < end) {
+		fft_bin_val = (uint16_t)*src++;
+		*dest++ = (fft_bin_val > MAX_FFTBIN_VALUE_LINEAR_MODE) ?
+			  MAX_FFTBIN_VALUE_LINEAR_MODE : fft_bin_val;
+	}
+}
+
 QDF_STATUS
 target_if_spectral_copy_fft_bins(struct target_if_spectral *spectral,
 				 const void *src_fft_buf,
@@ -2203,14 +2387,9 @@ target_if_spectral_copy_fft_bins(struct target_if_spectral *spectral,
 				 uint32_t *bytes_copied,
 				 uint16_t pwr_format)
 {
-	uint16_t idx, dword_idx, fft_bin_idx;
-	uint8_t num_bins_per_dword, hw_fft_bin_width_bits;
+	uint8_t num_bins_per_dword;
 	uint32_t num_dwords;
-	uint16_t fft_bin_val;
 	struct spectral_report_params *rparams;
-	const uint32_t *dword_ptr;
-	uint32_t dword;
-	uint8_t *fft_bin_buf;
 
 	*bytes_copied = 0;
 
@@ -2232,31 +2411,35 @@ target_if_spectral_copy_fft_bins(struct target_if_spectral *spectral,
 	rparams = &spectral->rparams;
 	num_bins_per_dword = SPECTRAL_DWORD_SIZE / rparams->hw_fft_bin_width;
 	num_dwords = fft_bin_count / num_bins_per_dword;
-	hw_fft_bin_width_bits = rparams->hw_fft_bin_width * QDF_CHAR_BIT;
 
-	fft_bin_idx = 0;
-	dword_ptr = src_fft_buf;
-	fft_bin_buf = dest_fft_buf;
-	for (dword_idx = 0; dword_idx < num_dwords; dword_idx++) {
-		dword = *dword_ptr++; /* Read a DWORD */
-		for (idx = 0; idx < num_bins_per_dword; idx++) {
-			/**
-			 * If we use QDF_GET_BITS, when hw_fft_bin_width_bits is
-			 * 32, on certain platforms, we could end up doing a
-			 * 32-bit left shift operation on 32-bit constant
-			 * integer '1'. As per C standard, result of shifting an
-			 * operand by a count greater than or equal to width
-			 * (in bits) of the operand is undefined.
-			 * If we use QDF_GET_BITS_64, we can avoid that.
-			 */
-			fft_bin_val = (uint16_t)QDF_GET_BITS64(
-					dword,
-					idx * hw_fft_bin_width_bits,
-					hw_fft_bin_width_bits);
+	if (qdf_unlikely(pwr_format != SPECTRAL_PWR_FORMAT_LINEAR &&
+			 pwr_format != SPECTRAL_PWR_FORMAT_DBM)) {
+		spectral_err_rl("Invalid pwr format: %d.", pwr_format);
+		qdf_mem_zero(dest_fft_buf, num_dwords * num_bins_per_dword);
+		*bytes_copied = num_dwords * SPECTRAL_DWORD_SIZE;
+		return QDF_STATUS_SUCCESS;
+	}
 
-			fft_bin_buf[fft_bin_idx++] =
-				clamp_fft_bin_value(fft_bin_val, pwr_format);
-		}
+	switch (rparams->hw_fft_bin_width) {
+	case 1:
+		target_if_spectral_unpack_fft_bins_8(src_fft_buf, dest_fft_buf,
+						     num_dwords, pwr_format);
+		break;
+	case 2:
+		target_if_spectral_unpack_fft_bins_16(src_fft_buf,
+						      dest_fft_buf,
+						      num_dwords, pwr_format);
+		break;
+	case 4:
+		target_if_spectral_unpack_fft_bins_32(src_fft_buf,
+						      dest_fft_buf,
+						      num_dwords, pwr_format);
+		break;
+	default:
+		target_if_spectral_unpack_fft_bins_generic(
+				src_fft_buf, dest_fft_buf, num_dwords,
+				rparams->hw_fft_bin_width, pwr_format);
+		break;
 	}
 
 	*bytes_copied = num_dwords *  SPECTRAL_DWORD_SIZE;
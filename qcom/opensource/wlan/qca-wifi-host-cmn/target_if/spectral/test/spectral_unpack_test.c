@@ -0,0 +1,288 @@
+/*
+ * Copyright (c) 2024 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted, provided that the
+ * above copyright notice and this permission notice appear in all
+ * copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+ * AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR
+ * PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+ * TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "target_if_spectral.h"
+#include "spectral_unpack_test.h"
+#include "qdf_mem.h"
+#include "qdf_time.h"
+#include "qdf_util.h"
+
+#define SPECTRAL_UNPACK_TEST_MAX_DWORDS 1024
+#define SPECTRAL_UNPACK_TEST_RANDOM_DWORDS 4096
+#define SPECTRAL_UNPACK_TEST_BENCH_ROUNDS 1000
+#define SPECTRAL_UNPACK_TEST_POISON 0xa5
+
+/* Byte values around every clamping boundary of the supported bin widths */
+static const uint8_t spectral_unpack_test_edges[] = {
+	0x00, 0x01, 0x7e, 0x7f, 0x80, 0x81, 0xfe, 0xff,
+};
+
+static const uint8_t spectral_unpack_test_widths[] = { 1, 2, 4 };
+
+static const uint16_t spectral_unpack_test_formats[] = {
+	SPECTRAL_PWR_FORMAT_LINEAR,
+	SPECTRAL_PWR_FORMAT_DBM,
+};
+
+/**
+ * struct spectral_unpack_test_ctx - State of the FFT bin unpack test
+ * @spectral: Spectral object carrying the HW bin width under test
+ * @src: Source DWORDs
+ * @ref: Bins from the reference unpacker
+ * @out: Bins from target_if_spectral_copy_fft_bins(), one spare byte to
+ *	 catch overruns
+ * @num_cases: Number of width, format and input combinations compared
+ * @errors: Number of mismatching combinations
+ */
+struct spectral_unpack_test_ctx {
+	struct target_if_spectral *spectral;
+	uint32_t src[SPECTRAL_UNPACK_TEST_MAX_DWORDS];
+	uint8_t ref[SPECTRAL_UNPACK_TEST_MAX_DWORDS * SPECTRAL_DWORD_SIZE];
+	uint8_t out[SPECTRAL_UNPACK_TEST_MAX_DWORDS * SPECTRAL_DWORD_SIZE + 1];
+	uint32_t num_cases;
+	uint32_t errors;
+};
+
+/**
+ * spectral_unpack_test_ref() - Unpack FFT bins one at a time
+ * @src: Source DWORDs
+ * @dest: Destination 8-bit FFT bins
+ * @num_dwords: Number of source DWORDs
+ * @hw_fft_bin_width: FFT bin width in bytes as reported by the HW
+ * @pwr_format: Spectral FFT bin format (linear/dBm mode)
+ *
+ * The per-bin extract and clamp target_if_spectral_copy_fft_bins() used
+ * before it got a specialized path for each bin width.
+ *
+ * Return: None
+ */
+static void
+spectral_unpack_test_ref(const uint32_t *src, uint8_t *dest,
+			 uint32_t num_dwords, uint8_t hw_fft_bin_width,
+			 uint16_t pwr_format)
+{
+	uint8_t num_bins_per_dword, hw_fft_bin_width_bits;
+	uint16_t fft_bin_val;
+	uint32_t dword_idx;
+	uint8_t idx;
+
+	num_bins_per_dword = SPECTRAL_DWORD_SIZE / hw_fft_bin_width;
+	hw_fft_bin_width_bits = hw_fft_bin_width * QDF_CHAR_BIT;
+
+	for (dword_idx = 0; dword_idx < num_dwords; dword_idx++) {
+		for (idx = 0; idx < num_bins_per_dword; idx++) {
+			fft_bin_val = (uint16_t)QDF_GET_BITS64(
+					src[dword_idx],
+					idx * hw_fft_bin_width_bits,
+					hw_fft_bin_width_bits);
+			*dest++ = clamp_fft_bin_value(fft_bin_val, pwr_format);
+		}
+	}
+}
+
+/**
+ * spectral_unpack_test_cmp() - Compare both unpackers on the DWORDs in
+ * the test context
+ * @uctx: Unpack test context
+ * @num_dwords: Number of DWORDs in @uctx->src
+ * @input: Name of the input, for logging
+ *
+ * Return: None
+ */
+static void
+spectral_unpack_test_cmp(struct spectral_unpack_test_ctx *uctx,
+			 uint32_t num_dwords, const char *input)
+{
+	struct target_if_spectral *spectral = uctx->spectral;
+	uint32_t num_bins, bytes_copied, idx;
+	QDF_STATUS status;
+	uint8_t width;
+	uint16_t fmt;
+	int i, j;
+
+	for (i = 0; i < QDF_ARRAY_SIZE(spectral_unpack_test_widths); i++) {
+		width = spectral_unpack_test_widths[i];
+		num_bins = num_dwords * (SPECTRAL_DWORD_SIZE / width);
+		spectral->rparams.hw_fft_bin_width = width;
+
+		for (j = 0; j < QDF_ARRAY_SIZE(spectral_unpack_test_formats);
+		     j++) {
+			fmt = spectral_unpack_test_formats[j];
+			spectral_unpack_test_ref(uctx->src, uctx->ref,
+						 num_dwords, width, fmt);
+			qdf_mem_set(uctx->out, num_bins + 1,
+				    SPECTRAL_UNPACK_TEST_POISON);
+			status = target_if_spectral_copy_fft_bins(
+					spectral, uctx->src, uctx->out,
+					num_bins, &bytes_copied, fmt);
+			uctx->num_cases++;
+
+			for (idx = 0; idx < num_bins; idx++)
+				if (uctx->out[idx] != uctx->ref[idx])
+					break;
+
+			if (QDF_IS_STATUS_ERROR(status) ||
+			    bytes_copied != num_dwords * SPECTRAL_DWORD_SIZE ||
+			    idx != num_bins ||
+			    uctx->out[num_bins] != SPECTRAL_UNPACK_TEST_POISON) {
+				spectral_err("unpack mismatch: %s width %u format %u bin %u/%u",
+					     input, width, fmt, idx, num_bins);
+				uctx->errors++;
+			}
+		}
+	}
+}
+
+/**
+ * spectral_unpack_test_bench() - Time both unpackers
+ * @uctx: Unpack test context, @uctx->src holding random DWORDs
+ *
+ * Return: None
+ */
+static void
+spectral_unpack_test_bench(struct spectral_unpack_test_ctx *uctx)
+{
+	uint32_t num_dwords = SPECTRAL_UNPACK_TEST_MAX_DWORDS;
+	uint32_t num_bins, bytes_copied, round;
+	int64_t ref_ns, new_ns;
+	qdf_ktime_t start;
+	uint8_t width;
+	uint16_t fmt;
+	int i, j;
+
+	for (i = 0; i < QDF_ARRAY_SIZE(spectral_unpack_test_widths); i++) {
+		width = spectral_unpack_test_widths[i];
+		num_bins = num_dwords * (SPECTRAL_DWORD_SIZE / width);
+		uctx->spectral->rparams.hw_fft_bin_width = width;
+
+		for (j = 0; j < QDF_ARRAY_SIZE(spectral_unpack_test_formats);
+		     j++) {
+			fmt = spectral_unpack_test_formats[j];
+
+			start = qdf_ktime_get();
+			for (round = 0;
+			     round < SPECTRAL_UNPACK_TEST_BENCH_ROUNDS; round++)
+				spectral_unpack_test_ref(uctx->src, uctx->ref,
+							 num_dwords, width,
+							 fmt);
+			ref_ns = qdf_ktime_to_ns(qdf_ktime_get()) -
+				 qdf_ktime_to_ns(start);
+
+			start = qdf_ktime_get();
+			for (round = 0;
+			     round < SPECTRAL_UNPACK_TEST_BENCH_ROUNDS; round++)
+				target_if_spectral_copy_fft_bins(
+					uctx->spectral, uctx->src, uctx->out,
+					num_bins, &bytes_copied, fmt);
+			new_ns = qdf_ktime_to_ns(qdf_ktime_get()) -
+				 qdf_ktime_to_ns(start);
+
+			spectral_info("unpack width %u format %u: %llu ps/bin reference, %llu ps/bin specialized",
+				      width, fmt,
+				      qdf_do_div((uint64_t)ref_ns * 1000,
+						 num_bins *
+						 SPECTRAL_UNPACK_TEST_BENCH_ROUNDS),
+				      qdf_do_div((uint64_t)new_ns * 1000,
+						 num_bins *
+						 SPECTRAL_UNPACK_TEST_BENCH_ROUNDS));
+		}
+	}
+}
+
+/*
+ * target_if_spectral_copy_fft_bins() has to produce the same bins as the
+ * reference unpacker, bit for bit, for every bin width and power format.
+ * It is fed every DWORD made of bytes around the clamping boundaries and
+ * pseudo-random DWORDs, then timed against the reference.
+ */
+uint32_t spectral_unpack_unit_test(void)
+{
+	struct spectral_unpack_test_ctx *uctx;
+	uint32_t num_edges = QDF_ARRAY_SIZE(spectral_unpack_test_edges);
+	uint32_t seed = 1;
+	uint32_t i, n, bytes_copied;
+	uint32_t errors;
+
+	uctx = qdf_mem_malloc(sizeof(*uctx));
+	if (!uctx)
+		return 1;
+
+	uctx->spectral = qdf_mem_malloc(sizeof(*uctx->spectral));
+	if (!uctx->spectral) {
+		qdf_mem_free(uctx);
+		return 1;
+	}
+
+	/* every combination of boundary bytes in the four lanes */
+	n = 0;
+	for (i = 0; i < num_edges * num_edges * num_edges * num_edges; i++) {
+		uctx->src[n++] =
+			spectral_unpack_test_edges[i % num_edges] |
+			(spectral_unpack_test_edges[(i / num_edges) %
+						   num_edges] << 8) |
+			(spectral_unpack_test_edges[(i / (num_edges *
+							 num_edges)) %
+						   num_edges] << 16) |
+			((uint32_t)spectral_unpack_test_edges[i / (num_edges *
+								  num_edges *
+								  num_edges)]
+			 << 24);
+		if (n == SPECTRAL_UNPACK_TEST_MAX_DWORDS) {
+			spectral_unpack_test_cmp(uctx, n, "edges");
+			n = 0;
+		}
+	}
+	if (n)
+		spectral_unpack_test_cmp(uctx, n, "edges");
+
+	for (i = 0; i < SPECTRAL_UNPACK_TEST_RANDOM_DWORDS; i++) {
+		seed = seed * 1664525 + 1013904223;
+		uctx->src[i % SPECTRAL_UNPACK_TEST_MAX_DWORDS] = seed;
+		if ((i + 1) % SPECTRAL_UNPACK_TEST_MAX_DWORDS == 0)
+			spectral_unpack_test_cmp(
+				uctx, SPECTRAL_UNPACK_TEST_MAX_DWORDS, "random");
+	}
+
+	/* an unknown power format gives zeroed bins */
+	uctx->spectral->rparams.hw_fft_bin_width = 2;
+	qdf_mem_set(uctx->out, sizeof(uctx->out), SPECTRAL_UNPACK_TEST_POISON);
+	target_if_spectral_copy_fft_bins(uctx->spectral, uctx->src, uctx->out,
+					 2 * SPECTRAL_UNPACK_TEST_MAX_DWORDS,
+					 &bytes_copied, U16_MAX);
+	uctx->num_cases++;
+	for (i = 0; i < 2 * SPECTRAL_UNPACK_TEST_MAX_DWORDS; i++) {
+		if (uctx->out[i]) {
+			spectral_err("unpack: bin %u not zeroed for unknown format",
+				     i);
+			uctx->errors++;
+			break;
+		}
+	}
+
+	spectral_unpack_test_bench(uctx);
+
+	errors = uctx->errors;
+	spectral_info("unpack test: %u cases, %u mismatches",
+		      uctx->num_cases, errors);
+
+	qdf_mem_free(uctx->spectral);
+	qdf_mem_free(uctx);
+	QDF_BUG(!errors);
+
+	return errors;
+}
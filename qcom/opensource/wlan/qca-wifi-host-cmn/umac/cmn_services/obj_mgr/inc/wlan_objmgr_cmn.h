@@ -28,16 +28,26 @@
 #include "qdf_status.h"
 #include "wlan_cmn.h"
 #include "qdf_atomic.h"
+#include "qdf_util.h"
 
 /* No. of PSOCs can be supported */
 #define WLAN_OBJMGR_MAX_DEVICES 5
 
-/* size of Hash */
-#define WLAN_PEER_HASHSIZE 64
+/* size of Hash, as a power of 2, set by CONFIG_WLAN_PEER_HASH_BITS */
+#ifndef WLAN_PEER_HASH_BITS
+#define WLAN_PEER_HASH_BITS 6
+#endif
+/*
+ * The table is sized at build time and never resized. Hash indexes are
+ * passed around as uint16_t, and every psoc and MLD carries a table.
+ */
+#if (WLAN_PEER_HASH_BITS < 1) || (WLAN_PEER_HASH_BITS > 10)
+#error "WLAN_PEER_HASH_BITS must be in the range [1, 10]"
+#endif
+#define WLAN_PEER_HASHSIZE (1 << WLAN_PEER_HASH_BITS)
 
-/* simple hash is enough for variation of macaddr */
-#define WLAN_PEER_HASH(addr)   \
-(((const uint8_t *)(addr))[QDF_MAC_ADDR_SIZE - 1] % WLAN_PEER_HASHSIZE)
+#define WLAN_PEER_HASH(addr) \
+	qdf_mac_addr_hash((const uint8_t *)(addr), WLAN_PEER_HASH_BITS)
 
 #define obj_mgr_log(level, args...) \
 		QDF_TRACE(QDF_MODULE_ID_OBJ_MGR, level, ## args)
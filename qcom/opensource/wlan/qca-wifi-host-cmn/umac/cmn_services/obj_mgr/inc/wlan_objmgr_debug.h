@@ -25,6 +25,8 @@
 
 #include <qdf_timer.h>
 
+struct wlan_objmgr_psoc;
+
 #ifdef WLAN_OBJMGR_DEBUG
 
 /**
@@ -66,6 +68,14 @@ void wlan_objmgr_debug_info_init(void);
  */
 void wlan_objmgr_debug_info_deinit(void);
 
+/**
+ * wlan_objmgr_print_peer_hash_stats() - print occupancy of the psoc peer
+ *  hash buckets
+ * @psoc: psoc object
+ *
+ * Return: void
+ */
+void wlan_objmgr_print_peer_hash_stats(struct wlan_objmgr_psoc *psoc);
 
 #else
 
@@ -91,6 +101,11 @@ wlan_objmgr_debug_info_deinit(void)
 {
 }
 
+static inline void
+wlan_objmgr_print_peer_hash_stats(struct wlan_objmgr_psoc *psoc)
+{
+}
+
 #endif /*WLAN_OBJMGR_DEBUG*/
 
 #ifdef WLAN_OBJMGR_REF_ID_TRACE
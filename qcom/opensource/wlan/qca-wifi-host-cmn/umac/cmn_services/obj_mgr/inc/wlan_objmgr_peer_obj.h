@@ -192,6 +192,7 @@ struct wlan_objmgr_peer_objmgr {
  * @mldaddr:          Peer MLD MAC address
  * @mlo_bridge_peer:  Indicates bridge peer
  * @peer_flags:        QCN flag and 4 address mode flag
+ * @rcu_head:         defers the free until lockless lookups are done
  */
 struct wlan_objmgr_peer {
 	qdf_list_node_t psoc_peer;
@@ -213,6 +214,9 @@ struct wlan_objmgr_peer {
 	u_int32_t peer_flags;
 	bool mlo_bridge_peer;
 #endif
+#ifdef WLAN_OBJMGR_PEER_HASH_RCU
+	qdf_rcu_head_t rcu_head;
+#endif
 };
 
 /*
@@ -516,14 +520,14 @@ void wlan_objmgr_peer_release_ref(struct wlan_objmgr_peer *peer,
 
 struct wlan_objmgr_peer *wlan_peer_get_next_peer_of_psoc_ref_debug(
 				struct wlan_peer_list *peer_list,
-				uint8_t hash_index,
+				uint16_t hash_index,
 				struct wlan_objmgr_peer *peer,
 				wlan_objmgr_ref_dbgid dbg_id,
 				const char *func, int line);
 #else
 struct wlan_objmgr_peer *wlan_peer_get_next_peer_of_psoc_ref(
 				struct wlan_peer_list *peer_list,
-				uint8_t hash_index,
+				uint16_t hash_index,
 				struct wlan_objmgr_peer *peer,
 				wlan_objmgr_ref_dbgid dbg_id);
 #endif
@@ -548,14 +552,14 @@ struct wlan_objmgr_peer *wlan_peer_get_next_peer_of_psoc_ref(
 
 struct wlan_objmgr_peer *wlan_peer_get_next_active_peer_of_psoc_debug(
 					struct wlan_peer_list *peer_list,
-					uint8_t hash_index,
+					uint16_t hash_index,
 					struct wlan_objmgr_peer *peer,
 					wlan_objmgr_ref_dbgid dbg_id,
 					const char *func, int line);
 #else
 struct wlan_objmgr_peer *wlan_peer_get_next_active_peer_of_psoc(
 					struct wlan_peer_list *peer_list,
-					uint8_t hash_index,
+					uint16_t hash_index,
 					struct wlan_objmgr_peer *peer,
 					wlan_objmgr_ref_dbgid dbg_id);
 #endif
@@ -635,14 +639,14 @@ struct wlan_objmgr_peer *wlan_vdev_peer_list_peek_active_head(
 
 struct wlan_objmgr_peer *wlan_psoc_peer_list_peek_head_ref_debug(
 					struct wlan_peer_list *peer_list,
-					uint8_t hash_index,
+					uint16_t hash_index,
 					wlan_objmgr_ref_dbgid dbg_id,
 					const char *func, int line);
 
 #else
 struct wlan_objmgr_peer *wlan_psoc_peer_list_peek_head_ref(
 					struct wlan_peer_list *peer_list,
-					uint8_t hash_index,
+					uint16_t hash_index,
 					wlan_objmgr_ref_dbgid dbg_id);
 #endif
 
@@ -663,13 +667,13 @@ struct wlan_objmgr_peer *wlan_psoc_peer_list_peek_head_ref(
 
 struct wlan_objmgr_peer *wlan_psoc_peer_list_peek_active_head_debug(
 					struct wlan_peer_list *peer_list,
-					uint8_t hash_index,
+					uint16_t hash_index,
 					wlan_objmgr_ref_dbgid dbg_id,
 					const char *func, int line);
 #else
 struct wlan_objmgr_peer *wlan_psoc_peer_list_peek_active_head(
 					struct wlan_peer_list *peer_list,
-					uint8_t hash_index,
+					uint16_t hash_index,
 					wlan_objmgr_ref_dbgid dbg_id);
 #endif
 
@@ -30,6 +30,7 @@
 #include <qdf_mem.h>
 #include <qdf_platform.h>
 #include <qdf_str.h>
+#include <qdf_module.h>
 
 /*
  * Default TTL (of FW) for mgmt frames is 5 sec, by considering all the other
@@ -586,6 +587,58 @@ void wlan_objmgr_debug_info_init(void)
 	g_umac_glb_obj->debug_info = debug_info;
 }
 
+/* chain length histogram buckets: 0, 1, 2, 3, 4-7, 8+ */
+#define PEER_HASH_CHAIN_HIST_SIZE 6
+
+static uint8_t wlan_objmgr_peer_hash_hist_idx(uint32_t len)
+{
+	if (len < 4)
+		return len;
+
+	return len < 8 ? 4 : 5;
+}
+
+void wlan_objmgr_print_peer_hash_stats(struct wlan_objmgr_psoc *psoc)
+{
+	struct wlan_peer_list *peer_list;
+	uint32_t hist[PEER_HASH_CHAIN_HIST_SIZE] = {0};
+	uint32_t i, len, total = 0, used = 0, max_len = 0;
+
+	if (!psoc)
+		return;
+
+	peer_list = &psoc->soc_objmgr.peer_list;
+
+	/* the table can be too large to snapshot on the stack */
+	qdf_spin_lock_bh(&peer_list->peer_list_lock);
+	for (i = 0; i < WLAN_PEER_HASHSIZE; i++) {
+		len = qdf_list_size(&peer_list->peer_hash[i]);
+		hist[wlan_objmgr_peer_hash_hist_idx(len)]++;
+		if (!len)
+			continue;
+
+		used++;
+		total += len;
+		if (len > max_len)
+			max_len = len;
+	}
+	qdf_spin_unlock_bh(&peer_list->peer_list_lock);
+
+	obj_mgr_info("peer hash: %u peers in %u/%u buckets, max chain %u",
+		     total, used, WLAN_PEER_HASHSIZE, max_len);
+	obj_mgr_info("chain len histogram [0]:%u [1]:%u [2]:%u [3]:%u [4-7]:%u [8+]:%u",
+		     hist[0], hist[1], hist[2], hist[3], hist[4], hist[5]);
+
+	/* unlocked, a chain may change between the summary and this dump */
+	for (i = 0; i < WLAN_PEER_HASHSIZE; i++) {
+		len = qdf_list_size(&peer_list->peer_hash[i]);
+		if (len > 1)
+			obj_mgr_debug("bucket[%u]: %u peers", i, len);
+	}
+}
+
+qdf_export_symbol(wlan_objmgr_print_peer_hash_stats);
+
 #ifdef WLAN_OBJMGR_REF_ID_TRACE
 void
 wlan_objmgr_trace_init_lock(struct wlan_objmgr_trace *trace)
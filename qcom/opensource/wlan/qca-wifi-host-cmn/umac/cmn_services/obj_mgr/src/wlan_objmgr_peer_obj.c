@@ -69,6 +69,67 @@ static QDF_STATUS wlan_objmgr_peer_object_status(
 	return status;
 }
 
+#ifdef WLAN_OBJMGR_PEER_HASH_RCU
+/**
+ * wlan_objmgr_peer_mem_free_rcu_cb() - free peer memory after grace period
+ * @head: RCU head embedded in the peer
+ *
+ * Return: None
+ */
+static void wlan_objmgr_peer_mem_free_rcu_cb(qdf_rcu_head_t *head)
+{
+	struct wlan_objmgr_peer *peer;
+
+	peer = qdf_container_of(head, struct wlan_objmgr_peer, rcu_head);
+	qdf_spinlock_destroy(&peer->peer_lock);
+	qdf_mem_free(peer);
+}
+
+/**
+ * wlan_objmgr_peer_mem_free() - free a peer detached from the psoc
+ * @peer: PEER object
+ *
+ * Lockless lookups may still be reading the peer, and may still take its
+ * lock to find it is no longer in created state, until a grace period has
+ * elapsed.
+ *
+ * Return: None
+ */
+static void wlan_objmgr_peer_mem_free(struct wlan_objmgr_peer *peer)
+{
+	qdf_call_rcu(&peer->rcu_head, wlan_objmgr_peer_mem_free_rcu_cb);
+}
+
+#ifdef WLAN_FEATURE_DYNAMIC_MAC_ADDR_UPDATE
+/**
+ * wlan_objmgr_peer_wait_readers() - wait for lookups that may still be
+ *                                   walking the hash bucket a peer left
+ *
+ * The peer's list node still points into its old bucket. It must not be
+ * rekeyed and linked into another bucket until no lookup can be standing
+ * on it. May sleep.
+ *
+ * Return: None
+ */
+static void wlan_objmgr_peer_wait_readers(void)
+{
+	qdf_synchronize_rcu();
+}
+#endif
+#else
+static void wlan_objmgr_peer_mem_free(struct wlan_objmgr_peer *peer)
+{
+	qdf_spinlock_destroy(&peer->peer_lock);
+	qdf_mem_free(peer);
+}
+
+#ifdef WLAN_FEATURE_DYNAMIC_MAC_ADDR_UPDATE
+static inline void wlan_objmgr_peer_wait_readers(void)
+{
+}
+#endif
+#endif
+
 static QDF_STATUS wlan_objmgr_peer_obj_free(struct wlan_objmgr_peer *peer)
 {
 	struct wlan_objmgr_psoc *psoc;
@@ -136,8 +197,7 @@ static QDF_STATUS wlan_objmgr_peer_obj_free(struct wlan_objmgr_peer *peer)
 	}
 	wlan_objmgr_peer_trace_del_ref_list(peer);
 	wlan_objmgr_peer_trace_deinit_lock(peer);
-	qdf_spinlock_destroy(&peer->peer_lock);
-	qdf_mem_free(peer);
+	wlan_objmgr_peer_mem_free(peer);
 	peer = NULL;
 
 	if (peer_free_notify)
@@ -231,9 +291,9 @@ struct wlan_objmgr_peer *wlan_objmgr_peer_obj_create(
 				QDF_MAC_ADDR_REF(macaddr));
 		/* if attach fails, detach from psoc table before free */
 		wlan_objmgr_psoc_peer_detach(psoc, peer);
-		qdf_spinlock_destroy(&peer->peer_lock);
 		wlan_objmgr_peer_trace_deinit_lock(peer);
-		qdf_mem_free(peer);
+		/* peer was visible to hash lookups, free it like a deleted one */
+		wlan_objmgr_peer_mem_free(peer);
 		return NULL;
 	}
 	wlan_peer_set_pdev_id(peer, wlan_objmgr_pdev_get_pdev_id(
@@ -974,7 +1034,7 @@ qdf_export_symbol(wlan_objmgr_peer_try_get_ref);
 #ifdef WLAN_OBJMGR_REF_ID_TRACE
 struct wlan_objmgr_peer *wlan_peer_get_next_active_peer_of_psoc_debug(
 					struct wlan_peer_list *peer_list,
-					uint8_t hash_index,
+					uint16_t hash_index,
 					struct wlan_objmgr_peer *peer,
 					wlan_objmgr_ref_dbgid dbg_id,
 					const char *func, int line)
@@ -1010,7 +1070,7 @@ struct wlan_objmgr_peer *wlan_peer_get_next_active_peer_of_psoc_debug(
 #else
 struct wlan_objmgr_peer *wlan_peer_get_next_active_peer_of_psoc(
 					struct wlan_peer_list *peer_list,
-					uint8_t hash_index,
+					uint16_t hash_index,
 					struct wlan_objmgr_peer *peer,
 					wlan_objmgr_ref_dbgid dbg_id)
 {
@@ -1194,7 +1254,7 @@ struct wlan_objmgr_peer *wlan_peer_get_next_active_peer_of_vdev(
 #ifdef WLAN_OBJMGR_REF_ID_TRACE
 struct wlan_objmgr_peer *wlan_psoc_peer_list_peek_active_head_debug(
 					struct wlan_peer_list *peer_list,
-					uint8_t hash_index,
+					uint16_t hash_index,
 					wlan_objmgr_ref_dbgid dbg_id,
 					const char *func, int line)
 {
@@ -1231,7 +1291,7 @@ struct wlan_objmgr_peer *wlan_psoc_peer_list_peek_active_head_debug(
 #else
 struct wlan_objmgr_peer *wlan_psoc_peer_list_peek_active_head(
 					struct wlan_peer_list *peer_list,
-					uint8_t hash_index,
+					uint16_t hash_index,
 					wlan_objmgr_ref_dbgid dbg_id)
 {
 	struct wlan_objmgr_peer *peer;
@@ -1268,7 +1328,7 @@ struct wlan_objmgr_peer *wlan_psoc_peer_list_peek_active_head(
 #ifdef WLAN_OBJMGR_REF_ID_TRACE
 struct wlan_objmgr_peer *wlan_psoc_peer_list_peek_head_ref_debug(
 					struct wlan_peer_list *peer_list,
-					uint8_t hash_index,
+					uint16_t hash_index,
 					wlan_objmgr_ref_dbgid dbg_id,
 					const char *func, int line)
 {
@@ -1294,7 +1354,7 @@ struct wlan_objmgr_peer *wlan_psoc_peer_list_peek_head_ref_debug(
 #else
 struct wlan_objmgr_peer *wlan_psoc_peer_list_peek_head_ref(
 					struct wlan_peer_list *peer_list,
-					uint8_t hash_index,
+					uint16_t hash_index,
 					wlan_objmgr_ref_dbgid dbg_id)
 {
 	struct wlan_objmgr_peer *peer;
@@ -1320,7 +1380,7 @@ struct wlan_objmgr_peer *wlan_psoc_peer_list_peek_head_ref(
 
 #ifdef WLAN_OBJMGR_REF_ID_TRACE
 struct wlan_objmgr_peer *wlan_peer_get_next_peer_of_psoc_ref_debug(
-			struct wlan_peer_list *peer_list, uint8_t hash_index,
+			struct wlan_peer_list *peer_list, uint16_t hash_index,
 			struct wlan_objmgr_peer *peer,
 			wlan_objmgr_ref_dbgid dbg_id,
 			const char *func, int line)
@@ -1345,7 +1405,7 @@ struct wlan_objmgr_peer *wlan_peer_get_next_peer_of_psoc_ref_debug(
 }
 #else
 struct wlan_objmgr_peer *wlan_peer_get_next_peer_of_psoc_ref(
-			struct wlan_peer_list *peer_list, uint8_t hash_index,
+			struct wlan_peer_list *peer_list, uint16_t hash_index,
 			struct wlan_objmgr_peer *peer,
 			wlan_objmgr_ref_dbgid dbg_id)
 {
@@ -1525,6 +1585,7 @@ QDF_STATUS wlan_peer_update_macaddr(struct wlan_objmgr_peer *peer,
 			    QDF_MAC_ADDR_REF(macaddr));
 		return status;
 	}
+	wlan_objmgr_peer_wait_readers();
 
 	wlan_peer_set_macaddr(peer, new_macaddr);
 
@@ -76,7 +76,7 @@ static QDF_STATUS wlan_objmgr_psoc_object_status(
 
 static void wlan_objmgr_psoc_peer_list_init(struct wlan_peer_list *peer_list)
 {
-	uint8_t i;
+	uint16_t i;
 
 	qdf_spinlock_create(&peer_list->peer_list_lock);
 	for (i = 0; i < WLAN_PEER_HASHSIZE; i++)
@@ -87,12 +87,16 @@ static void wlan_objmgr_psoc_peer_list_init(struct wlan_peer_list *peer_list)
 
 static void wlan_objmgr_psoc_peer_list_deinit(struct wlan_peer_list *peer_list)
 {
-	uint8_t i;
+	uint16_t i;
 
 	/* deinit the lock */
 	qdf_spinlock_destroy(&peer_list->peer_list_lock);
 	for (i = 0; i < WLAN_PEER_HASHSIZE; i++)
 		qdf_list_destroy(&peer_list->peer_hash[i]);
+#ifdef WLAN_OBJMGR_PEER_HASH_RCU
+	/* flush peer frees still waiting for lockless lookups to finish */
+	qdf_rcu_barrier();
+#endif
 }
 
 static QDF_STATUS wlan_objmgr_psoc_obj_free(struct wlan_objmgr_psoc *psoc)
@@ -420,7 +424,7 @@ QDF_STATUS wlan_objmgr_iterate_obj_list(
 		wlan_objmgr_ref_dbgid dbg_id)
 {
 	uint16_t obj_id;
-	uint8_t i;
+	uint16_t i;
 	struct wlan_objmgr_psoc_objmgr *objmgr = &psoc->soc_objmgr;
 	struct wlan_peer_list *peer_list;
 	struct wlan_objmgr_pdev *pdev;
@@ -486,7 +490,7 @@ QDF_STATUS wlan_objmgr_iterate_obj_list_all(
 		wlan_objmgr_ref_dbgid dbg_id)
 {
 	uint16_t obj_id;
-	uint8_t i;
+	uint16_t i;
 	struct wlan_objmgr_psoc_objmgr *objmgr = &psoc->soc_objmgr;
 	struct wlan_peer_list *peer_list;
 	struct wlan_objmgr_pdev *pdev;
@@ -571,7 +575,7 @@ static QDF_STATUS wlan_objmgr_iterate_obj_list_all_noref(
 		void *arg)
 {
 	uint16_t obj_id;
-	uint8_t i;
+	uint16_t i;
 	struct wlan_objmgr_psoc_objmgr *objmgr = &psoc->soc_objmgr;
 	struct wlan_peer_list *peer_list;
 	qdf_list_t *obj_list;
@@ -1310,6 +1314,63 @@ struct wlan_objmgr_vdev *wlan_objmgr_get_vdev_by_macaddr_from_psoc_no_state(
 qdf_export_symbol(wlan_objmgr_get_vdev_by_macaddr_from_psoc_no_state);
 #endif
 
+#ifdef WLAN_OBJMGR_PEER_HASH_RCU
+/*
+ * Peers are looked up by MAC address without the psoc and peer list locks,
+ * inside an RCU read section. The peer list lock still serializes writers,
+ * and peer memory is only freed after a grace period.
+ */
+#define wlan_psoc_peer_hash_for_each(obj_list, peer) \
+	qdf_list_for_each_rcu(obj_list, peer, psoc_peer)
+
+static void wlan_obj_psoc_peerlist_add_tail(qdf_list_t *obj_list,
+				struct wlan_objmgr_peer *obj)
+{
+	qdf_list_insert_back_rcu(obj_list, &obj->psoc_peer);
+}
+
+static QDF_STATUS wlan_obj_psoc_peerlist_remove_peer(
+				qdf_list_t *obj_list,
+				struct wlan_objmgr_peer *peer)
+{
+	if (!peer)
+		return QDF_STATUS_E_FAILURE;
+	/* list is empty, return failure */
+	if (qdf_list_empty(obj_list))
+		return QDF_STATUS_E_FAILURE;
+
+	qdf_list_remove_node_rcu(obj_list, &peer->psoc_peer);
+
+	return QDF_STATUS_SUCCESS;
+}
+
+/**
+ * wlan_psoc_peer_hash_read_begin() - start a MAC address lookup
+ * @psoc: PSOC object
+ *
+ * Return: true if the peer hash may be walked, false if it is empty
+ */
+static inline bool wlan_psoc_peer_hash_read_begin(struct wlan_objmgr_psoc *psoc)
+{
+	qdf_rcu_read_lock_bh();
+
+	return true;
+}
+
+/**
+ * wlan_psoc_peer_hash_read_end() - end a MAC address lookup
+ * @psoc: PSOC object
+ *
+ * Return: None
+ */
+static inline void wlan_psoc_peer_hash_read_end(struct wlan_objmgr_psoc *psoc)
+{
+	qdf_rcu_read_unlock_bh();
+}
+#else
+#define wlan_psoc_peer_hash_for_each(obj_list, peer) \
+	qdf_list_for_each(obj_list, peer, psoc_peer)
+
 static void wlan_obj_psoc_peerlist_add_tail(qdf_list_t *obj_list,
 				struct wlan_objmgr_peer *obj)
 {
@@ -1333,6 +1394,27 @@ static QDF_STATUS wlan_obj_psoc_peerlist_remove_peer(
 	return QDF_STATUS_SUCCESS;
 }
 
+static inline bool wlan_psoc_peer_hash_read_begin(struct wlan_objmgr_psoc *psoc)
+{
+	/* psoc lock should be taken before peer list lock */
+	wlan_psoc_obj_lock(psoc);
+	/* List is empty, nothing to walk */
+	if (psoc->soc_objmgr.wlan_peer_count == 0) {
+		wlan_psoc_obj_unlock(psoc);
+		return false;
+	}
+	qdf_spin_lock_bh(&psoc->soc_objmgr.peer_list.peer_list_lock);
+
+	return true;
+}
+
+static inline void wlan_psoc_peer_hash_read_end(struct wlan_objmgr_psoc *psoc)
+{
+	qdf_spin_unlock_bh(&psoc->soc_objmgr.peer_list.peer_list_lock);
+	wlan_psoc_obj_unlock(psoc);
+}
+#endif
+
 static QDF_STATUS wlan_peer_bssid_match(struct wlan_objmgr_peer *peer,
 				     uint8_t *bssid)
 {
@@ -1368,11 +1450,9 @@ static struct wlan_objmgr_peer
 				const char *func, int line)
 {
 	struct wlan_objmgr_peer *peer;
-	struct wlan_objmgr_peer *peer_temp;
 
 	/* Iterate through hash list to get the peer */
-	peer = wlan_psoc_peer_list_peek_head(obj_list);
-	while (peer) {
+	wlan_psoc_peer_hash_for_each(obj_list, peer) {
 		/* For peer, macaddr is key */
 		if ((WLAN_ADDR_EQ(wlan_peer_get_macaddr(peer), macaddr)
 			== QDF_STATUS_SUCCESS) &&
@@ -1383,9 +1463,6 @@ static struct wlan_objmgr_peer
 				return peer;
 			}
 		}
-		/* Move to next peer */
-		peer_temp = peer;
-		peer = wlan_peer_get_next_peer_of_psoc(obj_list, peer_temp);
 	}
 
 	/* Not found, return NULL */
@@ -1410,11 +1487,9 @@ static struct wlan_objmgr_peer *wlan_obj_psoc_peerlist_get_peer_by_pdev_id(
 				uint8_t pdev_id, wlan_objmgr_ref_dbgid dbg_id)
 {
 	struct wlan_objmgr_peer *peer;
-	struct wlan_objmgr_peer *peer_temp;
 
 	/* Iterate through hash list to get the peer */
-	peer = wlan_psoc_peer_list_peek_head(obj_list);
-	while (peer) {
+	wlan_psoc_peer_hash_for_each(obj_list, peer) {
 		/* For peer, macaddr is key */
 		if ((WLAN_ADDR_EQ(wlan_peer_get_macaddr(peer), macaddr)
 			== QDF_STATUS_SUCCESS) &&
@@ -1424,9 +1499,6 @@ static struct wlan_objmgr_peer *wlan_obj_psoc_peerlist_get_peer_by_pdev_id(
 				return peer;
 			}
 		}
-		/* Move to next peer */
-		peer_temp = peer;
-		peer = wlan_peer_get_next_peer_of_psoc(obj_list, peer_temp);
 	}
 
 	/* Not found, return NULL */
@@ -1454,11 +1526,9 @@ static struct wlan_objmgr_peer *wlan_obj_psoc_peerlist_get_peer_debug(
 		const char *func, int line)
 {
 	struct wlan_objmgr_peer *peer;
-	struct wlan_objmgr_peer *peer_temp;
 
 	/* Iterate through hash list to get the peer */
-	peer = wlan_psoc_peer_list_peek_head(obj_list);
-	while (peer) {
+	wlan_psoc_peer_hash_for_each(obj_list, peer) {
 		/* For peer, macaddr is key */
 		if (WLAN_ADDR_EQ(wlan_peer_get_macaddr(peer), macaddr)
 				== QDF_STATUS_SUCCESS) {
@@ -1468,9 +1538,6 @@ static struct wlan_objmgr_peer *wlan_obj_psoc_peerlist_get_peer_debug(
 				return peer;
 			}
 		}
-		/* Move to next peer */
-		peer_temp = peer;
-		peer = wlan_peer_get_next_peer_of_psoc(obj_list, peer_temp);
 	}
 
 	/* Not found, return NULL */
@@ -1493,11 +1560,9 @@ static struct wlan_objmgr_peer *wlan_obj_psoc_peerlist_get_peer(
 		wlan_objmgr_ref_dbgid dbg_id)
 {
 	struct wlan_objmgr_peer *peer;
-	struct wlan_objmgr_peer *peer_temp;
 
 	/* Iterate through hash list to get the peer */
-	peer = wlan_psoc_peer_list_peek_head(obj_list);
-	while (peer) {
+	wlan_psoc_peer_hash_for_each(obj_list, peer) {
 		/* For peer, macaddr is key */
 		if (WLAN_ADDR_EQ(wlan_peer_get_macaddr(peer), macaddr)
 				== QDF_STATUS_SUCCESS) {
@@ -1506,9 +1571,6 @@ static struct wlan_objmgr_peer *wlan_obj_psoc_peerlist_get_peer(
 				return peer;
 			}
 		}
-		/* Move to next peer */
-		peer_temp = peer;
-		peer = wlan_peer_get_next_peer_of_psoc(obj_list, peer_temp);
 	}
 
 	/* Not found, return NULL */
@@ -2076,7 +2138,7 @@ QDF_STATUS wlan_objmgr_psoc_peer_attach(struct wlan_objmgr_psoc *psoc,
 					struct wlan_objmgr_peer *peer)
 {
 	struct wlan_objmgr_psoc_objmgr *objmgr;
-	uint8_t hash_index;
+	uint16_t hash_index;
 	struct wlan_peer_list *peer_list;
 
 	wlan_psoc_obj_lock(psoc);
@@ -2123,7 +2185,7 @@ QDF_STATUS wlan_objmgr_psoc_peer_detach(struct wlan_objmgr_psoc *psoc,
 					struct wlan_objmgr_peer *peer)
 {
 	struct wlan_objmgr_psoc_objmgr *objmgr;
-	uint8_t hash_index;
+	uint16_t hash_index;
 	struct wlan_peer_list *peer_list;
 
 	wlan_psoc_obj_lock(psoc);
@@ -2166,8 +2228,7 @@ struct wlan_objmgr_peer *wlan_objmgr_get_peer_debug(
 			const uint8_t *macaddr, wlan_objmgr_ref_dbgid dbg_id,
 			const char *func, int line)
 {
-	struct wlan_objmgr_psoc_objmgr *objmgr;
-	uint8_t hash_index;
+	uint16_t hash_index;
 	struct wlan_objmgr_peer *peer = NULL;
 	struct wlan_peer_list *peer_list;
 
@@ -2177,24 +2238,16 @@ struct wlan_objmgr_peer *wlan_objmgr_get_peer_debug(
 	if (!macaddr)
 		return NULL;
 
-	/* psoc lock should be taken before peer list lock */
-	wlan_psoc_obj_lock(psoc);
-	objmgr = &psoc->soc_objmgr;
-	/* List is empty, return NULL */
-	if (objmgr->wlan_peer_count == 0) {
-		wlan_psoc_obj_unlock(psoc);
+	if (!wlan_psoc_peer_hash_read_begin(psoc))
 		return NULL;
-	}
 	/* reduce the search window, with hash key */
 	hash_index = WLAN_PEER_HASH(macaddr);
-	peer_list = &objmgr->peer_list;
-	qdf_spin_lock_bh(&peer_list->peer_list_lock);
+	peer_list = &psoc->soc_objmgr.peer_list;
 	/* Iterate through peer list, get peer */
 	peer = wlan_obj_psoc_peerlist_get_peer_by_pdev_id_debug(
 		&peer_list->peer_hash[hash_index], macaddr,
 		pdev_id, dbg_id, func, line);
-	qdf_spin_unlock_bh(&peer_list->peer_list_lock);
-	wlan_psoc_obj_unlock(psoc);
+	wlan_psoc_peer_hash_read_end(psoc);
 
 	return peer;
 }
@@ -2205,8 +2258,7 @@ struct wlan_objmgr_peer *wlan_objmgr_get_peer(
 			struct wlan_objmgr_psoc *psoc, uint8_t pdev_id,
 			const uint8_t *macaddr, wlan_objmgr_ref_dbgid dbg_id)
 {
-	struct wlan_objmgr_psoc_objmgr *objmgr;
-	uint8_t hash_index;
+	uint16_t hash_index;
 	struct wlan_objmgr_peer *peer = NULL;
 	struct wlan_peer_list *peer_list;
 
@@ -2216,23 +2268,15 @@ struct wlan_objmgr_peer *wlan_objmgr_get_peer(
 	if (!macaddr)
 		return NULL;
 
-	/* psoc lock should be taken before peer list lock */
-	wlan_psoc_obj_lock(psoc);
-	objmgr = &psoc->soc_objmgr;
-	/* List is empty, return NULL */
-	if (objmgr->wlan_peer_count == 0) {
-		wlan_psoc_obj_unlock(psoc);
+	if (!wlan_psoc_peer_hash_read_begin(psoc))
 		return NULL;
-	}
 	/* reduce the search window, with hash key */
 	hash_index = WLAN_PEER_HASH(macaddr);
-	peer_list = &objmgr->peer_list;
-	qdf_spin_lock_bh(&peer_list->peer_list_lock);
+	peer_list = &psoc->soc_objmgr.peer_list;
 	/* Iterate through peer list, get peer */
 	peer = wlan_obj_psoc_peerlist_get_peer_by_pdev_id(
 		&peer_list->peer_hash[hash_index], macaddr, pdev_id, dbg_id);
-	qdf_spin_unlock_bh(&peer_list->peer_list_lock);
-	wlan_psoc_obj_unlock(psoc);
+	wlan_psoc_peer_hash_read_end(psoc);
 
 	return peer;
 }
@@ -2246,8 +2290,7 @@ struct wlan_objmgr_peer *wlan_objmgr_get_peer_by_mac_debug(
 		wlan_objmgr_ref_dbgid dbg_id,
 		const char *func, int line)
 {
-	struct wlan_objmgr_psoc_objmgr *objmgr;
-	uint8_t hash_index;
+	uint16_t hash_index;
 	struct wlan_objmgr_peer *peer = NULL;
 	struct wlan_peer_list *peer_list;
 
@@ -2256,24 +2299,16 @@ struct wlan_objmgr_peer *wlan_objmgr_get_peer_by_mac_debug(
 	if (!psoc)
 		return NULL;
 
-	/* psoc lock should be taken before peer list lock */
-	wlan_psoc_obj_lock(psoc);
-	objmgr = &psoc->soc_objmgr;
-	/* List is empty, return NULL */
-	if (objmgr->wlan_peer_count == 0) {
-		wlan_psoc_obj_unlock(psoc);
+	if (!wlan_psoc_peer_hash_read_begin(psoc))
 		return NULL;
-	}
 	/* reduce the search window, with hash key */
 	hash_index = WLAN_PEER_HASH(macaddr);
-	peer_list = &objmgr->peer_list;
-	qdf_spin_lock_bh(&peer_list->peer_list_lock);
+	peer_list = &psoc->soc_objmgr.peer_list;
 	/* Iterate through peer list, get peer */
 	peer = wlan_obj_psoc_peerlist_get_peer_debug(
 			&peer_list->peer_hash[hash_index],
 			macaddr, dbg_id, func, line);
-	qdf_spin_unlock_bh(&peer_list->peer_list_lock);
-	wlan_psoc_obj_unlock(psoc);
+	wlan_psoc_peer_hash_read_end(psoc);
 
 	return peer;
 }
@@ -2284,8 +2319,7 @@ struct wlan_objmgr_peer *wlan_objmgr_get_peer_by_mac(
 		struct wlan_objmgr_psoc *psoc, uint8_t *macaddr,
 		wlan_objmgr_ref_dbgid dbg_id)
 {
-	struct wlan_objmgr_psoc_objmgr *objmgr;
-	uint8_t hash_index;
+	uint16_t hash_index;
 	struct wlan_objmgr_peer *peer = NULL;
 	struct wlan_peer_list *peer_list;
 
@@ -2294,23 +2328,15 @@ struct wlan_objmgr_peer *wlan_objmgr_get_peer_by_mac(
 	if (!psoc)
 		return NULL;
 
-	/* psoc lock should be taken before peer list lock */
-	wlan_psoc_obj_lock(psoc);
-	objmgr = &psoc->soc_objmgr;
-	/* List is empty, return NULL */
-	if (objmgr->wlan_peer_count == 0) {
-		wlan_psoc_obj_unlock(psoc);
+	if (!wlan_psoc_peer_hash_read_begin(psoc))
 		return NULL;
-	}
 	/* reduce the search window, with hash key */
 	hash_index = WLAN_PEER_HASH(macaddr);
-	peer_list = &objmgr->peer_list;
-	qdf_spin_lock_bh(&peer_list->peer_list_lock);
+	peer_list = &psoc->soc_objmgr.peer_list;
 	/* Iterate through peer list, get peer */
 	peer = wlan_obj_psoc_peerlist_get_peer(
 			&peer_list->peer_hash[hash_index], macaddr, dbg_id);
-	qdf_spin_unlock_bh(&peer_list->peer_list_lock);
-	wlan_psoc_obj_unlock(psoc);
+	wlan_psoc_peer_hash_read_end(psoc);
 
 	return peer;
 }
@@ -2325,7 +2351,7 @@ struct wlan_objmgr_peer *wlan_objmgr_get_peer_logically_deleted_debug(
 			const char *func, int line)
 {
 	struct wlan_objmgr_psoc_objmgr *objmgr;
-	uint8_t hash_index;
+	uint16_t hash_index;
 	struct wlan_objmgr_peer *peer = NULL;
 	struct wlan_peer_list *peer_list;
 
@@ -2356,7 +2382,7 @@ struct wlan_objmgr_peer *wlan_objmgr_get_peer_logically_deleted(
 			wlan_objmgr_ref_dbgid dbg_id)
 {
 	struct wlan_objmgr_psoc_objmgr *objmgr;
-	uint8_t hash_index;
+	uint16_t hash_index;
 	struct wlan_objmgr_peer *peer = NULL;
 	struct wlan_peer_list *peer_list;
 
@@ -2390,7 +2416,7 @@ struct wlan_objmgr_peer *wlan_objmgr_get_peer_by_mac_n_vdev_no_state_debug(
 			const char *func, int line)
 {
 	struct wlan_objmgr_psoc_objmgr *objmgr;
-	uint8_t hash_index;
+	uint16_t hash_index;
 	struct wlan_objmgr_peer *peer = NULL;
 	struct wlan_peer_list *peer_list;
 
@@ -2424,7 +2450,7 @@ struct wlan_objmgr_peer *wlan_objmgr_get_peer_by_mac_n_vdev_no_state(
 			wlan_objmgr_ref_dbgid dbg_id)
 {
 	struct wlan_objmgr_psoc_objmgr *objmgr;
-	uint8_t hash_index;
+	uint16_t hash_index;
 	struct wlan_objmgr_peer *peer = NULL;
 	struct wlan_peer_list *peer_list;
 
@@ -2461,7 +2487,7 @@ struct wlan_objmgr_peer *wlan_objmgr_get_peer_by_mac_n_vdev_debug(
 			const char *func, int line)
 {
 	struct wlan_objmgr_psoc_objmgr *objmgr;
-	uint8_t hash_index;
+	uint16_t hash_index;
 	struct wlan_objmgr_peer *peer = NULL;
 	struct wlan_peer_list *peer_list;
 
@@ -2495,7 +2521,7 @@ struct wlan_objmgr_peer *wlan_objmgr_get_peer_by_mac_n_vdev(
 			wlan_objmgr_ref_dbgid dbg_id)
 {
 	struct wlan_objmgr_psoc_objmgr *objmgr;
-	uint8_t hash_index;
+	uint16_t hash_index;
 	struct wlan_objmgr_peer *peer = NULL;
 	struct wlan_peer_list *peer_list;
 
@@ -2531,7 +2557,7 @@ struct wlan_objmgr_peer *wlan_objmgr_get_peer_nolock_debug(
 			const char *func, int line)
 {
 	struct wlan_objmgr_psoc_objmgr *objmgr;
-	uint8_t hash_index;
+	uint16_t hash_index;
 	struct wlan_objmgr_peer *peer = NULL;
 	struct wlan_peer_list *peer_list;
 
@@ -2559,7 +2585,7 @@ struct wlan_objmgr_peer *wlan_objmgr_get_peer_nolock(
 			uint8_t *macaddr, wlan_objmgr_ref_dbgid dbg_id)
 {
 	struct wlan_objmgr_psoc_objmgr *objmgr;
-	uint8_t hash_index;
+	uint16_t hash_index;
 	struct wlan_objmgr_peer *peer = NULL;
 	struct wlan_peer_list *peer_list;
 
@@ -2589,7 +2615,7 @@ struct wlan_objmgr_peer *wlan_objmgr_get_peer_no_state_debug(
 			const char *func, int line)
 {
 	struct wlan_objmgr_psoc_objmgr *objmgr;
-	uint8_t hash_index;
+	uint16_t hash_index;
 	struct wlan_objmgr_peer *peer = NULL;
 	struct wlan_peer_list *peer_list;
 
@@ -2622,7 +2648,7 @@ struct wlan_objmgr_peer *wlan_objmgr_get_peer_no_state(
 			uint8_t *macaddr, wlan_objmgr_ref_dbgid dbg_id)
 {
 	struct wlan_objmgr_psoc_objmgr *objmgr;
-	uint8_t hash_index;
+	uint16_t hash_index;
 	struct wlan_objmgr_peer *peer = NULL;
 	struct wlan_peer_list *peer_list;
 
@@ -2658,7 +2684,7 @@ qdf_list_t *wlan_objmgr_populate_logically_deleted_peerlist_by_mac_n_vdev_debug(
 			const char *func, int line)
 {
 	struct wlan_objmgr_psoc_objmgr *objmgr;
-	uint8_t hash_index;
+	uint16_t hash_index;
 	struct wlan_peer_list *peer_list = NULL;
 	qdf_list_t *logical_del_peer_list = NULL;
 
@@ -2695,7 +2721,7 @@ qdf_list_t *wlan_objmgr_populate_logically_deleted_peerlist_by_mac_n_vdev(
 			wlan_objmgr_ref_dbgid dbg_id)
 {
 	struct wlan_objmgr_psoc_objmgr *objmgr;
-	uint8_t hash_index;
+	uint16_t hash_index;
 	struct wlan_peer_list *peer_list = NULL;
 	qdf_list_t *logical_del_peer_list = NULL;
 
@@ -3131,6 +3157,8 @@ void wlan_print_psoc_info(struct wlan_objmgr_psoc *psoc)
 		obj_mgr_debug("wlan_vdev_list[%d]: %pK", index, vdev);
 		wlan_print_vdev_info(vdev);
 	}
+
+	wlan_objmgr_print_peer_hash_stats(psoc);
 }
 
 qdf_export_symbol(wlan_print_psoc_info);
@@ -2002,6 +2002,34 @@ int dfs_bin_check(struct wlan_dfs *dfs,
 		uint32_t width,
 		int ext_chan_flag);
 
+#ifdef WLAN_DFS_PULSE_REPLAY_TEST
+/**
+ * dfs_bin_test_set_ref_score() - Select the PRI scoring dfs_bin_check() uses
+ * @enable: true to walk the whole delay line for every score as before,
+ *          false for the sorted delay line scoring.
+ *
+ * Test hook for the pulse replay test, which runs both and compares the
+ * detection decisions. It is global, so only use it with no radar
+ * processing going on.
+ */
+void dfs_bin_test_set_ref_score(bool enable);
+
+/**
+ * dfs_bin_test_find_priscores() - Score every delay element PRI
+ * @dl: Pointer to dfs_delayline structure.
+ * @rf: Pointer to dfs_filter structure.
+ * @score: Score array of DFS_MAX_DL_SIZE entries.
+ * @primargin: PRI margin.
+ *
+ * Test hook for the pulse replay test, with the scoring selected by
+ * dfs_bin_test_set_ref_score().
+ */
+void dfs_bin_test_find_priscores(struct dfs_delayline *dl,
+				 struct dfs_filter *rf,
+				 int *score,
+				 uint32_t primargin);
+#endif /* WLAN_DFS_PULSE_REPLAY_TEST */
+
 /**
  * dfs_bin_pri_check() - BIN PRI check
  * @dfs: Pointer to wlan_dfs structure.
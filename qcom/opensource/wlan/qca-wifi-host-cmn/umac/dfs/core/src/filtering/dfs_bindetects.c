@@ -360,16 +360,107 @@ static inline void dfs_find_lowestpri(
 }
 
 /**
- * dfs_calculate_score() - Calculate score for the score index
- * if PRI match is found
+ * dfs_sort_delayline_pri() - Build an ascending copy of the delay line PRIs
+ * @dl: Pointer to dfs delayline.
+ * @sorted_pri: Output array of at least DFS_MAX_DL_SIZE entries.
+ *
+ * The delay line holds at most DFS_MAX_DL_SIZE entries and is usually
+ * close to sorted already, so a plain insertion sort is the cheapest
+ * option here.
+ */
+static void dfs_sort_delayline_pri(struct dfs_delayline *dl,
+				   uint32_t *sorted_pri)
+{
+	uint32_t i, j, pri;
+	int dindex;
+
+	for (i = 0; i < dl->dl_numelems; i++) {
+		dindex = (dl->dl_firstelem + i) & DFS_MAX_DL_MASK;
+		pri = dl->dl_elems[dindex].de_time;
+		for (j = i; j > 0 && sorted_pri[j - 1] > pri; j--)
+			sorted_pri[j] = sorted_pri[j - 1];
+		sorted_pri[j] = pri;
+	}
+}
+
+/**
+ * dfs_pri_lower_bound() - Find the first sorted PRI not below a value
+ * @sorted_pri: Ascending PRI array.
+ * @numelems: Number of entries in @sorted_pri.
+ * @val: Value to search for.
+ *
+ * Return: Index of the first entry >= @val, or @numelems if none.
+ */
+static inline uint32_t dfs_pri_lower_bound(const uint32_t *sorted_pri,
+					   uint32_t numelems,
+					   uint32_t val)
+{
+	uint32_t lo = 0, hi = numelems, mid;
+
+	while (lo < hi) {
+		mid = lo + ((hi - lo) >> 1);
+		if (sorted_pri[mid] < val)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+/**
+ * dfs_count_pri_window() - Count sorted PRIs in [@lo, @hi)
+ * @sorted_pri: Ascending PRI array.
+ * @numelems: Number of entries in @sorted_pri.
+ * @lo: Inclusive lower bound.
+ * @hi: Exclusive upper bound.
+ *
+ * Return: Number of entries in the window.
+ */
+static inline uint32_t dfs_count_pri_window(const uint32_t *sorted_pri,
+					    uint32_t numelems,
+					    uint32_t lo,
+					    uint32_t hi)
+{
+	if (lo >= hi)
+		return 0;
+
+	return dfs_pri_lower_bound(sorted_pri, numelems, hi) -
+		dfs_pri_lower_bound(sorted_pri, numelems, lo);
+}
+
+#ifdef WLAN_DFS_PULSE_REPLAY_TEST
+static bool dfs_bin_ref_score;
+
+void dfs_bin_test_set_ref_score(bool enable)
+{
+	dfs_bin_ref_score = enable;
+}
+
+/**
+ * dfs_use_ref_score() - Whether PRI scores come from the reference walk
+ *
+ * Return: true while the pulse replay test runs the reference scoring.
+ */
+static inline bool dfs_use_ref_score(void)
+{
+	return dfs_bin_ref_score;
+}
+
+/**
+ * dfs_calculate_score_ref() - Calculate score for the score index by
+ * walking the whole delay line
  * @dl: Pointer to dfs delayline.
  * @rf: Pointer to dfs_filter structure.
  * @score: score array.
  * @refpri: reference PRI.
  * @primargin: PRI margin.
  * @score_index: Score index.
+ *
+ * The scoring dfs_calculate_score() replaced, kept as the reference the
+ * pulse replay test compares detection decisions against.
  */
-static inline void dfs_calculate_score(
+static void dfs_calculate_score_ref(
 	struct dfs_delayline *dl,
 	struct dfs_filter *rf,
 	int *score,
@@ -399,6 +490,69 @@ static inline void dfs_calculate_score(
 			score[score_index]++;
 	}
 }
+#else
+static inline bool dfs_use_ref_score(void)
+{
+	return false;
+}
+
+static inline void dfs_calculate_score_ref(
+	struct dfs_delayline *dl,
+	struct dfs_filter *rf,
+	int *score,
+	uint32_t refpri,
+	uint32_t primargin,
+	uint32_t score_index)
+{
+}
+#endif /* WLAN_DFS_PULSE_REPLAY_TEST */
+
+/**
+ * dfs_calculate_score() - Calculate score for the score index
+ * if PRI match is found
+ * @sorted_pri: Ascending copy of the delay line PRIs.
+ * @numelems: Number of entries in @sorted_pri.
+ * @rf: Pointer to dfs_filter structure.
+ * @score: score array.
+ * @refpri: reference PRI.
+ * @primargin: PRI margin.
+ * @score_index: Score index.
+ *
+ * A delay element matches when DFS_DIFF(pri, refpri) < primargin, i.e.
+ * when its PRI lies in the half-open window [refpri - primargin + 1,
+ * refpri + primargin). With rf_ignore_pri_window == 2 the windows around
+ * 2 * refpri and 3 * refpri count as well; the windows are ascending, so
+ * each one is clipped to start where the previous one ended to avoid
+ * counting an element twice.
+ */
+static inline void dfs_calculate_score(
+	const uint32_t *sorted_pri,
+	uint32_t numelems,
+	struct dfs_filter *rf,
+	int *score,
+	uint32_t refpri,
+	uint32_t primargin,
+	uint32_t score_index)
+{
+	uint32_t nwin, k, center, lo, hi, prev_hi = 0;
+	uint32_t count = 0;
+
+	if (!primargin)
+		return;
+
+	nwin = (rf->rf_ignore_pri_window == 2) ? 3 : 1;
+	for (k = 1; k <= nwin; k++) {
+		center = k * refpri;
+		lo = (center >= primargin) ? center - primargin + 1 : 0;
+		hi = center + primargin;
+		if (lo < prev_hi)
+			lo = prev_hi;
+		count += dfs_count_pri_window(sorted_pri, numelems, lo, hi);
+		prev_hi = hi;
+	}
+
+	score[score_index] += count;
+}
 
 /**
  * dfs_find_priscores() - Find PRI score
@@ -406,6 +560,9 @@ static inline void dfs_calculate_score(
  * @rf: Pointer to dfs_filter structure.
  * @score: score array.
  * @primargin: PRI margin.
+ *
+ * The delay line is sorted once so that each element's score is two or
+ * six binary searches rather than a full walk of the delay line.
  */
 static void dfs_find_priscores(
 	struct dfs_delayline *dl,
@@ -416,9 +573,12 @@ static void dfs_find_priscores(
 	int delayindex;
 	uint32_t refpri;
 	uint32_t n;
+	uint32_t sorted_pri[DFS_MAX_DL_SIZE];
 
 	qdf_mem_zero(score, sizeof(int)*DFS_MAX_DL_SIZE);
 
+	dfs_sort_delayline_pri(dl, sorted_pri);
+
 	for (n = 0; n < dl->dl_numelems; n++) {
 		delayindex = (dl->dl_firstelem + n) & DFS_MAX_DL_MASK;
 		refpri = dl->dl_elems[delayindex].de_time;
@@ -426,8 +586,13 @@ static void dfs_find_priscores(
 			continue;
 		if (refpri < rf->rf_maxpri) {
 			/* Use only valid PRI range for high score. */
-			dfs_calculate_score(dl, rf, score, refpri, primargin,
-				n);
+			if (dfs_use_ref_score())
+				dfs_calculate_score_ref(dl, rf, score, refpri,
+							primargin, n);
+			else
+				dfs_calculate_score(sorted_pri,
+						    dl->dl_numelems, rf, score,
+						    refpri, primargin, n);
 		} else {
 			score[n] = 0;
 		}
@@ -442,6 +607,16 @@ static void dfs_find_priscores(
 	}
 }
 
+#ifdef WLAN_DFS_PULSE_REPLAY_TEST
+void dfs_bin_test_find_priscores(struct dfs_delayline *dl,
+				 struct dfs_filter *rf,
+				 int *score,
+				 uint32_t primargin)
+{
+	dfs_find_priscores(dl, rf, score, primargin);
+}
+#endif
+
 /**
  * dfs_find_highscore() - Find PRI high score
  * @dl: Pointer to dfs delayline.
@@ -0,0 +1,424 @@
+/*
+ * Copyright (c) 2024 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted, provided that the
+ * above copyright notice and this permission notice appear in all
+ * copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+ * AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR
+ * PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+ * TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "../../dfs.h"
+#include "dfs_pulse_replay_test.h"
+#include "qdf_mem.h"
+#include "qdf_time.h"
+#include "qdf_trace.h"
+
+/* pulses more than this many maximum PRIs apart are rejected */
+#define DFS_PULSE_REPLAY_PRI_MULTIPLIER 2
+/* traces per radar type and impairment, each with its own PRI and width */
+#define DFS_PULSE_REPLAY_SEEDS 8
+#define DFS_PULSE_REPLAY_NOISE_TRACES 64
+#define DFS_PULSE_REPLAY_NOISE_PULSES 256
+/* quiet time between traces, longer than the longest filter */
+#define DFS_PULSE_REPLAY_GAP_US 200000
+#define DFS_PULSE_REPLAY_MAX_DUR 30
+#define DFS_PULSE_REPLAY_RSSI 30
+
+enum dfs_pulse_replay_copy {
+	DFS_PULSE_REPLAY_REF,
+	DFS_PULSE_REPLAY_SORTED,
+	DFS_PULSE_REPLAY_COPIES,
+};
+
+enum dfs_pulse_replay_mode {
+	DFS_PULSE_REPLAY_CLEAN,
+	/* every fourth pulse is missing, so the PRI doubles */
+	DFS_PULSE_REPLAY_LOSSY,
+	/* interfering pulses between the radar pulses */
+	DFS_PULSE_REPLAY_BUSY,
+	DFS_PULSE_REPLAY_MODES,
+};
+
+static const char * const dfs_pulse_replay_mode_names[] = {
+	"clean", "lossy", "busy",
+};
+
+/*
+ * Constant PRI rows of the partial offload FCC, MKK4 and ETSI radar
+ * tables, the ones dfs_bin_check() scores. Fixed pattern and staggered
+ * rows are detected elsewhere.
+ */
+static const struct dfs_pulse dfs_pulse_replay_radars[] = {
+	/* FCC TYPE 1 */
+	{18,  1,  700, 700, 0,  4,  5,  0,  1, 18,  0, 3,  1, 5, 0, 0},
+	{18,  1,  350, 350, 0,  4,  5,  0,  1, 18,  0, 3,  0, 5, 0, 0},
+	/* FCC TYPE 2 */
+	{23, 5, 4347, 6666, 0,  4, 11,  0,  7, 22,  0, 3,  0, 5, 0, 2},
+	/* FCC TYPE 3 */
+	{18, 10, 2000, 5000, 0,  4,  8,  6, 13, 22,  0, 3, 0, 5, 0, 5},
+	/* FCC TYPE 4 */
+	{16, 15, 2000, 5000, 0,  4,  7, 11, 23, 22,  0, 3, 0, 5, 0, 11},
+	/* FCC NEW TYPE 1 */
+	{57, 1, 1066, 1930, 0, 4,  20,  0,  1, 22,  0, 3,  0, 5, 0, 21},
+	{27, 1,  500, 1066, 0, 4,  13,  0,  1, 22,  0, 3,  0, 5, 0, 22},
+	{18, 1,  325,  500, 0, 4,  9,   0,  1, 22,  0, 3,  0, 5, 0, 23},
+	/* MKK4 1389 +/- 6 us */
+	{18,  1,  720,  720, 0,  4,  6,  0,  1, 18,  0, 3, 0, 5, 0, 17},
+	/* MKK4 4000 +/- 6 us */
+	{18,  4,  250,  250, 0,  4,  5,  1,  6, 18,  0, 3, 0, 5, 0, 18},
+	/* MKK4 3846 +/- 7 us */
+	{18,  5,  260,  260, 0,  4,  6,  1,  6, 18,  0, 3, 1, 5, 0, 19},
+	/* ETSI Type 3 */
+	{15, 15, 200, 1000, 0, 4, 5, 8, 18, 22, 0, 0, 0, 5, 0, 42},
+	/* ETSI Type 4 */
+	{15, 15, 1200, 1600, 0, 4, 5, 0, 18, 22, 0, 0, 0, 5, 0, 43},
+	/* ETSI Type 1 */
+	{10, 5,   200,  400, 0,  4,  5,  0,  8, 15, 0,   0, 2, 5, 0, 33},
+	{10, 5,   400,  600, 0,  4,  5,  0,  8, 15, 0,   0, 2, 5, 0, 37},
+	{10, 5,   600,  800, 0,  4,  5,  0,  8, 15, 0,   0, 2, 5, 0, 38},
+	{10, 5,   800, 1000, 0,  4,  5,  0,  8, 15, 0,   0, 2, 5, 0, 39},
+	/* ETSI Type 2 */
+	{15, 15,  200, 1600, 0,  4, 8,  0, 18, 24, 0,   0, 0, 5, 0, 34},
+	/* ETSI Type 3 */
+	{25, 15, 2300, 4000, 0,  4, 10, 0, 18, 24, 0,   0, 0, 5, 0, 35},
+	/* ETSI Type 4 */
+	{20, 30, 2000, 4000, 0,  4, 6, 19, 33, 24, 0,   0, 0, 24,  1, 36},
+};
+
+#define DFS_PULSE_REPLAY_NUM_RADARS QDF_ARRAY_SIZE(dfs_pulse_replay_radars)
+
+/**
+ * struct dfs_pulse_replay_ctx - DFS pulse replay test state
+ * @dfs: DFS object the filters run against
+ * @chan: Current channel of @dfs, not HT40 so margins are not adjusted
+ * @filters: One filter per radar row for each scoring, fed the same pulses
+ * @seed: Pseudo-random generator state
+ * @ts: Time of the last pulse in usecs
+ * @pulses: Pulses replayed
+ * @checks: Pulses that reached dfs_bin_check()
+ * @detections: Detections of each replay mode, noise only last
+ * @check_ns: Time spent in dfs_bin_check() with each scoring
+ * @errors: Number of mismatches
+ */
+struct dfs_pulse_replay_ctx {
+	struct wlan_dfs *dfs;
+	struct dfs_channel chan;
+	struct dfs_filter filters[DFS_PULSE_REPLAY_COPIES]
+				 [DFS_PULSE_REPLAY_NUM_RADARS];
+	uint32_t seed;
+	uint64_t ts;
+	uint32_t pulses;
+	uint32_t checks;
+	uint32_t detections[DFS_PULSE_REPLAY_MODES + 1];
+	int64_t check_ns[DFS_PULSE_REPLAY_COPIES];
+	uint32_t errors;
+};
+
+static uint32_t dfs_pulse_replay_rand(struct dfs_pulse_replay_ctx *ctx,
+				      uint32_t range)
+{
+	ctx->seed = ctx->seed * 1664525 + 1013904223;
+
+	return (ctx->seed >> 8) % range;
+}
+
+/*
+ * dfs_reset_delayline() only clears the elements, start every trace from
+ * an empty delay line with no last pulse time instead
+ */
+static void dfs_pulse_replay_clear(struct dfs_delayline *dl)
+{
+	qdf_mem_zero(dl, sizeof(*dl));
+	dfs_reset_delayline(dl);
+}
+
+/* the same conversion dfs_init_radar_filters() does */
+static void dfs_pulse_replay_init_filter(struct dfs_filter *rf,
+					 const struct dfs_pulse *radar)
+{
+	uint32_t T, Tmax;
+
+	dfs_pulse_replay_clear(&rf->rf_dl);
+	rf->rf_numpulses = radar->rp_numpulses;
+	rf->rf_patterntype = radar->rp_patterntype;
+	rf->rf_sidx_spread = radar->rp_sidx_spread;
+	rf->rf_check_delta_peak = radar->rp_check_delta_peak;
+	rf->rf_pulseid = radar->rp_pulseid;
+	rf->rf_mindur = radar->rp_mindur;
+	rf->rf_maxdur = radar->rp_maxdur;
+	rf->rf_ignore_pri_window = radar->rp_ignore_pri_window;
+	T = (100000000 / radar->rp_max_pulsefreq) -
+		100 * radar->rp_meanoffset;
+	rf->rf_minpri = dfs_round((int32_t)T - 100 * radar->rp_pulsevar);
+	Tmax = (100000000 / radar->rp_pulsefreq) -
+		100 * radar->rp_meanoffset;
+	rf->rf_maxpri = dfs_round((int32_t)Tmax + 100 * radar->rp_pulsevar);
+	rf->rf_fixed_pri_radar_pulse =
+		radar->rp_max_pulsefreq == radar->rp_pulsefreq;
+	rf->rf_threshold = radar->rp_threshold;
+	rf->rf_filterlen = rf->rf_maxpri * rf->rf_numpulses;
+}
+
+static void dfs_pulse_replay_reset(struct dfs_pulse_replay_ctx *ctx)
+{
+	int copy, i;
+
+	for (copy = 0; copy < DFS_PULSE_REPLAY_COPIES; copy++)
+		for (i = 0; i < DFS_PULSE_REPLAY_NUM_RADARS; i++)
+			dfs_pulse_replay_clear(&ctx->filters[copy][i].rf_dl);
+}
+
+/*
+ * Feed one pulse to one filter the way __dfs_process_radarevent() does.
+ * Return: -1 if the filter rejected the pulse, else the dfs_bin_check()
+ * decision.
+ */
+static int dfs_pulse_replay_filter(struct dfs_pulse_replay_ctx *ctx,
+				   struct dfs_filter *rf,
+				   struct dfs_event *re,
+				   enum dfs_pulse_replay_copy copy,
+				   int *score)
+{
+	struct wlan_dfs *dfs = ctx->dfs;
+	uint64_t deltaT = ctx->ts - rf->rf_dl.dl_last_ts;
+	uint32_t primargin;
+	qdf_ktime_t start;
+	int found;
+
+	/* dfs_reject_on_pri() */
+	if (deltaT < rf->rf_minpri && deltaT != 0)
+		return -1;
+
+	if (rf->rf_ignore_pri_window > 0) {
+		if (deltaT < rf->rf_minpri) {
+			rf->rf_dl.dl_last_ts = ctx->ts;
+			return -1;
+		}
+	} else if (deltaT > dfs->dfs_pri_multiplier * rf->rf_maxpri ||
+		   deltaT < rf->rf_minpri) {
+		rf->rf_dl.dl_last_ts = ctx->ts;
+		return -1;
+	}
+
+	dfs_add_pulse(dfs, rf, re, deltaT, ctx->ts);
+
+	dfs_bin_test_set_ref_score(copy == DFS_PULSE_REPLAY_REF);
+	primargin = dfs_get_pri_margin(dfs, 0, 0);
+	dfs_bin_test_find_priscores(&rf->rf_dl, rf, score, primargin);
+
+	start = qdf_ktime_get();
+	found = dfs_bin_check(dfs, rf, deltaT, re->re_dur, 0);
+	ctx->check_ns[copy] += qdf_ktime_to_ns(qdf_ktime_get()) -
+			       qdf_ktime_to_ns(start);
+
+	rf->rf_dl.dl_last_ts = ctx->ts;
+
+	return found;
+}
+
+static void dfs_pulse_replay_pulse(struct dfs_pulse_replay_ctx *ctx,
+				   uint64_t ts, uint8_t dur, uint32_t mode)
+{
+	struct dfs_filter *ref_rf, *rf;
+	struct dfs_event re = {0};
+	const char *mismatch;
+	int ref_score[DFS_MAX_DL_SIZE];
+	int score[DFS_MAX_DL_SIZE];
+	int ref_found, found;
+	int i;
+
+	ctx->ts = ts;
+	ctx->pulses++;
+	re.re_full_ts = ts;
+	re.re_ts = (uint32_t)ts;
+	re.re_dur = dur;
+	re.re_rssi = DFS_PULSE_REPLAY_RSSI;
+
+	for (i = 0; i < DFS_PULSE_REPLAY_NUM_RADARS; i++) {
+		ref_rf = &ctx->filters[DFS_PULSE_REPLAY_REF][i];
+		rf = &ctx->filters[DFS_PULSE_REPLAY_SORTED][i];
+		if (dur < rf->rf_mindur || dur > rf->rf_maxdur)
+			continue;
+
+		ref_found = dfs_pulse_replay_filter(ctx, ref_rf, &re,
+						    DFS_PULSE_REPLAY_REF,
+						    ref_score);
+		found = dfs_pulse_replay_filter(ctx, rf, &re,
+						DFS_PULSE_REPLAY_SORTED, score);
+
+		if (ref_found != found)
+			mismatch = "decision";
+		else if (found >= 0 &&
+			 qdf_mem_cmp(ref_score, score, sizeof(score)))
+			mismatch = "scores";
+		else if (qdf_mem_cmp(&ref_rf->rf_dl, &rf->rf_dl,
+				     sizeof(rf->rf_dl)))
+			mismatch = "delay line";
+		else
+			mismatch = NULL;
+
+		if (mismatch) {
+			qdf_nofl_err("dfs_pulse_replay: %s: filter %u ts %llu dur %u: found %d, expected %d",
+				     mismatch, rf->rf_pulseid, ts, dur, found,
+				     ref_found);
+			ctx->errors++;
+			/* carry on from the reference state */
+			rf->rf_dl = ref_rf->rf_dl;
+			continue;
+		}
+
+		if (found < 0)
+			continue;
+
+		ctx->checks++;
+		if (found) {
+			ctx->detections[mode]++;
+			dfs_pulse_replay_clear(&ref_rf->rf_dl);
+			dfs_pulse_replay_clear(&rf->rf_dl);
+		}
+	}
+}
+
+/*
+ * A burst of one radar type, half as many pulses again as the filter
+ * needs, with PRI and width drawn from the type's ranges and +/- 1 us of
+ * PRI jitter.
+ */
+static void dfs_pulse_replay_radar(struct dfs_pulse_replay_ctx *ctx,
+				   const struct dfs_pulse *radar,
+				   enum dfs_pulse_replay_mode mode)
+{
+	uint32_t pri_min, pri_max, pri, numpulses, i;
+	uint64_t start, ts;
+	uint8_t dur;
+
+	pri_min = 1000000 / radar->rp_max_pulsefreq;
+	pri_max = 1000000 / radar->rp_pulsefreq;
+	pri = pri_min + dfs_pulse_replay_rand(ctx, pri_max - pri_min + 1);
+	dur = radar->rp_mindur +
+	      dfs_pulse_replay_rand(ctx, radar->rp_maxdur -
+				    radar->rp_mindur + 1);
+	numpulses = radar->rp_numpulses + radar->rp_numpulses / 2;
+
+	dfs_pulse_replay_reset(ctx);
+	start = ctx->ts + DFS_PULSE_REPLAY_GAP_US;
+	for (i = 0; i < numpulses; i++) {
+		ts = start + (uint64_t)i * pri + dfs_pulse_replay_rand(ctx, 3);
+		if (mode == DFS_PULSE_REPLAY_LOSSY && i % 4 == 3)
+			continue;
+
+		dfs_pulse_replay_pulse(ctx, ts, dur, mode);
+
+		if (mode != DFS_PULSE_REPLAY_BUSY)
+			continue;
+
+		/* up to two interferers before the next radar pulse */
+		ts += 2 + dfs_pulse_replay_rand(ctx, pri / 3);
+		dfs_pulse_replay_pulse(ctx, ts, 1 +
+				       dfs_pulse_replay_rand(ctx,
+						DFS_PULSE_REPLAY_MAX_DUR),
+				       mode);
+		if (dfs_pulse_replay_rand(ctx, 2))
+			continue;
+
+		ts += 2 + dfs_pulse_replay_rand(ctx, pri / 3);
+		dfs_pulse_replay_pulse(ctx, ts, 1 +
+				       dfs_pulse_replay_rand(ctx,
+						DFS_PULSE_REPLAY_MAX_DUR),
+				       mode);
+	}
+}
+
+/* pulses at random times and widths, no radar in them */
+static void dfs_pulse_replay_noise(struct dfs_pulse_replay_ctx *ctx)
+{
+	uint64_t ts;
+	uint32_t i;
+
+	dfs_pulse_replay_reset(ctx);
+	ts = ctx->ts + DFS_PULSE_REPLAY_GAP_US;
+	for (i = 0; i < DFS_PULSE_REPLAY_NOISE_PULSES; i++) {
+		ts += 50 + dfs_pulse_replay_rand(ctx, 3000);
+		dfs_pulse_replay_pulse(ctx, ts, 1 +
+				       dfs_pulse_replay_rand(ctx,
+						DFS_PULSE_REPLAY_MAX_DUR),
+				       DFS_PULSE_REPLAY_MODES);
+	}
+}
+
+static void dfs_pulse_replay_run(struct dfs_pulse_replay_ctx *ctx)
+{
+	uint32_t mode, seed, i;
+
+	for (i = 0; i < DFS_PULSE_REPLAY_NUM_RADARS; i++)
+		for (mode = 0; mode < DFS_PULSE_REPLAY_MODES; mode++)
+			for (seed = 0; seed < DFS_PULSE_REPLAY_SEEDS; seed++)
+				dfs_pulse_replay_radar(ctx,
+						&dfs_pulse_replay_radars[i],
+						mode);
+
+	for (i = 0; i < DFS_PULSE_REPLAY_NOISE_TRACES; i++)
+		dfs_pulse_replay_noise(ctx);
+}
+
+uint32_t dfs_pulse_replay_unit_test(void)
+{
+	struct dfs_pulse_replay_ctx *ctx;
+	uint32_t errors;
+	int copy, i;
+
+	ctx = qdf_mem_valloc(sizeof(*ctx));
+	if (!ctx)
+		return 1;
+
+	ctx->dfs = qdf_mem_malloc(sizeof(*ctx->dfs));
+	if (!ctx->dfs) {
+		qdf_mem_vfree(ctx);
+		return 1;
+	}
+
+	ctx->dfs->dfs_curchan = &ctx->chan;
+	ctx->dfs->dfs_pri_multiplier = DFS_PULSE_REPLAY_PRI_MULTIPLIER;
+	ctx->seed = 1;
+	for (copy = 0; copy < DFS_PULSE_REPLAY_COPIES; copy++)
+		for (i = 0; i < DFS_PULSE_REPLAY_NUM_RADARS; i++)
+			dfs_pulse_replay_init_filter(&ctx->filters[copy][i],
+						&dfs_pulse_replay_radars[i]);
+
+	dfs_pulse_replay_run(ctx);
+	dfs_bin_test_set_ref_score(false);
+
+	/* the replay must have exercised the scoring at all */
+	if (!ctx->checks) {
+		qdf_nofl_err("dfs_pulse_replay: no pulse reached dfs_bin_check");
+		ctx->errors++;
+	}
+
+	for (i = 0; i < DFS_PULSE_REPLAY_MODES; i++)
+		qdf_nofl_info("dfs_pulse_replay: %s: %u detections",
+			      dfs_pulse_replay_mode_names[i],
+			      ctx->detections[i]);
+	qdf_nofl_info("dfs_pulse_replay: noise: %u detections",
+		      ctx->detections[DFS_PULSE_REPLAY_MODES]);
+	qdf_nofl_info("dfs_pulse_replay: %u pulses %u bin checks, %lld ns reference %lld ns sorted",
+		      ctx->pulses, ctx->checks,
+		      ctx->check_ns[DFS_PULSE_REPLAY_REF],
+		      ctx->check_ns[DFS_PULSE_REPLAY_SORTED]);
+
+	errors = ctx->errors;
+	qdf_mem_free(ctx->dfs);
+	qdf_mem_vfree(ctx);
+
+	QDF_BUG(!errors);
+
+	return errors;
+}
@@ -0,0 +1,36 @@
+/*
+ * Copyright (c) 2024 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted, provided that the
+ * above copyright notice and this permission notice appear in all
+ * copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+ * AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR
+ * PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+ * TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef __DFS_PULSE_REPLAY_TEST_H
+#define __DFS_PULSE_REPLAY_TEST_H
+
+#ifdef WLAN_DFS_PULSE_REPLAY_TEST
+/**
+ * dfs_pulse_replay_unit_test() - run the DFS pulse replay unit test
+ *
+ * Return: number of failed test cases
+ */
+uint32_t dfs_pulse_replay_unit_test(void);
+#else
+static inline uint32_t dfs_pulse_replay_unit_test(void)
+{
+	return 0;
+}
+#endif /* WLAN_DFS_PULSE_REPLAY_TEST */
+
+#endif /* __DFS_PULSE_REPLAY_TEST_H */
@@ -79,7 +79,7 @@ struct wlan_mlo_peer_context *mlo_get_mlpeer(
 				struct wlan_mlo_dev_context *ml_dev,
 				const struct qdf_mac_addr *ml_addr)
 {
-	uint8_t hash_index;
+	uint16_t hash_index;
 	struct wlan_mlo_peer_list *mlo_peer_list;
 	struct wlan_mlo_peer_context *ml_peer;
 	struct wlan_mlo_peer_context *next_ml_peer;
@@ -112,7 +112,7 @@ QDF_STATUS wlan_mlo_iterate_ml_peerlist(struct wlan_mlo_dev_context *ml_dev,
 					wlan_mlo_op_handler handler,
 					void *arg)
 {
-	uint8_t hash_index;
+	uint16_t hash_index;
 	struct wlan_mlo_peer_list *peerlist;
 	struct wlan_mlo_peer_context *ml_peer;
 	struct wlan_mlo_peer_context *next;
@@ -400,7 +400,7 @@ static QDF_STATUS wlan_mlo_peerlist_remove_mlpeer(
 QDF_STATUS mlo_dev_mlpeer_attach(struct wlan_mlo_dev_context *ml_dev,
 				 struct wlan_mlo_peer_context *ml_peer)
 {
-	uint8_t hash_index;
+	uint16_t hash_index;
 	struct wlan_mlo_peer_list *mlo_peer_list;
 
 	mlo_peer_list = &ml_dev->mlo_peer_list;
@@ -428,7 +428,7 @@ QDF_STATUS mlo_dev_mlpeer_attach(struct wlan_mlo_dev_context *ml_dev,
 QDF_STATUS mlo_dev_mlpeer_detach(struct wlan_mlo_dev_context *ml_dev,
 				 struct wlan_mlo_peer_context *ml_peer)
 {
-	uint8_t hash_index;
+	uint16_t hash_index;
 	QDF_STATUS status;
 	struct wlan_mlo_peer_list *mlo_peer_list;
 
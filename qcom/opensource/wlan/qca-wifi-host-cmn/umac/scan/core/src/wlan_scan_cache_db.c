@@ -40,6 +40,10 @@
  *   it the node is physically deleted from the scan cache.
  * - While reading the node the ref_cnt should be incremented. Once reading
  *   operation is done ref_cnt is decremented.
+ * - Every active node is also linked in the age list of the scan db, sorted
+ *   by scan_entry_time. A node leaves the age list as soon as it is logically
+ *   deleted, so aging and eviction of the oldest entry only look at the head
+ *   of the age list instead of iterating the whole scan cache.
  */
 #include <qdf_status.h>
 #include <wlan_objmgr_psoc_obj.h>
@@ -300,6 +304,10 @@ static QDF_STATUS scm_del_scan_node_from_db(struct scan_dbs *scan_db,
 	if (!scan_node)
 		return QDF_STATUS_E_INVAL;
 
+	if (qdf_list_node_in_any_list(&scan_node->age_node))
+		qdf_list_remove_node(&scan_db->scan_age_list,
+				     &scan_node->age_node);
+
 	hash_idx = SCAN_GET_HASH(scan_node->entry->bssid.bytes);
 	scm_del_scan_node(&scan_db->scan_hash_tbl[hash_idx], scan_node);
 	scan_db->num_entries--;
@@ -390,9 +398,57 @@ static void scm_scan_entry_del(struct scan_dbs *scan_db,
 		return;
 	}
 	scan_node->cookie = 0;
+	/*
+	 * A logically deleted node must not be picked for aging or eviction
+	 * again, drop it from the age list right away even if it stays in the
+	 * hash table until the last reference is released.
+	 */
+	qdf_list_remove_node(&scan_db->scan_age_list, &scan_node->age_node);
 	scm_scan_entry_put_ref(scan_db, scan_node, false);
 }
 
+/**
+ * scm_add_scan_node_to_age_list() - insert scan node in the age list
+ * @scan_db: data base
+ * @scan_node: node to be added
+ *
+ * Entries are mostly added in order of reception, so the node is appended
+ * at the tail. Only if a frame was processed late, e.g. from a deferred
+ * queue, the list is walked to keep it sorted by scan_entry_time.
+ *
+ * Call must be protected by scan_db->scan_db_lock
+ *
+ * Return: void
+ */
+static void scm_add_scan_node_to_age_list(struct scan_dbs *scan_db,
+					  struct scan_cache_node *scan_node)
+{
+	struct scan_cache_node *cur_node;
+	qdf_time_t entry_time = scan_node->entry->scan_entry_time;
+
+	if (qdf_list_empty(&scan_db->scan_age_list))
+		goto insert_back;
+
+	cur_node = qdf_list_last_entry(&scan_db->scan_age_list,
+				       struct scan_cache_node, age_node);
+	if (!qdf_system_time_after(cur_node->entry->scan_entry_time,
+				   entry_time))
+		goto insert_back;
+
+	qdf_list_for_each(&scan_db->scan_age_list, cur_node, age_node) {
+		if (qdf_system_time_after(cur_node->entry->scan_entry_time,
+					  entry_time)) {
+			qdf_list_insert_before(&scan_db->scan_age_list,
+					       &scan_node->age_node,
+					       &cur_node->age_node);
+			return;
+		}
+	}
+
+insert_back:
+	qdf_list_insert_back(&scan_db->scan_age_list, &scan_node->age_node);
+}
+
 /**
  * scm_add_scan_node() - API to add scan node
  * @scan_db: data base
@@ -423,6 +479,7 @@ static void scm_add_scan_node(struct scan_dbs *scan_db,
 		qdf_list_insert_before(&scan_db->scan_hash_tbl[hash_idx],
 				       &scan_node->node, &dup_node->node);
 
+	scm_add_scan_node_to_age_list(scan_db, scan_node);
 	scan_db->num_entries++;
 }
 
@@ -508,29 +565,6 @@ scm_get_next_node(struct scan_dbs *scan_db,
 	return next_node;
 }
 
-/**
- * scm_check_and_age_out() - check and age out the old entries
- * @scan_db: scan db
- * @node: node to check for age out
- * @scan_aging_time: scan cache aging time
- *
- * Return: void
- */
-static void scm_check_and_age_out(struct scan_dbs *scan_db,
-	struct scan_cache_node *node,
-	qdf_time_t scan_aging_time)
-{
-	if (util_scan_entry_age(node->entry) >=
-	   scan_aging_time) {
-		scm_debug("Aging out BSSID: "QDF_MAC_ADDR_FMT" with age %lu ms",
-			  QDF_MAC_ADDR_REF(node->entry->bssid.bytes),
-			  util_scan_entry_age(node->entry));
-		qdf_spin_lock_bh(&scan_db->scan_db_lock);
-		scm_scan_entry_del(scan_db, node);
-		qdf_spin_unlock_bh(&scan_db->scan_db_lock);
-	}
-}
-
 static bool scm_bss_is_connected(struct scan_cache_entry *entry)
 {
 	if (entry->mlme_info.assoc_state == SCAN_ENTRY_CON_STATE_ASSOC)
@@ -542,26 +576,19 @@ static bool scm_bss_is_connected(struct scan_cache_entry *entry)
  * scm_get_conn_node() - Get the scan cache entry node of the connected BSS
  * @scan_db: scan DB pointer
  *
+ * Call must be protected by scan_db->scan_db_lock, no reference is taken on
+ * the returned node.
+ *
  * Return: scan cache entry node of connected BSS if exists, NULL otherwise
  */
 static
 struct scan_cache_node *scm_get_conn_node(struct scan_dbs *scan_db)
 {
-	int i;
-	struct scan_cache_node *cur_node = NULL;
-	struct scan_cache_node *next_node = NULL;
+	struct scan_cache_node *cur_node;
 
-	for (i = 0 ; i < SCAN_HASH_SIZE; i++) {
-		cur_node = scm_get_next_node(scan_db,
-			&scan_db->scan_hash_tbl[i], NULL);
-		while (cur_node) {
-			if (scm_bss_is_connected(cur_node->entry))
-				return cur_node;
-			next_node = scm_get_next_node(scan_db,
-				&scan_db->scan_hash_tbl[i], cur_node);
-			cur_node = next_node;
-			next_node = NULL;
-		}
+	qdf_list_for_each(&scan_db->scan_age_list, cur_node, age_node) {
+		if (scm_bss_is_connected(cur_node->entry))
+			return cur_node;
 	}
 
 	return NULL;
@@ -583,11 +610,11 @@ scm_bss_is_nontx_of_conn_bss(struct scan_cache_node *conn_node,
 void scm_age_out_entries(struct wlan_objmgr_psoc *psoc,
 	struct scan_dbs *scan_db)
 {
-	int i;
-	struct scan_cache_node *cur_node = NULL;
-	struct scan_cache_node *next_node = NULL;
+	struct scan_cache_node *cur_node;
+	struct scan_cache_node *next_node;
 	struct scan_cache_node *conn_node = NULL;
 	struct scan_default_params *def_param;
+	bool conn_node_found = false;
 
 	def_param = wlan_scan_psoc_get_def_params(psoc);
 	if (!def_param) {
@@ -595,84 +622,63 @@ void scm_age_out_entries(struct wlan_objmgr_psoc *psoc,
 		return;
 	}
 
-	conn_node = scm_get_conn_node(scan_db);
-	for (i = 0 ; i < SCAN_HASH_SIZE; i++) {
-		cur_node = scm_get_next_node(scan_db,
-			&scan_db->scan_hash_tbl[i], NULL);
-		while (cur_node) {
-			if (!conn_node /* if there is no connected node */ ||
-			    /* OR cur_node is not part of the MBSSID of the
-			     * connected node
-			     */
-			    (!scm_bss_is_connected(cur_node->entry) &&
-			     !scm_bss_is_nontx_of_conn_bss(conn_node,
-							  cur_node))) {
-				scm_check_and_age_out(scan_db, cur_node,
-					def_param->scan_cache_aging_time);
-			}
-			next_node = scm_get_next_node(scan_db,
-				&scan_db->scan_hash_tbl[i], cur_node);
-			cur_node = next_node;
-			next_node = NULL;
+	/*
+	 * The age list is sorted by scan_entry_time, so the walk stops at the
+	 * first entry which is still fresh and only expired entries, plus the
+	 * connected ones that are kept, are visited.
+	 */
+	qdf_spin_lock_bh(&scan_db->scan_db_lock);
+	qdf_list_for_each_del(&scan_db->scan_age_list, cur_node, next_node,
+			      age_node) {
+		if (util_scan_entry_age(cur_node->entry) <
+		    def_param->scan_cache_aging_time)
+			break;
+
+		if (!conn_node_found) {
+			conn_node = scm_get_conn_node(scan_db);
+			conn_node_found = true;
 		}
-	}
 
-	if (conn_node)
-		scm_scan_entry_put_ref(scan_db, conn_node, true);
+		/*
+		 * Do not age out the connected node or the MBSSID members of
+		 * the connected node
+		 */
+		if (conn_node &&
+		    (scm_bss_is_connected(cur_node->entry) ||
+		     scm_bss_is_nontx_of_conn_bss(conn_node, cur_node)))
+			continue;
+
+		scm_debug("Aging out BSSID: "QDF_MAC_ADDR_FMT" with age %lu ms",
+			  QDF_MAC_ADDR_REF(cur_node->entry->bssid.bytes),
+			  util_scan_entry_age(cur_node->entry));
+		scm_scan_entry_del(scan_db, cur_node);
+	}
+	qdf_spin_unlock_bh(&scan_db->scan_db_lock);
 }
 
 /**
- * scm_flush_oldest_entry() - Iterate over scan db and flust out the
- *  oldest entry
+ * scm_flush_oldest_entry() - flush out the oldest entry of the scan db
  * @scan_db: scan db from which oldest entry needs to be flushed
  *
+ * The oldest active entry is always at the head of the age list.
+ *
  * Return: QDF_STATUS
  */
 static QDF_STATUS scm_flush_oldest_entry(struct scan_dbs *scan_db)
 {
-	int i;
-	struct scan_cache_node *oldest_node = NULL;
-	struct scan_cache_node *cur_node;
-
-	for (i = 0 ; i < SCAN_HASH_SIZE; i++) {
-		/* Get the first valid node for the hash */
-		cur_node = scm_get_next_node(scan_db,
-					     &scan_db->scan_hash_tbl[i],
-					     NULL);
-		 /* Iterate scan db and flush out oldest node
-		  * take ref_cnt for oldest_node
-		  */
-
-		while (cur_node) {
-			if (!oldest_node ||
-			   (util_scan_entry_age(oldest_node->entry) <
-			    util_scan_entry_age(cur_node->entry))) {
-				if (oldest_node)
-					scm_scan_entry_put_ref(scan_db,
-							       oldest_node,
-							       true);
-				qdf_spin_lock_bh(&scan_db->scan_db_lock);
-				oldest_node = cur_node;
-				scm_scan_entry_get_ref(oldest_node);
-				qdf_spin_unlock_bh(&scan_db->scan_db_lock);
-			}
-
-			cur_node = scm_get_next_node(scan_db,
-					&scan_db->scan_hash_tbl[i],
-					cur_node);
-		};
-	}
+	struct scan_cache_node *oldest_node;
 
+	qdf_spin_lock_bh(&scan_db->scan_db_lock);
+	oldest_node = qdf_list_first_entry_or_null(&scan_db->scan_age_list,
+						   struct scan_cache_node,
+						   age_node);
 	if (oldest_node) {
 		scm_debug("Flush oldest BSSID: "QDF_MAC_ADDR_FMT" with age %lu ms",
 			  QDF_MAC_ADDR_REF(oldest_node->entry->bssid.bytes),
 			  util_scan_entry_age(oldest_node->entry));
-		/* Release ref_cnt taken for oldest_node and delete it */
-		qdf_spin_lock_bh(&scan_db->scan_db_lock);
 		scm_scan_entry_del(scan_db, oldest_node);
-		scm_scan_entry_put_ref(scan_db, oldest_node, false);
-		qdf_spin_unlock_bh(&scan_db->scan_db_lock);
 	}
+	qdf_spin_unlock_bh(&scan_db->scan_db_lock);
 
 	return QDF_STATUS_SUCCESS;
 }
@@ -1479,6 +1485,8 @@ static void scm_get_results(struct wlan_objmgr_psoc *psoc,
 	int i, count;
 	struct scan_cache_node *cur_node;
 	struct scan_cache_node *next_node = NULL;
+	uint32_t num_results;
+	uint32_t shared_frame_bytes = 0;
 
 	for (i = 0 ; i < SCAN_HASH_SIZE; i++) {
 		cur_node = scm_get_next_node(scan_db,
@@ -1487,13 +1495,25 @@ static void scm_get_results(struct wlan_objmgr_psoc *psoc,
 		if (!count)
 			continue;
 		while (cur_node) {
+			num_results = qdf_list_size(scan_list);
 			scm_scan_apply_filter_get_entry(psoc,
 				cur_node->entry, filter, scan_list);
+			if (qdf_list_size(scan_list) != num_results)
+				shared_frame_bytes +=
+					cur_node->entry->raw_frame.len;
 			next_node = scm_get_next_node(scan_db,
 				&scan_db->scan_hash_tbl[i], cur_node);
 			cur_node = next_node;
 		}
 	}
+
+	/*
+	 * Each result costs a node and an entry allocation, the frame and
+	 * its IEs are shared with the scan db entry instead of copied.
+	 */
+	scm_debug("results %u of %u, frame bytes shared %u",
+		  qdf_list_size(scan_list), scan_db->num_entries,
+		  shared_frame_bytes);
 }
 
 QDF_STATUS scm_purge_scan_results(qdf_list_t *scan_list)
@@ -1890,6 +1910,7 @@ QDF_STATUS scm_db_init(struct wlan_objmgr_psoc *psoc)
 		for (j = 0; j < SCAN_HASH_SIZE; j++)
 			qdf_list_create(&scan_db->scan_hash_tbl[j],
 				MAX_SCAN_CACHE_SIZE);
+		qdf_list_create(&scan_db->scan_age_list, MAX_SCAN_CACHE_SIZE);
 		scm_reset_scan_chan_info(psoc, i);
 	}
 	return QDF_STATUS_SUCCESS;
@@ -1916,6 +1937,7 @@ QDF_STATUS scm_db_deinit(struct wlan_objmgr_psoc *psoc)
 		scm_flush_scan_entries(psoc, scan_db, NULL, i);
 		for (j = 0; j < SCAN_HASH_SIZE; j++)
 			qdf_list_destroy(&scan_db->scan_hash_tbl[j]);
+		qdf_list_destroy(&scan_db->scan_age_list);
 		qdf_spinlock_destroy(&scan_db->scan_db_lock);
 	}
 
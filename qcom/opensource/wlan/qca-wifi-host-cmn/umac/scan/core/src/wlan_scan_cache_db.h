@@ -24,15 +24,19 @@
 #ifndef _WLAN_SCAN_CACHE_DB_H_
 #define _WLAN_SCAN_CACHE_DB_H_
 
+#include <qdf_util.h>
 #include <scheduler_api.h>
 #include <wlan_objmgr_psoc_obj.h>
 #include <wlan_objmgr_pdev_obj.h>
 #include <wlan_objmgr_vdev_obj.h>
 #include <wlan_scan_public_structs.h>
 
-#define SCAN_HASH_SIZE 64
+/* size of the BSSID hash, as a power of 2 */
+#define SCAN_HASH_BITS 6
+#define SCAN_HASH_SIZE (1 << SCAN_HASH_BITS)
+
 #define SCAN_GET_HASH(addr) \
-	(((const uint8_t *)(addr))[QDF_MAC_ADDR_SIZE - 1] % SCAN_HASH_SIZE)
+	qdf_mac_addr_hash((const uint8_t *)(addr), SCAN_HASH_BITS)
 
 #define ADJACENT_CHANNEL_RSSI_THRESHOLD -80
 #define ADJACENT_CHANNEL_RSSI_DIFF_THRESHOLD 40
@@ -40,13 +44,17 @@
 /**
  * struct scan_dbs - scan cache data base definition
  * @num_entries: number of scan entries
- * @scan_db_lock: lock for @scan_hash_tbl
+ * @scan_db_lock: lock for @scan_hash_tbl and @scan_age_list
  * @scan_hash_tbl: link list of bssid hashed scan cache entries for a pdev
+ * @scan_age_list: active scan cache entries ordered by scan_entry_time,
+ *  oldest at the head. Used to age out and evict entries without walking
+ *  the whole hash table.
  */
 struct scan_dbs {
 	uint32_t num_entries;
 	qdf_spinlock_t scan_db_lock;
 	qdf_list_t scan_hash_tbl[SCAN_HASH_SIZE];
+	qdf_list_t scan_age_list;
 };
 
 /**
@@ -287,7 +287,8 @@ struct ie_list {
 	uint8_t *qcn;
 
 /*
- * For any new IEs in this structure, add handling in
+ * All IE pointers in this structure point into the raw frame of the scan
+ * entry, which is shared as is by copies of the entry, see
  * util_scan_copy_beacon_data API.
  */
 };
@@ -334,12 +335,14 @@ struct bss_info {
 /**
  * struct scan_cache_node - Scan cache entry node
  * @node: node pointers
+ * @age_node: node pointers in the age ordered list of the scan db
  * @ref_cnt: ref count if in use
  * @cookie: cookie to check if entry is logically active
  * @entry: scan entry pointer
  */
 struct scan_cache_node {
 	qdf_list_node_t node;
+	qdf_list_node_t age_node;
 	qdf_atomic_t ref_cnt;
 	uint32_t cookie;
 	struct scan_cache_entry *entry;
@@ -650,6 +650,75 @@ util_scan_entry_copy_ie_data(struct scan_cache_entry *scan_entry,
 	return QDF_STATUS_E_NOMEM;
 }
 
+/**
+ * struct scan_raw_frame_buf - refcounted beacon/probe frame buffer
+ * @ref_cnt: number of scan cache entries sharing the frame
+ * @len: length of @data
+ * @data: received frame, pointed to by scan_cache_entry->raw_frame.ptr
+ *
+ * The frame is never modified once the scan entry is parsed. A beacon or
+ * probe response updating the BSS creates a new scan entry with a new frame
+ * buffer, so copies of a scan entry returned in scan results can share the
+ * frame, and the IE pointers into it, instead of duplicating it.
+ */
+struct scan_raw_frame_buf {
+	qdf_atomic_t ref_cnt;
+	uint32_t len;
+	uint8_t data[];
+};
+
+/**
+ * util_scan_alloc_raw_frame() - allocate a raw frame buffer for scan entry
+ * @len: frame length
+ *
+ * Return: frame buffer with one reference held, NULL on failure
+ */
+static inline uint8_t *util_scan_alloc_raw_frame(uint32_t len)
+{
+	struct scan_raw_frame_buf *buf;
+
+	buf = qdf_mem_malloc_atomic(sizeof(*buf) + len);
+	if (!buf)
+		return NULL;
+
+	qdf_atomic_init(&buf->ref_cnt);
+	qdf_atomic_inc(&buf->ref_cnt);
+	buf->len = len;
+
+	return buf->data;
+}
+
+/**
+ * util_scan_get_raw_frame() - take a reference on a raw frame buffer
+ * @frame: frame allocated by util_scan_alloc_raw_frame()
+ *
+ * Return: void
+ */
+static inline void util_scan_get_raw_frame(uint8_t *frame)
+{
+	struct scan_raw_frame_buf *buf;
+
+	buf = qdf_container_of(frame, struct scan_raw_frame_buf, data);
+	qdf_atomic_inc(&buf->ref_cnt);
+}
+
+/**
+ * util_scan_free_raw_frame() - release a reference on a raw frame buffer
+ * @frame: frame allocated by util_scan_alloc_raw_frame()
+ *
+ * The buffer is freed once the last scan entry sharing it is freed.
+ *
+ * Return: void
+ */
+static inline void util_scan_free_raw_frame(uint8_t *frame)
+{
+	struct scan_raw_frame_buf *buf;
+
+	buf = qdf_container_of(frame, struct scan_raw_frame_buf, data);
+	if (qdf_atomic_dec_and_test(&buf->ref_cnt))
+		qdf_mem_free(buf);
+}
+
 /**
  * util_scan_free_cache_entry() - function to free scan
  * cache entry
@@ -667,22 +736,20 @@ util_scan_free_cache_entry(struct scan_cache_entry *scan_entry)
 	if (scan_entry->alt_wcn_ie.ptr)
 		qdf_mem_free(scan_entry->alt_wcn_ie.ptr);
 	if (scan_entry->raw_frame.ptr)
-		qdf_mem_free(scan_entry->raw_frame.ptr);
+		util_scan_free_raw_frame(scan_entry->raw_frame.ptr);
 
 	qdf_mem_free(scan_entry);
 }
 
-#define conv_ptr(_address, _base1, _base2) \
-	((_address) ? (((u_int8_t *) (_address) - \
-	(u_int8_t *) (_base1)) + (u_int8_t *) (_base2)) : NULL)
-
 /**
- * util_scan_copy_beacon_data() - copy beacon and update ie ptrs
+ * util_scan_copy_beacon_data() - share beacon and ie ptrs with a copy of
  * cache entry
  * @new_entry: new scan entry
  * @scan_entry: entry from where data is copied
  *
- * API, function to copy beacon and update ie ptrs
+ * API, function to share the beacon of @scan_entry with @new_entry. The
+ * frame is immutable, so the ie ptrs of @scan_entry stay valid for
+ * @new_entry as well.
  *
  * Return: QDF_STATUS
  */
@@ -690,98 +757,14 @@ static inline QDF_STATUS
 util_scan_copy_beacon_data(struct scan_cache_entry *new_entry,
 	struct scan_cache_entry *scan_entry)
 {
-	u_int8_t *new_ptr, *old_ptr;
-	struct ie_list *ie_lst;
-	uint8_t i;
+	if (!scan_entry->raw_frame.ptr)
+		return QDF_STATUS_SUCCESS;
 
-	new_entry->raw_frame.ptr =
-		qdf_mem_malloc_atomic(scan_entry->raw_frame.len);
-	if (!new_entry->raw_frame.ptr)
-		return QDF_STATUS_E_NOMEM;
-
-	qdf_mem_copy(new_entry->raw_frame.ptr,
-		scan_entry->raw_frame.ptr,
-		scan_entry->raw_frame.len);
+	util_scan_get_raw_frame(scan_entry->raw_frame.ptr);
+	new_entry->raw_frame.ptr = scan_entry->raw_frame.ptr;
 	new_entry->raw_frame.len = scan_entry->raw_frame.len;
-	new_ptr = new_entry->raw_frame.ptr;
-	old_ptr = scan_entry->raw_frame.ptr;
-
 	new_entry->ie_list = scan_entry->ie_list;
 
-	ie_lst = &new_entry->ie_list;
-
-	/* New info_element needs also be added in ieee80211_parse_beacon */
-	ie_lst->tim = conv_ptr(ie_lst->tim, old_ptr, new_ptr);
-	ie_lst->country = conv_ptr(ie_lst->country, old_ptr, new_ptr);
-	ie_lst->ssid = conv_ptr(ie_lst->ssid, old_ptr, new_ptr);
-	ie_lst->rates = conv_ptr(ie_lst->rates, old_ptr, new_ptr);
-	ie_lst->xrates = conv_ptr(ie_lst->xrates, old_ptr, new_ptr);
-	ie_lst->ds_param = conv_ptr(ie_lst->ds_param, old_ptr, new_ptr);
-	ie_lst->csa = conv_ptr(ie_lst->csa, old_ptr, new_ptr);
-	ie_lst->xcsa = conv_ptr(ie_lst->xcsa, old_ptr, new_ptr);
-	ie_lst->mcst = conv_ptr(ie_lst->mcst, old_ptr, new_ptr);
-	ie_lst->secchanoff = conv_ptr(ie_lst->secchanoff, old_ptr, new_ptr);
-	ie_lst->wpa = conv_ptr(ie_lst->wpa, old_ptr, new_ptr);
-	ie_lst->wcn = conv_ptr(ie_lst->wcn, old_ptr, new_ptr);
-	ie_lst->rsn = conv_ptr(ie_lst->rsn, old_ptr, new_ptr);
-	ie_lst->wps = conv_ptr(ie_lst->wps, old_ptr, new_ptr);
-	ie_lst->wmeinfo = conv_ptr(ie_lst->wmeinfo, old_ptr, new_ptr);
-	ie_lst->wmeparam = conv_ptr(ie_lst->wmeparam, old_ptr, new_ptr);
-	ie_lst->quiet = conv_ptr(ie_lst->quiet, old_ptr, new_ptr);
-	ie_lst->htcap = conv_ptr(ie_lst->htcap, old_ptr, new_ptr);
-	ie_lst->htinfo = conv_ptr(ie_lst->htinfo, old_ptr, new_ptr);
-	ie_lst->athcaps = conv_ptr(ie_lst->athcaps, old_ptr, new_ptr);
-	ie_lst->athextcaps = conv_ptr(ie_lst->athextcaps, old_ptr, new_ptr);
-	ie_lst->sfa = conv_ptr(ie_lst->sfa, old_ptr, new_ptr);
-	ie_lst->vendor = conv_ptr(ie_lst->vendor, old_ptr, new_ptr);
-	ie_lst->qbssload = conv_ptr(ie_lst->qbssload, old_ptr, new_ptr);
-	ie_lst->wapi = conv_ptr(ie_lst->wapi, old_ptr, new_ptr);
-	ie_lst->p2p = conv_ptr(ie_lst->p2p, old_ptr, new_ptr);
-	ie_lst->alt_wcn = conv_ptr(ie_lst->alt_wcn, old_ptr, new_ptr);
-	ie_lst->extcaps = conv_ptr(ie_lst->extcaps, old_ptr, new_ptr);
-	ie_lst->ibssdfs = conv_ptr(ie_lst->ibssdfs, old_ptr, new_ptr);
-	ie_lst->sonadv = conv_ptr(ie_lst->sonadv, old_ptr, new_ptr);
-	ie_lst->vhtcap = conv_ptr(ie_lst->vhtcap, old_ptr, new_ptr);
-	ie_lst->vhtop = conv_ptr(ie_lst->vhtop, old_ptr, new_ptr);
-	ie_lst->opmode = conv_ptr(ie_lst->opmode, old_ptr, new_ptr);
-	ie_lst->cswrp = conv_ptr(ie_lst->cswrp, old_ptr, new_ptr);
-	for (i = 0; i < WLAN_MAX_NUM_TPE_IE; i++)
-		ie_lst->tpe[i] = conv_ptr(ie_lst->tpe[i], old_ptr, new_ptr);
-	ie_lst->widebw = conv_ptr(ie_lst->widebw, old_ptr, new_ptr);
-	ie_lst->txpwrenvlp = conv_ptr(ie_lst->txpwrenvlp, old_ptr, new_ptr);
-	ie_lst->bwnss_map = conv_ptr(ie_lst->bwnss_map, old_ptr, new_ptr);
-	ie_lst->mdie = conv_ptr(ie_lst->mdie, old_ptr, new_ptr);
-	ie_lst->hecap = conv_ptr(ie_lst->hecap, old_ptr, new_ptr);
-	ie_lst->hecap_6g = conv_ptr(ie_lst->hecap_6g, old_ptr, new_ptr);
-	ie_lst->heop = conv_ptr(ie_lst->heop, old_ptr, new_ptr);
-	ie_lst->srp = conv_ptr(ie_lst->srp, old_ptr, new_ptr);
-	ie_lst->fils_indication = conv_ptr(ie_lst->fils_indication,
-					   old_ptr, new_ptr);
-	ie_lst->esp = conv_ptr(ie_lst->esp, old_ptr, new_ptr);
-	ie_lst->mbo_oce = conv_ptr(ie_lst->mbo_oce, old_ptr, new_ptr);
-	ie_lst->muedca = conv_ptr(ie_lst->muedca, old_ptr, new_ptr);
-	ie_lst->rnrie = conv_ptr(ie_lst->rnrie, old_ptr, new_ptr);
-	ie_lst->extender = conv_ptr(ie_lst->extender, old_ptr, new_ptr);
-	ie_lst->adaptive_11r = conv_ptr(ie_lst->adaptive_11r, old_ptr, new_ptr);
-	ie_lst->single_pmk = conv_ptr(ie_lst->single_pmk, old_ptr, new_ptr);
-	ie_lst->rsnxe = conv_ptr(ie_lst->rsnxe, old_ptr, new_ptr);
-#ifdef WLAN_FEATURE_11BE
-	/* This macro will be removed once 11be is enabled */
-	ie_lst->ehtcap = conv_ptr(ie_lst->ehtcap, old_ptr, new_ptr);
-	ie_lst->ehtop = conv_ptr(ie_lst->ehtop, old_ptr, new_ptr);
-	ie_lst->bw_ind =
-		conv_ptr(ie_lst->bw_ind, old_ptr, new_ptr);
-#endif
-#ifdef WLAN_FEATURE_11BE_MLO
-	ie_lst->multi_link_bv =
-			conv_ptr(ie_lst->multi_link_bv, old_ptr, new_ptr);
-	ie_lst->multi_link_rv =
-			conv_ptr(ie_lst->multi_link_rv, old_ptr, new_ptr);
-	for (i = 0; i < WLAN_MAX_T2LM_IE; i++)
-		ie_lst->t2lm[i] = conv_ptr(ie_lst->t2lm[i], old_ptr, new_ptr);
-#endif
-	ie_lst->qcn = conv_ptr(ie_lst->qcn, old_ptr, new_ptr);
-
 	return QDF_STATUS_SUCCESS;
 }
 
@@ -2478,8 +2478,7 @@ util_scan_gen_scan_entry(struct wlan_objmgr_pdev *pdev,
 		return QDF_STATUS_E_NOMEM;
 	}
 
-	scan_entry->raw_frame.ptr =
-			qdf_mem_malloc_atomic(frame_len);
+	scan_entry->raw_frame.ptr = util_scan_alloc_raw_frame(frame_len);
 	if (!scan_entry->raw_frame.ptr) {
 		scm_err("failed to allocate memory for frame");
 		qdf_mem_free(scan_entry);
@@ -2553,7 +2552,7 @@ util_scan_gen_scan_entry(struct wlan_objmgr_pdev *pdev,
 	status = util_scan_populate_bcn_ie_list(pdev, scan_entry, &chan_freq,
 						band_mask);
 	if (QDF_IS_STATUS_ERROR(status)) {
-		qdf_mem_free(scan_entry->raw_frame.ptr);
+		util_scan_free_raw_frame(scan_entry->raw_frame.ptr);
 		qdf_mem_free(scan_entry);
 		return QDF_STATUS_E_FAILURE;
 	}
@@ -2562,7 +2561,7 @@ util_scan_gen_scan_entry(struct wlan_objmgr_pdev *pdev,
 		scan_entry->ie_list.ssid;
 
 	if (ssid && (ssid->ssid_len > WLAN_SSID_MAX_LEN)) {
-		qdf_mem_free(scan_entry->raw_frame.ptr);
+		util_scan_free_raw_frame(scan_entry->raw_frame.ptr);
 		qdf_mem_free(scan_entry);
 		return QDF_STATUS_E_FAILURE;
 	}
@@ -2577,7 +2576,7 @@ util_scan_gen_scan_entry(struct wlan_objmgr_pdev *pdev,
 							      band_mask,
 							      recv_freq);
 		if (QDF_IS_STATUS_ERROR(status)) {
-			qdf_mem_free(scan_entry->raw_frame.ptr);
+			util_scan_free_raw_frame(scan_entry->raw_frame.ptr);
 			qdf_mem_free(scan_entry);
 			return QDF_STATUS_E_FAILURE;
 		}
@@ -2623,7 +2622,7 @@ util_scan_gen_scan_entry(struct wlan_objmgr_pdev *pdev,
 
 	scan_node = qdf_mem_malloc_atomic(sizeof(*scan_node));
 	if (!scan_node) {
-		qdf_mem_free(scan_entry->raw_frame.ptr);
+		util_scan_free_raw_frame(scan_entry->raw_frame.ptr);
 		qdf_mem_free(scan_entry);
 		scm_err("failed to allocate memory for scan_node");
 		return QDF_STATUS_E_FAILURE;
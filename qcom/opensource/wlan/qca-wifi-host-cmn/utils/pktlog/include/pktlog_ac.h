@@ -126,6 +126,15 @@ struct ath_pktlog_info_lnx {
 	struct ctl_table sysctls[PKTLOG_SYSCTL_SIZE];
 	struct proc_dir_entry *proc_entry;
 	struct ctl_table_header *sysctl_header;
+#ifdef PKTLOG_MMAP_STREAM
+	/* mmap stream: the mapping and the driver's own copy of prod/size */
+	struct proc_dir_entry *stream_entry;
+	qdf_spinlock_t stream_lock;
+	struct ath_pktlog_stream_hdr *stream;
+	uint32_t stream_size;
+	uint64_t stream_prod;
+	bool stream_active;
+#endif
 };
 
 #define PL_INFO_LNX(_pl_info)   ((struct ath_pktlog_info_lnx *)(_pl_info))
@@ -127,5 +127,52 @@ pktlog_arg_get_specific_data(struct ath_pktlog_arg *plarg)
 	return 0;
 }
 #endif /* PKTLOG_HAS_SPECIFIC_DATA */
+
+#ifdef PKTLOG_MMAP_STREAM
+/**
+ * pktlog_stream_put() - append a complete record to the mmap stream
+ * @pl_info: pktlog info
+ * @pl_hdr: pktlog header of the record
+ * @data: record payload of @pl_hdr->size bytes
+ *
+ * Never waits for the reader: the record is dropped and accounted in the
+ * stream header when the reader has not made room for it.
+ *
+ * Return: None
+ */
+void pktlog_stream_put(struct ath_pktlog_info *pl_info,
+		       struct ath_pktlog_hdr *pl_hdr, void *data);
+
+#ifdef WLAN_PKTLOG_STREAM_TEST
+/**
+ * pktlog_stream_test_start() - start the mmap stream on a test buffer
+ * @pl_info: pktlog info without a proc entry
+ * @shdr: zeroed buffer of PAGE_SIZE + @size bytes
+ * @size: size of the record area, a power of two
+ *
+ * Sets the stream up as pktlog_stream_open() does, minus the vmalloc_user()
+ * area and the proc entry. Only for the pktlog_stream unit test.
+ *
+ * Return: None
+ */
+void pktlog_stream_test_start(struct ath_pktlog_info *pl_info,
+			      struct ath_pktlog_stream_hdr *shdr,
+			      uint32_t size);
+
+/**
+ * pktlog_stream_test_stop() - detach the test buffer from the mmap stream
+ * @pl_info: pktlog info passed to pktlog_stream_test_start()
+ *
+ * Return: None
+ */
+void pktlog_stream_test_stop(struct ath_pktlog_info *pl_info);
+#endif /* WLAN_PKTLOG_STREAM_TEST */
+#else
+static inline void
+pktlog_stream_put(struct ath_pktlog_info *pl_info,
+		  struct ath_pktlog_hdr *pl_hdr, void *data)
+{
+}
+#endif /* PKTLOG_MMAP_STREAM */
 #endif /* REMOVE_PKT_LOG */
 #endif
@@ -57,6 +57,7 @@
 
 /* Permissions for creating proc entries */
 #define PKTLOG_PROC_PERM        0444
+#define PKTLOG_STREAM_PROC_PERM 0600
 #define PKTLOG_PROCSYS_DIR_PERM 0555
 #define PKTLOG_PROCSYS_PERM     0644
 
@@ -100,6 +101,305 @@ static struct file_operations pktlog_fops = {
 };
 #endif
 
+#ifdef PKTLOG_MMAP_STREAM
+#define PKTLOG_STREAM_PROC_NAME WLANDEV_BASENAME "_stream"
+
+static int pktlog_stream_open(struct inode *i, struct file *f);
+static int pktlog_stream_release(struct inode *i, struct file *f);
+static int pktlog_stream_mmap(struct file *f, struct vm_area_struct *vma);
+
+#if (LINUX_VERSION_CODE >= KERNEL_VERSION(5, 6, 0))
+static const struct proc_ops pktlog_stream_fops = {
+	.proc_open = pktlog_stream_open,
+	.proc_release = pktlog_stream_release,
+	.proc_mmap = pktlog_stream_mmap,
+};
+#else
+static struct file_operations pktlog_stream_fops = {
+	open:  pktlog_stream_open,
+	release:pktlog_stream_release,
+	mmap : pktlog_stream_mmap,
+};
+#endif
+
+void pktlog_stream_put(struct ath_pktlog_info *pl_info,
+		       struct ath_pktlog_hdr *pl_hdr, void *data)
+{
+	struct ath_pktlog_info_lnx *pl_info_lnx;
+	struct ath_pktlog_stream_hdr *shdr;
+	struct ath_pktlog_stream_rec *rec;
+	char *area;
+	uint32_t need, off, pad, size;
+	uint64_t prod, cons;
+
+	if (!pl_info)
+		return;
+
+	pl_info_lnx = PL_INFO_LNX(pl_info);
+	if (!READ_ONCE(pl_info_lnx->stream_active))
+		return;
+
+	need = ALIGN(sizeof(*rec) + sizeof(*pl_hdr) + pl_hdr->size,
+		     PKTLOG_STREAM_ALIGN);
+
+	/* only serializes producers, the reader never takes this lock */
+	qdf_spin_lock_bh(&pl_info_lnx->stream_lock);
+	shdr = pl_info_lnx->stream;
+	if (!shdr)
+		goto unlock;
+
+	/*
+	 * Index with the driver's own prod and size only; the control page
+	 * is writable by the reader, so a bogus cons can at worst make
+	 * records get dropped.
+	 */
+	size = pl_info_lnx->stream_size;
+	prod = pl_info_lnx->stream_prod;
+	cons = READ_ONCE(shdr->cons);
+	/* do not touch the area before cons says the reader left it */
+	qdf_mb();
+
+	off = prod & (size - 1);
+	pad = (size - off < need) ? size - off : 0;
+	if (need > size / 2 || prod - cons > size ||
+	    prod - cons + pad + need > size) {
+		shdr->dropped_records++;
+		shdr->dropped_bytes += need;
+		goto unlock;
+	}
+
+	area = (char *)shdr + PAGE_SIZE;
+	if (pad) {
+		rec = (struct ath_pktlog_stream_rec *)(area + off);
+		rec->len = pad;
+		rec->type = PKTLOG_STREAM_REC_PAD;
+		prod += pad;
+		off = 0;
+	}
+
+	rec = (struct ath_pktlog_stream_rec *)(area + off);
+	rec->len = need;
+	rec->type = PKTLOG_STREAM_REC_DATA;
+	qdf_mem_copy(rec + 1, pl_hdr, sizeof(*pl_hdr));
+	qdf_mem_copy((char *)(rec + 1) + sizeof(*pl_hdr), data, pl_hdr->size);
+	prod += need;
+
+	pl_info_lnx->stream_prod = prod;
+	/* publish the records before the new prod */
+	qdf_wmb();
+	WRITE_ONCE(shdr->prod, prod);
+
+unlock:
+	qdf_spin_unlock_bh(&pl_info_lnx->stream_lock);
+}
+
+/**
+ * pktlog_stream_reset() - restart the mmap stream from an empty area
+ * @pl_info_lnx: Linux pktlog info
+ * @shdr: control page of the stream
+ * @size: size of the record area in bytes
+ *
+ * Return: None
+ */
+static void pktlog_stream_reset(struct ath_pktlog_info_lnx *pl_info_lnx,
+				struct ath_pktlog_stream_hdr *shdr,
+				uint32_t size)
+{
+	qdf_spin_lock_bh(&pl_info_lnx->stream_lock);
+	shdr->magic_num = PKTLOG_STREAM_MAGIC_NUM;
+	shdr->version = PKTLOG_STREAM_VER;
+	shdr->data_offset = PAGE_SIZE;
+	shdr->data_size = size;
+	shdr->prod = 0;
+	shdr->cons = 0;
+	shdr->dropped_records = 0;
+	shdr->dropped_bytes = 0;
+	pl_info_lnx->stream = shdr;
+	pl_info_lnx->stream_size = size;
+	pl_info_lnx->stream_prod = 0;
+	qdf_spin_unlock_bh(&pl_info_lnx->stream_lock);
+}
+
+static int __pktlog_stream_open(struct inode *i, struct file *f)
+{
+	struct ath_pktlog_info *pl_info = pde_data(i);
+	struct ath_pktlog_info_lnx *pl_info_lnx;
+	struct ath_pktlog_stream_hdr *shdr;
+	uint32_t size;
+
+	if (!pl_info)
+		return -EINVAL;
+
+	pl_info_lnx = PL_INFO_LNX(pl_info);
+
+	mutex_lock(&pl_info->pktlog_mutex);
+	if (pl_info_lnx->stream_active) {
+		mutex_unlock(&pl_info->pktlog_mutex);
+		return -EBUSY;
+	}
+
+	/*
+	 * The area is sized after the pktlog buffer on first open and kept
+	 * until detach, as a previous reader may still have it mapped.
+	 */
+	shdr = pl_info_lnx->stream;
+	if (!shdr) {
+		size = qdf_get_pwr2(QDF_MAX(pl_info->buf_size,
+					    (int32_t)PAGE_SIZE));
+		shdr = vmalloc_user(PAGE_SIZE + size);
+		if (!shdr) {
+			mutex_unlock(&pl_info->pktlog_mutex);
+			return -ENOMEM;
+		}
+	} else {
+		size = pl_info_lnx->stream_size;
+	}
+
+	pktlog_stream_reset(pl_info_lnx, shdr, size);
+	WRITE_ONCE(pl_info_lnx->stream_active, true);
+	PKTLOG_MOD_INC_USE_COUNT;
+	mutex_unlock(&pl_info->pktlog_mutex);
+
+	return 0;
+}
+
+static int pktlog_stream_open(struct inode *i, struct file *f)
+{
+	struct qdf_op_sync *op_sync;
+	int errno;
+
+	errno = qdf_op_protect(&op_sync);
+	if (errno)
+		return errno;
+
+	errno = __pktlog_stream_open(i, f);
+
+	qdf_op_unprotect(op_sync);
+
+	return errno;
+}
+
+static int pktlog_stream_release(struct inode *i, struct file *f)
+{
+	struct ath_pktlog_info *pl_info = pde_data(i);
+
+	if (!pl_info)
+		return -EINVAL;
+
+	WRITE_ONCE(PL_INFO_LNX(pl_info)->stream_active, false);
+	PKTLOG_MOD_DEC_USE_COUNT;
+
+	return 0;
+}
+
+static int pktlog_stream_mmap(struct file *f, struct vm_area_struct *vma)
+{
+	struct ath_pktlog_info *pl_info = pde_data(file_inode(f));
+	struct ath_pktlog_info_lnx *pl_info_lnx;
+	unsigned long len = vma->vm_end - vma->vm_start;
+
+	if (!pl_info)
+		return -EINVAL;
+
+	/*
+	 * The area is set up by open and only freed by detach, after the
+	 * proc entry is gone, so it cannot change under a file operation.
+	 */
+	pl_info_lnx = PL_INFO_LNX(pl_info);
+	if (!pl_info_lnx->stream || vma->vm_pgoff ||
+	    len > PAGE_SIZE + pl_info_lnx->stream_size)
+		return -EINVAL;
+
+	return remap_vmalloc_range(vma, pl_info_lnx->stream, 0);
+}
+
+/**
+ * pktlog_stream_attach() - create the proc entry of the mmap stream
+ * @pl_info_lnx: Linux pktlog info
+ *
+ * Return: 0 on success, -EINVAL otherwise
+ */
+static int pktlog_stream_attach(struct ath_pktlog_info_lnx *pl_info_lnx)
+{
+	qdf_spinlock_create(&pl_info_lnx->stream_lock);
+	pl_info_lnx->stream = NULL;
+	pl_info_lnx->stream_size = 0;
+	pl_info_lnx->stream_prod = 0;
+	pl_info_lnx->stream_active = false;
+
+	pl_info_lnx->stream_entry =
+		proc_create_data(PKTLOG_STREAM_PROC_NAME,
+				 PKTLOG_STREAM_PROC_PERM, g_pktlog_pde,
+				 &pktlog_stream_fops, &pl_info_lnx->info);
+	if (!pl_info_lnx->stream_entry) {
+		qdf_spinlock_destroy(&pl_info_lnx->stream_lock);
+		qdf_info(PKTLOG_TAG "create_proc_entry failed for %s",
+			 PKTLOG_STREAM_PROC_NAME);
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+/**
+ * pktlog_stream_detach() - remove the mmap stream
+ * @pl_info_lnx: Linux pktlog info
+ *
+ * Return: None
+ */
+static void pktlog_stream_detach(struct ath_pktlog_info_lnx *pl_info_lnx)
+{
+	struct ath_pktlog_stream_hdr *shdr;
+
+	remove_proc_entry(PKTLOG_STREAM_PROC_NAME, g_pktlog_pde);
+
+	qdf_spin_lock_bh(&pl_info_lnx->stream_lock);
+	pl_info_lnx->stream_active = false;
+	shdr = pl_info_lnx->stream;
+	pl_info_lnx->stream = NULL;
+	qdf_spin_unlock_bh(&pl_info_lnx->stream_lock);
+
+	/* pages still mapped by a reader are kept until it unmaps them */
+	vfree(shdr);
+	qdf_spinlock_destroy(&pl_info_lnx->stream_lock);
+}
+
+#ifdef WLAN_PKTLOG_STREAM_TEST
+void pktlog_stream_test_start(struct ath_pktlog_info *pl_info,
+			      struct ath_pktlog_stream_hdr *shdr,
+			      uint32_t size)
+{
+	struct ath_pktlog_info_lnx *pl_info_lnx = PL_INFO_LNX(pl_info);
+
+	qdf_spinlock_create(&pl_info_lnx->stream_lock);
+	pktlog_stream_reset(pl_info_lnx, shdr, size);
+	WRITE_ONCE(pl_info_lnx->stream_active, true);
+}
+
+void pktlog_stream_test_stop(struct ath_pktlog_info *pl_info)
+{
+	struct ath_pktlog_info_lnx *pl_info_lnx = PL_INFO_LNX(pl_info);
+
+	qdf_spin_lock_bh(&pl_info_lnx->stream_lock);
+	pl_info_lnx->stream_active = false;
+	pl_info_lnx->stream = NULL;
+	qdf_spin_unlock_bh(&pl_info_lnx->stream_lock);
+	qdf_spinlock_destroy(&pl_info_lnx->stream_lock);
+}
+#endif /* WLAN_PKTLOG_STREAM_TEST */
+#else
+static inline int
+pktlog_stream_attach(struct ath_pktlog_info_lnx *pl_info_lnx)
+{
+	return 0;
+}
+
+static inline void
+pktlog_stream_detach(struct ath_pktlog_info_lnx *pl_info_lnx)
+{
+}
+#endif /* PKTLOG_MMAP_STREAM */
+
 void pktlog_disable_adapter_logging(struct hif_opaque_softc *scn)
 {
 	struct pktlog_dev_t *pl_dev = get_pktlog_handle();
@@ -475,14 +775,20 @@ static int pktlog_attach(struct hif_opaque_softc *scn)
 
 	pl_info_lnx->proc_entry = proc_entry;
 
+	if (pktlog_stream_attach(pl_info_lnx))
+		goto attach_fail2;
+
 	if (pktlog_sysctl_register(scn)) {
 		qdf_nofl_info(PKTLOG_TAG "sysctl register failed for %s",
 			      proc_name);
-		goto attach_fail2;
+		goto attach_fail3;
 	}
 
 	return 0;
 
+attach_fail3:
+	pktlog_stream_detach(pl_info_lnx);
+
 attach_fail2:
 	remove_proc_entry(proc_name, g_pktlog_pde);
 
@@ -532,6 +838,7 @@ static void pktlog_detach(struct hif_opaque_softc *scn)
 	}
 	mutex_lock(&pl_info->pktlog_mutex);
 	remove_proc_entry(WLANDEV_BASENAME, g_pktlog_pde);
+	pktlog_stream_detach(PL_INFO_LNX(pl_info));
 	pktlog_sysctl_unregister(pl_dev);
 
 	qdf_spin_lock_bh(&pl_info->log_lock);
@@ -281,6 +281,7 @@ A_STATUS process_tx_info(struct cdp_pdev *txrx_pdev, void *data)
 			     sizeof(struct ath_pktlog_hdr)),
 			     pl_hdr.size);
 		pl_hdr.size = log_size;
+		pktlog_stream_put(pl_info, &pl_hdr, txdesc_hdr_ctl);
 		cds_pkt_stats_to_logger_thread(&pl_hdr, NULL,
 					       txdesc_hdr_ctl);
 	}
@@ -298,6 +299,7 @@ A_STATUS process_tx_info(struct cdp_pdev *txrx_pdev, void *data)
 			      sizeof(struct ath_pktlog_hdr)),
 			     pl_hdr.size);
 		/* TODO: MCL specific API */
+		pktlog_stream_put(pl_info, &pl_hdr, txstat_log.ds_status);
 		cds_pkt_stats_to_logger_thread(&pl_hdr, NULL,
 					       txstat_log.ds_status);
 	}
@@ -445,6 +447,7 @@ A_STATUS process_tx_info(struct cdp_pdev *txrx_pdev, void *data)
 		qdf_mem_copy(txctl_log.txdesc_hdr_ctl, &txctl_log.priv,
 			     sizeof(txctl_log.priv));
 		pl_hdr.size = log_size;
+		pktlog_stream_put(pl_info, &pl_hdr, txctl_log.txdesc_hdr_ctl);
 		cds_pkt_stats_to_logger_thread(&pl_hdr, NULL,
 					       txctl_log.txdesc_hdr_ctl);
 		/* Add Protocol information and HT specific information */
@@ -463,6 +466,7 @@ A_STATUS process_tx_info(struct cdp_pdev *txrx_pdev, void *data)
 			      sizeof(struct ath_pktlog_hdr)),
 			     pl_hdr.size);
 
+		pktlog_stream_put(pl_info, &pl_hdr, txstat_log.ds_status);
 		cds_pkt_stats_to_logger_thread(&pl_hdr, NULL,
 					       txstat_log.ds_status);
 	}
@@ -486,6 +490,7 @@ A_STATUS process_tx_info(struct cdp_pdev *txrx_pdev, void *data)
 			     sizeof(pl_msdu_info.priv.msdu_id_info));
 		qdf_mem_copy(pl_msdu_info.ath_msdu_info, &pl_msdu_info.priv,
 			     sizeof(pl_msdu_info.priv));
+		pktlog_stream_put(pl_info, &pl_hdr, pl_msdu_info.ath_msdu_info);
 		cds_pkt_stats_to_logger_thread(&pl_hdr, NULL,
 					       pl_msdu_info.ath_msdu_info);
 	}
@@ -548,6 +553,7 @@ A_STATUS process_rx_info_remote(void *pdev, void *data)
 							   log_size, &pl_hdr);
 		qdf_mem_copy(rxstat_log.rx_desc, (void *)rx_desc +
 			     sizeof(struct htt_host_fw_desc_base), pl_hdr.size);
+		pktlog_stream_put(pl_info, &pl_hdr, rxstat_log.rx_desc);
 		cds_pkt_stats_to_logger_thread(&pl_hdr, NULL,
 					       rxstat_log.rx_desc);
 		msdu = qdf_nbuf_next(msdu);
@@ -628,6 +634,7 @@ A_STATUS process_rx_info(void *pdev, void *data)
 	qdf_mem_copy(rxstat_log.rx_desc,
 		     (void *)fw_data->data + sizeof(struct ath_pktlog_hdr),
 		     pl_hdr.size);
+	pktlog_stream_put(pl_info, &pl_hdr, rxstat_log.rx_desc);
 	cds_pkt_stats_to_logger_thread(&pl_hdr, NULL, rxstat_log.rx_desc);
 
 	return A_OK;
@@ -698,6 +705,7 @@ A_STATUS process_rx_info(void *pdev, void *data)
 	qdf_mem_copy(rxstat_log.rx_desc,
 		     (void *)fw_data->data + sizeof(struct ath_pktlog_hdr),
 		     pl_hdr.size);
+	pktlog_stream_put(pl_info, &pl_hdr, rxstat_log.rx_desc);
 	cds_pkt_stats_to_logger_thread(&pl_hdr, NULL, rxstat_log.rx_desc);
 
 	return A_OK;
@@ -781,6 +789,7 @@ A_STATUS process_rate_find(void *pdev, void *data)
 	qdf_mem_copy(rcf_log.rcFind,
 		     ((char *)fw_data->data + sizeof(struct ath_pktlog_hdr)),
 		     pl_hdr.size);
+	pktlog_stream_put(pl_info, &pl_hdr, rcf_log.rcFind);
 	cds_pkt_stats_to_logger_thread(&pl_hdr, NULL, rcf_log.rcFind);
 
 	return A_OK;
@@ -857,6 +866,7 @@ A_STATUS process_rate_find(void *pdev, void *data)
 	qdf_mem_copy(rcf_log.rcFind,
 		     ((char *)fw_data->data + sizeof(struct ath_pktlog_hdr)),
 		     pl_hdr.size);
+	pktlog_stream_put(pl_info, &pl_hdr, rcf_log.rcFind);
 	cds_pkt_stats_to_logger_thread(&pl_hdr, NULL, rcf_log.rcFind);
 
 	return A_OK;
@@ -939,6 +949,7 @@ A_STATUS process_rate_update(void *pdev, void *data)
 		     ((char *)fw_data->data +
 		      sizeof(struct ath_pktlog_hdr)),
 		     pl_hdr.size);
+	pktlog_stream_put(pl_info, &pl_hdr, rcu_log.txRateCtrl);
 	cds_pkt_stats_to_logger_thread(&pl_hdr, NULL, rcu_log.txRateCtrl);
 	return A_OK;
 }
@@ -1012,6 +1023,7 @@ A_STATUS process_rate_update(void *pdev, void *data)
 		     ((char *)fw_data->data +
 		      sizeof(struct ath_pktlog_hdr)),
 		     pl_hdr.size);
+	pktlog_stream_put(pl_info, &pl_hdr, rcu_log.txRateCtrl);
 	cds_pkt_stats_to_logger_thread(&pl_hdr, NULL, rcu_log.txRateCtrl);
 	return A_OK;
 }
@@ -1102,6 +1114,7 @@ A_STATUS process_sw_event(void *pdev, void *data)
 		     ((char *)fw_data->data + sizeof(struct ath_pktlog_hdr)),
 		     pl_hdr.size);
 
+	pktlog_stream_put(pl_info, &pl_hdr, sw_event.sw_event);
 	cds_pkt_stats_to_logger_thread(&pl_hdr, NULL, sw_event.sw_event);
 
 	return A_OK;
@@ -1188,6 +1201,7 @@ A_STATUS process_sw_event(void *pdev, void *data)
 		     ((char *)fw_data->data + sizeof(struct ath_pktlog_hdr)),
 		     pl_hdr.size);
 
+	pktlog_stream_put(pl_info, &pl_hdr, sw_event.sw_event);
 	cds_pkt_stats_to_logger_thread(&pl_hdr, NULL, sw_event.sw_event);
 
 	return A_OK;
@@ -81,6 +81,7 @@ process_offload_pktlog_wifi3(struct cdp_pdev *pdev, void *data)
 	qdf_mem_copy(txdesc_hdr_ctl,
 		     ((void *)data + sizeof(struct ath_pktlog_hdr)),
 		     pl_hdr.size);
+	pktlog_stream_put(pl_info, &pl_hdr, txdesc_hdr_ctl);
 	cds_pkt_stats_to_logger_thread(&pl_hdr, NULL, txdesc_hdr_ctl);
 
 	return A_OK;
@@ -118,6 +119,7 @@ int process_rx_desc_remote_wifi3(void *pdev, void *data)
 	}
 
 	qdf_mem_copy(rxstat_log.rx_desc, qdf_nbuf_data(log_nbuf), pl_hdr.size);
+	pktlog_stream_put(pl_info, &pl_hdr, rxstat_log.rx_desc);
 	cds_pkt_stats_to_logger_thread(&pl_hdr, NULL,
 				       rxstat_log.rx_desc);
 	return 0;
@@ -157,6 +159,7 @@ process_pktlog_lite_wifi3(void *context, void *log_data,
 
 	qdf_mem_copy(rxstat_log.rx_desc, qdf_nbuf_data(log_nbuf), pl_hdr.size);
 
+	pktlog_stream_put(pl_info, &pl_hdr, rxstat_log.rx_desc);
 	cds_pkt_stats_to_logger_thread(&pl_hdr, NULL, rxstat_log.rx_desc);
 	return 0;
 }
@@ -0,0 +1,395 @@
+/*
+ * Copyright (c) 2024 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted, provided that the
+ * above copyright notice and this permission notice appear in all
+ * copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+ * AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR
+ * PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+ * TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <pktlog_ac_i.h>
+#include <pktlog_ac_fmt.h>
+#include "pktlog_stream_test.h"
+#include "qdf_mem.h"
+#include "qdf_threads.h"
+#include "qdf_trace.h"
+#include "qdf_util.h"
+
+/* small enough to wrap every few dozen records */
+#define PKTLOG_STREAM_TEST_SIZE 4096
+#define PKTLOG_STREAM_TEST_MAX_PAYLOAD 256
+/* records put with the reader right behind, about a hundred laps */
+#define PKTLOG_STREAM_TEST_LAP_RECORDS 4096
+#define PKTLOG_STREAM_TEST_RECORDS 200000
+/* the reader stops consuming for a while after this many records */
+#define PKTLOG_STREAM_TEST_STALL_EVERY 1000
+#define PKTLOG_STREAM_TEST_FIFO 1024
+#define PKTLOG_STREAM_TEST_LOG_TYPE 0x55
+
+struct pktlog_stream_test_ctx {
+	struct ath_pktlog_info_lnx *pl_info_lnx;
+	struct ath_pktlog_stream_hdr *shdr;
+	/* large enough for the record that never fits the area */
+	uint8_t payload[PKTLOG_STREAM_TEST_SIZE];
+	/* sequence numbers the reader still has to see, single-threaded only */
+	uint32_t fifo[PKTLOG_STREAM_TEST_FIFO];
+	uint32_t fifo_head;
+	uint32_t fifo_tail;
+	/* reader state, driven from one thread like a user space collector */
+	uint32_t next_seq;
+	uint64_t consumed;
+	uint64_t missed;
+	uint32_t pads;
+	uint32_t errors;
+	/* producer thread: first sequence number, set once all are put */
+	uint32_t first;
+	bool done;
+};
+
+/* payload lengths walk across every alignment of the 8 byte records */
+static uint16_t pktlog_stream_test_len(uint32_t seq)
+{
+	return sizeof(uint32_t) +
+	       (seq * 37) % (PKTLOG_STREAM_TEST_MAX_PAYLOAD - sizeof(uint32_t));
+}
+
+static uint32_t pktlog_stream_test_need(uint16_t len)
+{
+	return QDF_ROUND_UP(sizeof(struct ath_pktlog_stream_rec) +
+			    sizeof(struct ath_pktlog_hdr) + len,
+			    PKTLOG_STREAM_ALIGN);
+}
+
+static void pktlog_stream_test_put(struct pktlog_stream_test_ctx *ctx,
+				   uint32_t seq, uint16_t len)
+{
+	struct ath_pktlog_hdr pl_hdr = {0};
+	uint16_t i;
+
+	pl_hdr.log_type = PKTLOG_STREAM_TEST_LOG_TYPE;
+	pl_hdr.size = len;
+	pl_hdr.timestamp = seq;
+	qdf_mem_copy(ctx->payload, &seq, sizeof(seq));
+	for (i = sizeof(seq); i < len; i++)
+		ctx->payload[i] = (uint8_t)(seq + i);
+
+	pktlog_stream_put(&ctx->pl_info_lnx->info, &pl_hdr, ctx->payload);
+}
+
+static bool pktlog_stream_test_check(struct ath_pktlog_stream_rec *rec,
+				     uint32_t *seq)
+{
+	struct ath_pktlog_hdr *pl_hdr = (struct ath_pktlog_hdr *)(rec + 1);
+	uint8_t *payload = (uint8_t *)(pl_hdr + 1);
+	uint16_t i;
+
+	if (pl_hdr->log_type != PKTLOG_STREAM_TEST_LOG_TYPE ||
+	    rec->len != pktlog_stream_test_need(pl_hdr->size))
+		return false;
+
+	qdf_mem_copy(seq, payload, sizeof(*seq));
+	if (pl_hdr->timestamp != *seq ||
+	    pl_hdr->size != pktlog_stream_test_len(*seq))
+		return false;
+
+	for (i = sizeof(*seq); i < pl_hdr->size; i++)
+		if (payload[i] != (uint8_t)(*seq + i))
+			return false;
+
+	return true;
+}
+
+/*
+ * Read records the way a user space collector does through the mapping:
+ * only prod is trusted, every record is validated before use and cons is
+ * moved after the records are done with. Sequence gaps are the records
+ * the producer dropped.
+ *
+ * Return: number of data records consumed
+ */
+static uint32_t pktlog_stream_test_consume(struct pktlog_stream_test_ctx *ctx,
+					   uint32_t max)
+{
+	struct ath_pktlog_stream_hdr *shdr = ctx->shdr;
+	struct ath_pktlog_stream_rec *rec;
+	char *area = (char *)shdr + shdr->data_offset;
+	uint32_t size = shdr->data_size;
+	uint64_t prod, cons = shdr->cons;
+	uint32_t off, seq, n = 0;
+
+	prod = READ_ONCE(shdr->prod);
+	/* read the records only after the prod that published them */
+	qdf_rmb();
+
+	while (cons != prod && n < max) {
+		off = cons & (size - 1);
+		rec = (struct ath_pktlog_stream_rec *)(area + off);
+		if (rec->len < sizeof(*rec) || rec->len % PKTLOG_STREAM_ALIGN ||
+		    rec->len > size - off || rec->len > prod - cons) {
+			/* lost track of the records, skip all that are there */
+			ctx->errors++;
+			cons = prod;
+			break;
+		}
+
+		if (rec->type == PKTLOG_STREAM_REC_PAD) {
+			/* padding only ever fills the tail of the area */
+			if (off + rec->len != size)
+				ctx->errors++;
+			ctx->pads++;
+		} else if (rec->type != PKTLOG_STREAM_REC_DATA ||
+			   !pktlog_stream_test_check(rec, &seq) ||
+			   seq < ctx->next_seq) {
+			ctx->errors++;
+		} else {
+			ctx->missed += seq - ctx->next_seq;
+			ctx->next_seq = seq + 1;
+			ctx->consumed++;
+			n++;
+		}
+		cons += rec->len;
+	}
+
+	/* hand the area back only once the records are read */
+	qdf_mb();
+	WRITE_ONCE(shdr->cons, cons);
+
+	return n;
+}
+
+static void pktlog_stream_test_fifo_push(struct pktlog_stream_test_ctx *ctx,
+					 uint32_t seq)
+{
+	ctx->fifo[ctx->fifo_tail++ % PKTLOG_STREAM_TEST_FIFO] = seq;
+}
+
+static uint32_t
+pktlog_stream_test_fifo_count(struct pktlog_stream_test_ctx *ctx)
+{
+	return ctx->fifo_tail - ctx->fifo_head;
+}
+
+/*
+ * Put one record from the test thread and note whether the stream took
+ * it, so the reader can be told exactly which sequence numbers to expect.
+ */
+static bool pktlog_stream_test_put_one(struct pktlog_stream_test_ctx *ctx,
+				       uint32_t seq)
+{
+	uint64_t dropped = ctx->shdr->dropped_records;
+	uint64_t dropped_bytes = ctx->shdr->dropped_bytes;
+	uint16_t len = pktlog_stream_test_len(seq);
+
+	pktlog_stream_test_put(ctx, seq, len);
+	if (ctx->shdr->dropped_records == dropped) {
+		pktlog_stream_test_fifo_push(ctx, seq);
+		return true;
+	}
+
+	if (ctx->shdr->dropped_records != dropped + 1 ||
+	    ctx->shdr->dropped_bytes !=
+	    dropped_bytes + pktlog_stream_test_need(len))
+		ctx->errors++;
+
+	return false;
+}
+
+/* the reader must see exactly what the stream took, in order */
+static void pktlog_stream_test_drain(struct pktlog_stream_test_ctx *ctx,
+				     uint32_t max)
+{
+	uint32_t expected;
+
+	while (max-- && pktlog_stream_test_fifo_count(ctx)) {
+		expected = ctx->fifo[ctx->fifo_head++ %
+				     PKTLOG_STREAM_TEST_FIFO];
+		ctx->next_seq = expected;
+		if (pktlog_stream_test_consume(ctx, 1) != 1 ||
+		    ctx->next_seq != expected + 1)
+			ctx->errors++;
+	}
+}
+
+static uint32_t pktlog_stream_test_fill(struct pktlog_stream_test_ctx *ctx)
+{
+	struct ath_pktlog_stream_hdr *shdr = ctx->shdr;
+	uint32_t seq = 0;
+	uint32_t taken = 0;
+	uint64_t prod;
+	uint32_t i;
+
+	ctx->errors = 0;
+
+	/* fill the empty area up to the first drop, nothing is overwritten */
+	while (taken < PKTLOG_STREAM_TEST_FIFO &&
+	       pktlog_stream_test_put_one(ctx, seq++))
+		taken++;
+	if (!taken || shdr->dropped_records != 1 ||
+	    shdr->prod > PKTLOG_STREAM_TEST_SIZE || shdr->cons)
+		ctx->errors++;
+
+	/* half the area back, then put until the producer wraps */
+	pktlog_stream_test_drain(ctx, taken / 2);
+	prod = shdr->prod;
+	while (shdr->prod < prod + PKTLOG_STREAM_TEST_SIZE / 2 &&
+	       pktlog_stream_test_put_one(ctx, seq))
+		seq++;
+	if (shdr->prod <= PKTLOG_STREAM_TEST_SIZE)
+		ctx->errors++;
+	pktlog_stream_test_drain(ctx, PKTLOG_STREAM_TEST_FIFO);
+
+	/* many laps of the area with the reader right behind the producer */
+	for (i = 0; i < PKTLOG_STREAM_TEST_LAP_RECORDS; i++) {
+		if (!pktlog_stream_test_put_one(ctx, seq++))
+			ctx->errors++;
+		if (pktlog_stream_test_fifo_count(ctx) > 8)
+			pktlog_stream_test_drain(ctx, 8);
+	}
+	pktlog_stream_test_drain(ctx, PKTLOG_STREAM_TEST_FIFO);
+	if (!ctx->pads || shdr->prod != shdr->cons)
+		ctx->errors++;
+
+	/* a record bigger than half the area never fits */
+	prod = shdr->prod;
+	pktlog_stream_test_put(ctx, seq, PKTLOG_STREAM_TEST_SIZE / 2);
+	if (shdr->prod != prod)
+		ctx->errors++;
+
+	/* garbage in the reader owned cons only gets records dropped */
+	WRITE_ONCE(shdr->cons, prod + 3 * PKTLOG_STREAM_TEST_SIZE + 5);
+	pktlog_stream_test_put(ctx, seq, 16);
+	WRITE_ONCE(shdr->cons, prod - PKTLOG_STREAM_TEST_SIZE - 8);
+	pktlog_stream_test_put(ctx, seq, 16);
+	if (shdr->prod != prod)
+		ctx->errors++;
+	WRITE_ONCE(shdr->cons, prod);
+
+	if (ctx->errors)
+		qdf_nofl_err("pktlog_stream: %u errors filling %u records, %u pads",
+			     ctx->errors, seq, ctx->pads);
+
+	return ctx->errors;
+}
+
+static QDF_STATUS pktlog_stream_test_producer(void *context)
+{
+	struct pktlog_stream_test_ctx *ctx = context;
+	struct ath_pktlog_stream_hdr *shdr = ctx->shdr;
+	uint64_t dropped;
+	uint32_t seq;
+
+	for (seq = ctx->first; seq < ctx->first + PKTLOG_STREAM_TEST_RECORDS;
+	     seq++) {
+		dropped = shdr->dropped_records;
+		pktlog_stream_test_put(ctx, seq, pktlog_stream_test_len(seq));
+
+		/* end the burst on a full area, as real traffic would */
+		if (shdr->dropped_records != dropped)
+			qdf_sleep_us(20);
+	}
+
+	WRITE_ONCE(ctx->done, true);
+
+	return QDF_STATUS_SUCCESS;
+}
+
+/*
+ * Producer and reader run concurrently. The reader stalls now and then
+ * until the stream drops, so both the drop accounting and the wraparound
+ * are exercised while the producer keeps going.
+ */
+static uint32_t pktlog_stream_test_race(struct pktlog_stream_test_ctx *ctx)
+{
+	struct ath_pktlog_stream_hdr *shdr = ctx->shdr;
+	qdf_thread_t *thread;
+	uint64_t dropped, stall_mark;
+	uint32_t lap = 0;
+	bool done;
+
+	ctx->errors = 0;
+	ctx->consumed = 0;
+	ctx->missed = 0;
+	ctx->first = ctx->next_seq;
+	ctx->done = false;
+	dropped = shdr->dropped_records;
+
+	thread = qdf_thread_run(pktlog_stream_test_producer, ctx);
+	if (!thread)
+		return 1;
+
+	while (true) {
+		done = READ_ONCE(ctx->done);
+		/* a finished producer has published its last prod by now */
+		qdf_rmb();
+		lap += pktlog_stream_test_consume(ctx, ~0U);
+		if (done && READ_ONCE(shdr->prod) == shdr->cons)
+			break;
+		if (lap < PKTLOG_STREAM_TEST_STALL_EVERY)
+			continue;
+
+		lap = 0;
+		stall_mark = READ_ONCE(shdr->dropped_records);
+		while (!READ_ONCE(ctx->done) &&
+		       READ_ONCE(shdr->dropped_records) == stall_mark)
+			qdf_sleep_us(10);
+	}
+	qdf_thread_join(thread);
+
+	/* records dropped at the very end never show up as a gap */
+	ctx->missed += ctx->first + PKTLOG_STREAM_TEST_RECORDS - ctx->next_seq;
+	dropped = shdr->dropped_records - dropped;
+
+	if (ctx->errors || !dropped || ctx->missed != dropped ||
+	    ctx->consumed + ctx->missed != PKTLOG_STREAM_TEST_RECORDS ||
+	    shdr->prod < 16 * PKTLOG_STREAM_TEST_SIZE)
+		ctx->errors++;
+
+	qdf_nofl_info("pktlog_stream: %u records %llu read %llu dropped %llu laps %u pads %u errors",
+		      PKTLOG_STREAM_TEST_RECORDS, ctx->consumed, dropped,
+		      shdr->prod / PKTLOG_STREAM_TEST_SIZE, ctx->pads,
+		      ctx->errors);
+
+	return ctx->errors;
+}
+
+uint32_t pktlog_stream_unit_test(void)
+{
+	struct pktlog_stream_test_ctx *ctx;
+	uint32_t errors = 0;
+
+	ctx = qdf_mem_malloc(sizeof(*ctx));
+	if (!ctx)
+		return 1;
+
+	ctx->pl_info_lnx = qdf_mem_malloc(sizeof(*ctx->pl_info_lnx));
+	ctx->shdr = qdf_mem_valloc(PAGE_SIZE + PKTLOG_STREAM_TEST_SIZE);
+	if (!ctx->pl_info_lnx || !ctx->shdr) {
+		errors++;
+		goto free;
+	}
+
+	pktlog_stream_test_start(&ctx->pl_info_lnx->info, ctx->shdr,
+				 PKTLOG_STREAM_TEST_SIZE);
+	errors += pktlog_stream_test_fill(ctx);
+	errors += pktlog_stream_test_race(ctx);
+	pktlog_stream_test_stop(&ctx->pl_info_lnx->info);
+
+free:
+	if (ctx->shdr)
+		qdf_mem_vfree(ctx->shdr);
+	qdf_mem_free(ctx->pl_info_lnx);
+	qdf_mem_free(ctx);
+
+	QDF_BUG(!errors);
+
+	return errors;
+}
@@ -123,6 +123,18 @@
 
 #define WMI_UNIFIED_MAX_EVENT 0x100
 
+/*
+ * Firmware event ids are encoded as (group << 12) | offset. Handler lookup
+ * uses a two-level table: the first level is indexed by group, the second
+ * level (allocated on first registration within a group) maps the offset to
+ * the handler index. Ids outside the table range fall back to a linear scan.
+ */
+#define WMI_EVT_DISPATCH_GRP_SHIFT	12
+#define WMI_EVT_DISPATCH_OFFSET_MASK	((1 << WMI_EVT_DISPATCH_GRP_SHIFT) - 1)
+#define WMI_EVT_DISPATCH_MAX_GRPS	0x80
+#define WMI_EVT_DISPATCH_GRP_SIZE	0x100
+#define WMI_EVT_DISPATCH_INVALID_IDX	0xFFFF
+
 #ifdef WMI_EXT_DBG
 
 #define WMI_EXT_DBG_DIR			"WMI_EXT_DBG"
@@ -3498,11 +3510,49 @@ struct wmi_host_abi_version {
 /* number of debugfs entries used */
 #ifdef WMI_INTERFACE_FILTERED_EVENT_LOGGING
 /* filtered logging added 4 more entries */
-#define NUM_DEBUG_INFOS 13
+#define NUM_DEBUG_INFOS 14
 #else
-#define NUM_DEBUG_INFOS 9
+#define NUM_DEBUG_INFOS 10
 #endif
 
+#ifdef WMI_INTERFACE_EVENT_LOGGING
+/**
+ * enum wmi_evt_latency_bucket - event handler latency histogram buckets
+ * @WMI_EVT_LAT_BUCKET_10_US: handler ran for less than 10us
+ * @WMI_EVT_LAT_BUCKET_50_US: handler ran for 10us to 50us
+ * @WMI_EVT_LAT_BUCKET_100_US: handler ran for 50us to 100us
+ * @WMI_EVT_LAT_BUCKET_500_US: handler ran for 100us to 500us
+ * @WMI_EVT_LAT_BUCKET_1_MS: handler ran for 500us to 1ms
+ * @WMI_EVT_LAT_BUCKET_5_MS: handler ran for 1ms to 5ms
+ * @WMI_EVT_LAT_BUCKET_10_MS: handler ran for 5ms to 10ms
+ * @WMI_EVT_LAT_BUCKET_BEYOND: handler ran for 10ms or more
+ * @WMI_EVT_LAT_BUCKET_MAX: max number of buckets
+ */
+enum wmi_evt_latency_bucket {
+	WMI_EVT_LAT_BUCKET_10_US,
+	WMI_EVT_LAT_BUCKET_50_US,
+	WMI_EVT_LAT_BUCKET_100_US,
+	WMI_EVT_LAT_BUCKET_500_US,
+	WMI_EVT_LAT_BUCKET_1_MS,
+	WMI_EVT_LAT_BUCKET_5_MS,
+	WMI_EVT_LAT_BUCKET_10_MS,
+	WMI_EVT_LAT_BUCKET_BEYOND,
+	WMI_EVT_LAT_BUCKET_MAX,
+};
+
+/**
+ * struct wmi_evt_dispatch_stats - per event handler dispatch statistics
+ * @count: number of events dispatched to the handler
+ * @max_us: longest handler execution time in microseconds
+ * @hist: handler execution time histogram
+ */
+struct wmi_evt_dispatch_stats {
+	uint64_t count;
+	uint32_t max_us;
+	uint32_t hist[WMI_EVT_LAT_BUCKET_MAX];
+};
+#endif /*WMI_INTERFACE_EVENT_LOGGING */
+
 struct wmi_unified {
 	void *scn_handle;    /* handle to device */
 	osdev_t  osdev; /* handle to use OS-independent services */
@@ -3595,6 +3645,10 @@ struct wmi_soc {
 	wmi_unified_event_handler event_handler[WMI_UNIFIED_MAX_EVENT];
 	uint32_t max_event_idx;
 	struct wmi_unified_exec_ctx ctx[WMI_UNIFIED_MAX_EVENT];
+	uint16_t *evt_dispatch_tbl[WMI_EVT_DISPATCH_MAX_GRPS];
+#ifdef WMI_INTERFACE_EVENT_LOGGING
+	struct wmi_evt_dispatch_stats evt_dispatch_stats[WMI_UNIFIED_MAX_EVENT];
+#endif
 	qdf_spinlock_t ctx_lock;
 	struct wmi_unified *wmi_pdev[WMI_MAX_RADIOS];
 	HTC_ENDPOINT_ID wmi_endpoint_id[WMI_MAX_RADIOS];
@@ -21,6 +21,8 @@
 #include "wmi_tlv_defs.h"
 #include "wmi_version.h"
 #include "qdf_module.h"
+#include "qdf_atomic.h"
+#include "qdf_util.h"
 
 #define WMITLV_GET_ATTRIB_NUM_TLVS  0xFFFFFFFF
 
@@ -54,6 +56,187 @@ uint32_t evt_attr_list[] = {
 	WMITLV_ALL_EVT_LIST(WMITLV_GET_CMD_EVT_ATTRB_LIST)
 };
 
+/*
+ * Events received at a high rate get their own attribute list generated at
+ * compile time so that the attribute lookup does not have to walk the whole
+ * evt_attr_list for them.
+ */
+#define WMITLV_HOT_EVT_LIST(OP) \
+	OP(WMI_MGMT_RX_EVENTID) \
+	OP(WMI_MGMT_TX_COMPLETION_EVENTID) \
+	OP(WMI_MGMT_TX_BUNDLE_COMPLETION_EVENTID) \
+	OP(WMI_SCAN_EVENTID) \
+	OP(WMI_UPDATE_STATS_EVENTID) \
+	OP(WMI_PEER_STATS_INFO_EVENTID) \
+	OP(WMI_PEER_STA_PS_STATECHG_EVENTID) \
+	OP(WMI_ROAM_EVENTID) \
+	OP(WMI_ROAM_STATS_EVENTID)
+
+#define WMITLV_HOT_EVT_ATTRB_LIST(id) \
+	static uint32_t wmitlv_hot_attr_list_##id[] = { \
+		WMITLV_GET_CMD_EVT_ATTRB_LIST(id) \
+	};
+
+WMITLV_HOT_EVT_LIST(WMITLV_HOT_EVT_ATTRB_LIST)
+
+#define WMITLV_HOT_EVT_ATTRB_CASE(id) \
+	case id: \
+		return wmitlv_hot_attr_list_##id;
+
+#if defined(WMI_TLV_EVENT_ARENA) && !defined(NO_DYNAMIC_MEM_ALLOC)
+#define WMITLV_ARENA_NUM	4
+#define WMITLV_ARENA_SIZE	4096
+#define WMITLV_ARENA_ALIGN	sizeof(uint64_t)
+
+/**
+ * struct wmitlv_arena - preallocated buffer for parsing one WMI event
+ * @used: number of bytes handed out from @buf
+ * @buf: backing memory for the parameter structure and padded TLVs
+ */
+struct wmitlv_arena {
+	uint32_t used;
+	uint64_t buf[WMITLV_ARENA_SIZE / sizeof(uint64_t)];
+};
+
+static struct wmitlv_arena wmitlv_arena_pool[WMITLV_ARENA_NUM];
+static unsigned long wmitlv_arena_in_use;
+
+/**
+ * wmitlv_arena_get() - claim a free arena for parsing one event
+ *
+ * Events are parsed concurrently from the WMI work queue, tasklet and
+ * scheduler thread contexts, so a small pool of arenas is kept and each
+ * parse claims one. When all of them are busy the caller falls back to
+ * dynamic allocation.
+ *
+ * Return: arena or NULL if none is available
+ */
+static struct wmitlv_arena *wmitlv_arena_get(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < WMITLV_ARENA_NUM; i++) {
+		if (!qdf_atomic_test_and_set_bit(i, &wmitlv_arena_in_use)) {
+			wmitlv_arena_pool[i].used = 0;
+			return &wmitlv_arena_pool[i];
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * wmitlv_arena_alloc() - carve a buffer out of an arena
+ * @arena: arena claimed by wmitlv_arena_get()
+ * @len: number of bytes needed
+ *
+ * Return: buffer or NULL if the arena is exhausted
+ */
+static void *wmitlv_arena_alloc(struct wmitlv_arena *arena, uint32_t len)
+{
+	uint32_t aligned_len = qdf_roundup(len, WMITLV_ARENA_ALIGN);
+	void *ptr;
+
+	if (aligned_len > sizeof(arena->buf) - arena->used)
+		return NULL;
+
+	ptr = (uint8_t *)arena->buf + arena->used;
+	arena->used += aligned_len;
+
+	return ptr;
+}
+
+/**
+ * wmitlv_is_arena_buf() - check if a buffer belongs to the arena pool
+ * @ptr: buffer to check
+ *
+ * Return: true if @ptr was handed out by wmitlv_arena_alloc()
+ */
+static inline bool wmitlv_is_arena_buf(void *ptr)
+{
+	return (uint8_t *)ptr >= (uint8_t *)wmitlv_arena_pool &&
+	       (uint8_t *)ptr < (uint8_t *)(wmitlv_arena_pool +
+					     WMITLV_ARENA_NUM);
+}
+
+/**
+ * wmitlv_arena_put() - release the arena owning a buffer
+ * @ptr: any buffer handed out from the arena
+ *
+ * Return: none
+ */
+static void wmitlv_arena_put(void *ptr)
+{
+	uint32_t i = ((uint8_t *)ptr - (uint8_t *)wmitlv_arena_pool) /
+		     sizeof(struct wmitlv_arena);
+
+	qdf_atomic_test_and_clear_bit(i, &wmitlv_arena_in_use);
+}
+#else
+struct wmitlv_arena;
+
+static inline struct wmitlv_arena *wmitlv_arena_get(void)
+{
+	return NULL;
+}
+
+static inline void *wmitlv_arena_alloc(struct wmitlv_arena *arena,
+				       uint32_t len)
+{
+	return NULL;
+}
+
+static inline bool wmitlv_is_arena_buf(void *ptr)
+{
+	return false;
+}
+
+static inline void wmitlv_arena_put(void *ptr)
+{
+}
+#endif
+
+#ifndef NO_DYNAMIC_MEM_ALLOC
+/**
+ * wmitlv_tlv_buf_alloc() - allocate a buffer for TLV parsing
+ * @os_handle: os context handle
+ * @arena: arena of the current parse or NULL
+ * @len: number of bytes needed
+ *
+ * Return: buffer from @arena if it has room, dynamically allocated
+ * buffer otherwise
+ */
+static void *wmitlv_tlv_buf_alloc(void *os_handle, struct wmitlv_arena *arena,
+				  uint32_t len)
+{
+	void *ptr = NULL;
+
+	if (arena) {
+		ptr = wmitlv_arena_alloc(arena, len);
+		if (ptr)
+			return ptr;
+	}
+
+	wmi_tlv_os_mem_alloc(os_handle, ptr, len);
+
+	return ptr;
+}
+
+/**
+ * wmitlv_tlv_buf_free() - free a buffer allocated by wmitlv_tlv_buf_alloc()
+ * @ptr: buffer to free
+ *
+ * Arena buffers are released together with the arena.
+ *
+ * Return: none
+ */
+static inline void wmitlv_tlv_buf_free(void *ptr)
+{
+	if (!wmitlv_is_arena_buf(ptr))
+		wmi_tlv_os_mem_free(ptr);
+}
+#endif
+
 #ifdef NO_DYNAMIC_MEM_ALLOC
 static wmitlv_cmd_param_info *g_wmi_static_cmd_param_info_buf;
 uint32_t g_wmi_static_max_cmd_param_tlvs;
@@ -89,90 +272,132 @@ wmitlv_set_static_param_tlv_buf(void *param_tlv_buf,
 }
 
 /**
- * wmitlv_get_attributes() - tlv helper function
+ * wmitlv_find_attr_list() - tlv helper function
  * @is_cmd_id: boolean for command attribute
  * @cmd_event_id: command event id
- * @curr_tlv_order: tlv order
- * @tlv_attr_ptr: pointer to tlv attribute
  *
  *
- * WMI TLV Helper functions to find the attributes of the
- * Command/Event TLVs.
+ * WMI TLV Helper function to find the attribute list of the
+ * Command/Event, starting at its number of TLVs entry.
  *
- * Return: 0 if success. Return >=1 if failure.
+ * Return: pointer to the attribute list or NULL if not found.
  */
-static
-uint32_t wmitlv_get_attributes(uint32_t is_cmd_id, uint32_t cmd_event_id,
-			       uint32_t curr_tlv_order,
-			       wmitlv_attributes_struc *tlv_attr_ptr)
+static uint32_t *wmitlv_find_attr_list(uint32_t is_cmd_id,
+				       uint32_t cmd_event_id)
 {
-	uint32_t i, base_index, num_tlvs, num_entries;
+	uint32_t i, num_entries;
 	uint32_t *pAttrArrayList;
 
 	if (is_cmd_id) {
 		pAttrArrayList = &cmd_attr_list[0];
 		num_entries = QDF_ARRAY_SIZE(cmd_attr_list);
 	} else {
+		switch (cmd_event_id) {
+			WMITLV_HOT_EVT_LIST(WMITLV_HOT_EVT_ATTRB_CASE);
+		default:
+			break;
+		}
 		pAttrArrayList = &evt_attr_list[0];
 		num_entries = QDF_ARRAY_SIZE(evt_attr_list);
 	}
 
 	for (i = 0; i < num_entries; i++) {
-		num_tlvs = WMITLV_GET_NUM_TLVS(pAttrArrayList[i]);
 		if (WMITLV_GET_CMDID(cmd_event_id) ==
-		    WMITLV_GET_CMDID(pAttrArrayList[i])) {
-			tlv_attr_ptr->cmd_num_tlv = num_tlvs;
-			/* Return success from here when only number of TLVS for
-			 * this command/event is required */
-			if (curr_tlv_order == WMITLV_GET_ATTRIB_NUM_TLVS) {
-				wmi_tlv_print_verbose
-					("%s: WMI TLV attribute definitions for %s:0x%x found; num_of_tlvs:%d\n",
-					__func__, (is_cmd_id ? "Cmd" : "Evt"),
-					cmd_event_id, num_tlvs);
-				return 0;
-			}
+		    WMITLV_GET_CMDID(pAttrArrayList[i]))
+			return &pAttrArrayList[i];
 
-			/* Return failure if tlv_order is more than the expected
-			 * number of TLVs */
-			if (curr_tlv_order >= num_tlvs) {
-				wmi_tlv_print_error
-					("%s: ERROR: TLV order %d greater than num_of_tlvs:%d for %s:0x%x\n",
-					__func__, curr_tlv_order, num_tlvs,
-					(is_cmd_id ? "Cmd" : "Evt"), cmd_event_id);
-				return 1;
-			}
-
-			base_index = i + 1;     /* index to first TLV attributes */
-			wmi_tlv_print_verbose
-				("%s: WMI TLV attributes for %s:0x%x tlv[%d]:0x%x\n",
-				__func__, (is_cmd_id ? "Cmd" : "Evt"),
-				cmd_event_id, curr_tlv_order,
-				pAttrArrayList[(base_index + curr_tlv_order)]);
-			tlv_attr_ptr->tag_order = curr_tlv_order;
-			tlv_attr_ptr->tag_id =
-				WMITLV_GET_TAGID(pAttrArrayList
-						 [(base_index + curr_tlv_order)]);
-			tlv_attr_ptr->tag_struct_size =
-				WMITLV_GET_TAG_STRUCT_SIZE(pAttrArrayList
-							   [(base_index +
-							     curr_tlv_order)]);
-			tlv_attr_ptr->tag_varied_size =
-				WMITLV_GET_TAG_VARIED(pAttrArrayList
-						      [(base_index +
-							curr_tlv_order)]);
-			tlv_attr_ptr->tag_array_size =
-				WMITLV_GET_TAG_ARRAY_SIZE(pAttrArrayList
-							  [(base_index +
-							    curr_tlv_order)]);
-			return 0;
-		}
-		i += num_tlvs;
+		i += WMITLV_GET_NUM_TLVS(pAttrArrayList[i]);
 	}
 
 	wmi_tlv_print_error
 		("%s: ERROR: Didn't found WMI TLV attribute definitions for %s:0x%x\n",
 		__func__, (is_cmd_id ? "Cmd" : "Evt"), cmd_event_id);
-	return 1;
+	return NULL;
+}
+
+/**
+ * wmitlv_decode_attributes() - tlv helper function
+ * @is_cmd_id: boolean for command attribute
+ * @cmd_event_id: command event id
+ * @attr_list: attribute list returned by wmitlv_find_attr_list()
+ * @curr_tlv_order: tlv order
+ * @tlv_attr_ptr: pointer to tlv attribute
+ *
+ *
+ * WMI TLV Helper function to decode the attributes of the
+ * Command/Event TLV with the given order.
+ *
+ * Return: 0 if success. Return >=1 if failure.
+ */
+static
+uint32_t wmitlv_decode_attributes(uint32_t is_cmd_id, uint32_t cmd_event_id,
+				  uint32_t *attr_list, uint32_t curr_tlv_order,
+				  wmitlv_attributes_struc *tlv_attr_ptr)
+{
+	uint32_t num_tlvs = WMITLV_GET_NUM_TLVS(attr_list[0]);
+	uint32_t attr;
+
+	tlv_attr_ptr->cmd_num_tlv = num_tlvs;
+	/* Return success from here when only number of TLVS for
+	 * this command/event is required */
+	if (curr_tlv_order == WMITLV_GET_ATTRIB_NUM_TLVS) {
+		wmi_tlv_print_verbose
+			("%s: WMI TLV attribute definitions for %s:0x%x found; num_of_tlvs:%d\n",
+			__func__, (is_cmd_id ? "Cmd" : "Evt"),
+			cmd_event_id, num_tlvs);
+		return 0;
+	}
+
+	/* Return failure if tlv_order is more than the expected
+	 * number of TLVs */
+	if (curr_tlv_order >= num_tlvs) {
+		wmi_tlv_print_error
+			("%s: ERROR: TLV order %d greater than num_of_tlvs:%d for %s:0x%x\n",
+			__func__, curr_tlv_order, num_tlvs,
+			(is_cmd_id ? "Cmd" : "Evt"), cmd_event_id);
+		return 1;
+	}
+
+	/* attr_list[0] is followed by the attributes of the first TLV */
+	attr = attr_list[1 + curr_tlv_order];
+	wmi_tlv_print_verbose
+		("%s: WMI TLV attributes for %s:0x%x tlv[%d]:0x%x\n",
+		__func__, (is_cmd_id ? "Cmd" : "Evt"),
+		cmd_event_id, curr_tlv_order, attr);
+	tlv_attr_ptr->tag_order = curr_tlv_order;
+	tlv_attr_ptr->tag_id = WMITLV_GET_TAGID(attr);
+	tlv_attr_ptr->tag_struct_size = WMITLV_GET_TAG_STRUCT_SIZE(attr);
+	tlv_attr_ptr->tag_varied_size = WMITLV_GET_TAG_VARIED(attr);
+	tlv_attr_ptr->tag_array_size = WMITLV_GET_TAG_ARRAY_SIZE(attr);
+	return 0;
+}
+
+/**
+ * wmitlv_get_attributes() - tlv helper function
+ * @is_cmd_id: boolean for command attribute
+ * @cmd_event_id: command event id
+ * @curr_tlv_order: tlv order
+ * @tlv_attr_ptr: pointer to tlv attribute
+ *
+ *
+ * WMI TLV Helper functions to find the attributes of the
+ * Command/Event TLVs.
+ *
+ * Return: 0 if success. Return >=1 if failure.
+ */
+static
+uint32_t wmitlv_get_attributes(uint32_t is_cmd_id, uint32_t cmd_event_id,
+			       uint32_t curr_tlv_order,
+			       wmitlv_attributes_struc *tlv_attr_ptr)
+{
+	uint32_t *attr_list;
+
+	attr_list = wmitlv_find_attr_list(is_cmd_id, cmd_event_id);
+	if (!attr_list)
+		return 1;
+
+	return wmitlv_decode_attributes(is_cmd_id, cmd_event_id, attr_list,
+					curr_tlv_order, tlv_attr_ptr);
 }
 
 /**
@@ -502,11 +727,19 @@ wmitlv_check_and_pad_tlvs(void *os_handle, void *param_struc_ptr,
 	uint32_t len_wmi_cmd_struct_buf;
 	uint32_t free_buf_len;
 	int32_t error = -1;
+	uint32_t *attr_list;
+#ifndef NO_DYNAMIC_MEM_ALLOC
+	struct wmitlv_arena *arena = NULL;
+#endif
+
+	/* Look up the attribute list once for all TLVs of this command/event */
+	attr_list = wmitlv_find_attr_list(is_cmd_id, wmi_cmd_event_id);
 
 	/* Get the number of TLVs for this command/event */
-	if (wmitlv_get_attributes
-		    (is_cmd_id, wmi_cmd_event_id, WMITLV_GET_ATTRIB_NUM_TLVS,
-		    &attr_struct_ptr) != 0) {
+	if (!attr_list ||
+	    wmitlv_decode_attributes
+		    (is_cmd_id, wmi_cmd_event_id, attr_list,
+		    WMITLV_GET_ATTRIB_NUM_TLVS, &attr_struct_ptr) != 0) {
 		wmi_tlv_print_error
 			("%s: ERROR: Couldn't get expected number of TLVs for Cmd=%d\n",
 			__func__, wmi_cmd_event_id);
@@ -525,9 +758,18 @@ wmitlv_check_and_pad_tlvs(void *os_handle, void *param_struc_ptr,
 	len_wmi_cmd_struct_buf =
 		attr_struct_ptr.cmd_num_tlv * sizeof(wmitlv_cmd_param_info);
 #ifndef NO_DYNAMIC_MEM_ALLOC
-	/* Dynamic memory allocation supported */
-	wmi_tlv_os_mem_alloc(os_handle, *wmi_cmd_struct_ptr,
-			     len_wmi_cmd_struct_buf);
+	/* Dynamic memory allocation supported. Events are parsed into a
+	 * preallocated arena when one is available, so the parameter
+	 * structure and any padded TLVs need no allocation of their own. */
+	if (!is_cmd_id)
+		arena = wmitlv_arena_get();
+	*wmi_cmd_struct_ptr = wmitlv_tlv_buf_alloc(os_handle, arena,
+						   len_wmi_cmd_struct_buf);
+	if (arena && !wmitlv_is_arena_buf(*wmi_cmd_struct_ptr)) {
+		/* Parameter structure does not fit, don't hold the arena */
+		wmitlv_arena_put(arena);
+		arena = NULL;
+	}
 #else
 	/* Dynamic memory allocation is not supported. Use the buffer
 	 * g_wmi_static_cmd_param_info_buf, which should be set using
@@ -573,8 +815,8 @@ wmitlv_check_and_pad_tlvs(void *os_handle, void *param_struc_ptr,
 		/* Get the attributes of the TLV with the given order in "tlv_index" */
 		wmi_tlv_OS_MEMZERO(&attr_struct_ptr,
 				   sizeof(wmitlv_attributes_struc));
-		if (wmitlv_get_attributes
-			    (is_cmd_id, wmi_cmd_event_id, tlv_index,
+		if (wmitlv_decode_attributes
+			    (is_cmd_id, wmi_cmd_event_id, attr_list, tlv_index,
 			    &attr_struct_ptr) != 0) {
 			wmi_tlv_print_error
 				("%s: ERROR: No TLV attributes found for Cmd=%d Tag_order=%d\n",
@@ -707,9 +949,9 @@ wmitlv_check_and_pad_tlvs(void *os_handle, void *param_struc_ptr,
 				WMITLV_GET_TLVLEN(WMITLV_GET_HDR(buf_ptr)) +
 				WMI_TLV_HDR_SIZE;
 #ifndef NO_DYNAMIC_MEM_ALLOC
-			wmi_tlv_os_mem_alloc(os_handle, new_tlv_buf,
-					     (num_of_elems *
-					      attr_struct_ptr.tag_struct_size));
+			new_tlv_buf = wmitlv_tlv_buf_alloc(os_handle, arena,
+							   (num_of_elems *
+							    attr_struct_ptr.tag_struct_size));
 			if (!new_tlv_buf) {
 				/* Error: unable to alloc memory */
 				wmi_tlv_print_error
@@ -914,8 +1156,9 @@ wmitlv_check_and_pad_tlvs(void *os_handle, void *param_struc_ptr,
 				__func__, tlv_size_diff);
 #ifndef NO_DYNAMIC_MEM_ALLOC
 			/* Dynamic memory allocation is supported */
-			wmi_tlv_os_mem_alloc(os_handle, new_tlv_buf,
-					     (curr_tlv_len - tlv_size_diff));
+			new_tlv_buf = wmitlv_tlv_buf_alloc(os_handle, arena,
+							   (curr_tlv_len -
+							    tlv_size_diff));
 			if (!new_tlv_buf) {
 				/* Error: unable to alloc memory */
 				wmi_tlv_print_error
@@ -1061,7 +1304,7 @@ static void wmitlv_free_allocated_tlvs(uint32_t is_cmd_id,
 	if ((((WMITLV_TYPEDEF_STRUCT_PARAMS_TLVS(wmi_cmd_event_id) *)ptr)->WMITLV_FIELD_BUF_IS_ALLOCATED(elem_name)) &&	\
 	    (((WMITLV_TYPEDEF_STRUCT_PARAMS_TLVS(wmi_cmd_event_id) *)ptr)->elem_name)) \
 	{ \
-		wmi_tlv_os_mem_free(((WMITLV_TYPEDEF_STRUCT_PARAMS_TLVS(wmi_cmd_event_id) *)ptr)->elem_name); \
+		wmitlv_tlv_buf_free(((WMITLV_TYPEDEF_STRUCT_PARAMS_TLVS(wmi_cmd_event_id) *)ptr)->elem_name); \
 	}
 
 #define WMITLV_FREE_TLV_ELEMS(id)	     \
@@ -1089,7 +1332,10 @@ break;
 		}
 	}
 
-	wmi_tlv_os_mem_free(*wmi_cmd_struct_ptr);
+	if (wmitlv_is_arena_buf(*wmi_cmd_struct_ptr))
+		wmitlv_arena_put(*wmi_cmd_struct_ptr);
+	else
+		wmi_tlv_os_mem_free(*wmi_cmd_struct_ptr);
 	*wmi_cmd_struct_ptr = NULL;
 #endif
 
@@ -1270,6 +1270,165 @@ static ssize_t debug_wmi_log_size_write(struct file *file,
 	return -EINVAL;
 }
 
+/**
+ * wmi_evt_dispatch_stats_reset() - clear dispatch stats of a handler slot
+ * @soc: wmi soc handle
+ * @idx: handler index
+ *
+ * Return: none
+ */
+static void wmi_evt_dispatch_stats_reset(struct wmi_soc *soc, uint32_t idx)
+{
+	qdf_mem_zero(&soc->evt_dispatch_stats[idx],
+		     sizeof(soc->evt_dispatch_stats[idx]));
+}
+
+/**
+ * wmi_evt_dispatch_stats_move() - move dispatch stats along with a handler
+ * @soc: wmi soc handle
+ * @dst: new handler index
+ * @src: old handler index
+ *
+ * Return: none
+ */
+static void wmi_evt_dispatch_stats_move(struct wmi_soc *soc, uint32_t dst,
+					uint32_t src)
+{
+	if (dst != src)
+		soc->evt_dispatch_stats[dst] = soc->evt_dispatch_stats[src];
+	wmi_evt_dispatch_stats_reset(soc, src);
+}
+
+/**
+ * wmi_evt_dispatch_ts() - get the start timestamp of an event dispatch
+ *
+ * Return: log timestamp
+ */
+static inline uint64_t wmi_evt_dispatch_ts(void)
+{
+	return qdf_get_log_timestamp();
+}
+
+/**
+ * wmi_evt_dispatch_stats_record() - account one event handler invocation
+ * @soc: wmi soc handle
+ * @idx: handler index
+ * @start_ts: log timestamp taken before the handler was invoked
+ *
+ * Return: none
+ */
+static void wmi_evt_dispatch_stats_record(struct wmi_soc *soc, uint32_t idx,
+					  uint64_t start_ts)
+{
+	struct wmi_evt_dispatch_stats *stats = &soc->evt_dispatch_stats[idx];
+	uint32_t delta_us;
+	enum wmi_evt_latency_bucket bucket;
+
+	delta_us = qdf_log_timestamp_to_usecs(qdf_get_log_timestamp() -
+					      start_ts);
+	if (delta_us < 10)
+		bucket = WMI_EVT_LAT_BUCKET_10_US;
+	else if (delta_us < 50)
+		bucket = WMI_EVT_LAT_BUCKET_50_US;
+	else if (delta_us < 100)
+		bucket = WMI_EVT_LAT_BUCKET_100_US;
+	else if (delta_us < 500)
+		bucket = WMI_EVT_LAT_BUCKET_500_US;
+	else if (delta_us < 1000)
+		bucket = WMI_EVT_LAT_BUCKET_1_MS;
+	else if (delta_us < 5000)
+		bucket = WMI_EVT_LAT_BUCKET_5_MS;
+	else if (delta_us < 10000)
+		bucket = WMI_EVT_LAT_BUCKET_10_MS;
+	else
+		bucket = WMI_EVT_LAT_BUCKET_BEYOND;
+
+	stats->count++;
+	stats->hist[bucket]++;
+	if (delta_us > stats->max_us)
+		stats->max_us = delta_us;
+}
+
+/**
+ * debug_wmi_event_dispatch_stats_show() - debugfs function to display per
+ * event id dispatch counters and handler latency histograms.
+ *
+ * @m: debugfs handler to access wmi_handle
+ * @v: Variable arguments (not used)
+ *
+ * Return: Length of characters printed
+ */
+static int debug_wmi_event_dispatch_stats_show(struct seq_file *m, void *v)
+{
+	wmi_unified_t wmi_handle = (wmi_unified_t)m->private;
+	struct wmi_soc *soc = wmi_handle->soc;
+	struct wmi_evt_dispatch_stats *stats;
+	uint32_t idx;
+
+	wmi_bp_seq_printf(m, "%-10s %-12s %-8s %s\n", "event_id", "count",
+			  "max_us",
+			  "<10us <50us <100us <500us <1ms <5ms <10ms >=10ms");
+
+	for (idx = 0; idx < soc->max_event_idx &&
+	     idx < WMI_UNIFIED_MAX_EVENT; idx++) {
+		stats = &soc->evt_dispatch_stats[idx];
+		if (!stats->count)
+			continue;
+
+		wmi_bp_seq_printf(m, "0x%-8x %-12llu %-8u %u %u %u %u %u %u %u %u\n",
+				  wmi_handle->event_id[idx], stats->count,
+				  stats->max_us,
+				  stats->hist[WMI_EVT_LAT_BUCKET_10_US],
+				  stats->hist[WMI_EVT_LAT_BUCKET_50_US],
+				  stats->hist[WMI_EVT_LAT_BUCKET_100_US],
+				  stats->hist[WMI_EVT_LAT_BUCKET_500_US],
+				  stats->hist[WMI_EVT_LAT_BUCKET_1_MS],
+				  stats->hist[WMI_EVT_LAT_BUCKET_5_MS],
+				  stats->hist[WMI_EVT_LAT_BUCKET_10_MS],
+				  stats->hist[WMI_EVT_LAT_BUCKET_BEYOND]);
+	}
+
+	return 0;
+}
+
+/**
+ * debug_wmi_event_dispatch_stats_write() - debugfs function to clear the
+ * event dispatch statistics.
+ *
+ * @file: file handler to access wmi_handle
+ * @buf: received data buffer
+ * @count: length of received buffer
+ * @ppos: Not used
+ *
+ * Return: count
+ */
+static ssize_t debug_wmi_event_dispatch_stats_write(struct file *file,
+						    const char __user *buf,
+						    size_t count, loff_t *ppos)
+{
+	wmi_unified_t wmi_handle =
+		((struct seq_file *)file->private_data)->private;
+	int k, ret;
+	char locbuf[50] = {0x00};
+
+	if ((!buf) || (count > 50))
+		return -EFAULT;
+
+	if (copy_from_user(locbuf, buf, count))
+		return -EFAULT;
+
+	ret = sscanf(locbuf, "%d", &k);
+	if ((ret != 1) || (k != 0)) {
+		wmi_err("Wrong input, echo 0 to clear the dispatch stats");
+		return -EINVAL;
+	}
+
+	qdf_mem_zero(wmi_handle->soc->evt_dispatch_stats,
+		     sizeof(wmi_handle->soc->evt_dispatch_stats));
+
+	return count;
+}
+
 /* Structure to maintain debug information */
 struct wmi_debugfs_info {
 	const char *name;
@@ -1314,6 +1473,7 @@ GENERATE_DEBUG_STRUCTS(wmi_mgmt_command_tx_cmp_log);
 GENERATE_DEBUG_STRUCTS(wmi_mgmt_event_log);
 GENERATE_DEBUG_STRUCTS(wmi_enable);
 GENERATE_DEBUG_STRUCTS(wmi_log_size);
+GENERATE_DEBUG_STRUCTS(wmi_event_dispatch_stats);
 #ifdef WMI_INTERFACE_FILTERED_EVENT_LOGGING
 GENERATE_DEBUG_STRUCTS(filtered_wmi_cmds);
 GENERATE_DEBUG_STRUCTS(filtered_wmi_evts);
@@ -1331,6 +1491,7 @@ struct wmi_debugfs_info wmi_debugfs_infos[NUM_DEBUG_INFOS] = {
 	DEBUG_FOO(wmi_mgmt_event_log),
 	DEBUG_FOO(wmi_enable),
 	DEBUG_FOO(wmi_log_size),
+	DEBUG_FOO(wmi_event_dispatch_stats),
 #ifdef WMI_INTERFACE_FILTERED_EVENT_LOGGING
 	DEBUG_FOO(filtered_wmi_cmds),
 	DEBUG_FOO(filtered_wmi_evts),
@@ -1452,6 +1613,19 @@ static inline void wmi_log_buffer_free(struct wmi_unified *wmi_handle) { }
 static void wmi_minidump_detach(struct wmi_unified *wmi_handle) { }
 static void wmi_minidump_attach(struct wmi_unified *wmi_handle) { }
 static void wmi_dump_last_cmd_rec_info(wmi_unified_t wmi_handle) { }
+static inline void
+wmi_evt_dispatch_stats_reset(struct wmi_soc *soc, uint32_t idx) { }
+static inline void
+wmi_evt_dispatch_stats_move(struct wmi_soc *soc, uint32_t dst,
+			    uint32_t src) { }
+static inline uint64_t wmi_evt_dispatch_ts(void)
+{
+	return 0;
+}
+
+static inline void
+wmi_evt_dispatch_stats_record(struct wmi_soc *soc, uint32_t idx,
+			      uint64_t start_ts) { }
 #endif /*WMI_INTERFACE_EVENT_LOGGING */
 qdf_export_symbol(wmi_mgmt_cmd_record);
 
@@ -2230,6 +2404,79 @@ QDF_STATUS wmi_unified_cmd_send_fl(wmi_unified_t wmi_handle, wmi_buf_t buf,
 }
 qdf_export_symbol(wmi_unified_cmd_send_fl);
 
+/**
+ * wmi_evt_dispatch_is_direct() - check if event id fits the dispatch table
+ * @event_id: wmi event id
+ *
+ * Return: true if the handler index of @event_id is kept in the two-level
+ * dispatch table, false if it has to be found with a linear scan
+ */
+static inline bool wmi_evt_dispatch_is_direct(uint32_t event_id)
+{
+	return ((event_id >> WMI_EVT_DISPATCH_GRP_SHIFT) <
+		WMI_EVT_DISPATCH_MAX_GRPS) &&
+	       ((event_id & WMI_EVT_DISPATCH_OFFSET_MASK) <
+		WMI_EVT_DISPATCH_GRP_SIZE);
+}
+
+/**
+ * wmi_evt_dispatch_tbl_set() - update the dispatch table entry of an event
+ * @soc: wmi soc handle
+ * @event_id: wmi event id
+ * @idx: handler index or WMI_EVT_DISPATCH_INVALID_IDX
+ *
+ * The second level table of the event group is allocated when the first
+ * handler of the group is registered.
+ *
+ * Return: QDF_STATUS_SUCCESS on success else failure
+ */
+static QDF_STATUS wmi_evt_dispatch_tbl_set(struct wmi_soc *soc,
+					   uint32_t event_id, uint16_t idx)
+{
+	uint32_t grp = event_id >> WMI_EVT_DISPATCH_GRP_SHIFT;
+	uint16_t *tbl;
+
+	if (!wmi_evt_dispatch_is_direct(event_id))
+		return QDF_STATUS_SUCCESS;
+
+	tbl = soc->evt_dispatch_tbl[grp];
+	if (!tbl) {
+		if (idx == WMI_EVT_DISPATCH_INVALID_IDX)
+			return QDF_STATUS_SUCCESS;
+
+		tbl = qdf_mem_malloc(WMI_EVT_DISPATCH_GRP_SIZE * sizeof(*tbl));
+		if (!tbl)
+			return QDF_STATUS_E_NOMEM;
+
+		qdf_mem_set(tbl, WMI_EVT_DISPATCH_GRP_SIZE * sizeof(*tbl),
+			    0xFF);
+		soc->evt_dispatch_tbl[grp] = tbl;
+	}
+
+	tbl[event_id & WMI_EVT_DISPATCH_OFFSET_MASK] = idx;
+
+	return QDF_STATUS_SUCCESS;
+}
+
+/**
+ * wmi_evt_dispatch_tbl_free() - free the event dispatch table
+ * @soc: wmi soc handle
+ *
+ * Return: none
+ */
+static void wmi_evt_dispatch_tbl_free(struct wmi_soc *soc)
+{
+	uint32_t grp;
+
+	for (grp = 0; grp < WMI_EVT_DISPATCH_MAX_GRPS; grp++) {
+		if (!soc->evt_dispatch_tbl[grp])
+			continue;
+
+		qdf_mem_free(soc->evt_dispatch_tbl[grp]);
+		soc->evt_dispatch_tbl[grp] = NULL;
+	}
+}
+
 /**
  * wmi_unified_get_event_handler_ix() - gives event handler's index
  * @wmi_handle: handle to wmi
@@ -2243,6 +2490,22 @@ static int wmi_unified_get_event_handler_ix(wmi_unified_t wmi_handle,
 	uint32_t idx = 0;
 	int32_t invalid_idx = -1;
 	struct wmi_soc *soc = wmi_handle->soc;
+	uint16_t *tbl;
+
+	if (qdf_likely(wmi_evt_dispatch_is_direct(event_id))) {
+		tbl = soc->evt_dispatch_tbl[event_id >>
+					    WMI_EVT_DISPATCH_GRP_SHIFT];
+		if (!tbl)
+			return invalid_idx;
+
+		idx = tbl[event_id & WMI_EVT_DISPATCH_OFFSET_MASK];
+		if (idx < soc->max_event_idx &&
+		    wmi_handle->event_id[idx] == event_id &&
+		    wmi_handle->event_handler[idx])
+			return idx;
+
+		return invalid_idx;
+	}
 
 	for (idx = 0; (idx < soc->max_event_idx &&
 		       idx < WMI_UNIFIED_MAX_EVENT); ++idx) {
@@ -2255,6 +2518,46 @@ static int wmi_unified_get_event_handler_ix(wmi_unified_t wmi_handle,
 	return invalid_idx;
 }
 
+/**
+ * wmi_unified_release_event_handler_ix() - release an event handler's index
+ * @wmi_handle: handle to wmi
+ * @idx: index of the handler to release
+ *
+ * The last registered handler is moved into the released slot so that the
+ * registered handlers stay contiguous.
+ *
+ * Return: none
+ */
+static void wmi_unified_release_event_handler_ix(wmi_unified_t wmi_handle,
+						 uint32_t idx)
+{
+	struct wmi_soc *soc = wmi_handle->soc;
+	uint32_t last;
+
+	wmi_evt_dispatch_tbl_set(soc, wmi_handle->event_id[idx],
+				 WMI_EVT_DISPATCH_INVALID_IDX);
+	wmi_handle->event_handler[idx] = NULL;
+	wmi_handle->event_id[idx] = 0;
+	last = --soc->max_event_idx;
+	wmi_handle->event_handler[idx] =
+		wmi_handle->event_handler[last];
+	wmi_handle->event_id[idx] =
+		wmi_handle->event_id[last];
+	if (idx != last && wmi_handle->event_handler[idx])
+		wmi_evt_dispatch_tbl_set(soc, wmi_handle->event_id[idx], idx);
+
+	qdf_spin_lock_bh(&soc->ctx_lock);
+
+	wmi_handle->ctx[idx].exec_ctx =
+		wmi_handle->ctx[last].exec_ctx;
+	wmi_handle->ctx[idx].buff_type =
+		wmi_handle->ctx[last].buff_type;
+
+	qdf_spin_unlock_bh(&soc->ctx_lock);
+
+	wmi_evt_dispatch_stats_move(soc, idx, last);
+}
+
 /**
  * wmi_register_event_handler_with_ctx() - register event handler with
  * exec ctx and buffer type
@@ -2308,9 +2611,13 @@ wmi_register_event_handler_with_ctx(wmi_unified_t wmi_handle,
 			 evt_id);
 		return QDF_STATUS_E_FAILURE;
 	}
+	idx = soc->max_event_idx;
+	if (QDF_IS_STATUS_ERROR(wmi_evt_dispatch_tbl_set(soc, evt_id, idx))) {
+		wmi_err("no memory for dispatch table of event 0x%x", evt_id);
+		return QDF_STATUS_E_NOMEM;
+	}
 	QDF_TRACE(QDF_MODULE_ID_WMI, QDF_TRACE_LEVEL_DEBUG,
 		  "Registered event handler for event 0x%8x", evt_id);
-	idx = soc->max_event_idx;
 	wmi_handle->event_handler[idx] = handler_func;
 	wmi_handle->event_id[idx] = evt_id;
 
@@ -2318,6 +2625,7 @@ wmi_register_event_handler_with_ctx(wmi_unified_t wmi_handle,
 	wmi_handle->ctx[idx].exec_ctx = rx_ctx;
 	wmi_handle->ctx[idx].buff_type = rx_buf_type;
 	qdf_spin_unlock_bh(&soc->ctx_lock);
+	wmi_evt_dispatch_stats_reset(soc, idx);
 	soc->max_event_idx++;
 
 	return QDF_STATUS_SUCCESS;
@@ -2365,14 +2673,12 @@ QDF_STATUS wmi_unified_unregister_event(wmi_unified_t wmi_handle,
 {
 	uint32_t idx = 0;
 	uint32_t evt_id;
-	struct wmi_soc *soc;
 
 	if (!wmi_handle) {
 		wmi_err("WMI handle is NULL");
 		return QDF_STATUS_E_FAILURE;
 	}
 
-	soc = wmi_handle->soc;
 	if (event_id >= wmi_events_max ||
 		wmi_handle->wmi_events[event_id] == WMI_EVENT_ID_INVALID) {
 		QDF_TRACE(QDF_MODULE_ID_WMI, QDF_TRACE_LEVEL_INFO,
@@ -2388,22 +2694,7 @@ QDF_STATUS wmi_unified_unregister_event(wmi_unified_t wmi_handle,
 			 evt_id);
 		return QDF_STATUS_E_FAILURE;
 	}
-	wmi_handle->event_handler[idx] = NULL;
-	wmi_handle->event_id[idx] = 0;
-	--soc->max_event_idx;
-	wmi_handle->event_handler[idx] =
-		wmi_handle->event_handler[soc->max_event_idx];
-	wmi_handle->event_id[idx] =
-		wmi_handle->event_id[soc->max_event_idx];
-
-	qdf_spin_lock_bh(&soc->ctx_lock);
-
-	wmi_handle->ctx[idx].exec_ctx =
-		wmi_handle->ctx[soc->max_event_idx].exec_ctx;
-	wmi_handle->ctx[idx].buff_type =
-		wmi_handle->ctx[soc->max_event_idx].buff_type;
-
-	qdf_spin_unlock_bh(&soc->ctx_lock);
+	wmi_unified_release_event_handler_ix(wmi_handle, idx);
 
 	return QDF_STATUS_SUCCESS;
 }
@@ -2413,15 +2704,12 @@ QDF_STATUS wmi_unified_unregister_event_handler(wmi_unified_t wmi_handle,
 {
 	uint32_t idx = 0;
 	uint32_t evt_id;
-	struct wmi_soc *soc;
 
 	if (!wmi_handle) {
 		wmi_err("WMI handle is NULL");
 		return QDF_STATUS_E_FAILURE;
 	}
 
-	soc = wmi_handle->soc;
-
 	if (event_id >= wmi_events_max) {
 		wmi_err("Event id %d is unavailable", event_id);
 		return QDF_STATUS_E_FAILURE;
@@ -2440,22 +2728,7 @@ QDF_STATUS wmi_unified_unregister_event_handler(wmi_unified_t wmi_handle,
 			 evt_id);
 		return QDF_STATUS_E_FAILURE;
 	}
-	wmi_handle->event_handler[idx] = NULL;
-	wmi_handle->event_id[idx] = 0;
-	--soc->max_event_idx;
-	wmi_handle->event_handler[idx] =
-		wmi_handle->event_handler[soc->max_event_idx];
-	wmi_handle->event_id[idx] =
-		wmi_handle->event_id[soc->max_event_idx];
-
-	qdf_spin_lock_bh(&soc->ctx_lock);
-
-	wmi_handle->ctx[idx].exec_ctx =
-		wmi_handle->ctx[soc->max_event_idx].exec_ctx;
-	wmi_handle->ctx[idx].buff_type =
-		wmi_handle->ctx[soc->max_event_idx].buff_type;
-
-	qdf_spin_unlock_bh(&soc->ctx_lock);
+	wmi_unified_release_event_handler_ix(wmi_handle, idx);
 
 	return QDF_STATUS_SUCCESS;
 }
@@ -2901,6 +3174,7 @@ void __wmi_control_rx(struct wmi_unified *wmi_handle, wmi_buf_t evt_buf)
 	uint32_t idx = 0;
 	struct wmi_raw_event_buffer ev_buf;
 	enum wmi_rx_buff_type ev_buff_type;
+	uint64_t dispatch_ts;
 
 	id = WMI_GET_FIELD(qdf_nbuf_data(evt_buf), WMI_CMD_HDR, COMMANDID);
 
@@ -2961,6 +3235,7 @@ void __wmi_control_rx(struct wmi_unified *wmi_handle, wmi_buf_t evt_buf)
 	}
 #endif
 	/* Call the WMI registered event handler */
+	dispatch_ts = wmi_evt_dispatch_ts();
 	if (wmi_handle->target_type == WMI_TLV_TARGET) {
 		ev_buff_type = wmi_handle->ctx[idx].buff_type;
 		if (ev_buff_type == WMI_RX_PROCESSED_BUFF) {
@@ -2977,6 +3252,7 @@ void __wmi_control_rx(struct wmi_unified *wmi_handle, wmi_buf_t evt_buf)
 	else
 		wmi_handle->event_handler[idx] (wmi_handle->scn_handle,
 			data, len);
+	wmi_evt_dispatch_stats_record(wmi_handle->soc, idx, dispatch_ts);
 
 end:
 	/* Free event buffer and allocated event tlv */
@@ -3470,6 +3746,7 @@ void wmi_unified_detach(struct wmi_unified *wmi_handle)
 		}
 	}
 	qdf_spinlock_destroy(&soc->ctx_lock);
+	wmi_evt_dispatch_tbl_free(soc);
 
 	if (soc->wmi_service_bitmap) {
 		qdf_mem_free(soc->wmi_service_bitmap);
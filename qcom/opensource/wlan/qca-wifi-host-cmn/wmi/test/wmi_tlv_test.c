@@ -0,0 +1,347 @@
+/*
+ * Copyright (c) 2024 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted, provided that the
+ * above copyright notice and this permission notice appear in all
+ * copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+ * AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR
+ * PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+ * TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "wmi.h"
+#include "wmi_tlv_test.h"
+#include "qdf_mem.h"
+#include "qdf_threads.h"
+#include "qdf_time.h"
+#include "qdf_trace.h"
+#include "qdf_util.h"
+
+#define WMI_TLV_TEST_ITERS 100000
+#define WMI_TLV_TEST_MAX_THREADS 4
+#define WMI_TLV_TEST_BUF_LEN 4096
+#define WMI_TLV_TEST_FRAME_LEN 128
+#define WMI_TLV_TEST_PEERS 16
+/* firmware older than the rate count fields, every peer gets padded */
+#define WMI_TLV_TEST_PEER_LEN \
+	(sizeof(wmi_peer_stats_info) - 2 * sizeof(A_UINT32))
+/* more parses kept outstanding than there are arenas */
+#define WMI_TLV_TEST_HOLD 16
+/* one event parsed in place, one padded */
+#define WMI_TLV_TEST_EVENTS 2
+
+struct wmi_tlv_test_event {
+	uint32_t id;
+	uint32_t len;
+	uint32_t buf[WMI_TLV_TEST_BUF_LEN / sizeof(uint32_t)];
+};
+
+struct wmi_tlv_test_thread_ctx {
+	struct wmi_tlv_test_event *event;
+	uint32_t errors;
+};
+
+/* a beacon or probe response as it is seen on every scan */
+static void wmi_tlv_test_build_mgmt_rx(struct wmi_tlv_test_event *event)
+{
+	uint8_t *ptr = (uint8_t *)event->buf;
+	wmi_mgmt_rx_hdr *hdr = (wmi_mgmt_rx_hdr *)ptr;
+	uint32_t i;
+
+	qdf_mem_zero(hdr, sizeof(*hdr));
+	WMITLV_SET_HDR(&hdr->tlv_header, WMITLV_TAG_STRUC_wmi_mgmt_rx_hdr,
+		       WMITLV_GET_STRUCT_TLVLEN(wmi_mgmt_rx_hdr));
+	hdr->buf_len = WMI_TLV_TEST_FRAME_LEN;
+	hdr->chan_freq = 5180;
+	ptr += sizeof(*hdr);
+
+	WMITLV_SET_HDR(ptr, WMITLV_TAG_ARRAY_BYTE, WMI_TLV_TEST_FRAME_LEN);
+	ptr += WMI_TLV_HDR_SIZE;
+	for (i = 0; i < WMI_TLV_TEST_FRAME_LEN; i++)
+		ptr[i] = (uint8_t)i;
+	ptr += WMI_TLV_TEST_FRAME_LEN;
+
+	event->id = WMI_MGMT_RX_EVENTID;
+	event->len = ptr - (uint8_t *)event->buf;
+}
+
+static uint32_t wmi_tlv_test_check_mgmt_rx(struct wmi_tlv_test_event *event,
+					   void *tlvs)
+{
+	WMI_MGMT_RX_EVENTID_param_tlvs *param_tlvs = tlvs;
+	uint8_t *buf = (uint8_t *)event->buf;
+
+	if (param_tlvs->hdr != (wmi_mgmt_rx_hdr *)buf ||
+	    param_tlvs->is_allocated_hdr ||
+	    param_tlvs->bufp != buf + sizeof(wmi_mgmt_rx_hdr) +
+				WMI_TLV_HDR_SIZE ||
+	    param_tlvs->num_bufp != WMI_TLV_TEST_FRAME_LEN ||
+	    param_tlvs->rssi_ctl_ext || param_tlvs->reo_params)
+		return 1;
+
+	return 0;
+}
+
+/* a peer stats report that needs every array element padded */
+static void wmi_tlv_test_build_peer_stats(struct wmi_tlv_test_event *event)
+{
+	uint8_t *ptr = (uint8_t *)event->buf;
+	wmi_peer_stats_info_event_fixed_param *fixed_param;
+	wmi_peer_stats_info *peer;
+	uint32_t i;
+
+	fixed_param = (wmi_peer_stats_info_event_fixed_param *)ptr;
+	qdf_mem_zero(fixed_param, sizeof(*fixed_param));
+	WMITLV_SET_HDR(&fixed_param->tlv_header,
+		       WMITLV_TAG_STRUC_wmi_peer_stats_info_event_fixed_param,
+		       WMITLV_GET_STRUCT_TLVLEN
+				(wmi_peer_stats_info_event_fixed_param));
+	fixed_param->num_peers = WMI_TLV_TEST_PEERS;
+	ptr += sizeof(*fixed_param);
+
+	WMITLV_SET_HDR(ptr, WMITLV_TAG_ARRAY_STRUC,
+		       WMI_TLV_TEST_PEERS * WMI_TLV_TEST_PEER_LEN);
+	ptr += WMI_TLV_HDR_SIZE;
+	for (i = 0; i < WMI_TLV_TEST_PEERS; i++) {
+		peer = (wmi_peer_stats_info *)ptr;
+		qdf_mem_zero(peer, WMI_TLV_TEST_PEER_LEN);
+		WMITLV_SET_HDR(&peer->tlv_header,
+			       WMITLV_TAG_STRUC_wmi_peer_stats_info,
+			       WMI_TLV_TEST_PEER_LEN - WMI_TLV_HDR_SIZE);
+		peer->peer_rssi = -40 - (int32_t)i;
+		ptr += WMI_TLV_TEST_PEER_LEN;
+	}
+
+	event->id = WMI_PEER_STATS_INFO_EVENTID;
+	event->len = ptr - (uint8_t *)event->buf;
+}
+
+static uint32_t
+wmi_tlv_test_check_peer_stats(struct wmi_tlv_test_event *event, void *tlvs)
+{
+	WMI_PEER_STATS_INFO_EVENTID_param_tlvs *param_tlvs = tlvs;
+	wmi_peer_stats_info *peer;
+	uint32_t i;
+
+	if (param_tlvs->fixed_param !=
+	    (wmi_peer_stats_info_event_fixed_param *)event->buf ||
+	    !param_tlvs->is_allocated_peer_stats_info ||
+	    param_tlvs->num_peer_stats_info != WMI_TLV_TEST_PEERS)
+		return 1;
+
+	/* the padding is zeroed, not the next peer's TLV header */
+	for (i = 0; i < WMI_TLV_TEST_PEERS; i++) {
+		peer = &param_tlvs->peer_stats_info[i];
+		if (peer->peer_rssi != -40 - (int32_t)i ||
+		    peer->num_tx_rate_counts || peer->num_rx_rate_counts)
+			return 1;
+	}
+
+	return 0;
+}
+
+static uint32_t wmi_tlv_test_check(struct wmi_tlv_test_event *event,
+				   void *tlvs)
+{
+	if (event->id == WMI_MGMT_RX_EVENTID)
+		return wmi_tlv_test_check_mgmt_rx(event, tlvs);
+
+	return wmi_tlv_test_check_peer_stats(event, tlvs);
+}
+
+static uint32_t wmi_tlv_test_parse_one(struct wmi_tlv_test_event *event)
+{
+	void *tlvs = NULL;
+	uint32_t errors;
+
+	if (wmitlv_check_and_pad_event_tlvs(NULL, event->buf, event->len,
+					    event->id, &tlvs))
+		return 1;
+
+	errors = wmi_tlv_test_check(event, tlvs);
+	wmitlv_free_allocated_event_tlvs(event->id, &tlvs);
+	if (tlvs)
+		errors++;
+
+	return errors;
+}
+
+/*
+ * Events that stop in the middle of a TLV are rejected, and whatever the
+ * parse had taken is given back on the way out.
+ */
+static uint32_t wmi_tlv_test_truncated(struct wmi_tlv_test_event *event)
+{
+	uint32_t len = event->len;
+	void *tlvs = NULL;
+	uint32_t errors = 0;
+
+	event->len = len - WMI_TLV_HDR_SIZE;
+	if (!wmitlv_check_and_pad_event_tlvs(NULL, event->buf, event->len,
+					     event->id, &tlvs) || tlvs)
+		errors++;
+	event->len = len;
+
+	return errors;
+}
+
+/* what every event costs the WMI RX path before its handler runs */
+static uint64_t wmi_tlv_test_time(struct wmi_tlv_test_event *event,
+				  uint32_t *errors)
+{
+	qdf_ktime_t start;
+	void *tlvs;
+	uint32_t i;
+
+	start = qdf_ktime_get();
+	for (i = 0; i < WMI_TLV_TEST_ITERS; i++) {
+		if (wmitlv_check_and_pad_event_tlvs(NULL, event->buf,
+						    event->len, event->id,
+						    &tlvs)) {
+			(*errors)++;
+			continue;
+		}
+		wmitlv_free_allocated_event_tlvs(event->id, &tlvs);
+	}
+
+	return qdf_do_div(qdf_ktime_to_ns(qdf_ktime_get()) -
+			  qdf_ktime_to_ns(start), WMI_TLV_TEST_ITERS);
+}
+
+/*
+ * Time the parse once with the arenas free and once with all of them
+ * held by outstanding parses, which is the dynamic allocation cost every
+ * event paid before the arenas.
+ */
+static uint32_t wmi_tlv_test_bench(struct wmi_tlv_test_event *event)
+{
+	void *held[WMI_TLV_TEST_HOLD] = { NULL };
+	uint64_t arena_ns, alloc_ns;
+	uint32_t errors = 0;
+	uint32_t i;
+
+	arena_ns = wmi_tlv_test_time(event, &errors);
+
+	for (i = 0; i < WMI_TLV_TEST_HOLD; i++)
+		if (wmitlv_check_and_pad_event_tlvs(NULL, event->buf,
+						    event->len, event->id,
+						    &held[i]))
+			errors++;
+
+	alloc_ns = wmi_tlv_test_time(event, &errors);
+
+	for (i = 0; i < WMI_TLV_TEST_HOLD; i++) {
+		if (!held[i])
+			continue;
+		errors += wmi_tlv_test_check(event, held[i]);
+		wmitlv_free_allocated_event_tlvs(event->id, &held[i]);
+	}
+
+	/* once given back the arenas serve parses again */
+	errors += wmi_tlv_test_parse_one(event);
+
+	qdf_nofl_info("wmi_tlv: event 0x%x %u bytes: %llu ns per event, %llu ns with the arenas busy, %u errors",
+		      event->id, event->len, arena_ns, alloc_ns, errors);
+
+	return errors;
+}
+
+static QDF_STATUS wmi_tlv_test_thread(void *context)
+{
+	struct wmi_tlv_test_thread_ctx *ctx = context;
+	struct wmi_tlv_test_event *event = ctx->event;
+	void *tlvs;
+	uint32_t i;
+
+	for (i = 0; i < WMI_TLV_TEST_ITERS; i++) {
+		if (wmitlv_check_and_pad_event_tlvs(NULL, event->buf,
+						    event->len, event->id,
+						    &tlvs)) {
+			ctx->errors++;
+			continue;
+		}
+		/* a parse sharing an arena with another would show here */
+		ctx->errors += wmi_tlv_test_check(event, tlvs);
+		wmitlv_free_allocated_event_tlvs(event->id, &tlvs);
+	}
+
+	return QDF_STATUS_SUCCESS;
+}
+
+/*
+ * Events are parsed from the WMI work queue, tasklet and scheduler thread
+ * at once. Run that many parsers against the same event and check every
+ * result, up to and past the point where the arenas run out.
+ */
+static uint32_t wmi_tlv_test_threads(struct wmi_tlv_test_event *event,
+				     uint32_t num_threads)
+{
+	struct wmi_tlv_test_thread_ctx ctx[WMI_TLV_TEST_MAX_THREADS] = { 0 };
+	qdf_thread_t *threads[WMI_TLV_TEST_MAX_THREADS];
+	qdf_ktime_t start;
+	uint64_t elapsed_ns;
+	uint32_t errors = 0;
+	uint32_t i;
+
+	start = qdf_ktime_get();
+	for (i = 0; i < num_threads; i++) {
+		ctx[i].event = event;
+		threads[i] = qdf_thread_run(wmi_tlv_test_thread, &ctx[i]);
+		QDF_BUG(threads[i]);
+		if (!threads[i]) {
+			errors++;
+			num_threads = i;
+		}
+	}
+
+	for (i = 0; i < num_threads; i++) {
+		qdf_thread_join(threads[i]);
+		errors += ctx[i].errors;
+	}
+	elapsed_ns = qdf_ktime_to_ns(qdf_ktime_get()) - qdf_ktime_to_ns(start);
+
+	qdf_nofl_info("wmi_tlv: event 0x%x %u threads: %llu ns per event, %u errors",
+		      event->id, num_threads,
+		      num_threads ?
+		      qdf_do_div(elapsed_ns, num_threads * WMI_TLV_TEST_ITERS) :
+		      0, errors);
+
+	return errors;
+}
+
+uint32_t wmi_tlv_unit_test(void)
+{
+	struct wmi_tlv_test_event *events;
+	uint32_t num_threads;
+	uint32_t errors = 0;
+	uint32_t i;
+
+	events = qdf_mem_malloc(WMI_TLV_TEST_EVENTS * sizeof(*events));
+	if (!events)
+		return 1;
+
+	wmi_tlv_test_build_mgmt_rx(&events[0]);
+	wmi_tlv_test_build_peer_stats(&events[1]);
+
+	for (i = 0; i < WMI_TLV_TEST_EVENTS; i++) {
+		errors += wmi_tlv_test_parse_one(&events[i]);
+		errors += wmi_tlv_test_truncated(&events[i]);
+		errors += wmi_tlv_test_bench(&events[i]);
+	}
+
+	for (num_threads = 1; num_threads <= WMI_TLV_TEST_MAX_THREADS;
+	     num_threads <<= 1)
+		errors += wmi_tlv_test_threads(&events[1], num_threads);
+
+	qdf_mem_free(events);
+	QDF_BUG(!errors);
+
+	return errors;
+}
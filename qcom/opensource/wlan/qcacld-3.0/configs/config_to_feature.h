@@ -73,6 +73,33 @@
 #define WLAN_DSC_TEST (1)
 #endif
 
+#if defined(CONFIG_DFS_TEST) && defined(CONFIG_WLAN_DFS_MASTER_ENABLE) && \
+	!defined(CONFIG_WLAN_FEATURE_DFS_OFFLOAD)
+#define WLAN_DFS_PULSE_REPLAY_TEST (1)
+#endif
+
+#ifdef CONFIG_DP_TEST
+#define WLAN_DP_PEER_HASH_TEST (1)
+#define WLAN_DP_RX_DEFRAG_TEST (1)
+#endif
+
+#if defined(CONFIG_DP_TEST) && defined(CONFIG_DP_HIST_LOG_LINEAR)
+#define WLAN_DP_HIST_TEST (1)
+#endif
+
+#if defined(CONFIG_DP_TEST) && defined(CONFIG_WLAN_DP_TX_DESC_PCPU_CACHE)
+#define WLAN_DP_TX_DESC_CACHE_TEST (1)
+#endif
+
+#if defined(CONFIG_DP_TEST) && defined(CONFIG_WLAN_DP_PERCPU_STATS)
+#define WLAN_DP_STATS_PCPU_TEST (1)
+#endif
+
+#if defined(CONFIG_DP_TEST) && defined(CONFIG_WLAN_DP_REO_QDESC_POOL) && \
+	!defined(CONFIG_RHINE)
+#define WLAN_DP_REO_QDESC_POOL_TEST (1)
+#endif
+
 #ifdef CONFIG_BERYLLIUM
 #define DP_OFFLOAD_FRAME_WITH_SW_EXCEPTION (1)
 #endif
@@ -85,6 +112,10 @@
 #define WLAN_DELAYED_WORK_TEST (1)
 #endif
 
+#if defined(CONFIG_QDF_TEST) && defined(CONFIG_DP_TRACE)
+#define WLAN_DP_TRACE_TEST (1)
+#endif
+
 #ifdef CONFIG_QDF_TEST
 #define WLAN_HASHTABLE_TEST (1)
 #endif
@@ -194,6 +225,14 @@
 #define WMI_INTERFACE_EVENT_LOGGING (1)
 #endif
 
+#ifdef CONFIG_WMI_TLV_EVENT_ARENA
+#define WMI_TLV_EVENT_ARENA (1)
+#endif
+
+#ifdef CONFIG_WMI_TEST
+#define WLAN_WMI_TLV_TEST (1)
+#endif
+
 #ifdef CONFIG_WLAN_FEATURE_LINK_LAYER_STATS
 #define WLAN_FEATURE_LINK_LAYER_STATS (1)
 #endif
@@ -238,6 +277,10 @@
 #define WLAN_CONV_SPECTRAL_ENABLE (1)
 #endif
 
+#if defined(CONFIG_SPECTRAL_TEST) && defined(CONFIG_WLAN_CONV_SPECTRAL_ENABLE)
+#define WLAN_SPECTRAL_UNPACK_TEST (1)
+#endif
+
 #ifdef CONFIG_WLAN_CFR_ENABLE
 #define WLAN_CFR_ENABLE (1)
 #endif
@@ -646,6 +689,26 @@
 #ifdef CONFIG_WLAN_SYSFS_DP_STATS
 #define WLAN_SYSFS_DP_STATS (1)
 #endif
+#ifdef CONFIG_WLAN_DP_PERCPU_STATS
+#define WLAN_DP_PERCPU_STATS (1)
+#endif
+#ifdef CONFIG_DP_HIST_LOG_LINEAR
+#define DP_HIST_LOG_LINEAR (1)
+#endif
+#ifdef CONFIG_WLAN_DP_PEER_HASH_RCU
+#define WLAN_DP_PEER_HASH_RCU (1)
+#endif
+#ifdef CONFIG_WLAN_DP_TX_DESC_PCPU_CACHE
+#define WLAN_DP_TX_DESC_PCPU_CACHE (1)
+#endif
+#ifdef CONFIG_PKTLOG_MMAP_STREAM
+#define PKTLOG_MMAP_STREAM (1)
+#endif
+
+#if defined(CONFIG_PKTLOG_TEST) && defined(CONFIG_PKTLOG_MMAP_STREAM) && \
+	!defined(CONFIG_REMOVE_PKT_LOG)
+#define WLAN_PKTLOG_STREAM_TEST (1)
+#endif
 #ifdef CONFIG_WIFI_MONITOR_SUPPORT
 #define WIFI_MONITOR_SUPPORT (1)
 #endif
@@ -787,6 +850,14 @@
 #define WLAN_OBJMGR_REF_ID_TRACE (1)
 #endif
 
+#ifdef CONFIG_WLAN_OBJMGR_PEER_HASH_RCU
+#define WLAN_OBJMGR_PEER_HASH_RCU (1)
+#endif
+
+#ifdef CONFIG_WLAN_PEER_HASH_BITS
+#define WLAN_PEER_HASH_BITS (CONFIG_WLAN_PEER_HASH_BITS)
+#endif
+
 #ifdef CONFIG_FEATURE_DELAYED_PEER_OBJ_DESTROY
 #define FEATURE_DELAYED_PEER_OBJ_DESTROY (1)
 #endif
@@ -1169,6 +1240,10 @@
 #define WLAN_DP_FEATURE_DEFERRED_REO_QDESC_DESTROY (1)
 #endif
 
+#ifdef CONFIG_WLAN_DP_REO_QDESC_POOL
+#define WLAN_DP_REO_QDESC_POOL (1)
+#endif
+
 #ifdef CONFIG_ARCH_SDX20
 #define SYNC_IPA_READY (1)
 #endif
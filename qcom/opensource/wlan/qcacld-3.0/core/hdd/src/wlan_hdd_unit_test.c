@@ -23,7 +23,16 @@
  * debugfs unit_test_host
  */
 #include "wlan_hdd_main.h"
+#include "dfs_pulse_replay_test.h"
+#include "dp_hist_test.h"
+#include "dp_peer_hash_test.h"
+#include "dp_reo_qdesc_pool_test.h"
+#include "dp_rx_defrag_test.h"
+#include "dp_stats_pcpu_test.h"
+#include "dp_tx_desc_cache_test.h"
+#include "pktlog_stream_test.h"
 #include "qdf_delayed_work_test.h"
+#include "qdf_dp_trace_test.h"
 #include "qdf_hashtable_test.h"
 #include "qdf_periodic_work_test.h"
 #include "qdf_ptr_hash_test.h"
@@ -33,8 +42,10 @@
 #include "qdf_trace.h"
 #include "qdf_tracker_test.h"
 #include "qdf_types_test.h"
+#include "spectral_unpack_test.h"
 #include "wlan_dsc_test.h"
 #include "wlan_hdd_unit_test.h"
+#include "wmi_tlv_test.h"
 
 typedef uint32_t (*hdd_ut_callback)(void);
 
@@ -44,8 +55,17 @@ struct hdd_ut_entry {
 };
 
 struct hdd_ut_entry hdd_ut_entries[] = {
+	{ .name = "dfs_pulse_replay", .callback = dfs_pulse_replay_unit_test },
+	{ .name = "dp_hist", .callback = dp_hist_unit_test },
+	{ .name = "dp_peer_hash", .callback = dp_peer_hash_unit_test },
+	{ .name = "dp_reo_qdesc_pool", .callback = dp_reo_qdesc_pool_unit_test },
+	{ .name = "dp_rx_defrag", .callback = dp_rx_defrag_unit_test },
+	{ .name = "dp_stats_pcpu", .callback = dp_stats_pcpu_unit_test },
+	{ .name = "dp_tx_desc_cache", .callback = dp_tx_desc_cache_unit_test },
 	{ .name = "dsc", .callback = dsc_unit_test },
+	{ .name = "pktlog_stream", .callback = pktlog_stream_unit_test },
 	{ .name = "qdf_delayed_work", .callback = qdf_delayed_work_unit_test },
+	{ .name = "qdf_dp_trace", .callback = qdf_dp_trace_unit_test },
 	{ .name = "qdf_ht", .callback = qdf_ht_unit_test },
 	{ .name = "qdf_periodic_work",
 	  .callback = qdf_periodic_work_unit_test },
@@ -54,6 +74,9 @@ struct hdd_ut_entry hdd_ut_entries[] = {
 	{ .name = "qdf_talloc", .callback = qdf_talloc_unit_test },
 	{ .name = "qdf_tracker", .callback = qdf_tracker_unit_test },
 	{ .name = "qdf_types", .callback = qdf_types_unit_test },
+	{ .name = "spectral_unpack",
+	  .callback = spectral_unpack_unit_test },
+	{ .name = "wmi_tlv", .callback = wmi_tlv_unit_test },
 };
 
 #define hdd_for_each_ut_entry(cursor) \
@@ -301,6 +301,46 @@ struct ath_pktlog_buf {
 				sizeof(struct ath_pktlog_hdr)) ? _rd_offset : 0; \
 	} while (0)
 
+#define PKTLOG_STREAM_MAGIC_NUM 0x504c5354
+#define PKTLOG_STREAM_VER       1
+#define PKTLOG_STREAM_ALIGN     8
+
+/* Record types of the mmap stream */
+#define PKTLOG_STREAM_REC_DATA  0
+#define PKTLOG_STREAM_REC_PAD   1
+
+/*
+ * Control page at the start of the mmap stream, followed by data_size
+ * bytes of records at data_offset. prod and cons are running byte counts,
+ * reduced modulo data_size to index the record area. The driver only
+ * writes prod and the drop counters; the reader only writes cons, after it
+ * is done with the records below it. Records are dropped, never
+ * overwritten, when the reader is behind.
+ */
+struct ath_pktlog_stream_hdr {
+	uint32_t magic_num;
+	uint32_t version;
+	uint32_t data_offset;
+	uint32_t data_size;
+	volatile uint64_t prod;
+	uint64_t dropped_records;
+	uint64_t dropped_bytes;
+	uint8_t reserved[24];
+	/* On its own cacheline, as it is written by the reader */
+	volatile uint64_t cons;
+};
+
+/*
+ * Each stream record starts 8 byte aligned with this header. A DATA record
+ * carries a struct ath_pktlog_hdr and its payload; a PAD record fills the
+ * end of the area when the next record does not fit there, and the reader
+ * continues at offset 0.
+ */
+struct ath_pktlog_stream_rec {
+	uint32_t len;
+	uint32_t type;
+};
+
 #endif /* REMOVE_PKT_LOG */
 
 /**